@@ -391,14 +391,15 @@ void amf_app::handle_itti_message(
   }
 
   // Update AMF UE NGAP ID
-  std::shared_ptr<ue_ngap_context> unc = {};
-  if (!amf_n2_inst->is_ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc =
+      amf_n2_inst->ran_ue_id_2_ue_ngap_context(
+          itti_msg.gnb_assoc_id, itti_msg.ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n1().error(
         "Could not find UE NGAP Context with ran_ue_ngap_id "
         "(" GNB_UE_NGAP_ID_FMT ")",
         itti_msg.ran_ue_ngap_id);
   } else {
-    unc = amf_n2_inst->ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id);
     unc.get()->amf_ue_ngap_id = amf_ue_ngap_id;
     amf_n2_inst->set_amf_ue_ngap_id_2_ue_ngap_context(amf_ue_ngap_id, unc);
   }
@@ -599,26 +600,23 @@ void amf_app::handle_itti_message(itti_sbi_n1_message_notification& itti_msg) {
 
   // Step 4. Create UE NGAP Context if necessary
   // Create/Update UE NGAP Context
-  std::shared_ptr<ue_ngap_context> unc = {};
-  if (!amf_n2_inst->is_ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id)) {
+  // No SCTP association yet (gnb_assoc_id 0)
+  std::shared_ptr<ue_ngap_context> unc =
+      amf_n2_inst->ran_ue_id_2_ue_ngap_context(0, ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_app().debug(
         "Create a new UE NGAP context with ran_ue_ngap_id " GNB_UE_NGAP_ID_FMT,
         ran_ue_ngap_id);
     unc = std::shared_ptr<ue_ngap_context>(new ue_ngap_context());
-    amf_n2_inst->set_ran_ue_ngap_id_2_ue_ngap_context(ran_ue_ngap_id, unc);
-  } else {
-    unc = amf_n2_inst->ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id);
-    if (!unc.get()) {
-      Logger::amf_app().error(
-          "Failed to get UE NGAP context for "
-          "ran_ue_ngap_id " GNB_UE_NGAP_ID_FMT,
-          ran_ue_ngap_id);
-      return;
-    }
+    unc->ran_ue_ngap_id = ran_ue_ngap_id;
+    unc->gnb_assoc_id   = 0;
+    amf_n2_inst->set_ran_ue_ngap_id_2_ue_ngap_context(unc);
   }
 
   // Store related information into UE NGAP context
   unc.get()->ran_ue_ngap_id = ran_ue_ngap_id;
+  unc.get()->amf_ue_ngap_id = amf_ue_ngap_id;
+  amf_n2_inst->set_amf_ue_ngap_id_2_ue_ngap_context(amf_ue_ngap_id, unc);
   // TODO:  unc.get()->sctp_stream_recv
   // TODO: unc.get()->sctp_stream_send
   // TODO: gc.get()->next_sctp_stream
@@ -0,0 +1,324 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+/*! \file amf_auth_vectors.cpp
+ \brief Authentication vectors generated ahead of the registrations, from SQNs
+        leased by blocks in the DB
+ \date 2021
+ */
+#include "amf_auth_vectors.hpp"
+
+#include "amf.hpp"
+#include "itti.hpp"
+#include "itti_msg_n1.hpp"
+#include "logger.hpp"
+
+extern "C" {
+#include "dynamic_memory_check.h"
+}
+
+extern itti_mw* itti_inst;
+
+//------------------------------------------------------------------------------
+amf_auth_vectors::amf_auth_vectors()
+    : generator(),
+      entries(),
+      epochs(0),
+      last_purge(clock::now()),
+      m_entries(),
+      workers(),
+      jobs(),
+      stopping(true),
+      m_jobs(),
+      c_jobs(),
+      db() {}
+
+//------------------------------------------------------------------------------
+amf_auth_vectors::~amf_auth_vectors() {
+  stop();
+}
+
+//------------------------------------------------------------------------------
+bool amf_auth_vectors::start(
+    const database_t& db_desc, const int nb_connections, const int nb_workers,
+    amf_auth_vector_generator_t generator) {
+  this->generator = generator;
+  {
+    std::unique_lock lock(m_jobs);
+    stopping = false;
+  }
+  int nb = (nb_workers > 0) ? nb_workers : 1;
+  for (int i = 0; i < nb; i++)
+    workers.push_back(std::thread(&amf_auth_vectors::run, this));
+  Logger::amf_n1().startup(
+      "Authentication vectors: %d workers, %d vectors per refill", nb,
+      AMF_AUTH_VECTORS_BATCH);
+  return db.start(db_desc, nb_connections);
+}
+
+//------------------------------------------------------------------------------
+void amf_auth_vectors::stop() {
+  // no new refill, the queued ones compute their vectors themselves
+  {
+    std::unique_lock lock(m_jobs);
+    stopping = true;
+  }
+  c_jobs.notify_all();
+  db.stop();
+  for (auto& w : workers) {
+    if (w.joinable()) w.join();
+  }
+  workers.clear();
+}
+
+//------------------------------------------------------------------------------
+bool amf_auth_vectors::get(
+    const amf_auth_vector_request_t& request, _5G_HE_AV_t& vector) {
+  bool available = false;
+  bool refilling = false;
+  uint64_t epoch = 0;
+  {
+    std::unique_lock lock(m_entries);
+    clock::time_point now = clock::now();
+    if (now - last_purge > std::chrono::seconds(AMF_AUTH_VECTORS_EXPIRY_S))
+      purge(now);
+
+    entry& e = entries[request.imsi];
+    if (e.serving_network != request.serving_network) {
+      // the vectors are bound to the serving network name
+      invalidate(e);
+      e.serving_network = request.serving_network;
+    }
+    drop_expired(e, now);
+    if (!e.vectors.empty() && e.waiters.empty()) {
+      vector = e.vectors.front().first;
+      e.vectors.pop_front();
+      available = true;
+    } else {
+      e.waiters.push_back(
+          {request.amf_ue_ngap_id, request.ran_ue_ngap_id, false});
+    }
+    if (!e.refilling &&
+        (!available ||
+         e.vectors.size() <= AMF_AUTH_VECTORS_REFILL_THRESHOLD)) {
+      e.refilling = true;
+      refilling   = true;
+    }
+    epoch = e.epoch;
+  }
+  if (refilling) refill(request.imsi, request.serving_network, epoch, {}, {});
+  return available;
+}
+
+//------------------------------------------------------------------------------
+void amf_auth_vectors::resynchronize(
+    const amf_auth_vector_request_t& request, const uint8_t* rand,
+    const std::string& auts) {
+  uint64_t epoch = 0;
+  {
+    std::unique_lock lock(m_entries);
+    entry& e = entries[request.imsi];
+    invalidate(e);
+    e.serving_network = request.serving_network;
+    e.waiters.push_back({request.amf_ue_ngap_id, request.ran_ue_ngap_id, true});
+    e.refilling = true;
+    epoch       = e.epoch;
+  }
+  refill(
+      request.imsi, request.serving_network, epoch,
+      std::string((const char*) rand, RAND_LENGTH), auts);
+}
+
+//------------------------------------------------------------------------------
+void amf_auth_vectors::invalidate(entry& e) {
+  // unique, the entry may be purged and created again
+  e.epoch = ++epochs;
+  e.vectors.clear();
+  e.refilling = false;
+}
+
+//------------------------------------------------------------------------------
+void amf_auth_vectors::refill(
+    const std::string& imsi, const std::string& serving_network,
+    const uint64_t epoch, const std::string& rand, const std::string& auts) {
+  {
+    std::unique_lock lock(m_jobs);
+    if (stopping) {
+      lock.unlock();
+      deliver(imsi, epoch, {}, false);
+      return;
+    }
+  }
+  // Run by the DB connection of the IMSI: the refills and the
+  // resynchronizations of a subscriber update the SQN in order
+  bool queued = db.async(imsi, [=](mysql_db_connection& conn) {
+    mysql_auth_info_t info = {};
+    bool result            = conn.get_auth_info(imsi, info);
+
+    uint8_t* sqn_ms = nullptr;
+    if (result && !auts.empty()) {
+      sqn_ms = Authentication_5gaka::sqn_ms_derive(
+          info.opc, info.key, (uint8_t*) auts.c_str(),
+          (uint8_t*) rand.c_str());
+    }
+    if (sqn_ms) {
+      // vectors after SQN_MS, next refill after them
+      uint64_t sqn = mysql_sqn_to_uint64(sqn_ms) + MYSQL_SQN_INCREMENT;
+      free_wrapper((void**) &sqn_ms);
+      mysql_sqn_from_uint64(sqn, info.sqn);
+      uint8_t next_sqn[SQN_LENGTH];
+      mysql_sqn_from_uint64(
+          sqn + MYSQL_SQN_INCREMENT * AMF_AUTH_VECTORS_BATCH, next_sqn);
+      result =
+          conn.set_rand_sqn(imsi, (const uint8_t*) rand.c_str(), next_sqn);
+    } else if (result) {
+      result = conn.lease_sqn(imsi, AMF_AUTH_VECTORS_BATCH, info.sqn);
+    }
+    if (!result) {
+      deliver(imsi, epoch, {}, false);
+      return;
+    }
+
+    {
+      std::unique_lock lock(m_jobs);
+      if (!stopping) {
+        jobs.push_back([=] { generate(imsi, serving_network, epoch, info); });
+        lock.unlock();
+        c_jobs.notify_one();
+        return;
+      }
+    }
+    generate(imsi, serving_network, epoch, info);
+  });
+  if (!queued) {
+    Logger::amf_n1().error("MySQL DB connections stopped");
+    deliver(imsi, epoch, {}, false);
+  }
+}
+
+//------------------------------------------------------------------------------
+void amf_auth_vectors::generate(
+    const std::string& imsi, const std::string& serving_network,
+    const uint64_t epoch, const mysql_auth_info_t& auth_info) {
+  std::vector<_5G_HE_AV_t> vectors(AMF_AUTH_VECTORS_BATCH);
+  mysql_auth_info_t info = auth_info;
+  uint64_t sqn           = mysql_sqn_to_uint64(auth_info.sqn);
+  for (int i = 0; i < AMF_AUTH_VECTORS_BATCH; i++) {
+    mysql_sqn_from_uint64(sqn + i * MYSQL_SQN_INCREMENT, info.sqn);
+    generator(info, imsi, serving_network, vectors[i]);
+  }
+  deliver(imsi, epoch, vectors, true);
+}
+
+//------------------------------------------------------------------------------
+void amf_auth_vectors::deliver(
+    const std::string& imsi, const uint64_t epoch,
+    const std::vector<_5G_HE_AV_t>& vectors, const bool result) {
+  std::vector<std::pair<waiter, _5G_HE_AV_t>> served = {};
+  std::vector<waiter> failed                         = {};
+  bool refilling                                     = false;
+  std::string serving_network                        = {};
+  {
+    std::unique_lock lock(m_entries);
+    auto it = entries.find(imsi);
+    if (it == entries.end()) return;
+    entry& e = it->second;
+    // dropped since, the waiters are served by the refill started then
+    if (e.epoch != epoch) return;
+    e.refilling = false;
+    if (!result) {
+      failed.swap(e.waiters);
+    } else {
+      clock::time_point now = clock::now();
+      clock::time_point expiry =
+          now + std::chrono::seconds(AMF_AUTH_VECTORS_EXPIRY_S);
+      drop_expired(e, now);
+      for (auto& v : vectors) e.vectors.push_back(std::make_pair(v, expiry));
+      std::size_t nb = 0;
+      while (nb < e.waiters.size() && !e.vectors.empty()) {
+        served.emplace_back(e.waiters[nb], e.vectors.front().first);
+        e.vectors.pop_front();
+        nb++;
+      }
+      e.waiters.erase(e.waiters.begin(), e.waiters.begin() + nb);
+      if (!e.waiters.empty() ||
+          e.vectors.size() <= AMF_AUTH_VECTORS_REFILL_THRESHOLD) {
+        e.refilling     = true;
+        refilling       = true;
+        serving_network = e.serving_network;
+      }
+    }
+  }
+  for (auto& s : served) send(s.first, &s.second);
+  for (auto& w : failed) send(w, nullptr);
+  if (refilling) refill(imsi, serving_network, epoch, {}, {});
+}
+
+//------------------------------------------------------------------------------
+void amf_auth_vectors::send(const waiter& w, const _5G_HE_AV_t* vector) {
+  std::shared_ptr<itti_n1_auth_vector> msg =
+      std::make_shared<itti_n1_auth_vector>(TASK_AMF_N1, TASK_AMF_N1);
+  msg->amf_ue_ngap_id       = w.amf_ue_ngap_id;
+  msg->ran_ue_ngap_id       = w.ran_ue_ngap_id;
+  msg->is_resynchronization = w.is_resynchronization;
+  msg->result               = (vector != nullptr);
+  if (vector) msg->vector = *vector;
+  int ret = itti_inst->send_msg(msg);
+  if (0 != ret) {
+    Logger::amf_n1().error(
+        "Could not send ITTI message %s to task TASK_AMF_N1",
+        msg->get_msg_name());
+  }
+}
+
+//------------------------------------------------------------------------------
+void amf_auth_vectors::drop_expired(entry& e, const clock::time_point now) {
+  // in order of expiry
+  while (!e.vectors.empty() && e.vectors.front().second <= now)
+    e.vectors.pop_front();
+}
+
+//------------------------------------------------------------------------------
+void amf_auth_vectors::purge(const clock::time_point now) {
+  for (auto it = entries.begin(); it != entries.end();) {
+    drop_expired(it->second, now);
+    if (it->second.vectors.empty() && it->second.waiters.empty() &&
+        !it->second.refilling)
+      it = entries.erase(it);
+    else
+      ++it;
+  }
+  last_purge = now;
+}
+
+//------------------------------------------------------------------------------
+void amf_auth_vectors::run() {
+  while (true) {
+    std::function<void()> job = {};
+    {
+      std::unique_lock lock(m_jobs);
+      c_jobs.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (jobs.empty()) return;
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+    job();
+  }
+}
@@ -0,0 +1,167 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+/*! \file amf_auth_vectors.hpp
+ \brief Authentication vectors generated ahead of the registrations, from SQNs
+        leased by blocks in the DB
+ \date 2021
+ */
+#ifndef _AMF_AUTH_VECTORS_H_
+#define _AMF_AUTH_VECTORS_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "authentication_algorithms_with_5gaka.hpp"
+#include "mysql_db.hpp"
+
+// Generate the 5G HE AV of a round: RAND and vector from the key, OPc, SQN
+typedef std::function<void(
+    const mysql_auth_info_t& auth_info, const std::string& imsi,
+    const std::string& serving_network, _5G_HE_AV_t& vector)>
+    amf_auth_vector_generator_t;
+
+typedef struct {
+  std::string imsi;
+  std::string serving_network;
+  long amf_ue_ngap_id;
+  uint32_t ran_ue_ngap_id;
+} amf_auth_vector_request_t;
+
+// Per subscriber cache of the 5G HE AVs of the next rounds. A refill leases
+// AMF_AUTH_VECTORS_BATCH SQNs with one DB statement (MySQL connections) and
+// the vectors are computed by the workers, the N1 workers only take a vector
+// from the cache.
+// The requests finding the cache empty get their vector in an ITTI message
+// (itti_n1_auth_vector to TASK_AMF_N1) once the refill is done.
+// A Synch failure (AUTS) drops the vectors of the subscriber, the refills in
+// progress are ignored (epoch) and a new block is leased after SQN_MS.
+class amf_auth_vectors {
+ public:
+  amf_auth_vectors();
+  ~amf_auth_vectors();
+  amf_auth_vectors(amf_auth_vectors const&) = delete;
+  void operator=(amf_auth_vectors const&) = delete;
+
+  /*
+   * Connect to the DB and start the workers computing the vectors
+   * @param [const database_t&] db_desc: DB parameters
+   * @param [const int] nb_connections: number of DB connections
+   * @param [const int] nb_workers: number of threads computing the vectors
+   * @param [amf_auth_vector_generator_t] generator: vector generation
+   * @return false if the DB cannot be connected (connected again at the
+   * next refill)
+   */
+  bool start(
+      const database_t& db_desc, const int nb_connections,
+      const int nb_workers, amf_auth_vector_generator_t generator);
+
+  /*
+   * Close the DB connections, let the workers compute the queued vectors and
+   * stop them
+   * @return void
+   */
+  void stop();
+
+  /*
+   * Take the next vector of a subscriber
+   * @param [const amf_auth_vector_request_t&] request: subscriber and UE
+   * @param [_5G_HE_AV_t&] vector: vector, if available
+   * @return true if the vector is available, otherwise it is sent to the UE
+   * N1 worker once generated
+   */
+  bool get(const amf_auth_vector_request_t& request, _5G_HE_AV_t& vector);
+
+  /*
+   * Drop the vectors of a subscriber after a Synch failure and generate a
+   * vector after SQN_MS, sent to the UE N1 worker
+   * @param [const amf_auth_vector_request_t&] request: subscriber and UE
+   * @param [const uint8_t*] rand: RAND of the vector rejected by the UE
+   * @param [const std::string&] auts: AUTS
+   * @return void
+   */
+  void resynchronize(
+      const amf_auth_vector_request_t& request, const uint8_t* rand,
+      const std::string& auts);
+
+ private:
+  typedef std::chrono::steady_clock clock;
+
+  class waiter {
+   public:
+    long amf_ue_ngap_id;
+    uint32_t ran_ue_ngap_id;
+    bool is_resynchronization;
+  };
+
+  class entry {
+   public:
+    std::string serving_network;
+    std::deque<std::pair<_5G_HE_AV_t, clock::time_point>> vectors;
+    std::vector<waiter> waiters;
+    uint64_t epoch = 0;  // incremented when the vectors are dropped
+    bool refilling = false;
+  };
+
+  // drop the vectors, the refill in progress
+  void invalidate(entry& e);
+  // lease the SQNs, after SQN_MS if the AUTS is given
+  void refill(
+      const std::string& imsi, const std::string& serving_network,
+      const uint64_t epoch, const std::string& rand, const std::string& auts);
+  // run by a worker
+  void generate(
+      const std::string& imsi, const std::string& serving_network,
+      const uint64_t epoch, const mysql_auth_info_t& auth_info);
+  // give the vectors to the cache and its waiters
+  void deliver(
+      const std::string& imsi, const uint64_t epoch,
+      const std::vector<_5G_HE_AV_t>& vectors, const bool result);
+  void send(const waiter& w, const _5G_HE_AV_t* vector);
+  void drop_expired(entry& e, const clock::time_point now);
+  void purge(const clock::time_point now);
+  void run();
+
+  amf_auth_vector_generator_t generator;
+
+  std::unordered_map<std::string, entry> entries;
+  uint64_t epochs;
+  clock::time_point last_purge;
+  std::mutex m_entries;
+
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> jobs;
+  bool stopping;
+  std::mutex m_jobs;
+  std::condition_variable c_jobs;
+
+  mysql_db_pool db;
+};
+
+#endif
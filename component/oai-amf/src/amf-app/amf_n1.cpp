@@ -60,6 +60,7 @@
 #include "itti.hpp"
 #include "itti_msg_n11.hpp"
 #include "itti_msg_n2.hpp"
+#include "itti_workers.hpp"
 #include "logger.hpp"
 #include "nas_algorithms.hpp"
 #include "comUt.hpp"
@@ -88,58 +89,88 @@ extern statistics stacs;
 // Static variables
 uint8_t amf_n1::no_random_delta                        = 0;
 std::map<std::string, std::string> amf_n1::rand_record = {};
+std::shared_mutex amf_n1::m_rand_record;
 
 void amf_n1_task(void*);
 
+//------------------------------------------------------------------------------
+static void amf_n1_handle_msg(itti_msg* msg) {
+  switch (msg->msg_type) {
+    case UL_NAS_DATA_IND: {
+      Logger::amf_n1().info("Received UL_NAS_DATA_IND");
+      itti_uplink_nas_data_ind* m =
+          dynamic_cast<itti_uplink_nas_data_ind*>(msg);
+      amf_n1_inst->handle_itti_message(ref(*m));
+    } break;
+    case DOWNLINK_NAS_TRANSFER: {
+      Logger::amf_n1().info("Received DOWNLINK_NAS_TRANSFER");
+      itti_downlink_nas_transfer* m =
+          dynamic_cast<itti_downlink_nas_transfer*>(msg);
+      amf_n1_inst->handle_itti_message(ref(*m));
+    } break;
+    case N1_AUTH_VECTOR: {
+      Logger::amf_n1().info("Received N1_AUTH_VECTOR");
+      itti_n1_auth_vector* m = dynamic_cast<itti_n1_auth_vector*>(msg);
+      amf_n1_inst->handle_itti_message(ref(*m));
+    } break;
+    case N1_AUSF_RESPONSE: {
+      Logger::amf_n1().info("Received N1_AUSF_RESPONSE");
+      itti_n1_ausf_response* m = dynamic_cast<itti_n1_ausf_response*>(msg);
+      amf_n1_inst->handle_itti_message(ref(*m));
+    } break;
+    case TIME_OUT: {
+      if (itti_msg_timeout* to = dynamic_cast<itti_msg_timeout*>(msg)) {
+        switch (to->arg1_user) {
+          case TASK_AMF_MOBILE_REACHABLE_TIMER_EXPIRE:
+            amf_n1_inst->mobile_reachable_timer_timeout(
+                to->timer_id, to->arg2_user);
+            break;
+          case TASK_AMF_IMPLICIT_DEREGISTRATION_TIMER_EXPIRE:
+            amf_n1_inst->implicit_deregistration_timer_timeout(
+                to->timer_id, to->arg2_user);
+            break;
+          default:
+            Logger::amf_n1().info(
+                "No handler for timer(%d) with arg1_user(%d) ", to->timer_id,
+                to->arg1_user);
+        }
+      }
+    } break;
+    default:
+      Logger::amf_n1().error("No handler for msg type %d", msg->msg_type);
+  }
+}
+
 //------------------------------------------------------------------------------
 void amf_n1_task(void*) {
   const task_id_t task_id = TASK_AMF_N1;
+  // NAS messages are handled in parallel, in order per AMF UE NGAP ID
+  itti_workers workers(task_id, AMF_N1_N2_WORKERS, amf_n1_handle_msg);
   itti_inst->notify_task_ready(task_id);
   do {
     std::shared_ptr<itti_msg> shared_msg = itti_inst->receive_msg(task_id);
     auto* msg                            = shared_msg.get();
 
     switch (msg->msg_type) {
-      case UL_NAS_DATA_IND: {
-        Logger::amf_n1().info("Received UL_NAS_DATA_IND");
-        itti_uplink_nas_data_ind* m =
-            dynamic_cast<itti_uplink_nas_data_ind*>(msg);
-        amf_n1_inst->handle_itti_message(ref(*m));
-      } break;
-      case DOWNLINK_NAS_TRANSFER: {
-        Logger::amf_n1().info("Received DOWNLINK_NAS_TRANSFER");
-        itti_downlink_nas_transfer* m =
-            dynamic_cast<itti_downlink_nas_transfer*>(msg);
-        amf_n1_inst->handle_itti_message(ref(*m));
+      case UL_NAS_DATA_IND:
+      case DOWNLINK_NAS_TRANSFER:
+      case N1_AUTH_VECTOR:
+      case N1_AUSF_RESPONSE: {
+        itti_msg_n1* m = dynamic_cast<itti_msg_n1*>(msg);
+        workers.dispatch(m->amf_ue_ngap_id, shared_msg);
       } break;
       case TIME_OUT: {
-        if (itti_msg_timeout* to = dynamic_cast<itti_msg_timeout*>(msg)) {
-          switch (to->arg1_user) {
-            case TASK_AMF_MOBILE_REACHABLE_TIMER_EXPIRE:
-              amf_n1_inst->mobile_reachable_timer_timeout(
-                  to->timer_id, to->arg2_user);
-              break;
-            case TASK_AMF_IMPLICIT_DEREGISTRATION_TIMER_EXPIRE:
-              amf_n1_inst->implicit_deregistration_timer_timeout(
-                  to->timer_id, to->arg2_user);
-              break;
-            default:
-              Logger::amf_n1().info(
-                  "No handler for timer(%d) with arg1_user(%d) ", to->timer_id,
-                  to->arg1_user);
-          }
-        }
+        // arg2_user: AMF UE NGAP ID
+        itti_msg_timeout* to = dynamic_cast<itti_msg_timeout*>(msg);
+        workers.dispatch(to->arg2_user, shared_msg);
       } break;
-
       case TERMINATE: {
-        if (itti_msg_terminate* terminate =
-                dynamic_cast<itti_msg_terminate*>(msg)) {
-          Logger::amf_n1().info("Received terminate message");
-          return;
-        }
+        Logger::amf_n1().info("Received terminate message");
+        workers.terminate();
+        return;
       } break;
       default:
-        Logger::amf_n1().error("No handler for msg type %d", msg->msg_type);
+        workers.dispatch_all(shared_msg);
     }
   } while (true);
 }
@@ -151,6 +182,27 @@ amf_n1::amf_n1() {
     throw std::runtime_error("Cannot create task TASK_AMF_N1");
   }
   Logger::amf_n1().startup("amf_n1 started");
+  Logger::amf_n1().startup(
+      "NAS 128-NEA2/128-NIA2: %s AES",
+      nas_algorithms::aes_hw_accelerated() ? "hardware" : "software");
+
+  if (!amf_cfg.support_features.enable_external_ausf) {
+    database_t db_desc = {};
+    db_desc.server     = amf_cfg.auth_para.mysql_server;
+    db_desc.user       = amf_cfg.auth_para.mysql_user;
+    db_desc.password   = amf_cfg.auth_para.mysql_pass;
+    db_desc.database   = amf_cfg.auth_para.mysql_db;
+    // connected again at the first authentication if the DB is not up yet
+    if (!auth_vectors.start(
+            db_desc, AMF_MYSQL_CONNECTIONS, AMF_AUTH_VECTORS_WORKERS,
+            [this](
+                const mysql_auth_info_t& auth_info, const std::string& imsi,
+                const std::string& serving_network, _5G_HE_AV_t& vector) {
+              authentication_vector_generator_in_udm(
+                  auth_info, imsi, serving_network, vector);
+            }))
+      Logger::amf_n1().warn("Cannot connect to MySQL DB");
+  }
 
   // EventExposure: subscribe to UE Location Report
   ee_ue_location_report_connection = event_sub.subscribe_ue_location_report(
@@ -204,11 +256,14 @@ void amf_n1::handle_itti_message(itti_downlink_nas_transfer& itti_msg) {
     return;
   }
 
-  bstring protected_nas;
-  encode_nas_message_protected(
-      secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
-      (uint8_t*) bdata(itti_msg.dl_nas), blength(itti_msg.dl_nas),
-      protected_nas);
+  bstring protected_nas = nullptr;
+  if (!encode_nas_message_protected(
+          secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
+          (uint8_t*) bdata(itti_msg.dl_nas), blength(itti_msg.dl_nas),
+          protected_nas)) {
+    Logger::amf_n1().error("Could not protect the NAS message");
+    return;
+  }
 
   if (itti_msg.is_n2sm_set) {
     // PDU Session Resource Release Command
@@ -913,10 +968,13 @@ void amf_n1::service_request_handle(
     service_accept->setPDU_session_status(0x0000);
     uint8_t buffer[BUFFER_SIZE_256];
     int encoded_size = service_accept->encode2buffer(buffer, BUFFER_SIZE_256);
-    bstring protectedNas;
-    encode_nas_message_protected(
-        secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
-        buffer, encoded_size, protectedNas);
+    bstring protectedNas = nullptr;
+    if (!encode_nas_message_protected(
+            secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
+            buffer, encoded_size, protectedNas)) {
+      Logger::amf_n1().error("Could not protect the NAS message");
+      return;
+    }
     uint8_t* kamf = nc.get()->kamf[secu->vector_pointer];
     uint8_t kgnb[32];
     uint32_t ulcount = secu->ul_count.seq_num | (secu->ul_count.overflow << 8);
@@ -963,10 +1021,13 @@ void amf_n1::service_request_handle(
 
     uint8_t buffer[BUFFER_SIZE_256];
     int encoded_size = service_accept->encode2buffer(buffer, BUFFER_SIZE_256);
-    bstring protectedNas;
-    encode_nas_message_protected(
-        secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
-        buffer, encoded_size, protectedNas);
+    bstring protectedNas = nullptr;
+    if (!encode_nas_message_protected(
+            secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
+            buffer, encoded_size, protectedNas)) {
+      Logger::amf_n1().error("Could not protect the NAS message");
+      return;
+    }
     uint8_t* kamf = nc.get()->kamf[secu->vector_pointer];
     uint8_t kgnb[32];
     uint32_t ulcount = secu->ul_count.seq_num | (secu->ul_count.overflow << 8);
@@ -1200,15 +1261,14 @@ void amf_n1::registration_request_handle(
       // release ue_ngap_context and ue_context
       if (uc.get()) uc.reset();
 
-      if (!amf_n2_inst->is_ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id)) {
+      std::shared_ptr<ue_ngap_context> unc =
+          amf_n2_inst->ue_ids_2_ue_ngap_context(amf_ue_ngap_id, ran_ue_ngap_id);
+      if (!unc) {
         Logger::amf_n1().error(
             "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
             ran_ue_ngap_id);
         return;
       }
-
-      std::shared_ptr<ue_ngap_context> unc =
-          amf_n2_inst->ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id);
       if (unc.get()) unc.reset();
       return;
     }
@@ -1336,13 +1396,13 @@ void amf_n1::registration_request_handle(
   }
 
   // Trigger UE Location Report
-  if (!amf_n2_inst->is_ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc =
+      amf_n2_inst->ue_ids_2_ue_ngap_context(amf_ue_ngap_id, ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n1().warn(
         "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
         ran_ue_ngap_id);
   } else {
-    std::shared_ptr<ue_ngap_context> unc =
-        amf_n2_inst->ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id);
 
     std::shared_ptr<gnb_context> gc = {};
     if (!amf_n2_inst->is_assoc_id_2_gnb_context(unc.get()->gnb_assoc_id)) {
@@ -1649,21 +1709,14 @@ void amf_n1::run_registration_procedure(std::shared_ptr<nas_context>& nc) {
     if (!nc.get()->is_auth_vectors_present) {
       Logger::amf_n1().debug(
           "Authentication vector in nas_context is not available");
-      if (auth_vectors_generator(nc)) {  // all authentication in one (AMF)
-        ngksi_t ngksi = 0;
-        if (nc.get()->security_ctx &&
-            nc.get()->ngKsi != NAS_KEY_SET_IDENTIFIER_NOT_AVAILABLE) {
-          // ngksi = (nc.get()->ngKsi + 1) % (NGKSI_MAX_VALUE + 1);
-          ngksi = (nc.get()->amf_ue_ngap_id + 1);  // % (NGKSI_MAX_VALUE + 1);
-        }
-        nc.get()->ngKsi = ngksi;
+      if (!amf_cfg.support_features.enable_external_ausf) {
+        // continued now or once generated (N1_AUTH_VECTOR)
+        request_auth_vectors(nc, false);
       } else {
-        Logger::amf_n1().error("Request Authentication Vectors failure");
-        send_registration_reject_msg(
-            _5GMM_CAUSE_ILLEGAL_UE, nc.get()->ran_ue_ngap_id,
-            nc.get()->amf_ue_ngap_id);  // cause?
-        return;
+        // continued once received (N1_AUSF_RESPONSE)
+        get_authentication_vectors_from_ausf(nc, false);
       }
+      return;
     } else {
       Logger::amf_n1().debug(
           "Authentication Vector in nas_context is available");
@@ -1706,33 +1759,37 @@ void amf_n1::run_registration_procedure(std::shared_ptr<nas_context>& nc) {
 }
 
 //------------------------------------------------------------------------------
-// Get authentication vectors either from AUSF(UDM) or from AMF (generate
-// locally)
-bool amf_n1::auth_vectors_generator(std::shared_ptr<nas_context>& nc) {
-  Logger::amf_n1().debug("Start to generate Authentication Vectors");
-  if (amf_cfg.support_features.enable_external_ausf) {
-    // get authentication vectors from AUSF
-    if (!get_authentication_vectors_from_ausf(nc)) return false;
-  } else {
-    authentication_vectors_generator_in_udm(nc);
-    authentication_vectors_generator_in_ausf(nc);
-    Logger::amf_n1().debug("Deriving kamf");
-    for (int i = 0; i < MAX_5GS_AUTH_VECTORS; i++) {
-      Authentication_5gaka::derive_kamf(
-          nc.get()->imsi, nc.get()->_5g_av[i].kseaf, nc.get()->kamf[i],
-          0x0000);  // second parameter: abba
+// Called on the SBI client thread, the AUSF response is handled by TASK_AMF_N1
+// in order with the NAS messages of the UE
+static sbi_json_handler_t ausf_response_handler(
+    const std::shared_ptr<nas_context>& nc, const bool is_confirmation,
+    const bool is_resynchronization) {
+  const long amf_ue_ngap_id     = nc.get()->amf_ue_ngap_id;
+  const uint32_t ran_ue_ngap_id = nc.get()->ran_ue_ngap_id;
+  return [=](const uint32_t response_code, nlohmann::json& response_json) {
+    std::shared_ptr<itti_n1_ausf_response> i =
+        std::make_shared<itti_n1_ausf_response>(TASK_AMF_N11, TASK_AMF_N1);
+    i->amf_ue_ngap_id       = amf_ue_ngap_id;
+    i->ran_ue_ngap_id       = ran_ue_ngap_id;
+    i->is_confirmation      = is_confirmation;
+    i->is_resynchronization = is_resynchronization;
+    i->http_code            = response_code;
+    i->response_data        = std::move(response_json);
+    int ret                 = itti_inst->send_msg(i);
+    if (0 != ret) {
+      Logger::amf_n1().error(
+          "Could not send ITTI message %s to task TASK_AMF_N1",
+          i->get_msg_name());
     }
-  }
-  return true;
+  };
 }
 
 //------------------------------------------------------------------------------
-bool amf_n1::get_authentication_vectors_from_ausf(
-    std::shared_ptr<nas_context>& nc) {
+void amf_n1::get_authentication_vectors_from_ausf(
+    std::shared_ptr<nas_context>& nc, bool is_resynchronization) {
   Logger::amf_n1().debug("Get Authentication Vectors from AUSF");
 
-  UEAuthenticationCtx ueauthenticationctx = {};
-  AuthenticationInfo authenticationinfo   = {};
+  AuthenticationInfo authenticationinfo = {};
   authenticationinfo.setSupiOrSuci(nc.get()->imsi);
   authenticationinfo.setServingNetworkName(nc.get()->serving_network);
   ResynchronizationInfo resynchronizationInfo = {};
@@ -1754,6 +1811,7 @@ bool amf_n1::get_authentication_vectors_from_ausf(
     comUt::print_buffer("amf_n1", "AUTS", auts_value, auts_len);
     Logger::amf_n1().info("ausf_s (%s)", auts_s);
     // generate_random(rand_value, RAND_LENGTH);
+    std::shared_lock lock(m_rand_record);
     std::map<std::string, std::string>::iterator iter;
     iter = rand_record.find(nc.get()->imsi);
     if (iter != rand_record.end()) {
@@ -1772,60 +1830,81 @@ bool amf_n1::get_authentication_vectors_from_ausf(
   uint8_t http_version = 1;
   if (amf_cfg.support_features.use_http2) http_version = 2;
 
-  if (amf_n11_inst->send_ue_authentication_request(
-          authenticationinfo, ueauthenticationctx, http_version)) {
-    unsigned char* r5gauthdata_rand = conv::format_string_as_hex(
-        ueauthenticationctx.getR5gAuthData().getRand());
-    memcpy(nc.get()->_5g_av[0].rand, r5gauthdata_rand, 16);
-    rand_record[nc.get()->imsi] =
-        ueauthenticationctx.getR5gAuthData().getRand();
-    comUt::print_buffer("amf_n1", "5G AV: RAND", nc.get()->_5g_av[0].rand, 16);
-    free_wrapper((void**) &r5gauthdata_rand);
-
-    unsigned char* r5gauthdata_autn = conv::format_string_as_hex(
-        ueauthenticationctx.getR5gAuthData().getAutn());
-    memcpy(nc.get()->_5g_av[0].autn, r5gauthdata_autn, 16);
-    comUt::print_buffer("amf_n1", "5G AV: AUTN", nc.get()->_5g_av[0].autn, 16);
-    free_wrapper((void**) &r5gauthdata_autn);
-
-    unsigned char* r5gauthdata_hxresstar = conv::format_string_as_hex(
-        ueauthenticationctx.getR5gAuthData().getHxresStar());
-    memcpy(nc.get()->_5g_av[0].hxresStar, r5gauthdata_hxresstar, 16);
-    comUt::print_buffer(
-        "amf_n1", "5G AV: hxres*", nc.get()->_5g_av[0].hxresStar, 16);
-    free_wrapper((void**) &r5gauthdata_hxresstar);
+  amf_n11_inst->send_ue_authentication_request(
+      authenticationinfo, http_version,
+      ausf_response_handler(nc, false, is_resynchronization));
+}
 
-    std::map<std::string, LinksValueSchema>::iterator iter;
-    iter = ueauthenticationctx.getLinks().find("5G_AKA");
+//------------------------------------------------------------------------------
+bool amf_n1::handle_ue_authentication_ctx(
+    std::shared_ptr<nas_context>& nc, itti_n1_ausf_response& itti_msg) {
+  Logger::amf_n1().debug(
+      "UE Authentication, response from AUSF, HTTP Code: %d",
+      itti_msg.http_code);
 
-    if (iter != ueauthenticationctx.getLinks().end()) {
-      nc.get()->Href = iter->second.getHref();
-      Logger::amf_n1().info("Links is: %s", nc.get()->Href.c_str());
-    } else {
-      Logger::amf_n1().error("Not found 5G_AKA");
+  UEAuthenticationCtx ueauthenticationctx = {};
+  if ((itti_msg.http_code == 200) or
+      (itti_msg.http_code == 201)) {  // TODO: remove hardcoded value
+    try {
+      from_json(itti_msg.response_data, ueauthenticationctx);
+    } catch (std::exception& e) {
+      return false;
     }
   } else {
-    Logger::amf_n1().info("Could not get expected response from AUSF");
-    // TODO: error handling
+    Logger::amf_n1().warn(
+        "UE Authentication, could not get response from AUSF");
     return false;
   }
 
+  unsigned char* r5gauthdata_rand = conv::format_string_as_hex(
+      ueauthenticationctx.getR5gAuthData().getRand());
+  memcpy(nc.get()->_5g_av[0].rand, r5gauthdata_rand, 16);
+  {
+    std::unique_lock lock(m_rand_record);
+    rand_record[nc.get()->imsi] =
+        ueauthenticationctx.getR5gAuthData().getRand();
+  }
+  comUt::print_buffer("amf_n1", "5G AV: RAND", nc.get()->_5g_av[0].rand, 16);
+  free_wrapper((void**) &r5gauthdata_rand);
+
+  unsigned char* r5gauthdata_autn = conv::format_string_as_hex(
+      ueauthenticationctx.getR5gAuthData().getAutn());
+  memcpy(nc.get()->_5g_av[0].autn, r5gauthdata_autn, 16);
+  comUt::print_buffer("amf_n1", "5G AV: AUTN", nc.get()->_5g_av[0].autn, 16);
+  free_wrapper((void**) &r5gauthdata_autn);
+
+  unsigned char* r5gauthdata_hxresstar = conv::format_string_as_hex(
+      ueauthenticationctx.getR5gAuthData().getHxresStar());
+  memcpy(nc.get()->_5g_av[0].hxresStar, r5gauthdata_hxresstar, 16);
+  comUt::print_buffer(
+      "amf_n1", "5G AV: hxres*", nc.get()->_5g_av[0].hxresStar, 16);
+  free_wrapper((void**) &r5gauthdata_hxresstar);
+
+  std::map<std::string, LinksValueSchema>::iterator iter;
+  iter = ueauthenticationctx.getLinks().find("5G_AKA");
+
+  if (iter != ueauthenticationctx.getLinks().end()) {
+    nc.get()->Href = iter->second.getHref();
+    Logger::amf_n1().info("Links is: %s", nc.get()->Href.c_str());
+  } else {
+    Logger::amf_n1().error("Not found 5G_AKA");
+  }
   return true;
 }
 
 //------------------------------------------------------------------------------
-bool amf_n1::_5g_aka_confirmation_from_ausf(
+void amf_n1::_5g_aka_confirmation_from_ausf(
     std::shared_ptr<nas_context>& nc, bstring resStar) {
   Logger::amf_n1().debug("5G AKA Confirmation from AUSF");
   std::string remoteUri = nc.get()->Href;
 
   std::string msgBody        = {};
-  nlohmann::json response    = {};
   std::string resStar_string = {};
 
-  std::map<std::string, std::string>::iterator iter;
-  iter = rand_record.find(nc.get()->imsi);
-  rand_record.erase(iter);
+  {
+    std::unique_lock lock(m_rand_record);
+    rand_record.erase(nc.get()->imsi);
+  }
   // convert_string_2_hex(resStar, resStar_string);
   uint8_t resStar_len    = blength(resStar);
   uint8_t* resStar_value = (uint8_t*) bdata(resStar);
@@ -1846,17 +1925,21 @@ bool amf_n1::_5g_aka_confirmation_from_ausf(
   msgBody = confirmationdata_j.dump();
 
   // TODO: Should be updated
-  uint8_t http_version   = 1;
-  uint32_t response_code = 0;
+  uint8_t http_version = 1;
   if (amf_cfg.support_features.use_http2) http_version = 2;
 
-  amf_n11_inst->curl_http_client(
-      remoteUri, "PUT", msgBody, response, response_code, http_version);
-
   free_wrapper((void**) &resStar_s);
+  amf_n11_inst->send_sbi_request(
+      remoteUri, "PUT", msgBody, http_version,
+      ausf_response_handler(nc, true, false));
+}
+
+//------------------------------------------------------------------------------
+bool amf_n1::handle_5g_aka_confirmation_response(
+    std::shared_ptr<nas_context>& nc, itti_n1_ausf_response& itti_msg) {
   try {
     ConfirmationDataResponse confirmationdataresponse;
-    response.get_to(confirmationdataresponse);
+    itti_msg.response_data.get_to(confirmationdataresponse);
     unsigned char* kseaf_hex =
         conv::format_string_as_hex(confirmationdataresponse.getKseaf());
     memcpy(nc.get()->_5g_av[0].kseaf, kseaf_hex, 32);
@@ -1908,79 +1991,153 @@ bool amf_n1::authentication_vectors_generator_in_ausf(
 }
 
 //------------------------------------------------------------------------------
-bool amf_n1::authentication_vectors_generator_in_udm(
-    std::shared_ptr<nas_context>& nc) {
-  Logger::amf_n1().debug("Generate Authentication Vectors");
-  uint8_t* sqn        = nullptr;
-  uint8_t* auts       = (uint8_t*) bdata(nc.get()->auts);
-  _5G_HE_AV_t* vector = nc.get()->_5g_he_av;
-  // Access to MySQL to fetch UE-related information
-  if (!connect_to_mysql()) {
-    Logger::amf_n1().error("Cannot connect to MySQL DB");
-    return false;
+// The vectors generated ahead hold one round each
+static_assert(
+    MAX_5GS_AUTH_VECTORS == 1, "one Authentication Vector per procedure");
+
+//------------------------------------------------------------------------------
+void amf_n1::request_auth_vectors(
+    std::shared_ptr<nas_context>& nc, bool is_resynchronization) {
+  amf_auth_vector_request_t request = {};
+  request.imsi                      = nc.get()->imsi;
+  request.serving_network           = nc.get()->serving_network;
+  request.amf_ue_ngap_id            = nc.get()->amf_ue_ngap_id;
+  request.ran_ue_ngap_id            = nc.get()->ran_ue_ngap_id;
+
+  if (is_resynchronization) {
+    // SQN_MS is hidden with the RAND of the vector the UE rejected
+    std::string auts = {};
+    if (nc.get()->auts)
+      auts =
+          std::string((char*) bdata(nc.get()->auts), blength(nc.get()->auts));
+    Logger::amf_n1().debug("Drop the Authentication Vectors generated ahead");
+    auth_vectors.resynchronize(request, nc.get()->_5g_he_av[0].rand, auts);
+    return;
   }
-  Logger::amf_n1().debug("Connected to MySQL successfully");
-  mysql_auth_info_t mysql_resp = {};
-  if (get_mysql_auth_info(nc.get()->imsi, mysql_resp)) {
-    if (auts) {
-      sqn = Authentication_5gaka::sqn_ms_derive(
-          mysql_resp.opc, mysql_resp.key, auts, mysql_resp.rand);
-      if (sqn) {
-        generate_random(vector[0].rand, RAND_LENGTH);
-        mysql_push_rand_sqn(nc.get()->imsi, vector[0].rand, sqn);
-        mysql_increment_sqn(nc.get()->imsi);
-        free_wrapper((void**) &sqn);
-      }
-      if (!get_mysql_auth_info(nc.get()->imsi, mysql_resp)) {
-        Logger::amf_n1().error("Cannot get data from MySQL");
-        return false;
-      }
-      sqn = mysql_resp.sqn;
-      for (int i = 0; i < MAX_5GS_AUTH_VECTORS; i++) {
-        generate_random(vector[i].rand, RAND_LENGTH);
-        comUt::print_buffer(
-            "amf_n1", "Generated random rand (5G HE AV)", vector[i].rand, 16);
-        generate_5g_he_av_in_udm(
-            mysql_resp.opc, nc.get()->imsi, mysql_resp.key, sqn,
-            nc.get()->serving_network,
-            vector[i]);  // serving network name
-      }
-      mysql_push_rand_sqn(
-          nc.get()->imsi, vector[MAX_5GS_AUTH_VECTORS - 1].rand, sqn);
-    } else {
-      Logger::amf_n1().debug("No AUTS ...");
-      Logger::amf_n1().debug(
-          "Receive information from MySQL with IMSI %s",
-          nc.get()->imsi.c_str());
-      for (int i = 0; i < MAX_5GS_AUTH_VECTORS; i++) {
-        generate_random(vector[i].rand, RAND_LENGTH);
-        sqn = mysql_resp.sqn;
-        generate_5g_he_av_in_udm(
-            mysql_resp.opc, nc.get()->imsi, mysql_resp.key, sqn,
-            nc.get()->serving_network,
-            vector[i]);  // serving network name
-      }
-      mysql_push_rand_sqn(
-          nc.get()->imsi, vector[MAX_5GS_AUTH_VECTORS - 1].rand, sqn);
+  if (auth_vectors.get(request, nc.get()->_5g_he_av[0])) {
+    Logger::amf_n1().debug("Authentication Vector generated ahead");
+    handle_auth_vector_available(nc, false);
+  }
+}
+
+//------------------------------------------------------------------------------
+void amf_n1::handle_itti_message(itti_n1_auth_vector& itti_msg) {
+  std::shared_ptr<nas_context> nc = {};
+  if (is_amf_ue_id_2_nas_context(itti_msg.amf_ue_ngap_id))
+    nc = amf_ue_id_2_nas_context(itti_msg.amf_ue_ngap_id);
+  else {
+    Logger::amf_n1().warn(
+        "No existed nas_context with amf_ue_ngap_id (" AMF_UE_NGAP_ID_FMT ")",
+        itti_msg.amf_ue_ngap_id);
+    return;
+  }
+
+  if (!itti_msg.result) {
+    Logger::amf_n1().error("Failed to generate the Authentication Vector");
+    send_registration_reject_msg(
+        _5GMM_CAUSE_ILLEGAL_UE, nc.get()->ran_ue_ngap_id,
+        nc.get()->amf_ue_ngap_id);  // cause?
+    return;
+  }
+  nc.get()->_5g_he_av[0] = itti_msg.vector;
+  handle_auth_vector_available(nc, itti_msg.is_resynchronization);
+}
+
+//------------------------------------------------------------------------------
+void amf_n1::handle_itti_message(itti_n1_ausf_response& itti_msg) {
+  std::shared_ptr<nas_context> nc = {};
+  if (is_amf_ue_id_2_nas_context(itti_msg.amf_ue_ngap_id))
+    nc = amf_ue_id_2_nas_context(itti_msg.amf_ue_ngap_id);
+  else {
+    Logger::amf_n1().warn(
+        "No existed nas_context with amf_ue_ngap_id (" AMF_UE_NGAP_ID_FMT ")",
+        itti_msg.amf_ue_ngap_id);
+    return;
+  }
+
+  if (!itti_msg.is_confirmation) {
+    if (!handle_ue_authentication_ctx(nc, itti_msg)) {
+      Logger::amf_n1().error("Request Authentication Vectors failure");
+      send_registration_reject_msg(
+          _5GMM_CAUSE_ILLEGAL_UE, nc.get()->ran_ue_ngap_id,
+          nc.get()->amf_ue_ngap_id);  // cause?
+      return;
     }
-    mysql_increment_sqn(nc.get()->imsi);
-  } else {
-    Logger::amf_n1().error("Failed to fetch user data from MySQL");
-    return false;
+    if (!itti_msg.is_resynchronization) select_ngksi(nc);
+    handle_auth_vector_successful_result(nc);
+    return;
   }
-  return true;
+
+  // 5G AKA Confirmation, the Authentication Response of the UE
+  if (!handle_5g_aka_confirmation_response(nc, itti_msg)) {
+    Logger::amf_n1().error(
+        "Authentication failed for UE with amf_ue_ngap_id " AMF_UE_NGAP_ID_FMT,
+        itti_msg.amf_ue_ngap_id);
+    send_registration_reject_msg(
+        _5GMM_CAUSE_ILLEGAL_UE, nc.get()->ran_ue_ngap_id,
+        nc.get()->amf_ue_ngap_id);  // cause?
+    return;
+  }
+  Logger::amf_n1().debug("Authentication successful by network!");
+  if (!start_security_mode_control_procedure(nc)) {
+    Logger::amf_n1().error("Start SMC procedure failure");
+  }
+}
+
+//------------------------------------------------------------------------------
+void amf_n1::handle_auth_vector_available(
+    std::shared_ptr<nas_context>& nc, bool is_resynchronization) {
+  authentication_vectors_generator_in_ausf(nc);
+  Logger::amf_n1().debug("Deriving kamf");
+  for (int i = 0; i < MAX_5GS_AUTH_VECTORS; i++) {
+    Authentication_5gaka::derive_kamf(
+        nc.get()->imsi, nc.get()->_5g_av[i].kseaf, nc.get()->kamf[i],
+        0x0000);  // second parameter: abba
+  }
+  if (!is_resynchronization) select_ngksi(nc);
+  handle_auth_vector_successful_result(nc);
+}
+
+//------------------------------------------------------------------------------
+void amf_n1::authentication_vector_generator_in_udm(
+    const mysql_auth_info_t& auth_info, const std::string& imsi,
+    const std::string& serving_network, _5G_HE_AV_t& vector) {
+  Logger::amf_n1().debug("Generate Authentication Vector");
+  uint8_t opc[KEY_LENGTH];
+  uint8_t key[KEY_LENGTH];
+  uint8_t sqn[SQN_LENGTH];
+  memcpy(opc, auth_info.opc, KEY_LENGTH);
+  memcpy(key, auth_info.key, KEY_LENGTH);
+  memcpy(sqn, auth_info.sqn, SQN_LENGTH);
+  std::string snn = serving_network;
+  generate_random(vector.rand, RAND_LENGTH);
+  comUt::print_buffer(
+      "amf_n1", "Generated random rand (5G HE AV)", vector.rand, 16);
+  generate_5g_he_av_in_udm(opc, imsi, key, sqn, snn, vector);
+}
+
+//------------------------------------------------------------------------------
+void amf_n1::select_ngksi(std::shared_ptr<nas_context>& nc) {
+  ngksi_t ngksi = 0;
+  if (nc.get()->security_ctx &&
+      nc.get()->ngKsi != NAS_KEY_SET_IDENTIFIER_NOT_AVAILABLE) {
+    // ngksi = (nc.get()->ngKsi + 1) % (NGKSI_MAX_VALUE + 1);
+    ngksi = (nc.get()->amf_ue_ngap_id + 1);  // % (NGKSI_MAX_VALUE + 1);
+  }
+  nc.get()->ngKsi = ngksi;
 }
 
 //------------------------------------------------------------------------------
 void amf_n1::generate_random(uint8_t* random_p, ssize_t length) {
-  gmp_randinit_default(random_state.state);
-  gmp_randseed_ui(random_state.state, time(NULL));
   if (!amf_cfg.auth_para.random.compare("true")) {
     Logger::amf_n1().debug("AMF config random -> true");
     random_t random_nb;
     mpz_init(random_nb);
     mpz_init_set_ui(random_nb, 0);
+    // called by the workers generating the Authentication Vectors
     pthread_mutex_lock(&random_state.lock);
+    gmp_randinit_default(random_state.state);
+    gmp_randseed_ui(random_state.state, time(NULL));
     mpz_urandomb(random_nb, random_state.state, 8 * length);
     pthread_mutex_unlock(&random_state.lock);
     mpz_export(random_p, NULL, 1, length, 0, 0, random_nb);
@@ -2215,7 +2372,9 @@ void amf_n1::authentication_response_handle(
   } else {
     if (amf_cfg.support_features.enable_external_ausf) {
       // std::string data = bdata(resStar);
-      if (!_5g_aka_confirmation_from_ausf(nc, resStar)) isAuthOk = false;
+      // continued once confirmed (N1_AUSF_RESPONSE)
+      _5g_aka_confirmation_from_ausf(nc, resStar);
+      return;
     } else {
       // Get stored XRES*
       int secu_index = 0;
@@ -2318,13 +2477,12 @@ void amf_n1::authentication_failure_handle(
       for (int i = 0; i < blength(auts); i++)
         printf("%x ", ((uint8_t*) bdata(auts))[i]);
       printf("\n");
-      if (auth_vectors_generator(nc)) {  // all authentication in one(AMF)
-        handle_auth_vector_successful_result(nc);
+      if (!amf_cfg.support_features.enable_external_ausf) {
+        // continued once generated (N1_AUTH_VECTOR)
+        request_auth_vectors(nc, true);
       } else {
-        Logger::amf_n1().error("Request Authentication Vectors failure");
-        send_registration_reject_msg(
-            _5GMM_CAUSE_ILLEGAL_UE, nc.get()->ran_ue_ngap_id,
-            nc.get()->amf_ue_ngap_id);  // cause?
+        // continued once received (N1_AUSF_RESPONSE)
+        get_authentication_vectors_from_ausf(nc, true);
       }
       // authentication_failure_synch_failure_handle(nc, auts);
     } break;
@@ -2440,10 +2598,14 @@ bool amf_n1::start_security_mode_control_procedure(
   std::string str = security_context_is_new ? "true" : "false";
   Logger::amf_n1().debug("Security Context status (is new:  %s)", str.c_str());
 
-  bstring intProtctedNas;
-  encode_nas_message_protected(
-      secu_ctx, security_context_is_new, INTEGRITY_PROTECTED_WITH_NEW_SECU_CTX,
-      NAS_MESSAGE_DOWNLINK, buffer, encoded_size, intProtctedNas);
+  bstring intProtctedNas = nullptr;
+  if (!encode_nas_message_protected(
+          secu_ctx, security_context_is_new,
+          INTEGRITY_PROTECTED_WITH_NEW_SECU_CTX, NAS_MESSAGE_DOWNLINK, buffer,
+          encoded_size, intProtctedNas)) {
+    Logger::amf_n1().error("Could not protect the NAS message");
+    return false;
+  }
   comUt::print_buffer(
       "amf_n1", "Encrypted Security-Mode-Command message buffer",
       (uint8_t*) bdata(intProtctedNas), blength(intProtctedNas));
@@ -2617,10 +2779,13 @@ void amf_n1::security_mode_complete_handle(
     return;
   }
 
-  bstring protectedNas;
-  encode_nas_message_protected(
-      secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
-      buffer, encoded_size, protectedNas);
+  bstring protectedNas = nullptr;
+  if (!encode_nas_message_protected(
+          secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
+          buffer, encoded_size, protectedNas)) {
+    Logger::amf_n1().error("Could not protect the NAS message");
+    return;
+  }
 
   if (!uc.get()->isUeContextRequest) {
     Logger::amf_n1().debug(
@@ -2745,11 +2910,12 @@ void amf_n1::registration_complete_handle(
 }
 
 //------------------------------------------------------------------------------
-void amf_n1::encode_nas_message_protected(
+bool amf_n1::encode_nas_message_protected(
     nas_secu_ctx* nsc, bool is_secu_ctx_new, uint8_t security_header_type,
     uint8_t direction, uint8_t* input_nas_buf, int input_nas_len,
     bstring& protected_nas) {
   Logger::amf_n1().debug("Encoding nas_message_protected...");
+  protected_nas = nullptr;
   uint8_t protected_nas_buf[1024];
   int encoded_size = 0;
 
@@ -2758,10 +2924,13 @@ void amf_n1::encode_nas_message_protected(
     } break;
 
     case INTEGRITY_PROTECTED_AND_CIPHERED: {
-      bstring input = blk2bstr(input_nas_buf, input_nas_len);
-      bstring ciphered;
-      // balloc(ciphered, blength(input));
-      nas_message_cipher_protected(nsc, NAS_MESSAGE_DOWNLINK, input, ciphered);
+      bstring input    = blk2bstr(input_nas_buf, input_nas_len);
+      bstring ciphered = nullptr;
+      if (!nas_message_cipher_protected(
+              nsc, NAS_MESSAGE_DOWNLINK, input, ciphered)) {
+        bdestroy(input);
+        return false;
+      }
       protected_nas_buf[0] = EPD_5GS_MM_MSG;
       protected_nas_buf[1] = INTEGRITY_PROTECTED_AND_CIPHERED;
       protected_nas_buf[6] = (uint8_t) nsc->dl_count.seq_num;
@@ -2769,6 +2938,8 @@ void amf_n1::encode_nas_message_protected(
       uint8_t* buf_tmp = (uint8_t*) bdata(ciphered);
       if (buf_tmp != nullptr)
         memcpy(&protected_nas_buf[7], (uint8_t*) buf_tmp, blength(ciphered));
+      bdestroy(input);
+      bdestroy(ciphered);
 
       uint32_t mac32 = 0;
       if (!(nas_message_integrity_protected(
@@ -2785,7 +2956,7 @@ void amf_n1::encode_nas_message_protected(
     case INTEGRITY_PROTECTED_WITH_NEW_SECU_CTX: {
       if ((nsc == nullptr) || !is_secu_ctx_new) {
         Logger::amf_n1().error("Security context is too old");
-        return;
+        return false;
       }
       protected_nas_buf[0] = EPD_5GS_MM_MSG;
       protected_nas_buf[1] = INTEGRITY_PROTECTED_WITH_NEW_SECU_CTX;
@@ -2809,6 +2980,7 @@ void amf_n1::encode_nas_message_protected(
   }
   protected_nas = blk2bstr(protected_nas_buf, encoded_size);
   nsc->dl_count.seq_num++;
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -2865,7 +3037,11 @@ bool amf_n1::nas_message_integrity_protected(
 
     case IA2_128_5G: {
       Logger::amf_n1().debug("Integrity with algorithms: 128-5G-IA2");
-      nas_algorithms::nas_stream_encrypt_nia2(&stream_cipher, mac);
+      if (nas_algorithms::nas_stream_encrypt_nia2(
+              nsc->algorithms_ctx, &stream_cipher, mac)) {
+        Logger::amf_n1().error("Integrity with 128-5G-IA2 failed");
+        return false;
+      }
       comUt::print_buffer("amf_n1", "Result for NIA2, mac: ", mac, 4);
       mac32 = ntohl(*((uint32_t*) mac));
       Logger::amf_n1().debug("Result for NIA2, mac32: 0x%x", mac32);
@@ -2927,12 +3103,16 @@ bool amf_n1::nas_message_cipher_protected(
     case EA2_128_5G: {
       Logger::amf_n1().debug("Cipher protected with EA2_128_5G");
 
-      uint32_t len = stream_cipher.blength >> 3;
-      if ((stream_cipher.blength & 0x7) > 0) len += 1;
-      uint8_t* ciphered = (uint8_t*) malloc(len);
-      nas_algorithms::nas_stream_encrypt_nea2(&stream_cipher, ciphered);
-      output_nas = blk2bstr(ciphered, len);
-      free(ciphered);
+      // ciphered in place in the output
+      output_nas = blk2bstr(buf, buf_len);
+      if (nas_algorithms::nas_stream_encrypt_nea2(
+              nsc->algorithms_ctx, &stream_cipher,
+              (uint8_t*) bdata(output_nas))) {
+        Logger::amf_n1().error("Cipher protection with EA2_128_5G failed");
+        bdestroy(output_nas);
+        output_nas = nullptr;
+        return false;
+      }
     } break;
   }
   return true;
@@ -3257,10 +3437,13 @@ void amf_n1::run_mobility_registration_update_procedure(
   }
 
   // protect nas message
-  bstring protectedNas;
-  encode_nas_message_protected(
-      secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
-      buffer, encoded_size, protectedNas);
+  bstring protectedNas = nullptr;
+  if (!encode_nas_message_protected(
+          secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
+          buffer, encoded_size, protectedNas)) {
+    Logger::amf_n1().error("Could not protect the NAS message");
+    return;
+  }
 
   // get PDU session status
   std::vector<uint8_t> pdu_session_to_be_activated = {};
@@ -3350,10 +3533,13 @@ void amf_n1::run_periodic_registration_update_procedure(
     return;
   }
 
-  bstring protectedNas;
-  encode_nas_message_protected(
-      secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
-      buffer, encoded_size, protectedNas);
+  bstring protectedNas = nullptr;
+  if (!encode_nas_message_protected(
+          secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
+          buffer, encoded_size, protectedNas)) {
+    Logger::amf_n1().error("Could not protect the NAS message");
+    return;
+  }
 
   std::shared_ptr<itti_dl_nas_transport> itti_msg =
       std::make_shared<itti_dl_nas_transport>(TASK_AMF_N1, TASK_AMF_N2);
@@ -3421,10 +3607,13 @@ void amf_n1::run_periodic_registration_update_procedure(
     return;
   }
 
-  bstring protectedNas;
-  encode_nas_message_protected(
-      secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
-      buffer, encoded_size, protectedNas);
+  bstring protectedNas = nullptr;
+  if (!encode_nas_message_protected(
+          secu, false, INTEGRITY_PROTECTED_AND_CIPHERED, NAS_MESSAGE_DOWNLINK,
+          buffer, encoded_size, protectedNas)) {
+    Logger::amf_n1().error("Could not protect the NAS message");
+    return;
+  }
 
   std::shared_ptr<itti_dl_nas_transport> itti_msg =
       std::make_shared<itti_dl_nas_transport>(TASK_AMF_N1, TASK_AMF_N2);
@@ -4363,8 +4552,12 @@ bool amf_n1::get_slice_selection_subscription_data_from_conf_file(
   }
 
   // Get gNB Context
-  std::shared_ptr<ue_ngap_context> unc =
-      amf_n2_inst->ran_ue_id_2_ue_ngap_context(nc->ran_ue_ngap_id);
+  std::shared_ptr<ue_ngap_context> unc = amf_n2_inst->ue_ids_2_ue_ngap_context(
+      nc->amf_ue_ngap_id, nc->ran_ue_ngap_id);
+  if (!unc) {
+    Logger::amf_n1().warn("Cannot find the UE NGAP context");
+    return false;
+  }
 
   std::shared_ptr<gnb_context> gc = {};
   if (!amf_n2_inst->is_assoc_id_2_gnb_context(unc.get()->gnb_assoc_id)) {
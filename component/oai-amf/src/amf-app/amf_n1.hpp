@@ -35,10 +35,12 @@
 
 #include <map>
 #include <shared_mutex>
+#include <vector>
 
 #include "3gpp_ts24501.hpp"
 #include "3gpp_29.503.h"
 #include "amf.hpp"
+#include "amf_auth_vectors.hpp"
 #include "amf_statistics.hpp"
 #include "bstrlib.h"
 #include "itti_msg_n1.hpp"
@@ -74,6 +76,21 @@ class amf_n1 {
    */
   void handle_itti_message(itti_downlink_nas_transfer& itti_msg);
 
+  /*
+   * Handle ITTI message (Authentication vector generated for the UE)
+   * @param [itti_n1_auth_vector&]: ITTI message
+   * @return void
+   */
+  void handle_itti_message(itti_n1_auth_vector& itti_msg);
+
+  /*
+   * Handle ITTI message (response of the AUSF) to go on with the
+   * Authentication procedure
+   * @param [itti_n1_ausf_response&]: ITTI message
+   * @return void
+   */
+  void handle_itti_message(itti_n1_ausf_response& itti_msg);
+
   /*
    * Handle NAS Establishment Request (Registration Request, Service Request)
    * @param [SecurityHeaderType_t] type: Security Header Type
@@ -284,28 +301,44 @@ class amf_n1 {
       std::shared_ptr<nas_context>& nc, bstring& nas_msg);
 
   /*
-   * Generate the Authentication Vectors
+   * Get the Authentication Vectors from an external AUSF, the response is
+   * handled by handle_itti_message(itti_n1_ausf_response&)
    * @param [std::shared_ptr<nas_context>&] nc: Pointer to the UE NAS Context
-   * @return true if generated successfully, otherwise return false
+   * @param [bool] is_resynchronization: after a Synch failure
+   * @return void
    */
-  bool auth_vectors_generator(std::shared_ptr<nas_context>& nc);
+  void get_authentication_vectors_from_ausf(
+      std::shared_ptr<nas_context>& nc, bool is_resynchronization);
 
   /*
-   * Get the Authentication Vectors from an external AUSF
+   * Store the Authentication Vectors of the UE Authentication Context from
+   * the AUSF
    * @param [std::shared_ptr<nas_context>&] nc: Pointer to the UE NAS Context
-   * @return true if generated successfully, otherwise return false
+   * @param [itti_n1_ausf_response&] itti_msg: response of the AUSF
+   * @return true if received successfully, otherwise return false
    */
-  bool get_authentication_vectors_from_ausf(std::shared_ptr<nas_context>& nc);
+  bool handle_ue_authentication_ctx(
+      std::shared_ptr<nas_context>& nc, itti_n1_ausf_response& itti_msg);
 
   /*
-   * Get the 5G AKA Confirmation from an external AUSF
+   * Get the 5G AKA Confirmation from an external AUSF, the response is
+   * handled by handle_itti_message(itti_n1_ausf_response&)
    * @param [std::shared_ptr<nas_context>&] nc: Pointer to the UE NAS Context
    * @param [bstring] resStar: resStar
-   * @return true if generated successfully, otherwise return false
+   * @return void
    */
-  bool _5g_aka_confirmation_from_ausf(
+  void _5g_aka_confirmation_from_ausf(
       std::shared_ptr<nas_context>& nc, bstring resStar);
 
+  /*
+   * Derive kamf from the kseaf of the 5G AKA Confirmation from the AUSF
+   * @param [std::shared_ptr<nas_context>&] nc: Pointer to the UE NAS Context
+   * @param [itti_n1_ausf_response&] itti_msg: response of the AUSF
+   * @return true if confirmed successfully, otherwise return false
+   */
+  bool handle_5g_aka_confirmation_response(
+      std::shared_ptr<nas_context>& nc, itti_n1_ausf_response& itti_msg);
+
   /*
    * Generate the Authentication Vectors (locally at AMF)
    * @param [std::shared_ptr<nas_context>&] nc: Pointer to the UE NAS Context
@@ -315,12 +348,46 @@ class amf_n1 {
       std::shared_ptr<nas_context>& nc);
 
   /*
-   * Generate the Authentication Vectors (RANDOM, locally at AMF)
+   * Get the Authentication Vector of the UE from the vectors generated ahead
+   * (local authentication). If none is available it is generated without
+   * waiting and handled by handle_itti_message(itti_n1_auth_vector&)
    * @param [std::shared_ptr<nas_context>&] nc: Pointer to the UE NAS Context
-   * @return true if generated successfully, otherwise return false
+   * @param [bool] is_resynchronization: after a Synch failure, the vectors
+   * generated ahead are dropped
+   * @return void
    */
-  bool authentication_vectors_generator_in_udm(
-      std::shared_ptr<nas_context>& nc);
+  void request_auth_vectors(
+      std::shared_ptr<nas_context>& nc, bool is_resynchronization);
+
+  /*
+   * Continue the procedure with the 5G HE AV of the NAS context: derive the
+   * 5G SE AV and kamf
+   * @param [std::shared_ptr<nas_context>&] nc: Pointer to the UE NAS Context
+   * @param [bool] is_resynchronization: after a Synch failure
+   * @return void
+   */
+  void handle_auth_vector_available(
+      std::shared_ptr<nas_context>& nc, bool is_resynchronization);
+
+  /*
+   * Generate an Authentication Vector (locally at AMF), run by the workers of
+   * the vectors generated ahead
+   * @param [const mysql_auth_info_t&] auth_info: Key, OPc and SQN of the UE
+   * @param [const std::string&] imsi: UE IMSI
+   * @param [const std::string&] serving_network: serving network name
+   * @param [_5G_HE_AV_t&] vector: 5G HE AV, with a new RAND
+   * @return void
+   */
+  void authentication_vector_generator_in_udm(
+      const mysql_auth_info_t& auth_info, const std::string& imsi,
+      const std::string& serving_network, _5G_HE_AV_t& vector);
+
+  /*
+   * Select the ngKSI of new Authentication Vectors
+   * @param [std::shared_ptr<nas_context>&] nc: Pointer to the UE NAS Context
+   * @return void
+   */
+  void select_ngksi(std::shared_ptr<nas_context>& nc);
 
   /*
    * Handle the Authentication Vector to setup security context with the UE
@@ -373,10 +440,11 @@ class amf_n1 {
    * @param [uint8_t] direction: Direction
    * @param [uint8_t*] input_nas_buf: Buffer of the input NAS
    * @param [int] input_nas_les: Length of the buffer
-   * @param [bstring&] encrypted_nas: Encrypted NAS (output)
-   * @return void
+   * @param [bstring&] encrypted_nas: Encrypted NAS (output), nullptr if the
+   * protection failed
+   * @return true if successful, otherwise return false
    */
-  void encode_nas_message_protected(
+  bool encode_nas_message_protected(
       nas_secu_ctx* nsc, bool is_secu_ctx_new, uint8_t security_header_type,
       uint8_t direction, uint8_t* input_nas_buf, int input_nas_len,
       bstring& encrypted_nas);
@@ -406,40 +474,6 @@ class amf_n1 {
       nas_secu_ctx* nsc, uint8_t direction, bstring input_nas,
       bstring& output_nas);
 
-  // NOTE: All the MySQL-related functions are currently implemented in
-  // mysql_db.cpp
-
-  /*
-   * Get the Authentication info from the DB (MySQL)
-   * @param [const std::string&] imsi: UE IMSI
-   * @param [mysql_auth_info_t&] resp: Response from MySQL
-   * @return true if retrieve successfully, otherwise return false
-   */
-  bool get_mysql_auth_info(const std::string& imsi, mysql_auth_info_t& resp);
-
-  /*
-   * Update the RAND and SQN to the DB (MySQL)
-   * @param [const std::string&] imsi: UE IMSI
-   * @param [uint8_t*] rand_p: RAND
-   * @param [uint8_t*] sqn: SQN
-   * @return void
-   */
-  void mysql_push_rand_sqn(
-      const std::string& imsi, uint8_t* rand_p, uint8_t* sqn);
-
-  /*
-   * Increment SQN in the DB for next round (MySQL)
-   * @param [const std::string&] imsi: UE IMSI
-   * @return void
-   */
-  void mysql_increment_sqn(const std::string& imsi);
-
-  /*
-   * Establish the connection to the DB (MySQL)
-   * @return true if successfully, otherwise return false
-   */
-  bool connect_to_mysql();
-
   /*
    * Generate a RAND with corresponding length
    * @param [uint8_t*] random_p: RAND
@@ -971,9 +1005,11 @@ class amf_n1 {
   mutable std::shared_mutex m_guti2nas_context;
 
   static std::map<std::string, std::string> rand_record;
+  static std::shared_mutex m_rand_record;
   static uint8_t no_random_delta;
   random_state_t random_state;
-  database_t* db_desc;
+  // local authentication only
+  amf_auth_vectors auth_vectors;
 
   // for Event Handling
   amf_event event_sub;
@@ -60,14 +60,6 @@ extern amf_n11* amf_n11_inst;
 extern amf_n1* amf_n1_inst;
 extern amf_app* amf_app_inst;
 
-//------------------------------------------------------------------------------
-std::size_t callback(
-    const char* in, std::size_t size, std::size_t num, std::string* out) {
-  const std::size_t totalBytes(size * num);
-  out->append(in, totalBytes);
-  return totalBytes;
-}
-
 //------------------------------------------------------------------------------
 void octet_stream_2_hex_stream(uint8_t* buf, int len, std::string& out) {
   out       = "";
@@ -90,8 +82,17 @@ void amf_n11_task(void*) {
     switch (msg->msg_type) {
       case NSMF_PDU_SESSION_CREATE_SM_CTX: {
         Logger::amf_n11().info("Running ITTI_SMF_PDU_SESSION_CREATE_SM_CTX");
-        itti_nsmf_pdusession_create_sm_context* m =
-            dynamic_cast<itti_nsmf_pdusession_create_sm_context*>(msg);
+        // Kept by the SMF selection until the SMF is discovered
+        std::shared_ptr<itti_nsmf_pdusession_create_sm_context> m =
+            std::dynamic_pointer_cast<itti_nsmf_pdusession_create_sm_context>(
+                shared_msg);
+        amf_n11_inst->handle_itti_message(m);
+      } break;
+
+      case N11_SMF_SELECTION_RESPONSE: {
+        Logger::amf_n11().info("Receive SMF Selection response, handling ...");
+        itti_n11_smf_selection_response* m =
+            dynamic_cast<itti_n11_smf_selection_response*>(msg);
         amf_n11_inst->handle_itti_message(ref(*m));
       } break;
 
@@ -103,6 +104,14 @@ void amf_n11_task(void*) {
         amf_n11_inst->handle_itti_message(ref(*m));
       } break;
 
+      case NSMF_PDU_SESSION_SM_CTX_RESPONSE: {
+        Logger::amf_n11().info(
+            "Receive Nsmf_PDUSession SM context response, handling ...");
+        itti_nsmf_pdusession_sm_context_response* m =
+            dynamic_cast<itti_nsmf_pdusession_sm_context_response*>(msg);
+        amf_n11_inst->handle_itti_message(ref(*m));
+      } break;
+
       case NSMF_PDU_SESSION_RELEASE_SM_CTX: {
         Logger::amf_n11().info(
             "Receive Nsmf_PDUSessionReleaseSMContext, handling ...");
@@ -185,7 +194,7 @@ void amf_n11_task(void*) {
 }
 
 //------------------------------------------------------------------------------
-amf_n11::amf_n11() {
+amf_n11::amf_n11() : sbi_client(amf_cfg.n11.if_name) {
   if (itti_inst->create_task(TASK_AMF_N11, amf_n11_task, nullptr)) {
     Logger::amf_n11().error("Cannot create task TASK_AMF_N11");
     throw std::runtime_error("Cannot create task TASK_AMF_N11");
@@ -298,18 +307,19 @@ void amf_n11::handle_itti_message(
 }
 
 //------------------------------------------------------------------------------
-void amf_n11::handle_itti_message(itti_nsmf_pdusession_create_sm_context& smf) {
+void amf_n11::handle_itti_message(
+    std::shared_ptr<itti_nsmf_pdusession_create_sm_context>& smf) {
   Logger::amf_n11().debug("Handle ITTI SMF_PDU_SESSION_CREATE_SM_CTX");
 
-  if (!amf_n1_inst->is_amf_ue_id_2_nas_context(smf.amf_ue_ngap_id)) {
+  if (!amf_n1_inst->is_amf_ue_id_2_nas_context(smf->amf_ue_ngap_id)) {
     Logger::amf_n11().error(
         "No UE NAS context with amf_ue_ngap_id (" AMF_UE_NGAP_ID_FMT ")",
-        smf.amf_ue_ngap_id);
+        smf->amf_ue_ngap_id);
     return;
   }
 
   std::shared_ptr<nas_context> nc = {};
-  nc               = amf_n1_inst->amf_ue_id_2_nas_context(smf.amf_ue_ngap_id);
+  nc               = amf_n1_inst->amf_ue_id_2_nas_context(smf->amf_ue_ngap_id);
   std::string supi = "imsi-" + nc.get()->imsi;
   string ue_context_key = "app_ue_ranid_" +
                           to_string(nc.get()->ran_ue_ngap_id) + ":amfid_" +
@@ -333,9 +343,9 @@ void amf_n11::handle_itti_message(itti_nsmf_pdusession_create_sm_context& smf) {
 
   // Create PDU Session Context if not available
   std::shared_ptr<pdu_session_context> psc = {};
-  if (!uc.get()->find_pdu_session_context(smf.pdu_sess_id, psc)) {
+  if (!uc.get()->find_pdu_session_context(smf->pdu_sess_id, psc)) {
     psc = std::shared_ptr<pdu_session_context>(new pdu_session_context());
-    uc.get()->add_pdu_session_context(smf.pdu_sess_id, psc);
+    uc.get()->add_pdu_session_context(smf->pdu_sess_id, psc);
     Logger::amf_n11().debug("Create a PDU Session Context");
   }
 
@@ -347,12 +357,12 @@ void amf_n11::handle_itti_message(itti_nsmf_pdusession_create_sm_context& smf) {
   // Store corresponding info in PDU Session Context
   psc.get()->amf_ue_ngap_id = nc.get()->amf_ue_ngap_id;
   psc.get()->ran_ue_ngap_id = nc.get()->ran_ue_ngap_id;
-  psc.get()->req_type       = smf.req_type;
-  psc.get()->pdu_session_id = smf.pdu_sess_id;
-  psc.get()->snssai.sST     = smf.snssai.sST;
-  psc.get()->snssai.sD      = smf.snssai.sD;
-  psc.get()->plmn.mcc       = smf.plmn.mcc;
-  psc.get()->plmn.mnc       = smf.plmn.mnc;
+  psc.get()->req_type       = smf->req_type;
+  psc.get()->pdu_session_id = smf->pdu_sess_id;
+  psc.get()->snssai.sST     = smf->snssai.sST;
+  psc.get()->snssai.sD      = smf->snssai.sD;
+  psc.get()->plmn.mcc       = smf->plmn.mcc;
+  psc.get()->plmn.mnc       = smf->plmn.mnc;
 
   Logger::amf_n11().debug(
       "PDU Session Context, NSSAI SST (0x%x) SD %s", psc.get()->snssai.sST,
@@ -360,8 +370,8 @@ void amf_n11::handle_itti_message(itti_nsmf_pdusession_create_sm_context& smf) {
 
   // parse binary dnn and store
   std::string dnn = "default";  // If DNN doesn't available, use "default"
-  if ((smf.dnn != nullptr) && (blength(smf.dnn) > 0)) {
-    char* tmp = conv::bstring2charString(smf.dnn);
+  if ((smf->dnn != nullptr) && (blength(smf->dnn) > 0)) {
+    char* tmp = conv::bstring2charString(smf->dnn);
     dnn       = tmp;
     free_wrapper((void**) &tmp);
   }
@@ -369,29 +379,24 @@ void amf_n11::handle_itti_message(itti_nsmf_pdusession_create_sm_context& smf) {
   Logger::amf_n11().debug("Requested DNN: %s", dnn.c_str());
   psc.get()->dnn = dnn;
 
-  std::string smf_addr        = {};
-  std::string smf_api_version = {};
-  std::string smf_port        = "80";  // Set to default port number
   if (!psc.get()->smf_available) {
     if (amf_cfg.support_features.enable_smf_selection) {
-      // Get NRF URI
-      std::string nrf_uri = {};
-      if (!amf_n11::get_nrf_uri(
-              psc.get()->snssai, psc.get()->plmn, psc.get()->dnn, nrf_uri)) {
-        Logger::amf_n11().error("No NRF is available");
-        return;
-      }
-      Logger::amf_n11().debug("NRF NF Discover URI: %s", nrf_uri.c_str());
-      // use NRF to find suitable SMF based on snssai, plmn and dnn
-      if (!discover_smf(
-              smf_addr, smf_port, smf_api_version, psc.get()->snssai,
-              psc.get()->plmn, psc.get()->dnn, nrf_uri)) {
-        Logger::amf_n11().error("SMF Selection, no SMF candidate is available");
-        return;
-      }
+      // Continued once the SMF is discovered (N11_SMF_SELECTION_RESPONSE)
+      std::shared_ptr<itti_n11_smf_selection_response> selection =
+          std::make_shared<itti_n11_smf_selection_response>(
+              TASK_AMF_N11, TASK_AMF_N11);
+      selection->request  = smf;
+      selection->supi     = supi;
+      selection->smf_port = "80";  // Set to default port number
+      get_nrf_uri(selection);
+      return;
+    }
 
-    } else if (!smf_selection_from_configuration(
-                   smf_addr, smf_port, smf_api_version)) {
+    std::string smf_addr        = {};
+    std::string smf_api_version = {};
+    std::string smf_port        = "80";  // Set to default port number
+    if (!smf_selection_from_configuration(
+            smf_addr, smf_port, smf_api_version)) {
       Logger::amf_n11().error(
           "No SMF candidate is available (from configuration file)");
       return;
@@ -402,11 +407,41 @@ void amf_n11::handle_itti_message(itti_nsmf_pdusession_create_sm_context& smf) {
     psc->smf_addr            = smf_addr;
     psc->smf_port            = smf_port;
     psc->smf_api_version     = smf_api_version;
-  } else {
-    smf_addr        = psc->smf_addr;
-    smf_api_version = psc->smf_api_version;
   }
 
+  send_pdu_session_sm_context_request(*smf, supi, psc);
+}
+
+//------------------------------------------------------------------------------
+void amf_n11::handle_itti_message(itti_n11_smf_selection_response& selection) {
+  itti_nsmf_pdusession_create_sm_context& smf = *selection.request;
+  if (!selection.result) {
+    Logger::amf_n11().error("SMF Selection, no SMF candidate is available");
+    return;
+  }
+
+  std::shared_ptr<pdu_session_context> psc = {};
+  if (!amf_app_inst->find_pdu_session_context(
+          selection.supi, smf.pdu_sess_id, psc)) {
+    Logger::amf_n11().warn(
+        "PDU Session context for SUPI %s doesn't exit!",
+        selection.supi.c_str());
+    return;
+  }
+
+  // store smf info to be used with this PDU session
+  psc.get()->smf_available = true;
+  psc->smf_addr            = selection.smf_addr;
+  psc->smf_port            = selection.smf_port;
+  psc->smf_api_version     = selection.smf_api_version;
+
+  send_pdu_session_sm_context_request(smf, selection.supi, psc);
+}
+
+//------------------------------------------------------------------------------
+void amf_n11::send_pdu_session_sm_context_request(
+    itti_nsmf_pdusession_create_sm_context& smf, const std::string& supi,
+    std::shared_ptr<pdu_session_context>& psc) {
   switch (smf.req_type & 0x07) {
     case PDU_SESSION_INITIAL_REQUEST: {
       // get pti
@@ -416,7 +451,8 @@ void amf_n11::handle_itti_message(itti_nsmf_pdusession_create_sm_context& smf) {
           "Decoded PTI for PDUSessionEstablishmentRequest(0x%x)", pti);
       psc.get()->isn2sm_avaliable = false;
       handle_pdu_session_initial_request(
-          supi, psc, smf_addr, smf_api_version, smf_port, smf.sm_msg, dnn);
+          supi, psc, psc->smf_addr, psc->smf_api_version, psc->smf_port,
+          smf.sm_msg, psc->dnn);
     } break;
     case EXISTING_PDU_SESSION: {
       // TODO:
@@ -428,7 +464,7 @@ void amf_n11::handle_itti_message(itti_nsmf_pdusession_create_sm_context& smf) {
       // send Nsmf_PDUSession_UpdateSM_Context to SMF e.g., for PDU Session
       // release request
       send_pdu_session_update_sm_context_request(
-          supi, psc, smf_addr, smf.sm_msg, dnn);
+          supi, psc, psc->smf_addr, smf.sm_msg, psc->dnn);
     }
   }
 }
@@ -578,21 +614,20 @@ void amf_n11::handle_itti_message(
   uint8_t http_version                     = 1;
   if (amf_cfg.support_features.use_http2) http_version = 2;
 
-  nlohmann::json response_json = {};
-  uint32_t response_code       = 0;
-
   // curl_http_client(
   //     remote_uri, json_part, "", "", itti_msg.supi,
   //     psc.get()->pdu_session_id, http_version);
 
-  curl_http_client(
-      remote_uri, "POST", msg_body, response_json, response_code, http_version);
-
-  // Notify to the result
-  if (itti_msg.promise_id > 0) {
-    amf_app_inst->trigger_process_response(itti_msg.promise_id, response_code);
-    return;
-  }
+  const uint32_t promise_id = itti_msg.promise_id;
+  send_sbi_request(
+      remote_uri, "POST", msg_body, http_version,
+      [promise_id](
+          const uint32_t response_code, nlohmann::json& response_json) {
+        // Notify to the result
+        if (promise_id > 0) {
+          amf_app_inst->trigger_process_response(promise_id, response_code);
+        }
+      });
 }
 
 //------------------------------------------------------------------------------
@@ -627,13 +662,13 @@ void amf_n11::handle_itti_message(itti_sbi_notify_subscribed_event& itti_msg) {
 
     json_data["reportList"] = report_lists;
 
-    std::string body             = json_data.dump();
-    nlohmann::json response_json = {};
-
-    std::string url        = i.get_notify_uri();
-    uint32_t response_code = 0;
-    curl_http_client(url, "POST", body, response_json, response_code);
-    // TODO: process the response
+    std::string body = json_data.dump();
+    std::string url  = i.get_notify_uri();
+    send_sbi_request(
+        url, "POST", body, 1,
+        [](const uint32_t response_code, nlohmann::json& response_json) {
+          // TODO: process the response
+        });
   }
   return;
 }
@@ -661,17 +696,16 @@ void amf_n11::handle_itti_message(
       "Send Slice Selection Subscription Data Retrieval to UDM, URL %s",
       url.c_str());
 
-  nlohmann::json response_data = {};
-  uint32_t response_code       = 0;
-  curl_http_client(url, "GET", "", response_data, response_code);
-
-  // Notify to the result
-  if (itti_msg.promise_id > 0) {
-    amf_app_inst->trigger_process_response(itti_msg.promise_id, response_data);
-    return;
-  }
-
-  return;
+  const uint32_t promise_id = itti_msg.promise_id;
+  send_sbi_request(
+      url, "GET", "", 1,
+      [promise_id](
+          const uint32_t response_code, nlohmann::json& response_data) {
+        // Notify to the result
+        if (promise_id > 0) {
+          amf_app_inst->trigger_process_response(promise_id, response_data);
+        }
+      });
 }
 
 //------------------------------------------------------------------------------
@@ -708,17 +742,16 @@ void amf_n11::handle_itti_message(
       "Send Slice Selection Information Retrieval to NSSF, URL %s",
       url.c_str());
 
-  nlohmann::json response_data = {};
-  uint32_t response_code       = 0;
-  curl_http_client(url, "GET", "", response_data, response_code);
-
-  // Notify to the result
-  if (itti_msg.promise_id > 0) {
-    amf_app_inst->trigger_process_response(itti_msg.promise_id, response_data);
-    return;
-  }
-
-  return;
+  const uint32_t promise_id = itti_msg.promise_id;
+  send_sbi_request(
+      url, "GET", "", 1,
+      [promise_id](
+          const uint32_t response_code, nlohmann::json& response_data) {
+        // Notify to the result
+        if (promise_id > 0) {
+          amf_app_inst->trigger_process_response(promise_id, response_data);
+        }
+      });
 }
 
 //------------------------------------------------------------------------------
@@ -742,14 +775,14 @@ void amf_n11::handle_itti_message(itti_n11_n1_message_notify& itti_msg) {
       (uint8_t*) bdata(itti_msg.registration_request),
       blength(itti_msg.registration_request), n1sm_msg);
 
-  uint8_t http_version   = 1;
-  uint32_t response_code = 0;
-  std::string n2sm_msg   = {};
-
-  curl_http_client(
-      url, json_part, n1sm_msg, n2sm_msg, http_version, response_code);
+  uint8_t http_version = 1;
+  std::string n2sm_msg = {};
 
-  // TODO: handle response
+  send_sbi_request(
+      url, json_part, n1sm_msg, n2sm_msg, http_version,
+      [](sbi_response_t& response) {
+        // TODO: handle response
+      });
   return;
 }
 
@@ -770,15 +803,16 @@ void amf_n11::handle_itti_message(itti_n11_nf_instance_discovery& itti_msg) {
   // TODO: remove hardcoded values
   url += "?target-nf-type=AMF&requester-nf-type=AMF";
 
-  nlohmann::json response_data = {};
-  uint32_t response_code       = 0;
-  curl_http_client(url, "GET", "", response_data, response_code, http_version);
-
-  // Notify to the result
-  if (itti_msg.promise_id > 0) {
-    amf_app_inst->trigger_process_response(itti_msg.promise_id, response_data);
-    return;
-  }
+  const uint32_t promise_id = itti_msg.promise_id;
+  send_sbi_request(
+      url, "GET", "", http_version,
+      [promise_id](
+          const uint32_t response_code, nlohmann::json& response_data) {
+        // Notify to the result
+        if (promise_id > 0) {
+          amf_app_inst->trigger_process_response(promise_id, response_data);
+        }
+      });
 }
 
 //------------------------------------------------------------------------------
@@ -847,33 +881,13 @@ void amf_n11::handle_post_sm_context_response_error(
 }
 
 //-----------------------------------------------------------------------------------------------------
-bool amf_n11::discover_smf(
-    std::string& smf_addr, std::string& smf_port, std::string& smf_api_version,
-    const snssai_t& snssai, const plmn_t& plmn, const std::string& dnn,
-    const std::string& nrf_uri) {
-  Logger::amf_n11().debug(
-      "Send NFDiscovery to NRF to discover the available SMFs");
+// Select the SMF from the NF instances discovered from the NRF
+static bool smf_from_nf_discovery(
+    const uint32_t response_code, nlohmann::json& response_data,
+    const snssai_t& snssai, std::string& smf_addr, std::string& smf_port,
+    std::string& smf_api_version) {
   bool result = false;
 
-  uint8_t http_version = 1;
-  if (amf_cfg.support_features.use_http2) http_version = 2;
-
-  nlohmann::json json_data = {};
-  std::string url          = {};
-
-  if (!nrf_uri.empty()) {
-    url = nrf_uri;
-  } else {
-    url = amf_cfg.get_nrf_nf_discovery_service_uri();
-  }
-
-  // TODO: remove hardcoded values
-  url += "?target-nf-type=SMF&requester-nf-type=AMF";
-
-  nlohmann::json response_data = {};
-  uint32_t response_code       = 0;
-  curl_http_client(url, "GET", "", response_data, response_code, http_version);
-
   Logger::amf_n11().debug(
       "NFDiscovery, response from NRF, json data: \n %s",
       response_data.dump().c_str());
@@ -959,6 +973,52 @@ bool amf_n11::discover_smf(
   return result;
 }
 
+//-----------------------------------------------------------------------------------------------------
+// Called on the SBI client thread, the PDU session creation goes on in
+// TASK_AMF_N11
+static void send_smf_selection_response(
+    std::shared_ptr<itti_n11_smf_selection_response>& selection) {
+  int ret = itti_inst->send_msg(selection);
+  if (0 != ret) {
+    Logger::amf_n11().error(
+        "Could not send ITTI message %s to task TASK_AMF_N11",
+        selection->get_msg_name());
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+void amf_n11::discover_smf(
+    std::shared_ptr<itti_n11_smf_selection_response>& selection,
+    const std::string& nrf_uri) {
+  Logger::amf_n11().debug(
+      "Send NFDiscovery to NRF to discover the available SMFs");
+
+  uint8_t http_version = 1;
+  if (amf_cfg.support_features.use_http2) http_version = 2;
+
+  std::string url = {};
+
+  if (!nrf_uri.empty()) {
+    url = nrf_uri;
+  } else {
+    url = amf_cfg.get_nrf_nf_discovery_service_uri();
+  }
+
+  // TODO: remove hardcoded values
+  url += "?target-nf-type=SMF&requester-nf-type=AMF";
+
+  send_sbi_request(
+      url, "GET", "", http_version,
+      [selection](
+          const uint32_t response_code, nlohmann::json& response_data) mutable {
+        selection->result = smf_from_nf_discovery(
+            response_code, response_data, selection->request->snssai,
+            selection->smf_addr, selection->smf_port,
+            selection->smf_api_version);
+        send_smf_selection_response(selection);
+      });
+}
+
 //-----------------------------------------------------------------------------------------------------
 void amf_n11::register_nf_instance(
     std::shared_ptr<itti_n11_register_nf_instance_request> msg) {
@@ -981,25 +1041,24 @@ void amf_n11::register_nf_instance(
   uint8_t http_version = 1;
   if (amf_cfg.support_features.use_http2) http_version = 2;
 
-  nlohmann::json response_data = {};
-  uint32_t response_code       = 0;
-  curl_http_client(
-      url, "PUT", body, response_data, response_code, http_version);
-
-  Logger::amf_n11().debug(
-      "NF Registration, response from NRF, json data: \n %s",
-      response_data.dump().c_str());
+  send_sbi_request(
+      url, "PUT", body, http_version,
+      [](const uint32_t response_code, nlohmann::json& response_data) {
+        Logger::amf_n11().debug(
+            "NF Registration, response from NRF, json data: \n %s",
+            response_data.dump().c_str());
 
-  if (response_code == 201) {
-    Logger::amf_n11().debug("NFRegistration, got successful response from NRF");
-  }
+        if (response_code == 201) {
+          Logger::amf_n11().debug(
+              "NFRegistration, got successful response from NRF");
+        }
+      });
 }
 
 //-----------------------------------------------------------------------------------------------------
-bool amf_n11::send_ue_authentication_request(
+void amf_n11::send_ue_authentication_request(
     const oai::amf::model::AuthenticationInfo& auth_info,
-    oai::amf::model::UEAuthenticationCtx& ue_auth_ctx,
-    const uint8_t& http_version) {
+    const uint8_t& http_version, sbi_json_handler_t&& handler) {
   Logger::amf_n11().debug(
       "Send UE Authentication Request to AUSF (HTTP version %d)", http_version);
 
@@ -1014,54 +1073,49 @@ bool amf_n11::send_ue_authentication_request(
   Logger::amf_n11().debug(
       "Send UE Authentication Request to AUSF, msg body: \n %s", body.c_str());
 
-  nlohmann::json response_data = {};
-  uint32_t response_code       = 0;
-  curl_http_client(
-      url, "POST", body, response_data, response_code, http_version);
-
-  Logger::amf_n11().debug(
-      "UE Authentication, response from AUSF, HTTP Code: %d", response_code);
-
-  if ((response_code == 200) or
-      (response_code == 201)) {  // TODO: remove hardcoded value
-    Logger::amf_n11().debug(
-        "UE Authentication, response from AUSF\n, %s ",
-        response_data.dump().c_str());
-    try {
-      from_json(response_data, ue_auth_ctx);
-    } catch (std::exception& e) {
-      return false;
-    }
-  } else {
-    Logger::amf_n11().warn(
-        "UE Authentication, could not get response from AUSF");
-    return false;
-  }
-
-  return true;
+  send_sbi_request(url, "POST", body, http_version, std::move(handler));
 }
 
 //------------------------------------------------------------------------------
-void amf_n11::curl_http_client(
-    const std::string& remote_uri, const std::string& json_data,
-    const std::string& n1sm_msg, const std::string& n2sm_msg,
-    const std::string& supi, const uint8_t& pdu_session_id,
-    const uint8_t& http_version, const uint32_t& promise_id) {
-  Logger::amf_n11().debug("Call SMF service: %s", remote_uri.c_str());
+static void json_from_response(
+    const std::string& remote_uri, const sbi_response_t& response,
+    nlohmann::json& response_json) {
+  Logger::amf_n11().info(
+      "Get response with HTTP code (%d)", response.http_code);
 
-  uint8_t number_parts                     = 0;
-  mime_parser parser                       = {};
-  std::string body                         = {};
-  std::shared_ptr<pdu_session_context> psc = {};
-  bool is_multipart                        = true;
+  if (static_cast<http_response_codes_e>(response.http_code) ==
+      http_response_codes_e::HTTP_RESPONSE_CODE_0) {
+    Logger::amf_n11().info(
+        "Cannot get response when calling %s", remote_uri.c_str());
+    return;
+  }
 
-  if (!amf_app_inst->find_pdu_session_context(supi, pdu_session_id, psc)) {
-    Logger::amf_n11().warn(
-        "PDU Session context for SUPI %s doesn't exit!", supi.c_str());
-    // TODO:
+  if (response.body.size() < 1) {
+    Logger::amf_n11().info("There's no content in the response");
+    response_json = {};
     return;
   }
 
+  try {
+    response_json = nlohmann::json::parse(response.body);
+  } catch (nlohmann::json::exception& e) {
+    Logger::amf_n11().info("Could not get JSON content from the response");
+    response_json = {};
+  }
+
+  Logger::amf_n11().info(
+      "Get response with Json content: %s", response_json.dump().c_str());
+}
+
+//------------------------------------------------------------------------------
+static void create_sm_body(
+    const std::string& json_data, const std::string& n1sm_msg,
+    const std::string& n2sm_msg, std::string& body,
+    std::string& content_type) {
+  mime_parser parser = {};
+  content_type       = "multipart/related; boundary=" +
+                 std::string(CURL_MIME_BOUNDARY);
+
   if ((n1sm_msg.size() > 0) and (n2sm_msg.size() > 0)) {
     // prepare the body content for Curl
     parser.create_multipart_related_content(
@@ -1078,621 +1132,378 @@ void amf_n11::curl_http_client(
         multipart_related_content_part_e::NGAP);
   } else {
     body         = json_data;
-    is_multipart = false;
+    content_type = "application/json";
   }
+}
 
-  Logger::amf_n11().debug(
-      "Send HTTP message to SMF with body %s", body.c_str());
+//------------------------------------------------------------------------------
+void amf_n11::curl_http_client(
+    const std::string& remote_uri, const std::string& json_data,
+    const std::string& n1sm_msg, const std::string& n2sm_msg,
+    const std::string& supi, const uint8_t& pdu_session_id,
+    const uint8_t& http_version, const uint32_t& promise_id) {
+  Logger::amf_n11().debug("Call SMF service: %s", remote_uri.c_str());
 
-  uint32_t str_len = body.length();
-  char* body_data  = (char*) malloc(str_len + 1);
-  memset(body_data, 0, str_len + 1);
-  memcpy((void*) body_data, (void*) body.c_str(), str_len);
-
-  curl_global_init(CURL_GLOBAL_ALL);
-  CURL* curl = curl_easy_init();
-
-  if (curl) {
-    CURLcode res               = {};
-    struct curl_slist* headers = nullptr;
-    std::string content_type   = {};
-    if (is_multipart) {
-      content_type = "content-type: multipart/related; boundary=" +
-                     std::string(CURL_MIME_BOUNDARY);
-    } else {
-      content_type = "content-type: application/json";
-    }
-    headers = curl_slist_append(headers, content_type.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_URL, remote_uri.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, CURL_TIMEOUT_MS);
-    curl_easy_setopt(curl, CURLOPT_INTERFACE, amf_cfg.n11.if_name.c_str());
-
-    if (http_version == 2) {
-      curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
-      // we use a self-signed test server, skip verification during debugging
-      curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-      curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-      curl_easy_setopt(
-          curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
-    }
+  std::string body                         = {};
+  std::string content_type                 = {};
+  std::shared_ptr<pdu_session_context> psc = {};
 
-    // Response information
-    long httpCode = {0};
-    std::unique_ptr<std::string> httpData(new std::string());
-    std::unique_ptr<std::string> httpHeaderData(new std::string());
+  if (!amf_app_inst->find_pdu_session_context(supi, pdu_session_id, psc)) {
+    Logger::amf_n11().warn(
+        "PDU Session context for SUPI %s doesn't exit!", supi.c_str());
+    // TODO:
+    return;
+  }
 
-    // Hook up data handling function
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, httpData.get());
-    curl_easy_setopt(curl, CURLOPT_HEADERDATA, httpHeaderData.get());
+  create_sm_body(json_data, n1sm_msg, n2sm_msg, body, content_type);
 
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, body.length());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body_data);
+  Logger::amf_n11().debug(
+      "Send HTTP message to SMF with body %s", body.c_str());
 
-    res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+  // Meanwhile TASK_AMF_N11 goes on with the next messages, the SBI client
+  // thread only hands the response over to it
+  sbi_client.send_request(
+      remote_uri, "POST", std::move(body), content_type, http_version,
+      [remote_uri, supi, pdu_session_id, promise_id](sbi_response_t& response) {
+        std::shared_ptr<itti_nsmf_pdusession_sm_context_response> i =
+            std::make_shared<itti_nsmf_pdusession_sm_context_response>(
+                TASK_AMF_N11, TASK_AMF_N11);
+        i->remote_uri     = remote_uri;
+        i->supi           = supi;
+        i->pdu_session_id = pdu_session_id;
+        i->promise_id     = promise_id;
+        i->http_code      = response.http_code;
+        i->body           = std::move(response.body);
+        i->headers        = std::move(response.headers);
+        int ret           = itti_inst->send_msg(i);
+        if (0 != ret) {
+          Logger::amf_n11().error(
+              "Could not send ITTI message %s to task TASK_AMF_N11",
+              i->get_msg_name());
+        }
+      });
+}
 
-    // get cause from the response
-    std::string response           = *httpData.get();
-    std::string json_data_response = {};
-    std::string n1sm               = {};
-    std::string n2sm               = {};
-    nlohmann::json response_data   = {};
-    bstring n1sm_hex, n2sm_hex;
+//------------------------------------------------------------------------------
+void amf_n11::handle_itti_message(
+    itti_nsmf_pdusession_sm_context_response& response) {
+  const std::string& remote_uri = response.remote_uri;
+  const std::string& supi       = response.supi;
+  const uint8_t pdu_session_id  = response.pdu_session_id;
+  const uint32_t promise_id     = response.promise_id;
+  uint8_t number_parts          = 0;
+  mime_parser parser            = {};
+  long httpCode                 = response.http_code;
+
+  // get cause from the response
+  std::string json_data_response = {};
+  std::string n1sm               = {};
+  std::string n2sm               = {};
+  nlohmann::json response_data   = {};
+  bstring n1sm_hex, n2sm_hex;
+
+  Logger::amf_n11().info("Get response with HTTP code (%d)", httpCode);
+  Logger::amf_n11().info("Response body %s", response.body.c_str());
+
+  if (static_cast<http_response_codes_e>(httpCode) ==
+      http_response_codes_e::HTTP_RESPONSE_CODE_0) {
+    // TODO: should be removed
+    Logger::amf_n11().error(
+        "Cannot get response when calling %s", remote_uri.c_str());
+    return;
+  }
 
-    Logger::amf_n11().info("Get response with HTTP code (%d)", httpCode);
-    Logger::amf_n11().info("Response body %s", response.c_str());
+  if (response.body.size() > 0) {
+    number_parts =
+        parser.parse(response.body, json_data_response, n1sm, n2sm);
+  }
 
-    if (static_cast<http_response_codes_e>(httpCode) ==
-        http_response_codes_e::HTTP_RESPONSE_CODE_0) {
-      // TODO: should be removed
-      Logger::amf_n11().error(
-          "Cannot get response when calling %s", remote_uri.c_str());
-      // free curl before returning
-      curl_slist_free_all(headers);
-      curl_easy_cleanup(curl);
-      curl_global_cleanup();
-      free_wrapper((void**) &body_data);
+  if (number_parts == 0) {
+    json_data_response = response.body;
+  }
+
+  Logger::amf_n11().info("JSON part %s", json_data_response.c_str());
+
+  if ((static_cast<http_response_codes_e>(httpCode) !=
+       http_response_codes_e::HTTP_RESPONSE_CODE_200_OK) &&
+      (static_cast<http_response_codes_e>(httpCode) !=
+       http_response_codes_e::HTTP_RESPONSE_CODE_201_CREATED) &&
+      (static_cast<http_response_codes_e>(httpCode) !=
+       http_response_codes_e::HTTP_RESPONSE_CODE_204_NO_CONTENT)) {
+    // ERROR
+    if (response.body.size() < 1) {
+      Logger::amf_n11().error("There's no content in the response");
+      // TODO: send context response error
       return;
     }
+    // TODO: HO
 
-    if (response.size() > 0) {
-      number_parts = parser.parse(response, json_data_response, n1sm, n2sm);
-    }
+    // Transfer N1 to gNB/UE if available
+    if (number_parts > 1) {
+      try {
+        response_data = nlohmann::json::parse(json_data_response);
+      } catch (nlohmann::json::exception& e) {
+        Logger::amf_n11().warn("Could not get JSON content from the response");
+        // Set the default Cause
+        response_data["error"]["cause"] = "504 Gateway Timeout";
+      }
 
-    if (number_parts == 0) {
-      json_data_response = response;
-    }
+      Logger::amf_n11().debug(
+          "Get response with json_data: %s", json_data_response.c_str());
+      conv::msg_str_2_msg_hex(n1sm, n1sm_hex);
+      comUt::print_buffer(
+          "amf_n11", "Get response with n1sm:", (uint8_t*) bdata(n1sm_hex),
+          blength(n1sm_hex));
 
-    Logger::amf_n11().info("JSON part %s", json_data_response.c_str());
-
-    if ((static_cast<http_response_codes_e>(httpCode) !=
-         http_response_codes_e::HTTP_RESPONSE_CODE_200_OK) &&
-        (static_cast<http_response_codes_e>(httpCode) !=
-         http_response_codes_e::HTTP_RESPONSE_CODE_201_CREATED) &&
-        (static_cast<http_response_codes_e>(httpCode) !=
-         http_response_codes_e::HTTP_RESPONSE_CODE_204_NO_CONTENT)) {
-      // ERROR
-      if (response.size() < 1) {
-        Logger::amf_n11().error("There's no content in the response");
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        curl_global_cleanup();
-        free_wrapper((void**) &body_data);
-        // TODO: send context response error
-        return;
-      }
-      // TODO: HO
+      std::string cause = response_data["error"]["cause"];
+      Logger::amf_n11().debug(
+          "Network Function services failure (with cause %s)", cause.c_str());
+      //         if (!cause.compare("DNN_DENIED"))
+      handle_post_sm_context_response_error(
+          httpCode, cause, n1sm_hex, supi, pdu_session_id);
+    }
 
-      // Transfer N1 to gNB/UE if available
-      if (number_parts > 1) {
-        try {
-          response_data = nlohmann::json::parse(json_data_response);
-        } catch (nlohmann::json::exception& e) {
+  } else {  // Response with success code
+    // Store location of the created context in case of PDU Session
+    // Establishment
+    const std::string& header_response = response.headers;
+    std::string CRLF                   = "\r\n";
+    std::size_t location_pos           = header_response.find("Location");
+    if (location_pos == std::string::npos)
+      location_pos = header_response.find("location");
+
+    if (location_pos != std::string::npos) {
+      std::size_t crlf_pos = header_response.find(CRLF, location_pos);
+      if (crlf_pos != std::string::npos) {
+        std::string location = header_response.substr(
+            location_pos + 10, crlf_pos - (location_pos + 10));
+        Logger::amf_n11().info(
+            "Location of the created SMF context: %s", location.c_str());
+        std::shared_ptr<pdu_session_context> psc = {};
+        if (amf_app_inst->find_pdu_session_context(
+                supi, pdu_session_id, psc)) {
+          psc.get()->smf_context_location = location;
+        } else {
           Logger::amf_n11().warn(
-              "Could not get JSON content from the response");
-          // Set the default Cause
-          response_data["error"]["cause"] = "504 Gateway Timeout";
+              "PDU Session context for SUPI %s doesn't exit!", supi.c_str());
         }
+      }
+    }
 
-        Logger::amf_n11().debug(
-            "Get response with json_data: %s", json_data_response.c_str());
-        conv::msg_str_2_msg_hex(n1sm, n1sm_hex);
-        comUt::print_buffer(
-            "amf_n11", "Get response with n1sm:", (uint8_t*) bdata(n1sm_hex),
-            blength(n1sm_hex));
+    try {
+      response_data = nlohmann::json::parse(json_data_response);
+    } catch (nlohmann::json::exception& e) {
+      Logger::amf_n11().warn("Could not get JSON content from the response");
+      // TODO:
+      return;
+    }
 
-        std::string cause = response_data["error"]["cause"];
-        Logger::amf_n11().debug(
-            "Network Function services failure (with cause %s)", cause.c_str());
-        //         if (!cause.compare("DNN_DENIED"))
-        handle_post_sm_context_response_error(
-            httpCode, cause, n1sm_hex, supi, pdu_session_id);
+    // For N2 HO
+    bool is_ho_procedure       = false;
+    std::string promise_result = {};
+    if (response_data.find("hoState") != response_data.end()) {
+      is_ho_procedure = true;
+
+      std::string ho_state = {};
+      response_data.at("hoState").get_to(ho_state);
+      if (ho_state.compare("COMPLETED") == 0) {
+        if (response_data.find("pduSessionId") != response_data.end())
+          response_data.at("pduSessionId").get_to(promise_result);
+      } else if (number_parts > 1) {
+        promise_result = n1sm;  // actually, N2 SM Info
       }
+    }
+    // Notify to the result
+    if ((promise_id > 0) and (is_ho_procedure)) {
+      amf_app_inst->trigger_process_response(promise_id, promise_result);
+      return;
+    }
 
-    } else {  // Response with success code
-      // Store location of the created context in case of PDU Session
-      // Establishment
-      std::string header_response = *httpHeaderData.get();
-      std::string CRLF            = "\r\n";
-      std::size_t location_pos    = header_response.find("Location");
-      if (location_pos == std::string::npos)
-        location_pos = header_response.find("location");
-
-      if (location_pos != std::string::npos) {
-        std::size_t crlf_pos = header_response.find(CRLF, location_pos);
-        if (crlf_pos != std::string::npos) {
-          std::string location = header_response.substr(
-              location_pos + 10, crlf_pos - (location_pos + 10));
-          Logger::amf_n11().info(
-              "Location of the created SMF context: %s", location.c_str());
-          psc.get()->smf_context_location = location;
-        }
-      }
+    // Transfer N1/N2 to gNB/UE if available
+    if (number_parts > 1) {
+      itti_n1n2_message_transfer_request* itti_msg =
+          new itti_n1n2_message_transfer_request(TASK_AMF_N11, TASK_AMF_APP);
 
-      try {
-        response_data = nlohmann::json::parse(json_data_response);
-      } catch (nlohmann::json::exception& e) {
-        Logger::amf_n11().warn("Could not get JSON content from the response");
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        curl_global_cleanup();
-        free_wrapper((void**) &body_data);
-        // TODO:
-        return;
-      }
+      itti_msg->is_n1sm_set = false;
+      itti_msg->is_n2sm_set = false;
+      itti_msg->is_ppi_set  = false;
 
-      // For N2 HO
-      bool is_ho_procedure       = false;
-      std::string promise_result = {};
-      if (response_data.find("hoState") != response_data.end()) {
-        is_ho_procedure = true;
-
-        std::string ho_state = {};
-        response_data.at("hoState").get_to(ho_state);
-        if (ho_state.compare("COMPLETED") == 0) {
-          if (response_data.find("pduSessionId") != response_data.end())
-            response_data.at("pduSessionId").get_to(promise_result);
-        } else if (number_parts > 1) {
-          promise_result = n1sm;  // actually, N2 SM Info
-        }
+      if (n1sm.size() > 0) {
+        conv::msg_str_2_msg_hex(n1sm, n1sm_hex);
+        comUt::print_buffer(
+            "amf_n11", "Get response n1sm:", (uint8_t*) bdata(n1sm_hex),
+            blength(n1sm_hex));
+        itti_msg->n1sm        = n1sm_hex;
+        itti_msg->is_n1sm_set = true;
       }
-      // Notify to the result
-      if ((promise_id > 0) and (is_ho_procedure)) {
-        amf_app_inst->trigger_process_response(promise_id, promise_result);
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        curl_global_cleanup();
-        free_wrapper((void**) &body_data);
-        return;
+      if (n2sm.size() > 0) {
+        conv::msg_str_2_msg_hex(n2sm, n2sm_hex);
+        comUt::print_buffer(
+            "amf_n11", "Get response n2sm:", (uint8_t*) bdata(n2sm_hex),
+            blength(n2sm_hex));
+        itti_msg->n2sm           = n2sm_hex;
+        itti_msg->is_n2sm_set    = true;
+        itti_msg->n2sm_info_type = response_data
+            ["n2SmInfoType"];  // response_data["n2InfoContainer"]["smInfo"]["n2InfoContent"]["ngapIeType"];
       }
 
-      // Transfer N1/N2 to gNB/UE if available
-      if (number_parts > 1) {
-        itti_n1n2_message_transfer_request* itti_msg =
-            new itti_n1n2_message_transfer_request(TASK_AMF_N11, TASK_AMF_APP);
-
-        itti_msg->is_n1sm_set = false;
-        itti_msg->is_n2sm_set = false;
-        itti_msg->is_ppi_set  = false;
-
-        if (n1sm.size() > 0) {
-          conv::msg_str_2_msg_hex(n1sm, n1sm_hex);
-          comUt::print_buffer(
-              "amf_n11", "Get response n1sm:", (uint8_t*) bdata(n1sm_hex),
-              blength(n1sm_hex));
-          itti_msg->n1sm        = n1sm_hex;
-          itti_msg->is_n1sm_set = true;
-        }
-        if (n2sm.size() > 0) {
-          conv::msg_str_2_msg_hex(n2sm, n2sm_hex);
-          comUt::print_buffer(
-              "amf_n11", "Get response n2sm:", (uint8_t*) bdata(n2sm_hex),
-              blength(n2sm_hex));
-          itti_msg->n2sm           = n2sm_hex;
-          itti_msg->is_n2sm_set    = true;
-          itti_msg->n2sm_info_type = response_data
-              ["n2SmInfoType"];  // response_data["n2InfoContainer"]["smInfo"]["n2InfoContent"]["ngapIeType"];
-        }
-
-        itti_msg->supi           = supi;
-        itti_msg->pdu_session_id = pdu_session_id;
-        std::shared_ptr<itti_n1n2_message_transfer_request> i =
-            std::shared_ptr<itti_n1n2_message_transfer_request>(itti_msg);
-        int ret = itti_inst->send_msg(i);
-        if (0 != ret) {
-          Logger::amf_n11().error(
-              "Could not send ITTI message %s to task TASK_AMF_APP",
-              i->get_msg_name());
-        }
+      itti_msg->supi           = supi;
+      itti_msg->pdu_session_id = pdu_session_id;
+      std::shared_ptr<itti_n1n2_message_transfer_request> i =
+          std::shared_ptr<itti_n1n2_message_transfer_request>(itti_msg);
+      int ret = itti_inst->send_msg(i);
+      if (0 != ret) {
+        Logger::amf_n11().error(
+            "Could not send ITTI message %s to task TASK_AMF_APP",
+            i->get_msg_name());
       }
     }
-
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
   }
-
-  curl_global_cleanup();
-  free_wrapper((void**) &body_data);
 }
 
 //------------------------------------------------------------------------------
-void amf_n11::curl_http_client(
-    const std::string& remote_uri, std::string& json_data,
-    std::string& n1sm_msg, std::string& n2sm_msg, const uint8_t& http_version,
-    uint32_t& response_code, const uint32_t& promise_id) {
+void amf_n11::send_sbi_request(
+    const std::string& remote_uri, const std::string& json_data,
+    const std::string& n1sm_msg, const std::string& n2sm_msg,
+    const uint8_t& http_version, sbi_response_handler_t&& handler) {
   Logger::amf_n11().debug("Call SMF service: %s", remote_uri.c_str());
 
-  uint8_t number_parts = 0;
-  mime_parser parser   = {};
-  std::string body     = {};
+  std::string body         = {};
+  std::string content_type = {};
 
-  bool is_multipart = true;
-
-  if ((n1sm_msg.size() > 0) and (n2sm_msg.size() > 0)) {
-    // prepare the body content for Curl
-    parser.create_multipart_related_content(
-        body, json_data, CURL_MIME_BOUNDARY, n1sm_msg, n2sm_msg);
-  } else if (n1sm_msg.size() > 0) {  // only N1 content
-    // prepare the body content for Curl
-    parser.create_multipart_related_content(
-        body, json_data, CURL_MIME_BOUNDARY, n1sm_msg,
-        multipart_related_content_part_e::NAS);
-  } else if (n2sm_msg.size() > 0) {  // only N2 content
-    // prepare the body content for Curl
-    parser.create_multipart_related_content(
-        body, json_data, CURL_MIME_BOUNDARY, n2sm_msg,
-        multipart_related_content_part_e::NGAP);
-  } else {
-    body         = json_data;
-    is_multipart = false;
-  }
+  create_sm_body(json_data, n1sm_msg, n2sm_msg, body, content_type);
 
   Logger::amf_n11().debug(
       "Send HTTP message to SMF with body %s", body.c_str());
 
-  uint32_t str_len = body.length();
-  char* body_data  = (char*) malloc(str_len + 1);
-  memset(body_data, 0, str_len + 1);
-  memcpy((void*) body_data, (void*) body.c_str(), str_len);
-
-  curl_global_init(CURL_GLOBAL_ALL);
-  CURL* curl = curl_easy_init();
-
-  if (curl) {
-    CURLcode res               = {};
-    struct curl_slist* headers = nullptr;
-    std::string content_type   = {};
-    if (is_multipart) {
-      content_type = "content-type: multipart/related; boundary=" +
-                     std::string(CURL_MIME_BOUNDARY);
-    } else {
-      content_type = "content-type: application/json";
-    }
-    headers = curl_slist_append(headers, content_type.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_URL, remote_uri.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, CURL_TIMEOUT_MS);
-    curl_easy_setopt(curl, CURLOPT_INTERFACE, amf_cfg.n11.if_name.c_str());
-
-    if (http_version == 2) {
-      curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
-      // we use a self-signed test server, skip verification during debugging
-      curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-      curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-      curl_easy_setopt(
-          curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
-    }
-
-    // Response information
-    long httpCode = {0};
-    std::unique_ptr<std::string> httpData(new std::string());
-    std::unique_ptr<std::string> httpHeaderData(new std::string());
-
-    // Hook up data handling function
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, httpData.get());
-    curl_easy_setopt(curl, CURLOPT_HEADERDATA, httpHeaderData.get());
-
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, body.length());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body_data);
-
-    res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-
-    // get cause from the response
-    std::string response           = *httpData.get();
-    std::string json_data_response = {};
-    std::string n1sm               = {};
-    std::string n2sm               = {};
-    nlohmann::json response_data   = {};
-    bstring n1sm_hex, n2sm_hex;
-
-    // clear input
-    n1sm_msg  = {};
-    n2sm_msg  = {};
-    json_data = {};
-
-    Logger::amf_n11().info("Get response with HTTP code (%d)", httpCode);
-    Logger::amf_n11().info("Response body %s", response.c_str());
-
-    response_code = httpCode;
-    if (static_cast<http_response_codes_e>(httpCode) ==
-        http_response_codes_e::HTTP_RESPONSE_CODE_0) {
-      // TODO: should be removed
-      Logger::amf_n11().error(
-          "Cannot get response when calling %s", remote_uri.c_str());
-      // free curl before returning
-      curl_slist_free_all(headers);
-      curl_easy_cleanup(curl);
-      curl_global_cleanup();
-      free_wrapper((void**) &body_data);
-      return;
-    }
-
-    if (response.size() > 0) {
-      number_parts = parser.parse(response, json_data_response, n1sm, n2sm);
-    }
-
-    if (number_parts == 0) {
-      json_data_response = response;
-    }
-
-    Logger::amf_n11().info("JSON part %s", json_data_response.c_str());
-
-    if ((static_cast<http_response_codes_e>(httpCode) !=
-         http_response_codes_e::HTTP_RESPONSE_CODE_200_OK) &&
-        (static_cast<http_response_codes_e>(httpCode) !=
-         http_response_codes_e::HTTP_RESPONSE_CODE_201_CREATED) &&
-        (static_cast<http_response_codes_e>(httpCode) !=
-         http_response_codes_e::HTTP_RESPONSE_CODE_204_NO_CONTENT)) {
-      // TODO:
-
-    } else {  // Response with success code
-
-      try {
-        response_data = nlohmann::json::parse(json_data_response);
-      } catch (nlohmann::json::exception& e) {
-        Logger::amf_n11().warn("Could not get JSON content from the response");
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        curl_global_cleanup();
-        free_wrapper((void**) &body_data);
-        // TODO:
-        return;
-      }
-
-      // Transfer N1/N2 to gNB/UE if available
-      if (number_parts > 1) {
-        if (n1sm.size() > 0) {
-          n1sm_msg = n1sm;
-        }
-        if (n2sm.size() > 0) {
-          n2sm_msg = n2sm;
-        }
-      }
-    }
-
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-  }
-
-  curl_global_cleanup();
-  free_wrapper((void**) &body_data);
+  sbi_client.send_request(
+      remote_uri, "POST", std::move(body), content_type, http_version,
+      std::move(handler));
 }
 
-//-----------------------------------------------------------------------------------------------------
-void amf_n11::curl_http_client(
+//------------------------------------------------------------------------------
+void amf_n11::send_sbi_request(
     const std::string& remote_uri, const std::string& method,
-    const std::string& msg_body, nlohmann::json& response_json,
-    uint32_t& response_code, const uint8_t& http_version) {
+    const std::string& msg_body, const uint8_t& http_version,
+    sbi_json_handler_t&& handler) {
   Logger::amf_n11().info("Send HTTP message to %s", remote_uri.c_str());
   Logger::amf_n11().info("HTTP message Body: %s", msg_body.c_str());
 
-  uint32_t str_len = msg_body.length();
-  char* body_data  = (char*) malloc(str_len + 1);
-  memset(body_data, 0, str_len + 1);
-  memcpy((void*) body_data, (void*) msg_body.c_str(), str_len);
-
-  curl_global_init(CURL_GLOBAL_ALL);
-  CURL* curl = curl_easy_init();
-
-  if (curl) {
-    CURLcode res               = {};
-    struct curl_slist* headers = nullptr;
-
-    std::string content_type = "Content-Type: application/json";
-    headers                  = curl_slist_append(headers, content_type.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_URL, remote_uri.c_str());
-
-    if (method.compare("POST") == 0)
-      curl_easy_setopt(curl, CURLOPT_HTTPPOST, 1);
-    else if (method.compare("PATCH") == 0)
-      curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PATCH");
-    else if (method.compare("PUT") == 0) {
-      curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-    } else  // GET
-      curl_easy_setopt(curl, CURLOPT_HTTPGET, 1);
-
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, CURL_TIMEOUT_MS);
-    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1);
-    curl_easy_setopt(curl, CURLOPT_INTERFACE, amf_cfg.n11.if_name.c_str());
-
-    if (http_version == 2) {
-      curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
-      // we use a self-signed test server, skip verification during debugging
-      curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-      curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-      curl_easy_setopt(
-          curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
-    }
-
-    // Response information.
-    long httpCode = {0};
-    std::unique_ptr<std::string> httpData(new std::string());
-    std::unique_ptr<std::string> httpHeaderData(new std::string());
-
-    // Hook up data handling function.
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, httpData.get());
-    curl_easy_setopt(curl, CURLOPT_HEADERDATA, httpHeaderData.get());
-    if ((method.compare("POST") == 0) or (method.compare("PATCH") == 0) or
-        (method.compare("PUT") == 0)) {
-      curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, msg_body.length());
-      curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body_data);
-    }
-
-    res = curl_easy_perform(curl);
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+  sbi_client.send_request(
+      remote_uri, method, std::string(msg_body), "application/json",
+      http_version,
+      [remote_uri, handler](sbi_response_t& response) {
+        nlohmann::json response_json = {};
+        json_from_response(remote_uri, response, response_json);
+        handler(response.http_code, response_json);
+      });
+}
 
-    // get the response
-    std::string response = *httpData.get();
-    std::string resMsg   = {};
-    bool is_response_ok  = true;
-    Logger::amf_n11().info("Get response with HTTP code (%d)", httpCode);
+//------------------------------------------------------------------------------
+// Get the NRF's URI from the NSI information of the NSSF
+static bool nrf_uri_from_nsi_information(
+    const uint32_t response_code, nlohmann::json& response_data,
+    std::string& nrf_uri) {
+  bool result = false;
 
-    response_code = httpCode;
+  Logger::amf_n11().debug(
+      "NS Selection, response from NSSF, json data: \n %s",
+      response_data.dump().c_str());
 
-    if (static_cast<http_response_codes_e>(httpCode) ==
-        http_response_codes_e::HTTP_RESPONSE_CODE_0) {
-      Logger::amf_n11().info(
-          "Cannot get response when calling %s", remote_uri.c_str());
-      // free curl before returning
-      curl_slist_free_all(headers);
-      curl_easy_cleanup(curl);
-      return;
-    }
+  if (response_code != 200) {
+    Logger::amf_n11().warn("NS Selection, could not get response from NSSF");
+    result = false;
+  } else {
+    // Process data to obtain NRF info
+    if (response_data.find("nsiInformation") != response_data.end()) {
+      if (response_data["nsiInformation"].count("nrfId") > 0) {
+        // nrf_uri =
+        // response_data["nsiInformation"]["nrfId"].get<std::string>();
+
+        // TODO: Should be remove when NSSF is updated with NRF Disc URI
+        std::string nrf_id =
+            response_data["nsiInformation"]["nrfId"].get<std::string>();
+        std::vector<std::string> split_result;
+        boost::split(split_result, nrf_id, boost::is_any_of("/"));
+        if (split_result.size() > 4) {
+          nrf_uri = split_result[2] + "/nnrf-disc/" + split_result[4] +
+                    "/nf-instances";
+        }
 
-    if ((static_cast<http_response_codes_e>(httpCode) !=
-         http_response_codes_e::HTTP_RESPONSE_CODE_200_OK) and
-        (static_cast<http_response_codes_e>(httpCode) !=
-         http_response_codes_e::HTTP_RESPONSE_CODE_201_CREATED) and
-        (static_cast<http_response_codes_e>(httpCode) !=
-         http_response_codes_e::HTTP_RESPONSE_CODE_204_NO_CONTENT)) {
-      is_response_ok = false;
-
-      if (response.size() < 1) {
-        Logger::amf_n11().info("There's no content in the response");
-        response_json = {};
-        return;
+        Logger::amf_n11().debug(
+            "NSI Information is successfully retrieved from NSSF");
+        Logger::amf_n11().debug("NS Selection, NRF's URI: %s", nrf_uri.c_str());
+        result = true;
       }
-    }
 
-    try {
-      response_json = nlohmann::json::parse(response);
-    } catch (nlohmann::json::exception& e) {
-      Logger::amf_n11().info("Could not get JSON content from the response");
-      response_json = {};
+      std::string nsi_id = {};
+      if (response_data["nsiInformation"].count("nsi_id") > 0)
+        nsi_id = response_data["nsiInformation"]["nsiId"].get<std::string>();
     }
-
-    Logger::amf_n11().info(
-        "Get response with Json content: %s", response_json.dump().c_str());
-
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
   }
 
-  curl_global_cleanup();
-
-  if (body_data) {
-    free(body_data);
-    body_data = NULL;
-  }
+  return result;
 }
 
 //------------------------------------------------------------------------------
-bool amf_n11::get_nrf_uri(
-    const snssai_t& snssai, const plmn_t& plmn, const std::string& dnn,
-    std::string& nrf_uri) {
+void amf_n11::get_nrf_uri(
+    std::shared_ptr<itti_n11_smf_selection_response>& selection) {
   if (!amf_cfg.support_features.enable_nrf_selection) {
     // Get NRF info from configuration file if available
     if (amf_cfg.support_features.enable_external_nrf) {
-      nrf_uri = amf_cfg.get_nrf_nf_discovery_service_uri();
-      return true;
+      discover_smf(selection, amf_cfg.get_nrf_nf_discovery_service_uri());
     } else {
       Logger::amf_n11().debug("No NRF information from the configuration file");
-      return false;
+      Logger::amf_n11().error("No NRF is available");
+      send_smf_selection_response(selection);
     }
+    return;
+  }
 
-  } else {  // Get NRF info from NSSF
-            // TODO: check if external NSSF feature is supported
-    Logger::amf_n11().debug(
-        "Send NS Selection to NSSF to discover the appropriate NRF");
-
-    bool result = false;
-
-    uint8_t http_version = 1;
-    if (amf_cfg.support_features.use_http2) http_version = 2;
-
-    // Get NSI information from NSSF
-    nlohmann::json slice_info  = {};
-    nlohmann::json snssai_info = {};
-    snssai_info["sst"]         = snssai.sST;
-    if (!snssai.sD.empty()) snssai_info["sd"] = snssai.sD;
-    slice_info["sNssai"]            = snssai_info;
-    slice_info["roamingIndication"] = "NON_ROAMING";
-    // ToDo Add TAI
-
-    std::string nssf_url =
-        amf_cfg.get_nssf_network_slice_selection_information_uri();
-
-    std::string parameters = {};
-    parameters = "?nf-type=AMF&nf-id=" + amf_app_inst->get_nf_instance() +
-                 "&slice-info-request-for-pdu-session=" + slice_info.dump();
-    nssf_url += parameters;
+  // Get NRF info from NSSF
+  // TODO: check if external NSSF feature is supported
+  Logger::amf_n11().debug(
+      "Send NS Selection to NSSF to discover the appropriate NRF");
 
-    Logger::amf_n11().debug(
-        "Send Network Slice Information Retrieval during PDU session "
-        "establishment procedure, URL %s",
-        nssf_url.c_str());
+  uint8_t http_version = 1;
+  if (amf_cfg.support_features.use_http2) http_version = 2;
 
-    nlohmann::json response_data = {};
-    uint32_t response_code       = 0;
-    curl_http_client(
-        nssf_url, "GET", "", response_data, response_code, http_version);
+  // Get NSI information from NSSF
+  const snssai_t& snssai     = selection->request->snssai;
+  nlohmann::json slice_info  = {};
+  nlohmann::json snssai_info = {};
+  snssai_info["sst"]         = snssai.sST;
+  if (!snssai.sD.empty()) snssai_info["sd"] = snssai.sD;
+  slice_info["sNssai"]            = snssai_info;
+  slice_info["roamingIndication"] = "NON_ROAMING";
+  // ToDo Add TAI
 
-    Logger::amf_n11().debug(
-        "NS Selection, response from NSSF, json data: \n %s",
-        response_data.dump().c_str());
+  std::string nssf_url =
+      amf_cfg.get_nssf_network_slice_selection_information_uri();
 
-    if (response_code != 200) {
-      Logger::amf_n11().warn("NS Selection, could not get response from NSSF");
-      result = false;
-    } else {
-      // Process data to obtain NRF info
-      if (response_data.find("nsiInformation") != response_data.end()) {
-        if (response_data["nsiInformation"].count("nrfId") > 0) {
-          // nrf_uri =
-          // response_data["nsiInformation"]["nrfId"].get<std::string>();
-
-          // TODO: Should be remove when NSSF is updated with NRF Disc URI
-          std::string nrf_id =
-              response_data["nsiInformation"]["nrfId"].get<std::string>();
-          std::vector<std::string> split_result;
-          boost::split(split_result, nrf_id, boost::is_any_of("/"));
-          if (split_result.size() > 4) {
-            nrf_uri = split_result[2] + "/nnrf-disc/" + split_result[4] +
-                      "/nf-instances";
-          }
+  std::string parameters = {};
+  parameters = "?nf-type=AMF&nf-id=" + amf_app_inst->get_nf_instance() +
+               "&slice-info-request-for-pdu-session=" + slice_info.dump();
+  nssf_url += parameters;
 
-          Logger::amf_n11().debug(
-              "NSI Information is successfully retrieved from NSSF");
-          Logger::amf_n11().debug(
-              "NS Selection, NRF's URI: %s", nrf_uri.c_str());
-          result = true;
+  Logger::amf_n11().debug(
+      "Send Network Slice Information Retrieval during PDU session "
+      "establishment procedure, URL %s",
+      nssf_url.c_str());
+
+  send_sbi_request(
+      nssf_url, "GET", "", http_version,
+      [this, selection](
+          const uint32_t response_code, nlohmann::json& response_data) mutable {
+        std::string nrf_uri = {};
+        if (!nrf_uri_from_nsi_information(
+                response_code, response_data, nrf_uri)) {
+          Logger::amf_n11().error("No NRF is available");
+          send_smf_selection_response(selection);
+          return;
         }
-
-        std::string nsi_id = {};
-        if (response_data["nsiInformation"].count("nsi_id") > 0)
-          nsi_id = response_data["nsiInformation"]["nsiId"].get<std::string>();
-      }
-    }
-
-    return result;
-  }
-  return true;
+        Logger::amf_n11().debug("NRF NF Discover URI: %s", nrf_uri.c_str());
+        // use NRF to find suitable SMF based on snssai, plmn and dnn
+        discover_smf(selection, nrf_uri);
+      });
 }
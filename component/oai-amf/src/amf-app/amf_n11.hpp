@@ -29,12 +29,14 @@
 #ifndef _AMF_N11_H_
 #define _AMF_N11_H_
 
+#include <functional>
 #include <map>
 #include <shared_mutex>
 #include <string>
 
 #include "AuthenticationInfo.h"
 #include "UEAuthenticationCtx.h"
+#include "amf_sbi_client.hpp"
 #include "itti_msg_n11.hpp"
 #include "itti_msg_sbi.hpp"
 #include "pdu_session_context.hpp"
@@ -45,6 +47,12 @@
 
 namespace amf_application {
 
+// Called on the SBI client thread with the HTTP code (0 if no response was
+// received) and the JSON body of the response
+typedef std::function<void(
+    const uint32_t response_code, nlohmann::json& response_json)>
+    sbi_json_handler_t;
+
 class amf_n11 {
  public:
   amf_n11();
@@ -52,11 +60,22 @@ class amf_n11 {
 
   /*
    * Handle ITTI message (Nsmf_PDUSessionCreateSMContext) to create a new PDU
-   * Session SM context
-   * @param [itti_nsmf_pdusession_create_sm_context&]: ITTI message
+   * Session SM context. With the SMF selection, the request is sent once the
+   * SMF is discovered
+   * @param [std::shared_ptr<itti_nsmf_pdusession_create_sm_context>&]: ITTI
+   * message
    * @return void
    */
-  void handle_itti_message(itti_nsmf_pdusession_create_sm_context&);
+  void handle_itti_message(
+      std::shared_ptr<itti_nsmf_pdusession_create_sm_context>& smf);
+
+  /*
+   * Handle ITTI message (SMF discovered from the NSSF/NRF) to go on with the
+   * PDU Session SM context creation
+   * @param [itti_n11_smf_selection_response&]: ITTI message
+   * @return void
+   */
+  void handle_itti_message(itti_n11_smf_selection_response& selection);
 
   /*
    * Handle ITTI message (Nsmf_PDUSessionUpdateSMContext) to update a PDU
@@ -74,6 +93,14 @@ class amf_n11 {
    */
   void handle_itti_message(itti_nsmf_pdusession_release_sm_context& itti_msg);
 
+  /*
+   * Handle ITTI message (response of SMF to a request sent with
+   * curl_http_client)
+   * @param [itti_nsmf_pdusession_sm_context_response&]: ITTI message
+   * @return void
+   */
+  void handle_itti_message(itti_nsmf_pdusession_sm_context_response& itti_msg);
+
   /*
    * Handle ITTI message (receiving PDU Session Resource Setup Response)
    * @param [itti_pdu_session_resource_setup_response&]: ITTI message
@@ -183,49 +210,53 @@ class amf_n11 {
       std::string& smf_api_version);
 
   /*
-   * Find suitable SMF from NRF (based on snssai, plmn and dnn)
-   * @param [std::string&] smf_addr: SMF's Address
-   * @param [std::string&] smf_port: SMF's HTTP port
-   * @param [std::string&] smf_api_version: SMF's API version
-   * @param [const snssai_t&] snssai: SNSSAI
-   * @param [const plmn_t&] plmn: PLMN
-   * @param [const std::string&] dnn: DNN
+   * Send the PDU Session SM context request to the SMF of the PDU session
+   * @param [itti_nsmf_pdusession_create_sm_context&] smf: ITTI message
+   * @param [const std::string&] supi: SUPI
+   * @param [std::shared_ptr<pdu_session_context>&] psc: Pointer to the PDU
+   * Session Context
+   * @return void
+   */
+  void send_pdu_session_sm_context_request(
+      itti_nsmf_pdusession_create_sm_context& smf, const std::string& supi,
+      std::shared_ptr<pdu_session_context>& psc);
+
+  /*
+   * Find suitable SMF from NRF (based on snssai, plmn and dnn), the selection
+   * is sent to TASK_AMF_N11 once done
+   * @param [std::shared_ptr<itti_n11_smf_selection_response>&] selection:
+   * SMF selection of the PDU session
    * @param [const std::string&] nrf_uri: NRF's NF Discovery Service URI
-   * @return true if successful, otherwise return false
+   * @return void
    */
-  bool discover_smf(
-      std::string& smf_addr, std::string& smf_port,
-      std::string& smf_api_version, const snssai_t& snssai, const plmn_t& plmn,
-      const std::string& dnn, const std::string& nrf_uri = {});
+  void discover_smf(
+      std::shared_ptr<itti_n11_smf_selection_response>& selection,
+      const std::string& nrf_uri = {});
 
   /*
    * Send UE Authentication Request to AUSF
    * @param [const oai::amf::model::AuthenticationInfo&] auth_info:
    * Authentication Information
-   * @param [oai::amf::model::UEAuthenticationCtx& ] ue_auth_ctx: UE
-   * Authentication Context response
    * @param [const uint8_t] http_version: HTTP versioin
-   * @return true if successful, otherwise return false
+   * @param [sbi_json_handler_t&&] handler: called with the UE Authentication
+   * Context response
+   * @return void
    */
-  bool send_ue_authentication_request(
+  void send_ue_authentication_request(
       const oai::amf::model::AuthenticationInfo& auth_info,
-      oai::amf::model::UEAuthenticationCtx& ue_auth_ctx,
-      const uint8_t& http_version);
+      const uint8_t& http_version, sbi_json_handler_t&& handler);
 
   /*
-   * Get NRF's URI from NSSF/configuration file
-   * @param [const snssai_t&] snssai: SNSSAI
-   * @param [const plmn_t&] plmn: PLMN
-   * @param [const std::string&] dnn: DNN
-   * @param [std::string&] nrf_uri: NRF's NF Discovery Service URI
-   * @return true if successful, otherwise return false
+   * Get NRF's URI from NSSF/configuration file, then discover the SMF
+   * @param [std::shared_ptr<itti_n11_smf_selection_response>&] selection:
+   * SMF selection of the PDU session
+   * @return void
    */
-  bool get_nrf_uri(
-      const snssai_t& snssai, const plmn_t& plmn, const std::string& dnn,
-      std::string& nrf_uri);
+  void get_nrf_uri(std::shared_ptr<itti_n11_smf_selection_response>& selection);
 
   /*
-   * CURL client to send request to the HTTP server
+   * Send request to SMF, the response is handled by TASK_AMF_N11 once
+   * received (itti_nsmf_pdusession_sm_context_response)
    * @param [const std::string&] remote_uri: Server's Address
    * @param [const std::string&] json_data: Json data (msg body)
    * @param [const std::string&] n1sm_msg: N1 SM message
@@ -243,35 +274,38 @@ class amf_n11 {
       const uint8_t& http_version = 1, const uint32_t& promise_id = 0);
 
   /*
-   * CURL client to send request to the HTTP server
+   * Send request to the HTTP server without waiting for the response
    * @param [const std::string&] remote_uri: Server's Address
    * @param [const std::string&] method: HTTP method
    * @param [const std::string&] msg_body: Msg body
-   * @param [std::string&] response_json: Respone in Json format
-   * @param [uint32_t&] response_code: HTTP Response code
    * @param [const uint8_t&] http_version: HTTP versioin
+   * @param [sbi_json_handler_t&&] handler: called with the response
    * @return void
    */
-  void curl_http_client(
+  void send_sbi_request(
       const std::string& remote_uri, const std::string& method,
-      const std::string& msg_body, nlohmann::json& response_json,
-      uint32_t& response_code, const uint8_t& http_version = 1);
+      const std::string& msg_body, const uint8_t& http_version,
+      sbi_json_handler_t&& handler);
 
   /*
-   * CURL client to send request to the HTTP server
+   * Send a multipart request (JSON data, N1/N2 SM messages) to the HTTP server
+   * without waiting for the response
    * @param [const std::string&] remote_uri: Server's Address
-   * @param [std::string&] json_data: Msg body
-   * @param [std::string&] n1sm_msg: N1 SM message
-   * @param [std::string&] n2sm_msg: N2 SM message
+   * @param [const std::string&] json_data: Json data (msg body)
+   * @param [const std::string&] n1sm_msg: N1 SM message
+   * @param [const std::string&] n2sm_msg: N2 SM message
    * @param [const uint8_t&] http_version: HTTP versioin
-   * @param [uint32_t&] response_code: HTTP Response code
-   * @param [const uint32_t&] promise_id: Promise ID
+   * @param [sbi_response_handler_t&&] handler: called with the response
    * @return void
    */
-  void curl_http_client(
-      const std::string& remote_uri, std::string& json_data,
-      std::string& n1sm_msg, std::string& n2sm_msg, const uint8_t& http_version,
-      uint32_t& response_code, const uint32_t& promise_id = 0);
+  void send_sbi_request(
+      const std::string& remote_uri, const std::string& json_data,
+      const std::string& n1sm_msg, const std::string& n2sm_msg,
+      const uint8_t& http_version, sbi_response_handler_t&& handler);
+
+ private:
+  // Shared by all the N11 requests, keeps the connections to the other NFs
+  amf_sbi_client sbi_client;
 };
 
 }  // namespace amf_application
@@ -53,6 +53,7 @@
 #include "comUt.hpp"
 #include "itti.hpp"
 #include "itti_msg_amf_app.hpp"
+#include "itti_workers.hpp"
 #include "logger.hpp"
 #include "sctp_server.hpp"
 #include "3gpp_24.501.h"
@@ -80,154 +81,254 @@ extern statistics stacs;
 
 void amf_n2_task(void*);
 
+//------------------------------------------------------------------------------
+static void amf_n2_handle_msg(itti_msg* msg) {
+  switch (msg->msg_type) {
+    case NEW_SCTP_ASSOCIATION: {
+      Logger::amf_n2().info("Received new SCTP_ASSOCIATION");
+      itti_new_sctp_association* m =
+          dynamic_cast<itti_new_sctp_association*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case NG_SETUP_REQ: {
+      Logger::amf_n2().info("Received NGSetupRequest message, handling");
+      itti_ng_setup_request* m = dynamic_cast<itti_ng_setup_request*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case NG_RESET: {
+      Logger::amf_n2().info("Received NGReset message, handling");
+      itti_ng_reset* m = dynamic_cast<itti_ng_reset*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case NG_SHUTDOWN: {
+      Logger::amf_n2().info("Received SCTP Shutdown Event, handling");
+      itti_ng_shutdown* m = dynamic_cast<itti_ng_shutdown*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case INITIAL_UE_MSG: {
+      Logger::amf_n2().info("Received INITIAL_UE_MESSAGE message, handling");
+      itti_initial_ue_message* m = dynamic_cast<itti_initial_ue_message*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case ITTI_UL_NAS_TRANSPORT: {
+      Logger::amf_n2().info("Received UPLINK_NAS_TRANSPORT message, handling");
+      itti_ul_nas_transport* m = dynamic_cast<itti_ul_nas_transport*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case ITTI_DL_NAS_TRANSPORT: {
+      Logger::amf_n2().info("Encoding DOWNLINK NAS TRANSPORT message, sending");
+      itti_dl_nas_transport* m = dynamic_cast<itti_dl_nas_transport*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case PDU_SESSION_RESOURCE_SETUP_REQUEST: {
+      Logger::amf_n2().info(
+          "Encoding PDU SESSION RESOURCE SETUP REQUEST message, sending");
+      itti_pdu_session_resource_setup_request* m =
+          dynamic_cast<itti_pdu_session_resource_setup_request*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case PDU_SESSION_RESOURCE_MODIFY_REQUEST: {
+      Logger::amf_n2().info(
+          "Received PDU_SESSION_RESOURCE_MODIFY_REQUEST message, handling");
+      itti_pdu_session_resource_modify_request* m =
+          dynamic_cast<itti_pdu_session_resource_modify_request*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case INITIAL_CONTEXT_SETUP_REQUEST: {
+      Logger::amf_n2().info(
+          "Encoding INITIAL CONTEXT SETUP REQUEST message, sending");
+      itti_initial_context_setup_request* m =
+          dynamic_cast<itti_initial_context_setup_request*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case UE_CONTEXT_RELEASE_REQUEST: {
+      Logger::amf_n2().info(
+          "Received UE_CONTEXT_RELEASE_REQUEST message, handling");
+      itti_ue_context_release_request* m =
+          dynamic_cast<itti_ue_context_release_request*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case UE_CONTEXT_RELEASE_COMMAND: {
+      Logger::amf_n2().info(
+          "Received UE_CONTEXT_RELEASE_COMMAND message, handling");
+      itti_ue_context_release_command* m =
+          dynamic_cast<itti_ue_context_release_command*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case UE_CONTEXT_RELEASE_COMPLETE: {
+      Logger::amf_n2().info(
+          "Received UE_CONTEXT_RELEASE_COMPLETE message, handling");
+      itti_ue_context_release_complete* m =
+          dynamic_cast<itti_ue_context_release_complete*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case PDU_SESSION_RESOURCE_RELEASE_COMMAND: {
+      Logger::amf_n2().info(
+          "Received PDU_SESSION_RESOURCE_RELEASE_COMMAND message, handling");
+      itti_pdu_session_resource_release_command* m =
+          dynamic_cast<itti_pdu_session_resource_release_command*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case UE_RADIO_CAP_IND: {
+      Logger::amf_n2().info("Received UE_RADIO_CAP_IND message, handling");
+      itti_ue_radio_capability_indication* m =
+          dynamic_cast<itti_ue_radio_capability_indication*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case HANDOVER_REQUIRED: {
+      Logger::amf_n2().info("Received HANDOVER_REQUIRED message, handling");
+      itti_handover_required* m = dynamic_cast<itti_handover_required*>(msg);
+      if (!amf_n2_inst->handle_itti_message(ref(*m)))
+        amf_n2_inst->send_handover_preparation_failure(
+            m->handoverReq->getAmfUeNgapId(),
+            m->handoverReq->getRanUeNgapId(), m->assoc_id);
+    } break;
+    case HANDOVER_REQUEST_ACK: {
+      Logger::amf_n2().info("Received HANDOVER_REQUEST_ACK message, handling");
+      itti_handover_request_Ack* m =
+          dynamic_cast<itti_handover_request_Ack*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case HANDOVER_NOTIFY: {
+      Logger::amf_n2().info("Received HANDOVER_NOTIFY message, handling");
+      itti_handover_notify* m = dynamic_cast<itti_handover_notify*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case UPLINK_RAN_STATUS_TRANSFER: {
+      Logger::amf_n2().info(
+          "Received UPLINK_RAN_STATUS_TRANSFER message, handling");
+      itti_uplink_ran_status_transfer* m =
+          dynamic_cast<itti_uplink_ran_status_transfer*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case PAGING: {
+      Logger::amf_n2().info("Received Paging message, handling");
+      itti_paging* m = dynamic_cast<itti_paging*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    case REROUTE_NAS_REQ: {
+      Logger::amf_n2().info("Received Reroute NAS Req message, handling");
+      itti_rereoute_nas* m = dynamic_cast<itti_rereoute_nas*>(msg);
+      amf_n2_inst->handle_itti_message(ref(*m));
+    } break;
+    default:
+      Logger::amf_n2().info("No handler for msg type %d", msg->msg_type);
+  }
+}
+
+//------------------------------------------------------------------------------
+// A RAN UE NGAP ID is only unique within its gNB: the key of a UE is its
+// (gNB association, RAN UE NGAP ID), folded so that the worker, chosen by the
+// low bits, depends on both
+static uint64_t amf_n2_ue_key(
+    const sctp_assoc_id_t& assoc_id, const uint32_t& ran_ue_ngap_id) {
+  const uint64_t k = ((uint64_t) (uint32_t) assoc_id << 32) | ran_ue_ngap_id;
+  return k ^ (k >> 32);
+}
+
+//------------------------------------------------------------------------------
+// The messages from the other tasks do not know the gNB, get it from the UE
+// NGAP context (unknown UE: any key, the handler drops the message)
+static uint64_t amf_n2_core_ue_key(
+    const long& amf_ue_ngap_id, const uint32_t& ran_ue_ngap_id) {
+  std::shared_ptr<ue_ngap_context> unc =
+      amf_n2_inst->ue_ids_2_ue_ngap_context(amf_ue_ngap_id, ran_ue_ngap_id);
+  return amf_n2_ue_key(unc ? unc->gnb_assoc_id : 0, ran_ue_ngap_id);
+}
+
+//------------------------------------------------------------------------------
+// UE associated messages are ordered by UE, known by its RAN UE NGAP ID in its
+// gNB from the Initial UE Message on. Return false for the messages of a gNB
+// (NG Setup, NG Reset...) and of the handover, that involves 2 gNBs: they are
+// handled while no UE message is.
+static bool amf_n2_get_ue_key(itti_msg* msg, uint64_t& key) {
+  switch (msg->msg_type) {
+    case INITIAL_UE_MSG: {
+      itti_initial_ue_message* m = dynamic_cast<itti_initial_ue_message*>(msg);
+      uint32_t ran_ue_ngap_id    = 0;
+      if (!m->initUeMsg->getRanUENgapID(ran_ue_ngap_id)) return false;
+      key = amf_n2_ue_key(m->assoc_id, ran_ue_ngap_id);
+    } break;
+    case ITTI_UL_NAS_TRANSPORT: {
+      itti_ul_nas_transport* m = dynamic_cast<itti_ul_nas_transport*>(msg);
+      key = amf_n2_ue_key(m->assoc_id, m->ulNas->getRanUeNgapId());
+    } break;
+    case UE_CONTEXT_RELEASE_REQUEST: {
+      itti_ue_context_release_request* m =
+          dynamic_cast<itti_ue_context_release_request*>(msg);
+      key = amf_n2_ue_key(m->assoc_id, m->ueCtxRel->getRanUeNgapId());
+    } break;
+    case UE_CONTEXT_RELEASE_COMPLETE: {
+      itti_ue_context_release_complete* m =
+          dynamic_cast<itti_ue_context_release_complete*>(msg);
+      key = amf_n2_ue_key(m->assoc_id, m->ueCtxRelCmpl->getRanUeNgapId());
+    } break;
+    case UE_RADIO_CAP_IND: {
+      itti_ue_radio_capability_indication* m =
+          dynamic_cast<itti_ue_radio_capability_indication*>(msg);
+      key = amf_n2_ue_key(m->assoc_id, m->ueRadioCap->getRanUeNgapId());
+    } break;
+    case ITTI_DL_NAS_TRANSPORT: {
+      itti_dl_nas_transport* m = dynamic_cast<itti_dl_nas_transport*>(msg);
+      key = amf_n2_core_ue_key(m->amf_ue_ngap_id, m->ran_ue_ngap_id);
+    } break;
+    case PDU_SESSION_RESOURCE_SETUP_REQUEST: {
+      itti_pdu_session_resource_setup_request* m =
+          dynamic_cast<itti_pdu_session_resource_setup_request*>(msg);
+      key = amf_n2_core_ue_key(m->amf_ue_ngap_id, m->ran_ue_ngap_id);
+    } break;
+    case PDU_SESSION_RESOURCE_MODIFY_REQUEST: {
+      itti_pdu_session_resource_modify_request* m =
+          dynamic_cast<itti_pdu_session_resource_modify_request*>(msg);
+      key = amf_n2_core_ue_key(m->amf_ue_ngap_id, m->ran_ue_ngap_id);
+    } break;
+    case PDU_SESSION_RESOURCE_RELEASE_COMMAND: {
+      itti_pdu_session_resource_release_command* m =
+          dynamic_cast<itti_pdu_session_resource_release_command*>(msg);
+      key = amf_n2_core_ue_key(m->amf_ue_ngap_id, m->ran_ue_ngap_id);
+    } break;
+    case INITIAL_CONTEXT_SETUP_REQUEST: {
+      itti_initial_context_setup_request* m =
+          dynamic_cast<itti_initial_context_setup_request*>(msg);
+      key = amf_n2_core_ue_key(m->amf_ue_ngap_id, m->ran_ue_ngap_id);
+    } break;
+    case UE_CONTEXT_RELEASE_COMMAND: {
+      itti_ue_context_release_command* m =
+          dynamic_cast<itti_ue_context_release_command*>(msg);
+      key = amf_n2_core_ue_key(m->amf_ue_ngap_id, m->ran_ue_ngap_id);
+    } break;
+    case PAGING: {
+      itti_paging* m = dynamic_cast<itti_paging*>(msg);
+      key = amf_n2_core_ue_key(m->amf_ue_ngap_id, m->ran_ue_ngap_id);
+    } break;
+    case REROUTE_NAS_REQ: {
+      itti_rereoute_nas* m = dynamic_cast<itti_rereoute_nas*>(msg);
+      key = amf_n2_core_ue_key(m->amf_ue_ngap_id, m->ran_ue_ngap_id);
+    } break;
+    default:
+      return false;
+  }
+  return true;
+}
+
 //------------------------------------------------------------------------------
 void amf_n2_task(void* args_p) {
   const task_id_t task_id = TASK_AMF_N2;
+  itti_workers workers(task_id, AMF_N1_N2_WORKERS, amf_n2_handle_msg);
   itti_inst->notify_task_ready(task_id);
   do {
     std::shared_ptr<itti_msg> shared_msg = itti_inst->receive_msg(task_id);
     auto* msg                            = shared_msg.get();
-    switch (msg->msg_type) {
-      case NEW_SCTP_ASSOCIATION: {
-        Logger::amf_n2().info("Received new SCTP_ASSOCIATION");
-        itti_new_sctp_association* m =
-            dynamic_cast<itti_new_sctp_association*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case NG_SETUP_REQ: {
-        Logger::amf_n2().info("Received NGSetupRequest message, handling");
-        itti_ng_setup_request* m = dynamic_cast<itti_ng_setup_request*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case NG_RESET: {
-        Logger::amf_n2().info("Received NGReset message, handling");
-        itti_ng_reset* m = dynamic_cast<itti_ng_reset*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case NG_SHUTDOWN: {
-        Logger::amf_n2().info("Received SCTP Shutdown Event, handling");
-        itti_ng_shutdown* m = dynamic_cast<itti_ng_shutdown*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case INITIAL_UE_MSG: {
-        Logger::amf_n2().info("Received INITIAL_UE_MESSAGE message, handling");
-        itti_initial_ue_message* m =
-            dynamic_cast<itti_initial_ue_message*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case ITTI_UL_NAS_TRANSPORT: {
-        Logger::amf_n2().info(
-            "Received UPLINK_NAS_TRANSPORT message, handling");
-        itti_ul_nas_transport* m = dynamic_cast<itti_ul_nas_transport*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case ITTI_DL_NAS_TRANSPORT: {
-        Logger::amf_n2().info(
-            "Encoding DOWNLINK NAS TRANSPORT message, sending");
-        itti_dl_nas_transport* m = dynamic_cast<itti_dl_nas_transport*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case PDU_SESSION_RESOURCE_SETUP_REQUEST: {
-        Logger::amf_n2().info(
-            "Encoding PDU SESSION RESOURCE SETUP REQUEST message, sending");
-        itti_pdu_session_resource_setup_request* m =
-            dynamic_cast<itti_pdu_session_resource_setup_request*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case PDU_SESSION_RESOURCE_MODIFY_REQUEST: {
-        Logger::amf_n2().info(
-            "Received PDU_SESSION_RESOURCE_MODIFY_REQUEST message, handling");
-        itti_pdu_session_resource_modify_request* m =
-            dynamic_cast<itti_pdu_session_resource_modify_request*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case INITIAL_CONTEXT_SETUP_REQUEST: {
-        Logger::amf_n2().info(
-            "Encoding INITIAL CONTEXT SETUP REQUEST message, sending");
-        itti_initial_context_setup_request* m =
-            dynamic_cast<itti_initial_context_setup_request*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case UE_CONTEXT_RELEASE_REQUEST: {
-        Logger::amf_n2().info(
-            "Received UE_CONTEXT_RELEASE_REQUEST message, handling");
-        itti_ue_context_release_request* m =
-            dynamic_cast<itti_ue_context_release_request*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case UE_CONTEXT_RELEASE_COMMAND: {
-        Logger::amf_n2().info(
-            "Received UE_CONTEXT_RELEASE_COMMAND message, handling");
-        itti_ue_context_release_command* m =
-            dynamic_cast<itti_ue_context_release_command*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case UE_CONTEXT_RELEASE_COMPLETE: {
-        Logger::amf_n2().info(
-            "Received UE_CONTEXT_RELEASE_COMPLETE message, handling");
-        itti_ue_context_release_complete* m =
-            dynamic_cast<itti_ue_context_release_complete*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case PDU_SESSION_RESOURCE_RELEASE_COMMAND: {
-        Logger::amf_n2().info(
-            "Received PDU_SESSION_RESOURCE_RELEASE_COMMAND message, handling");
-        itti_pdu_session_resource_release_command* m =
-            dynamic_cast<itti_pdu_session_resource_release_command*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case UE_RADIO_CAP_IND: {
-        Logger::amf_n2().info("Received UE_RADIO_CAP_IND message, handling");
-        itti_ue_radio_capability_indication* m =
-            dynamic_cast<itti_ue_radio_capability_indication*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case HANDOVER_REQUIRED: {
-        Logger::amf_n2().info("Received HANDOVER_REQUIRED message, handling");
-        itti_handover_required* m = dynamic_cast<itti_handover_required*>(msg);
-        if (!amf_n2_inst->handle_itti_message(ref(*m)))
-          amf_n2_inst->send_handover_preparation_failure(
-              m->handoverReq->getAmfUeNgapId(),
-              m->handoverReq->getRanUeNgapId(), m->assoc_id);
-      } break;
-      case HANDOVER_REQUEST_ACK: {
-        Logger::amf_n2().info(
-            "Received HANDOVER_REQUEST_ACK message, handling");
-        itti_handover_request_Ack* m =
-            dynamic_cast<itti_handover_request_Ack*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case HANDOVER_NOTIFY: {
-        Logger::amf_n2().info("Received HANDOVER_NOTIFY message, handling");
-        itti_handover_notify* m = dynamic_cast<itti_handover_notify*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case UPLINK_RAN_STATUS_TRANSFER: {
-        Logger::amf_n2().info(
-            "Received UPLINK_RAN_STATUS_TRANSFER message, handling");
-        itti_uplink_ran_status_transfer* m =
-            dynamic_cast<itti_uplink_ran_status_transfer*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case PAGING: {
-        Logger::amf_n2().info("Received Paging message, handling");
-        itti_paging* m = dynamic_cast<itti_paging*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case REROUTE_NAS_REQ: {
-        Logger::amf_n2().info("Received Reroute NAS Req message, handling");
-        itti_rereoute_nas* m = dynamic_cast<itti_rereoute_nas*>(msg);
-        amf_n2_inst->handle_itti_message(ref(*m));
-      } break;
-      case TERMINATE: {
-        if (itti_msg_terminate* terminate =
-                dynamic_cast<itti_msg_terminate*>(msg)) {
-          Logger::amf_n2().info("Received terminate message");
-          return;
-        }
-      } break;
-      default:
-        Logger::amf_n2().info("No handler for msg type %d", msg->msg_type);
+    uint64_t key                         = 0;
+
+    if (msg->msg_type == TERMINATE) {
+      Logger::amf_n2().info("Received terminate message");
+      workers.terminate();
+      return;
+    } else if (amf_n2_get_ue_key(msg, key)) {
+      workers.dispatch(key, shared_msg);
+    } else {
+      workers.dispatch_all(shared_msg);
     }
   } while (true);
 }
@@ -249,24 +350,17 @@ amf_n2::~amf_n2() {}
 void amf_n2::handle_itti_message(itti_paging& itti_msg) {
   Logger::amf_n2().debug("Handle Paging message...");
 
-  std::shared_ptr<ue_ngap_context> unc = {};
-
-  if (!is_ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id)) {
+  // RAN UE NGAP ID of the UE (with the AMF UE NGAP ID)
+  std::shared_ptr<ue_ngap_context> unc = ue_ids_2_ue_ngap_context(
+      itti_msg.amf_ue_ngap_id, itti_msg.ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
-        "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
-        itti_msg.ran_ue_ngap_id);
+        "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT
+        ") and amf_ue_ngap_id (" AMF_UE_NGAP_ID_FMT ")",
+        itti_msg.ran_ue_ngap_id, itti_msg.amf_ue_ngap_id);
     return;
   }
 
-  unc = ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id);
-  if (unc.get()->amf_ue_ngap_id != itti_msg.amf_ue_ngap_id) {
-    Logger::amf_n2().error(
-        "The requested UE (amf_ue_ngap_id: " AMF_UE_NGAP_ID_FMT
-        ") is not valid, existed UE "
-        "which's amf_ue_ngap_id (" AMF_UE_NGAP_ID_FMT ")",
-        itti_msg.amf_ue_ngap_id, unc.get()->amf_ue_ngap_id);
-  }
-
   // TODO: check UE reachability status
 
   // get NAS context
@@ -503,9 +597,10 @@ void amf_n2::handle_itti_message(itti_ng_reset& itti_msg) {
     std::vector<std::shared_ptr<ue_ngap_context>> ue_contexts;
     get_ue_ngap_contexts(itti_msg.assoc_id, ue_contexts);
 
+    // NAS and NGAP contexts
     for (auto ue_context : ue_contexts) {
-      remove_ue_context_with_amf_ue_ngap_id(ue_context->amf_ue_ngap_id);
-      remove_ue_context_with_ran_ue_ngap_id(ue_context->ran_ue_ngap_id);
+      remove_ue_context_with_ran_ue_ngap_id(
+          itti_msg.assoc_id, ue_context->ran_ue_ngap_id);
     }
 
     stacs.display();
@@ -520,7 +615,8 @@ void amf_n2::handle_itti_message(itti_ng_reset& itti_msg) {
       if (ue.getAmfUeNgapId(amf_ue_ngap_id)) {
         remove_ue_context_with_amf_ue_ngap_id(amf_ue_ngap_id);
       } else if (ue.getRanUeNgapId(ran_ue_ngap_id)) {
-        remove_ue_context_with_ran_ue_ngap_id(ran_ue_ngap_id);
+        remove_ue_context_with_ran_ue_ngap_id(
+            itti_msg.assoc_id, ran_ue_ngap_id);
       }
     }
   }
@@ -565,9 +661,10 @@ void amf_n2::handle_itti_message(itti_ng_shutdown& itti_msg) {
   std::vector<std::shared_ptr<ue_ngap_context>> ue_contexts;
   get_ue_ngap_contexts(itti_msg.assoc_id, ue_contexts);
 
+  // NAS and NGAP contexts
   for (auto ue_context : ue_contexts) {
-    remove_ue_context_with_amf_ue_ngap_id(ue_context->amf_ue_ngap_id);
-    remove_ue_context_with_ran_ue_ngap_id(ue_context->ran_ue_ngap_id);
+    remove_ue_context_with_ran_ue_ngap_id(
+        itti_msg.assoc_id, ue_context->ran_ue_ngap_id);
   }
 
   // Delete gNB context
@@ -629,15 +726,16 @@ void amf_n2::handle_itti_message(itti_initial_ue_message& init_ue_msg) {
     return;
   }
 
-  std::shared_ptr<ue_ngap_context> unc = {};
-  if (!is_ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc =
+      ran_ue_id_2_ue_ngap_context(init_ue_msg.assoc_id, ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().debug(
         "Create a new UE NGAP context with ran_ue_ngap_id " GNB_UE_NGAP_ID_FMT,
         ran_ue_ngap_id);
     unc = std::shared_ptr<ue_ngap_context>(new ue_ngap_context());
-    set_ran_ue_ngap_id_2_ue_ngap_context(ran_ue_ngap_id, unc);
-  } else {
-    unc = ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id);
+    unc.get()->ran_ue_ngap_id = ran_ue_ngap_id;
+    unc.get()->gnb_assoc_id   = init_ue_msg.assoc_id;
+    set_ran_ue_ngap_id_2_ue_ngap_context(unc);
   }
 
   if (unc.get() == nullptr) {
@@ -725,6 +823,7 @@ void amf_n2::handle_itti_message(itti_initial_ue_message& init_ue_msg) {
 
   itti_msg->ran_ue_ngap_id = ran_ue_ngap_id;
   itti_msg->amf_ue_ngap_id = -1;
+  itti_msg->gnb_assoc_id   = init_ue_msg.assoc_id;
 
   int ret = itti_inst->send_msg(itti_msg);
   if (0 != ret) {
@@ -754,8 +853,9 @@ void amf_n2::handle_itti_message(itti_ul_nas_transport& ul_nas_transport) {
     return;
   }
 
-  std::shared_ptr<ue_ngap_context> unc = {};
-  if (!is_ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc =
+      ran_ue_id_2_ue_ngap_context(ul_nas_transport.assoc_id, ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
         "UE with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT
         ") is not attached to gnb with assoc_id "
@@ -763,8 +863,6 @@ void amf_n2::handle_itti_message(itti_ul_nas_transport& ul_nas_transport) {
         ran_ue_ngap_id, ul_nas_transport.assoc_id);
     return;
   }
-
-  unc = ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id);
   if (unc.get()->amf_ue_ngap_id != amf_ue_ngap_id) {
     Logger::amf_n2().error(
         "The requested UE (amf_ue_ngap_id: " AMF_UE_NGAP_ID_FMT
@@ -819,16 +917,14 @@ void amf_n2::handle_itti_message(itti_ul_nas_transport& ul_nas_transport) {
 void amf_n2::handle_itti_message(itti_dl_nas_transport& dl_nas_transport) {
   Logger::amf_n2().debug("Handle DL NAS Transport ...");
 
-  if (!amf_n2_inst->is_ran_ue_id_2_ue_ngap_context(
-          dl_nas_transport.ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc = ue_ids_2_ue_ngap_context(
+      dl_nas_transport.amf_ue_ngap_id, dl_nas_transport.ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
         "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
         dl_nas_transport.ran_ue_ngap_id);
     return;
   }
-
-  std::shared_ptr<ue_ngap_context> unc = {};
-  unc = ran_ue_id_2_ue_ngap_context(dl_nas_transport.ran_ue_ngap_id);
   if (unc.get() == nullptr) {
     Logger::amf_n2().error(
         "Illegal UE with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
@@ -868,15 +964,14 @@ void amf_n2::handle_itti_message(itti_dl_nas_transport& dl_nas_transport) {
 void amf_n2::handle_itti_message(itti_initial_context_setup_request& itti_msg) {
   Logger::amf_n2().debug("Handle Initial Context Setup Request ...");
 
-  if (!amf_n2_inst->is_ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc = ue_ids_2_ue_ngap_context(
+      itti_msg.amf_ue_ngap_id, itti_msg.ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
         "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
         itti_msg.ran_ue_ngap_id);
     return;
   }
-
-  std::shared_ptr<ue_ngap_context> unc = {};
-  unc = ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id);
   if (unc.get() == nullptr) {
     Logger::amf_n2().error(
         "Illegal UE with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
@@ -1029,16 +1124,14 @@ void amf_n2::handle_itti_message(
     itti_pdu_session_resource_setup_request& itti_msg) {
   Logger::amf_n2().debug("Handle PDU Session Resource Setup Request ...");
 
-  if (!amf_n2_inst->is_ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc = ue_ids_2_ue_ngap_context(
+      itti_msg.amf_ue_ngap_id, itti_msg.ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
         "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
         itti_msg.ran_ue_ngap_id);
     return;
   }
-
-  std::shared_ptr<ue_ngap_context> unc = {};
-
-  unc = ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id);
   if (unc.get() == nullptr) {
     Logger::amf_n2().error(
         "Illegal UE with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
@@ -1134,15 +1227,14 @@ void amf_n2::handle_itti_message(
     itti_pdu_session_resource_modify_request& itti_msg) {
   Logger::amf_n2().debug("Handle PDU Session Resource Modify Request ...");
 
-  if (!amf_n2_inst->is_ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc = ue_ids_2_ue_ngap_context(
+      itti_msg.amf_ue_ngap_id, itti_msg.ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
         "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
         itti_msg.ran_ue_ngap_id);
     return;
   }
-
-  std::shared_ptr<ue_ngap_context> unc = {};
-  unc = ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id);
   if (unc.get() == nullptr) {
     Logger::amf_n2().error(
         "Illegal UE with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
@@ -1212,15 +1304,14 @@ void amf_n2::handle_itti_message(
     itti_pdu_session_resource_release_command& itti_msg) {
   Logger::amf_n2().debug("Handle PDU Session Resource Release Command ...");
 
-  if (!amf_n2_inst->is_ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc = ue_ids_2_ue_ngap_context(
+      itti_msg.amf_ue_ngap_id, itti_msg.ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
         "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
         itti_msg.ran_ue_ngap_id);
     return;
   }
-
-  std::shared_ptr<ue_ngap_context> unc = {};
-  unc = ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id);
   if (unc.get() == nullptr) {
     Logger::amf_n2().error(
         "Illegal UE with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
@@ -1301,15 +1392,14 @@ void amf_n2::handle_itti_message(itti_ue_context_release_request& itti_msg) {
 void amf_n2::handle_itti_message(itti_ue_context_release_command& itti_msg) {
   Logger::amf_n2().debug("Handling UE Context Release Command ...");
 
-  if (!amf_n2_inst->is_ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc = ue_ids_2_ue_ngap_context(
+      itti_msg.amf_ue_ngap_id, itti_msg.ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
         "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
         itti_msg.ran_ue_ngap_id);
     return;
   }
-
-  std::shared_ptr<ue_ngap_context> unc = {};
-  unc = ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id);
   if (unc.get() == nullptr) {
     Logger::amf_n2().error(
         "Illegal UE with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
@@ -1434,14 +1524,14 @@ bool amf_n2::handle_itti_message(itti_handover_required& itti_msg) {
       "Handover Required, gNB info (gNB Name %s, globalRanNodeId 0x%x)",
       gc.get()->gnb_name.c_str(), gc.get()->globalRanNodeId);
 
-  std::shared_ptr<ue_ngap_context> unc = {};
-  if (!is_ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc =
+      ran_ue_id_2_ue_ngap_context(itti_msg.assoc_id, ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
         "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
         ran_ue_ngap_id);
     return false;
   }
-  unc = ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id);
 
   if (unc.get()->amf_ue_ngap_id != amf_ue_ngap_id) {
     Logger::amf_n2().error(
@@ -2010,7 +2100,7 @@ void amf_n2::handle_itti_message(itti_handover_notify& itti_msg) {
   unc.get()->target_ran_ue_ngap_id = 0;        // Clear target RAN ID
   unc.get()->ng_ue_state           = NGAP_UE_CONNECTED;
   unc.get()->gnb_assoc_id          = itti_msg.assoc_id;  // update serving gNB
-  set_ran_ue_ngap_id_2_ue_ngap_context(ran_ue_ngap_id, unc);
+  set_ran_ue_ngap_id_2_ue_ngap_context(unc);  // moved to the target gNB
 }
 
 //------------------------------------------------------------------------------
@@ -2083,22 +2173,13 @@ void amf_n2::handle_itti_message(itti_uplink_ran_status_transfer& itti_msg) {
 void amf_n2::handle_itti_message(itti_rereoute_nas& itti_msg) {
   Logger::amf_n2().debug("Handle Reroute NAS Request message...");
 
-  std::shared_ptr<ue_ngap_context> unc = {};
-
-  if (!is_ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id)) {
-    Logger::amf_n2().error(
-        "No UE NGAP context with ran_ue_ngap_id " GNB_UE_NGAP_ID_FMT,
-        itti_msg.ran_ue_ngap_id);
-    return;
-  }
-
-  unc = ran_ue_id_2_ue_ngap_context(itti_msg.ran_ue_ngap_id);
-  if (unc.get()->amf_ue_ngap_id != itti_msg.amf_ue_ngap_id) {
+  std::shared_ptr<ue_ngap_context> unc = ue_ids_2_ue_ngap_context(
+      itti_msg.amf_ue_ngap_id, itti_msg.ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
-        "AMF UE NGAP ID does not match the expected value (requested "
-        "amf_ue_ngap_id " AMF_UE_NGAP_ID_FMT
-        ", existed amf_ue_ngap_id " AMF_UE_NGAP_ID_FMT ")",
-        itti_msg.amf_ue_ngap_id, unc.get()->amf_ue_ngap_id);
+        "No UE NGAP context with ran_ue_ngap_id " GNB_UE_NGAP_ID_FMT
+        " and amf_ue_ngap_id " AMF_UE_NGAP_ID_FMT,
+        itti_msg.ran_ue_ngap_id, itti_msg.amf_ue_ngap_id);
     return;
   }
 
@@ -2141,53 +2222,49 @@ void amf_n2::send_handover_preparation_failure(
 
 //------------------------------------------------------------------------------
 bool amf_n2::is_ran_ue_id_2_ue_ngap_context(
-    const uint32_t& ran_ue_ngap_id) const {
-  std::shared_lock lock(m_ranid2uecontext);
-  if (ranid2uecontext.count(ran_ue_ngap_id) > 0) {
-    if (ranid2uecontext.at(ran_ue_ngap_id).get() != nullptr) {
-      return true;
-    }
-  }
-  return false;
+    const sctp_assoc_id_t& gnb_assoc_id, const uint32_t& ran_ue_ngap_id) const {
+  return ranid2uecontext.find(gnb_assoc_id, ran_ue_ngap_id) != nullptr;
 }
 
 //------------------------------------------------------------------------------
 std::shared_ptr<ue_ngap_context> amf_n2::ran_ue_id_2_ue_ngap_context(
-    const uint32_t& ran_ue_ngap_id) const {
-  std::shared_lock lock(m_ranid2uecontext);
-  return ranid2uecontext.at(ran_ue_ngap_id);
+    const sctp_assoc_id_t& gnb_assoc_id, const uint32_t& ran_ue_ngap_id) const {
+  return ranid2uecontext.find(gnb_assoc_id, ran_ue_ngap_id);
 }
 
 //------------------------------------------------------------------------------
 void amf_n2::set_ran_ue_ngap_id_2_ue_ngap_context(
-    const uint32_t& ran_ue_ngap_id,
     const std::shared_ptr<ue_ngap_context>& unc) {
-  std::unique_lock lock(m_ranid2uecontext);
-  ranid2uecontext[ran_ue_ngap_id] = unc;
+  ranid2uecontext.insert(unc);
 }
 
 //------------------------------------------------------------------------------
 void amf_n2::remove_ran_ue_ngap_id_2_ngap_context(
-    const uint32_t& ran_ue_ngap_id) {
-  std::unique_lock lock(m_ranid2uecontext);
-  if (ranid2uecontext.count(ran_ue_ngap_id) > 0) {
-    ranid2uecontext.erase(ran_ue_ngap_id);
-  }
+    const sctp_assoc_id_t& gnb_assoc_id, const uint32_t& ran_ue_ngap_id) {
+  ranid2uecontext.remove(gnb_assoc_id, ran_ue_ngap_id);
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<ue_ngap_context> amf_n2::ue_ids_2_ue_ngap_context(
+    const unsigned long& amf_ue_ngap_id, const uint32_t& ran_ue_ngap_id) const {
+  std::shared_ptr<ue_ngap_context> unc =
+      amfueid2uecontext.find(amf_ue_ngap_id);
+  if (!unc || (unc.get()->ran_ue_ngap_id != ran_ue_ngap_id)) return nullptr;
+  return unc;
 }
 
 //------------------------------------------------------------------------------
 void amf_n2::remove_ue_context_with_ran_ue_ngap_id(
-    const uint32_t& ran_ue_ngap_id) {
+    const sctp_assoc_id_t& gnb_assoc_id, const uint32_t& ran_ue_ngap_id) {
   // Remove NAS context if still available
-  std::shared_ptr<ue_ngap_context> unc = {};
-
-  if (!is_ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id)) {
+  std::shared_ptr<ue_ngap_context> unc =
+      ran_ue_id_2_ue_ngap_context(gnb_assoc_id, ran_ue_ngap_id);
+  if (!unc) {
     Logger::amf_n2().error(
         "No UE NGAP context with ran_ue_ngap_id (" GNB_UE_NGAP_ID_FMT ")",
         ran_ue_ngap_id);
     return;
   }
-  unc = ran_ue_id_2_ue_ngap_context(ran_ue_ngap_id);
 
   // Remove all NAS context if still exist
   std::shared_ptr<nas_context> nc = nullptr;
@@ -2212,53 +2289,38 @@ void amf_n2::remove_ue_context_with_ran_ue_ngap_id(
 
   // Remove NGAP context
   remove_amf_ue_ngap_id_2_ue_ngap_context(unc.get()->amf_ue_ngap_id);
-  remove_ran_ue_ngap_id_2_ngap_context(ran_ue_ngap_id);
+  remove_ran_ue_ngap_id_2_ngap_context(gnb_assoc_id, ran_ue_ngap_id);
 }
 
 //------------------------------------------------------------------------------
 void amf_n2::get_ue_ngap_contexts(
     const sctp_assoc_id_t& gnb_assoc_id,
     std::vector<std::shared_ptr<ue_ngap_context>>& ue_contexts) {
-  std::shared_lock lock(m_ranid2uecontext);
-  for (auto ue : ranid2uecontext) {
-    if (ue.second->gnb_assoc_id == gnb_assoc_id)
-      ue_contexts.push_back(ue.second);
-  }
+  ranid2uecontext.get_gnb_ues(gnb_assoc_id, ue_contexts);
 }
 
 //------------------------------------------------------------------------------
 std::shared_ptr<ue_ngap_context> amf_n2::amf_ue_id_2_ue_ngap_context(
     const unsigned long& amf_ue_ngap_id) const {
-  std::shared_lock lock(m_amfueid2uecontext);
-  return amfueid2uecontext.at(amf_ue_ngap_id);
+  return amfueid2uecontext.find(amf_ue_ngap_id);
 }
 
 //------------------------------------------------------------------------------
 bool amf_n2::is_amf_ue_id_2_ue_ngap_context(
     const unsigned long& amf_ue_ngap_id) const {
-  std::shared_lock lock(m_amfueid2uecontext);
-  if (amfueid2uecontext.count(amf_ue_ngap_id) > 0) {
-    if (amfueid2uecontext.at(amf_ue_ngap_id).get() != nullptr) {
-      return true;
-    }
-  }
-  return false;
+  return amfueid2uecontext.find(amf_ue_ngap_id) != nullptr;
 }
 
 //------------------------------------------------------------------------------
 void amf_n2::set_amf_ue_ngap_id_2_ue_ngap_context(
     const unsigned long& amf_ue_ngap_id, std::shared_ptr<ue_ngap_context> unc) {
-  std::unique_lock lock(m_amfueid2uecontext);
-  amfueid2uecontext[amf_ue_ngap_id] = unc;
+  amfueid2uecontext.insert(amf_ue_ngap_id, unc);
 }
 
 //------------------------------------------------------------------------------
 void amf_n2::remove_amf_ue_ngap_id_2_ue_ngap_context(
     const unsigned long& amf_ue_ngap_id) {
-  std::unique_lock lock(m_amfueid2uecontext);
-  if (amfueid2uecontext.count(amf_ue_ngap_id) > 0) {
-    amfueid2uecontext.erase(amf_ue_ngap_id);
-  }
+  amfueid2uecontext.remove(amf_ue_ngap_id);
 }
 
 //------------------------------------------------------------------------------
@@ -2279,7 +2341,11 @@ void amf_n2::remove_ue_context_with_amf_ue_ngap_id(
     // TODO:  remove_guti_2_nas_context(guti);
     amf_n1_inst->remove_amf_ue_ngap_id_2_nas_context(amf_ue_ngap_id);
     // Remove NGAP context related to RAN UE NGAP ID
-    remove_ran_ue_ngap_id_2_ngap_context(nc.get()->ran_ue_ngap_id);
+    std::shared_ptr<ue_ngap_context> unc =
+        ue_ids_2_ue_ngap_context(amf_ue_ngap_id, nc.get()->ran_ue_ngap_id);
+    if (unc)
+      remove_ran_ue_ngap_id_2_ngap_context(
+          unc.get()->gnb_assoc_id, unc.get()->ran_ue_ngap_id);
 
   } else {
     Logger::amf_n2().warn(
@@ -36,6 +36,7 @@
 #include "itti_msg_n2.hpp"
 #include "ngap_app.hpp"
 #include "ue_ngap_context.hpp"
+#include "ue_ngap_context_index.hpp"
 
 namespace amf_application {
 
@@ -214,49 +215,70 @@ class amf_n2 : public ngap::ngap_app {
       std::vector<SupportedItem_t>& result);
 
   /*
-   * Get UE NGAP context associated with a RAN UE NGAP ID
+   * Get UE NGAP context associated with a RAN UE NGAP ID of a gNB
+   * @param [const sctp_assoc_id_t&] gnb_assoc_id: gNB Association ID
    * @param [const uint32_t&] ran_ue_ngap_id: RAN UE NGAP ID
-   * @return shared pointer to the UE NGAP context
+   * @return shared pointer to the UE NGAP context, nullptr if none
    */
   std::shared_ptr<ue_ngap_context> ran_ue_id_2_ue_ngap_context(
+      const sctp_assoc_id_t& gnb_assoc_id,
       const uint32_t& ran_ue_ngap_id) const;
 
   /*
-   * Verify whether a UE NGAP context associated with a RAN UE NGAP ID exist
+   * Verify whether a UE NGAP context associated with a RAN UE NGAP ID of a gNB
+   * exist
+   * @param [const sctp_assoc_id_t&] gnb_assoc_id: gNB Association ID
    * @param [const uint32_t&] ran_ue_ngap_id: RAN UE NGAP ID
    * @return true if exist, otherwise return false
    */
-  bool is_ran_ue_id_2_ue_ngap_context(const uint32_t& ran_ue_ngap_id) const;
+  bool is_ran_ue_id_2_ue_ngap_context(
+      const sctp_assoc_id_t& gnb_assoc_id,
+      const uint32_t& ran_ue_ngap_id) const;
 
   /*
-   * Store UE NGAP context associated with a RAN UE NGAP ID
-   * @param [const uint32_t&] ran_ue_ngap_id: RAN UE NGAP ID
+   * Store UE NGAP context associated with its RAN UE NGAP ID and gNB
+   * (gnb_assoc_id), moved if they changed since it was stored
    * @param [const std::shared_ptr<ue_ngap_context>&] unc: pointer to UE NGAP
    * context
    * @return void
    */
   void set_ran_ue_ngap_id_2_ue_ngap_context(
-      const uint32_t& ran_ue_ngap_id,
       const std::shared_ptr<ue_ngap_context>& unc);
 
   /*
-   * Remove UE NGAP context associated with a RAN UE NGAP ID
+   * Remove UE NGAP context associated with a RAN UE NGAP ID of a gNB
+   * @param [const sctp_assoc_id_t&] gnb_assoc_id: gNB Association ID
    * @param [const uint32_t&] ran_ue_ngap_id: RAN UE NGAP ID
    * @return void
    */
-  void remove_ran_ue_ngap_id_2_ngap_context(const uint32_t& ran_ue_ngap_id);
+  void remove_ran_ue_ngap_id_2_ngap_context(
+      const sctp_assoc_id_t& gnb_assoc_id, const uint32_t& ran_ue_ngap_id);
 
   /*
-   * Remove UE Context associated with a RAN UE NGAP ID
+   * Remove UE Context associated with a RAN UE NGAP ID of a gNB
+   * @param [const sctp_assoc_id_t&] gnb_assoc_id: gNB Association ID
    * @param [const uint32_t&] ran_ue_ngap_id: RAN UE NGAP ID
    * @return void
    */
-  void remove_ue_context_with_ran_ue_ngap_id(const uint32_t& ran_ue_ngap_id);
+  void remove_ue_context_with_ran_ue_ngap_id(
+      const sctp_assoc_id_t& gnb_assoc_id, const uint32_t& ran_ue_ngap_id);
+
+  /*
+   * Get UE NGAP context of a UE known by its AMF UE NGAP ID and RAN UE NGAP
+   * ID (messages from the other tasks, which do not know the gNB)
+   * @param [const unsigned long&] amf_ue_ngap_id: AMF UE NGAP ID
+   * @param [const uint32_t&] ran_ue_ngap_id: RAN UE NGAP ID
+   * @return shared pointer to the UE NGAP context, nullptr if none or if the
+   * RAN UE NGAP ID does not match
+   */
+  std::shared_ptr<ue_ngap_context> ue_ids_2_ue_ngap_context(
+      const unsigned long& amf_ue_ngap_id,
+      const uint32_t& ran_ue_ngap_id) const;
 
   /*
    * Get UE NGAP context associated with a AMF UE NGAP ID
    * @param [const unsigned long&] amf_ue_ngap_id: AMF UE NGAP ID
-   * @return shared pointer to the UE NGAP context
+   * @return shared pointer to the UE NGAP context, nullptr if none
    */
   std::shared_ptr<ue_ngap_context> amf_ue_id_2_ue_ngap_context(
       const unsigned long& amf_ue_ngap_id) const;
@@ -308,13 +330,10 @@ class amf_n2 : public ngap::ngap_app {
       std::vector<std::shared_ptr<ue_ngap_context>>& ue_contexts);
 
  private:
-  std::map<uint32_t, std::shared_ptr<ue_ngap_context>>
-      ranid2uecontext;  // ran ue ngap id
-  mutable std::shared_mutex m_ranid2uecontext;
+  // (gnb assoc id, ran ue ngap id), UEs per gNB
+  ue_ngap_context_index ranid2uecontext;
 
-  std::map<unsigned long, std::shared_ptr<ue_ngap_context>>
-      amfueid2uecontext;  // amf ue id
-  mutable std::shared_mutex m_amfueid2uecontext;
+  ue_ngap_context_amf_index amfueid2uecontext;  // amf ue id
 };
 
 }  // namespace amf_application
@@ -0,0 +1,309 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file amf_sbi_client.cpp
+ \brief Event driven HTTP client used to reach the other NFs (SMF, NRF, AUSF,
+        UDM, NSSF)
+ \date 2021
+ \email: contact@openairinterface.org
+ */
+
+#include "amf_sbi_client.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <future>
+
+#include "amf.hpp"
+#include "logger.hpp"
+
+using namespace amf_application;
+
+//------------------------------------------------------------------------------
+static std::size_t sbi_client_write(
+    const char* in, std::size_t size, std::size_t num, std::string* out) {
+  const std::size_t total_bytes(size * num);
+  out->append(in, total_bytes);
+  return total_bytes;
+}
+
+//------------------------------------------------------------------------------
+amf_sbi_client::amf_sbi_client(const std::string& if_name)
+    : if_name(if_name),
+      multi(nullptr),
+      event_fd(-1),
+      running(true),
+      thread(),
+      m_pending(),
+      pending(),
+      free_handles(),
+      in_flight() {
+  // Once for the process, not per request
+  curl_global_init(CURL_GLOBAL_ALL);
+  multi = curl_multi_init();
+  if (!multi) {
+    throw std::runtime_error("Cannot create the SBI client");
+  }
+  // The connection cache of the multi handle is shared by all the requests:
+  // HTTP/2 requests to the same authority are multiplexed over a single
+  // connection, HTTP/1.1 connections are kept alive and reused.
+  curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+  curl_multi_setopt(
+      multi, CURLMOPT_MAX_HOST_CONNECTIONS, SBI_CLIENT_MAX_HOST_CONNECTIONS);
+  curl_multi_setopt(
+      multi, CURLMOPT_MAXCONNECTS, SBI_CLIENT_MAX_CACHED_CONNECTIONS);
+
+  event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd < 0) {
+    curl_multi_cleanup(multi);
+    throw std::runtime_error("Cannot create the SBI client event fd");
+  }
+  thread = std::thread(&amf_sbi_client::run, this);
+  Logger::amf_n11().startup("SBI client started");
+}
+
+//------------------------------------------------------------------------------
+amf_sbi_client::~amf_sbi_client() {
+  running      = false;
+  uint64_t one = 1;
+  if (write(event_fd, &one, sizeof(one)) < 0) {
+    Logger::amf_n11().warn("Could not wake the SBI client thread up");
+  }
+  if (thread.joinable()) thread.join();
+  for (auto h : free_handles) curl_easy_cleanup(h);
+  curl_multi_cleanup(multi);
+  close(event_fd);
+  curl_global_cleanup();
+}
+
+//------------------------------------------------------------------------------
+void amf_sbi_client::send_request(
+    const std::string& uri, const std::string& method, std::string&& body,
+    const std::string& content_type, const uint8_t http_version,
+    sbi_response_handler_t&& handler) {
+  sbi_request_t* request = new sbi_request_t();
+  request->curl          = nullptr;
+  request->headers =
+      curl_slist_append(nullptr, ("content-type: " + content_type).c_str());
+  request->uri                = uri;
+  request->method             = method;
+  request->body               = std::move(body);
+  request->http_version       = http_version;
+  request->response.result    = CURLE_OK;
+  request->response.http_code = 0;
+  request->handler            = std::move(handler);
+
+  {
+    // Checked with the lock held, the event thread takes the last pending
+    // requests with it once it is not running anymore
+    std::lock_guard<std::mutex> lock(m_pending);
+    if (running) {
+      pending.push_back(request);
+      request = nullptr;
+    }
+  }
+  if (request) {
+    Logger::amf_n11().error(
+        "SBI client stopped, cannot send request to %s", uri.c_str());
+    complete(request, CURLE_FAILED_INIT);
+    return;
+  }
+  uint64_t one = 1;
+  if (write(event_fd, &one, sizeof(one)) < 0) {
+    Logger::amf_n11().warn("Could not wake the SBI client thread up");
+  }
+}
+
+//------------------------------------------------------------------------------
+void amf_sbi_client::send_request_sync(
+    const std::string& uri, const std::string& method, std::string&& body,
+    const std::string& content_type, const uint8_t http_version,
+    sbi_response_t& response) {
+  response.result    = CURLE_FAILED_INIT;
+  response.http_code = 0;
+  if (std::this_thread::get_id() == thread.get_id()) {
+    // The response would be completed by this very thread
+    Logger::amf_n11().error(
+        "Cannot wait for a response from %s in a completion handler",
+        uri.c_str());
+    return;
+  }
+  // Shared with the handler, which may run after a timeout
+  std::shared_ptr<std::promise<sbi_response_t>> done =
+      std::make_shared<std::promise<sbi_response_t>>();
+  std::future<sbi_response_t> f = done->get_future();
+  send_request(
+      uri, method, std::move(body), content_type, http_version,
+      [done](sbi_response_t& r) { done->set_value(std::move(r)); });
+  if (f.wait_for(std::chrono::milliseconds(SBI_CLIENT_SYNC_TIMEOUT_MS)) !=
+      std::future_status::ready) {
+    Logger::amf_n11().error("No completion of the request to %s", uri.c_str());
+    response.result = CURLE_OPERATION_TIMEDOUT;
+    return;
+  }
+  response = f.get();
+}
+
+//------------------------------------------------------------------------------
+CURL* amf_sbi_client::get_easy_handle() {
+  if (free_handles.empty()) return curl_easy_init();
+  CURL* curl = free_handles.back();
+  free_handles.pop_back();
+  return curl;
+}
+
+//------------------------------------------------------------------------------
+void amf_sbi_client::setup(sbi_request_t* request) {
+  CURL* curl = request->curl;
+  curl_easy_setopt(curl, CURLOPT_PRIVATE, request);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl, CURLOPT_URL, request->uri.c_str());
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request->headers);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, CURL_TIMEOUT_MS);
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(curl, CURLOPT_INTERFACE, if_name.c_str());
+
+  if (request->http_version == 2) {
+    // we use a self-signed test server, skip verification during debugging
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(
+        curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
+    // Rather wait for a stream on the existing connection than open another
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+  }
+
+  if (request->method.compare("GET") == 0) {
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+  } else if (request->method.compare("DELETE") == 0) {
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+  } else {
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, request->body.length());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request->body.c_str());
+    if (request->method.compare("POST") != 0)
+      curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request->method.c_str());
+  }
+
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &sbi_client_write);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &request->response.body);
+  curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &sbi_client_write);
+  curl_easy_setopt(curl, CURLOPT_HEADERDATA, &request->response.headers);
+}
+
+//------------------------------------------------------------------------------
+void amf_sbi_client::add_pending_requests() {
+  std::vector<sbi_request_t*> requests = {};
+  {
+    std::lock_guard<std::mutex> lock(m_pending);
+    requests.swap(pending);
+  }
+  for (auto request : requests) {
+    request->curl = get_easy_handle();
+    if (!request->curl) {
+      Logger::amf_n11().error(
+          "Cannot get a handle to send request to %s", request->uri.c_str());
+      complete(request, CURLE_FAILED_INIT);
+      continue;
+    }
+    setup(request);
+    CURLMcode rc = curl_multi_add_handle(multi, request->curl);
+    if (rc != CURLM_OK) {
+      Logger::amf_n11().error(
+          "Cannot send request to %s: %s", request->uri.c_str(),
+          curl_multi_strerror(rc));
+      complete(request, CURLE_FAILED_INIT);
+      continue;
+    }
+    in_flight.insert(request);
+  }
+}
+
+//------------------------------------------------------------------------------
+void amf_sbi_client::complete(sbi_request_t* request, const CURLcode result) {
+  if (request->curl) {
+    long http_code = 0;
+    curl_easy_getinfo(request->curl, CURLINFO_RESPONSE_CODE, &http_code);
+    request->response.http_code = http_code;
+    curl_multi_remove_handle(multi, request->curl);
+    curl_easy_reset(request->curl);
+    free_handles.push_back(request->curl);
+    in_flight.erase(request);
+  }
+  request->response.result = result;
+  if (result != CURLE_OK) {
+    Logger::amf_n11().warn(
+        "Request to %s failed: %s", request->uri.c_str(),
+        curl_easy_strerror(result));
+  }
+  curl_slist_free_all(request->headers);
+
+  try {
+    request->handler(request->response);
+  } catch (std::exception& e) {
+    Logger::amf_n11().error(
+        "Error while handling the response from %s: %s", request->uri.c_str(),
+        e.what());
+  }
+  delete request;
+}
+
+//------------------------------------------------------------------------------
+void amf_sbi_client::complete_requests() {
+  CURLMsg* msg  = nullptr;
+  int msgs_left = 0;
+  while ((msg = curl_multi_info_read(multi, &msgs_left))) {
+    if (msg->msg != CURLMSG_DONE) continue;
+    sbi_request_t* request = nullptr;
+    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &request);
+    // msg is not valid anymore once the handle is removed
+    const CURLcode result = msg->data.result;
+    complete(request, result);
+  }
+}
+
+//------------------------------------------------------------------------------
+void amf_sbi_client::run() {
+  int still_running = 0;
+  while (running) {
+    add_pending_requests();
+    curl_multi_perform(multi, &still_running);
+    complete_requests();
+
+    struct curl_waitfd wfd = {};
+    wfd.fd                 = event_fd;
+    wfd.events             = CURL_WAIT_POLLIN;
+    curl_multi_wait(multi, &wfd, 1, SBI_CLIENT_POLL_TIMEOUT_MS, nullptr);
+    if (wfd.revents) {
+      uint64_t count = 0;
+      if (read(event_fd, &count, sizeof(count)) < 0) {
+        // already drained
+      }
+    }
+  }
+
+  // Do not leave anyone waiting for a response
+  add_pending_requests();
+  std::vector<sbi_request_t*> requests(in_flight.begin(), in_flight.end());
+  for (auto request : requests) {
+    complete(request, CURLE_ABORTED_BY_CALLBACK);
+  }
+}
@@ -0,0 +1,135 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file amf_sbi_client.hpp
+ \brief Event driven HTTP client used to reach the other NFs (SMF, NRF, AUSF,
+        UDM, NSSF)
+ \date 2021
+ \email: contact@openairinterface.org
+ */
+
+#ifndef _AMF_SBI_CLIENT_H_
+#define _AMF_SBI_CLIENT_H_
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace amf_application {
+
+typedef struct sbi_response_s {
+  CURLcode result;
+  uint32_t http_code;  // 0 if no response was received
+  std::string body;
+  std::string headers;
+} sbi_response_t;
+
+// Called on the SBI client thread, must not wait for another SBI response
+typedef std::function<void(sbi_response_t&)> sbi_response_handler_t;
+
+class amf_sbi_client {
+ public:
+  /*
+   * Start the event thread
+   * @param [const std::string&] if_name: interface the requests are sent from
+   */
+  explicit amf_sbi_client(const std::string& if_name);
+  ~amf_sbi_client();
+
+  amf_sbi_client(amf_sbi_client const&) = delete;
+  void operator=(amf_sbi_client const&) = delete;
+
+  /*
+   * Queue a request, the handler is called once the response is received or
+   * the request failed (by the calling thread if the client is stopped)
+   * @param [const std::string&] uri: Server's URI
+   * @param [const std::string&] method: HTTP method
+   * @param [std::string&&] body: Msg body
+   * @param [const std::string&] content_type: Content type of the body
+   * @param [const uint8_t] http_version: HTTP version
+   * @param [sbi_response_handler_t&&] handler: completion handler
+   * @return void
+   */
+  void send_request(
+      const std::string& uri, const std::string& method, std::string&& body,
+      const std::string& content_type, const uint8_t http_version,
+      sbi_response_handler_t&& handler);
+
+  /*
+   * Send a request and wait for its completion, other requests keep going.
+   * Fails (http_code 0) if the client is stopped, if the request is not
+   * completed within SBI_CLIENT_SYNC_TIMEOUT_MS, or if called from a
+   * completion handler
+   * @param [const std::string&] uri: Server's URI
+   * @param [const std::string&] method: HTTP method
+   * @param [std::string&&] body: Msg body
+   * @param [const std::string&] content_type: Content type of the body
+   * @param [const uint8_t] http_version: HTTP version
+   * @param [sbi_response_t&] response: response
+   * @return void
+   */
+  void send_request_sync(
+      const std::string& uri, const std::string& method, std::string&& body,
+      const std::string& content_type, const uint8_t http_version,
+      sbi_response_t& response);
+
+ private:
+  typedef struct sbi_request_s {
+    CURL* curl;
+    struct curl_slist* headers;
+    std::string uri;
+    std::string method;
+    std::string body;
+    uint8_t http_version;
+    sbi_response_t response;
+    sbi_response_handler_t handler;
+  } sbi_request_t;
+
+  void run();
+  void add_pending_requests();
+  void complete_requests();
+  void complete(sbi_request_t* request, const CURLcode result);
+  CURL* get_easy_handle();
+  void setup(sbi_request_t* request);
+
+  std::string if_name;
+  CURLM* multi;
+  int event_fd;  // wakes the event thread up when a request is queued
+  std::atomic<bool> running;
+  std::thread thread;
+
+  std::mutex m_pending;
+  std::vector<sbi_request_t*> pending;
+
+  // event thread only
+  std::vector<CURL*> free_handles;
+  std::unordered_set<sbi_request_t*> in_flight;
+};
+
+}  // namespace amf_application
+
+#endif
@@ -53,6 +53,7 @@ void statistics::display() {
   Logger::amf_app().info(
       "|    Index    |      Status      |       Global ID       |       gNB "
       "Name       |               PLMN             |");
+  std::shared_lock lock_gnbs(m_gnbs);
   if (gnbs.size() == 0) {
     Logger::amf_app().info(
         "|      -      |          -       |           -           |           "
@@ -87,6 +88,9 @@ void statistics::display() {
       "| Index |      5GMM state      |      IMSI        |     GUTI      | RAN "
       "UE NGAP ID | AMF UE ID |  PLMN   |Cell ID|");
 
+  lock_gnbs.unlock();
+
+  std::shared_lock lock_ue_infos(m_ue_infos);
   i = 0;
   for (auto const& ue : ue_infos) {
     Logger::amf_app().info(
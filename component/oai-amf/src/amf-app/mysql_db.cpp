@@ -26,188 +26,305 @@
  \email: contact@openairinterface.org
  */
 
-#include "amf_config.hpp"
-#include "amf_n1.hpp"
+#include "mysql_db.hpp"
+
+#include <inttypes.h>
+#include <string.h>
+
 #include "logger.hpp"
 
-using namespace amf_application;
-using namespace config;
+#define MYSQL_SELECT_AUTH_INFO                                                 \
+  "SELECT `key`,`sqn`,`rand`,`OPc` FROM `users` WHERE `users`.`imsi`=?"
+#define MYSQL_UPDATE_RAND_SQN                                                  \
+  "UPDATE `users` SET `rand`=?,`sqn`=? WHERE `users`.`imsi`=?"
+// LAST_INSERT_ID(expr) returns the SQN read by the same statement
+#define MYSQL_LEASE_SQN                                                        \
+  "UPDATE `users` SET `sqn`=LAST_INSERT_ID(`sqn`)+? WHERE `users`.`imsi`=?"
+
+//------------------------------------------------------------------------------
+uint64_t mysql_sqn_to_uint64(const uint8_t* sqn) {
+  uint64_t value = 0;
+  for (int i = 0; i < SQN_LENGTH; i++) value = (value << 8) | sqn[i];
+  return value;
+}
+
+//------------------------------------------------------------------------------
+void mysql_sqn_from_uint64(uint64_t value, uint8_t* sqn) {
+  for (int i = SQN_LENGTH - 1; i >= 0; i--) {
+    sqn[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void bind_string(MYSQL_BIND& bind, const std::string& str) {
+  memset(&bind, 0, sizeof(bind));
+  bind.buffer_type   = MYSQL_TYPE_STRING;
+  bind.buffer        = (void*) str.c_str();
+  bind.buffer_length = str.size();
+}
+
+//------------------------------------------------------------------------------
+static void bind_blob(
+    MYSQL_BIND& bind, const uint8_t* data, const unsigned long length) {
+  memset(&bind, 0, sizeof(bind));
+  bind.buffer_type   = MYSQL_TYPE_BLOB;
+  bind.buffer        = (void*) data;
+  bind.buffer_length = length;
+}
 
-extern amf_config amf_cfg;
+//------------------------------------------------------------------------------
+static void bind_uint64(MYSQL_BIND& bind, uint64_t* value) {
+  memset(&bind, 0, sizeof(bind));
+  bind.buffer_type = MYSQL_TYPE_LONGLONG;
+  bind.buffer      = value;
+  bind.is_unsigned = true;
+}
+
+//------------------------------------------------------------------------------
+static MYSQL_STMT* prepare(MYSQL* conn, const char* query) {
+  MYSQL_STMT* stmt = mysql_stmt_init(conn);
+  if (!stmt) return nullptr;
+  if (mysql_stmt_prepare(stmt, query, strlen(query))) {
+    Logger::amf_n1().error(
+        "Cannot prepare statement: %s", mysql_stmt_error(stmt));
+    mysql_stmt_close(stmt);
+    return nullptr;
+  }
+  return stmt;
+}
 
 //------------------------------------------------------------------------------
-bool amf_n1::get_mysql_auth_info(
-    const std::string& imsi,
-    mysql_auth_info_t&
-        resp) {  // openair-cn/tree/v0.5.0/src/oai_hss/db/db_connector.c
-  MYSQL_RES* res;
-  MYSQL_ROW row;
-  std::string query;
+mysql_db_connection::mysql_db_connection()
+    : db(nullptr),
+      conn(nullptr),
+      select_auth_info(nullptr),
+      update_rand_sqn(nullptr),
+      lease_sqns(nullptr) {}
 
-  if (!db_desc->db_conn) {
-    Logger::amf_n1().error("Cannot connect to MySQL DB");
+//------------------------------------------------------------------------------
+mysql_db_connection::~mysql_db_connection() {
+  close();
+}
+
+//------------------------------------------------------------------------------
+void mysql_db_connection::close() {
+  for (MYSQL_STMT** stmt :
+       {&select_auth_info, &update_rand_sqn, &lease_sqns}) {
+    if (*stmt) mysql_stmt_close(*stmt);
+    *stmt = nullptr;
+  }
+  if (conn) mysql_close(conn);
+  conn = nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool mysql_db_connection::connect(const database_t& db) {
+  close();
+  this->db = &db;
+  conn     = mysql_init(NULL);
+  if (!conn) {
+    Logger::amf_n1().error("Cannot allocate a MySQL connection");
     return false;
   }
-  query =
-      "SELECT `key`,`sqn`,`rand`,`OPc` FROM `users` WHERE `users`.`imsi`='" +
-      imsi + "' ";
-  pthread_mutex_lock(&db_desc->db_cs_mutex);
-  if (mysql_query(db_desc->db_conn, query.c_str())) {
-    pthread_mutex_unlock(&db_desc->db_cs_mutex);
+  if (!mysql_real_connect(
+          conn, db.server.c_str(), db.user.c_str(), db.password.c_str(),
+          db.database.c_str(), 0, NULL, 0)) {
     Logger::amf_n1().error(
-        "Query execution failed: %s\n", mysql_error(db_desc->db_conn));
+        "An error occurred while connecting to db: %s", mysql_error(conn));
+    close();
     return false;
   }
-  res = mysql_store_result(db_desc->db_conn);
-  pthread_mutex_unlock(&db_desc->db_cs_mutex);
-  if (!res) {
-    Logger::amf_n1().error("Data fetched from MySQL is not present");
+  select_auth_info = prepare(conn, MYSQL_SELECT_AUTH_INFO);
+  update_rand_sqn  = prepare(conn, MYSQL_UPDATE_RAND_SQN);
+  lease_sqns       = prepare(conn, MYSQL_LEASE_SQN);
+  if (!select_auth_info || !update_rand_sqn || !lease_sqns) {
+    close();
     return false;
   }
-  if (row = mysql_fetch_row(res)) {
-    if (row[0] == NULL || row[1] == NULL || row[2] == NULL || row[3] == NULL) {
-      Logger::amf_n1().error("row data failed");
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool mysql_db_connection::execute(MYSQL_STMT*& stmt, MYSQL_BIND* params) {
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (!stmt) {
+      // lost at the previous query
+      if (!db || !connect(*db)) return false;
+    }
+    if (mysql_stmt_bind_param(stmt, params)) {
+      Logger::amf_n1().error(
+          "Cannot bind parameters: %s", mysql_stmt_error(stmt));
       return false;
     }
-    memcpy(resp.key, row[0], KEY_LENGTH);
-    uint64_t sqn = 0;
-    sqn          = atoll(row[1]);
-    resp.sqn[0]  = (sqn & (255UL << 40)) >> 40;
-    resp.sqn[1]  = (sqn & (255UL << 32)) >> 32;
-    resp.sqn[2]  = (sqn & (255UL << 24)) >> 24;
-    resp.sqn[3]  = (sqn & (255UL << 16)) >> 16;
-    resp.sqn[4]  = (sqn & (255UL << 8)) >> 8;
-    resp.sqn[5]  = (sqn & 0xff);
-    memcpy(resp.rand, row[2], RAND_LENGTH);
-    memcpy(resp.opc, row[3], KEY_LENGTH);
-  }
-  mysql_free_result(res);
-  return true;
+    if (!mysql_stmt_execute(stmt)) return true;
+    unsigned int err = mysql_stmt_errno(stmt);
+    Logger::amf_n1().error(
+        "Query execution failed: %s", mysql_stmt_error(stmt));
+    if ((err != CR_SERVER_GONE_ERROR) && (err != CR_SERVER_LOST)) return false;
+    close();
+  }
+  return false;
 }
 
 //------------------------------------------------------------------------------
-bool amf_n1::connect_to_mysql() {
-  const int mysql_reconnect_val = 1;
-  db_desc                       = (database_t*) calloc(1, sizeof(database_t));
-  if (!db_desc) {
+bool mysql_db_connection::get_auth_info(
+    const std::string& imsi, mysql_auth_info_t& resp) {
+  MYSQL_BIND param[1];
+  MYSQL_BIND result[4];
+  uint64_t sqn = 0;
+
+  bind_string(param[0], imsi);
+  if (!execute(select_auth_info, param)) return false;
+
+  bind_blob(result[0], resp.key, KEY_LENGTH);
+  bind_uint64(result[1], &sqn);
+  bind_blob(result[2], resp.rand, RAND_LENGTH);
+  bind_blob(result[3], resp.opc, KEY_LENGTH);
+  if (mysql_stmt_bind_result(select_auth_info, result) ||
+      mysql_stmt_store_result(select_auth_info)) {
     Logger::amf_n1().error(
-        "An error occurs when allocating memory for DB_DESC");
+        "Cannot retrieve the result: %s", mysql_stmt_error(select_auth_info));
+    mysql_stmt_free_result(select_auth_info);
     return false;
   }
-  pthread_mutex_init(&db_desc->db_cs_mutex, NULL);
-  db_desc->server   = amf_cfg.auth_para.mysql_server;
-  db_desc->user     = amf_cfg.auth_para.mysql_user;
-  db_desc->password = amf_cfg.auth_para.mysql_pass;
-  db_desc->database = amf_cfg.auth_para.mysql_db;
-  db_desc->db_conn  = mysql_init(NULL);
-  mysql_options(db_desc->db_conn, MYSQL_OPT_RECONNECT, &mysql_reconnect_val);
-  if (!mysql_real_connect(
-          db_desc->db_conn, db_desc->server.c_str(), db_desc->user.c_str(),
-          db_desc->password.c_str(), db_desc->database.c_str(), 0, NULL, 0)) {
+  int rc = mysql_stmt_fetch(select_auth_info);
+  mysql_stmt_free_result(select_auth_info);
+  if (rc == MYSQL_NO_DATA) {
+    Logger::amf_n1().error("No user with IMSI %s", imsi.c_str());
+    return false;
+  }
+  if ((rc != 0) && (rc != MYSQL_DATA_TRUNCATED)) {
     Logger::amf_n1().error(
-        "An error occurred while connecting to db: %s",
-        mysql_error(db_desc->db_conn));
-    mysql_thread_end();
+        "Cannot fetch the result: %s", mysql_stmt_error(select_auth_info));
     return false;
   }
-  mysql_set_server_option(db_desc->db_conn, MYSQL_OPTION_MULTI_STATEMENTS_ON);
+  // is_null set by mysql_stmt_bind_result when not provided
+  for (int i = 0; i < 4; i++) {
+    if (*result[i].is_null) {
+      Logger::amf_n1().error("row data failed");
+      return false;
+    }
+  }
+  mysql_sqn_from_uint64(sqn, resp.sqn);
   return true;
 }
 
 //------------------------------------------------------------------------------
-void amf_n1::mysql_push_rand_sqn(
-    const std::string& imsi, uint8_t* rand_p, uint8_t* sqn) {
-  int status = 0;
-  MYSQL_RES* res;
-  char query[1000];
-  int query_length     = 0;
-  uint64_t sqn_decimal = 0;
-  if (!db_desc->db_conn) {
-    Logger::amf_n1().error("Cannot connect to MySQL DB");
-    return;
-  }
-  if (!sqn || !rand_p) {
-    Logger::amf_n1().error("Need sqn and rand");
-    return;
-  }
-  sqn_decimal = ((uint64_t) sqn[0] << 40) | ((uint64_t) sqn[1] << 32) |
-                ((uint64_t) sqn[2] << 24) | (sqn[3] << 16) | (sqn[4] << 8) |
-                sqn[5];
-  query_length = sprintf(query, "UPDATE `users` SET `rand`=UNHEX('");
-  for (int i = 0; i < RAND_LENGTH; i++) {
-    query_length += sprintf(&query[query_length], "%02x", rand_p[i]);
-  }
-
-  query_length +=
-      sprintf(&query[query_length], "'),`sqn`=%" PRIu64, sqn_decimal);
-  query_length +=
-      sprintf(&query[query_length], " WHERE `users`.`imsi`='%s'", imsi.c_str());
-  pthread_mutex_lock(&db_desc->db_cs_mutex);
-  if (mysql_query(db_desc->db_conn, query)) {
-    pthread_mutex_unlock(&db_desc->db_cs_mutex);
-    Logger::amf_n1().error(
-        "Query execution failed: %s", mysql_error(db_desc->db_conn));
-    return;
-  }
-  do {
-    res = mysql_store_result(db_desc->db_conn);
-    if (res) {
-      mysql_free_result(res);
-    } else {
-      if (mysql_field_count(db_desc->db_conn) == 0) {
-        Logger::amf_n1().debug(
-            "[MySQL] %lld rows affected",
-            mysql_affected_rows(db_desc->db_conn));
-      } else { /* some error occurred */
-        Logger::amf_n1().error("Could not retrieve result set");
-        break;
-      }
-    }
-    if ((status = mysql_next_result(db_desc->db_conn)) > 0)
-      Logger::amf_n1().error("Could not execute statement");
-  } while (status == 0);
-  pthread_mutex_unlock(&db_desc->db_cs_mutex);
-  return;
+bool mysql_db_connection::set_rand_sqn(
+    const std::string& imsi, const uint8_t* rand, const uint8_t* sqn) {
+  MYSQL_BIND param[3];
+  uint64_t sqn_decimal = mysql_sqn_to_uint64(sqn);
+
+  bind_blob(param[0], rand, RAND_LENGTH);
+  bind_uint64(param[1], &sqn_decimal);
+  bind_string(param[2], imsi);
+  if (!execute(update_rand_sqn, param)) return false;
+  Logger::amf_n1().debug(
+      "[MySQL] %" PRIu64 " rows affected",
+      (uint64_t) mysql_stmt_affected_rows(update_rand_sqn));
+  return true;
 }
 
 //------------------------------------------------------------------------------
-void amf_n1::mysql_increment_sqn(const std::string& imsi) {
-  int status;
-  MYSQL_RES* res;
-  char query[1000];
-  if (db_desc->db_conn == NULL) {
-    Logger::amf_n1().error("Cannot connect to MySQL DB");
-    return;
+bool mysql_db_connection::lease_sqn(
+    const std::string& imsi, const int nb_rounds, uint8_t* sqn) {
+  MYSQL_BIND param[2];
+  uint64_t increment = (uint64_t) MYSQL_SQN_INCREMENT * nb_rounds;
+
+  bind_uint64(param[0], &increment);
+  bind_string(param[1], imsi);
+  if (!execute(lease_sqns, param)) return false;
+  if (mysql_stmt_affected_rows(lease_sqns) != 1) {
+    Logger::amf_n1().error("No user with IMSI %s", imsi.c_str());
+    return false;
   }
-  sprintf(
-      query, "UPDATE `users` SET `sqn` = `sqn` + 32 WHERE `users`.`imsi`='%s'",
-      imsi.c_str());
+  mysql_sqn_from_uint64(mysql_stmt_insert_id(lease_sqns), sqn);
+  return true;
+}
 
-  pthread_mutex_lock(&db_desc->db_cs_mutex);
+//------------------------------------------------------------------------------
+mysql_db_pool::mysql_db_pool()
+    : db(), nb_connections(0), workers(), m_workers() {}
 
-  if (mysql_query(db_desc->db_conn, query)) {
-    pthread_mutex_unlock(&db_desc->db_cs_mutex);
-    Logger::amf_n1().error(
-        "Query execution failed: %s", mysql_error(db_desc->db_conn));
-    return;
-  }
-  do {
-    res = mysql_store_result(db_desc->db_conn);
-    if (res) {
-      mysql_free_result(res);
-    } else {
-      if (mysql_field_count(db_desc->db_conn) == 0) {
-        Logger::amf_n1().debug(
-            "[MySQL] %lld rows affected",
-            mysql_affected_rows(db_desc->db_conn));
-      } else {
-        Logger::amf_n1().error("Could not retrieve result set");
-        break;
-      }
+//------------------------------------------------------------------------------
+mysql_db_pool::~mysql_db_pool() {
+  stop();
+}
+
+//------------------------------------------------------------------------------
+bool mysql_db_pool::start(const database_t& db, const int nb_connections) {
+  std::unique_lock lock(m_workers);
+  this->db             = db;
+  this->nb_connections = (nb_connections > 0) ? nb_connections : 1;
+  return open();
+}
+
+//------------------------------------------------------------------------------
+bool mysql_db_pool::open() {
+  if (!workers.empty()) return true;
+  int nb_connected = 0;
+  for (int i = 0; i < nb_connections; i++) {
+    std::unique_ptr<worker> w = std::make_unique<worker>();
+    w->stopping               = false;
+    // Not connected: the thread of the connection connects again at its next
+    // job, the callers are never blocked
+    if (w->conn.connect(db)) nb_connected++;
+    w->thread = std::thread(&mysql_db_pool::run, this, w.get());
+    workers.push_back(std::move(w));
+  }
+  Logger::amf_n1().startup(
+      "%d/%d MySQL connections opened", nb_connected, nb_connections);
+  return nb_connected == nb_connections;
+}
+
+//------------------------------------------------------------------------------
+bool mysql_db_pool::async(const std::string& key, mysql_db_job_t job) {
+  std::shared_lock lock(m_workers);
+  if (workers.empty()) return false;  // stopped
+  worker* w = workers[std::hash<std::string>{}(key) % workers.size()].get();
+  {
+    std::unique_lock lock_jobs(w->m_jobs);
+    w->jobs.push_back(std::move(job));
+  }
+  w->c_jobs.notify_one();
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void mysql_db_pool::stop() {
+  std::unique_lock lock(m_workers);
+  close();
+}
+
+//------------------------------------------------------------------------------
+void mysql_db_pool::close() {
+  for (auto& w : workers) {
+    {
+      std::unique_lock lock(w->m_jobs);
+      w->stopping = true;
+    }
+    w->c_jobs.notify_one();
+  }
+  for (auto& w : workers) {
+    if (w->thread.joinable()) w->thread.join();
+  }
+  workers.clear();
+}
+
+//------------------------------------------------------------------------------
+void mysql_db_pool::run(worker* w) {
+  mysql_thread_init();
+  while (true) {
+    mysql_db_job_t job;
+    {
+      std::unique_lock lock(w->m_jobs);
+      w->c_jobs.wait(lock, [w] { return w->stopping || !w->jobs.empty(); });
+      if (w->jobs.empty()) break;
+      job = std::move(w->jobs.front());
+      w->jobs.pop_front();
     }
-    if ((status = mysql_next_result(db_desc->db_conn)) > 0)
-      Logger::amf_n1().error("Could not execute statement");
-  } while (status == 0);
-  pthread_mutex_unlock(&db_desc->db_cs_mutex);
-  return;
+    job(w->conn);
+  }
+  mysql_thread_end();
 }
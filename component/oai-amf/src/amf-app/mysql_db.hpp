@@ -30,14 +30,24 @@
 #define _MYSQL_DB_HANDLERS_H_
 
 #include <mysql/mysql.h>
-#include <pthread.h>
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #define KEY_LENGTH (16)
 #define SQN_LENGTH (6)
 #define RAND_LENGTH (16)
 
+// SQN step between two rounds of authentication vectors
+#define MYSQL_SQN_INCREMENT 32
+
 typedef struct {
   uint8_t key[KEY_LENGTH];
   uint8_t sqn[SQN_LENGTH];
@@ -45,15 +55,129 @@ typedef struct {
   uint8_t rand[RAND_LENGTH];
 } mysql_auth_info_t;
 
+/*
+ * SQN as an integer (as stored in the DB) and back
+ */
+uint64_t mysql_sqn_to_uint64(const uint8_t* sqn);
+void mysql_sqn_from_uint64(uint64_t value, uint8_t* sqn);
+
 typedef struct {
-  // mysql reference connector object
-  MYSQL* db_conn;
   std::string server;
   std::string user;
   std::string password;
   std::string database;
-
-  pthread_mutex_t db_cs_mutex;
 } database_t;
 
+// One connection to the DB with its prepared statements, only used by the
+// thread of the connection
+class mysql_db_connection {
+ public:
+  mysql_db_connection();
+  ~mysql_db_connection();
+  mysql_db_connection(mysql_db_connection const&) = delete;
+  void operator=(mysql_db_connection const&) = delete;
+
+  /*
+   * Connect (again) and prepare the statements
+   * @param [const database_t&] db: DB parameters
+   * @return true if connected
+   */
+  bool connect(const database_t& db);
+
+  /*
+   * Get the Authentication info of a UE
+   * @param [const std::string&] imsi: UE IMSI
+   * @param [mysql_auth_info_t&] resp: key, OPc, SQN and last RAND
+   * @return true if retrieved successfully, otherwise return false
+   */
+  bool get_auth_info(const std::string& imsi, mysql_auth_info_t& resp);
+
+  /*
+   * Store the RAND and the SQN of a UE
+   * @param [const std::string&] imsi: UE IMSI
+   * @param [const uint8_t*] rand: RAND
+   * @param [const uint8_t*] sqn: SQN
+   * @return true if stored successfully, otherwise return false
+   */
+  bool set_rand_sqn(
+      const std::string& imsi, const uint8_t* rand, const uint8_t* sqn);
+
+  /*
+   * Lease the SQNs of several rounds of a UE in one atomic statement: the SQN
+   * is read and incremented by nb_rounds * MYSQL_SQN_INCREMENT
+   * @param [const std::string&] imsi: UE IMSI
+   * @param [const int] nb_rounds: number of rounds
+   * @param [uint8_t*] sqn: SQN of the first round (output)
+   * @return true if updated successfully, otherwise return false
+   */
+  bool lease_sqn(const std::string& imsi, const int nb_rounds, uint8_t* sqn);
+
+ private:
+  void close();
+  // execute, reconnect and retry once if the server went away
+  bool execute(MYSQL_STMT*& stmt, MYSQL_BIND* params);
+
+  const database_t* db;
+  MYSQL* conn;
+  MYSQL_STMT* select_auth_info;
+  MYSQL_STMT* update_rand_sqn;
+  MYSQL_STMT* lease_sqns;
+};
+
+typedef std::function<void(mysql_db_connection&)> mysql_db_job_t;
+
+// Fixed set of connections, each with its own thread: the callers queue jobs
+// and are not blocked by the queries, the jobs send their result to an ITTI
+// task. The jobs of a key (IMSI) always go to the same connection, in order.
+class mysql_db_pool {
+ public:
+  mysql_db_pool();
+  ~mysql_db_pool();
+  mysql_db_pool(mysql_db_pool const&) = delete;
+  void operator=(mysql_db_pool const&) = delete;
+
+  /*
+   * Open the connections and start their threads, a connection that fails is
+   * opened again by its thread at its next job
+   * @param [const database_t&] db: DB parameters
+   * @param [const int] nb_connections: number of connections
+   * @return false if a connection cannot be established
+   */
+  bool start(const database_t& db, const int nb_connections);
+
+  /*
+   * Queue a job to the connection of the key
+   * @param [const std::string&] key: ordering key, e.g. IMSI
+   * @param [mysql_db_job_t] job: job, run by the thread of the connection
+   * (connected again by this thread if needed), never blocks the caller
+   * @return false if the pool is stopped
+   */
+  bool async(const std::string& key, mysql_db_job_t job);
+
+  /*
+   * Let the connections run the queued jobs and close them
+   * @return void
+   */
+  void stop();
+
+ private:
+  class worker {
+   public:
+    mysql_db_connection conn;
+    std::mutex m_jobs;
+    std::condition_variable c_jobs;
+    std::deque<mysql_db_job_t> jobs;
+    bool stopping;
+    std::thread thread;
+  };
+  bool open();
+  void close();
+  void run(worker* w);
+
+  database_t db;
+  int nb_connections;
+  std::vector<std::unique_ptr<worker>> workers;
+  mutable std::shared_mutex m_workers;
+};
+
 #endif
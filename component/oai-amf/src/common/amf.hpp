@@ -36,6 +36,23 @@
 // for CURL
 constexpr auto CURL_MIME_BOUNDARY = "----Boundary";
 #define CURL_TIMEOUT_MS 1000L
+// SBI client: connections kept per peer authority, HTTP/2 streams share one
+#define SBI_CLIENT_MAX_HOST_CONNECTIONS 16
+#define SBI_CLIENT_MAX_CACHED_CONNECTIONS 64
+#define SBI_CLIENT_POLL_TIMEOUT_MS 100
+// send_request_sync gives up if the client did not complete the request
+#define SBI_CLIENT_SYNC_TIMEOUT_MS (CURL_TIMEOUT_MS + 1000L)
+// Threads handling the NAS (N1) and NGAP (N2) messages each, 0: one per core
+#define AMF_N1_N2_WORKERS 0
+// Connections to the MySQL DB (local authentication), each with its thread
+#define AMF_MYSQL_CONNECTIONS 4
+// Authentication vectors generated ahead per subscriber (local
+// authentication): SQNs leased at once, refill when at most REFILL_THRESHOLD
+// are left, unused vectors dropped after EXPIRY_S, threads computing them
+#define AMF_AUTH_VECTORS_BATCH 4
+#define AMF_AUTH_VECTORS_REFILL_THRESHOLD 1
+#define AMF_AUTH_VECTORS_EXPIRY_S 300
+#define AMF_AUTH_VECTORS_WORKERS 2
 
 #define BUFFER_SIZE_4096 4096
 #define BUFFER_SIZE_2048 2048
@@ -31,6 +31,8 @@
 
 #include <stdint.h>
 
+#include "nas_algorithms.hpp"
+
 #define AUTH_KNAS_INT_SIZE 16 /* NAS integrity key     */
 #define AUTH_KNAS_ENC_SIZE 16 /* NAS cyphering key     */
 
@@ -106,6 +108,8 @@ class nas_secu_ctx {
   count_t ul_count;
   capability_t ue_algorithms;
   selected_algs nas_algs;
+  // key schedules of knas_enc/knas_int, reused by all the messages
+  nas_algorithms_ctx algorithms_ctx;
 };
 
 #endif
@@ -32,6 +32,7 @@
 #include <stdint.h>
 
 #include <map>
+#include <memory>
 
 #include "gNB_context.hpp"
 #include "amf.hpp"
@@ -45,7 +46,7 @@ typedef enum {
   NGAP_UE_WAITING_CRR
 } ng_ue_state_t;
 
-class ue_ngap_context {
+class ue_ngap_context : public std::enable_shared_from_this<ue_ngap_context> {
  public:
   ue_ngap_context() {
     ran_ue_ngap_id        = 0;
@@ -67,6 +68,12 @@ class ue_ngap_context {
     ncc                 = 0;
     initialUEMsg.buf    = new uint8_t[BUFFER_SIZE_1024];
     initialUEMsg.size   = 0;
+
+    indexed              = false;
+    index_gnb_assoc_id   = 0;
+    index_ran_ue_ngap_id = 0;
+    gnb_ues_prev         = nullptr;
+    gnb_ues_next         = nullptr;
   }
   virtual ~ue_ngap_context() {
     delete[] initialUEMsg.buf;
@@ -98,6 +105,14 @@ class ue_ngap_context {
   uint8_t ncc;  // Next Hop Chaining Counter
 
   OCTET_STRING_t initialUEMsg;
+
+  // Managed by ue_ngap_context_index: key the context is indexed with, links
+  // in the list of the UEs of the gNB
+  bool indexed;
+  sctp_assoc_id_t index_gnb_assoc_id;
+  uint32_t index_ran_ue_ngap_id;
+  ue_ngap_context* gnb_ues_prev;
+  ue_ngap_context* gnb_ues_next;
 };
 
 #endif
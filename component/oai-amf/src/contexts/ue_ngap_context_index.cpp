@@ -0,0 +1,171 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+/*! \file ue_ngap_context_index.cpp
+ \brief UE NGAP contexts indexed by (gNB association, RAN UE NGAP ID), with
+        the list of the UEs of each gNB, and by AMF UE NGAP ID
+ \date 2021
+ */
+#include "ue_ngap_context_index.hpp"
+
+//------------------------------------------------------------------------------
+ue_ngap_context_index::ue_ngap_context_index() : shards(), gnbs(), m_gnbs() {}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<ue_ngap_context> ue_ngap_context_index::find(
+    const sctp_assoc_id_t& gnb_assoc_id, const uint32_t& ran_ue_ngap_id) const {
+  const uint64_t k = key(gnb_assoc_id, ran_ue_ngap_id);
+  const shard& s   = shard_of(k);
+  std::shared_lock lock(s.m_ues);
+  auto it = s.ues.find(k);
+  if (it == s.ues.end()) return nullptr;
+  return it->second;
+}
+
+//------------------------------------------------------------------------------
+void ue_ngap_context_index::insert(
+    const std::shared_ptr<ue_ngap_context>& unc) {
+  std::unique_lock lock(m_gnbs);
+  const uint64_t k = key(unc->gnb_assoc_id, unc->ran_ue_ngap_id);
+  if (unc->indexed) {
+    if (key(unc->index_gnb_assoc_id, unc->index_ran_ue_ngap_id) == k) return;
+    erase(key(unc->index_gnb_assoc_id, unc->index_ran_ue_ngap_id));
+  }
+
+  std::shared_ptr<ue_ngap_context> replaced = {};
+  {
+    shard& s = shard_of(k);
+    std::unique_lock lock_ues(s.m_ues);
+    std::shared_ptr<ue_ngap_context>& entry = s.ues[k];
+    replaced.swap(entry);
+    entry = unc;
+  }
+  if (replaced) unlink(replaced.get());
+
+  unc->indexed              = true;
+  unc->index_gnb_assoc_id   = unc->gnb_assoc_id;
+  unc->index_ran_ue_ngap_id = unc->ran_ue_ngap_id;
+  link(unc.get());
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<ue_ngap_context> ue_ngap_context_index::remove(
+    const sctp_assoc_id_t& gnb_assoc_id, const uint32_t& ran_ue_ngap_id) {
+  std::unique_lock lock(m_gnbs);
+  return erase(key(gnb_assoc_id, ran_ue_ngap_id));
+}
+
+//------------------------------------------------------------------------------
+void ue_ngap_context_index::get_gnb_ues(
+    const sctp_assoc_id_t& gnb_assoc_id,
+    std::vector<std::shared_ptr<ue_ngap_context>>& ue_contexts) const {
+  std::unique_lock lock(m_gnbs);
+  auto it = gnbs.find(gnb_assoc_id);
+  if (it == gnbs.end()) return;
+  ue_contexts.reserve(ue_contexts.size() + it->second.size);
+  for (ue_ngap_context* unc = it->second.head; unc; unc = unc->gnb_ues_next)
+    ue_contexts.push_back(unc->shared_from_this());
+}
+
+//------------------------------------------------------------------------------
+std::size_t ue_ngap_context_index::gnb_ues_size(
+    const sctp_assoc_id_t& gnb_assoc_id) const {
+  std::unique_lock lock(m_gnbs);
+  auto it = gnbs.find(gnb_assoc_id);
+  if (it == gnbs.end()) return 0;
+  return it->second.size;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<ue_ngap_context> ue_ngap_context_index::erase(
+    const uint64_t k) {
+  std::shared_ptr<ue_ngap_context> unc = {};
+  {
+    shard& s = shard_of(k);
+    std::unique_lock lock_ues(s.m_ues);
+    auto it = s.ues.find(k);
+    if (it == s.ues.end()) return nullptr;
+    unc = std::move(it->second);
+    s.ues.erase(it);
+  }
+  unlink(unc.get());
+  return unc;
+}
+
+//------------------------------------------------------------------------------
+void ue_ngap_context_index::link(ue_ngap_context* unc) {
+  gnb_ues& g        = gnbs[unc->index_gnb_assoc_id];
+  unc->gnb_ues_prev = nullptr;
+  unc->gnb_ues_next = g.head;
+  if (g.head) g.head->gnb_ues_prev = unc;
+  g.head = unc;
+  g.size++;
+}
+
+//------------------------------------------------------------------------------
+void ue_ngap_context_index::unlink(ue_ngap_context* unc) {
+  auto it = gnbs.find(unc->index_gnb_assoc_id);
+  if (it != gnbs.end()) {
+    if (unc->gnb_ues_prev)
+      unc->gnb_ues_prev->gnb_ues_next = unc->gnb_ues_next;
+    else
+      it->second.head = unc->gnb_ues_next;
+    if (unc->gnb_ues_next) unc->gnb_ues_next->gnb_ues_prev = unc->gnb_ues_prev;
+    if (--it->second.size == 0) gnbs.erase(it);
+  }
+  unc->gnb_ues_prev = nullptr;
+  unc->gnb_ues_next = nullptr;
+  unc->indexed      = false;
+}
+
+//------------------------------------------------------------------------------
+ue_ngap_context_amf_index::ue_ngap_context_amf_index() : shards() {}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<ue_ngap_context> ue_ngap_context_amf_index::find(
+    const unsigned long& amf_ue_ngap_id) const {
+  const shard& s = shard_of(amf_ue_ngap_id);
+  std::shared_lock lock(s.m_ues);
+  auto it = s.ues.find(amf_ue_ngap_id);
+  if (it == s.ues.end()) return nullptr;
+  return it->second;
+}
+
+//------------------------------------------------------------------------------
+void ue_ngap_context_amf_index::insert(
+    const unsigned long& amf_ue_ngap_id,
+    const std::shared_ptr<ue_ngap_context>& unc) {
+  shard& s = shard_of(amf_ue_ngap_id);
+  std::unique_lock lock(s.m_ues);
+  s.ues[amf_ue_ngap_id] = unc;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<ue_ngap_context> ue_ngap_context_amf_index::remove(
+    const unsigned long& amf_ue_ngap_id) {
+  std::shared_ptr<ue_ngap_context> unc = {};
+  shard& s                             = shard_of(amf_ue_ngap_id);
+  std::unique_lock lock(s.m_ues);
+  auto it = s.ues.find(amf_ue_ngap_id);
+  if (it == s.ues.end()) return nullptr;
+  unc = std::move(it->second);
+  s.ues.erase(it);
+  return unc;
+}
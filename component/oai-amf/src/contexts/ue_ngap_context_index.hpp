@@ -0,0 +1,185 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+/*! \file ue_ngap_context_index.hpp
+ \brief UE NGAP contexts indexed by (gNB association, RAN UE NGAP ID), with
+        the list of the UEs of each gNB, and by AMF UE NGAP ID
+ \date 2021
+ */
+#ifndef _UE_NGAP_CONTEXT_INDEX_H_
+#define _UE_NGAP_CONTEXT_INDEX_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ue_ngap_context.hpp"
+
+// Power of 2
+#define UE_NGAP_CONTEXT_INDEX_SHARDS 64
+
+// A RAN UE NGAP ID is only unique within its gNB: the contexts are indexed by
+// (gnb_assoc_id, ran_ue_ngap_id) in hash maps sharded by key, a lookup only
+// takes the shared lock of its shard. Each gNB has an intrusive list of its
+// UEs (links in ue_ngap_context), the UEs of a gNB are enumerated or removed
+// in time proportional to their number (NG Reset, SCTP shutdown).
+// The updates of the lists are serialized by one mutex, taken before the
+// lock of a shard and never by the lookups.
+class ue_ngap_context_index {
+ public:
+  ue_ngap_context_index();
+  ue_ngap_context_index(ue_ngap_context_index const&) = delete;
+  void operator=(ue_ngap_context_index const&) = delete;
+
+  /*
+   * Get the UE NGAP context of a RAN UE NGAP ID of a gNB
+   * @param [const sctp_assoc_id_t&] gnb_assoc_id: gNB Association ID
+   * @param [const uint32_t&] ran_ue_ngap_id: RAN UE NGAP ID
+   * @return shared pointer to the context, nullptr if none
+   */
+  std::shared_ptr<ue_ngap_context> find(
+      const sctp_assoc_id_t& gnb_assoc_id,
+      const uint32_t& ran_ue_ngap_id) const;
+
+  /*
+   * Index a context with its gnb_assoc_id and ran_ue_ngap_id, moved if it
+   * was indexed with other ones (e.g. after a handover), replaces the context
+   * indexed with the same ones
+   * @param [const std::shared_ptr<ue_ngap_context>&] unc: UE NGAP context
+   * @return void
+   */
+  void insert(const std::shared_ptr<ue_ngap_context>& unc);
+
+  /*
+   * Remove the context of a RAN UE NGAP ID of a gNB
+   * @param [const sctp_assoc_id_t&] gnb_assoc_id: gNB Association ID
+   * @param [const uint32_t&] ran_ue_ngap_id: RAN UE NGAP ID
+   * @return shared pointer to the removed context, nullptr if none
+   */
+  std::shared_ptr<ue_ngap_context> remove(
+      const sctp_assoc_id_t& gnb_assoc_id, const uint32_t& ran_ue_ngap_id);
+
+  /*
+   * Get the contexts of the UEs of a gNB
+   * @param [const sctp_assoc_id_t&] gnb_assoc_id: gNB Association ID
+   * @param [std::vector<std::shared_ptr<ue_ngap_context>>&] ue_contexts:
+   * contexts, appended
+   * @return void
+   */
+  void get_gnb_ues(
+      const sctp_assoc_id_t& gnb_assoc_id,
+      std::vector<std::shared_ptr<ue_ngap_context>>& ue_contexts) const;
+
+  /*
+   * Number of UEs of a gNB
+   * @param [const sctp_assoc_id_t&] gnb_assoc_id: gNB Association ID
+   * @return number of UEs
+   */
+  std::size_t gnb_ues_size(const sctp_assoc_id_t& gnb_assoc_id) const;
+
+ private:
+  class shard {
+   public:
+    std::unordered_map<uint64_t, std::shared_ptr<ue_ngap_context>> ues;
+    mutable std::shared_mutex m_ues;
+  };
+
+  class gnb_ues {
+   public:
+    ue_ngap_context* head = nullptr;
+    std::size_t size      = 0;
+  };
+
+  static uint64_t key(
+      const sctp_assoc_id_t& gnb_assoc_id, const uint32_t& ran_ue_ngap_id) {
+    return ((uint64_t) gnb_assoc_id << 32) | ran_ue_ngap_id;
+  }
+  shard& shard_of(const uint64_t k) {
+    return shards[(k ^ (k >> 32)) & (UE_NGAP_CONTEXT_INDEX_SHARDS - 1)];
+  }
+  const shard& shard_of(const uint64_t k) const {
+    return shards[(k ^ (k >> 32)) & (UE_NGAP_CONTEXT_INDEX_SHARDS - 1)];
+  }
+  // m_gnbs held
+  std::shared_ptr<ue_ngap_context> erase(const uint64_t k);
+  void link(ue_ngap_context* unc);
+  void unlink(ue_ngap_context* unc);
+
+  shard shards[UE_NGAP_CONTEXT_INDEX_SHARDS];
+  std::unordered_map<sctp_assoc_id_t, gnb_ues> gnbs;
+  mutable std::mutex m_gnbs;
+};
+
+// The contexts indexed by AMF UE NGAP ID (messages from the other tasks), in
+// hash maps sharded the same way
+class ue_ngap_context_amf_index {
+ public:
+  ue_ngap_context_amf_index();
+  ue_ngap_context_amf_index(ue_ngap_context_amf_index const&) = delete;
+  void operator=(ue_ngap_context_amf_index const&) = delete;
+
+  /*
+   * Get the UE NGAP context of an AMF UE NGAP ID
+   * @param [const unsigned long&] amf_ue_ngap_id: AMF UE NGAP ID
+   * @return shared pointer to the context, nullptr if none
+   */
+  std::shared_ptr<ue_ngap_context> find(
+      const unsigned long& amf_ue_ngap_id) const;
+
+  /*
+   * Index a context with an AMF UE NGAP ID, replaces the context indexed with
+   * the same one
+   * @param [const unsigned long&] amf_ue_ngap_id: AMF UE NGAP ID
+   * @param [const std::shared_ptr<ue_ngap_context>&] unc: UE NGAP context
+   * @return void
+   */
+  void insert(
+      const unsigned long& amf_ue_ngap_id,
+      const std::shared_ptr<ue_ngap_context>& unc);
+
+  /*
+   * Remove the context of an AMF UE NGAP ID
+   * @param [const unsigned long&] amf_ue_ngap_id: AMF UE NGAP ID
+   * @return shared pointer to the removed context, nullptr if none
+   */
+  std::shared_ptr<ue_ngap_context> remove(const unsigned long& amf_ue_ngap_id);
+
+ private:
+  class shard {
+   public:
+    std::unordered_map<uint64_t, std::shared_ptr<ue_ngap_context>> ues;
+    mutable std::shared_mutex m_ues;
+  };
+
+  shard& shard_of(const uint64_t k) {
+    return shards[(k ^ (k >> 32)) & (UE_NGAP_CONTEXT_INDEX_SHARDS - 1)];
+  }
+  const shard& shard_of(const uint64_t k) const {
+    return shards[(k ^ (k >> 32)) & (UE_NGAP_CONTEXT_INDEX_SHARDS - 1)];
+  }
+
+  shard shards[UE_NGAP_CONTEXT_INDEX_SHARDS];
+};
+
+#endif
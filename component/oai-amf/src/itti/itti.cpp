@@ -39,75 +39,91 @@
 
 extern itti_mw* itti_inst;
 
-static itti_timer null_timer(
-    ITTI_INVALID_TIMER_ID, TASK_NONE, 0xFFFFFFFF, 0xFFFFFFFF, 0, 0);
-
 //------------------------------------------------------------------------------
 void itti_mw::timer_manager_task(
     const util::thread_sched_params& sched_params) {
   Logger::itti().info("Starting timer_manager_task");
   sched_params.apply(TASK_ITTI_TIMER, Logger::itti());
+  std::vector<itti_timer*> expired = {};
+  const uint64_t stats_period_us =
+      (uint64_t) ITTI_TASK_STATS_PERIOD_SECONDS * 1000000;
+  uint64_t stats_us = stats_period_us;
   while (true) {
     if (itti_inst->terminate) return;
+    if (itti_inst->timer_elapsed_us() >= stats_us) {
+      itti_inst->log_task_stats();
+      stats_us += stats_period_us;
+    }
     {
       std::unique_lock<std::mutex> lx(itti_inst->m_timers);
-      while (itti_inst->timers.empty()) {
-        itti_inst->c_timers.wait(lx);
-      }
-      std::set<itti_timer>::iterator it = itti_inst->timers.begin();
-      itti_inst->current_timer          = std::ref(*it);
-      itti_inst->timers.erase(it);
-      lx.unlock();
-
-      // check time-out
-      if (itti_inst->current_timer.time_out >
-          std::chrono::system_clock::now()) {
-        std::unique_lock<std::mutex> lto(itti_inst->m_timeout);
-        auto diff = itti_inst->current_timer.time_out -
-                    std::chrono::system_clock::now();
-        auto rc = itti_inst->c_timeout.wait_for(lto, diff);
-        lto.unlock();
-        if (std::cv_status::timeout == rc) {
-          // signal time-out
-          itti_msg_timeout mto(
-              TASK_ITTI_TIMER, itti_inst->current_timer.task_id,
-              itti_inst->current_timer.id, itti_inst->current_timer.arg1_user,
-              itti_inst->current_timer.arg2_user);
-          std::shared_ptr<itti_msg_timeout> msgsh =
-              std::make_shared<itti_msg_timeout>(mto);
-          int ret = itti_inst->send_msg(msgsh);
-        } else {
-          // other timer required ?
-          itti_inst->m_timers.lock();
-          if (itti_inst->current_timer.id != ITTI_INVALID_TIMER_ID) {
-            itti_inst->timers.insert(itti_inst->current_timer);
-          }
-          itti_inst->current_timer = null_timer;
-          itti_inst->m_timers.unlock();
-          // cout << "cv.wait released by other triggered timer end" << endl;
-        }
-      } else {
-        // signal time-out
-        itti_msg_timeout mto(
-            TASK_ITTI_TIMER, itti_inst->current_timer.task_id,
-            itti_inst->current_timer.id, itti_inst->current_timer.arg1_user,
-            itti_inst->current_timer.arg2_user);
-        std::shared_ptr<itti_msg_timeout> msgsh =
-            std::make_shared<itti_msg_timeout>(mto);
-        itti_inst->send_msg(msgsh);
+      itti_inst->timers.advance(
+          itti_inst->timer_elapsed_us() / ITTI_TIMER_TICK_US, expired);
+      if (expired.empty()) {
+        // the next timer, or the next log of the task stats
+        const uint64_t wakeup = std::min(
+            itti_inst->timers.next_wakeup(), stats_us / ITTI_TIMER_TICK_US);
+        itti_inst->timer_wakeup_tick = wakeup;
+        itti_inst->c_timers.wait_until(
+            lx, itti_inst->timer_epoch +
+                    std::chrono::microseconds(wakeup * ITTI_TIMER_TICK_US));
+        itti_inst->timer_wakeup_tick = 0;
+        continue;
       }
     }
+    // signal time-out, all the timers of the tick at once and out of the lock
+    for (auto timer : expired) {
+      std::shared_ptr<itti_msg_timeout> msgsh =
+          std::make_shared<itti_msg_timeout>(
+              TASK_ITTI_TIMER, timer->task_id, timer->id, timer->arg1_user,
+              timer->arg2_user);
+      itti_inst->send_msg(msgsh);
+      delete timer;
+    }
+    expired.clear();
+  }
+}
+
+//------------------------------------------------------------------------------
+bool itti_task_ctxt::push(const std::shared_ptr<itti_msg>& message) {
+  // The task thread cannot make room in its own mailbox
+  if (!mailbox.push(message, std::this_thread::get_id() != thread_id))
+    return false;
+  // Pairs with the fence in wait(): either the task sees the message or this
+  // thread sees the task sleeping
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> l(m_queue);
+    c_queue.notify_one();
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void itti_task_ctxt::wait() {
+  for (int i = 0; i < ITTI_MAILBOX_SPIN; i++) {
+    if (!mailbox.empty()) return;
+    itti_cpu_relax();
   }
+  std::unique_lock<std::mutex> lk(m_queue);
+  sleeping.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  while (mailbox.empty()) {
+    c_queue.wait(lk);
+  }
+  sleeping.store(false, std::memory_order_relaxed);
 }
+
 //------------------------------------------------------------------------------
 itti_mw::itti_mw()
     : timer_id(0),
       msg_number(0),
       created_tasks(0),
       ready_tasks(0),
+      timer_epoch(std::chrono::steady_clock::now()),
+      timers(0),
       m_timers(),
-      current_timer(null_timer),
-      m_timeout(),
+      c_timers(),
+      timer_wakeup_tick(0),
       m_timer_id(),
       terminate(false) {
   std::fill(itti_task_ctxts, itti_task_ctxts + TASK_MAX, nullptr);
@@ -117,9 +133,11 @@ itti_mw::itti_mw()
 itti_mw::~itti_mw() {
   std::cout << "~itti()" << std::endl;
   timer_thread.detach();
-  // wake up thread timer if necessary
-  std::unique_lock<std::mutex> l2(m_timeout);
-  c_timeout.notify_one();
+  {
+    // wake up thread timer if necessary
+    std::lock_guard<std::mutex> lx(m_timers);
+    c_timers.notify_one();
+  }
 
   for (int t = TASK_FIRST; t < TASK_MAX; t++) {
     if (itti_task_ctxts[t]) {
@@ -137,7 +155,18 @@ void itti_mw::start(const util::thread_sched_params& sched_params) {
 }
 //------------------------------------------------------------------------------
 timer_id_t itti_mw::increment_timer_id() {
-  return ++timer_id;
+  // under m_timers, skip the ids still armed once the counter wraps
+  do {
+    ++timer_id;
+  } while ((timer_id == ITTI_INVALID_TIMER_ID) || timers.exists(timer_id));
+  return timer_id;
+}
+
+//------------------------------------------------------------------------------
+uint64_t itti_mw::timer_elapsed_us() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - timer_epoch)
+      .count();
 }
 
 //------------------------------------------------------------------------------
@@ -182,6 +211,7 @@ int itti_mw::notify_task_ready(const task_id_t task_id) {
   if (itti_task_ctxts[task_id]) {
     itti_task_ctxts[task_id]->m_state.lock();
     if (itti_task_ctxts[task_id]->task_state == TASK_STATE_STARTING) {
+      itti_task_ctxts[task_id]->thread_id  = std::this_thread::get_id();
       itti_task_ctxts[task_id]->task_state = TASK_STATE_READY;
       itti_task_ctxts[task_id]->m_state.unlock();
       return RETURNok;
@@ -203,12 +233,9 @@ int itti_mw::send_msg(std::shared_ptr<itti_msg> message) {
     if (itti_task_ctxts[message->destination]) {
       if (itti_task_ctxts[message->destination]->task_state ==
           TASK_STATE_READY) {
-        std::unique_lock<std::mutex> l(
-            itti_task_ctxts[message->destination]->m_queue);
-        // res =
-        itti_task_ctxts[message->destination]->msg_queue.push(message);
-        itti_task_ctxts[message->destination]->c_queue.notify_one();
-        return RETURNok;
+        if (itti_task_ctxts[message->destination]->push(message))
+          return RETURNok;
+        return RETURNerror;
       } else if (
           itti_task_ctxts[message->destination]->task_state ==
           TASK_STATE_ENDED) {
@@ -236,9 +263,12 @@ int itti_mw::send_broadcast_msg(std::shared_ptr<itti_msg> message) {
     for (int t = TASK_FIRST; t < TASK_MAX; t++) {
       if (itti_task_ctxts[t]) {
         if (itti_task_ctxts[t]->task_state == TASK_STATE_READY) {
-          std::unique_lock<std::mutex> l(itti_task_ctxts[t]->m_queue);
-          itti_task_ctxts[t]->msg_queue.push(message);
-          itti_task_ctxts[t]->c_queue.notify_one();
+          if (!itti_task_ctxts[t]->push(message)) {
+            Logger::itti().warn(
+                "Broadcast message number %lu can not be sent from %d to %d, "
+                "full mailbox!",
+                message->msg_num, message->origin, t);
+          }
         } else if (itti_task_ctxts[t]->task_state == TASK_STATE_ENDED) {
           Logger::itti().warn(
               "Broadcast message number %lu can not be sent from %d to %d, "
@@ -271,37 +301,89 @@ int itti_mw::send_terminate_msg(task_id_t src_task_id) {
 //------------------------------------------------------------------------------
 std::shared_ptr<itti_msg> itti_mw::receive_msg(task_id_t task_id) {
   if ((TASK_FIRST <= task_id) && (TASK_MAX > task_id)) {
-    if (itti_task_ctxts[task_id]) {
-      std::unique_lock<std::mutex> lk(itti_task_ctxts[task_id]->m_queue);
-      while (itti_task_ctxts[task_id]->msg_queue.empty()) {
-        itti_task_ctxts[task_id]->c_queue.wait(lk);
+    itti_task_ctxt* t = itti_task_ctxts[task_id];
+    if (t) {
+      if (t->batch_pos == t->batch.size()) {
+        t->batch.clear();
+        t->batch_pos = 0;
+        while (!t->mailbox.pop(t->batch, ITTI_MAILBOX_BATCH)) {
+          t->wait();
+        }
       }
-      std::shared_ptr<itti_msg> msg =
-          itti_task_ctxts[task_id]->msg_queue.front();
-      itti_task_ctxts[task_id]->msg_queue.pop();
-      return msg;
+      return std::move(t->batch[t->batch_pos++]);
     }
   }
   Logger::itti().warn("received message failed, bad task id");
   return nullptr;
 }
 
+//------------------------------------------------------------------------------
+std::size_t itti_mw::receive_msgs(
+    task_id_t task_id, std::vector<std::shared_ptr<itti_msg>>& msgs) {
+  if ((TASK_FIRST <= task_id) && (TASK_MAX > task_id)) {
+    itti_task_ctxt* t = itti_task_ctxts[task_id];
+    if (t) {
+      // first what receive_msg left
+      if (t->batch_pos < t->batch.size()) {
+        std::size_t n = t->batch.size() - t->batch_pos;
+        for (; t->batch_pos < t->batch.size(); t->batch_pos++) {
+          msgs.push_back(std::move(t->batch[t->batch_pos]));
+        }
+        return n;
+      }
+      std::size_t n = 0;
+      while (!(n = t->mailbox.pop(msgs, ITTI_MAILBOX_BATCH))) {
+        t->wait();
+      }
+      return n;
+    }
+  }
+  Logger::itti().warn("received message failed, bad task id");
+  return 0;
+}
+
 //------------------------------------------------------------------------------
 std::shared_ptr<itti_msg> itti_mw::poll_msg(task_id_t task_id) {
   if ((TASK_FIRST <= task_id) && (TASK_MAX > task_id)) {
-    if (itti_task_ctxts[task_id]) {
-      std::lock_guard<std::mutex> lk(itti_task_ctxts[task_id]->m_queue);
-      if (!itti_task_ctxts[task_id]->msg_queue.empty()) {
-        std::shared_ptr<itti_msg> msg =
-            itti_task_ctxts[task_id]->msg_queue.front();
-        itti_task_ctxts[task_id]->msg_queue.pop();
-        return msg;
+    itti_task_ctxt* t = itti_task_ctxts[task_id];
+    if (t) {
+      if (t->batch_pos == t->batch.size()) {
+        t->batch.clear();
+        t->batch_pos = 0;
+        if (!t->mailbox.pop(t->batch, ITTI_MAILBOX_BATCH)) return nullptr;
       }
+      return std::move(t->batch[t->batch_pos++]);
     }
   }
   return nullptr;
 }
 
+//------------------------------------------------------------------------------
+int itti_mw::get_task_stats(task_id_t task_id, itti_task_stats_t& stats) const {
+  if ((TASK_FIRST <= task_id) && (TASK_MAX > task_id)) {
+    if (itti_task_ctxts[task_id]) {
+      itti_task_ctxts[task_id]->mailbox.get_stats(stats);
+      return RETURNok;
+    }
+  }
+  return RETURNerror;
+}
+
+//------------------------------------------------------------------------------
+void itti_mw::log_task_stats() const {
+  for (int t = TASK_FIRST; t < TASK_MAX; t++) {
+    itti_task_stats_t stats = {};
+    if (get_task_stats((task_id_t) t, stats) == RETURNok) {
+      Logger::itti().info(
+          "Task %d: sent %lu received %lu, depth %lu (max %lu), full %lu, "
+          "dropped %lu, latency avg %lu ns max %lu ns",
+          t, stats.sent, stats.received, stats.depth, stats.max_depth,
+          stats.full, stats.dropped, stats.latency_avg_ns,
+          stats.latency_max_ns);
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 void itti_mw::wait_tasks_end(void) {
   Logger::itti().info("Waiting ITTI tasks closed");
@@ -316,6 +398,7 @@ void itti_mw::wait_tasks_end(void) {
     }
   }
   Logger::itti().info("All ITTI tasks closed");
+  log_task_stats();
 }
 
 //------------------------------------------------------------------------------
@@ -324,17 +407,17 @@ timer_id_t itti_mw::timer_setup(
     uint64_t arg1_user, uint64_t arg2_user) {
   // Not sending to task timer
   if ((TASK_FIRST < task_id) && (TASK_MAX > task_id)) {
-    itti_timer t(
-        increment_timer_id(), task_id, interval_sec, interval_us, arg1_user,
-        arg2_user);
-    timer_id_t id = t.id;
-    std::unique_lock<std::mutex> l(m_timers);
-    timers.insert(t);
-    c_timers.notify_one();
-
+    const uint64_t interval_us_total =
+        (uint64_t) interval_sec * 1000000 + interval_us;
+    std::lock_guard<std::mutex> l(m_timers);
+    // rounded up to the next tick, a timer never expires early
+    const uint64_t expires =
+        (timer_elapsed_us() + interval_us_total + ITTI_TIMER_TICK_US - 1) /
+        ITTI_TIMER_TICK_US;
+    timer_id_t id = increment_timer_id();
+    timers.add(new itti_timer(id, task_id, expires, arg1_user, arg2_user));
     // wake up thread timer if necessary
-    std::unique_lock<std::mutex> l2(m_timeout);
-    c_timeout.notify_one();
+    if (expires < timer_wakeup_tick) c_timers.notify_one();
     return id;
   }
   return ITTI_INVALID_TIMER_ID;
@@ -343,24 +426,7 @@ timer_id_t itti_mw::timer_setup(
 //------------------------------------------------------------------------------
 int itti_mw::timer_remove(timer_id_t timer_id) {
   std::lock_guard<std::mutex> lk(m_timers);
-  if (current_timer.id == timer_id) {
-    // cout << "timer_remove() current_timer.id == timer_id" << endl;
-    current_timer = null_timer;
-    c_timers.notify_one();
-    // wake up thread timer if necessary
-    std::unique_lock<std::mutex> l2(m_timeout);
-    c_timeout.notify_one();
-    return RETURNok;
-  } else {
-    std::set<itti_timer>::iterator it = itti_inst->timers.begin();
-    while (it != itti_inst->timers.end()) {
-      if (it->id == timer_id) {
-        itti_inst->timers.erase(it);
-        return RETURNok;
-      }
-      ++it;
-    }
-  }
+  if (timers.remove(timer_id)) return RETURNok;
   Logger::itti().trace("Removing timer 0x%lx: Not found", timer_id);
   return RETURNerror;
 }
@@ -80,11 +80,15 @@ typedef enum {
   UE_RADIO_CAP_IND,
   UL_NAS_DATA_IND,  // task amf_n1 message id
   DOWNLINK_NAS_TRANSFER,
+  N1_AUTH_VECTOR,     // task amf_n1, from the authentication vectors cache
+  N1_AUSF_RESPONSE,   // task amf_n1, from the SBI client
   NAS_SIG_ESTAB_REQ,  // task amf_app
   N1N2_MESSAGE_TRANSFER_REQ,
   REROUTE_NAS_REQ,
   NSMF_PDU_SESSION_CREATE_SM_CTX,
   NSMF_PDU_SESSION_UPDATE_SM_CTX,
+  NSMF_PDU_SESSION_SM_CTX_RESPONSE,  // task amf_n11, from the SBI client
+  N11_SMF_SELECTION_RESPONSE,        // task amf_n11, from the SBI client
   N11_REGISTER_NF_INSTANCE_REQUEST,
   N11_REGISTER_NF_INSTANCE_RESPONSE,
   N11_UPDATE_NF_INSTANCE_REQUEST,
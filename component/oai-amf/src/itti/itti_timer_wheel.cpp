@@ -0,0 +1,148 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+/*! \file itti_timer_wheel.cpp
+ \brief Hierarchical timing wheel holding the ITTI timers
+ \date 2021
+ */
+#include "itti_timer_wheel.hpp"
+
+#include <string.h>
+
+//------------------------------------------------------------------------------
+itti_timer_wheel::itti_timer_wheel(const uint64_t now)
+    : current(now), timers() {
+  memset(slots, 0, sizeof(slots));
+}
+
+//------------------------------------------------------------------------------
+itti_timer_wheel::~itti_timer_wheel() {
+  for (auto& it : timers) {
+    delete it.second;
+  }
+}
+
+//------------------------------------------------------------------------------
+void itti_timer_wheel::link(itti_timer* timer) {
+  // already late: next tick
+  if (timer->expires < current) timer->expires = current;
+  uint64_t delta = timer->expires - current;
+  if (delta > ITTI_TIMER_MAX_TICKS) {
+    delta          = ITTI_TIMER_MAX_TICKS;
+    timer->expires = current + delta;
+  }
+
+  int level = 0;
+  while ((level < ITTI_TIMER_WHEEL_LEVELS - 1) &&
+         (delta >= (1ULL << (ITTI_TIMER_WHEEL_BITS * (level + 1))))) {
+    level++;
+  }
+  const uint32_t idx =
+      (timer->expires >> (ITTI_TIMER_WHEEL_BITS * level)) &
+      ITTI_TIMER_WHEEL_MASK;
+
+  timer->slot = &slots[level][idx];
+  timer->prev = nullptr;
+  timer->next = *timer->slot;
+  if (timer->next) timer->next->prev = timer;
+  *timer->slot = timer;
+}
+
+//------------------------------------------------------------------------------
+void itti_timer_wheel::unlink(itti_timer* timer) {
+  if (timer->prev)
+    timer->prev->next = timer->next;
+  else
+    *timer->slot = timer->next;
+  if (timer->next) timer->next->prev = timer->prev;
+  timer->slot = nullptr;
+  timer->prev = nullptr;
+  timer->next = nullptr;
+}
+
+//------------------------------------------------------------------------------
+void itti_timer_wheel::add(itti_timer* timer) {
+  timers[timer->id] = timer;
+  link(timer);
+}
+
+//------------------------------------------------------------------------------
+bool itti_timer_wheel::remove(const timer_id_t id) {
+  auto it = timers.find(id);
+  if (it == timers.end()) return false;
+  itti_timer* timer = it->second;
+  timers.erase(it);
+  unlink(timer);
+  delete timer;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+uint32_t itti_timer_wheel::cascade(const int level) {
+  const uint32_t idx =
+      (current >> (ITTI_TIMER_WHEEL_BITS * level)) & ITTI_TIMER_WHEEL_MASK;
+  itti_timer* timer    = slots[level][idx];
+  slots[level][idx]    = nullptr;
+  while (timer) {
+    itti_timer* next = timer->next;
+    link(timer);
+    timer = next;
+  }
+  return idx;
+}
+
+//------------------------------------------------------------------------------
+void itti_timer_wheel::advance(
+    const uint64_t now, std::vector<itti_timer*>& expired) {
+  while (current <= now) {
+    if (timers.empty()) {
+      current = now + 1;
+      return;
+    }
+    const uint32_t idx = current & ITTI_TIMER_WHEEL_MASK;
+    if ((!idx) && (!cascade(1)) && (!cascade(2))) {
+      cascade(3);
+    }
+    itti_timer* timer = slots[0][idx];
+    slots[0][idx]     = nullptr;
+    while (timer) {
+      itti_timer* next = timer->next;
+      timers.erase(timer->id);
+      timer->slot = nullptr;
+      timer->prev = nullptr;
+      timer->next = nullptr;
+      expired.push_back(timer);
+      timer = next;
+    }
+    current++;
+  }
+}
+
+//------------------------------------------------------------------------------
+uint64_t itti_timer_wheel::next_wakeup() const {
+  if (timers.empty()) return UINT64_MAX;
+  // the coarse levels are only looked at when level 0 wraps
+  const uint64_t end = (current | ITTI_TIMER_WHEEL_MASK) + 1;
+  if (!(current & ITTI_TIMER_WHEEL_MASK)) return current;
+  for (uint64_t t = current; t < end; t++) {
+    if (slots[0][t & ITTI_TIMER_WHEEL_MASK]) return t;
+  }
+  return end;
+}
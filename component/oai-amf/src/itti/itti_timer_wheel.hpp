@@ -0,0 +1,133 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+/*! \file itti_timer_wheel.hpp
+ \brief Hierarchical timing wheel holding the ITTI timers
+ \date 2021
+ */
+#ifndef SRC_OAI_ITTI_ITTI_TIMER_WHEEL_HPP_INCLUDED_
+#define SRC_OAI_ITTI_ITTI_TIMER_WHEEL_HPP_INCLUDED_
+
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "itti_msg.hpp"
+
+typedef uint32_t timer_id_t;
+#define ITTI_INVALID_TIMER_ID (timer_id_t) 0
+
+// Resolution of the timers, intervals are rounded up to a tick
+#define ITTI_TIMER_TICK_US 1000
+// 4 levels of 256 slots: 2^32 ticks, about 49 days with 1 ms ticks
+#define ITTI_TIMER_WHEEL_LEVELS 4
+#define ITTI_TIMER_WHEEL_BITS 8
+#define ITTI_TIMER_WHEEL_SLOTS (1 << ITTI_TIMER_WHEEL_BITS)
+#define ITTI_TIMER_WHEEL_MASK (ITTI_TIMER_WHEEL_SLOTS - 1)
+#define ITTI_TIMER_MAX_TICKS 0xFFFFFFFFULL
+
+class itti_timer {
+ public:
+  itti_timer(
+      const timer_id_t id, const task_id_t task_id, const uint64_t expires,
+      uint64_t arg1_user, uint64_t arg2_user)
+      : id(id),
+        task_id(task_id),
+        expires(expires),
+        arg1_user(arg1_user),
+        arg2_user(arg2_user),
+        slot(nullptr),
+        prev(nullptr),
+        next(nullptr) {}
+  itti_timer(itti_timer const&) = delete;
+  void operator=(itti_timer const&) = delete;
+
+  timer_id_t id;
+  task_id_t task_id;
+  uint64_t expires;  // tick
+  uint64_t arg1_user;
+  uint64_t arg2_user;
+
+  // slot list the timer is linked in
+  itti_timer** slot;
+  itti_timer* prev;
+  itti_timer* next;
+};
+
+// Not thread safe, itti_mw serializes the accesses.
+// Timers due within 256 ticks sit in the slot of their tick in level 0, the
+// others in a coarser level and are moved down (cascaded) when level 0 wraps:
+// add and remove are O(1), a tick only visits the timers it expires.
+class itti_timer_wheel {
+ public:
+  explicit itti_timer_wheel(const uint64_t now);
+  ~itti_timer_wheel();
+  itti_timer_wheel(itti_timer_wheel const&) = delete;
+  void operator=(itti_timer_wheel const&) = delete;
+
+  /*
+   * Arm a timer, the wheel owns it until it expires or is removed
+   * @param [itti_timer*] timer: timer, expires set
+   * @return void
+   */
+  void add(itti_timer* timer);
+
+  /*
+   * Cancel a timer
+   * @param [const timer_id_t] id: timer id
+   * @return false if not armed
+   */
+  bool remove(const timer_id_t id);
+
+  /*
+   * Process all ticks up to now
+   * @param [const uint64_t] now: current tick
+   * @param [std::vector<itti_timer*>&] expired: expired timers, owned by the
+   * caller
+   * @return void
+   */
+  void advance(const uint64_t now, std::vector<itti_timer*>& expired);
+
+  /*
+   * Tick at which advance has to be called again, UINT64_MAX if empty
+   */
+  uint64_t next_wakeup() const;
+
+  bool exists(const timer_id_t id) const {
+    return timers.find(id) != timers.end();
+  }
+
+  std::size_t size() const { return timers.size(); }
+
+ private:
+  void link(itti_timer* timer);
+  void unlink(itti_timer* timer);
+  // move the timers of a slot of a coarse level to the finer levels, return
+  // the index of the slot
+  uint32_t cascade(const int level);
+
+  // next tick to process
+  uint64_t current;
+  itti_timer* slots[ITTI_TIMER_WHEEL_LEVELS][ITTI_TIMER_WHEEL_SLOTS];
+  std::unordered_map<timer_id_t, itti_timer*> timers;
+};
+
+#endif /* SRC_OAI_ITTI_ITTI_TIMER_WHEEL_HPP_INCLUDED_ */
@@ -0,0 +1,139 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+/*! \file itti_workers.cpp
+ \brief Pool of threads sharing the messages of an ITTI task, the messages with
+        the same key are handled in order by the same thread
+ \date 2021
+ */
+#include "itti_workers.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "logger.hpp"
+
+// Queued to every worker by dispatch_all, the last worker reaching it handles
+// the message while the others wait
+class itti_workers_barrier : public itti_msg {
+ public:
+  itti_workers_barrier(
+      const task_id_t task_id, const std::shared_ptr<itti_msg>& msg,
+      const std::size_t nb_workers)
+      : itti_msg(ITTI_MSG_TYPE_NONE, task_id, task_id),
+        msg(msg),
+        nb_workers(nb_workers),
+        arrived(0),
+        done(false),
+        m_barrier(),
+        c_barrier() {}
+
+  void arrive(itti_worker_handler_t& handler) {
+    std::unique_lock<std::mutex> lk(m_barrier);
+    if (++arrived < nb_workers) {
+      c_barrier.wait(lk, [this] { return done; });
+      return;
+    }
+    lk.unlock();
+    handler(msg.get());
+    lk.lock();
+    done = true;
+    c_barrier.notify_all();
+  }
+
+ private:
+  std::shared_ptr<itti_msg> msg;
+  const std::size_t nb_workers;
+  std::size_t arrived;
+  bool done;
+  std::mutex m_barrier;
+  std::condition_variable c_barrier;
+};
+
+//------------------------------------------------------------------------------
+itti_workers::itti_workers(
+    const task_id_t task_id, const int nb_workers,
+    itti_worker_handler_t handler)
+    : task_id(task_id), handler(handler), workers() {
+  int nb = nb_workers;
+  if (nb <= 0) nb = std::thread::hardware_concurrency();
+  if (nb <= 0) nb = 1;
+  for (int i = 0; i < nb; i++) {
+    itti_task_ctxt* worker = new itti_task_ctxt(task_id);
+    workers.push_back(worker);
+    worker->thread = std::thread(&itti_workers::run, this, worker);
+  }
+  Logger::itti().startup("Task %d: %d workers started", task_id, nb);
+}
+
+//------------------------------------------------------------------------------
+itti_workers::~itti_workers() {
+  terminate();
+  for (auto worker : workers) delete worker;
+}
+
+//------------------------------------------------------------------------------
+void itti_workers::dispatch(
+    const uint64_t key, const std::shared_ptr<itti_msg>& msg) {
+  workers[key % workers.size()]->push(msg);
+}
+
+//------------------------------------------------------------------------------
+void itti_workers::dispatch_all(const std::shared_ptr<itti_msg>& msg) {
+  std::shared_ptr<itti_msg> barrier =
+      std::make_shared<itti_workers_barrier>(task_id, msg, workers.size());
+  for (auto worker : workers) worker->push(barrier);
+}
+
+//------------------------------------------------------------------------------
+void itti_workers::terminate() {
+  std::shared_ptr<itti_msg> msg =
+      std::make_shared<itti_msg_terminate>(task_id, task_id);
+  for (auto worker : workers) {
+    if (worker->thread.joinable()) worker->push(msg);
+  }
+  for (auto worker : workers) {
+    if (worker->thread.joinable()) worker->thread.join();
+  }
+}
+
+//------------------------------------------------------------------------------
+void itti_workers::run(itti_task_ctxt* worker) {
+  std::vector<std::shared_ptr<itti_msg>> msgs = {};
+  msgs.reserve(ITTI_MAILBOX_BATCH);
+  while (true) {
+    msgs.clear();
+    while (!worker->mailbox.pop(msgs, ITTI_MAILBOX_BATCH)) {
+      worker->wait();
+    }
+    for (auto& msg : msgs) {
+      if (msg->msg_type == TERMINATE) return;
+      if (msg->msg_type == ITTI_MSG_TYPE_NONE) {
+        if (itti_workers_barrier* barrier =
+                dynamic_cast<itti_workers_barrier*>(msg.get())) {
+          barrier->arrive(handler);
+          continue;
+        }
+      }
+      handler(msg.get());
+    }
+  }
+}
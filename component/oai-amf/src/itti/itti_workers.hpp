@@ -0,0 +1,93 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+/*! \file itti_workers.hpp
+ \brief Pool of threads sharing the messages of an ITTI task, the messages with
+        the same key are handled in order by the same thread
+ \date 2021
+ */
+#ifndef SRC_OAI_ITTI_ITTI_WORKERS_HPP_INCLUDED_
+#define SRC_OAI_ITTI_ITTI_WORKERS_HPP_INCLUDED_
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "itti.hpp"
+
+typedef std::function<void(itti_msg*)> itti_worker_handler_t;
+
+// The task thread receives the messages of the task and dispatches them:
+// - dispatch(key, msg): the worker is chosen by the key (e.g. UE id), a UE is
+//   always handled by the same worker, different UEs in parallel
+// - dispatch_all(msg): the message is handled once all the messages
+//   dispatched before it have been handled, and before any message dispatched
+//   after it (e.g. procedures of a gNB touching all its UEs)
+// Only the task thread dispatches.
+class itti_workers {
+ public:
+  /*
+   * Start the workers
+   * @param [const task_id_t] task_id: task the messages are received by
+   * @param [const int] nb_workers: number of threads, 0 for one per core
+   * @param [itti_worker_handler_t] handler: called by the workers
+   */
+  itti_workers(
+      const task_id_t task_id, const int nb_workers,
+      itti_worker_handler_t handler);
+  ~itti_workers();
+  itti_workers(itti_workers const&) = delete;
+  void operator=(itti_workers const&) = delete;
+
+  /*
+   * Queue a message to the worker of the key
+   * @param [const uint64_t] key: ordering key
+   * @param [std::shared_ptr<itti_msg>&] msg: message
+   * @return void
+   */
+  void dispatch(const uint64_t key, const std::shared_ptr<itti_msg>& msg);
+
+  /*
+   * Queue a message to be handled while all the workers are stopped
+   * @param [std::shared_ptr<itti_msg>&] msg: message
+   * @return void
+   */
+  void dispatch_all(const std::shared_ptr<itti_msg>& msg);
+
+  /*
+   * Let the workers handle the pending messages and stop them
+   * @return void
+   */
+  void terminate();
+
+  std::size_t size() const { return workers.size(); }
+
+ private:
+  void run(itti_task_ctxt* worker);
+
+  const task_id_t task_id;
+  itti_worker_handler_t handler;
+  std::vector<itti_task_ctxt*> workers;
+};
+
+#endif /* SRC_OAI_ITTI_ITTI_WORKERS_HPP_INCLUDED_ */
@@ -26,6 +26,7 @@
 
 #include "NgapIEsStruct.hpp"
 #include "itti_msg.hpp"
+#include "sctp_server.hpp"
 using namespace ngap;
 #include "bstrlib.h"
 
@@ -52,7 +53,8 @@ class itti_nas_signalling_establishment_request : public itti_msg_amf_app {
       : itti_msg_amf_app(NAS_SIG_ESTAB_REQ, origin, destination) {}
   itti_nas_signalling_establishment_request(
       const itti_nas_signalling_establishment_request& i)
-      : itti_msg_amf_app(i) {}
+      : itti_msg_amf_app(i), gnb_assoc_id(i.gnb_assoc_id) {}
+  sctp::sctp_assoc_id_t gnb_assoc_id;
   int rrc_cause;
   int ueCtxReq;
   NrCgi_t cgi;
@@ -22,8 +22,11 @@
 #ifndef _ITTI_AMF_N1_H_
 #define _ITTI_AMF_N1_H_
 
+#include <nlohmann/json.hpp>
+
 #include "bstrlib.h"
 #include "itti_msg.hpp"
+#include "authentication_algorithms_with_5gaka.hpp"
 
 class itti_msg_n1 : public itti_msg {
  public:
@@ -74,4 +77,45 @@ class itti_downlink_nas_transfer : public itti_msg_n1 {
   std::string n2sm_info_type;
 };
 
+class itti_n1_auth_vector : public itti_msg_n1 {
+ public:
+  itti_n1_auth_vector(const task_id_t origin, const task_id_t destination)
+      : itti_msg_n1(N1_AUTH_VECTOR, origin, destination),
+        result(false),
+        is_resynchronization(false),
+        vector() {}
+  itti_n1_auth_vector(const itti_n1_auth_vector& i)
+      : itti_msg_n1(i),
+        result(i.result),
+        is_resynchronization(i.is_resynchronization),
+        vector(i.vector) {}
+
+ public:
+  bool result;
+  bool is_resynchronization;  // after a Synch failure
+  _5G_HE_AV_t vector;
+};
+
+class itti_n1_ausf_response : public itti_msg_n1 {
+ public:
+  itti_n1_ausf_response(const task_id_t origin, const task_id_t destination)
+      : itti_msg_n1(N1_AUSF_RESPONSE, origin, destination),
+        is_confirmation(false),
+        is_resynchronization(false),
+        http_code(0),
+        response_data() {}
+  itti_n1_ausf_response(const itti_n1_ausf_response& i)
+      : itti_msg_n1(i),
+        is_confirmation(i.is_confirmation),
+        is_resynchronization(i.is_resynchronization),
+        http_code(i.http_code),
+        response_data(i.response_data) {}
+
+ public:
+  bool is_confirmation;       // 5G AKA Confirmation, else UE Authentication
+  bool is_resynchronization;  // after a Synch failure
+  uint32_t http_code;         // 0 if no response was received
+  nlohmann::json response_data;
+};
+
 #endif
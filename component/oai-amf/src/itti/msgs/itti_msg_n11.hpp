@@ -22,6 +22,7 @@
 #ifndef _ITTI_N11_MSG_H_
 #define _ITTI_N11_MSG_H_
 
+#include <memory>
 #include <string>
 
 #include "amf.hpp"
@@ -64,6 +65,33 @@ class itti_nsmf_pdusession_create_sm_context : public itti_msg_n11 {
   plmn_t plmn;
 };
 
+// SMF discovered from the NSSF/NRF, continues the PDU session creation
+class itti_n11_smf_selection_response : public itti_msg_n11 {
+ public:
+  itti_n11_smf_selection_response(
+      const task_id_t origin, const task_id_t destination)
+      : itti_msg_n11(N11_SMF_SELECTION_RESPONSE, origin, destination) {
+    result = false;
+  }
+  itti_n11_smf_selection_response(const itti_n11_smf_selection_response& i)
+      : itti_msg_n11(i) {
+    request         = i.request;
+    supi            = i.supi;
+    result          = i.result;
+    smf_addr        = i.smf_addr;
+    smf_port        = i.smf_port;
+    smf_api_version = i.smf_api_version;
+  }
+
+ public:
+  std::shared_ptr<itti_nsmf_pdusession_create_sm_context> request;
+  std::string supi;
+  bool result;
+  std::string smf_addr;
+  std::string smf_port;
+  std::string smf_api_version;
+};
+
 class itti_pdu_session_resource_setup_response : public itti_msg_n11 {
  public:
   itti_pdu_session_resource_setup_response(
@@ -130,6 +158,39 @@ class itti_nsmf_pdusession_release_sm_context : public itti_msg_n11 {
   std::string context_location;
 };
 
+// Response of the SMF to a request of amf_n11::curl_http_client, handed over
+// by the SBI client thread
+class itti_nsmf_pdusession_sm_context_response : public itti_msg_n11 {
+ public:
+  itti_nsmf_pdusession_sm_context_response(
+      const task_id_t origin, const task_id_t destination)
+      : itti_msg_n11(NSMF_PDU_SESSION_SM_CTX_RESPONSE, origin, destination) {
+    pdu_session_id = 0;
+    promise_id     = 0;
+    http_code      = 0;
+  }
+  itti_nsmf_pdusession_sm_context_response(
+      const itti_nsmf_pdusession_sm_context_response& i)
+      : itti_msg_n11(i) {
+    remote_uri     = i.remote_uri;
+    supi           = i.supi;
+    pdu_session_id = i.pdu_session_id;
+    promise_id     = i.promise_id;
+    http_code      = i.http_code;
+    body           = i.body;
+    headers        = i.headers;
+  }
+
+ public:
+  std::string remote_uri;
+  std::string supi;
+  uint8_t pdu_session_id;
+  uint32_t promise_id;
+  uint32_t http_code;  // 0 if no response was received
+  std::string body;
+  std::string headers;
+};
+
 //-----------------------------------------------------------------------------
 class itti_n11_register_nf_instance_request : public itti_msg_n11 {
  public:
@@ -88,6 +88,7 @@ void amf_signal_handler(int s) {
     std::cout << "ITTI memory done." << std::endl;
   }
   std::cout << "Freeing Allocated memory done" << std::endl;
+  Logger::flush();
   exit(s);
 }
 
@@ -100,8 +101,15 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  Logger::init("AMF", Options::getlogStdout(), Options::getlogRotFilelog());
+  Logger::init(
+      "AMF", Options::getlogStdout(), Options::getlogRotFilelog(),
+      Options::getlogAsync());
   Logger::amf_app().startup("Options parsed!");
+  if (!Options::getlogLevels().empty() &&
+      !Logger::set_levels(Options::getlogLevels())) {
+    std::cout << "Invalid log levels " << Options::getlogLevels() << std::endl;
+    return 1;
+  }
 
   // TODO: to be optimized
   struct sigaction sigIntHandler;
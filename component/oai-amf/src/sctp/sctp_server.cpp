@@ -32,13 +32,16 @@
 extern "C" {
 #include <arpa/inet.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <netinet/in.h>
 #include <netinet/sctp.h>
+#include <poll.h>
 #include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -47,20 +50,38 @@ extern "C" {
 #include "bstrlib.h"
 }
 
+#include <algorithm>
 #include <iostream>
 
 namespace sctp {
 
 //------------------------------------------------------------------------------
-sctp_server::sctp_server(const char* address, const uint16_t port_num) {
+static int sctp_set_nonblocking(int sd) {
+  int flags = fcntl(sd, F_GETFL, 0);
+  if (flags < 0) return RETURNerror;
+  return fcntl(sd, F_SETFL, flags | O_NONBLOCK);
+}
+
+//------------------------------------------------------------------------------
+static void sctp_release_association(sctp_association_t* association) {
+  // Last user gone, the socket can be closed (and its number reused)
+  if (association->sd >= 0) close(association->sd);
+  if (association->peer_addresses)
+    sctp_freepaddrs(association->peer_addresses);
+  delete association;
+}
+
+//------------------------------------------------------------------------------
+sctp_server::sctp_server(const char* address, const uint16_t port_num)
+    : next_io_thread(0), buffer_pool() {
   Logger::sctp().debug("creating socket!!");
-  create_socket(address, port_num);
   app_ = nullptr;
   // pthread_t thread_;
   sctp_desc   = {};
   serverAddr_ = {};
   events_     = {};
   sctp_ctx    = {};
+  create_socket(address, port_num);
 }
 
 //------------------------------------------------------------------------------
@@ -96,62 +117,135 @@ int sctp_server::create_socket(const char* address, const uint16_t port_num) {
   events_.sctp_shutdown_event    = 1;
   events_.sctp_association_event = 1;
   setsockopt(socket_, IPPROTO_SCTP, SCTP_EVENTS, &events_, 8);
-  listen(socket_, 5);
+  sctp_set_nonblocking(socket_);
+  listen(socket_, SOMAXCONN);
   return 0;
 }
 
 //------------------------------------------------------------------------------
-void sctp_server::start_receive(sctp_application* app) {
+void sctp_server::start_receive(
+    sctp_application* app, const int nb_io_threads) {
   app_ = app;
-  pthread_create(&thread_, NULL, sctp_receiver_thread, (void*) this);
+  for (int i = 0; i < std::max(nb_io_threads, 1); i++) {
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+      Logger::sctp().error("epoll_create1: %s:%d", strerror(errno), errno);
+      break;
+    }
+    epoll_fds.push_back(epoll_fd);
+  }
+  if (epoll_fds.empty()) return;
+
+  // The first I/O thread accepts the new associations
+  struct epoll_event event = {};
+  event.events             = EPOLLIN | EPOLLET;
+  event.data.ptr           = nullptr;
+  if (epoll_ctl(epoll_fds[0], EPOLL_CTL_ADD, getSocket(), &event) < 0) {
+    Logger::sctp().error(
+        "[socket(%d)] epoll_ctl() error: %s:%d", getSocket(), strerror(errno),
+        errno);
+    return;
+  }
+  for (auto epoll_fd : epoll_fds) {
+    std::thread(&sctp_server::sctp_io_thread, this, epoll_fd).detach();
+  }
+  Logger::sctp().info("Started %d SCTP I/O threads", (int) epoll_fds.size());
 }
 
 //------------------------------------------------------------------------------
-void* sctp_server::sctp_receiver_thread(void* arg) {
-  sctp_server* ptr = (sctp_server*) arg;
+void sctp_server::sctp_io_thread(const int epoll_fd) {
   Logger::sctp().info("Create pthread to receive sctp message");
-  int fdmax;
-  int clientsock;
-  fd_set master;
-  fd_set read_fds;
-  if (arg == NULL) pthread_exit(NULL);
-  FD_ZERO(&master);
-  FD_ZERO(&read_fds);
-  FD_SET(ptr->getSocket(), &master);
-  fdmax = ptr->getSocket();
+  struct epoll_event events[SCTP_EPOLL_MAX_EVENTS];
   while (1) {
-    memcpy(&read_fds, &master, sizeof(master));
-    if (select(fdmax + 1, &read_fds, NULL, NULL, NULL) == -1) {
+    int nb = epoll_wait(epoll_fd, events, SCTP_EPOLL_MAX_EVENTS, -1);
+    if (nb < 0) {
+      if (errno == EINTR) continue;
       Logger::sctp().error(
-          "[socket(%d)] Select() error: %s:%d", ptr->getSocket(),
-          strerror(errno), errno);
-      pthread_exit(NULL);
+          "[epoll(%d)] epoll_wait() error: %s:%d", epoll_fd, strerror(errno),
+          errno);
+      return;
     }
-    for (int i = 0; i <= fdmax; i++) {
-      if (FD_ISSET(i, &read_fds)) {
-        if (i == ptr->getSocket()) {
-          if ((clientsock = accept(ptr->getSocket(), NULL, NULL)) < 0) {
-            Logger::sctp().error(
-                "[socket(%d)] accept() error: %s:%d", ptr->getSocket(),
-                strerror(errno), errno);
-            pthread_exit(NULL);
-          } else {
-            FD_SET(clientsock, &master);
-            if (clientsock > fdmax) fdmax = clientsock;
-          }
-        } else {
-          int ret = ptr->sctp_read_from_socket(i, ptr->app_->getPpid());
-          if (ret == SCTP_RC_DISCONNECT) {
-            FD_CLR(i, &master);
-            if (i == fdmax) {
-              while (FD_ISSET(fdmax, &master) == false) fdmax -= 1;
-            }
-          }
-        }
+    for (int i = 0; i < nb; i++) {
+      sctp_connection_t* connection =
+          (sctp_connection_t*) events[i].data.ptr;
+      if (!connection) {
+        sctp_accept();
+        continue;
       }
+      // Edge triggered: read until the socket is drained
+      int ret = SCTP_RC_NORMAL_READ;
+      do {
+        ret = sctp_read_from_socket(connection, app_->getPpid());
+      } while ((ret != SCTP_RC_DRAINED) && (ret != SCTP_RC_DISCONNECT));
+      if (ret == SCTP_RC_DISCONNECT) {
+        sctp_close_connection(connection);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void sctp_server::sctp_accept() {
+  while (1) {
+    int clientsock = accept(getSocket(), NULL, NULL);
+    if (clientsock < 0) {
+      if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+        Logger::sctp().error(
+            "[socket(%d)] accept() error: %s:%d", getSocket(), strerror(errno),
+            errno);
+      }
+      if (errno == EINTR) continue;
+      return;
+    }
+    sctp_set_nonblocking(clientsock);
+
+    sctp_connection_t* connection = new sctp_connection_t();
+    connection->sd                = clientsock;
+    connection->epoll_fd =
+        epoll_fds[next_io_thread.fetch_add(1) % epoll_fds.size()];
+    connection->assoc_id = 0;
+    connection->up       = false;
+    connection->partial  = nullptr;
+
+    struct epoll_event event = {};
+    event.events             = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    event.data.ptr           = connection;
+    if (epoll_ctl(connection->epoll_fd, EPOLL_CTL_ADD, clientsock, &event) <
+        0) {
+      Logger::sctp().error(
+          "[socket(%d)] epoll_ctl() error: %s:%d", clientsock, strerror(errno),
+          errno);
+      close(clientsock);
+      delete connection;
     }
   }
-  return NULL;
+}
+
+//------------------------------------------------------------------------------
+void sctp_server::sctp_close_connection(sctp_connection_t* connection) {
+  epoll_ctl(connection->epoll_fd, EPOLL_CTL_DEL, connection->sd, NULL);
+  std::shared_ptr<sctp_association_t> association = nullptr;
+  if (connection->up) {
+    std::unique_lock lock(m_sctp_ctx);
+    auto it = sctp_ctx.find(connection->assoc_id);
+    if ((it != sctp_ctx.end()) && (it->second->sd == connection->sd)) {
+      association = it->second;
+      sctp_ctx.erase(it);
+    }
+  }
+  if (association) {
+    Logger::sctp().info(
+        "[Assoc_id %d] Closed, received %lu msgs (%lu bytes), sent %lu msgs "
+        "(%lu bytes), %lu send errors",
+        association->assoc_id, association->messages_recv.load(),
+        association->bytes_recv.load(), association->messages_sent.load(),
+        association->bytes_sent.load(), association->send_errors.load());
+    // the socket is closed once the senders are done with it
+  } else {
+    close(connection->sd);
+  }
+  if (connection->partial) bdestroy(connection->partial);
+  delete connection;
 }
 
 //------------------------------------------------------------------------------
@@ -160,34 +254,63 @@ int sctp_server::getSocket() {
 }
 
 //------------------------------------------------------------------------------
-int sctp_server::sctp_read_from_socket(int sd, uint32_t ppid) {
+int sctp_server::sctp_read_from_socket(
+    sctp_connection_t* connection, uint32_t ppid) {
   int flags                    = 0;
   socklen_t from_len           = 0;
   struct sctp_sndrcvinfo sinfo = {0};
   struct sockaddr_in6 addr     = {0};
-  uint8_t buffer[SCTP_RECV_BUFFER_SIZE];
+  int sd                       = connection->sd;
   if (sd < 0) return RETURNerror;
   memset((void*) &addr, 0, sizeof(struct sockaddr_in6));
   from_len = (socklen_t) sizeof(struct sockaddr_in6);
   memset((void*) &sinfo, 0, sizeof(struct sctp_sndrcvinfo));
-  int n = sctp_recvmsg(
+  uint8_t* buffer = buffer_pool.get();
+  int n           = sctp_recvmsg(
       sd, (void*) buffer, SCTP_RECV_BUFFER_SIZE, (struct sockaddr*) &addr,
       &from_len, &sinfo, &flags);
   if (n < 0) {
+    buffer_pool.put(buffer);
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) return SCTP_RC_DRAINED;
+    if (errno == EINTR) return SCTP_RC_NORMAL_READ;
     Logger::sctp().error("sctp_recvmsg error:: %s:%d", strerror(errno), errno);
-    return SCTP_RC_ERROR;
+    if (connection->up) sctp_handle_com_down(connection->assoc_id);
+    return SCTP_RC_DISCONNECT;
+  }
+  if (n == 0) {
+    // closed by the peer without a notification
+    buffer_pool.put(buffer);
+    if (connection->up) return sctp_handle_com_down(connection->assoc_id);
+    return SCTP_RC_DISCONNECT;
+  }
+
+  // A message bigger than the buffer comes in several reads, the last one
+  // with MSG_EOR
+  uint8_t* data = buffer;
+  if ((!(flags & MSG_EOR)) || connection->partial) {
+    if (!connection->partial) connection->partial = bfromcstr("");
+    bcatblk(connection->partial, buffer, n);
+    if (!(flags & MSG_EOR)) {
+      buffer_pool.put(buffer);
+      return SCTP_RC_NORMAL_READ;
+    }
+    data = (uint8_t*) bdata(connection->partial);
+    n    = blength(connection->partial);
   }
+
+  int rc = SCTP_RC_NORMAL_READ;
   if (flags & MSG_NOTIFICATION) {
-    union sctp_notification* snp = (union sctp_notification*) buffer;
+    union sctp_notification* snp = (union sctp_notification*) data;
     switch (snp->sn_header.sn_type) {
       case SCTP_SHUTDOWN_EVENT: {
         Logger::sctp().debug("SCTP Shutdown Event received");
-        return sctp_handle_com_down(snp->sn_shutdown_event.sse_assoc_id);
+        rc = sctp_handle_com_down(snp->sn_shutdown_event.sse_assoc_id);
         break;
       }
       case SCTP_ASSOC_CHANGE: {
         Logger::sctp().debug("SCTP Association Change event received");
-        return handle_assoc_change(sd, ppid, &snp->sn_assoc_change);
+        rc = handle_assoc_change(connection, ppid, &snp->sn_assoc_change);
+        break;
       }
       default: {
         Logger::sctp().error(
@@ -196,30 +319,41 @@ int sctp_server::sctp_read_from_socket(int sd, uint32_t ppid) {
       }
     }
   } else {
-    sctp_association_t* association;
-    if ((association = sctp_is_assoc_in_list(
-             (sctp_assoc_id_t) sinfo.sinfo_assoc_id)) == NULL) {
-      return SCTP_RC_ERROR;
-    }
-    association->messages_recv++;
-    if (ntohl(sinfo.sinfo_ppid) != association->ppid) {
+    std::shared_ptr<sctp_association_t> association =
+        sctp_is_assoc_in_list((sctp_assoc_id_t) sinfo.sinfo_assoc_id);
+    if (!association) {
+      Logger::sctp().error(
+          "Received data on unknown association (%d)", sinfo.sinfo_assoc_id);
+    } else if (ntohl(sinfo.sinfo_ppid) != association->ppid) {
       Logger::sctp().error(
           "Received data from peer with unsolicited PPID (%d), expecting (%d)",
           ntohl(sinfo.sinfo_ppid), association->ppid);
-      return SCTP_RC_ERROR;
+    } else {
+      association->messages_recv.fetch_add(1, std::memory_order_relaxed);
+      association->bytes_recv.fetch_add(n, std::memory_order_relaxed);
+      if (sinfo.sinfo_stream < association->instreams) {
+        association->stream_messages_recv[sinfo.sinfo_stream].fetch_add(
+            1, std::memory_order_relaxed);
+      }
+      Logger::sctp().debug(
+          "****[Assoc_id %d, Socket %d] Received a msg (length %d) from port "
+          "%d, on stream %d, PPID %d ****",
+          sinfo.sinfo_assoc_id, sd, n, ntohs(addr.sin6_port),
+          sinfo.sinfo_stream, ntohl(sinfo.sinfo_ppid));
+      // handle payload, straight from the receive buffer
+      struct tagbstring payload;
+      btfromblk(payload, data, n);
+      app_->handle_receive(
+          &payload, (sctp_assoc_id_t) sinfo.sinfo_assoc_id, sinfo.sinfo_stream,
+          association->instreams, association->outstreams);
     }
-    Logger::sctp().info(
-        "****[Assoc_id %d, Socket %d] Received a msg (length %d) from port %d, "
-        "on stream %d, PPID %d ****",
-        sinfo.sinfo_assoc_id, sd, n, ntohs(addr.sin6_port), sinfo.sinfo_stream,
-        ntohl(sinfo.sinfo_ppid));
-    bstring payload = blk2bstr(buffer, n);
-    // handle payload
-    app_->handle_receive(
-        payload, (sctp_assoc_id_t) sinfo.sinfo_assoc_id, sinfo.sinfo_stream,
-        association->instreams, association->outstreams);
   }
-  return 0;
+  if (connection->partial) {
+    bdestroy(connection->partial);
+    connection->partial = nullptr;
+  }
+  buffer_pool.put(buffer);
+  return rc;
 }
 
 //------------------------------------------------------------------------------
@@ -235,20 +369,26 @@ int sctp_server::sctp_handle_reset(const sctp_assoc_id_t assoc_id) {
 
 //------------------------------------------------------------------------------
 int sctp_server::handle_assoc_change(
-    int sd, uint32_t ppid, struct sctp_assoc_change* sctp_assoc_changed) {
+    sctp_connection_t* connection, uint32_t ppid,
+    struct sctp_assoc_change* sctp_assoc_changed) {
   int rc = SCTP_RC_NORMAL_READ;
+  int sd = connection->sd;
   switch (sctp_assoc_changed->sac_state) {
     case SCTP_COMM_UP: {
-      if (add_new_association(sd, ppid, sctp_assoc_changed) == NULL) {
+      if (add_new_association(sd, ppid, sctp_assoc_changed) == nullptr) {
         Logger::sctp().error(
             "Add new association with ppid (%d) socket (%d) error", ppid, sd);
         rc = SCTP_RC_ERROR;
+      } else {
+        connection->assoc_id =
+            (sctp_assoc_id_t) sctp_assoc_changed->sac_assoc_id;
+        connection->up = true;
       }
       break;
     }
     case SCTP_RESTART: {
       if (sctp_is_assoc_in_list(
-              (sctp_assoc_id_t) sctp_assoc_changed->sac_assoc_id) != NULL) {
+              (sctp_assoc_id_t) sctp_assoc_changed->sac_assoc_id) != nullptr) {
         rc = sctp_handle_reset(
             (sctp_assoc_id_t) sctp_assoc_changed->sac_assoc_id);
       }
@@ -258,9 +398,11 @@ int sctp_server::handle_assoc_change(
     case SCTP_SHUTDOWN_COMP:
     case SCTP_CANT_STR_ASSOC: {
       if (sctp_is_assoc_in_list(
-              (sctp_assoc_id_t) sctp_assoc_changed->sac_assoc_id) != NULL) {
+              (sctp_assoc_id_t) sctp_assoc_changed->sac_assoc_id) != nullptr) {
         rc = sctp_handle_com_down(
             (sctp_assoc_id_t) sctp_assoc_changed->sac_assoc_id);
+      } else {
+        rc = SCTP_RC_DISCONNECT;
       }
       break;
     }
@@ -273,24 +415,29 @@ int sctp_server::handle_assoc_change(
 }
 
 //------------------------------------------------------------------------------
-sctp_association_t* sctp_server::add_new_association(
+std::shared_ptr<sctp_association_t> sctp_server::add_new_association(
     int sd, uint32_t ppid, struct sctp_assoc_change* sctp_assoc_changed) {
-  sctp_association_t* new_association = NULL;
-  new_association = (sctp_association_t*) calloc(1, sizeof(sctp_association_t));
+  std::shared_ptr<sctp_association_t> new_association(
+      new sctp_association_t(), sctp_release_association);
   new_association->sd         = sd;
   new_association->ppid       = ppid;
   new_association->instreams  = sctp_assoc_changed->sac_inbound_streams;
   new_association->outstreams = sctp_assoc_changed->sac_outbound_streams;
   new_association->assoc_id =
       (sctp_assoc_id_t) sctp_assoc_changed->sac_assoc_id;
+  new_association->stream_messages_recv.reset(
+      new std::atomic<uint64_t>[new_association->instreams]());
   Logger::sctp().debug(
       "Add new association with id (%d)",
       (sctp_assoc_id_t) sctp_assoc_changed->sac_assoc_id);
-  sctp_ctx.push_back(new_association);
   sctp_get_localaddresses(sd, NULL, NULL);
   sctp_get_peeraddresses(
       sd, &new_association->peer_addresses,
       &new_association->nb_peer_addresses);
+  {
+    std::unique_lock lock(m_sctp_ctx);
+    sctp_ctx[new_association->assoc_id] = new_association;
+  }
   app_->handle_sctp_new_association(
       new_association->assoc_id, new_association->instreams,
       new_association->outstreams);
@@ -298,18 +445,30 @@ sctp_association_t* sctp_server::add_new_association(
 }
 
 //------------------------------------------------------------------------------
-sctp_association_t* sctp_server::sctp_is_assoc_in_list(
-    sctp_assoc_id_t assoc_id) {
-  sctp_association_t* assoc_desc = NULL;
-  if (assoc_id < 0) {
-    return NULL;
-  }
-  for (int i = 0; i < sctp_ctx.size(); i++) {
-    if (sctp_ctx[i]->assoc_id == assoc_id) {
-      return sctp_ctx[i];
-    }
+std::shared_ptr<sctp_association_t> sctp_server::sctp_is_assoc_in_list(
+    sctp_assoc_id_t assoc_id) const {
+  std::shared_lock lock(m_sctp_ctx);
+  auto it = sctp_ctx.find(assoc_id);
+  if (it == sctp_ctx.end()) return nullptr;
+  return it->second;
+}
+
+//------------------------------------------------------------------------------
+bool sctp_server::get_association_stats(
+    sctp_assoc_id_t assoc_id, sctp_assoc_stats_t& stats) const {
+  std::shared_ptr<sctp_association_t> association =
+      sctp_is_assoc_in_list(assoc_id);
+  if (!association) return false;
+  stats.messages_recv = association->messages_recv.load();
+  stats.messages_sent = association->messages_sent.load();
+  stats.bytes_recv    = association->bytes_recv.load();
+  stats.bytes_sent    = association->bytes_sent.load();
+  stats.send_errors   = association->send_errors.load();
+  stats.stream_messages_recv.resize(association->instreams);
+  for (int i = 0; i < association->instreams; i++) {
+    stats.stream_messages_recv[i] = association->stream_messages_recv[i].load();
   }
-  return assoc_desc;
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -401,8 +560,9 @@ int sctp_server::sctp_get_localaddresses(
 //------------------------------------------------------------------------------
 int sctp_server::sctp_send_msg(
     sctp_assoc_id_t sctp_assoc_id, sctp_stream_id_t stream, bstring* payload) {
-  sctp_association_t* assoc_desc = NULL;
-  if ((assoc_desc = sctp_is_assoc_in_list(sctp_assoc_id)) == NULL) {
+  std::shared_ptr<sctp_association_t> assoc_desc =
+      sctp_is_assoc_in_list(sctp_assoc_id);
+  if (assoc_desc == nullptr) {
     Logger::sctp().error(
         "This assoc id (%d) has not been fount in list", sctp_assoc_id);
     return RETURNerror;
@@ -417,21 +577,37 @@ int sctp_server::sctp_send_msg(
       "with ppid %d",
       assoc_desc->sd, sctp_assoc_id, bdata(*payload), blength(*payload), stream,
       assoc_desc->ppid);
-  if (sctp_sendmsg(
-          assoc_desc->sd, (const void*) bdata(*payload),
-          (size_t) blength(*payload), NULL, 0, htonl(assoc_desc->ppid), 0,
-          stream, 0, 0) < 0) {
+  int rc = 0;
+  while ((rc = sctp_sendmsg(
+              assoc_desc->sd, (const void*) bdata(*payload),
+              (size_t) blength(*payload), NULL, 0, htonl(assoc_desc->ppid), 0,
+              stream, 0, 0)) < 0) {
+    // Non blocking socket, wait for room in the send buffer
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+      struct pollfd pfd = {};
+      pfd.fd            = assoc_desc->sd;
+      pfd.events        = POLLOUT;
+      if (poll(&pfd, 1, SCTP_SEND_TIMEOUT_MS) > 0) continue;
+      errno = EAGAIN;
+    } else if (errno == EINTR) {
+      continue;
+    }
+    break;
+  }
+  if (rc < 0) {
     Logger::sctp().error(
         "[Socket %d] Send stream %u, ppid %u, len %u failed (%s, %d)",
         assoc_desc->sd, stream, htonl(assoc_desc->ppid), blength(*payload),
         strerror(errno), errno);
+    assoc_desc->send_errors.fetch_add(1, std::memory_order_relaxed);
     *payload = NULL;
     return RETURNerror;
   }
   Logger::sctp().debug(
       "Successfully sent %d bytes on stream %d", blength(*payload), stream);
+  assoc_desc->messages_sent.fetch_add(1, std::memory_order_relaxed);
+  assoc_desc->bytes_sent.fetch_add(blength(*payload), std::memory_order_relaxed);
   *payload = NULL;
-  assoc_desc->messages_sent++;
   return 0;
 }
 
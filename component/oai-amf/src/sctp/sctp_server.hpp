@@ -29,7 +29,12 @@
 #ifndef _SCTP_SERVER_H_
 #define _SCTP_SERVER_H_
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <thread>
+#include <unordered_map>
 
 #include "endpoint.hpp"
 #include "common_defs.h"
@@ -47,6 +52,14 @@ extern "C" {
 #define SCTP_RC_ERROR -1
 #define SCTP_RC_NORMAL_READ 0
 #define SCTP_RC_DISCONNECT 1
+#define SCTP_RC_DRAINED 2
+// Threads reading the associations, an association is read by one thread
+#define SCTP_IO_THREADS 2
+#define SCTP_EPOLL_MAX_EVENTS 64
+// Receive buffers kept for reuse
+#define SCTP_BUFFER_POOL_SIZE 64
+// How long a sender waits for room in the socket send buffer
+#define SCTP_SEND_TIMEOUT_MS 1000
 
 namespace sctp {
 
@@ -64,13 +77,29 @@ typedef struct sctp_association_s {
   uint16_t
       outstreams;  ///< Number of output strams negotiated for this connection
   sctp_assoc_id_t assoc_id;  ///< SCTP association id for the connection
-  uint32_t messages_recv;    ///< Number of messages received on this connection
-  uint32_t messages_sent;    ///< Number of messages sent on this connection
+  std::atomic<uint64_t>
+      messages_recv;  ///< Number of messages received on this connection
+  std::atomic<uint64_t>
+      messages_sent;  ///< Number of messages sent on this connection
+  std::atomic<uint64_t> bytes_recv;
+  std::atomic<uint64_t> bytes_sent;
+  std::atomic<uint64_t> send_errors;
+  ///< Number of messages received per stream, instreams entries
+  std::unique_ptr<std::atomic<uint64_t>[]> stream_messages_recv;
 
   struct sockaddr* peer_addresses;  ///< A list of peer addresses
   int nb_peer_addresses;
 } sctp_association_t;
 
+typedef struct sctp_assoc_stats_s {
+  uint64_t messages_recv;
+  uint64_t messages_sent;
+  uint64_t bytes_recv;
+  uint64_t bytes_sent;
+  uint64_t send_errors;
+  std::vector<uint64_t> stream_messages_recv;  // per input stream
+} sctp_assoc_stats_t;
+
 typedef struct sctp_descriptor_s {
   // List of connected peers
   struct sctp_association_s* available_connections_head;
@@ -82,6 +111,8 @@ typedef struct sctp_descriptor_s {
 
 class sctp_application {
  public:
+  // Called by the I/O thread of the association, in order, payload is only
+  // valid during the call
   virtual void handle_receive(
       bstring payload, sctp_assoc_id_t assoc_id, sctp_stream_id_t stream,
       sctp_stream_id_t instreams, sctp_stream_id_t outstreams) = 0;
@@ -92,38 +123,109 @@ class sctp_application {
   virtual uint32_t getPpid()                                  = 0;
 };
 
+// Receive buffers of SCTP_RECV_BUFFER_SIZE bytes, shared by the I/O threads
+class sctp_buffer_pool {
+ public:
+  sctp_buffer_pool() : m_buffers(), buffers() {}
+  ~sctp_buffer_pool() {
+    for (auto buffer : buffers) delete[] buffer;
+  }
+  sctp_buffer_pool(sctp_buffer_pool const&) = delete;
+  void operator=(sctp_buffer_pool const&) = delete;
+
+  uint8_t* get() {
+    {
+      std::lock_guard<std::mutex> lock(m_buffers);
+      if (!buffers.empty()) {
+        uint8_t* buffer = buffers.back();
+        buffers.pop_back();
+        return buffer;
+      }
+    }
+    return new uint8_t[SCTP_RECV_BUFFER_SIZE];
+  }
+  void put(uint8_t* buffer) {
+    {
+      std::lock_guard<std::mutex> lock(m_buffers);
+      if (buffers.size() < SCTP_BUFFER_POOL_SIZE) {
+        buffers.push_back(buffer);
+        return;
+      }
+    }
+    delete[] buffer;
+  }
+
+ private:
+  std::mutex m_buffers;
+  std::vector<uint8_t*> buffers;
+};
+
 class sctp_server {
  public:
   sctp_server(const char* address, const uint16_t port_num);
   virtual ~sctp_server();
   int create_socket(const char* address, const uint16_t port_num);
-  void start_receive(sctp_application* app);
+  /*
+   * Start the I/O threads, the associations are spread over them
+   * @param [sctp_application*] app: receiver of the messages and events
+   * @param [const int] nb_io_threads: number of I/O threads
+   * @return void
+   */
+  void start_receive(
+      sctp_application* app, const int nb_io_threads = SCTP_IO_THREADS);
   int sctp_send_msg(
       sctp_assoc_id_t sctp_assoc_id, sctp_stream_id_t stream, bstring* payload);
+  /*
+   * Get the counters of an association
+   * @param [sctp_assoc_id_t] assoc_id: association id
+   * @param [sctp_assoc_stats_t&] stats: counters
+   * @return false if the association is unknown
+   */
+  bool get_association_stats(
+      sctp_assoc_id_t assoc_id, sctp_assoc_stats_t& stats) const;
 
  private:
-  static void* sctp_receiver_thread(void* arg);
+  // A socket accepted on the listening socket, read by one I/O thread
+  typedef struct sctp_connection_s {
+    int sd;
+    int epoll_fd;  ///< epoll of the I/O thread reading the socket
+    sctp_assoc_id_t assoc_id;
+    bool up;       ///< association is known to the application
+    bstring partial;  ///< message received so far, without MSG_EOR
+  } sctp_connection_t;
+
+  void sctp_io_thread(const int epoll_fd);
+  void sctp_accept();
   int getSocket();
-  int sctp_read_from_socket(int sd, uint32_t m_ppid);
+  int sctp_read_from_socket(sctp_connection_t* connection, uint32_t m_ppid);
+  void sctp_close_connection(sctp_connection_t* connection);
   int handle_assoc_change(
-      int sd, uint32_t ppid, struct sctp_assoc_change* assoc_change);
+      sctp_connection_t* connection, uint32_t ppid,
+      struct sctp_assoc_change* assoc_change);
   int sctp_handle_com_down(sctp_assoc_id_t assoc_id);
   int sctp_handle_reset(const sctp_assoc_id_t assoc_id);
-  sctp_association_t* add_new_association(
+  std::shared_ptr<sctp_association_t> add_new_association(
       int sd, uint32_t ppid, struct sctp_assoc_change* sctp_assoc_changed);
   int sctp_get_localaddresses(
       int sock, struct sockaddr** local_addr, int* nb_local_addresses);
   int sctp_get_peeraddresses(
       int sock, struct sockaddr** remote_addr, int* nb_remote_addresses);
-  sctp_association_t* sctp_is_assoc_in_list(sctp_assoc_id_t assoc_id);
+  std::shared_ptr<sctp_association_t> sctp_is_assoc_in_list(
+      sctp_assoc_id_t assoc_id) const;
 
   int socket_;
   sctp_application* app_;
-  pthread_t thread_;
   sctp_descriptor_t sctp_desc;
   struct sockaddr_in serverAddr_;
   struct sctp_event_subscribe events_;
-  std::vector<sctp_association_t*> sctp_ctx;
+
+  std::vector<int> epoll_fds;  // one per I/O thread
+  std::atomic<uint32_t> next_io_thread;
+  sctp_buffer_pool buffer_pool;
+
+  std::unordered_map<sctp_assoc_id_t, std::shared_ptr<sctp_association_t>>
+      sctp_ctx;
+  mutable std::shared_mutex m_sctp_ctx;
 };
 
 }  // namespace sctp
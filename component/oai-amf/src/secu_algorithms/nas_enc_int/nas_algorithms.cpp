@@ -28,7 +28,10 @@
 
 #include "nas_algorithms.hpp"
 
-#include "logger.hpp"
+#if defined(__aarch64__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
 
 //------------------------------------------------------------------------------
 uint64_t MUL64x(uint64_t V, uint64_t c) {
@@ -178,95 +181,228 @@ int nas_algorithms::nas_stream_encrypt_nia1(
   return 0;
 }
 
+//------------------------------------------------------------------------------
+nas_algorithms_ctx::~nas_algorithms_ctx() {
+  if (nea2) EVP_CIPHER_CTX_free(nea2);
+  if (nea2_blocks) EVP_CIPHER_CTX_free(nea2_blocks);
+  if (nia2) CMAC_CTX_free(nia2);
+}
+
+//------------------------------------------------------------------------------
+bool nas_algorithms_ctx::set_nea2_key(const uint8_t* const key) {
+  if (nea2 && !memcmp(nea2_key, key, NAS_ALGORITHMS_KEY_SIZE)) return true;
+  if (!nea2) nea2 = EVP_CIPHER_CTX_new();
+  if (!nea2_blocks) nea2_blocks = EVP_CIPHER_CTX_new();
+  if ((!nea2) || (!nea2_blocks) ||
+      (!EVP_EncryptInit_ex(nea2, EVP_aes_128_ctr(), NULL, key, NULL)) ||
+      (!EVP_EncryptInit_ex(nea2_blocks, EVP_aes_128_ecb(), NULL, key, NULL))) {
+    if (nea2) EVP_CIPHER_CTX_free(nea2);
+    if (nea2_blocks) EVP_CIPHER_CTX_free(nea2_blocks);
+    nea2        = nullptr;
+    nea2_blocks = nullptr;
+    return false;
+  }
+  EVP_CIPHER_CTX_set_padding(nea2_blocks, 0);
+  memcpy(nea2_key, key, NAS_ALGORITHMS_KEY_SIZE);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool nas_algorithms_ctx::set_nia2_key(const uint8_t* const key) {
+  if (nia2 && !memcmp(nia2_key, key, NAS_ALGORITHMS_KEY_SIZE)) return true;
+  if (!nia2) nia2 = CMAC_CTX_new();
+  if ((!nia2) ||
+      (!CMAC_Init(
+          nia2, key, NAS_ALGORITHMS_KEY_SIZE, EVP_aes_128_cbc(), NULL))) {
+    if (nia2) CMAC_CTX_free(nia2);
+    nia2 = nullptr;
+    return false;
+  }
+  memcpy(nia2_key, key, NAS_ALGORITHMS_KEY_SIZE);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Number of AES blocks of keystream needed by a message
+static uint32_t nea2_nb_blocks(const nas_stream_cipher_t* const stream_cipher) {
+  return (stream_cipher->blength + 127) >> 7;
+}
+
+//------------------------------------------------------------------------------
+// Write the nb first counter blocks of a message:
+// COUNT | BEARER | DIRECTION | 0...0 | block number (TS 33.501 D.4.4)
+static void nea2_counter_blocks(
+    const nas_stream_cipher_t* const stream_cipher, const uint32_t nb,
+    uint8_t* counters) {
+  uint8_t t[16]        = {0};
+  uint32_t local_count = hton_int32(stream_cipher->count);
+  memcpy(&t[0], &local_count, 4);
+  t[4] = ((stream_cipher->bearer & 0x1F) << 3) |
+         ((stream_cipher->direction & 0x01) << 2);
+  for (uint32_t b = 0; b < nb; b++) {
+    uint32_t block = hton_int32(b);
+    memcpy(&t[12], &block, 4);
+    memcpy(counters + (b << 4), t, 16);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Clear the bits of the last byte after blength
+static void nea2_mask(
+    const nas_stream_cipher_t* const stream_cipher, uint8_t* const out) {
+  uint32_t zero_bit = stream_cipher->blength & 0x7;
+  if (zero_bit > 0)
+    out[stream_cipher->blength >> 3] &= (uint8_t)(0xFF << (8 - zero_bit));
+}
+
 //------------------------------------------------------------------------------
 int nas_algorithms::nas_stream_encrypt_nea2(
     nas_stream_cipher_t* const stream_cipher, uint8_t* const out) {
-  uint8_t m[16];
-  uint32_t local_count;
-  void* ctx;
-  uint8_t* data;
-  uint32_t zero_bit = 0;
-  uint32_t byte_length;
+  // contexts of the last key used by the thread
+  static thread_local nas_algorithms_ctx ctx;
+  return nas_stream_encrypt_nea2(ctx, stream_cipher, out);
+}
+
+//------------------------------------------------------------------------------
+int nas_algorithms::nas_stream_encrypt_nea2(
+    nas_algorithms_ctx& ctx, nas_stream_cipher_t* const stream_cipher,
+    uint8_t* const out) {
+  uint8_t iv[16] = {0};
+  int len        = 0;
 
   DevAssert(stream_cipher != NULL);
+  DevAssert(stream_cipher->key_length == NAS_ALGORITHMS_KEY_SIZE);
   DevAssert(out != NULL);
-  zero_bit    = stream_cipher->blength & 0x7;
-  byte_length = stream_cipher->blength >> 3;
+  if (!ctx.set_nea2_key(stream_cipher->key)) return -1;
 
-  if (zero_bit > 0) byte_length += 1;
-
-  ctx         = malloc(nettle_aes128.context_size);
-  data        = (uint8_t*) malloc(byte_length);
-  local_count = hton_int32(stream_cipher->count);
-  memset(m, 0, sizeof(m));
-  memcpy(&m[0], &local_count, 4);
-  m[4] = ((stream_cipher->bearer & 0x1F) << 3) |
-         ((stream_cipher->direction & 0x01) << 2);
-  /*
-   * Other bits are 0
-   */
-#if NETTLE_VERSION_MAJOR < 3
-  nettle_aes128.set_encrypt_key(
-      ctx, stream_cipher->key_length, stream_cipher->key);
-#else
-  nettle_aes128.set_encrypt_key(ctx, stream_cipher->key);
-#endif
-  nettle_ctr_crypt(
-      ctx, nettle_aes128.encrypt, nettle_aes128.block_size, m, byte_length,
-      data, stream_cipher->message);
+  nea2_counter_blocks(stream_cipher, 1, iv);
+  // new IV, the key schedule is kept
+  if (!EVP_EncryptInit_ex(ctx.nea2, NULL, NULL, NULL, iv)) return -1;
+  if (!EVP_EncryptUpdate(
+          ctx.nea2, out, &len, stream_cipher->message,
+          (stream_cipher->blength + 7) >> 3))
+    return -1;
+  nea2_mask(stream_cipher, out);
+  return 0;
+}
 
-  if (zero_bit > 0)
-    data[byte_length - 1] =
-        data[byte_length - 1] & (uint8_t)(0xFF << (8 - zero_bit));
+//------------------------------------------------------------------------------
+int nas_algorithms::nas_stream_encrypt_nea2_batch(
+    nas_algorithms_ctx& ctx, nas_stream_cipher_t* const stream_ciphers,
+    uint8_t* const* out, const std::size_t nb) {
+  uint8_t counters[NAS_NEA2_KEYSTREAM_BLOCKS << 4];
+  uint8_t keystream[NAS_NEA2_KEYSTREAM_BLOCKS << 4];
+  int len = 0;
 
-  memcpy(out, data, byte_length);
-  free(data);
-  free(ctx);
+  DevAssert(stream_ciphers != NULL);
+  DevAssert(out != NULL);
+  std::size_t i = 0;
+  while (i < nb) {
+    DevAssert(stream_ciphers[i].key_length == NAS_ALGORITHMS_KEY_SIZE);
+    if (!ctx.set_nea2_key(stream_ciphers[i].key)) return -1;
+    // messages [i, j) have the same key and their counter blocks fit in the
+    // buffer: one AES call for all of them
+    std::size_t j   = i;
+    uint32_t blocks = 0;
+    while ((j < nb) &&
+           (blocks + nea2_nb_blocks(&stream_ciphers[j]) <=
+            NAS_NEA2_KEYSTREAM_BLOCKS) &&
+           (!memcmp(
+               stream_ciphers[j].key, stream_ciphers[i].key,
+               NAS_ALGORITHMS_KEY_SIZE))) {
+      uint32_t n = nea2_nb_blocks(&stream_ciphers[j]);
+      nea2_counter_blocks(&stream_ciphers[j], n, counters + (blocks << 4));
+      blocks += n;
+      j++;
+    }
+    // too long to share the buffer
+    if (j == i) {
+      if (nas_stream_encrypt_nea2(ctx, &stream_ciphers[i], out[i])) return -1;
+      i++;
+      continue;
+    }
+    if (!EVP_EncryptUpdate(
+            ctx.nea2_blocks, keystream, &len, counters, blocks << 4))
+      return -1;
+    const uint8_t* ks = keystream;
+    for (; i < j; i++) {
+      const uint8_t* in    = stream_ciphers[i].message;
+      uint32_t byte_length = (stream_ciphers[i].blength + 7) >> 3;
+      uint32_t k           = 0;
+      for (; k + 8 <= byte_length; k += 8) {
+        uint64_t m, x;
+        memcpy(&m, in + k, 8);
+        memcpy(&x, ks + k, 8);
+        m ^= x;
+        memcpy(out[i] + k, &m, 8);
+      }
+      for (; k < byte_length; k++) out[i][k] = in[k] ^ ks[k];
+      nea2_mask(&stream_ciphers[i], out[i]);
+      ks += nea2_nb_blocks(&stream_ciphers[i]) << 4;
+    }
+  }
   return 0;
 }
 
 //------------------------------------------------------------------------------
 int nas_algorithms::nas_stream_encrypt_nia2(
     nas_stream_cipher_t* const stream_cipher, uint8_t const out[4]) {
-  uint8_t* m               = NULL;
-  uint32_t local_count     = 0;
-  size_t size              = 4;
-  uint8_t data[16]         = {0};
-  CMAC_CTX* cmac_ctx       = NULL;
-  const EVP_CIPHER* cipher = EVP_aes_128_cbc();
-  uint32_t zero_bit        = 0;
+  // contexts of the last key used by the thread
+  static thread_local nas_algorithms_ctx ctx;
+  return nas_stream_encrypt_nia2(ctx, stream_cipher, (uint8_t*) out);
+}
+
+//------------------------------------------------------------------------------
+int nas_algorithms::nas_stream_encrypt_nia2(
+    nas_algorithms_ctx& ctx, nas_stream_cipher_t* const stream_cipher,
+    uint8_t out[4]) {
+  uint8_t m[8]         = {0};
+  uint32_t local_count = 0;
+  size_t size          = 4;
+  uint8_t data[16]     = {0};
   uint32_t m_length;
 
   DevAssert(stream_cipher != NULL);
   DevAssert(stream_cipher->key != NULL);
-  DevAssert(stream_cipher->key_length > 0);
+  DevAssert(stream_cipher->key_length == NAS_ALGORITHMS_KEY_SIZE);
   DevAssert(out != NULL);
-  zero_bit = stream_cipher->blength & 0x7;
-  m_length = stream_cipher->blength >> 3;
-
-  if (zero_bit > 0) m_length += 1;
+  if (!ctx.set_nia2_key(stream_cipher->key)) return -1;
+  m_length = (stream_cipher->blength + 7) >> 3;
 
+  // COUNT | BEARER | DIRECTION | 0...0 | message, without copying the message
   local_count = hton_int32(stream_cipher->count);
-  m           = (uint8_t*) calloc(m_length + 8, sizeof(uint8_t));
   memcpy(&m[0], &local_count, 4);
   m[4] = ((stream_cipher->bearer & 0x1F) << 3) |
          ((stream_cipher->direction & 0x01) << 2);
-  memcpy(&m[8], stream_cipher->message, m_length);
 
-  Logger::amf_n1().trace(
-      "Byte length: %u, Zero bits: %u:", m_length + 8, zero_bit);
-  Logger::amf_n1().trace("m:0x%x", *m);
-  Logger::amf_n1().trace("Key:0x%x", *stream_cipher->key);
-  Logger::amf_n1().trace("Message:0x%x", *stream_cipher->message);
+  // restart with the subkeys already computed
+  if (!CMAC_Init(ctx.nia2, NULL, 0, NULL, NULL)) return -1;
+  CMAC_Update(ctx.nia2, m, sizeof(m));
+  CMAC_Update(ctx.nia2, stream_cipher->message, m_length);
+  CMAC_Final(ctx.nia2, data, &size);
+  memcpy(out, data, 4);
+  return 0;
+}
 
-  cmac_ctx = CMAC_CTX_new();
-  CMAC_Init(
-      cmac_ctx, stream_cipher->key, stream_cipher->key_length, cipher, NULL);
-  CMAC_Update(cmac_ctx, m, m_length + 8);
-  CMAC_Final(cmac_ctx, data, &size);
-  CMAC_CTX_free(cmac_ctx);
-  Logger::amf_n1().trace("Out:0x%x", *data);
-  memcpy((void*) out, data, 4);
-  free(m);
+//------------------------------------------------------------------------------
+int nas_algorithms::nas_stream_encrypt_nia2_batch(
+    nas_algorithms_ctx& ctx, nas_stream_cipher_t* const stream_ciphers,
+    uint8_t (*out)[4], const std::size_t nb) {
+  DevAssert(stream_ciphers != NULL);
+  DevAssert(out != NULL);
+  for (std::size_t i = 0; i < nb; i++) {
+    if (nas_stream_encrypt_nia2(ctx, &stream_ciphers[i], out[i])) return -1;
+  }
   return 0;
 }
+
+//------------------------------------------------------------------------------
+bool nas_algorithms::aes_hw_accelerated() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_cpu_supports("aes");
+#elif defined(__aarch64__)
+  return (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#else
+  return false;
+#endif
+}
@@ -53,6 +53,10 @@ extern "C" {
 #define SECU_DIRECTION_UPLINK 0
 #define SECU_DIRECTION_DOWNLINK 1
 
+#define NAS_ALGORITHMS_KEY_SIZE 16
+// Counter blocks of 128-NEA2 encrypted by a single AES call
+#define NAS_NEA2_KEYSTREAM_BLOCKS 64
+
 #define derive_key_nas_enc(aLGiD, kseaf, kNAS)                                 \
   Authentication_5gaka::derive_knas(NAS_ENC_ALG, aLGiD, kseaf, kNAS)
 
@@ -82,16 +86,105 @@ typedef struct {
   uint32_t blength;
 } nas_stream_cipher_t;
 
+// AES state of a key, kept in the NAS security context of the UE: the AES key
+// schedule (128-NEA2) and the CMAC subkeys (128-NIA2) are computed when the
+// key changes instead of for every message. AES runs through OpenSSL EVP,
+// which uses AES-NI (x86) or the ARMv8 Crypto Extensions when available.
+// Not thread safe, the messages of a UE are handled by one thread.
+class nas_algorithms_ctx {
+ public:
+  nas_algorithms_ctx() : nea2(nullptr), nea2_blocks(nullptr), nia2(nullptr) {}
+  ~nas_algorithms_ctx();
+  nas_algorithms_ctx(nas_algorithms_ctx const&) = delete;
+  void operator=(nas_algorithms_ctx const&) = delete;
+
+  /*
+   * Set the 128-NEA2 key, nothing done if unchanged
+   * @param [const uint8_t*] key: NAS_ALGORITHMS_KEY_SIZE bytes
+   * @return false on OpenSSL error
+   */
+  bool set_nea2_key(const uint8_t* const key);
+
+  /*
+   * Set the 128-NIA2 key, nothing done if unchanged
+   * @param [const uint8_t*] key: NAS_ALGORITHMS_KEY_SIZE bytes
+   * @return false on OpenSSL error
+   */
+  bool set_nia2_key(const uint8_t* const key);
+
+  EVP_CIPHER_CTX* nea2;         // AES-128-CTR, IV set per message
+  EVP_CIPHER_CTX* nea2_blocks;  // AES-128-ECB, counter blocks of a batch
+  CMAC_CTX* nia2;
+
+ private:
+  uint8_t nea2_key[NAS_ALGORITHMS_KEY_SIZE];
+  uint8_t nia2_key[NAS_ALGORITHMS_KEY_SIZE];
+};
+
 class nas_algorithms {
  public:
   static int nas_stream_encrypt_nea1(
       nas_stream_cipher_t* const stream_cipher, uint8_t* const out);
   static int nas_stream_encrypt_nia1(
       nas_stream_cipher_t* const stream_cipher, uint8_t const out[4]);
+  // 128-NEA2/128-NIA2 with the context of the last key used by the thread
   static int nas_stream_encrypt_nea2(
       nas_stream_cipher_t* const stream_cipher, uint8_t* const out);
   static int nas_stream_encrypt_nia2(
       nas_stream_cipher_t* const stream_cipher, uint8_t const out[4]);
+
+  /*
+   * 128-NEA2 with the key schedule of ctx
+   * @param [nas_algorithms_ctx&] ctx: AES state of the UE
+   * @param [nas_stream_cipher_t* const] stream_cipher: key, count, message...
+   * @param [uint8_t* const] out: ciphered message, may be the input message
+   * @return 0 on success
+   */
+  static int nas_stream_encrypt_nea2(
+      nas_algorithms_ctx& ctx, nas_stream_cipher_t* const stream_cipher,
+      uint8_t* const out);
+
+  /*
+   * 128-NIA2 with the CMAC state of ctx
+   * @param [nas_algorithms_ctx&] ctx: AES state of the UE
+   * @param [nas_stream_cipher_t* const] stream_cipher: key, count, message...
+   * @param [uint8_t[4]] out: MAC
+   * @return 0 on success
+   */
+  static int nas_stream_encrypt_nia2(
+      nas_algorithms_ctx& ctx, nas_stream_cipher_t* const stream_cipher,
+      uint8_t out[4]);
+
+  /*
+   * 128-NEA2 of several messages with the same key (e.g. DL NAS PDUs of a UE),
+   * the counter blocks of the messages are encrypted together so that AES
+   * runs on full pipelines even for short messages
+   * @param [nas_algorithms_ctx&] ctx: AES state of the UE
+   * @param [nas_stream_cipher_t* const] stream_ciphers: nb messages
+   * @param [uint8_t* const*] out: nb ciphered messages
+   * @param [const std::size_t] nb: number of messages
+   * @return 0 on success
+   */
+  static int nas_stream_encrypt_nea2_batch(
+      nas_algorithms_ctx& ctx, nas_stream_cipher_t* const stream_ciphers,
+      uint8_t* const* out, const std::size_t nb);
+
+  /*
+   * 128-NIA2 of several messages with the same key
+   * @param [nas_algorithms_ctx&] ctx: AES state of the UE
+   * @param [nas_stream_cipher_t* const] stream_ciphers: nb messages
+   * @param [uint8_t(*)[4]] out: nb MACs
+   * @param [const std::size_t] nb: number of messages
+   * @return 0 on success
+   */
+  static int nas_stream_encrypt_nia2_batch(
+      nas_algorithms_ctx& ctx, nas_stream_cipher_t* const stream_ciphers,
+      uint8_t (*out)[4], const std::size_t nb);
+
+  /*
+   * Whether the CPU has AES instructions (AES-NI, ARMv8 Crypto Extensions)
+   */
+  static bool aes_hw_accelerated();
 };
 
 #endif
@@ -0,0 +1,254 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file nas_secu_bench.cpp
+ \brief Micro-benchmark of the NAS ciphering and integrity algorithms, messages
+        per second on one core for NEA1/NEA2/NIA1/NIA2
+ \date 2021
+ */
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <nettle/version.h>
+#include <vector>
+
+#include "nas_algorithms.hpp"
+
+#define BENCH_DURATION_S 1.0
+#define BENCH_BATCH 8
+
+// TS 33.401 C.1 128-EEA2 Test Set 1
+static const uint8_t eea2_key[16] = {0xd3, 0xc5, 0xd5, 0x92, 0x32, 0x7f,
+                                     0xb1, 0x1c, 0x40, 0x35, 0xc6, 0x68,
+                                     0x0a, 0xf8, 0xc6, 0xd1};
+static const uint8_t eea2_plain[32] = {
+    0x98, 0x1b, 0xa6, 0x82, 0x4c, 0x1b, 0xfb, 0x1a, 0xb4, 0x85, 0x47,
+    0x20, 0x29, 0xb7, 0x1d, 0x80, 0x8c, 0xe3, 0x3e, 0x2c, 0xc3, 0xc0,
+    0xb5, 0xfc, 0x1f, 0x3d, 0xe8, 0xa6, 0xdc, 0x66, 0xb1, 0xf0};
+static const uint8_t eea2_ciphered[32] = {
+    0xe9, 0xfe, 0xd8, 0xa6, 0x3d, 0x15, 0x53, 0x04, 0xd7, 0x1d, 0xf2,
+    0x0b, 0xf3, 0xe8, 0x22, 0x14, 0xb2, 0x0e, 0xd7, 0xda, 0xd2, 0xf2,
+    0x33, 0xdc, 0x3c, 0x22, 0xd7, 0xbd, 0xee, 0xed, 0x8e, 0x78};
+
+// TS 33.401 C.2 128-EIA2 Test Set 2 (NAS messages are whole bytes, the MAC of
+// the other lengths is not bit exact)
+static const uint8_t eia2_message[8] = {0x48, 0x45, 0x83, 0xd5,
+                                        0xaf, 0xe0, 0x82, 0xae};
+static const uint8_t eia2_mac[4]     = {0xb9, 0x37, 0x87, 0xe6};
+
+//------------------------------------------------------------------------------
+// Previous 128-NEA2: context and output allocated, key expanded per message
+static void legacy_nea2(nas_stream_cipher_t* const sc, uint8_t* const out) {
+  uint8_t m[16]        = {0};
+  uint32_t local_count = hton_int32(sc->count);
+  uint32_t byte_length = (sc->blength + 7) >> 3;
+  void* ctx            = malloc(nettle_aes128.context_size);
+  uint8_t* data        = (uint8_t*) malloc(byte_length);
+  memcpy(&m[0], &local_count, 4);
+  m[4] = ((sc->bearer & 0x1F) << 3) | ((sc->direction & 0x01) << 2);
+#if NETTLE_VERSION_MAJOR < 3
+  nettle_aes128.set_encrypt_key(ctx, sc->key_length, sc->key);
+#else
+  nettle_aes128.set_encrypt_key(ctx, sc->key);
+#endif
+  nettle_ctr_crypt(
+      ctx, nettle_aes128.encrypt, nettle_aes128.block_size, m, byte_length,
+      data, sc->message);
+  if (sc->blength & 0x7)
+    data[byte_length - 1] &= (uint8_t)(0xFF << (8 - (sc->blength & 0x7)));
+  memcpy(out, data, byte_length);
+  free(data);
+  free(ctx);
+}
+
+//------------------------------------------------------------------------------
+// Previous 128-NIA2: CMAC context and message copy allocated per message
+static void legacy_nia2(nas_stream_cipher_t* const sc, uint8_t out[4]) {
+  uint32_t m_length    = (sc->blength + 7) >> 3;
+  uint32_t local_count = hton_int32(sc->count);
+  uint8_t data[16]     = {0};
+  size_t size          = 4;
+  uint8_t* m           = (uint8_t*) calloc(m_length + 8, sizeof(uint8_t));
+  memcpy(&m[0], &local_count, 4);
+  m[4] = ((sc->bearer & 0x1F) << 3) | ((sc->direction & 0x01) << 2);
+  memcpy(&m[8], sc->message, m_length);
+  CMAC_CTX* cmac_ctx = CMAC_CTX_new();
+  CMAC_Init(cmac_ctx, sc->key, sc->key_length, EVP_aes_128_cbc(), NULL);
+  CMAC_Update(cmac_ctx, m, m_length + 8);
+  CMAC_Final(cmac_ctx, data, &size);
+  CMAC_CTX_free(cmac_ctx);
+  memcpy(out, data, 4);
+  free(m);
+}
+
+//------------------------------------------------------------------------------
+static bool check() {
+  nas_algorithms_ctx ctx;
+  uint8_t message[32];
+  uint8_t out[32];
+  uint8_t mac[4];
+
+  memcpy(message, eea2_plain, sizeof(message));
+  nas_stream_cipher_t sc = {};
+  sc.key                 = (uint8_t*) eea2_key;
+  sc.key_length          = 16;
+  sc.count               = 0x398a59b4;
+  sc.bearer              = 0x15;
+  sc.direction           = 1;
+  sc.message             = message;
+  sc.blength             = 253;
+  nas_algorithms::nas_stream_encrypt_nea2(ctx, &sc, out);
+  if (memcmp(out, eea2_ciphered, sizeof(out))) {
+    std::cerr << "128-NEA2 test set 1 failed" << std::endl;
+    return false;
+  }
+
+  sc.count     = 0x398a59b4;
+  sc.bearer    = 0x1a;
+  sc.direction = 1;
+  sc.message   = (uint8_t*) eia2_message;
+  sc.blength   = 64;
+  nas_algorithms::nas_stream_encrypt_nia2(ctx, &sc, mac);
+  if (memcmp(mac, eia2_mac, sizeof(mac))) {
+    std::cerr << "128-NIA2 test set 2 failed" << std::endl;
+    return false;
+  }
+
+  // Cached, batched and previous implementations must agree
+  std::vector<uint8_t> plain(2048);
+  for (std::size_t i = 0; i < plain.size(); i++) plain[i] = (uint8_t) i;
+  nas_stream_cipher_t scs[BENCH_BATCH];
+  std::vector<uint8_t> batch_out[BENCH_BATCH];
+  uint8_t* batch_ptr[BENCH_BATCH];
+  uint8_t batch_mac[BENCH_BATCH][4];
+  for (int len : {1, 15, 16, 17, 100, 1500}) {
+    for (int b = 0; b < BENCH_BATCH; b++) {
+      scs[b]            = {};
+      scs[b].key        = (uint8_t*) eea2_key;
+      scs[b].key_length = 16;
+      scs[b].count      = 0x100 + b;
+      scs[b].bearer     = 1;
+      scs[b].direction  = 1;
+      scs[b].message    = &plain[b];
+      scs[b].blength    = (len + b) * 8 - (b & 3);
+      batch_out[b].assign(len + b, 0);
+      batch_ptr[b] = batch_out[b].data();
+    }
+    nas_algorithms::nas_stream_encrypt_nea2_batch(
+        ctx, scs, batch_ptr, BENCH_BATCH);
+    nas_algorithms::nas_stream_encrypt_nia2_batch(
+        ctx, scs, batch_mac, BENCH_BATCH);
+    for (int b = 0; b < BENCH_BATCH; b++) {
+      std::vector<uint8_t> ref(len + b);
+      uint8_t ref_mac[4];
+      legacy_nea2(&scs[b], ref.data());
+      legacy_nia2(&scs[b], ref_mac);
+      if ((ref != batch_out[b]) || memcmp(ref_mac, batch_mac[b], 4)) {
+        std::cerr << "Batch differs from the previous implementation, length "
+                  << len + b << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Run f for BENCH_DURATION_S, f handles nb messages
+template<typename F>
+static void bench(const char* name, const int nb, F f) {
+  uint64_t count = 0;
+  auto start     = std::chrono::steady_clock::now();
+  auto end       = start;
+  do {
+    for (int i = 0; i < 1024; i += nb) f();
+    count += 1024;
+    end = std::chrono::steady_clock::now();
+  } while (std::chrono::duration<double>(end - start).count() <
+           BENCH_DURATION_S);
+  double s = std::chrono::duration<double>(end - start).count();
+  std::cout << "  " << name << ": " << (count / s) / 1e3 << " k messages/s, "
+            << (s * 1e9) / count << " ns/message" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+static void bench_size(const int len) {
+  nas_algorithms_ctx ctx;
+  std::vector<uint8_t> plain(len * BENCH_BATCH, 0x5a);
+  std::vector<uint8_t> out(len * BENCH_BATCH + 16);
+  uint8_t mac[BENCH_BATCH][4];
+  nas_stream_cipher_t scs[BENCH_BATCH];
+  uint8_t* outs[BENCH_BATCH];
+  for (int b = 0; b < BENCH_BATCH; b++) {
+    scs[b]            = {};
+    scs[b].key        = (uint8_t*) eea2_key;
+    scs[b].key_length = 16;
+    scs[b].count      = b;
+    scs[b].bearer     = 1;
+    scs[b].direction  = 1;
+    scs[b].message    = &plain[b * len];
+    scs[b].blength    = len * 8;
+    outs[b]           = &out[b * len];
+  }
+  nas_stream_cipher_t& sc = scs[0];
+
+  std::cout << len << " bytes messages:" << std::endl;
+  bench("NEA1                ", 1, [&] {
+    nas_algorithms::nas_stream_encrypt_nea1(&sc, out.data());
+  });
+  bench("NIA1                ", 1, [&] {
+    nas_algorithms::nas_stream_encrypt_nia1(&sc, mac[0]);
+  });
+  bench("NEA2 previous       ", 1, [&] {
+    legacy_nea2(&sc, out.data());
+  });
+  bench("NEA2 thread context ", 1, [&] {
+    nas_algorithms::nas_stream_encrypt_nea2(&sc, out.data());
+  });
+  bench("NEA2 cached key     ", 1, [&] {
+    nas_algorithms::nas_stream_encrypt_nea2(ctx, &sc, out.data());
+  });
+  bench("NEA2 cached, batch  ", BENCH_BATCH, [&] {
+    nas_algorithms::nas_stream_encrypt_nea2_batch(
+        ctx, scs, outs, BENCH_BATCH);
+  });
+  bench("NIA2 previous       ", 1, [&] { legacy_nia2(&sc, mac[0]); });
+  bench("NIA2 thread context ", 1, [&] {
+    nas_algorithms::nas_stream_encrypt_nia2(&sc, mac[0]);
+  });
+  bench("NIA2 cached key     ", 1, [&] {
+    nas_algorithms::nas_stream_encrypt_nia2(ctx, &sc, mac[0]);
+  });
+  bench("NIA2 cached, batch  ", BENCH_BATCH, [&] {
+    nas_algorithms::nas_stream_encrypt_nia2_batch(ctx, scs, mac, BENCH_BATCH);
+  });
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  if (!check()) return 1;
+  std::cout << "AES instructions: "
+            << (nas_algorithms::aes_hw_accelerated() ? "yes" : "no")
+            << std::endl;
+  for (int len : {32, 128, 512}) bench_size(len);
+  return 0;
+}
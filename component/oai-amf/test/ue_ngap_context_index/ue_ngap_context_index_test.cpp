@@ -0,0 +1,204 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file ue_ngap_context_index_test.cpp
+ \brief Unit test of the UE NGAP context indexes: keys of several gNBs, moves,
+        replacements, lists of the UEs of a gNB, concurrent updates
+ \date 2021
+ */
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "ue_ngap_context_index.hpp"
+
+#define TEST_THREADS 4
+#define TEST_UES_PER_THREAD 10000
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::cerr << __func__ << ":" << __LINE__ << ": " #cond " failed"         \
+                << std::endl;                                                  \
+      return false;                                                            \
+    }                                                                          \
+  } while (0)
+
+//------------------------------------------------------------------------------
+static std::shared_ptr<ue_ngap_context> new_ue(
+    const sctp_assoc_id_t gnb_assoc_id, const uint32_t ran_ue_ngap_id) {
+  std::shared_ptr<ue_ngap_context> unc = std::make_shared<ue_ngap_context>();
+  unc->gnb_assoc_id                    = gnb_assoc_id;
+  unc->ran_ue_ngap_id                  = ran_ue_ngap_id;
+  return unc;
+}
+
+//------------------------------------------------------------------------------
+// The same RAN UE NGAP ID in 2 gNBs is 2 UEs
+static bool test_gnbs() {
+  ue_ngap_context_index index;
+  std::shared_ptr<ue_ngap_context> ue1 = new_ue(1, 7);
+  std::shared_ptr<ue_ngap_context> ue2 = new_ue(2, 7);
+  index.insert(ue1);
+  index.insert(ue2);
+  CHECK(index.find(1, 7) == ue1);
+  CHECK(index.find(2, 7) == ue2);
+  CHECK(index.find(3, 7) == nullptr);
+  CHECK(index.find(1, 8) == nullptr);
+  CHECK(index.gnb_ues_size(1) == 1);
+  CHECK(index.gnb_ues_size(2) == 1);
+
+  CHECK(index.remove(1, 7) == ue1);
+  CHECK(index.remove(1, 7) == nullptr);
+  CHECK(index.find(1, 7) == nullptr);
+  CHECK(index.find(2, 7) == ue2);
+  CHECK(index.gnb_ues_size(1) == 0);
+  CHECK(!ue1->indexed);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// A context inserted again with new IDs (handover) is moved, the context of
+// the same IDs is replaced
+static bool test_move_replace() {
+  ue_ngap_context_index index;
+  std::shared_ptr<ue_ngap_context> ue1 = new_ue(1, 10);
+  std::shared_ptr<ue_ngap_context> ue2 = new_ue(1, 11);
+  index.insert(ue1);
+  index.insert(ue2);
+  index.insert(ue1);  // same IDs, no change
+  CHECK(index.gnb_ues_size(1) == 2);
+
+  ue1->gnb_assoc_id   = 2;
+  ue1->ran_ue_ngap_id = 20;
+  index.insert(ue1);
+  CHECK(index.find(1, 10) == nullptr);
+  CHECK(index.find(2, 20) == ue1);
+  CHECK(index.gnb_ues_size(1) == 1);
+  CHECK(index.gnb_ues_size(2) == 1);
+
+  std::shared_ptr<ue_ngap_context> ue3 = new_ue(2, 20);
+  index.insert(ue3);
+  CHECK(index.find(2, 20) == ue3);
+  CHECK(index.gnb_ues_size(2) == 1);
+  CHECK(!ue1->indexed);
+  CHECK(ue3->indexed);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Lists of the UEs of the gNBs, removals at the head, middle and tail
+static bool test_gnb_ues() {
+  ue_ngap_context_index index;
+  std::vector<std::shared_ptr<ue_ngap_context>> ues;
+  for (uint32_t i = 0; i < 100; i++) {
+    ues.push_back(new_ue(1 + (i % 2), i));
+    index.insert(ues.back());
+  }
+  CHECK(index.gnb_ues_size(1) == 50);
+  CHECK(index.gnb_ues_size(2) == 50);
+
+  // inserted at the head: 98 head, 0 tail
+  for (uint32_t i : {98, 50, 0}) CHECK(index.remove(1, i) == ues[i]);
+  std::vector<std::shared_ptr<ue_ngap_context>> gnb_ues = {};
+  index.get_gnb_ues(1, gnb_ues);
+  CHECK(gnb_ues.size() == 47);
+  for (const auto& unc : gnb_ues) {
+    CHECK(unc->gnb_assoc_id == 1);
+    CHECK(index.find(1, unc->ran_ue_ngap_id) == unc);
+  }
+
+  // NG Reset of a gNB
+  for (const auto& unc : gnb_ues)
+    CHECK(index.remove(1, unc->ran_ue_ngap_id) == unc);
+  gnb_ues.clear();
+  index.get_gnb_ues(1, gnb_ues);
+  CHECK(gnb_ues.empty());
+  CHECK(index.gnb_ues_size(1) == 0);
+  CHECK(index.gnb_ues_size(2) == 50);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Threads inserting, finding and removing the UEs of their gNB, and listing
+// them, while the others do the same
+static bool test_concurrency() {
+  ue_ngap_context_index index;
+  std::vector<std::thread> threads;
+  std::vector<int> errors(TEST_THREADS, 0);
+  for (int t = 0; t < TEST_THREADS; t++) {
+    threads.emplace_back([&index, &errors, t] {
+      const sctp_assoc_id_t gnb = t + 1;
+      std::vector<std::shared_ptr<ue_ngap_context>> ues;
+      for (uint32_t i = 0; i < TEST_UES_PER_THREAD; i++) {
+        ues.push_back(new_ue(gnb, i));
+        index.insert(ues.back());
+      }
+      for (uint32_t i = 0; i < TEST_UES_PER_THREAD; i++) {
+        if (index.find(gnb, i) != ues[i]) errors[t]++;
+      }
+      std::vector<std::shared_ptr<ue_ngap_context>> gnb_ues = {};
+      index.get_gnb_ues(gnb, gnb_ues);
+      if (gnb_ues.size() != TEST_UES_PER_THREAD) errors[t]++;
+      for (uint32_t i = 0; i < TEST_UES_PER_THREAD; i += 2) {
+        if (index.remove(gnb, i) != ues[i]) errors[t]++;
+      }
+      if (index.gnb_ues_size(gnb) != TEST_UES_PER_THREAD / 2) errors[t]++;
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (int t = 0; t < TEST_THREADS; t++) CHECK(errors[t] == 0);
+  for (int t = 0; t < TEST_THREADS; t++) {
+    CHECK(index.find(t + 1, 0) == nullptr);
+    CHECK(index.find(t + 1, 1) != nullptr);
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static bool test_amf_index() {
+  ue_ngap_context_amf_index index;
+  std::shared_ptr<ue_ngap_context> ue1 = new_ue(1, 1);
+  std::shared_ptr<ue_ngap_context> ue2 = new_ue(1, 2);
+  for (unsigned long id = 1; id <= 1000; id++) index.insert(id, ue1);
+  CHECK(index.find(1000) == ue1);
+  CHECK(index.find(1001) == nullptr);
+  index.insert(1000, ue2);
+  CHECK(index.find(1000) == ue2);
+  for (unsigned long id = 1; id < 1000; id++) CHECK(index.remove(id) == ue1);
+  CHECK(index.remove(1) == nullptr);
+  CHECK(index.find(1) == nullptr);
+  CHECK(index.find(1000) == ue2);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  bool ok = true;
+  ok &= test_gnbs();
+  ok &= test_move_replace();
+  ok &= test_gnb_ues();
+  ok &= test_concurrency();
+  ok &= test_amf_index();
+  std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+  return ok ? 0 : 1;
+}
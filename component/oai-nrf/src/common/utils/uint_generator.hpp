@@ -28,65 +28,114 @@
 #ifndef FILE_UINT_GENERATOR_HPP_SEEN
 #define FILE_UINT_GENERATOR_HPP_SEEN
 
+#include <stdint.h>
+
+#include <atomic>
 #include <mutex>
-#include <set>
+#include <unordered_set>
+#include <vector>
+
+// Number of shards of a generator shared by the threads (power of 2)
+#define UINT_GENERATOR_SHARDS 64
+// Number of consecutive IDs leased by a thread from a sharded generator
+#define UINT_GENERATOR_BLOCK_SIZE 256
+// Leases kept by a thread, per type of ID (power of 2)
+#define UINT_GENERATOR_LEASES 16
 
 namespace util {
 
+// IDs taken from a counter, 0 is never generated.
+// A sharded generator leases UINT_GENERATOR_BLOCK_SIZE consecutive IDs to a
+// thread at once, the other IDs are generated by the thread without shared
+// write, otherwise one atomic increment per ID (consecutive IDs).
+// A counter of 64 bits does not wrap around, its IDs are not kept. The IDs of
+// less than 64 bits are kept until freed in a set per shard (by block, the
+// IDs of a thread are in one shard), the IDs still in use are skipped after a
+// wraparound.
 template<class UINT>
 class uint_generator {
  private:
-  UINT uid_generator;
-  std::mutex m_uid_generator;
+  static constexpr bool wraps = (sizeof(UINT) < sizeof(uint64_t));
 
-  std::set<UINT> uid_generated;
-  std::mutex m_uid_generated;
+  class alignas(64) shard {
+   public:
+    std::unordered_set<UINT> uids;
+    std::mutex m_uids;
+  };
 
- public:
-  uint_generator() : m_uid_generator(), m_uid_generated() {
-    uid_generator = 0;
-    uid_generated = {};
+  class lease {
+   public:
+    uint64_t instance = 0;
+    uint64_t next     = 0;
+    uint64_t end      = 0;
   };
 
+  const uint64_t instance;  // unique, key of the leases
+  const uint64_t block_size;
+  std::atomic<uint64_t> counter;
+  std::vector<shard> shards;
+
+  static std::atomic<uint64_t>& instances() {
+    static std::atomic<uint64_t> nb(0);
+    return nb;
+  }
+
+  uint64_t next() {
+    if (block_size == 1) return counter.fetch_add(1) + 1;
+    thread_local lease leases[UINT_GENERATOR_LEASES];
+    lease& l = leases[instance & (UINT_GENERATOR_LEASES - 1)];
+    if ((l.instance != instance) || (l.next == l.end)) {
+      l.instance = instance;
+      l.next     = counter.fetch_add(block_size) + 1;
+      l.end      = l.next + block_size;
+    }
+    return l.next++;
+  }
+
+  shard& shard_of(const UINT uid) {
+    return shards[((uid - 1) / block_size) & (shards.size() - 1)];
+  }
+
+ public:
+  /*
+   * @param [const uint32_t] nb_shards: 1 for a generator used by one thread
+   * at a time, UINT_GENERATOR_SHARDS for a generator shared by the threads
+   */
+  explicit uint_generator(const uint32_t nb_shards = 1)
+      : instance(++instances()),
+        block_size((nb_shards > 1) ? UINT_GENERATOR_BLOCK_SIZE : 1),
+        counter(0),
+        shards(wraps ? ((nb_shards > 1) ? nb_shards : 1) : 0) {}
+
   uint_generator(uint_generator const&) = delete;
   void operator=(uint_generator const&) = delete;
 
   UINT get_uid() {
-    std::unique_lock<std::mutex> lr(m_uid_generator);
-    UINT uid = ++uid_generator;
     while (true) {
-      // may happen race conditions here
-      std::unique_lock<std::mutex> ld(m_uid_generated);
-      if (uid_generated.count(uid) == 0) {
-        uid_generated.insert(uid);
-        ld.unlock();
-        lr.unlock();
-        return uid;
-      }
-      uid = ++uid_generator;
+      UINT uid = (UINT) next();
+      if (uid == 0) continue;
+      if constexpr (!wraps) return uid;
+      shard& s = shard_of(uid);
+      std::unique_lock<std::mutex> l(s.m_uids);
+      if (s.uids.insert(uid).second) return uid;
     }
   }
 
   void free_uid(UINT uid) {
-    std::unique_lock<std::mutex> l(m_uid_generated);
-    uid_generated.erase(uid);
-    l.unlock();
+    if constexpr (wraps) {
+      shard& s = shard_of(uid);
+      std::unique_lock<std::mutex> l(s.m_uids);
+      s.uids.erase(uid);
+    }
   }
 };
 
 template<class UINT>
 class uint_uid_generator {
  private:
-  UINT uid_generator;
-  std::mutex m_uid_generator;
+  uint_generator<UINT> generator;
 
-  std::set<UINT> uid_generated;
-  std::mutex m_uid_generated;
-
-  uint_uid_generator() : m_uid_generator(), m_uid_generated() {
-    uid_generator = 0;
-    uid_generated = {};
-  };
+  uint_uid_generator() : generator(UINT_GENERATOR_SHARDS){};
 
  public:
   static uint_uid_generator& get_instance() {
@@ -97,27 +146,9 @@ class uint_uid_generator {
   uint_uid_generator(uint_uid_generator const&) = delete;
   void operator=(uint_uid_generator const&) = delete;
 
-  UINT get_uid() {
-    std::unique_lock<std::mutex> lr(m_uid_generator);
-    UINT uid = ++uid_generator;
-    while (true) {
-      // may happen race conditions here
-      std::unique_lock<std::mutex> ld(m_uid_generated);
-      if (uid_generated.count(uid) == 0) {
-        uid_generated.insert(uid);
-        lr.unlock();
-        ld.unlock();
-        return uid;
-      }
-      uid = ++uid_generator;
-    }
-  }
+  UINT get_uid() { return generator.get_uid(); }
 
-  void free_uid(UINT uid) {
-    std::unique_lock<std::mutex> l(m_uid_generated);
-    uid_generated.erase(uid);
-    l.unlock();
-  }
+  void free_uid(UINT uid) { generator.free_uid(uid); }
 };
 
 }  // namespace util
@@ -65,17 +65,22 @@ void IndividualSMContextApiImpl::release_sm_context(
   xgpp_conv::sm_context_release_from_openapi(
       smContextReleaseMessage, sm_context_req_msg);
 
-  boost::shared_ptr<
-      boost::promise<smf::pdu_session_release_sm_context_response> >
-      p = boost::make_shared<
-          boost::promise<smf::pdu_session_release_sm_context_response> >();
-  boost::shared_future<smf::pdu_session_release_sm_context_response> f;
-  f = p->get_future();
-
   // Generate ID for this promise (to be used in SMF-APP)
   uint32_t promise_id = generate_promise_id();
   Logger::smf_api_server().debug("Promise ID generated %d", promise_id);
-  m_smf_app->add_promise(promise_id, p);
+
+  // The response is sent by the thread completing the procedure
+  std::shared_ptr<Pistache::Http::ResponseWriter> writer =
+      std::make_shared<Pistache::Http::ResponseWriter>(std::move(response));
+  m_smf_app->add_response_handler(
+      promise_id,
+      [writer, promise_id](
+          smf::pdu_session_release_sm_context_response& sm_context_response) {
+        Logger::smf_api_server().debug(
+            "Got result for promise ID %d", promise_id);
+        writer->send(
+            Pistache::Http::Code(sm_context_response.get_http_code()));
+      });
 
   // Handle the itti_n11_release_sm_context_request message in smf_app
   std::shared_ptr<itti_n11_release_sm_context_request> itti_msg =
@@ -84,13 +89,6 @@ void IndividualSMContextApiImpl::release_sm_context(
   itti_msg->req          = sm_context_req_msg;
   itti_msg->http_version = 1;
   m_smf_app->handle_pdu_session_release_sm_context_request(itti_msg);
-
-  // Wait for the result from APP and send reply to AMF
-  smf::pdu_session_release_sm_context_response sm_context_response = f.get();
-  Logger::smf_api_server().debug("Got result for promise ID %d", promise_id);
-
-  // TODO: Process the response
-  response.send(Pistache::Http::Code(sm_context_response.get_http_code()));
 }
 
 void IndividualSMContextApiImpl::retrieve_sm_context(
@@ -118,17 +116,21 @@ void IndividualSMContextApiImpl::update_sm_context(
   xgpp_conv::sm_context_update_from_openapi(
       smContextUpdateMessage, sm_context_req_msg);
 
-  boost::shared_ptr<
-      boost::promise<smf::pdu_session_update_sm_context_response> >
-      p = boost::make_shared<
-          boost::promise<smf::pdu_session_update_sm_context_response> >();
-  boost::shared_future<smf::pdu_session_update_sm_context_response> f;
-  f = p->get_future();
-
   // Generate ID for this promise (to be used in SMF-APP)
   uint32_t promise_id = generate_promise_id();
   Logger::smf_api_server().debug("Promise ID generated %d", promise_id);
-  m_smf_app->add_promise(promise_id, p);
+
+  // The response is sent by the thread completing the procedure
+  std::shared_ptr<Pistache::Http::ResponseWriter> writer =
+      std::make_shared<Pistache::Http::ResponseWriter>(std::move(response));
+  m_smf_app->add_response_handler(
+      promise_id,
+      [writer, promise_id](
+          smf::pdu_session_update_sm_context_response& sm_context_response) {
+        Logger::smf_api_server().debug(
+            "Got result for promise ID %d", promise_id);
+        send_sm_context_update_response(sm_context_response, *writer);
+      });
 
   // Handle the itti_n11_update_sm_context_request message in smf_app
   std::shared_ptr<itti_n11_update_sm_context_request> itti_msg =
@@ -137,11 +139,11 @@ void IndividualSMContextApiImpl::update_sm_context(
   itti_msg->req          = sm_context_req_msg;
   itti_msg->http_version = 1;
   m_smf_app->handle_pdu_session_update_sm_context_request(itti_msg);
+}
 
-  // Wait for the result from APP and send reply to AMF
-  smf::pdu_session_update_sm_context_response sm_context_response = f.get();
-  Logger::smf_api_server().debug("Got result for promise ID %d", promise_id);
-
+void IndividualSMContextApiImpl::send_sm_context_update_response(
+    smf::pdu_session_update_sm_context_response& sm_context_response,
+    Pistache::Http::ResponseWriter& response) {
   nlohmann::json json_data = {};
   std::string body         = {};
   std::string json_format;
@@ -75,6 +75,11 @@ class SMContextsCollectionApiImpl
       Pistache::Http::ResponseWriter& response);
 
  private:
+  // Called by the thread completing the procedure
+  static void send_sm_context_response(
+      smf::pdu_session_create_sm_context_response& sm_context_response,
+      Pistache::Http::ResponseWriter& response);
+
   smf::smf_app* m_smf_app;
   std::string m_address;
 
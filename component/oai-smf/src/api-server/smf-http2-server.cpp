@@ -30,8 +30,6 @@
 #include "smf-http2-server.h"
 #include <string>
 #include <boost/algorithm/string.hpp>
-#include <boost/thread.hpp>
-#include <boost/thread/future.hpp>
 #include <nlohmann/json.hpp>
 
 #include "logger.hpp"
@@ -50,6 +48,34 @@ using namespace oai::smf_server::model;
 
 extern smf::smf_config smf_cfg;
 
+//------------------------------------------------------------------------------
+// Response handler given to smf_app: the response is written from the
+// io_service of the stream (nghttp2 is not thread safe), not at all if the
+// stream was closed meanwhile
+template<class response_t>
+static std::function<void(response_t&)> make_stream_response_handler(
+    const response& res, const uint32_t promise_id,
+    const std::function<void(response_t&, const response&)>& send) {
+  std::shared_ptr<bool> closed = std::make_shared<bool>(false);
+  res.on_close([closed](uint32_t) { *closed = true; });
+  boost::asio::io_service* io_service = &res.io_service();
+  const response* stream_res          = &res;
+  return [closed, io_service, stream_res, promise_id,
+          send](response_t& sm_context_response) {
+    io_service->post([closed, stream_res, promise_id, send,
+                      sm_context_response]() mutable {
+      if (*closed) {
+        Logger::smf_api_server().warn(
+            "Stream closed, no response for promise ID %d", promise_id);
+        return;
+      }
+      Logger::smf_api_server().debug(
+          "Got result for promise ID %d", promise_id);
+      send(sm_context_response, *stream_res);
+    });
+  };
+}
+
 //------------------------------------------------------------------------------
 void smf_http2_server::start() {
   boost::system::error_code ec;
@@ -373,17 +399,13 @@ void smf_http2_server::create_sm_contexts_handler(
       NSMF_PDU_SESSION_BASE + smf_cfg.sbi_api_version +
       NSMF_PDU_SESSION_SM_CONTEXT_CREATE_URL);
 
-  boost::shared_ptr<
-      boost::promise<smf::pdu_session_create_sm_context_response> >
-      p = boost::make_shared<
-          boost::promise<smf::pdu_session_create_sm_context_response> >();
-  boost::shared_future<smf::pdu_session_create_sm_context_response> f;
-  f = p->get_future();
-
   // Generate ID for this promise (to be used in SMF-APP)
   uint32_t promise_id = generate_promise_id();
   Logger::smf_api_server().debug("Promise ID generated %d", promise_id);
-  m_smf_app->add_promise(promise_id, p);
+  m_smf_app->add_response_handler(
+      promise_id,
+      make_stream_response_handler<smf::pdu_session_create_sm_context_response>(
+          response, promise_id, &smf_http2_server::send_sm_context_response));
 
   // Handle the pdu_session_create_sm_context_request message in smf_app
   std::shared_ptr<itti_n11_create_sm_context_request> itti_msg =
@@ -392,10 +414,12 @@ void smf_http2_server::create_sm_contexts_handler(
   itti_msg->req          = sm_context_req_msg;
   itti_msg->http_version = 2;
   m_smf_app->handle_pdu_session_create_sm_context_request(itti_msg);
+}
 
-  // Wait for the result from APP and send reply to AMF
-  smf::pdu_session_create_sm_context_response sm_context_response = f.get();
-  Logger::smf_api_server().debug("Got result for promise ID %d", promise_id);
+//------------------------------------------------------------------------------
+void smf_http2_server::send_sm_context_response(
+    smf::pdu_session_create_sm_context_response& sm_context_response,
+    const response& response) {
   nlohmann::json json_data = {};
   sm_context_response.get_json_data(json_data);
   std::string json_format;
@@ -438,17 +462,14 @@ void smf_http2_server::update_sm_context_handler(
   xgpp_conv::sm_context_update_from_openapi(
       smContextUpdateMessage, sm_context_req_msg);
 
-  boost::shared_ptr<
-      boost::promise<smf::pdu_session_update_sm_context_response> >
-      p = boost::make_shared<
-          boost::promise<smf::pdu_session_update_sm_context_response> >();
-  boost::shared_future<smf::pdu_session_update_sm_context_response> f;
-  f = p->get_future();
-
   // Generate ID for this promise (to be used in SMF-APP)
   uint32_t promise_id = generate_promise_id();
   Logger::smf_api_server().debug("Promise ID generated %d", promise_id);
-  m_smf_app->add_promise(promise_id, p);
+  m_smf_app->add_response_handler(
+      promise_id,
+      make_stream_response_handler<smf::pdu_session_update_sm_context_response>(
+          response, promise_id,
+          &smf_http2_server::send_sm_context_update_response));
 
   // Handle the itti_n11_update_sm_context_request message in smf_app
   std::shared_ptr<itti_n11_update_sm_context_request> itti_msg =
@@ -457,11 +478,12 @@ void smf_http2_server::update_sm_context_handler(
   itti_msg->req          = sm_context_req_msg;
   itti_msg->http_version = 2;
   m_smf_app->handle_pdu_session_update_sm_context_request(itti_msg);
+}
 
-  // Wait for the result from APP and send reply to AMF
-  smf::pdu_session_update_sm_context_response sm_context_response = f.get();
-  Logger::smf_api_server().debug("Got result for promise ID %d", promise_id);
-
+//------------------------------------------------------------------------------
+void smf_http2_server::send_sm_context_update_response(
+    smf::pdu_session_update_sm_context_response& sm_context_response,
+    const response& response) {
   nlohmann::json json_data = {};
   std::string body         = {};
   header_map h             = {};
@@ -519,17 +541,19 @@ void smf_http2_server::release_sm_context_handler(
   xgpp_conv::sm_context_release_from_openapi(
       smContextReleaseMessage, sm_context_req_msg);
 
-  boost::shared_ptr<
-      boost::promise<smf::pdu_session_release_sm_context_response> >
-      p = boost::make_shared<
-          boost::promise<smf::pdu_session_release_sm_context_response> >();
-  boost::shared_future<smf::pdu_session_release_sm_context_response> f;
-  f = p->get_future();
-
   // Generate ID for this promise (to be used in SMF-APP)
   uint32_t promise_id = generate_promise_id();
   Logger::smf_api_server().debug("Promise ID generated %d", promise_id);
-  m_smf_app->add_promise(promise_id, p);
+  m_smf_app->add_response_handler(
+      promise_id,
+      make_stream_response_handler<
+          smf::pdu_session_release_sm_context_response>(
+          response, promise_id,
+          [](smf::pdu_session_release_sm_context_response& sm_context_response,
+             const nghttp2::asio_http2::server::response& res) {
+            res.write_head(sm_context_response.get_http_code());
+            res.end();
+          }));
 
   // handle Nsmf_PDUSession_UpdateSMContext Request
   Logger::smf_api_server().info(
@@ -542,13 +566,6 @@ void smf_http2_server::release_sm_context_handler(
   itti_msg->scid         = smf_ref;
   itti_msg->http_version = 2;
   m_smf_app->handle_pdu_session_release_sm_context_request(itti_msg);
-
-  // wait for the result from APP and send reply to AMF
-  smf::pdu_session_release_sm_context_response sm_context_response = f.get();
-  Logger::smf_api_server().debug("Got result for promise ID %d", promise_id);
-
-  response.write_head(sm_context_response.get_http_code());
-  response.end();
 }
 
 void smf_http2_server::nf_status_notify_handler(
@@ -67,6 +67,14 @@ class smf_http2_server {
   void stop();
 
  private:
+  // Called on the io_service of the stream once the procedure is done
+  static void send_sm_context_response(
+      smf::pdu_session_create_sm_context_response& sm_context_response,
+      const response& response);
+  static void send_sm_context_update_response(
+      smf::pdu_session_update_sm_context_response& sm_context_response,
+      const response& response);
+
   util::uint_generator<uint32_t> m_promise_id_generator;
   std::string m_address;
   uint32_t m_port;
@@ -15,19 +15,39 @@
  */
 
 #include "logger.hpp"
-#include "spdlog/sinks/syslog_sink.h"
 
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
-#include <memory>
+
+#include "spdlog/sinks/syslog_sink.h"
 
 Logger* Logger::m_singleton = NULL;
 
+static const char* level_names[] = SPDLOG_LEVEL_NAMES
+
+static bool level_from_name(
+    const std::string& name, spdlog::level::level_enum& level) {
+  for (int l = spdlog::level::trace; l <= spdlog::level::off; l++) {
+    std::string level_name = level_names[l];
+    level_name.erase(level_name.find_last_not_of(' ') + 1);
+    if (level_name == name) {
+      level = (spdlog::level::level_enum) l;
+      return true;
+    }
+  }
+  return false;
+}
+
 void Logger::_init(
-    const char* app, const bool log_stdout, bool const log_rot_file) {
+    const char* app, const bool log_stdout, const bool log_rot_file,
+    const bool log_async) {
   int num_sinks = 0;
-  spdlog::set_async_mode(2048);
 #if TRACE_IS_ON
   spdlog::level::level_enum llevel = spdlog::level::trace;
 #elif DEBUG_IS_ON
@@ -37,6 +57,7 @@ void Logger::_init(
 #else
   spdlog::level::level_enum llevel = spdlog::level::warn;
 #endif
+
   if (log_stdout) {
     std::string filename = fmt::format("./{}.log", app);
     m_sinks.push_back(
@@ -52,28 +73,185 @@ void Logger::_init(
 
   std::stringstream ss;
   ss << "[%Y-%m-%dT%H:%M:%S.%f] [" << app << "] [%n] [%l] %v";
+  m_pattern = ss.str();
+  if (log_async) {
+    m_queue = new _LoggerQueue(LOGGER_ASYNC_QUEUE_SIZE);
+    // the writer prints the time of the log call, not its own
+    m_pattern = "%v";
+  }
+
+  m_async_cmd      = add(app, "async_c", m_pattern.c_str());
+  m_itti           = add(app, "itti   ", m_pattern.c_str());
+  m_smf_app        = add(app, "smf_app", m_pattern.c_str());
+  m_system         = add(app, "system ", m_pattern.c_str());
+  m_udp            = add(app, "udp    ", m_pattern.c_str());
+  m_pfcp           = add(app, "pfcp   ", m_pattern.c_str());
+  m_pfcp_switch    = add(app, "pfcp_sw ", m_pattern.c_str());
+  m_smf_n1         = add(app, "smf_n1 ", m_pattern.c_str());
+  m_smf_n2         = add(app, "smf_n2 ", m_pattern.c_str());
+  m_smf_n4         = add(app, "smf_n4 ", m_pattern.c_str());
+  m_smf_sbi        = add(app, "smf_sbi", m_pattern.c_str());
+  m_smf_api_server = add(app, "sbi_srv", m_pattern.c_str());
+
+  if (m_queue) m_queue->start(m_system);
+}
+
+_Logger* Logger::add(
+    const char* app, const char* category, const char* pattern) {
+  _Logger* logger = new _Logger(app, category, m_sinks, pattern, m_queue);
+  m_loggers.push_back(logger);
+  return logger;
+}
+
+bool Logger::_set_levels(const std::string& levels) {
+  std::stringstream ss(levels);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    std::size_t pos = item.find('=');
+    if (pos == std::string::npos) return false;
+    std::string category = item.substr(0, pos);
+    spdlog::level::level_enum level;
+    if (!level_from_name(item.substr(pos + 1), level)) return false;
+
+    bool found = false;
+    for (auto logger : m_loggers) {
+      if ((category == "all") || (category == logger->get_category())) {
+        logger->set_level(level);
+        found = true;
+      }
+    }
+    if (!found) return false;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
 
-  m_async_cmd      = new _Logger("async_c", m_sinks, ss.str().c_str());
-  m_itti           = new _Logger("itti   ", m_sinks, ss.str().c_str());
-  m_smf_app        = new _Logger("smf_app", m_sinks, ss.str().c_str());
-  m_system         = new _Logger("system ", m_sinks, ss.str().c_str());
-  m_udp            = new _Logger("udp    ", m_sinks, ss.str().c_str());
-  m_pfcp           = new _Logger("pfcp   ", m_sinks, ss.str().c_str());
-  m_pfcp_switch    = new _Logger("pfcp_sw ", m_sinks, ss.str().c_str());
-  m_smf_n1         = new _Logger("smf_n1 ", m_sinks, ss.str().c_str());
-  m_smf_n2         = new _Logger("smf_n2 ", m_sinks, ss.str().c_str());
-  m_smf_n4         = new _Logger("smf_n4 ", m_sinks, ss.str().c_str());
-  m_smf_sbi        = new _Logger("smf_sbi", m_sinks, ss.str().c_str());
-  m_smf_api_server = new _Logger("sbi_srv", m_sinks, ss.str().c_str());
+_LoggerQueue::_LoggerQueue(const std::size_t capacity)
+    : records(capacity),
+      head(0),
+      size(0),
+      pushed(0),
+      written(0),
+      dropped(0),
+      writer_waiting(false),
+      stopping(true),
+      m_records(),
+      c_records(),
+      c_written(),
+      reporter(nullptr),
+      writer() {}
+
+_LoggerQueue::~_LoggerQueue() {
+  {
+    std::unique_lock lock(m_records);
+    stopping = true;
+  }
+  c_records.notify_one();
+  if (writer.joinable()) writer.join();
+}
+
+void _LoggerQueue::start(_Logger* reporter) {
+  this->reporter = reporter;
+  stopping       = false;
+  writer         = std::thread(&_LoggerQueue::run, this);
+}
+
+bool _LoggerQueue::push(
+    _Logger* logger, spdlog::level::level_enum level, const char* message,
+    std::size_t length) {
+  std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+  std::unique_lock lock(m_records);
+  if (size == records.size()) {
+    dropped++;
+    return false;
+  }
+  // the strings of the slots keep their capacity
+  record& r = records[(head + size) % records.size()];
+  r.logger  = logger;
+  r.level   = level;
+  r.time    = now;
+  r.message.assign(message, length);
+  size++;
+  pushed++;
+  bool notify    = writer_waiting;
+  writer_waiting = false;
+  lock.unlock();
+  if (notify) c_records.notify_one();
+  return true;
+}
+
+void _LoggerQueue::flush() {
+  std::unique_lock lock(m_records);
+  uint64_t target = pushed;
+  c_written.wait(lock, [&] { return stopping || (written >= target); });
+}
+
+uint64_t _LoggerQueue::get_dropped() {
+  std::unique_lock lock(m_records);
+  return dropped;
+}
+
+void _LoggerQueue::run() {
+  std::vector<record> batch(LOGGER_ASYNC_BATCH);
+  uint64_t reported = 0;
+  while (true) {
+    std::size_t nb = 0;
+    uint64_t drops = 0;
+    {
+      std::unique_lock lock(m_records);
+      while ((size == 0) && !stopping) {
+        writer_waiting = true;
+        c_records.wait(lock);
+      }
+      writer_waiting = false;
+      if (size == 0) break;
+      while ((size > 0) && (nb < batch.size())) {
+        record& r        = records[head];
+        batch[nb].logger = r.logger;
+        batch[nb].level  = r.level;
+        batch[nb].time   = r.time;
+        batch[nb].message.swap(r.message);
+        head = (head + 1) % records.size();
+        size--;
+        nb++;
+      }
+      drops = dropped;
+    }
+
+    for (std::size_t i = 0; i < nb; i++)
+      batch[i].logger->write(batch[i].level, batch[i].time, batch[i].message);
+    if ((drops != reported) && reporter) {
+      reporter->write(
+          spdlog::level::err, std::chrono::system_clock::now(),
+          std::to_string(drops - reported) +
+              " log messages dropped, the queue is full");
+      reported = drops;
+    }
+
+    {
+      std::unique_lock lock(m_records);
+      written += nb;
+    }
+    c_written.notify_all();
+  }
+  c_written.notify_all();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
 _Logger::_Logger(
-    const char* category, std::vector<spdlog::sink_ptr>& sinks,
-    const char* pattern)
-    : m_log(category, sinks.begin(), sinks.end()) {
+    const char* app, const char* category,
+    std::vector<spdlog::sink_ptr>& sinks, const char* pattern,
+    _LoggerQueue* queue)
+    : m_category(category),
+      m_prefix(),
+      m_queue(queue),
+      m_log(category, sinks.begin(), sinks.end()) {
+  m_category.erase(m_category.find_last_not_of(' ') + 1);
+  m_prefix = std::string("] [") + app + "] [" + category + "] [";
   m_log.set_pattern(pattern);
 #if TRACE_IS_ON
   m_log.set_level(spdlog::level::trace);
@@ -134,29 +312,61 @@ void _Logger::error(const char* format, ...) {
   va_end(args);
 }
 
-void _Logger::log(_LogType lt, const char* format, va_list& args) {
-  char buffer[2048];
-
-  vsnprintf(buffer, sizeof(buffer), format, args);
+void _Logger::set_level(spdlog::level::level_enum level) {
+  m_log.set_level(level);
+}
 
+void _Logger::log(_LogType lt, const char* format, va_list& args) {
+  spdlog::level::level_enum level = spdlog::level::off;
   switch (lt) {
     case _ltTrace:
-      m_log.trace(buffer);
+      level = spdlog::level::trace;
       break;
     case _ltDebug:
-      m_log.debug(buffer);
+      level = spdlog::level::debug;
       break;
     case _ltInfo:
-      m_log.info(buffer);
+      level = spdlog::level::info;
       break;
     case _ltStartup:
-      m_log.warn(buffer);
+      level = spdlog::level::warn;
       break;
     case _ltWarn:
-      m_log.error(buffer);
+      level = spdlog::level::err;
       break;
     case _ltError:
-      m_log.critical(buffer);
+      level = spdlog::level::critical;
       break;
   }
+  // nothing formatted for the levels not logged
+  if (!m_log.should_log(level)) return;
+
+  char buffer[LOGGER_MESSAGE_SIZE];
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  if (length < 0) return;
+  if (m_queue) {
+    m_queue->push(
+        this, level, buffer,
+        std::min((std::size_t) length, sizeof(buffer) - 1));
+    return;
+  }
+  m_log.log(level, "{}", buffer);
+}
+
+void _Logger::write(
+    spdlog::level::level_enum level,
+    const std::chrono::system_clock::time_point& time,
+    const std::string& message) {
+  // same format as the synchronous pattern
+  time_t t = std::chrono::system_clock::to_time_t(time);
+  struct tm tm;
+  localtime_r(&t, &tm);
+  long us = std::chrono::duration_cast<std::chrono::microseconds>(
+                time.time_since_epoch())
+                .count() %
+            1000000;
+  char stamp[48];
+  std::size_t n = strftime(stamp, sizeof(stamp), "[%Y-%m-%dT%H:%M:%S", &tm);
+  snprintf(stamp + n, sizeof(stamp) - n, ".%06ld", us);
+  m_log.log(level, "{}{}{}] {}", stamp, m_prefix, level_names[level], message);
 }
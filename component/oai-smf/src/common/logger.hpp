@@ -17,8 +17,15 @@
 #ifndef __LOGGER_H
 #define __LOGGER_H
 
+#include <stdint.h>
+
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
 #define SPDLOG_LEVEL_NAMES                                                     \
@@ -27,17 +34,93 @@
 #define SPDLOG_ENABLE_SYSLOG
 #include "spdlog/spdlog.h"
 
+// Longer messages are truncated
+#define LOGGER_MESSAGE_SIZE 2048
+// Asynchronous mode: messages waiting for the writer, the next ones are
+// dropped (and counted) when it is full
+#define LOGGER_ASYNC_QUEUE_SIZE 8192
+#define LOGGER_ASYNC_BATCH 64
+
 class LoggerException : public std::runtime_error {
  public:
   explicit LoggerException(const char* m) : std::runtime_error(m) {}
   explicit LoggerException(const std::string& m) : std::runtime_error(m) {}
 };
 
+class _Logger;
+
+// Messages formatted by the logging threads, written to the sinks by one
+// thread (timestamp of the log call)
+class _LoggerQueue {
+ public:
+  explicit _LoggerQueue(const std::size_t capacity);
+  ~_LoggerQueue();
+  _LoggerQueue(_LoggerQueue const&) = delete;
+  void operator=(_LoggerQueue const&) = delete;
+
+  /*
+   * Start the writer
+   * @param [_Logger*] reporter: category reporting the dropped messages
+   * @return void
+   */
+  void start(_Logger* reporter);
+
+  /*
+   * Queue a message
+   * @param [_Logger*] logger: category
+   * @param [spdlog::level::level_enum] level: level
+   * @param [const char*] message: formatted message
+   * @param [std::size_t] length: length of the message
+   * @return false if the queue is full (message dropped)
+   */
+  bool push(
+      _Logger* logger, spdlog::level::level_enum level, const char* message,
+      std::size_t length);
+
+  /*
+   * Wait until the queued messages are written
+   * @return void
+   */
+  void flush();
+
+  /*
+   * Number of messages dropped since the start
+   * @return number of messages
+   */
+  uint64_t get_dropped();
+
+ private:
+  class record {
+   public:
+    _Logger* logger;
+    spdlog::level::level_enum level;
+    std::chrono::system_clock::time_point time;
+    std::string message;
+  };
+
+  void run();
+
+  std::vector<record> records;
+  std::size_t head;
+  std::size_t size;
+  uint64_t pushed;
+  uint64_t written;
+  uint64_t dropped;
+  bool writer_waiting;
+  bool stopping;
+  std::mutex m_records;
+  std::condition_variable c_records;
+  std::condition_variable c_written;
+  _Logger* reporter;  // reports the dropped messages
+  std::thread writer;
+};
+
 class _Logger {
  public:
   _Logger(
-      const char* category, std::vector<spdlog::sink_ptr>& sinks,
-      const char* pattern);
+      const char* app, const char* category,
+      std::vector<spdlog::sink_ptr>& sinks, const char* pattern,
+      _LoggerQueue* queue);
 
   void trace(const char* format, ...);
   void trace(const std::string& format, ...);
@@ -52,25 +135,80 @@ class _Logger {
   void error(const char* format, ...);
   void error(const std::string& format, ...);
 
+  /*
+   * Change the level of the category at runtime (the levels under the one
+   * of the build are not logged)
+   * @param [spdlog::level::level_enum] level: lowest level logged
+   * @return void
+   */
+  void set_level(spdlog::level::level_enum level);
+
+  /*
+   * Category name, without padding
+   * @return category
+   */
+  const std::string& get_category() const { return m_category; }
+
+  /*
+   * Write a message to the sinks, called by the writer of the queue
+   * @param [spdlog::level::level_enum] level: level
+   * @param [const std::chrono::system_clock::time_point&] time: log call time
+   * @param [const std::string&] message: formatted message
+   * @return void
+   */
+  void write(
+      spdlog::level::level_enum level,
+      const std::chrono::system_clock::time_point& time,
+      const std::string& message);
+
  private:
   _Logger();
-
   enum _LogType { _ltTrace, _ltDebug, _ltInfo, _ltStartup, _ltWarn, _ltError };
 
   void log(_LogType lt, const char* format, va_list& args);
-
+  std::string m_category;
+  std::string m_prefix;  // "] [app] [category] [", asynchronous mode
+  _LoggerQueue* m_queue;
   spdlog::logger m_log;
 };
 
 class Logger {
  public:
   static void init(
-      const char* app, const bool log_stdout, const bool log_rot_file) {
-    singleton()._init(app, log_stdout, log_rot_file);
+      const char* app, const bool log_stdout, const bool log_rot_file,
+      const bool log_async = false) {
+    singleton()._init(app, log_stdout, log_rot_file, log_async);
   }
   static void init(
-      const std::string& app, const bool log_stdout, const bool log_rot_file) {
-    init(app.c_str(), log_stdout, log_rot_file);
+      const std::string& app, const bool log_stdout, const bool log_rot_file,
+      const bool log_async = false) {
+    init(app.c_str(), log_stdout, log_rot_file, log_async);
+  }
+
+  /*
+   * Set the level of categories, e.g. "all=info,pfcp=warn,smf_app=debug"
+   * (levels: trace, debug, info, start, warn, error, off)
+   * @param [const std::string&] levels: comma separated category=level
+   * @return false if a category or a level is unknown
+   */
+  static bool set_levels(const std::string& levels) {
+    return singleton()._set_levels(levels);
+  }
+
+  /*
+   * Write the queued messages (asynchronous mode), before exiting
+   * @return void
+   */
+  static void flush() {
+    if (singleton().m_queue) singleton().m_queue->flush();
+  }
+
+  /*
+   * Number of messages dropped because the queue was full
+   * @return number of messages
+   */
+  static uint64_t get_dropped() {
+    return singleton().m_queue ? singleton().m_queue->get_dropped() : 0;
   }
 
   static _Logger& async_cmd() { return *singleton().m_async_cmd; }
@@ -94,15 +232,22 @@ class Logger {
     return *m_singleton;
   }
 
-  Logger() {}
+  Logger() : m_queue(nullptr) {}
   ~Logger() {}
 
-  void _init(const char* app, const bool log_stdout, const bool log_rot_file);
+  void _init(
+      const char* app, const bool log_stdout, const bool log_rot_file,
+      const bool log_async);
+  bool _set_levels(const std::string& levels);
+  _Logger* add(const char* app, const char* category, const char* pattern);
 
   std::vector<spdlog::sink_ptr> m_sinks;
 
   std::string m_pattern;
 
+  _LoggerQueue* m_queue;
+  std::vector<_Logger*> m_loggers;
+
   _Logger* m_async_cmd;
   _Logger* m_itti;
   _Logger* m_smf_app;
@@ -456,4 +456,20 @@ class itti_n11_subscribe_upf_status_notify : public itti_n11_msg {
   uint8_t http_version;
 };
 
+//-----------------------------------------------------------------------------
+class itti_n11_get_sm_data_response : public itti_n11_msg {
+ public:
+  itti_n11_get_sm_data_response(const task_id_t orig, const task_id_t dest)
+      : itti_n11_msg(N11_GET_SM_DATA_RESPONSE, orig, dest),
+        smreq(),
+        http_response_code(0),
+        body() {}
+  const char* get_msg_name() { return "N11_GET_SM_DATA_RESPONSE"; };
+
+  // Request waiting for the SM subscription data
+  std::shared_ptr<itti_n11_create_sm_context_request> smreq;
+  uint32_t http_response_code;
+  std::string body;
+};
+
 #endif /* ITTI_MSG_N11_HPP_INCLUDED_ */
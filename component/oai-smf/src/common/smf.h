@@ -235,6 +235,10 @@ typedef struct qos_profile_s {
 
 // for CURL
 #define NF_CURL_TIMEOUT_MS 100L
+// SBI client: connections kept per peer authority, HTTP/2 streams share one
+#define SBI_CLIENT_MAX_HOST_CONNECTIONS 16
+#define SBI_CLIENT_MAX_CACHED_CONNECTIONS 64
+#define SBI_CLIENT_EPOLL_MAX_EVENTS 64
 #define MAX_WAIT_MSECS 10000  // 1 second
 #define AMF_NUMBER_RETRIES 3
 #define UDM_NUMBER_RETRIES 3
@@ -122,6 +122,7 @@ typedef enum {
   N11_UPDATE_NF_INSTANCE_RESPONSE,
   N11_DEREGISTER_NF_INSTANCE,
   N11_SUBSCRIBE_UPF_STATUS_NOTIFY,
+  N11_GET_SM_DATA_RESPONSE,
   NX_TRIGGER_SESSION_MODIFICATION,
   SBI_EVENT_EXPOSURE_REQUEST,
   SBI_NOTIFICATION_DATA,
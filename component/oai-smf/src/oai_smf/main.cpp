@@ -88,6 +88,7 @@ void my_app_signal_handler(int s) {
   smf_app_inst = nullptr;
   std::cout << "SMF APP memory done." << std::endl;
   std::cout << "Freeing Allocated memory done" << std::endl;
+  Logger::flush();
   exit(0);
 }
 //------------------------------------------------------------------------------
@@ -101,8 +102,15 @@ int main(int argc, char** argv) {
   }
 
   // Logger
-  Logger::init("smf", Options::getlogStdout(), Options::getlogRotFilelog());
+  Logger::init(
+      "smf", Options::getlogStdout(), Options::getlogRotFilelog(),
+      Options::getlogAsync());
   Logger::smf_app().startup("Options parsed");
+  if (!Options::getlogLevels().empty() &&
+      !Logger::set_levels(Options::getlogLevels())) {
+    std::cout << "Invalid log levels " << Options::getlogLevels() << std::endl;
+    return 1;
+  }
 
   struct sigaction sigIntHandler;
   sigIntHandler.sa_handler = my_app_signal_handler;
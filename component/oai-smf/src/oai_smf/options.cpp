@@ -26,6 +26,8 @@ int Options::options;
 std::string Options::m_libconfigcfg;
 bool Options::m_log_rot_file_log;
 bool Options::m_log_stdout;
+bool Options::m_log_async;
+std::string Options::m_log_levels;
 
 void Options::help() {
   std::cout << std::endl
@@ -39,6 +41,12 @@ void Options::help() {
             << std::endl
             << "  -r, --rotatelog              Send the application logs to "
                "local file (in  current working directory)."
+            << std::endl
+            << "  -a, --asynclog               Write the application logs "
+               "from a dedicated thread."
+            << std::endl
+            << "  -l, --loglevel levels        Log levels per category, e.g. "
+               "all=info,pfcp=warn"
             << std::endl;
 }
 
@@ -64,11 +72,13 @@ bool Options::parseInputOptions(int argc, char** argv) {
       {"libconfigcfg", required_argument, NULL, 'f'},
       {"stdoutlog", no_argument, NULL, 'o'},
       {"rotatelog", no_argument, NULL, 'r'},
+      {"asynclog", no_argument, NULL, 'a'},
+      {"loglevel", required_argument, NULL, 'l'},
       {NULL, 0, NULL, 0}};
 
   // Loop on arguments
   while (1) {
-    c = getopt_long(argc, argv, "horc:", long_options, &option_index);
+    c = getopt_long(argc, argv, "horac:l:", long_options, &option_index);
     if (c == -1) break;  // Exit from the loop.
 
     switch (c) {
@@ -92,6 +102,16 @@ bool Options::parseInputOptions(int argc, char** argv) {
         options |= log_rot_file_log;
         break;
       }
+      case 'a': {
+        m_log_async = true;
+        options |= log_async;
+        break;
+      }
+      case 'l': {
+        m_log_levels = optarg;
+        options |= log_levels;
+        break;
+      }
 
       case '?': {
         switch (optopt) {
@@ -100,6 +120,11 @@ bool Options::parseInputOptions(int argc, char** argv) {
                       << std::endl;
             break;
           }
+          case 'l': {
+            std::cout << "Option -l (log levels) requires an argument"
+                      << std::endl;
+            break;
+          }
           case 'o': {
             std::cout << "Option -o do not requires an argument, can be also "
                          "set with option -r."
@@ -30,12 +30,16 @@ class Options {
   static const std::string& getlibconfigConfig() { return m_libconfigcfg; }
   static const bool& getlogRotFilelog() { return m_log_rot_file_log; }
   static const bool& getlogStdout() { return m_log_stdout; }
+  static const bool& getlogAsync() { return m_log_async; }
+  static const std::string& getlogLevels() { return m_log_levels; }
 
  private:
   enum OptionsSelected {
     libconfigcfg     = 0x01,
     log_stdout       = 0x02,
-    log_rot_file_log = 0x04
+    log_rot_file_log = 0x04,
+    log_async        = 0x08,
+    log_levels       = 0x10
   };
 
   static void help();
@@ -44,6 +48,8 @@ class Options {
 
   static bool m_log_rot_file_log;
   static bool m_log_stdout;
+  static bool m_log_async;
+  static std::string m_log_levels;
   static std::string m_libconfigcfg;
 };
 
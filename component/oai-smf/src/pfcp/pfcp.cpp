@@ -253,7 +253,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -289,7 +289,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -327,7 +327,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -425,7 +425,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -448,15 +448,11 @@ uint32_t pfcp_l4_stack::send_request(
     const endpoint& dest, const uint64_t seid,
     const pfcp_session_establishment_request& pfcp_ies,
     const task_id_t& task_id, const uint64_t trxn_id) {
-  std::ostringstream oss(std::ostringstream::binary);
-  pfcp_msg msg(pfcp_ies);
+  pfcp_msg_header msg = {};
   msg.set_seid(seid);
   msg.set_sequence_number(get_next_seq_num());
-  msg.dump_to(oss);
-  // std::cout << string_to_hex(oss.str()) << std::endl;
-  // std::cout << std::hex << "msg length 0x" << msg.get_message_length() <<
-  // "msg seqnum 0x" << msg.get_sequence_number() << std::endl;
-  std::string bstream = oss.str();
+  std::string bstream = {};
+  pfcp::encode(msg, pfcp_ies, bstream);
 
   Logger::pfcp().trace(
       "Sending %s, seq %d seid " SEID_FMT " ", pfcp_ies.get_msg_name(),
@@ -464,7 +460,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -487,15 +483,11 @@ uint32_t pfcp_l4_stack::send_request(
     const endpoint& dest, const uint64_t seid,
     const pfcp_session_modification_request& pfcp_ies, const task_id_t& task_id,
     const uint64_t trxn_id) {
-  std::ostringstream oss(std::ostringstream::binary);
-  pfcp_msg msg(pfcp_ies);
+  pfcp_msg_header msg = {};
   msg.set_seid(seid);
   msg.set_sequence_number(get_next_seq_num());
-  msg.dump_to(oss);
-  // std::cout << string_to_hex(oss.str()) << std::endl;
-  // std::cout << std::hex << "msg length 0x" << msg.get_message_length() <<
-  // "msg seqnum 0x" << msg.get_sequence_number() << std::endl;
-  std::string bstream = oss.str();
+  std::string bstream = {};
+  pfcp::encode(msg, pfcp_ies, bstream);
 
   Logger::pfcp().trace(
       "Sending %s, seq %d seid " SEID_FMT " ", pfcp_ies.get_msg_name(),
@@ -503,7 +495,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -572,7 +564,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -611,7 +603,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -738,12 +730,11 @@ void pfcp_l4_stack::send_response(
   std::map<uint64_t, uint32_t>::iterator it;
   it = trxn_id2seq_num.find(trxn_id);
   if (it != trxn_id2seq_num.end()) {
-    std::ostringstream oss(std::ostringstream::binary);
-    pfcp_msg msg(pfcp_ies);
+    pfcp_msg_header msg = {};
     msg.set_seid(seid);
     msg.set_sequence_number(it->second);
-    msg.dump_to(oss);
-    std::string bstream = oss.str();
+    std::string bstream = {};
+    pfcp::encode(msg, pfcp_ies, bstream);
     Logger::pfcp().trace(
         "Sending %s, seq %d seid " SEID_FMT " ", pfcp_ies.get_msg_name(),
         msg.get_sequence_number(), seid);
@@ -773,12 +764,11 @@ void pfcp_l4_stack::send_response(
   std::map<uint64_t, uint32_t>::iterator it;
   it = trxn_id2seq_num.find(trxn_id);
   if (it != trxn_id2seq_num.end()) {
-    std::ostringstream oss(std::ostringstream::binary);
-    pfcp_msg msg(pfcp_ies);
+    pfcp_msg_header msg = {};
     msg.set_seid(seid);
     msg.set_sequence_number(it->second);
-    msg.dump_to(oss);
-    std::string bstream = oss.str();
+    std::string bstream = {};
+    pfcp::encode(msg, pfcp_ies, bstream);
     Logger::pfcp().trace(
         "Sending %s, seq %d seid " SEID_FMT " ", pfcp_ies.get_msg_name(),
         msg.get_sequence_number(), seid);
@@ -892,16 +882,12 @@ void pfcp_l4_stack::time_out_event(
       if (it_proc->second.retry_count < PFCP_N1_REQUESTS) {
         it_proc->second.retry_count++;
         start_msg_retry_timer(
-            it_proc->second, PFCP_T1_RESPONSE_MS, task_id,
-            it_proc->second.retry_msg->get_sequence_number());
+            it_proc->second, PFCP_T1_RESPONSE_MS, task_id, it_proc->first);
         // send again message
         Logger::pfcp().trace(
             "Retry %d Sending msg type %d, seq %d", it_proc->second.retry_count,
-            it_proc->second.retry_msg->get_message_type(),
-            it_proc->second.retry_msg->get_sequence_number());
-        std::ostringstream oss(std::ostringstream::binary);
-        it_proc->second.retry_msg->dump_to(oss);
-        std::string bstream = oss.str();
+            it_proc->second.initial_msg_type, it_proc->first);
+        const std::string& bstream = *it_proc->second.retry_bstream;
         udp_s_8805.async_send_to(
             reinterpret_cast<const char*>(bstream.c_str()), bstream.length(),
             it_proc->second.remote_endpoint);
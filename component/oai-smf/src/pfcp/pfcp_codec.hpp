@@ -0,0 +1,181 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_codec.hpp
+ \brief PFCP session establishment and modification messages encoded in a
+        contiguous buffer and decoded from it, without iostream nor pfcp_ie
+ \date 2021
+ */
+
+#ifndef FILE_PFCP_CODEC_HPP_SEEN
+#define FILE_PFCP_CODEC_HPP_SEEN
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sstream>
+#include <string>
+
+#include "3gpp_29.244.hpp"
+#include "msg_pfcp.hpp"
+
+// The encoder computes the length of the message (and of each grouped IE)
+// from the core types, then writes the header and the IEs in a buffer of the
+// caller: the bytes are the ones of pfcp_msg::dump_to, without a pfcp_ie
+// allocated per IE. The decoder reads the IEs in place and sets them in the
+// pfcp_ies_container like pfcp_msg::to_core_type.
+// Only the IEs of the session messages sent by the SMF and the UPF are
+// handled, a message with other IEs (e.g. Create QER, User ID) is not encoded
+// (encoded_length() returns 0) and a message with other IEs or a bad length
+// is not decoded (decode() returns false): pfcp_msg is used instead, with its
+// behaviour.
+namespace pfcp {
+
+// Read only view of contiguous bytes (std::span<const uint8_t> is C++20, the
+// components are built with -std=c++17)
+class byte_span {
+ public:
+  const uint8_t* data;
+  std::size_t size;
+
+  byte_span() : data(nullptr), size(0) {}
+  byte_span(const uint8_t* d, const std::size_t s) : data(d), size(s) {}
+
+  byte_span subspan(const std::size_t offset, const std::size_t count) const {
+    return byte_span(data + offset, count);
+  }
+};
+
+// An IE of a buffer, its value is not copied
+class ie_view {
+ public:
+  uint16_t type;
+  byte_span value;
+
+  ie_view() : type(0), value() {}
+};
+
+// The IEs of a buffer, in order
+class ie_cursor {
+ public:
+  explicit ie_cursor(const byte_span& b) : ies(b), offset(0), bad(false) {}
+
+  /*
+   * Get the next IE
+   * @param [ie_view&] ie: IE
+   * @return false at the end of the buffer, or if the IE is truncated, has a
+   * length of 0 or an enterprise type (then error() is true)
+   */
+  bool next(ie_view& ie);
+
+  bool error() const { return bad; }
+
+ private:
+  byte_span ies;
+  std::size_t offset;
+  bool bad;
+};
+
+/*
+ * Length of an encoded message, with a header with a SEID
+ * @param [const pfcp_session_establishment_request&] s: message
+ * @return length in bytes, 0 if the codec does not handle the message
+ */
+std::size_t encoded_length(const pfcp_session_establishment_request& s);
+std::size_t encoded_length(const pfcp_session_establishment_response& s);
+std::size_t encoded_length(const pfcp_session_modification_request& s);
+std::size_t encoded_length(const pfcp_session_modification_response& s);
+
+/*
+ * Encode a message in a buffer
+ * @param [pfcp_msg_header&] h: header, the SEID and the sequence number are
+ * set by the caller, the message type and length by encode()
+ * @param [const pfcp_session_establishment_request&] s: message
+ * @param [uint8_t*] buf: buffer
+ * @param [const std::size_t] size: size of the buffer
+ * @return length of the message, 0 if the codec does not handle the message
+ * or the buffer is too small
+ */
+std::size_t encode(
+    pfcp_msg_header& h, const pfcp_session_establishment_request& s,
+    uint8_t* buf, const std::size_t size);
+std::size_t encode(
+    pfcp_msg_header& h, const pfcp_session_establishment_response& s,
+    uint8_t* buf, const std::size_t size);
+std::size_t encode(
+    pfcp_msg_header& h, const pfcp_session_modification_request& s,
+    uint8_t* buf, const std::size_t size);
+std::size_t encode(
+    pfcp_msg_header& h, const pfcp_session_modification_response& s,
+    uint8_t* buf, const std::size_t size);
+
+/*
+ * Encode a message in a string, by pfcp_msg::dump_to if the codec does not
+ * handle it
+ * @param [pfcp_msg_header&] h: header, the SEID and the sequence number are
+ * set by the caller, the message type and length by encode()
+ * @param [const T&] s: session establishment or modification message
+ * @param [std::string&] bstream: encoded message
+ * @return void
+ */
+template<class T>
+void encode(pfcp_msg_header& h, const T& s, std::string& bstream) {
+  std::size_t length = encoded_length(s);
+  if (length) {
+    bstream.resize(length);
+    length = encode(h, s, reinterpret_cast<uint8_t*>(&bstream[0]), length);
+    if (length) {
+      bstream.resize(length);
+      return;
+    }
+  }
+  std::ostringstream oss(std::ostringstream::binary);
+  pfcp_msg msg(s);
+  if (h.has_seid()) msg.set_seid(h.get_seid());
+  msg.set_sequence_number(h.get_sequence_number());
+  msg.dump_to(oss);
+  h.set_message_type(msg.get_message_type());
+  h.set_message_length(msg.get_message_length());
+  bstream = oss.str();
+}
+
+/*
+ * Decode the header of a message
+ * @param [const byte_span&] b: message
+ * @param [pfcp_msg_header&] h: header, default constructed
+ * @return false if the header is truncated
+ */
+bool decode(const byte_span& b, pfcp_msg_header& h);
+
+/*
+ * Decode the IEs of a session establishment or modification message
+ * @param [const byte_span&] b: message
+ * @param [const pfcp_msg_header&] h: header of the message, from decode()
+ * @param [pfcp_ies_container&] s: message, set() of each IE, throws
+ * pfcp_msg_illegal_ie_exception like pfcp_msg::to_core_type
+ * @return false if the codec does not handle an IE or a length is bad
+ */
+bool decode(
+    const byte_span& b, const pfcp_msg_header& h, pfcp_ies_container& s);
+
+}  // namespace pfcp
+
+#endif /* FILE_PFCP_CODEC_HPP_SEEN */
@@ -84,6 +84,51 @@ extern itti_mw* itti_inst;
 
 void smf_app_task(void*);
 
+//------------------------------------------------------------------------------
+// Store the response handler of a SM context request, with its timeout timer
+// (the type of the response and the promise ID are given to the timer)
+template<class handler_t>
+static void store_response_handler(
+    std::mutex& m,
+    std::unordered_map<uint32_t, sm_context_response_handler<handler_t>>&
+        handlers,
+    const uint32_t id, handler_t&& handler, const uint32_t timeout_ms,
+    const uint8_t msg_type) {
+  sm_context_response_handler<handler_t> h = {};
+  h.handler                                = std::move(handler);
+  h.timer_id                               = ITTI_INVALID_TIMER_ID;
+  std::unique_lock lock(m);
+  if (timeout_ms > 0) {
+    h.timer_id = itti_inst->timer_setup(
+        timeout_ms / 1000, (timeout_ms % 1000) * 1000, TASK_SMF_APP,
+        TASK_SMF_APP_TIMEOUT_SM_CONTEXT_RESPONSE,
+        ((uint64_t) msg_type << 32) | id);
+  }
+  handlers[id] = std::move(h);
+}
+
+//------------------------------------------------------------------------------
+// Take the response handler of a SM context request out of the map (at most
+// once: result or timeout), the handler is called without the lock
+template<class handler_t>
+static bool take_response_handler(
+    std::mutex& m,
+    std::unordered_map<uint32_t, sm_context_response_handler<handler_t>>&
+        handlers,
+    const uint32_t id, handler_t& handler) {
+  timer_id_t timer_id = ITTI_INVALID_TIMER_ID;
+  {
+    std::unique_lock lock(m);
+    auto it = handlers.find(id);
+    if (it == handlers.end()) return false;
+    handler  = std::move(it->second.handler);
+    timer_id = it->second.timer_id;
+    handlers.erase(it);
+  }
+  if (timer_id != ITTI_INVALID_TIMER_ID) itti_inst->timer_remove(timer_id);
+  return true;
+}
+
 //------------------------------------------------------------------------------
 int smf_app::apply_config(const smf_config& cfg) {
   Logger::smf_app().info("Apply config...");
@@ -130,14 +175,8 @@ int smf_app::apply_config(const smf_config& cfg) {
 
 //------------------------------------------------------------------------------
 uint64_t smf_app::generate_seid() {
-  std::unique_lock<std::mutex> ls(m_seid_n4_generator);
-  uint64_t seid = ++seid_n4_generator;
-  while ((is_seid_n4_exist(seid)) || (seid == UNASSIGNED_SEID)) {
-    seid = ++seid_n4_generator;
-  }
-  set_seid_n4.insert(seid);
-  ls.unlock();
-  return seid;
+  // never UNASSIGNED_SEID
+  return seid_n4_generator.get_uid();
 }
 
 //------------------------------------------------------------------------------
@@ -155,16 +194,9 @@ evsub_id_t smf_app::generate_ev_subscription_id() {
   return evsub_id_generator.get_uid();
 }
 
-//------------------------------------------------------------------------------
-bool smf_app::is_seid_n4_exist(const uint64_t& seid) const {
-  return bool{set_seid_n4.count(seid) > 0};
-}
-
 //------------------------------------------------------------------------------
 void smf_app::free_seid_n4(const uint64_t& seid) {
-  std::unique_lock<std::mutex> ls(m_seid_n4_generator);
-  set_seid_n4.erase(seid);
-  ls.unlock();
+  seid_n4_generator.free_uid(seid);
 }
 
 //------------------------------------------------------------------------------
@@ -289,6 +321,13 @@ void smf_app_task(void*) {
         }
         break;
 
+      case N11_GET_SM_DATA_RESPONSE:
+        if (itti_n11_get_sm_data_response* m =
+                dynamic_cast<itti_n11_get_sm_data_response*>(msg)) {
+          smf_app_inst->handle_itti_msg(std::ref(*m));
+        }
+        break;
+
       case TIME_OUT:
         if (itti_msg_timeout* to = dynamic_cast<itti_msg_timeout*>(msg)) {
           Logger::smf_app().info("TIME-OUT event timer id %d", to->timer_id);
@@ -305,6 +344,10 @@ void smf_app_task(void*) {
               smf_app_inst->timer_nrf_deregistration(
                   to->timer_id, to->arg2_user);
               break;
+            case TASK_SMF_APP_TIMEOUT_SM_CONTEXT_RESPONSE:
+              smf_app_inst->timer_sm_context_response_timeout(
+                  to->timer_id, to->arg2_user);
+              break;
             default:;
           }
         }
@@ -329,17 +372,17 @@ void smf_app_task(void*) {
 
 //------------------------------------------------------------------------------
 smf_app::smf_app(const std::string& config_file)
-    : m_seid2smf_context(),
+    : seid_n4_generator(UINT_GENERATOR_SHARDS),
+      m_seid2smf_context(),
       m_supi2smf_context(),
+      sm_context_ref_generator(UINT_GENERATOR_SHARDS),
       m_scid2smf_context(),
       m_sm_context_create_promises(),
       m_sm_context_update_promises(),
       m_sm_context_release_promises() {
   Logger::smf_app().startup("Starting...");
 
-  supi2smf_context  = {};
-  set_seid_n4       = {};
-  seid_n4_generator = 0;
+  supi2smf_context = {};
 
   apply_config(smf_cfg);
 
@@ -703,40 +746,22 @@ void smf_app::handle_itti_msg(
 //------------------------------------------------------------------------------
 void smf_app::handle_itti_msg(itti_n11_create_sm_context_response& m) {
   Logger::smf_app().debug(
-      "PDU Session Create SM Context: Set promise with ID %d to ready", m.pid);
-  pdu_session_create_sm_context_response sm_context_response = {};
-  std::unique_lock lock(m_sm_context_create_promises);
-  if (sm_context_create_promises.count(m.pid) > 0) {
-    sm_context_create_promises[m.pid]->set_value(m.res);
-    // Remove this promise from list
-    sm_context_create_promises.erase(m.pid);
-  }
+      "PDU Session Create SM Context: send response, promise ID %d", m.pid);
+  trigger_session_create_sm_context_response(m.res, m.pid);
 }
 
 //------------------------------------------------------------------------------
 void smf_app::handle_itti_msg(itti_n11_update_sm_context_response& m) {
   Logger::smf_app().debug(
-      "PDU Session Update SM Context: Set promise with ID %d to ready", m.pid);
-  pdu_session_update_sm_context_response sm_context_response = {};
-  std::unique_lock lock(m_sm_context_update_promises);
-  if (sm_context_update_promises.count(m.pid) > 0) {
-    sm_context_update_promises[m.pid]->set_value(m.res);
-    // Remove this promise from list
-    sm_context_update_promises.erase(m.pid);
-  }
+      "PDU Session Update SM Context: send response, promise ID %d", m.pid);
+  trigger_session_update_sm_context_response(m.res, m.pid);
 }
 
 //------------------------------------------------------------------------------
 void smf_app::handle_itti_msg(itti_n11_release_sm_context_response& m) {
   Logger::smf_app().debug(
-      "PDU Session Release SM Context: Set promise with ID %d to ready", m.pid);
-  pdu_session_release_sm_context_response sm_context_response = {};
-  std::unique_lock lock(m_sm_context_release_promises);
-  if (sm_context_release_promises.count(m.pid) > 0) {
-    sm_context_release_promises[m.pid]->set_value(m.res);
-    // Remove this promise from list
-    sm_context_release_promises.erase(m.pid);
-  }
+      "PDU Session Release SM Context: send response, promise ID %d", m.pid);
+  trigger_session_release_sm_context_response(m.res, m.pid);
 }
 
 //------------------------------------------------------------------------------
@@ -1024,35 +1049,10 @@ void smf_app::handle_pdu_session_create_sm_context_request(
           "Retrieve Session Management Subscription data from the UDM");
       plmn_t plmn = {};
       sc.get()->get_plmn(plmn);
-      if (smf_sbi_inst->get_sm_data(supi64, dnn, snssai, subscription, plmn)) {
-        // Update dnn_context with subscription info
-        sc.get()->insert_dnn_subscription(snssai, dnn, subscription);
-      } else {
-        // Cannot retrieve information from UDM, reject PDU session
-        // establishment
-        Logger::smf_app().warn(
-            "Received a PDU Session Create SM Context Request, couldn't "
-            "retrieve the Session Management Subscription from UDM, ignore the "
-            "message!");
-        // PDU Session Establishment Reject
-        if (smf_n1::get_instance().create_n1_pdu_session_establishment_reject(
-                smreq->req, n1_sm_message,
-                cause_value_5gsm_e::
-                    CAUSE_29_USER_AUTHENTICATION_OR_AUTHORIZATION_FAILED)) {
-          conv::convert_string_2_hex(n1_sm_message, n1_sm_message_hex);
-          // Trigger reply to AMF
-          trigger_create_context_error_response(
-              http_status_code_e::HTTP_STATUS_CODE_403_FORBIDDEN,
-              PDU_SESSION_APPLICATION_ERROR_SUBSCRIPTION_DENIED,
-              n1_sm_message_hex, smreq->pid);
-
-        } else {
-          trigger_http_response(
-              http_status_code_e::HTTP_STATUS_CODE_500_INTERNAL_SERVER_ERROR,
-              smreq->pid, N11_SESSION_CREATE_SM_CONTEXT_RESPONSE);
-        }
-        return;
-      }
+      // Continued with the response, in handle_itti_msg
+      // (itti_n11_get_sm_data_response)
+      smf_sbi_inst->get_sm_data(supi64, dnn, snssai, plmn, smreq);
+      return;
     } else {
       // Use local configuration
       Logger::smf_app().debug(
@@ -1066,13 +1066,65 @@ void smf_app::handle_pdu_session_create_sm_context_request(
     }
   }
 
+  create_sm_context(sc, smreq);
+}
+
+//------------------------------------------------------------------------------
+void smf_app::handle_itti_msg(itti_n11_get_sm_data_response& r) {
+  std::shared_ptr<itti_n11_create_sm_context_request> smreq = r.smreq;
+  supi64_t supi64 = smf_supi_to_u64(smreq->req.get_supi());
+  std::string dnn = smreq->req.get_dnn();
+  snssai_t snssai = smreq->req.get_snssai();
+
+  std::shared_ptr<session_management_subscription> subscription =
+      std::shared_ptr<session_management_subscription>(
+          new session_management_subscription(snssai));
+  std::shared_ptr<smf_context> sc = {};
+  if (is_supi_2_smf_context(supi64) and
+      smf_sbi_inst->handle_sm_data(
+          r.http_response_code, r.body, dnn, snssai, subscription)) {
+    sc = supi_2_smf_context(supi64);
+    // Update dnn_context with subscription info
+    sc.get()->insert_dnn_subscription(snssai, dnn, subscription);
+    create_sm_context(sc, smreq);
+    return;
+  }
+
+  // Cannot retrieve information from UDM, reject PDU session establishment
+  Logger::smf_app().warn(
+      "Received a PDU Session Create SM Context Request, couldn't "
+      "retrieve the Session Management Subscription from UDM, ignore the "
+      "message!");
+  std::string n1_sm_message, n1_sm_message_hex;
+  // PDU Session Establishment Reject
+  if (smf_n1::get_instance().create_n1_pdu_session_establishment_reject(
+          smreq->req, n1_sm_message,
+          cause_value_5gsm_e::
+              CAUSE_29_USER_AUTHENTICATION_OR_AUTHORIZATION_FAILED)) {
+    conv::convert_string_2_hex(n1_sm_message, n1_sm_message_hex);
+    // Trigger reply to AMF
+    trigger_create_context_error_response(
+        http_status_code_e::HTTP_STATUS_CODE_403_FORBIDDEN,
+        PDU_SESSION_APPLICATION_ERROR_SUBSCRIPTION_DENIED, n1_sm_message_hex,
+        smreq->pid);
+  } else {
+    trigger_http_response(
+        http_status_code_e::HTTP_STATUS_CODE_500_INTERNAL_SERVER_ERROR,
+        smreq->pid, N11_SESSION_CREATE_SM_CONTEXT_RESPONSE);
+  }
+}
+
+//------------------------------------------------------------------------------
+void smf_app::create_sm_context(
+    std::shared_ptr<smf_context>& sc,
+    std::shared_ptr<itti_n11_create_sm_context_request> smreq) {
   // Step 8. Generate a SMF context Id and store the corresponding information
   // in a map (SM_Context_ID, (supi, pdu_session_id))
   scid_t scid = generate_smf_context_ref();
   std::shared_ptr<smf_context_ref> scf =
       std::shared_ptr<smf_context_ref>(new smf_context_ref());
-  scf.get()->supi           = supi;
-  scf.get()->pdu_session_id = pdu_session_id;
+  scf.get()->supi           = smreq->req.get_supi();
+  scf.get()->pdu_session_id = smreq->req.get_pdu_session_id();
   set_scid_2_smf_context(scid, scf);
   smreq->set_scid(scid);
 
@@ -1855,6 +1907,18 @@ void smf_app::timer_nrf_deregistration(
   trigger_nf_deregistration();
 }
 
+//---------------------------------------------------------------------------------------------
+void smf_app::timer_sm_context_response_timeout(
+    timer_id_t timer_id, uint64_t arg2_user) {
+  uint32_t pid     = arg2_user & 0xffffffff;
+  uint8_t msg_type = arg2_user >> 32;
+  Logger::smf_app().warn(
+      "No result for the SM context request with promise ID %d", pid);
+  trigger_http_response(
+      http_status_code_e::HTTP_STATUS_CODE_408_REQUEST_TIMEOUT, pid,
+      msg_type);
+}
+
 //---------------------------------------------------------------------------------------------
 n2_sm_info_type_e smf_app::n2_sm_info_type_str2e(
     const std::string& n2_info_type) const {
@@ -2012,30 +2076,30 @@ bool smf_app::get_session_management_subscription_data(
 }
 
 //---------------------------------------------------------------------------------------------
-void smf_app::add_promise(
-    uint32_t id,
-    boost::shared_ptr<boost::promise<pdu_session_create_sm_context_response>>&
-        p) {
-  std::unique_lock lock(m_sm_context_create_promises);
-  sm_context_create_promises.emplace(id, p);
+void smf_app::add_response_handler(
+    uint32_t id, sm_context_create_response_handler_t&& handler,
+    uint32_t timeout_ms) {
+  store_response_handler(
+      m_sm_context_create_promises, sm_context_create_promises, id,
+      std::move(handler), timeout_ms, N11_SESSION_CREATE_SM_CONTEXT_RESPONSE);
 }
 
 //---------------------------------------------------------------------------------------------
-void smf_app::add_promise(
-    uint32_t id,
-    boost::shared_ptr<boost::promise<pdu_session_update_sm_context_response>>&
-        p) {
-  std::unique_lock lock(m_sm_context_update_promises);
-  sm_context_update_promises.emplace(id, p);
+void smf_app::add_response_handler(
+    uint32_t id, sm_context_update_response_handler_t&& handler,
+    uint32_t timeout_ms) {
+  store_response_handler(
+      m_sm_context_update_promises, sm_context_update_promises, id,
+      std::move(handler), timeout_ms, N11_SESSION_UPDATE_SM_CONTEXT_RESPONSE);
 }
 
 //---------------------------------------------------------------------------------------------
-void smf_app::add_promise(
-    uint32_t id,
-    boost::shared_ptr<boost::promise<pdu_session_release_sm_context_response>>&
-        p) {
-  std::unique_lock lock(m_sm_context_release_promises);
-  sm_context_release_promises.emplace(id, p);
+void smf_app::add_response_handler(
+    uint32_t id, sm_context_release_response_handler_t&& handler,
+    uint32_t timeout_ms) {
+  store_response_handler(
+      m_sm_context_release_promises, sm_context_release_promises, id,
+      std::move(handler), timeout_ms, N11_SESSION_RELEASE_SM_CONTEXT_RESPONSE);
 }
 
 //---------------------------------------------------------------------------------------------
@@ -2144,15 +2208,12 @@ void smf_app::trigger_session_create_sm_context_response(
     pdu_session_create_sm_context_response& sm_context_response,
     uint32_t& pid) {
   Logger::smf_app().debug(
-      "Trigger PDU Session Create SM Context Response: Set promise with ID "
-      "%d "
-      "to ready",
-      pid);
-  std::unique_lock lock(m_sm_context_create_promises);
-  if (sm_context_create_promises.count(pid) > 0) {
-    sm_context_create_promises[pid]->set_value(sm_context_response);
-    // Remove this promise from list
-    sm_context_create_promises.erase(pid);
+      "Trigger PDU Session Create SM Context Response: promise ID %d", pid);
+  sm_context_create_response_handler_t handler = {};
+  if (take_response_handler(
+          m_sm_context_create_promises, sm_context_create_promises, pid,
+          handler)) {
+    handler(sm_context_response);
   }
 }
 
@@ -2161,15 +2222,12 @@ void smf_app::trigger_session_update_sm_context_response(
     pdu_session_update_sm_context_response& sm_context_response,
     uint32_t& pid) {
   Logger::smf_app().debug(
-      "Trigger PDU Session Update SM Context Response: Set promise with ID "
-      "%d "
-      "to ready",
-      pid);
-  std::unique_lock lock(m_sm_context_update_promises);
-  if (sm_context_update_promises.count(pid) > 0) {
-    sm_context_update_promises[pid]->set_value(sm_context_response);
-    // Remove this promise from list
-    sm_context_update_promises.erase(pid);
+      "Trigger PDU Session Update SM Context Response: promise ID %d", pid);
+  sm_context_update_response_handler_t handler = {};
+  if (take_response_handler(
+          m_sm_context_update_promises, sm_context_update_promises, pid,
+          handler)) {
+    handler(sm_context_response);
   }
 }
 
@@ -2178,15 +2236,12 @@ void smf_app::trigger_session_release_sm_context_response(
     pdu_session_release_sm_context_response& sm_context_response,
     uint32_t& pid) {
   Logger::smf_app().debug(
-      "Trigger PDU Session Release SM Context Response: Set promise with ID "
-      "%d "
-      "to ready",
-      pid);
-  std::unique_lock lock(m_sm_context_release_promises);
-  if (sm_context_release_promises.count(pid) > 0) {
-    sm_context_release_promises[pid]->set_value(sm_context_response);
-    // Remove this promise from list
-    sm_context_release_promises.erase(pid);
+      "Trigger PDU Session Release SM Context Response: promise ID %d", pid);
+  sm_context_release_response_handler_t handler = {};
+  if (take_response_handler(
+          m_sm_context_release_promises, sm_context_release_promises, pid,
+          handler)) {
+    handler(sm_context_response);
   }
 }
 
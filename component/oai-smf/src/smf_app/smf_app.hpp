@@ -32,12 +32,15 @@
 
 #include <boost/thread.hpp>
 #include <boost/thread/future.hpp>
+#include <functional>
 #include <future>
 #include <map>
+#include <mutex>
 #include <set>
 #include <shared_mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 
 #include "3gpp_29.502.h"
 #include "itti_msg_n11.hpp"
@@ -59,6 +62,7 @@ namespace smf {
 #define TASK_SMF_APP_TIMEOUT_T3592 (3)
 #define TASK_SMF_APP_TIMEOUT_NRF_HEARTBEAT (4)
 #define TASK_SMF_APP_TIMEOUT_NRF_DEREGISTRATION (5)
+#define TASK_SMF_APP_TIMEOUT_SM_CONTEXT_RESPONSE (6)
 
 // Table 10.3.2 @3GPP TS 24.501 V16.1.0 (2019-06)
 #define T3591_TIMER_VALUE_SEC 16
@@ -74,6 +78,22 @@ typedef enum {
 
 class smf_config;
 
+// Send the response of a SM context request to the HTTP server, called by the
+// thread completing the procedure (the HTTP threads do not wait for it)
+typedef std::function<void(pdu_session_create_sm_context_response&)>
+    sm_context_create_response_handler_t;
+typedef std::function<void(pdu_session_update_sm_context_response&)>
+    sm_context_update_response_handler_t;
+typedef std::function<void(pdu_session_release_sm_context_response&)>
+    sm_context_release_response_handler_t;
+
+template<class handler_t>
+class sm_context_response_handler {
+ public:
+  handler_t handler;
+  timer_id_t timer_id;  // ITTI_INVALID_TIMER_ID if no timeout
+};
+
 class smf_context_ref {
  public:
   smf_context_ref() { clear(); }
@@ -93,9 +113,7 @@ class smf_app {
   std::thread thread;
 
   // seid generator
-  uint64_t seid_n4_generator;
-  std::mutex m_seid_n4_generator;
-  std::set<uint64_t> set_seid_n4;
+  util::uint_generator<uint64_t> seid_n4_generator;
 
   std::map<seid_t, std::shared_ptr<smf_context>> seid2smf_context;
   mutable std::shared_mutex m_seid2smf_context;
@@ -113,22 +131,23 @@ class smf_app {
 
   mutable std::shared_mutex m_scid2smf_context;
   mutable std::shared_mutex m_smf_event_subscriptions;
-  // Store promise IDs for Create/Update session
-  mutable std::shared_mutex m_sm_context_create_promises;
-  mutable std::shared_mutex m_sm_context_update_promises;
-  mutable std::shared_mutex m_sm_context_release_promises;
+  // Response handlers of the Create/Update/Release SM context requests,
+  // indexed by promise ID
+  mutable std::mutex m_sm_context_create_promises;
+  mutable std::mutex m_sm_context_update_promises;
+  mutable std::mutex m_sm_context_release_promises;
 
-  std::map<
+  std::unordered_map<
       uint32_t,
-      boost::shared_ptr<boost::promise<pdu_session_create_sm_context_response>>>
+      sm_context_response_handler<sm_context_create_response_handler_t>>
       sm_context_create_promises;
-  std::map<
+  std::unordered_map<
       uint32_t,
-      boost::shared_ptr<boost::promise<pdu_session_update_sm_context_response>>>
+      sm_context_response_handler<sm_context_update_response_handler_t>>
       sm_context_update_promises;
-  std::map<
-      uint32_t, boost::shared_ptr<
-                    boost::promise<pdu_session_release_sm_context_response>>>
+  std::unordered_map<
+      uint32_t,
+      sm_context_response_handler<sm_context_release_response_handler_t>>
       sm_context_release_promises;
 
   smf_profile nf_instance_profile;  // SMF profile
@@ -392,6 +411,14 @@ class smf_app {
    */
   void handle_itti_msg(itti_n11_update_nf_instance_response& u);
 
+  /*
+   * Handle ITTI message from N11 (SM subscription data from UDM), continue
+   * the PDU Session Create SM Context Request waiting for it
+   * @param [itti_n11_get_sm_data_response&] r
+   * @return void
+   */
+  void handle_itti_msg(itti_n11_get_sm_data_response& r);
+
   /*
    * Restore a N4 Session
    * @param [const seid_t &] seid: Session ID to be restored
@@ -406,13 +433,6 @@ class smf_app {
    */
   uint64_t generate_seid();
 
-  /*
-   * Verify whether a session with a given ID exist
-   * @param [const uint64_t &] s: Seid ID
-   * @return bool: True if exist, otherwise false
-   */
-  bool is_seid_n4_exist(const uint64_t& s) const;
-
   /*
    * Free a Seid by its ID
    * @param [const uint64_t &] s: Seid ID
@@ -527,6 +547,18 @@ class smf_app {
   void handle_pdu_session_create_sm_context_request(
       std::shared_ptr<itti_n11_create_sm_context_request> smreq);
 
+  /*
+   * Create the SM context of an accepted PDUSession_CreateSMContextRequest
+   * and let the SMF context handle the request
+   * @param [std::shared_ptr<smf_context>&] sc: SMF context of the SUPI
+   * @param [std::shared_ptr<itti_n11_create_sm_context_request>] smreq:
+   * Request message
+   * @return void
+   */
+  void create_sm_context(
+      std::shared_ptr<smf_context>& sc,
+      std::shared_ptr<itti_n11_create_sm_context_request> smreq);
+
   /*
    * Handle PDUSession_UpdateSMContextRequest from AMF
    * @param [std::shared_ptr<itti_n11_update_sm_context_request>&] Request
@@ -679,6 +711,17 @@ class smf_app {
    */
   void timer_nrf_deregistration(timer_id_t timer_id, uint64_t arg2_user);
 
+  /*
+   * will be executed when the response of a SM context request is not ready
+   * in time, the request is answered with 408 Request Timeout
+   * @param [timer_id_t] timer_id
+   * @param [uint64_t] arg2_user: type of the response (bits 32 to 39) and
+   * promise id of the request
+   * @return void
+   */
+  void timer_sm_context_response_timeout(
+      timer_id_t timer_id, uint64_t arg2_user);
+
   /*
    * To start an association with a UPF (SMF-initiated association)
    * @param [const pfcp::node_id_t] node_id: UPF Node ID
@@ -702,50 +745,47 @@ class smf_app {
   void start_nf_registration_discovery();
 
   /*
-   * To store a promise of a PDU Session Create SM Contex Response to be
-   * triggered when the result is ready
+   * To store the handler sending the PDU Session Create SM Context Response,
+   * called once when the result is ready
    * @param [uint32_t] id: promise id
-   * @param [boost::shared_ptr<
-   * boost::promise<pdu_session_create_sm_context_response> >&] p: pointer to
-   * the promise
+   * @param [sm_context_create_response_handler_t&&] handler: response handler
+   * @param [uint32_t] timeout_ms: the handler gets 408 Request Timeout if the
+   * result is not ready after timeout_ms, 0 for no timeout
    * @return void
    */
-  void add_promise(
-      uint32_t id,
-      boost::shared_ptr<boost::promise<pdu_session_create_sm_context_response>>&
-          p);
+  void add_response_handler(
+      uint32_t id, sm_context_create_response_handler_t&& handler,
+      uint32_t timeout_ms = 0);
 
   /*
-   * To store a promise of a PDU Session Update SM Contex Response to be
-   * triggered when the result is ready
+   * To store the handler sending the PDU Session Update SM Context Response,
+   * called once when the result is ready
    * @param [uint32_t] id: promise id
-   * @param [boost::shared_ptr<
-   * boost::promise<pdu_session_update_sm_context_response> >&] p: pointer to
-   * the promise
+   * @param [sm_context_update_response_handler_t&&] handler: response handler
+   * @param [uint32_t] timeout_ms: the handler gets 408 Request Timeout if the
+   * result is not ready after timeout_ms, 0 for no timeout
    * @return void
    */
-  void add_promise(
-      uint32_t id,
-      boost::shared_ptr<boost::promise<pdu_session_update_sm_context_response>>&
-          p);
+  void add_response_handler(
+      uint32_t id, sm_context_update_response_handler_t&& handler,
+      uint32_t timeout_ms = 0);
 
   /*
-   * To store a promise of a PDU Session Release SM Context Response to be
-   * triggered when the result is ready
+   * To store the handler sending the PDU Session Release SM Context Response,
+   * called once when the result is ready
    * @param [uint32_t] id: promise id
-   * @param [boost::shared_ptr<
-   * boost::promise<pdu_session_release_sm_context_response> >&] p: pointer to
-   * the promise
+   * @param [sm_context_release_response_handler_t&&] handler: response handler
+   * @param [uint32_t] timeout_ms: the handler gets 408 Request Timeout if the
+   * result is not ready after timeout_ms, 0 for no timeout
    * @return void
    */
-  void add_promise(
-      uint32_t id,
-      boost::shared_ptr<
-          boost::promise<pdu_session_release_sm_context_response>>& p);
+  void add_response_handler(
+      uint32_t id, sm_context_release_response_handler_t&& handler,
+      uint32_t timeout_ms = 0);
 
   /*
-   * To trigger the response to the HTTP server by set the value of the
-   * corresponding promise to ready
+   * To trigger the response to the HTTP server by calling the
+   * corresponding response handler
    * @param [const uint32_t &] http_code: Status code of HTTP response
    * @param [const uint8_t&] cause: Error cause
    * @param [const std::string &] n1_sm_msg: N1 SM message
@@ -757,8 +797,8 @@ class smf_app {
       const std::string& n1_sm_msg, uint32_t& promise_id);
 
   /*
-   * To trigger the response to the HTTP server by set the value of the
-   * corresponding promise to ready
+   * To trigger the response to the HTTP server by calling the
+   * corresponding response handler
    * @param [const uint32_t &] http_code: Status code of HTTP response
    * @param [const uint8_t &] cause: Error cause
    * @param [uint32_t &] promise_id: Promise Id
@@ -768,8 +808,8 @@ class smf_app {
       const uint32_t& http_code, const uint8_t& cause, uint32_t& promise_id);
 
   /*
-   * To trigger the response to the HTTP server by set the value of the
-   * corresponding promise to ready
+   * To trigger the response to the HTTP server by calling the
+   * corresponding response handler
    * @param [const uint32_t &] http_code: Status code of HTTP response
    * @param [const uint8_t &] cause: cause
    * @param [const std::string &] n1_sm_msg: N1 SM message
@@ -781,8 +821,8 @@ class smf_app {
       const std::string& n1_sm_msg, uint32_t& promise_id);
 
   /*
-   * To trigger the response to the HTTP server by set the value of the
-   * corresponding promise to ready
+   * To trigger the response to the HTTP server by calling the
+   * corresponding response handler
    * @param [const uint32_t &] http_code: Status code of HTTP response
    * @param [uint32_t &] promise_id: Promise Id
    * @param [uint8_t] msg_type: Type of HTTP message (Create/Update/Release)
@@ -792,8 +832,8 @@ class smf_app {
       const uint32_t& http_code, uint32_t& promise_id, uint8_t msg_type);
 
   /*
-   * To trigger the session create sm context response by set the value of the
-   * corresponding promise to ready
+   * To trigger the session create sm context response by calling the
+   * corresponding response handler
    * @param [pdu_session_create_sm_context_response&] sm_context_response:
    * response message
    * @param [uint32_t &] promise_id: Promise Id
@@ -804,8 +844,8 @@ class smf_app {
       uint32_t& pid);
 
   /*
-   * To trigger the session update sm context response by set the value of the
-   * corresponding promise to ready
+   * To trigger the session update sm context response by calling the
+   * corresponding response handler
    * @param [pdu_session_update_sm_context_response&] sm_context_response:
    * response message
    * @param [uint32_t &] promise_id: Promise Id
@@ -816,8 +856,8 @@ class smf_app {
       uint32_t& pid);
 
   /*
-   * To trigger the session release sm context response by set the value of the
-   * corresponding promise to ready
+   * To trigger the session release sm context response by calling the
+   * corresponding response handler
    * @param [pdu_session_release_sm_context_response&] sm_context_response:
    * response message
    * @param [uint32_t &] promise_id: Promise Id
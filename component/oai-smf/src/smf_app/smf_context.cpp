@@ -336,8 +336,10 @@ void smf_pdu_session::deallocate_ressources(const std::string& dnn) {
     // release_far_id(it->second.far_id_ul.second);
     it->second.deallocate_ressources();
   }
-  if (ipv4) {
-    paa_dynamic::get_instance().release_paa(dnn, ipv4_address);
+  if (ipv4 or ipv6) {
+    paa_t paa = {};
+    get_paa(paa);
+    paa_dynamic::get_instance().release_paa(dnn, paa);
   }
   clear();  // including qos_flows.clear()
   Logger::smf_app().info(
@@ -1528,6 +1530,19 @@ void smf_context::handle_pdu_session_create_sm_context_request(
           paa_static_ip = true;
         }
       }
+      // the static address may be in a pool of the DNN
+      if (paa_static_ip and
+          !paa_dynamic::get_instance().reserve_paa(dnn, paa)) {
+        Logger::smf_app().warn(
+            "Static IP Address already allocated, use a dynamic one");
+        paa.ipv4_address.s_addr = INADDR_ANY;
+        paa.ipv6_address        = in6addr_any;
+        paa.pdu_session_type.pdu_session_type =
+            sdc.get()
+                ->pdu_session_types.default_session_type.pdu_session_type;
+        set_paa       = false;
+        paa_static_ip = false;
+      }
     }
   }
 
@@ -1716,6 +1731,9 @@ void smf_context::handle_pdu_session_create_sm_context_request(
           PDU_SESSION_APPLICATION_ERROR_PEER_NOT_RESPONDING);
     }
   } else {  // if request is rejected
+    // The static address reserved or the dynamic one allocated above, not
+    // set in the response (released in step 10 otherwise)
+    if (set_paa) paa_dynamic::get_instance().release_paa(dnn, paa);
     // TODO:
     // un-subscribe to the modifications of Session Management Subscription data
     // for (SUPI, DNN, S-NSSAI)
@@ -605,10 +605,19 @@ void smf_n4::handle_receive_association_release_response(
 //------------------------------------------------------------------------------
 void smf_n4::handle_receive_session_establishment_response(
     pfcp::pfcp_msg& msg, const endpoint& remote_endpoint) {
-  bool error                                            = true;
-  uint64_t trxn_id                                      = 0;
   pfcp_session_establishment_response msg_ies_container = {};
   msg.to_core_type(msg_ies_container);
+  handle_receive_session_establishment_response(
+      msg, msg_ies_container, remote_endpoint);
+}
+
+//------------------------------------------------------------------------------
+void smf_n4::handle_receive_session_establishment_response(
+    pfcp::pfcp_msg& msg,
+    const pfcp_session_establishment_response& msg_ies_container,
+    const endpoint& remote_endpoint) {
+  bool error       = true;
+  uint64_t trxn_id = 0;
 
   handle_receive_message_cb(msg, remote_endpoint, TASK_SMF_N4, error, trxn_id);
   if (!error) {
@@ -633,10 +642,19 @@ void smf_n4::handle_receive_session_establishment_response(
 //------------------------------------------------------------------------------
 void smf_n4::handle_receive_session_modification_response(
     pfcp::pfcp_msg& msg, const endpoint& remote_endpoint) {
-  bool error                                           = true;
-  uint64_t trxn_id                                     = 0;
   pfcp_session_modification_response msg_ies_container = {};
   msg.to_core_type(msg_ies_container);
+  handle_receive_session_modification_response(
+      msg, msg_ies_container, remote_endpoint);
+}
+
+//------------------------------------------------------------------------------
+void smf_n4::handle_receive_session_modification_response(
+    pfcp::pfcp_msg& msg,
+    const pfcp_session_modification_response& msg_ies_container,
+    const endpoint& remote_endpoint) {
+  bool error       = true;
+  uint64_t trxn_id = 0;
 
   handle_receive_message_cb(msg, remote_endpoint, TASK_SMF_N4, error, trxn_id);
   if (!error) {
@@ -787,6 +805,12 @@ void smf_n4::handle_receive(
   pfcp_msg msg    = {};
   msg.remote_port = remote_endpoint.port();
   try {
+    if (handle_receive_session_response(
+            pfcp::byte_span(
+                reinterpret_cast<const uint8_t*>(recv_buffer),
+                bytes_transferred),
+            remote_endpoint))
+      return;
     msg.load_from(iss);
     handle_receive_pfcp_msg(msg, remote_endpoint);
   } catch (pfcp_exception& e) {
@@ -794,6 +818,34 @@ void smf_n4::handle_receive(
   }
 }
 
+//------------------------------------------------------------------------------
+bool smf_n4::handle_receive_session_response(
+    const pfcp::byte_span& b, const endpoint& remote_endpoint) {
+  pfcp_msg_header hdr = {};
+  if (!pfcp::decode(b, hdr)) return false;
+  switch (hdr.get_message_type()) {
+    case PFCP_SESSION_ESTABLISHMENT_RESPONSE: {
+      pfcp_session_establishment_response msg_ies_container = {};
+      if (!pfcp::decode(b, hdr, msg_ies_container)) return false;
+      pfcp_msg msg(hdr);
+      msg.remote_port = remote_endpoint.port();
+      handle_receive_session_establishment_response(
+          msg, msg_ies_container, remote_endpoint);
+    } break;
+    case PFCP_SESSION_MODIFICATION_RESPONSE: {
+      pfcp_session_modification_response msg_ies_container = {};
+      if (!pfcp::decode(b, hdr, msg_ies_container)) return false;
+      pfcp_msg msg(hdr);
+      msg.remote_port = remote_endpoint.port();
+      handle_receive_session_modification_response(
+          msg, msg_ies_container, remote_endpoint);
+    } break;
+    default:
+      return false;
+  }
+  return true;
+}
+
 //------------------------------------------------------------------------------
 void smf_n4::time_out_itti_event(const uint32_t timer_id) {
   bool handled = false;
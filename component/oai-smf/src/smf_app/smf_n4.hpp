@@ -98,6 +98,10 @@ class smf_n4 : public pfcp::pfcp_l4_stack {
   void handle_receive(
       char* recv_buffer, const std::size_t bytes_transferred,
       const endpoint& r_endpoint);
+  // Session Establishment/Modification Response decoded by the PFCP codec,
+  // false if not handled by the codec (then decoded by pfcp_msg)
+  bool handle_receive_session_response(
+      const pfcp::byte_span& b, const endpoint& r_endpoint);
 
   void handle_receive_heartbeat_request(
       pfcp::pfcp_msg& msg, const endpoint& r_endpoint);
@@ -113,8 +117,16 @@ class smf_n4 : public pfcp::pfcp_l4_stack {
       pfcp::pfcp_msg& msg, const endpoint& remote_endpoint);
   void handle_receive_session_establishment_response(
       pfcp::pfcp_msg& msg, const endpoint& r_endpoint);
+  void handle_receive_session_establishment_response(
+      pfcp::pfcp_msg& msg,
+      const pfcp::pfcp_session_establishment_response& msg_ies_container,
+      const endpoint& r_endpoint);
   void handle_receive_session_modification_response(
       pfcp::pfcp_msg& msg, const endpoint& r_endpoint);
+  void handle_receive_session_modification_response(
+      pfcp::pfcp_msg& msg,
+      const pfcp::pfcp_session_modification_response& msg_ies_container,
+      const endpoint& r_endpoint);
   void handle_receive_session_deletion_response(
       pfcp::pfcp_msg& msg, const endpoint& r_endpoint);
   void handle_receive_session_report_request(
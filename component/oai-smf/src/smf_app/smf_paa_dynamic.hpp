@@ -29,139 +29,82 @@
 #ifndef FILE_SMF_PAA_DYNAMIC_HPP_SEEN
 #define FILE_SMF_PAA_DYNAMIC_HPP_SEEN
 
-#include <bitset>
 #include <map>
+#include <mutex>
 
 #include "logger.hpp"
+#include "smf_paa_pool.hpp"
 #include "string.hpp"
 #include <boost/algorithm/string.hpp>
 
-class ipv6_pool {
+class dnn_dynamic_pools {
  public:
-  struct in6_addr prefix;
-  int prefix_len;
+  std::vector<uint32_t> ipv4_pool_ids;
+  std::vector<uint32_t> ipv6_pool_ids;
 
-  ipv6_pool() : prefix(), prefix_len(0) {}
+  dnn_dynamic_pools() : ipv4_pool_ids(), ipv6_pool_ids() {}
 
-  ipv6_pool(const struct in6_addr prfix, const int prfix_len) {
-    prefix     = prfix;
-    prefix_len = prfix_len;
-  }
+  void add_ipv4_pool_id(const uint32_t id) { ipv4_pool_ids.push_back(id); }
+  void add_ipv6_pool_id(const uint32_t id) { ipv6_pool_ids.push_back(id); }
+};
 
-  ipv6_pool(const ipv6_pool& p) : prefix(p.prefix), prefix_len(p.prefix_len) {}
+class paa_dynamic {
+ private:
+  std::map<int32_t, ipv4_pool> ipv4_pools;
+  std::map<int32_t, ipv6_pool> ipv6_pools;
 
-  bool alloc_address(struct in6_addr& allocated) {
-    allocated = prefix;
-    return true;
-  }
+  std::map<std::string, dnn_dynamic_pools> dnns;
 
-  void free_address(const struct in_addr& allocated) {}
-};
+  // the IPv4 and IPv6 pools, the DNNs
+  mutable std::mutex m_pools;
 
-class ipv4_pool {
- protected:
-  struct in_addr start;
-  int num;
-  std::map<int, uint32_t> alloc;
+  paa_dynamic() : ipv4_pools(), ipv6_pools(), dnns(), m_pools(){};
 
-  bool alloc_free_bit(int& bit_pos) {
-    bit_pos = 0;
-    for (int i = 0; i < alloc.size(); ++i) {
-      if (alloc[i] != std::numeric_limits<uint32_t>::max()) {
-        std::bitset<32> bs(alloc[i]);
-        int word_bit_pos = 0;
-        while (bs[word_bit_pos]) {
-          bit_pos++;
-          word_bit_pos++;
-        }
-        bs.set(word_bit_pos);
-        alloc[i] = bs.to_ulong();
-        return true;
-      }
-      bit_pos += 32;
+  // m_pools held
+  bool alloc_ipv4(
+      const dnn_dynamic_pools& dnn_pool, struct in_addr& ipv4_address) {
+    for (auto id : dnn_pool.ipv4_pool_ids) {
+      if (ipv4_pools[id].alloc_address(ipv4_address)) return true;
     }
     return false;
   }
 
-  bool free_bit(const int bit_pos) {
-    if (bit_pos < num) {
-      int bit_pos32    = bit_pos >> 5;
-      int word_bit_pos = bit_pos & 0x0000001F;
-      std::bitset<32> bs(alloc[bit_pos32]);
-      bs.reset(word_bit_pos);
-      alloc[bit_pos32] = bs.to_ulong();
-      return true;
+  bool alloc_ipv6(
+      const dnn_dynamic_pools& dnn_pool, struct in6_addr& ipv6_address,
+      uint8_t& prefix_len) {
+    for (auto id : dnn_pool.ipv6_pool_ids) {
+      ipv6_pool& pool = ipv6_pools[id];
+      if (pool.alloc_address(ipv6_address)) {
+        prefix_len =
+            pool.delegates() ? SMF_IPV6_UE_PREFIX_LEN : pool.prefix_len;
+        return true;
+      }
     }
     return false;
   }
 
- public:
-  ipv4_pool() : num(0), alloc() { start.s_addr = 0; };
-
-  ipv4_pool(const struct in_addr first, const uint32_t range) : alloc() {
-    start.s_addr = first.s_addr;
-    num          = range;
-    int range32  = range >> 5;
-    int i        = 0;
-    for (i = 0; i < range32; ++i) {
-      alloc[i] = 0;
+  // An address out of the pools (static) has nothing to release
+  bool free_ipv4(
+      const dnn_dynamic_pools& dnn_pool, const struct in_addr& ipv4_address) {
+    for (auto id : dnn_pool.ipv4_pool_ids) {
+      if (ipv4_pools[id].in_pool(ipv4_address))
+        return ipv4_pools[id].free_address(ipv4_address);
     }
-    if (range & 0x0000001F) {
-      alloc[i] = std::numeric_limits<uint32_t>::max() << (range & 0x0000001F);
-    }
-  };
-
-  ipv4_pool(const ipv4_pool& p) : num(p.num), alloc(p.alloc) {
-    start.s_addr = p.start.s_addr;
-  };
-
-  bool alloc_address(struct in_addr& allocated) {
-    int bit_pos = 0;
-    if (alloc_free_bit(bit_pos)) {
-      allocated.s_addr = be32toh(start.s_addr) + bit_pos;  // overflow
-      allocated.s_addr = htobe32(allocated.s_addr);
-      return true;
-    }
-    allocated.s_addr = 0;
-    return false;
+    return true;
   }
 
-  bool free_address(const struct in_addr& allocated) {
-    if (in_pool(allocated)) {
-      int bit_pos = be32toh(allocated.s_addr) - be32toh(start.s_addr);
-      return free_bit(bit_pos);
+  bool free_ipv6(
+      const dnn_dynamic_pools& dnn_pool, const struct in6_addr& ipv6_address) {
+    for (auto id : dnn_pool.ipv6_pool_ids) {
+      ipv6_pool& pool = ipv6_pools[id];
+      // shared prefix, nothing to release
+      if (!pool.delegates() &&
+          IN6_ARE_ADDR_EQUAL(&pool.prefix, &ipv6_address))
+        return true;
+      if (pool.in_pool(ipv6_address)) return pool.free_address(ipv6_address);
     }
-    return false;
-  }
-
-  bool in_pool(const struct in_addr& a) const {
-    int addr_start = be32toh(start.s_addr);
-    int addr       = be32toh(a.s_addr);
-    return ((addr - addr_start) < num);
+    return true;
   }
-};
-
-class dnn_dynamic_pools {
- public:
-  std::vector<uint32_t> ipv4_pool_ids;
-  std::vector<uint32_t> ipv6_pool_ids;
-
-  dnn_dynamic_pools() : ipv4_pool_ids(), ipv6_pool_ids() {}
-
-  void add_ipv4_pool_id(const uint32_t id) { ipv4_pool_ids.push_back(id); }
-  void add_ipv6_pool_id(const uint32_t id) { ipv6_pool_ids.push_back(id); }
-};
-
-class paa_dynamic {
- private:
-  std::map<int32_t, ipv4_pool> ipv4_pools;
-  std::map<int32_t, ipv6_pool> ipv6_pools;
-
-  std::map<std::string, dnn_dynamic_pools> dnns;
-
-  mutable std::shared_mutex m_ipv4_pools;
-
-  paa_dynamic() : ipv4_pools(), ipv6_pools(), dnns(), m_ipv4_pools(){};
 
  public:
   static paa_dynamic& get_instance() {
@@ -177,18 +120,11 @@ class paa_dynamic {
       const struct in_addr& first, const int range) {
     if (pool_id >= 0) {
       uint32_t uint32pool_id = uint32_t(pool_id);
-      std::unique_lock lock(m_ipv4_pools);
+      std::unique_lock lock(m_pools);
       if (!ipv4_pools.count(uint32pool_id)) {
-        ipv4_pool pool(first, range);
-        ipv4_pools[uint32pool_id] = pool;
-      }
-
-      dnn_dynamic_pools adp = {};
-      if (dnns.count(dnn_label)) {
-        adp = dnns[dnn_label];
+        ipv4_pools[uint32pool_id] = ipv4_pool(first, range);
       }
-      adp.add_ipv4_pool_id(uint32pool_id);
-      dnns[dnn_label] = adp;
+      dnns[dnn_label].add_ipv4_pool_id(uint32pool_id);
     }
   }
 
@@ -197,58 +133,38 @@ class paa_dynamic {
       const struct in6_addr& prefix, const int prefix_len) {
     if (pool_id >= 0) {
       uint32_t uint32pool_id = uint32_t(pool_id);
+      std::unique_lock lock(m_pools);
       if (!ipv6_pools.count(uint32pool_id)) {
-        ipv6_pool pool(prefix, prefix_len);
-        ipv6_pools[uint32pool_id] = pool;
-      }
-
-      dnn_dynamic_pools adp = {};
-      if (dnns.count(dnn_label)) {
-        adp = dnns[dnn_label];
+        ipv6_pools[uint32pool_id] = ipv6_pool(prefix, prefix_len);
+        if (!ipv6_pools[uint32pool_id].delegates()) {
+          Logger::smf_app().warn(
+              "IPv6 prefix of DNN %s is /%d, shared by the UEs (a /%d is "
+              "delegated to each UE from a shorter prefix)",
+              dnn_label.c_str(), prefix_len, SMF_IPV6_UE_PREFIX_LEN);
+        }
       }
-      adp.add_ipv6_pool_id(uint32pool_id);
-      dnns[dnn_label] = adp;
+      dnns[dnn_label].add_ipv6_pool_id(uint32pool_id);
     }
   }
 
   bool get_free_paa(const std::string& dnn_label, paa_t& paa) {
-    if (dnns.count(dnn_label)) {
-      dnn_dynamic_pools& dnn_pool = dnns[dnn_label];
+    std::unique_lock lock(m_pools);
+    auto it = dnns.find(dnn_label);
+    if (it != dnns.end()) {
+      const dnn_dynamic_pools& dnn_pool = it->second;
       if (paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV4) {
-        std::unique_lock lock(m_ipv4_pools);
-        for (std::vector<uint32_t>::const_iterator it4 =
-                 dnn_pool.ipv4_pool_ids.begin();
-             it4 != dnn_pool.ipv4_pool_ids.end(); ++it4) {
-          if (ipv4_pools[*it4].alloc_address(paa.ipv4_address)) {
-            return true;
-          }
-        }
+        if (alloc_ipv4(dnn_pool, paa.ipv4_address)) return true;
         Logger::smf_app().warn(
             "Could not get PAA PDU_SESSION_TYPE_E_IPV4 for DNN %s",
             dnn_label.c_str());
         return false;
       } else if (
           paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV4V6) {
-        bool success                              = false;
-        std::vector<uint32_t>::const_iterator it4 = {};
-        uint32_t ipv4_pool_id                     = 0;
-        for (it4 = dnn_pool.ipv4_pool_ids.begin();
-             it4 != dnn_pool.ipv4_pool_ids.end(); ++it4) {
-          if (ipv4_pools[*it4].alloc_address(paa.ipv4_address)) {
-            success      = true;
-            ipv4_pool_id = *it4;
-            break;
-          }
-        }
-        if (success) {
-          for (std::vector<uint32_t>::const_iterator it6 =
-                   dnn_pool.ipv6_pool_ids.begin();
-               it6 != dnn_pool.ipv6_pool_ids.end(); ++it6) {
-            if (ipv6_pools[*it6].alloc_address(paa.ipv6_address)) {
-              return true;
-            }
-          }
-          ipv4_pools[ipv4_pool_id].free_address(paa.ipv4_address);
+        if (alloc_ipv4(dnn_pool, paa.ipv4_address)) {
+          if (alloc_ipv6(
+                  dnn_pool, paa.ipv6_address, paa.ipv6_prefix_length))
+            return true;
+          free_ipv4(dnn_pool, paa.ipv4_address);
         }
         Logger::smf_app().warn(
             "Could not get PAA PDU_SESSION_TYPE_E_IPV4V6 for DNN %s",
@@ -256,13 +172,8 @@ class paa_dynamic {
         return false;
       } else if (
           paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV6) {
-        for (std::vector<uint32_t>::const_iterator it6 =
-                 dnn_pool.ipv6_pool_ids.begin();
-             it6 != dnn_pool.ipv6_pool_ids.end(); ++it6) {
-          if (ipv6_pools[*it6].alloc_address(paa.ipv6_address)) {
-            return true;
-          }
-        }
+        if (alloc_ipv6(dnn_pool, paa.ipv6_address, paa.ipv6_prefix_length))
+          return true;
         Logger::smf_app().warn(
             "Could not get PAA PDU_SESSION_TYPE_E_IPV6 for DNN %s",
             dnn_label.c_str());
@@ -273,36 +184,65 @@ class paa_dynamic {
     return false;
   }
 
-  bool release_paa(const std::string& dnn_label, const paa_t& paa) {
-    if (dnns.count(dnn_label)) {
-      dnn_dynamic_pools& dnn_pool = dnns[dnn_label];
-      if (paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV4) {
-        std::unique_lock lock(m_ipv4_pools);
-        for (std::vector<uint32_t>::const_iterator it4 =
-                 dnn_pool.ipv4_pool_ids.begin();
-             it4 != dnn_pool.ipv4_pool_ids.end(); ++it4) {
-          if (ipv4_pools[*it4].free_address(paa.ipv4_address)) {
-            return true;
-          }
+  /*
+   * Reserve the static address(es) of a UE in the pools of a DNN
+   * @param [const std::string&] dnn_label: DNN
+   * @param [const paa_t&] paa: static address(es)
+   * @return false if an address is in a pool and already allocated, nothing
+   * is reserved then (an address out of the pools is not reserved)
+   */
+  bool reserve_paa(const std::string& dnn_label, const paa_t& paa) {
+    std::unique_lock lock(m_pools);
+    auto it = dnns.find(dnn_label);
+    if (it == dnns.end()) return true;
+    const dnn_dynamic_pools& dnn_pool = it->second;
+    bool v4 =
+        (paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV4) or
+        (paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV4V6);
+    bool v6 =
+        (paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV6) or
+        (paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV4V6);
+
+    ipv4_pool* pool4 = nullptr;
+    if (v4) {
+      for (auto id : dnn_pool.ipv4_pool_ids) {
+        if (ipv4_pools[id].in_pool(paa.ipv4_address)) {
+          pool4 = &ipv4_pools[id];
+          if (!pool4->reserve_address(paa.ipv4_address)) return false;
+          break;
         }
-        return false;
-      } else if (
-          paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV4V6) {
-        bool success                              = false;
-        std::vector<uint32_t>::const_iterator it4 = {};
-        for (it4 = dnn_pool.ipv4_pool_ids.begin();
-             it4 != dnn_pool.ipv4_pool_ids.end(); ++it4) {
-          if (ipv4_pools[*it4].free_address(paa.ipv4_address)) {
-            return true;
-          }
+      }
+    }
+    if (v6) {
+      for (auto id : dnn_pool.ipv6_pool_ids) {
+        if (ipv6_pools[id].in_pool(paa.ipv6_address)) {
+          if (ipv6_pools[id].reserve_address(paa.ipv6_address)) break;
+          if (pool4) pool4->free_address(paa.ipv4_address);
+          return false;
         }
-        return false;
-      } else if (
-          paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV6) {
-        Logger::smf_app().debug("IPv6 is not fully supported yet!");
-        return true;
       }
     }
+    return true;
+  }
+
+  // Succeeds for an address out of the pools of the DNN (static)
+  bool release_paa(const std::string& dnn_label, const paa_t& paa) {
+    std::unique_lock lock(m_pools);
+    auto it = dnns.find(dnn_label);
+    if (it == dnns.end()) return true;
+    const dnn_dynamic_pools& dnn_pool = it->second;
+    bool success                      = false;
+    if (paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV4) {
+      success = free_ipv4(dnn_pool, paa.ipv4_address);
+    } else if (
+        paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV4V6) {
+      success = free_ipv4(dnn_pool, paa.ipv4_address);
+      success = free_ipv6(dnn_pool, paa.ipv6_address) && success;
+    } else if (
+        paa.pdu_session_type.pdu_session_type == PDU_SESSION_TYPE_E_IPV6) {
+      success = free_ipv6(dnn_pool, paa.ipv6_address);
+    }
+    if (success) return true;
     Logger::smf_app().warn(
         "Could not release PAA for DNN %s", dnn_label.c_str());
     return false;
@@ -310,17 +250,9 @@ class paa_dynamic {
 
   bool release_paa(
       const std::string& dnn_label, const struct in_addr& ipv4_address) {
-    std::unique_lock lock(m_ipv4_pools);
-    if (dnns.count(dnn_label)) {
-      dnn_dynamic_pools& dnn_pool = dnns[dnn_label];
-      for (std::vector<uint32_t>::const_iterator it4 =
-               dnn_pool.ipv4_pool_ids.begin();
-           it4 != dnn_pool.ipv4_pool_ids.end(); ++it4) {
-        if (ipv4_pools[*it4].free_address(ipv4_address)) {
-          return true;
-        }
-      }
-    }
+    std::unique_lock lock(m_pools);
+    auto it = dnns.find(dnn_label);
+    if ((it == dnns.end()) || free_ipv4(it->second, ipv4_address)) return true;
     Logger::smf_app().warn(
         "Could not release PAA for DNN %s", dnn_label.c_str());
     return false;
@@ -0,0 +1,292 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file smf_paa_pool.hpp
+ \brief UE IPv4 address pools and IPv6 prefix pools, allocation in a bitmap
+ \date 2021
+ */
+
+#ifndef FILE_SMF_PAA_POOL_HPP_SEEN
+#define FILE_SMF_PAA_POOL_HPP_SEEN
+
+#include <endian.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+// Max number of /64 delegated from an IPv6 prefix (bitmap of 2 MB)
+#define SMF_IPV6_POOL_MAX_PREFIXES (1 << 24)
+// Length of the prefix delegated to a UE
+#define SMF_IPV6_UE_PREFIX_LEN 64
+
+// Allocation of the positions [0, size) of a pool: one bit per position
+// (1: allocated), summarized by levels of one bit per word of the level below
+// (1: the word has a free position) up to a single word. The lowest free
+// position is found with one ctz per level, i.e. 4 for a /8 IPv4 pool, the
+// allocations and the releases take O(log64(size)).
+class paa_bitmap {
+ public:
+  paa_bitmap() : num(0), nb_free(0), levels(1, std::vector<uint64_t>(1, 0)) {}
+
+  explicit paa_bitmap(const uint32_t size)
+      : num(size), nb_free(size), levels() {
+    std::size_t nb_words = (size + 63) >> 6;
+    levels.push_back(std::vector<uint64_t>(nb_words, 0));
+    // the positions after the end are allocated
+    if (num & 63) levels[0].back() = ~(uint64_t) 0 << (num & 63);
+    while (nb_words > 1) {
+      std::size_t nb_bits = nb_words;
+      nb_words            = (nb_bits + 63) >> 6;
+      levels.push_back(std::vector<uint64_t>(nb_words, 0));
+      const std::vector<uint64_t>& below = levels[levels.size() - 2];
+      bool positions                     = (levels.size() == 2);
+      for (std::size_t w = 0; w < nb_bits; w++) {
+        if (positions ? (below[w] != ~(uint64_t) 0) : (below[w] != 0))
+          levels.back()[w >> 6] |= (uint64_t) 1 << (w & 63);
+      }
+    }
+    if ((levels.size() == 1) || (num == 0)) {
+      // a single word, its summary
+      levels.push_back(std::vector<uint64_t>(
+          1, (size && (levels[0][0] != ~(uint64_t) 0)) ? 1 : 0));
+    }
+  }
+
+  /*
+   * Allocate the lowest free position
+   * @param [uint32_t&] pos: allocated position
+   * @return false if the pool is full
+   */
+  bool alloc(uint32_t& pos) {
+    if (levels.back()[0] == 0) return false;
+    uint32_t w = 0;
+    for (std::size_t l = levels.size() - 1; l > 0; l--)
+      w = (w << 6) + __builtin_ctzll(levels[l][w]);
+    pos = (w << 6) + __builtin_ctzll(~levels[0][w]);
+    set(pos);
+    return true;
+  }
+
+  /*
+   * Allocate a given position (static address)
+   * @param [const uint32_t] pos: position
+   * @return false if out of the pool or already allocated
+   */
+  bool reserve(const uint32_t pos) {
+    if ((pos >= num) || is_allocated(pos)) return false;
+    set(pos);
+    return true;
+  }
+
+  /*
+   * Release a position
+   * @param [const uint32_t] pos: position
+   * @return false if out of the pool or not allocated
+   */
+  bool free(const uint32_t pos) {
+    if ((pos >= num) || !is_allocated(pos)) return false;
+    uint32_t i = pos;
+    for (std::size_t l = 0; l < levels.size(); l++) {
+      uint64_t& word = levels[l][i >> 6];
+      bool was_full  = (l == 0) ? (word == ~(uint64_t) 0) : (word == 0);
+      if (l == 0)
+        word &= ~((uint64_t) 1 << (i & 63));
+      else
+        word |= (uint64_t) 1 << (i & 63);
+      if (!was_full) break;
+      i >>= 6;
+    }
+    nb_free++;
+    return true;
+  }
+
+  bool is_allocated(const uint32_t pos) const {
+    return (levels[0][pos >> 6] >> (pos & 63)) & 1;
+  }
+
+  uint32_t size() const { return num; }
+  uint32_t free_count() const { return nb_free; }
+
+ private:
+  // the free position pos is allocated
+  void set(const uint32_t pos) {
+    uint32_t i = pos;
+    for (std::size_t l = 0; l < levels.size(); l++) {
+      uint64_t& word = levels[l][i >> 6];
+      if (l == 0)
+        word |= (uint64_t) 1 << (i & 63);
+      else
+        word &= ~((uint64_t) 1 << (i & 63));
+      if ((l == 0) ? (word != ~(uint64_t) 0) : (word != 0)) break;
+      i >>= 6;
+    }
+    nb_free--;
+  }
+
+  uint32_t num;
+  uint32_t nb_free;
+  // levels[0]: 1 per allocated position, levels[l > 0]: 1 per word of
+  // levels[l - 1] with a free position, the last one is a single word
+  std::vector<std::vector<uint64_t>> levels;
+};
+
+// Addresses [start, start + range)
+class ipv4_pool {
+ protected:
+  struct in_addr start;
+  uint32_t num;
+  paa_bitmap alloc;
+
+ public:
+  ipv4_pool() : num(0), alloc() { start.s_addr = 0; };
+
+  ipv4_pool(const struct in_addr first, const uint32_t range)
+      : num(range), alloc(range) {
+    start.s_addr = first.s_addr;
+  };
+
+  bool alloc_address(struct in_addr& allocated) {
+    uint32_t pos = 0;
+    if (alloc.alloc(pos)) {
+      allocated.s_addr = htobe32(be32toh(start.s_addr) + pos);
+      return true;
+    }
+    allocated.s_addr = 0;
+    return false;
+  }
+
+  bool reserve_address(const struct in_addr& address) {
+    if (!in_pool(address)) return false;
+    return alloc.reserve(be32toh(address.s_addr) - be32toh(start.s_addr));
+  }
+
+  bool free_address(const struct in_addr& allocated) {
+    if (!in_pool(allocated)) return false;
+    return alloc.free(be32toh(allocated.s_addr) - be32toh(start.s_addr));
+  }
+
+  bool in_pool(const struct in_addr& a) const {
+    uint32_t addr_start = be32toh(start.s_addr);
+    uint32_t addr       = be32toh(a.s_addr);
+    return (addr >= addr_start) && ((addr - addr_start) < num);
+  }
+
+  uint32_t free_count() const { return alloc.free_count(); }
+};
+
+// A /64 per UE from a prefix shorter than 64 bits: the UE n gets the n-th
+// /64 of the prefix, at most SMF_IPV6_POOL_MAX_PREFIXES. A prefix of 64 bits
+// or more cannot be delegated, it is shared by the UEs (the previous
+// behaviour).
+class ipv6_pool {
+ public:
+  struct in6_addr prefix;
+  int prefix_len;
+
+  ipv6_pool() : prefix(), prefix_len(0), num(0), alloc() {}
+
+  ipv6_pool(const struct in6_addr prfix, const int prfix_len)
+      : prefix(prfix), prefix_len(prfix_len), num(0), alloc() {
+    if ((prefix_len >= 0) && (prefix_len < SMF_IPV6_UE_PREFIX_LEN)) {
+      int bits = SMF_IPV6_UE_PREFIX_LEN - prefix_len;
+      if ((bits >= 32) || ((1ULL << bits) >= SMF_IPV6_POOL_MAX_PREFIXES))
+        num = SMF_IPV6_POOL_MAX_PREFIXES;
+      else
+        num = 1U << bits;
+      alloc = paa_bitmap(num);
+      // bits after the prefix are 0
+      uint64_t high = (bits == 64) ? 0 : (upper_bits(prefix) & (~0ULL << bits));
+      set_upper_bits(prefix, high);
+      memset(&prefix.s6_addr[8], 0, 8);
+    }
+  }
+
+  // true if a /64 is delegated to each UE
+  bool delegates() const { return num > 0; }
+
+  bool alloc_address(struct in6_addr& allocated) {
+    if (!delegates()) {
+      allocated = prefix;
+      return true;
+    }
+    uint32_t pos = 0;
+    if (alloc.alloc(pos)) {
+      allocated = address(pos);
+      return true;
+    }
+    allocated = in6addr_any;
+    return false;
+  }
+
+  bool reserve_address(const struct in6_addr& address) {
+    uint32_t pos = 0;
+    if (!position(address, pos)) return false;
+    return alloc.reserve(pos);
+  }
+
+  bool free_address(const struct in6_addr& allocated) {
+    uint32_t pos = 0;
+    if (!position(allocated, pos)) return false;
+    return alloc.free(pos);
+  }
+
+  bool in_pool(const struct in6_addr& a) const {
+    uint32_t pos = 0;
+    return position(a, pos);
+  }
+
+  uint32_t free_count() const { return alloc.free_count(); }
+
+ protected:
+  uint32_t num;
+  paa_bitmap alloc;
+
+  // 64 first bits of an address, host order
+  static uint64_t upper_bits(const struct in6_addr& a) {
+    uint64_t be = 0;
+    memcpy(&be, &a.s6_addr[0], 8);
+    return be64toh(be);
+  }
+  static void set_upper_bits(struct in6_addr& a, const uint64_t high) {
+    uint64_t be = htobe64(high);
+    memcpy(&a.s6_addr[0], &be, 8);
+  }
+
+  struct in6_addr address(const uint32_t pos) const {
+    struct in6_addr a = prefix;
+    set_upper_bits(a, upper_bits(prefix) | pos);
+    return a;
+  }
+
+  // position of the /64 of an address
+  bool position(const struct in6_addr& a, uint32_t& pos) const {
+    if (!delegates()) return false;
+    uint64_t base = upper_bits(prefix);
+    uint64_t high = upper_bits(a);
+    if ((high < base) || ((high - base) >= num)) return false;
+    pos = (uint32_t)(high - base);
+    return true;
+  }
+};
+
+#endif /* FILE_SMF_PAA_POOL_HPP_SEEN */
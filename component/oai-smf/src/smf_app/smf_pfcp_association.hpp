@@ -31,6 +31,7 @@
 #include <folly/AtomicHashMap.h>
 #include <folly/AtomicLinkedList.h>
 #include <mutex>
+#include <set>
 #include <vector>
 
 #include "3gpp_29.244.h"
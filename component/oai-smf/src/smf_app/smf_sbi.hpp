@@ -29,33 +29,21 @@
 #ifndef FILE_SMF_SBI_HPP_SEEN
 #define FILE_SMF_SBI_HPP_SEEN
 
-#include <map>
-#include <thread>
-
-#include <boost/thread.hpp>
-#include <boost/thread/future.hpp>
-#include <curl/curl.h>
 #include "3gpp_29.503.h"
 #include "smf.h"
 #include "smf_context.hpp"
+#include "smf_sbi_client.hpp"
 
 namespace smf {
 
 #define TASK_SMF_SBI_TIMEOUT_NRF_HEARTBEAT_REQUEST 1
 
+// The requests of TASK_SMF_SBI are sent through the SBI client and their
+// responses are handled on the client thread (results posted to TASK_SMF_APP),
+// many requests to the AMF/NRF are in flight at once
 class smf_sbi {
  private:
-  CURLM* curl_multi;
-  std::vector<CURL*> handles;
-  struct curl_slist* headers;
-
-  mutable std::shared_mutex m_curl_handle_promises;
-
-  std::map<uint32_t, boost::shared_ptr<boost::promise<uint32_t>>>
-      curl_handle_promises;
-
-  std::thread::id thread_id;
-  std::thread thread;
+  smf_sbi_client sbi_client;
 
  public:
   smf_sbi();
@@ -147,18 +135,35 @@ class smf_sbi {
       std::shared_ptr<itti_n11_subscribe_upf_status_notify> msg);
 
   /*
-   * Get SM subscription data from UDM
+   * Get SM subscription data from UDM, the response is sent to TASK_SMF_APP
+   * (itti_n11_get_sm_data_response) with the request waiting for it
    * @param [const supi64_t &] supi
    * @param [const std::string &] dnn
    * @param [const snssai_t &] snssai
+   * @param [const plmn_t &] plmn
+   * @param [std::shared_ptr<itti_n11_create_sm_context_request>] smreq
+   * @return void
+   *
+   */
+  void get_sm_data(
+      const supi64_t& supi, const std::string& dnn, const snssai_t& snssai,
+      const plmn_t& plmn,
+      std::shared_ptr<itti_n11_create_sm_context_request> smreq);
+
+  /*
+   * Get the SM subscription data from the response of UDM
+   * @param [const uint32_t] http_code: HTTP response code
+   * @param [const std::string &] response_data: Msg body
+   * @param [const std::string &] dnn
+   * @param [const snssai_t &] snssai
    * @param [std::shared_ptr<session_management_subscription>] subscription
    * @return bool: True if successful, otherwise false
    *
    */
-  bool get_sm_data(
-      const supi64_t& supi, const std::string& dnn, const snssai_t& snssai,
-      std::shared_ptr<session_management_subscription>& subscription,
-      plmn_t plmn = {});
+  bool handle_sm_data(
+      const uint32_t http_code, const std::string& response_data,
+      const std::string& dnn, const snssai_t& snssai,
+      std::shared_ptr<session_management_subscription>& subscription);
 
   /*
    * Subscribe to be notify from UDM
@@ -167,103 +172,6 @@ class smf_sbi {
    *
    */
   void subscribe_sm_data();
-
-  /*
-   * Create Curl handle for multi curl
-   * @param [const std::string &] uri: URI of the subscribed NF
-   * @param [const char* ] data: pointer to the data to be sent
-   * @param [uint32_t] data_len: len of data to be sent
-   * @param [std::string &] response_data: response data
-   * @param [uint32_t* ] promise_id: pointer to the promise id
-   * @param [const std::string&] method: HTTP method
-   * @param [bool] is_multipart: use multipart or json format
-   * @return true if a handle was created successfully, otherwise return false
-   */
-  bool curl_create_handle(
-      const std::string& uri, const char* data, uint32_t data_len,
-      std::string& response_data, uint32_t* promise_id,
-      const std::string& method, bool is_multipart, uint8_t http_version = 1);
-
-  /*
-   * Create Curl handle for multi curl
-   * @param [const std::string &] uri: URI of the subscribed NF
-   * @param [const std::string& ] data: data to be sent
-   * @param [std::string &] response_data: response data
-   * @param [uint32_t* ] promise_id: pointer to the promise id
-   * @param [const std::string&] method: HTTP method
-   * @param [bool] is_multipart: use multipart or json format
-   * @return true if a handle was created successfully, otherwise return false
-   */
-  bool curl_create_handle(
-      const std::string& uri, const std::string& data,
-      std::string& response_data, uint32_t* promise_id,
-      const std::string& method, uint8_t http_version = 1);
-
-  /*
-   * Create Curl handle for multi curl
-   * @param [const std::string &] uri: URI of the subscribed NF
-   * @param [std::string &] response_data: response data
-   * @param [uint32_t* ] promise_id: pointer to the promise id
-   * @param [const std::string&] method: HTTP method
-   * @return true if a handle was created successfully, otherwise return false
-   */
-  bool curl_create_handle(
-      const std::string& uri, std::string& response_data, uint32_t* promise_id,
-      const std::string& method, uint8_t http_version = 1);
-
-  /*
-   * Perform curl multi to actually process the available data
-   * @param [uint64_t ms] ms: current time
-   * @return void
-   */
-  void perform_curl_multi(uint64_t ms);
-
-  /*
-   * Release all the handles
-   * @param void
-   * @return void
-   */
-  void curl_release_handles();
-
-  /*
-   * Wait for the promise ready
-   * @param [boost::shared_future<uint32_t>&] f: future
-   * @return future value
-   */
-  uint32_t get_available_response(boost::shared_future<uint32_t>& f);
-
-  /*
-   * Store the promise
-   * @param [uint32_t] pid: promise id
-   * @param [boost::shared_ptr<boost::promise<uint32_t>>&] p: promise
-   * @return void
-   */
-  void add_promise(
-      uint32_t pid, boost::shared_ptr<boost::promise<uint32_t>>& p);
-
-  /*
-   * Remove the promise
-   * @param [uint32_t] pid: promise id
-   * @return void
-   */
-  void remove_promise(uint32_t id);
-
-  /*
-   * Set the value of the promise to make it ready
-   * @param [uint32_t] pid: promise id
-   * @param [uint32_t ] http_code: http response code
-   * @return void
-   */
-  void trigger_process_response(uint32_t pid, uint32_t http_code);
-
-  /*
-   * Generate an unique value for promise id
-   * @param void
-   * @return generated promise id
-   */
-  static uint64_t generate_promise_id() {
-    return util::uint_uid_generator<uint64_t>::get_instance().get_uid();
-  }
 };
 }  // namespace smf
 #endif /* FILE_SMF_SBI_HPP_SEEN */
@@ -0,0 +1,349 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file smf_sbi_client.cpp
+ \brief Event driven HTTP client used to reach the other NFs (AMF, NRF, UDM)
+ \date 2021
+ \email: contact@openairinterface.org
+ */
+
+#include "smf_sbi_client.hpp"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+#include "logger.hpp"
+#include "smf.h"
+
+using namespace smf;
+
+//------------------------------------------------------------------------------
+static std::size_t sbi_client_write(
+    const char* in, std::size_t size, std::size_t num, std::string* out) {
+  const std::size_t total_bytes(size * num);
+  out->append(in, total_bytes);
+  return total_bytes;
+}
+
+//------------------------------------------------------------------------------
+smf_sbi_client::smf_sbi_client(const std::string& if_name)
+    : if_name(if_name),
+      multi(nullptr),
+      epoll_fd(-1),
+      event_fd(-1),
+      running(true),
+      thread(),
+      m_pending(),
+      pending(),
+      timer_armed(false),
+      timer_expiry(),
+      free_handles(),
+      in_flight() {
+  // Once for the process, not per request
+  curl_global_init(CURL_GLOBAL_ALL);
+  multi = curl_multi_init();
+  if (!multi) {
+    throw std::runtime_error("Cannot create the SBI client");
+  }
+  curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, &socket_callback);
+  curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, this);
+  curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, &timer_callback);
+  curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this);
+  curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+  curl_multi_setopt(
+      multi, CURLMOPT_MAX_HOST_CONNECTIONS, SBI_CLIENT_MAX_HOST_CONNECTIONS);
+  curl_multi_setopt(
+      multi, CURLMOPT_MAXCONNECTS, SBI_CLIENT_MAX_CACHED_CONNECTIONS);
+
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  struct epoll_event ev = {};
+  ev.events             = EPOLLIN;
+  ev.data.fd            = event_fd;
+  if ((epoll_fd < 0) || (event_fd < 0) ||
+      (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &ev) < 0)) {
+    if (epoll_fd >= 0) close(epoll_fd);
+    if (event_fd >= 0) close(event_fd);
+    curl_multi_cleanup(multi);
+    throw std::runtime_error("Cannot create the SBI client event loop");
+  }
+  thread = std::thread(&smf_sbi_client::run, this);
+  Logger::smf_sbi().startup("SBI client started");
+}
+
+//------------------------------------------------------------------------------
+smf_sbi_client::~smf_sbi_client() {
+  running      = false;
+  uint64_t one = 1;
+  if (write(event_fd, &one, sizeof(one)) < 0) {
+    Logger::smf_sbi().warn("Could not wake the SBI client thread up");
+  }
+  if (thread.joinable()) thread.join();
+  for (auto h : free_handles) curl_easy_cleanup(h);
+  curl_multi_cleanup(multi);
+  close(event_fd);
+  close(epoll_fd);
+  curl_global_cleanup();
+}
+
+//------------------------------------------------------------------------------
+void smf_sbi_client::send_request(
+    const std::string& uri, const std::string& method, std::string&& body,
+    const std::string& content_type, const uint8_t http_version,
+    sbi_response_handler_t&& handler) {
+  sbi_request_t* request = new sbi_request_t();
+  request->curl          = nullptr;
+  request->headers = curl_slist_append(nullptr, "Accept: application/json");
+  request->headers = curl_slist_append(
+      request->headers, ("Content-Type: " + content_type).c_str());
+  request->uri                = uri;
+  request->method             = method;
+  request->body               = std::move(body);
+  request->http_version       = http_version;
+  request->response.result    = CURLE_OK;
+  request->response.http_code = 0;
+  request->handler            = std::move(handler);
+
+  {
+    std::lock_guard<std::mutex> lock(m_pending);
+    pending.push_back(request);
+  }
+  uint64_t one = 1;
+  if (write(event_fd, &one, sizeof(one)) < 0) {
+    Logger::smf_sbi().warn("Could not wake the SBI client thread up");
+  }
+}
+
+//------------------------------------------------------------------------------
+int smf_sbi_client::socket_callback(
+    CURL* easy, curl_socket_t s, int what, void* userp, void* socketp) {
+  smf_sbi_client* client = (smf_sbi_client*) userp;
+  if (what == CURL_POLL_REMOVE) {
+    // curl forgets socketp by itself
+    epoll_ctl(client->epoll_fd, EPOLL_CTL_DEL, s, nullptr);
+    return 0;
+  }
+
+  struct epoll_event ev = {};
+  ev.data.fd            = s;
+  if (what & CURL_POLL_IN) ev.events |= EPOLLIN;
+  if (what & CURL_POLL_OUT) ev.events |= EPOLLOUT;
+  // socketp is set once the socket is in the epoll
+  int op = socketp ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  if (epoll_ctl(client->epoll_fd, op, s, &ev) < 0) {
+    Logger::smf_sbi().error(
+        "Cannot watch the SBI socket %d: %s", s, strerror(errno));
+    return -1;
+  }
+  if (!socketp) curl_multi_assign(client->multi, s, client);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int smf_sbi_client::timer_callback(
+    CURLM* multi, long timeout_ms, void* userp) {
+  smf_sbi_client* client = (smf_sbi_client*) userp;
+  client->timer_armed    = (timeout_ms >= 0);
+  client->timer_expiry =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int smf_sbi_client::get_wait_ms() {
+  if (!timer_armed) return -1;
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                timer_expiry - std::chrono::steady_clock::now())
+                .count();
+  if (ms <= 0) return 0;
+  return (int) ms;
+}
+
+//------------------------------------------------------------------------------
+CURL* smf_sbi_client::get_easy_handle() {
+  if (free_handles.empty()) return curl_easy_init();
+  CURL* curl = free_handles.back();
+  free_handles.pop_back();
+  return curl;
+}
+
+//------------------------------------------------------------------------------
+void smf_sbi_client::setup(sbi_request_t* request) {
+  CURL* curl = request->curl;
+  curl_easy_setopt(curl, CURLOPT_PRIVATE, request);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl, CURLOPT_URL, request->uri.c_str());
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request->headers);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, NF_CURL_TIMEOUT_MS);
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(curl, CURLOPT_INTERFACE, if_name.c_str());
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+
+  if (request->http_version == 2) {
+    // We use a self-signed test server, skip verification during debugging
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(
+        curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
+    // Rather wait for a stream on the existing connection than open another
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+  }
+
+  if (request->method.compare("GET") == 0) {
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+  } else if (request->method.compare("DELETE") == 0) {
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+  } else {
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, request->body.length());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request->body.c_str());
+    if (request->method.compare("POST") != 0)
+      curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request->method.c_str());
+  }
+
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &sbi_client_write);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &request->response.body);
+}
+
+//------------------------------------------------------------------------------
+void smf_sbi_client::add_pending_requests() {
+  std::vector<sbi_request_t*> requests = {};
+  {
+    std::lock_guard<std::mutex> lock(m_pending);
+    requests.swap(pending);
+  }
+  for (auto request : requests) {
+    request->curl = get_easy_handle();
+    if (!request->curl) {
+      Logger::smf_sbi().error(
+          "Cannot get a handle to send request to %s", request->uri.c_str());
+      complete(request, CURLE_FAILED_INIT);
+      continue;
+    }
+    setup(request);
+    // curl arms its timer to start the transfer from the event loop
+    CURLMcode rc = curl_multi_add_handle(multi, request->curl);
+    if (rc != CURLM_OK) {
+      Logger::smf_sbi().error(
+          "Cannot send request to %s: %s", request->uri.c_str(),
+          curl_multi_strerror(rc));
+      complete(request, CURLE_FAILED_INIT);
+      continue;
+    }
+    in_flight.insert(request);
+  }
+}
+
+//------------------------------------------------------------------------------
+void smf_sbi_client::complete(sbi_request_t* request, const CURLcode result) {
+  if (request->curl) {
+    long http_code = 0;
+    curl_easy_getinfo(request->curl, CURLINFO_RESPONSE_CODE, &http_code);
+    request->response.http_code = http_code;
+    if (in_flight.erase(request)) {
+      curl_multi_remove_handle(multi, request->curl);
+    }
+    curl_easy_reset(request->curl);
+    free_handles.push_back(request->curl);
+  }
+  request->response.result = result;
+  if (result != CURLE_OK) {
+    Logger::smf_sbi().warn(
+        "Request to %s failed: %s", request->uri.c_str(),
+        curl_easy_strerror(result));
+  }
+  curl_slist_free_all(request->headers);
+
+  try {
+    request->handler(request->response);
+  } catch (std::exception& e) {
+    Logger::smf_sbi().error(
+        "Error while handling the response from %s: %s", request->uri.c_str(),
+        e.what());
+  }
+  delete request;
+}
+
+//------------------------------------------------------------------------------
+void smf_sbi_client::complete_requests() {
+  CURLMsg* msg  = nullptr;
+  int msgs_left = 0;
+  while ((msg = curl_multi_info_read(multi, &msgs_left))) {
+    if (msg->msg != CURLMSG_DONE) continue;
+    sbi_request_t* request = nullptr;
+    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &request);
+    // msg is not valid anymore once the handle is removed
+    const CURLcode result = msg->data.result;
+    complete(request, result);
+  }
+}
+
+//------------------------------------------------------------------------------
+void smf_sbi_client::run() {
+  struct epoll_event events[SBI_CLIENT_EPOLL_MAX_EVENTS];
+  int still_running = 0;
+  // once stopped, the transfers in progress end within their timeout
+  while (running || !in_flight.empty()) {
+    int n = epoll_wait(
+        epoll_fd, events, SBI_CLIENT_EPOLL_MAX_EVENTS, get_wait_ms());
+    if ((n < 0) && (errno != EINTR)) {
+      Logger::smf_sbi().error("SBI client epoll_wait: %s", strerror(errno));
+    }
+
+    for (int i = 0; i < n; i++) {
+      if (events[i].data.fd == event_fd) {
+        uint64_t count = 0;
+        if (read(event_fd, &count, sizeof(count)) < 0) {
+          // already drained
+        }
+        add_pending_requests();
+        continue;
+      }
+      int action = 0;
+      if (events[i].events & EPOLLIN) action |= CURL_CSELECT_IN;
+      if (events[i].events & EPOLLOUT) action |= CURL_CSELECT_OUT;
+      if (events[i].events & (EPOLLERR | EPOLLHUP)) action |= CURL_CSELECT_ERR;
+      curl_multi_socket_action(
+          multi, events[i].data.fd, action, &still_running);
+    }
+
+    if (timer_armed && (get_wait_ms() == 0)) {
+      timer_armed = false;
+      curl_multi_socket_action(
+          multi, CURL_SOCKET_TIMEOUT, 0, &still_running);
+    }
+    complete_requests();
+  }
+
+  // Do not leave anyone waiting for a response
+  std::vector<sbi_request_t*> requests = {};
+  {
+    std::lock_guard<std::mutex> lock(m_pending);
+    requests.swap(pending);
+  }
+  for (auto request : requests) {
+    complete(request, CURLE_ABORTED_BY_CALLBACK);
+  }
+}
@@ -0,0 +1,302 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file paa_bench.cpp
+ \brief Micro-benchmark of the UE address pools, allocations and releases per
+        second in a /8 IPv4 pool and a /40 IPv6 prefix
+ \date 2021
+ */
+
+#include <arpa/inet.h>
+
+#include <bitset>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "smf_paa_pool.hpp"
+
+#define BENCH_DURATION_S 1.0
+#define BENCH_LEGACY_POOL_SIZE 4096
+
+//------------------------------------------------------------------------------
+// Previous IPv4 pool: words of 32 addresses in a std::map, linear scan
+class legacy_ipv4_pool {
+ public:
+  legacy_ipv4_pool(const struct in_addr first, const uint32_t range)
+      : alloc() {
+    start.s_addr = first.s_addr;
+    num          = range;
+    int range32  = range >> 5;
+    int i        = 0;
+    for (i = 0; i < range32; ++i) {
+      alloc[i] = 0;
+    }
+    if (range & 0x0000001F) {
+      alloc[i] = std::numeric_limits<uint32_t>::max() << (range & 0x0000001F);
+    }
+  }
+
+  bool alloc_address(struct in_addr& allocated) {
+    int bit_pos = 0;
+    for (std::size_t i = 0; i < alloc.size(); ++i) {
+      if (alloc[i] != std::numeric_limits<uint32_t>::max()) {
+        std::bitset<32> bs(alloc[i]);
+        int word_bit_pos = 0;
+        while (bs[word_bit_pos]) {
+          bit_pos++;
+          word_bit_pos++;
+        }
+        bs.set(word_bit_pos);
+        alloc[i]         = bs.to_ulong();
+        allocated.s_addr = htobe32(be32toh(start.s_addr) + bit_pos);
+        return true;
+      }
+      bit_pos += 32;
+    }
+    allocated.s_addr = 0;
+    return false;
+  }
+
+  bool free_address(const struct in_addr& allocated) {
+    int bit_pos = be32toh(allocated.s_addr) - be32toh(start.s_addr);
+    if (bit_pos < num) {
+      std::bitset<32> bs(alloc[bit_pos >> 5]);
+      bs.reset(bit_pos & 0x0000001F);
+      alloc[bit_pos >> 5] = bs.to_ulong();
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  struct in_addr start;
+  int num;
+  std::map<int, uint32_t> alloc;
+};
+
+//------------------------------------------------------------------------------
+static struct in_addr ipv4(const char* s) {
+  struct in_addr a = {};
+  inet_pton(AF_INET, s, &a);
+  return a;
+}
+
+//------------------------------------------------------------------------------
+static struct in6_addr ipv6(const char* s) {
+  struct in6_addr a = {};
+  inet_pton(AF_INET6, s, &a);
+  return a;
+}
+
+//------------------------------------------------------------------------------
+static bool is(const struct in6_addr& a, const char* s) {
+  struct in6_addr b = ipv6(s);
+  return IN6_ARE_ADDR_EQUAL(&a, &b);
+}
+
+//------------------------------------------------------------------------------
+static bool check() {
+  // Lowest free address first, not a multiple of 64 addresses
+  struct in_addr start = ipv4("12.1.1.2");
+  ipv4_pool pool(start, 1000);
+  struct in_addr a = {};
+  for (uint32_t i = 0; i < 1000; i++) {
+    if (!pool.alloc_address(a) ||
+        (be32toh(a.s_addr) != be32toh(start.s_addr) + i)) {
+      std::cerr << "IPv4 allocation " << i << " failed" << std::endl;
+      return false;
+    }
+  }
+  if (pool.alloc_address(a) || pool.free_count()) {
+    std::cerr << "IPv4 pool not full" << std::endl;
+    return false;
+  }
+  pool.free_address(ipv4("12.1.1.200"));
+  pool.free_address(ipv4("12.1.1.100"));
+  if (!pool.alloc_address(a) || (a.s_addr != ipv4("12.1.1.100").s_addr)) {
+    std::cerr << "IPv4 lowest free address not allocated" << std::endl;
+    return false;
+  }
+  if (pool.free_address(ipv4("12.1.1.1")) || pool.in_pool(ipv4("12.1.1.1")) ||
+      pool.in_pool(ipv4("12.1.5.234")) ||
+      pool.free_address(ipv4("12.1.1.200"))) {
+    std::cerr << "IPv4 release out of the pool or not allocated" << std::endl;
+    return false;
+  }
+  if (!pool.reserve_address(ipv4("12.1.1.200")) ||
+      pool.reserve_address(ipv4("12.1.1.200")) || pool.alloc_address(a)) {
+    std::cerr << "IPv4 static address reservation failed" << std::endl;
+    return false;
+  }
+
+  // Same addresses as the previous pool
+  std::mt19937 rng(1);
+  ipv4_pool p(start, BENCH_LEGACY_POOL_SIZE - 7);
+  legacy_ipv4_pool legacy(start, BENCH_LEGACY_POOL_SIZE - 7);
+  std::vector<struct in_addr> allocated;
+  for (int i = 0; i < 100000; i++) {
+    if (allocated.empty() || (rng() % 3)) {
+      struct in_addr b = {};
+      bool ok          = p.alloc_address(a);
+      if ((ok != legacy.alloc_address(b)) || (a.s_addr != b.s_addr)) {
+        std::cerr << "Differs from the previous pool, operation " << i
+                  << std::endl;
+        return false;
+      }
+      if (ok) allocated.push_back(a);
+    } else {
+      std::size_t n = rng() % allocated.size();
+      p.free_address(allocated[n]);
+      legacy.free_address(allocated[n]);
+      allocated[n] = allocated.back();
+      allocated.pop_back();
+    }
+  }
+
+  // A /64 per UE
+  ipv6_pool pool6(ipv6("2001:db8:0:1234::1"), 48);
+  struct in6_addr a6 = {};
+  pool6.alloc_address(a6);
+  if (!pool6.delegates() || !is(a6, "2001:db8::") ||
+      !pool6.alloc_address(a6) || !is(a6, "2001:db8:0:1::")) {
+    std::cerr << "IPv6 prefix delegation failed" << std::endl;
+    return false;
+  }
+  if (!pool6.free_address(ipv6("2001:db8::")) || !pool6.alloc_address(a6) ||
+      !is(a6, "2001:db8::") ||
+      !pool6.reserve_address(ipv6("2001:db8:0:ffff::")) ||
+      pool6.reserve_address(ipv6("2001:db8:0:ffff::")) ||
+      pool6.in_pool(ipv6("2001:db8:1::")) ||
+      (pool6.free_count() != 65536 - 3)) {
+    std::cerr << "IPv6 prefix release or reservation failed" << std::endl;
+    return false;
+  }
+  if ((ipv6_pool(ipv6("2001:db8::"), 32).free_count() !=
+       SMF_IPV6_POOL_MAX_PREFIXES) ||
+      ipv6_pool(ipv6("2001:db8::"), 64).delegates()) {
+    std::cerr << "IPv6 pool size failed" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Run f once, f handles nb operations
+template<typename F>
+static void once(const char* name, const uint64_t nb, F f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  double s = std::chrono::duration<double>(end - start).count();
+  std::cout << "  " << name << ": " << (nb / s) / 1e6 << " M operations/s, "
+            << (s * 1e9) / nb << " ns/operation" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+// Run f for BENCH_DURATION_S, f handles one operation
+template<typename F>
+static void bench(const char* name, F f) {
+  uint64_t count = 0;
+  auto start     = std::chrono::steady_clock::now();
+  auto end       = start;
+  do {
+    for (int i = 0; i < 1024; i++) f();
+    count += 1024;
+    end = std::chrono::steady_clock::now();
+  } while (std::chrono::duration<double>(end - start).count() <
+           BENCH_DURATION_S);
+  double s = std::chrono::duration<double>(end - start).count();
+  std::cout << "  " << name << ": " << (count / s) / 1e6 << " M operations/s, "
+            << (s * 1e9) / count << " ns/operation" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+// Fill the pool to 90% (lowest addresses), then release a random address and
+// allocate one (the released one)
+template<typename P, typename A, typename F>
+static void bench_churn(
+    const char* name, P& pool, const uint32_t size, A a, F address) {
+  std::mt19937 rng(1);
+  uint32_t nb = size - size / 10;
+  for (uint32_t i = 0; i < nb; i++) pool.alloc_address(a);
+  bench(name, [&] {
+    pool.free_address(address(rng() % nb));
+    pool.alloc_address(a);
+  });
+}
+
+//------------------------------------------------------------------------------
+template<typename P>
+static void bench_ipv4(const char* name, const uint32_t size) {
+  struct in_addr start = ipv4("10.0.0.0");
+  struct in_addr a     = {};
+  auto address         = [&](const uint32_t n) {
+    a.s_addr = htobe32(be32toh(start.s_addr) + n);
+    return a;
+  };
+  std::cout << size << " addresses " << name << ":" << std::endl;
+  P pool(start, size);
+  once("allocate all         ", size, [&] {
+    for (uint32_t i = 0; i < size; i++) pool.alloc_address(a);
+  });
+  once("release all          ", size, [&] {
+    for (uint32_t i = 0; i < size; i++) pool.free_address(address(i));
+  });
+  bench_churn("release/allocate, 90%", pool, size, a, address);
+}
+
+//------------------------------------------------------------------------------
+static void bench_ipv6() {
+  struct in6_addr prefix = ipv6("2001:db8::");
+  struct in6_addr a      = {};
+  auto address           = [&](const uint32_t n) {
+    a = prefix;
+    a.s6_addr[5] += n >> 16;
+    a.s6_addr[6] = n >> 8;
+    a.s6_addr[7] = n;
+    return a;
+  };
+  ipv6_pool pool(prefix, 40);
+  uint32_t size = pool.free_count();
+  std::cout << size << " /64 IPv6 pool:" << std::endl;
+  once("allocate all         ", size, [&] {
+    for (uint32_t i = 0; i < size; i++) pool.alloc_address(a);
+  });
+  once("release all          ", size, [&] {
+    for (uint32_t i = 0; i < size; i++) pool.free_address(address(i));
+  });
+  bench_churn("release/allocate, 90%", pool, size, a, address);
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  if (!check()) return 1;
+  bench_ipv4<legacy_ipv4_pool>(
+      "previous IPv4 pool", BENCH_LEGACY_POOL_SIZE);
+  bench_ipv4<ipv4_pool>("IPv4 pool", BENCH_LEGACY_POOL_SIZE);
+  bench_ipv4<ipv4_pool>("IPv4 pool", 1 << 24);
+  bench_ipv6();
+  return 0;
+}
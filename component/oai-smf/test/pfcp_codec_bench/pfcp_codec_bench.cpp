@@ -0,0 +1,436 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_codec_bench.cpp
+ \brief Throughput of the PFCP session establishment and modification
+        messages encoded and decoded by pfcp_msg (iostream, a pfcp_ie per IE)
+        and by the buffer based codec
+ \date 2021
+ */
+
+#include <arpa/inet.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "3gpp_29.244.hpp"
+#include "pfcp_codec.hpp"
+
+#define BENCH_DURATION_S 1.0
+#define BENCH_SEID 0x0123456789abcdefULL
+#define BENCH_SEQUENCE_NUMBER 0x123456
+
+using namespace pfcp;
+
+//------------------------------------------------------------------------------
+static struct in_addr ipv4(const char* s) {
+  struct in_addr a = {};
+  inet_pton(AF_INET, s, &a);
+  return a;
+}
+
+//------------------------------------------------------------------------------
+// A PDR per direction and QoS flow, as built by the SMF
+static create_pdr uplink_pdr(const uint16_t id) {
+  create_pdr pdr                 = {};
+  pdr_id_t pdr_id                = {};
+  precedence_t precedence        = {.precedence = 0};
+  pdi p                          = {};
+  source_interface_t source      = {};
+  network_instance_t nwi         = {};
+  fteid_t local_fteid            = {};
+  ue_ip_address_t ue_ip_address  = {};
+  qfi_t qfi                      = {};
+  outer_header_removal_t removal = {};
+  far_id_t far_id                = {};
+  pdr_id.rule_id                 = id;
+  far_id.far_id                  = id;
+  source.interface_value         = INTERFACE_VALUE_ACCESS;
+  nwi.network_instance           = "access.oai.org";
+  local_fteid.ch                 = 1;
+  local_fteid.v4                 = 1;
+  ue_ip_address.v4               = 1;
+  ue_ip_address.ipv4_address     = ipv4("12.1.1.2");
+  qfi.qfi                        = 9;
+  removal.outer_header_removal_description =
+      OUTER_HEADER_REMOVAL_GTPU_UDP_IPV4;
+  p.set(source);
+  p.set(nwi);
+  p.set(local_fteid);
+  p.set(ue_ip_address);
+  p.set(qfi);
+  pdr.set(pdr_id);
+  pdr.set(precedence);
+  pdr.set(p);
+  pdr.set(removal);
+  pdr.set(far_id);
+  return pdr;
+}
+
+//------------------------------------------------------------------------------
+static create_pdr downlink_pdr(const uint16_t id) {
+  create_pdr pdr                = {};
+  pdr_id_t pdr_id               = {};
+  precedence_t precedence       = {.precedence = 0};
+  pdi p                         = {};
+  source_interface_t source     = {};
+  network_instance_t nwi        = {};
+  ue_ip_address_t ue_ip_address = {};
+  qfi_t qfi                     = {};
+  far_id_t far_id               = {};
+  pdr_id.rule_id                = id;
+  far_id.far_id                 = id;
+  source.interface_value        = INTERFACE_VALUE_CORE;
+  nwi.network_instance          = "core.oai.org";
+  ue_ip_address.v4              = 1;
+  ue_ip_address.sd              = 1;
+  ue_ip_address.ipv4_address    = ipv4("12.1.1.2");
+  qfi.qfi                       = 9;
+  p.set(source);
+  p.set(nwi);
+  p.set(ue_ip_address);
+  p.set(qfi);
+  pdr.set(pdr_id);
+  pdr.set(precedence);
+  pdr.set(p);
+  pdr.set(far_id);
+  return pdr;
+}
+
+//------------------------------------------------------------------------------
+static create_far far(const uint32_t id, const uint8_t destination) {
+  create_far f                = {};
+  far_id_t far_id             = {};
+  apply_action_t apply_action = {};
+  forwarding_parameters fp    = {};
+  destination_interface_t d   = {};
+  network_instance_t nwi      = {};
+  far_id.far_id               = id;
+  apply_action.forw           = 1;
+  d.interface_value           = destination;
+  nwi.network_instance        = "core.oai.org";
+  fp.set(d);
+  fp.set(nwi);
+  f.set(far_id);
+  f.set(apply_action);
+  f.set(fp);
+  return f;
+}
+
+//------------------------------------------------------------------------------
+// nb_flows QoS flows, a PDR and a FAR per direction, a URR if with_urr
+static pfcp_session_establishment_request establishment_request(
+    const int nb_flows, const bool with_urr) {
+  pfcp_session_establishment_request s = {};
+  node_id_t node_id                    = {};
+  fseid_t cp_fseid                     = {};
+  node_id.node_id_type                 = NODE_ID_TYPE_IPV4_ADDRESS;
+  node_id.u1.ipv4_address              = ipv4("192.168.70.133");
+  cp_fseid.v4                          = 1;
+  cp_fseid.seid                        = 1;
+  cp_fseid.ipv4_address                = ipv4("192.168.70.133");
+  s.set(node_id);
+  s.set(cp_fseid);
+  for (int i = 0; i < nb_flows; i++) {
+    s.set(uplink_pdr(2 * i + 1));
+    s.set(downlink_pdr(2 * i + 2));
+    s.set(far(2 * i + 1, INTERFACE_VALUE_CORE));
+    s.set(far(2 * i + 2, INTERFACE_VALUE_ACCESS));
+  }
+  if (with_urr) {
+    create_urr urr                = {};
+    urr_id_t urr_id               = {.urr_id = 1};
+    measurement_method_t method   = {};
+    measurement_period_t period   = {.measurement_period = 10};
+    reporting_triggers_t triggers = {};
+    method.volum                  = 1;
+    triggers.perio                = 1;
+    urr.set(urr_id);
+    urr.set(method);
+    urr.set(period);
+    urr.set(triggers);
+    s.set(urr);
+  }
+  return s;
+}
+
+//------------------------------------------------------------------------------
+static pfcp_session_establishment_response establishment_response(
+    const int nb_flows) {
+  pfcp_session_establishment_response s = {};
+  node_id_t node_id                     = {};
+  cause_t cause                         = {};
+  fseid_t up_fseid                      = {};
+  node_id.node_id_type                  = NODE_ID_TYPE_FQDN;
+  node_id.fqdn                          = "upf.oai.org";
+  cause.cause_value                     = CAUSE_VALUE_REQUEST_ACCEPTED;
+  up_fseid.v4                           = 1;
+  up_fseid.seid                         = BENCH_SEID;
+  up_fseid.ipv4_address                 = ipv4("192.168.70.134");
+  s.set(node_id);
+  s.set(cause);
+  s.set(up_fseid);
+  for (int i = 0; i < nb_flows; i++) {
+    created_pdr c            = {};
+    pdr_id_t pdr_id          = {};
+    fteid_t local_fteid      = {};
+    pdr_id.rule_id           = 2 * i + 1;
+    local_fteid.v4           = 1;
+    local_fteid.teid         = 0x1000 + i;
+    local_fteid.ipv4_address = ipv4("192.168.71.134");
+    c.set(pdr_id);
+    c.set(local_fteid);
+    s.set(c);
+  }
+  return s;
+}
+
+//------------------------------------------------------------------------------
+// The access side FAR of each QoS flow with the gNB tunnel (N2 PDU Session
+// Resource Setup Response)
+static pfcp_session_modification_request modification_request(
+    const int nb_flows) {
+  pfcp_session_modification_request s = {};
+  fseid_t cp_fseid                    = {};
+  cp_fseid.v4                         = 1;
+  cp_fseid.seid                       = 1;
+  cp_fseid.ipv4_address               = ipv4("192.168.70.133");
+  s.set(cp_fseid);
+  for (int i = 0; i < nb_flows; i++) {
+    update_far f                    = {};
+    far_id_t far_id                 = {};
+    apply_action_t apply_action     = {};
+    update_forwarding_parameters fp = {};
+    destination_interface_t d       = {};
+    network_instance_t nwi          = {};
+    outer_header_creation_t ohc     = {};
+    far_id.far_id                   = 2 * i + 2;
+    apply_action.forw               = 1;
+    d.interface_value               = INTERFACE_VALUE_ACCESS;
+    nwi.network_instance            = "access.oai.org";
+    ohc.outer_header_creation_description =
+        OUTER_HEADER_CREATION_GTPU_UDP_IPV4;
+    ohc.teid         = 0x2000 + i;
+    ohc.ipv4_address = ipv4("192.168.72.141");
+    fp.set(d);
+    fp.set(nwi);
+    fp.set(ohc);
+    f.set(far_id);
+    f.set(apply_action);
+    f.set(fp);
+    s.set(f);
+  }
+  return s;
+}
+
+//------------------------------------------------------------------------------
+static pfcp_session_modification_response modification_response() {
+  pfcp_session_modification_response s = {};
+  cause_t cause                        = {};
+  cause.cause_value                    = CAUSE_VALUE_REQUEST_ACCEPTED;
+  s.set(cause);
+  return s;
+}
+
+//------------------------------------------------------------------------------
+// Previous encoder
+template<class T>
+static std::string legacy_encode(const T& s) {
+  std::ostringstream oss(std::ostringstream::binary);
+  pfcp_msg msg(s);
+  msg.set_seid(BENCH_SEID);
+  msg.set_sequence_number(BENCH_SEQUENCE_NUMBER);
+  msg.dump_to(oss);
+  return oss.str();
+}
+
+//------------------------------------------------------------------------------
+// Previous decoder
+template<class T>
+static void legacy_decode(std::string& bstream, T& s) {
+  std::istringstream iss(std::istringstream::binary);
+  iss.rdbuf()->pubsetbuf(&bstream[0], bstream.size());
+  pfcp_msg msg = {};
+  msg.load_from(iss);
+  msg.to_core_type(s);
+}
+
+//------------------------------------------------------------------------------
+template<class T>
+static std::string encode(const T& s) {
+  pfcp_msg_header h = {};
+  h.set_seid(BENCH_SEID);
+  h.set_sequence_number(BENCH_SEQUENCE_NUMBER);
+  std::string bstream = {};
+  pfcp::encode(h, s, bstream);
+  return bstream;
+}
+
+//------------------------------------------------------------------------------
+template<class T>
+static bool decode(const std::string& bstream, T& s) {
+  byte_span b(
+      reinterpret_cast<const uint8_t*>(bstream.data()), bstream.size());
+  pfcp_msg_header h = {};
+  return pfcp::decode(b, h) && (h.get_seid() == BENCH_SEID) &&
+         (h.get_sequence_number() == BENCH_SEQUENCE_NUMBER) &&
+         pfcp::decode(b, h, s);
+}
+
+//------------------------------------------------------------------------------
+// Same bytes as pfcp_msg, decoded to the same message as pfcp_msg (the network
+// instances are encoded in the dotted form and decoded as is by both, a
+// decoded message is not encoded back to the same bytes), truncated messages
+// not decoded. pfcp_msg of the SMF encodes an F-TEID without CHOOSE (sent by
+// the UPF) without its address: if !legacy_encodes the message is only
+// encoded back to the same bytes.
+template<class T>
+static bool check(const char* name, const T& s, const bool legacy_encodes) {
+  std::string bstream = encode(s);
+  if ((legacy_encodes && (bstream != legacy_encode(s))) ||
+      (encoded_length(s) != bstream.size())) {
+    std::cerr << name << ": encoding differs from pfcp_msg" << std::endl;
+    return false;
+  }
+  T decoded = {};
+  T legacy  = {};
+  legacy_decode(bstream, legacy);
+  if (!decode(bstream, decoded) || (encode(decoded) != encode(legacy)) ||
+      (!legacy_encodes && (encode(decoded) != bstream))) {
+    std::cerr << name << ": decoding differs from pfcp_msg" << std::endl;
+    return false;
+  }
+  for (std::size_t l = 0; l < bstream.size(); l++) {
+    T truncated       = {};
+    std::string b     = bstream.substr(0, l);
+    pfcp_msg_header h = {};
+    byte_span span(reinterpret_cast<const uint8_t*>(b.data()), b.size());
+    if (pfcp::decode(span, h) && pfcp::decode(span, h, truncated)) {
+      std::cerr << name << ": truncated message of " << l << " bytes decoded"
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static bool check() {
+  if (!check("establishment request", establishment_request(1, false), true) ||
+      !check(
+          "establishment request x8", establishment_request(8, false), true) ||
+      !check("establishment response", establishment_response(8), false) ||
+      !check("modification request", modification_request(8), true) ||
+      !check("modification response", modification_response(), true))
+    return false;
+
+  // Create URR, its Measurement Method is not decoded by pfcp_msg
+  pfcp_session_establishment_request s = establishment_request(1, true);
+  pfcp_session_establishment_request d = {};
+  std::string bstream                  = encode(s);
+  if ((bstream != legacy_encode(s)) || !decode(bstream, d) ||
+      (d.create_urrs.size() != 1) ||
+      (d.create_urrs[0].urr_id.second.urr_id != 1) ||
+      !d.create_urrs[0].measurement_method.second.volum ||
+      !d.create_urrs[0].reporting_triggers.second.perio ||
+      (d.create_urrs[0].measurement_period.second.measurement_period != 10)) {
+    std::cerr << "Create URR not encoded or decoded" << std::endl;
+    return false;
+  }
+
+  // Not handled by the codec: encoded by pfcp_msg
+  pfcp_session_establishment_request q = establishment_request(1, false);
+  create_qer qer                       = {};
+  qer_id_t qer_id                      = {.qer_id = 1};
+  qer.set(qer_id);
+  q.set(qer);
+  if (encoded_length(q) || (encode(q) != legacy_encode(q))) {
+    std::cerr << "Create QER not encoded by pfcp_msg" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Run f for BENCH_DURATION_S, f handles one operation
+template<typename F>
+static void bench(const char* name, F f) {
+  uint64_t count = 0;
+  auto start     = std::chrono::steady_clock::now();
+  auto end       = start;
+  do {
+    for (int i = 0; i < 1024; i++) f();
+    count += 1024;
+    end = std::chrono::steady_clock::now();
+  } while (std::chrono::duration<double>(end - start).count() <
+           BENCH_DURATION_S);
+  double s = std::chrono::duration<double>(end - start).count();
+  std::cout << "  " << name << ": " << (count / s) / 1e6 << " M operations/s, "
+            << (s * 1e9) / count << " ns/operation" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+template<class T>
+static void bench_message(const char* name, const T& s) {
+  std::string bstream = encode(s);
+  std::cout << name << " (" << bstream.size() << " bytes):" << std::endl;
+  uint8_t buf[4096];
+  volatile std::size_t sink = 0;
+  bench("previous encode     ", [&] { sink = legacy_encode(s).size(); });
+  bench("encode in a string  ", [&] { sink = encode(s).size(); });
+  bench("encode in a buffer  ", [&] {
+    pfcp_msg_header h = {};
+    h.set_seid(BENCH_SEID);
+    h.set_sequence_number(BENCH_SEQUENCE_NUMBER);
+    sink = pfcp::encode(h, s, buf, sizeof(buf));
+  });
+  bench("previous decode     ", [&] {
+    T d = {};
+    legacy_decode(bstream, d);
+  });
+  bench("decode              ", [&] {
+    T d  = {};
+    sink = decode(bstream, d);
+  });
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  if (!check()) return 1;
+  bench_message(
+      "Session Establishment Request, 1 QoS flow (2 PDR, 2 FAR)",
+      establishment_request(1, false));
+  bench_message(
+      "Session Establishment Request, 8 QoS flows (16 PDR, 16 FAR)",
+      establishment_request(8, false));
+  bench_message(
+      "Session Establishment Response, 8 created PDR",
+      establishment_response(8));
+  bench_message(
+      "Session Modification Request, 1 QoS flow (1 updated FAR)",
+      modification_request(1));
+  bench_message(
+      "Session Modification Request, 8 QoS flows (8 updated FAR)",
+      modification_request(8));
+  return 0;
+}
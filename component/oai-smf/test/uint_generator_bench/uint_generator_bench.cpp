@@ -0,0 +1,167 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file uint_generator_bench.cpp
+ \brief Contention benchmark of the ID generators, IDs generated and freed per
+        second by 1 to 64 threads
+ \date 2021
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "uint_generator.hpp"
+
+#define BENCH_DURATION_S 0.5
+// IDs in use per thread
+#define BENCH_WINDOW 64
+
+//------------------------------------------------------------------------------
+// Previous generator: two mutexes and a std::set of the IDs in use
+template<class UINT>
+class legacy_uint_generator {
+ private:
+  UINT uid_generator;
+  std::mutex m_uid_generator;
+
+  std::set<UINT> uid_generated;
+  std::mutex m_uid_generated;
+
+ public:
+  explicit legacy_uint_generator(const uint32_t = 1)
+      : uid_generator(0),
+        m_uid_generator(),
+        uid_generated(),
+        m_uid_generated() {}
+
+  UINT get_uid() {
+    std::unique_lock<std::mutex> lr(m_uid_generator);
+    UINT uid = ++uid_generator;
+    while (true) {
+      std::unique_lock<std::mutex> ld(m_uid_generated);
+      if (uid_generated.count(uid) == 0) {
+        uid_generated.insert(uid);
+        return uid;
+      }
+      uid = ++uid_generator;
+    }
+  }
+
+  void free_uid(UINT uid) {
+    std::unique_lock<std::mutex> l(m_uid_generated);
+    uid_generated.erase(uid);
+  }
+};
+
+//------------------------------------------------------------------------------
+// The IDs in use are unique, also after wraparounds, 0 is never generated
+template<class UINT>
+static bool check(const uint32_t nb_shards, const int nb_threads) {
+  util::uint_generator<UINT> generator(nb_shards);
+  std::vector<std::vector<UINT>> ids(nb_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nb_threads; t++) {
+    threads.push_back(std::thread([&, t] {
+      std::vector<UINT>& mine = ids[t];
+      for (int i = 0; i < 200000; i++) {
+        if (mine.size() < 500)
+          mine.push_back(generator.get_uid());
+        else {
+          generator.free_uid(mine[i % 500]);
+          mine[i % 500] = generator.get_uid();
+        }
+      }
+    }));
+  }
+  for (auto& th : threads) th.join();
+  std::set<UINT> in_use;
+  for (auto& mine : ids) {
+    for (auto id : mine) {
+      if ((id == 0) || !in_use.insert(id).second) {
+        std::cerr << "ID " << (uint64_t) id << " generated twice, "
+                  << sizeof(UINT) * 8 << " bits, " << nb_shards << " shards"
+                  << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Each thread generates an ID and frees its oldest one
+template<template<class> class G, class UINT>
+static void bench(const char* name, const uint32_t nb_shards) {
+  std::cout << name << ":" << std::endl;
+  for (int nb_threads = 1; nb_threads <= 64; nb_threads *= 2) {
+    G<UINT> generator(nb_shards);
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> count(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nb_threads; t++) {
+      threads.push_back(std::thread([&] {
+        UINT ids[BENCH_WINDOW];
+        for (int i = 0; i < BENCH_WINDOW; i++) ids[i] = generator.get_uid();
+        uint64_t nb = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+          for (int i = 0; i < BENCH_WINDOW; i++) {
+            generator.free_uid(ids[i]);
+            ids[i] = generator.get_uid();
+          }
+          nb += BENCH_WINDOW;
+        }
+        count += nb;
+      }));
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(
+        std::chrono::duration<double>(BENCH_DURATION_S));
+    stop = true;
+    for (auto& th : threads) th.join();
+    double s = std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+    std::cout << "  " << nb_threads << " threads: " << (count / s) / 1e6
+              << " M IDs/s" << std::endl;
+  }
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  if (!check<uint16_t>(1, 1) || !check<uint16_t>(UINT_GENERATOR_SHARDS, 1) ||
+      !check<uint16_t>(UINT_GENERATOR_SHARDS, 8) ||
+      !check<uint32_t>(UINT_GENERATOR_SHARDS, 8) ||
+      !check<uint64_t>(UINT_GENERATOR_SHARDS, 8))
+    return 1;
+  std::cout << "Hardware threads: " << std::thread::hardware_concurrency()
+            << std::endl;
+  bench<legacy_uint_generator, uint32_t>("previous, 32 bits", 1);
+  bench<util::uint_generator, uint32_t>("1 shard, 32 bits", 1);
+  bench<util::uint_generator, uint32_t>(
+      "sharded, 32 bits (scid, TEID)", UINT_GENERATOR_SHARDS);
+  bench<util::uint_generator, uint64_t>(
+      "sharded, 64 bits (SEID)", UINT_GENERATOR_SHARDS);
+  return 0;
+}
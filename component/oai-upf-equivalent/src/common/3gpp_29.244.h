@@ -927,6 +927,8 @@ typedef struct usage_report_trigger_s {
   uint16_t liusa : 1;
   uint16_t timqu : 1;
   uint16_t volqu : 1;
+  uint16_t tebur : 1;
+  uint16_t evequ : 1;
 } usage_report_trigger_t;
 
 //-------------------------------------
@@ -942,13 +944,19 @@ typedef struct measurement_period_s {
 //-------------------------------------
 // 8.2.44 Volume Measurement
 typedef struct volume_measurement_s {
-  uint8_t spare : 5;
+  uint8_t spare : 2;
+  uint8_t dlnop : 1;
+  uint8_t ulnop : 1;
+  uint8_t tonop : 1;
   uint8_t dlvol : 1;
   uint8_t ulvol : 1;
   uint8_t tovol : 1;
   uint64_t total_volume;
   uint64_t uplink_volume;
   uint64_t downlink_volume;
+  uint64_t total_nop;
+  uint64_t uplink_nop;
+  uint64_t downlink_nop;
 } volume_measurement_t;
 
 //-------------------------------------
@@ -0,0 +1,134 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file gtpu_template.hpp
+   \brief Precomputed G-PDU headers, one per tunnel
+   \date 2021
+*/
+
+#ifndef FILE_GTPU_TEMPLATE_HPP_SEEN
+#define FILE_GTPU_TEMPLATE_HPP_SEEN
+
+#include <endian.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "3gpp_29.281.h"
+
+// Mandatory part, counted out of the message length (TS 29.281 5.1)
+#define GTPU_MANDATORY_HEADER_LEN 8
+// Mandatory part, sequence number, N-PDU number, next extension type and one
+// PDU session container
+#define GTPU_G_PDU_TEMPLATE_MAX_LEN 16
+
+namespace gtpv1u {
+
+// Everything but the length is known when the FAR is installed
+typedef struct gtpu_g_pdu_template_s {
+  alignas(16) uint8_t header[GTPU_G_PDU_TEMPLATE_MAX_LEN];
+  uint8_t header_len;  // 8, or 16 with a PDU session container
+  socklen_t peer_addr_len;
+  union {
+    struct sockaddr sa;
+    struct sockaddr_in in4;
+    struct sockaddr_in6 in6;
+  } peer;
+} gtpu_g_pdu_template_t;
+
+//------------------------------------------------------------------------------
+inline void gtpu_g_pdu_template_init(
+    gtpu_g_pdu_template_t& t, const teid_t teid, const bool ext_hdr,
+    const uint8_t qfi) {
+  memset(t.header, 0, sizeof(t.header));
+  // version 1, protocol type GTP, E flag
+  t.header[0] = 0x30 | (ext_hdr ? 0x04 : 0x00);
+  t.header[1] = GTPU_G_PDU;
+  const uint32_t teid_be = htobe32(teid);
+  memcpy(&t.header[4], &teid_be, sizeof(teid_be));
+  t.header_len = GTPU_MANDATORY_HEADER_LEN;
+  if (ext_hdr) {
+    // sequence number and N-PDU number left to 0
+    t.header[11] = GTPU_PDU_SESSION_CONTAINER;
+    t.header[12] = 0x01;  // length in 4 octets units
+    t.header[13] = GTPU_DL_PDU_SESSION_INFORMATION;
+    t.header[14] = qfi;
+    t.header[15] = GTPU_NO_MORE_EXTENSION_HEADER;
+    t.header_len = GTPU_G_PDU_TEMPLATE_MAX_LEN;
+  }
+}
+
+//------------------------------------------------------------------------------
+inline void gtpu_g_pdu_template_init(
+    gtpu_g_pdu_template_t& t, const struct in_addr& peer_addr,
+    const uint16_t peer_port, const teid_t teid, const bool ext_hdr,
+    const uint8_t qfi) {
+  gtpu_g_pdu_template_init(t, teid, ext_hdr, qfi);
+  memset(&t.peer, 0, sizeof(t.peer));
+  t.peer.in4.sin_family = AF_INET;
+  t.peer.in4.sin_addr   = peer_addr;
+  t.peer.in4.sin_port   = htobe16(peer_port);
+  t.peer_addr_len       = sizeof(struct sockaddr_in);
+}
+
+//------------------------------------------------------------------------------
+inline void gtpu_g_pdu_template_init(
+    gtpu_g_pdu_template_t& t, const struct in6_addr& peer_addr,
+    const uint16_t peer_port, const teid_t teid, const bool ext_hdr,
+    const uint8_t qfi) {
+  gtpu_g_pdu_template_init(t, teid, ext_hdr, qfi);
+  memset(&t.peer, 0, sizeof(t.peer));
+  t.peer.in6.sin6_family = AF_INET6;
+  t.peer.in6.sin6_addr   = peer_addr;
+  t.peer.in6.sin6_port   = htobe16(peer_port);
+  t.peer_addr_len        = sizeof(struct sockaddr_in6);
+}
+
+//------------------------------------------------------------------------------
+// Write the G-PDU header of a payload of payload_len bytes in dst, that must
+// have room for GTPU_G_PDU_TEMPLATE_MAX_LEN bytes. Return the header length.
+inline std::size_t gtpu_g_pdu_encap(
+    const gtpu_g_pdu_template_t& t, uint8_t* const dst,
+    const uint16_t payload_len) {
+#if defined(__SSE2__)
+  _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(dst),
+      _mm_load_si128(reinterpret_cast<const __m128i*>(t.header)));
+#elif defined(__ARM_NEON)
+  vst1q_u8(dst, vld1q_u8(t.header));
+#else
+  memcpy(dst, t.header, GTPU_G_PDU_TEMPLATE_MAX_LEN);
+#endif
+  const uint16_t length =
+      htobe16(payload_len + t.header_len - GTPU_MANDATORY_HEADER_LEN);
+  memcpy(&dst[2], &length, sizeof(length));
+  return t.header_len;
+}
+}  // namespace gtpv1u
+
+#endif /* FILE_GTPU_TEMPLATE_HPP_SEEN */
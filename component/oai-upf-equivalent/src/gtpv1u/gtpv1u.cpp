@@ -65,7 +65,8 @@ extern itti_mw* itti_inst;
 //------------------------------------------------------------------------------
 gtpu_l4_stack::gtpu_l4_stack(
     const struct in_addr& address, const uint16_t port_num,
-    const util::thread_sched_params& sched_params, const bool send_ext_hdr)
+    const util::thread_sched_params& sched_params, const bool send_ext_hdr,
+    const udp_batch_params_t& batch_params)
     : udp_s(udp_server(address, port_num)), send_ext_hdr(send_ext_hdr) {
   Logger::gtpv1_u().info(
       "gtpu_l4_stack created listening to %s:%d",
@@ -75,12 +76,14 @@ gtpu_l4_stack::gtpu_l4_stack(
   srand(time(NULL));
   seq_num         = rand() & 0x7FFFFFFF;
   restart_counter = 0;
+  udp_s.set_batch_params(batch_params);
   udp_s.start_receive(this, sched_params);
 }
 //------------------------------------------------------------------------------
 gtpu_l4_stack::gtpu_l4_stack(
     const struct in6_addr& address, const uint16_t port_num,
-    const util::thread_sched_params& sched_params, const bool send_ext_hdr)
+    const util::thread_sched_params& sched_params, const bool send_ext_hdr,
+    const udp_batch_params_t& batch_params)
     : udp_s(udp_server(address, port_num)), send_ext_hdr(send_ext_hdr) {
   Logger::gtpv1_u().info(
       "gtpu_l4_stack created listening to %s:%d",
@@ -90,12 +93,14 @@ gtpu_l4_stack::gtpu_l4_stack(
   srand(time(NULL));
   seq_num         = rand() & 0x7FFFFFFF;
   restart_counter = 0;
+  udp_s.set_batch_params(batch_params);
   udp_s.start_receive(this, sched_params);
 }
 //------------------------------------------------------------------------------
 gtpu_l4_stack::gtpu_l4_stack(
     char* address, const uint16_t port_num,
-    const util::thread_sched_params& sched_params, const bool send_ext_hdr)
+    const util::thread_sched_params& sched_params, const bool send_ext_hdr,
+    const udp_batch_params_t& batch_params)
     : udp_s(udp_server(address, port_num)), send_ext_hdr(send_ext_hdr) {
   Logger::gtpv1_u().info(
       "gtpu_l4_stack created listening to %s:%d", address, port_num);
@@ -104,6 +109,7 @@ gtpu_l4_stack::gtpu_l4_stack(
   srand(time(NULL));
   seq_num         = rand() & 0x7FFFFFFF;
   restart_counter = 0;
+  udp_s.set_batch_params(batch_params);
   udp_s.start_receive(this, sched_params);
 }
 
@@ -157,84 +163,37 @@ void gtpu_l4_stack::handle_receive_message_cb(
     const socklen_t& r_endpoint_addr_len, const task_id_t& task_id, bool& error,
     uint64_t& gtpc_tx_id) {}
 
+//------------------------------------------------------------------------------
+void gtpu_l4_stack::build_g_pdu_template(
+    const struct in_addr& peer_addr, const uint16_t peer_port,
+    const teid_t teid, const uint8_t qfi, gtpu_g_pdu_template_t& t) const {
+  gtpu_g_pdu_template_init(t, peer_addr, peer_port, teid, send_ext_hdr, qfi);
+}
+//------------------------------------------------------------------------------
+void gtpu_l4_stack::build_g_pdu_template(
+    const struct in6_addr& peer_addr, const uint16_t peer_port,
+    const teid_t teid, const uint8_t qfi, gtpu_g_pdu_template_t& t) const {
+  gtpu_g_pdu_template_init(t, peer_addr, peer_port, teid, send_ext_hdr, qfi);
+}
 //------------------------------------------------------------------------------
 void gtpu_l4_stack::send_g_pdu(
     const struct sockaddr_in& peer_addr, const teid_t teid, const char* payload,
     const ssize_t payload_len, uint8_t qfi) {
-  if (!send_ext_hdr) {
-    struct gtpuhdr* gtpuhdr = reinterpret_cast<struct gtpuhdr*>(
-        reinterpret_cast<uintptr_t>(payload) -
-        (uintptr_t) sizeof(struct gtpuhdr) + 4);
-    gtpuhdr->spare          = 0;
-    gtpuhdr->e              = 0;
-    gtpuhdr->s              = 0;
-    gtpuhdr->pn             = 0;
-    gtpuhdr->pt             = 1;
-    gtpuhdr->version        = 1;
-    gtpuhdr->message_type   = GTPU_G_PDU;
-    gtpuhdr->message_length = htobe16(payload_len);
-    gtpuhdr->teid           = htobe32(teid);
-    // gtpuhdr->pdu_number     = 0x00;
-    // gtpuhdr->sequence       = 0x00;
-    // gtpuhdr->next_ext_type  = GTPU_NO_MORE_EXTENSION_HEADER;
-    udp_s.async_send_to(
-        reinterpret_cast<const char*>(gtpuhdr),
-        payload_len + sizeof(struct gtpuhdr) - 4, peer_addr);
-  } else {
-    struct gtpuhdr* gtpuhdr = reinterpret_cast<struct gtpuhdr*>(
-        reinterpret_cast<uintptr_t>(payload) -
-        (uintptr_t) sizeof(struct gtpuhdr) -
-        (uintptr_t) sizeof(struct gtpu_extn_pdu_session_container));
-    gtpuhdr->spare          = 0;
-    gtpuhdr->e              = 1;
-    gtpuhdr->s              = 0;
-    gtpuhdr->pn             = 0;
-    gtpuhdr->pt             = 1;
-    gtpuhdr->version        = 1;
-    gtpuhdr->message_type   = GTPU_G_PDU;
-    gtpuhdr->message_length = htobe16(
-        payload_len + sizeof(struct gtpu_extn_pdu_session_container) + 4);
-    gtpuhdr->teid          = htobe32(teid);
-    gtpuhdr->pdu_number    = 0x00;
-    gtpuhdr->sequence      = 0x00;
-    gtpuhdr->next_ext_type = GTPU_PDU_SESSION_CONTAINER;
-
-    struct gtpu_extn_pdu_session_container* gtpu_ext_hdr =
-        reinterpret_cast<struct gtpu_extn_pdu_session_container*>(
-            reinterpret_cast<uintptr_t>(payload) -
-            (uintptr_t) sizeof(struct gtpu_extn_pdu_session_container));
-
-    gtpu_ext_hdr->message_length = 0x01;
-    gtpu_ext_hdr->pdu_type       = GTPU_DL_PDU_SESSION_INFORMATION;
-    gtpu_ext_hdr->qfi            = qfi;  // Taken from uplink PDR
-    gtpu_ext_hdr->next_ext_type  = GTPU_NO_MORE_EXTENSION_HEADER;
-
-    udp_s.async_send_to(
-        reinterpret_cast<const char*>(gtpuhdr),
-        payload_len + sizeof(struct gtpuhdr) +
-            sizeof(struct gtpu_extn_pdu_session_container),
-        peer_addr);
-  }
+  gtpu_g_pdu_template_t t = {};
+  gtpu_g_pdu_template_init(t, teid, send_ext_hdr, qfi);
+  t.peer.in4      = peer_addr;
+  t.peer_addr_len = sizeof(struct sockaddr_in);
+  send_g_pdu(t, payload, payload_len);
 }
 //------------------------------------------------------------------------------
 void gtpu_l4_stack::send_g_pdu(
     const struct sockaddr_in6& peer_addr, const teid_t teid,
-    const char* payload, const ssize_t payload_len) {
-  struct gtpuhdr* gtpuhdr = reinterpret_cast<struct gtpuhdr*>(
-      reinterpret_cast<uintptr_t>(payload) -
-      (uintptr_t) sizeof(struct gtpuhdr));
-  gtpuhdr->spare          = 0;
-  gtpuhdr->e              = 0;
-  gtpuhdr->s              = 0;
-  gtpuhdr->pn             = 0;
-  gtpuhdr->pt             = 1;
-  gtpuhdr->version        = 1;
-  gtpuhdr->message_type   = GTPU_G_PDU;
-  gtpuhdr->message_length = htobe16(payload_len);
-  gtpuhdr->teid           = htobe32(teid);
-  udp_s.async_send_to(
-      reinterpret_cast<const char*>(gtpuhdr),
-      payload_len + sizeof(struct gtpuhdr), peer_addr);
+    const char* payload, const ssize_t payload_len, uint8_t qfi) {
+  gtpu_g_pdu_template_t t = {};
+  gtpu_g_pdu_template_init(t, teid, send_ext_hdr, qfi);
+  t.peer.in6      = peer_addr;
+  t.peer_addr_len = sizeof(struct sockaddr_in6);
+  send_g_pdu(t, payload, payload_len);
 }
 //------------------------------------------------------------------------------
 void gtpu_l4_stack::send_response(const gtpv1u_echo_response& gtp_ies) {
@@ -29,6 +29,7 @@
 #define FILE_GTPV1U_HPP_SEEN
 
 #include "3gpp_29.281.hpp"
+#include "gtpu_template.hpp"
 #include "itti.hpp"
 #include "msg_gtpv1u.hpp"
 #include "thread_sched.hpp"
@@ -73,13 +74,16 @@ class gtpu_l4_stack : public udp_application {
   static const uint8_t version = 1;
   gtpu_l4_stack(
       const struct in_addr& address, const uint16_t port_num,
-      const util::thread_sched_params& sched_params, const bool send_ext_hdr);
+      const util::thread_sched_params& sched_params, const bool send_ext_hdr,
+      const udp_batch_params_t& batch_params);
   gtpu_l4_stack(
       const struct in6_addr& address, const uint16_t port_num,
-      const util::thread_sched_params& sched_params, const bool send_ext_hdr);
+      const util::thread_sched_params& sched_params, const bool send_ext_hdr,
+      const udp_batch_params_t& batch_params);
   gtpu_l4_stack(
       char* ip_address, const uint16_t port_num,
-      const util::thread_sched_params& sched_params, const bool send_ext_hdr);
+      const util::thread_sched_params& sched_params, const bool send_ext_hdr,
+      const udp_batch_params_t& batch_params);
   virtual void handle_receive(
       char* recv_buffer, const std::size_t bytes_transferred,
       const endpoint& r_endpoint);
@@ -93,7 +97,33 @@ class gtpu_l4_stack : public udp_application {
       const char* payload, const ssize_t payload_len, uint8_t qfi);
   void send_g_pdu(
       const struct sockaddr_in6& peer_addr, const teid_t teid,
-      const char* payload, const ssize_t payload_len);
+      const char* payload, const ssize_t payload_len, uint8_t qfi);
+
+  // Header and destination of the G-PDUs of a tunnel, built once per FAR
+  void build_g_pdu_template(
+      const struct in_addr& peer_addr, const uint16_t peer_port,
+      const teid_t teid, const uint8_t qfi, gtpu_g_pdu_template_t& t) const;
+  void build_g_pdu_template(
+      const struct in6_addr& peer_addr, const uint16_t peer_port,
+      const teid_t teid, const uint8_t qfi, gtpu_g_pdu_template_t& t) const;
+  // The payload is sent in place and never written (scatter-gather)
+  void send_g_pdu(
+      const gtpu_g_pdu_template_t& t, const char* payload,
+      const ssize_t payload_len) {
+    alignas(16) uint8_t header[GTPU_G_PDU_TEMPLATE_MAX_LEN];
+    const std::size_t header_len = gtpu_g_pdu_encap(t, header, payload_len);
+    udp_s.async_send_to(
+        reinterpret_cast<const char*>(header), header_len, payload,
+        payload_len, &t.peer.sa, t.peer_addr_len);
+  };
+
+  // G-PDUs sent by the calling thread until flush_g_pdu_batch() are
+  // transmitted together, payload buffers must remain valid until then.
+  void begin_g_pdu_batch() { udp_s.begin_send_batch(); };
+  void flush_g_pdu_batch() { udp_s.flush_send_batch(); };
+  udp_batch_stats_t get_batch_stats() const {
+    return udp_s.get_batch_stats();
+  };
 
   void send_response(const gtpv1u_echo_response& gtp_ies);
   void send_indication(const gtpv1u_error_indication& gtp_ies);
@@ -34,12 +34,17 @@
 #include <memory>
 #include <mutex>
 #include <queue>
-#include <set>
 #include <stdint.h>
 #include <thread>
+#include <vector>
+#include "itti_mailbox.hpp"
 #include "itti_msg.hpp"
+#include "itti_timer_wheel.hpp"
 #include "thread_sched.hpp"
 
+// Period of the mailbox counters of the tasks in the log
+#define ITTI_TASK_STATS_PERIOD_SECONDS 60
+
 typedef volatile enum task_state_s {
   TASK_STATE_NOT_CONFIGURED,
   TASK_STATE_STARTING,
@@ -48,69 +53,38 @@ typedef volatile enum task_state_s {
   TASK_STATE_MAX,
 } task_state_t;
 
-typedef uint32_t timer_id_t;
-#define ITTI_INVALID_TIMER_ID (timer_id_t) 0
-
-class itti_timer {
- public:
-  itti_timer(
-      const timer_id_t id, const task_id_t task_id, const uint32_t interval_sec,
-      const uint32_t interval_us, uint64_t arg1_user, uint64_t arg2_user)
-      : id(id), task_id(task_id), arg1_user(arg1_user), arg2_user(arg2_user) {
-    time_out = std::chrono::system_clock::now() +
-               std::chrono::seconds(interval_sec) +
-               std::chrono::microseconds(interval_us);
-  }
-  itti_timer(
-      const timer_id_t id, const task_id_t task_id,
-      const std::chrono::system_clock::time_point time_out, uint64_t arg1_user,
-      uint64_t arg2_user)
-      : id(id),
-        task_id(task_id),
-        time_out(time_out),
-        arg1_user(arg1_user),
-        arg2_user(arg2_user) {}
-  itti_timer(const itti_timer& t)
-      : id(t.id),
-        task_id(t.task_id),
-        time_out(t.time_out),
-        arg1_user(t.arg1_user),
-        arg2_user(t.arg2_user) {}
-  // itti_timer(itti_timer&& t) noexcept : id(std::move(t.id)),
-  // task_id(std::move(t.task_id)) , time_out(std::move(t.time_out)) {}
-
-  bool operator<(const itti_timer& t) const { return time_out < t.time_out; }
-  ~itti_timer() {}
-  timer_id_t id;
-  task_id_t task_id;
-  std::chrono::system_clock::time_point time_out;
-  uint64_t arg1_user;
-  uint64_t arg2_user;
-};
-
-//------------------------------------------------------------------------------
-struct timer_comparator {
-  bool operator()(const itti_timer& left, const itti_timer& right) const {
-    return (left.time_out < right.time_out);
-  }
-};
-
 class itti_task_ctxt {
  public:
   explicit itti_task_ctxt(const task_id_t task_id)
       : task_id(task_id),
         m_state(),
         task_state(TASK_STATE_STARTING),
-        msg_queue(),
+        mailbox(),
+        sleeping(false),
+        batch(),
+        batch_pos(0),
         m_queue(),
-        c_queue() {}
+        c_queue() {
+    batch.reserve(ITTI_MAILBOX_BATCH);
+  }
   ~itti_task_ctxt() {}
 
+  /*
+   * Queue a message, wake the task thread up if it sleeps. Return false if
+   * the message is dropped, the mailbox being full
+   */
+  bool push(const std::shared_ptr<itti_msg>& message);
+  /*
+   * Task thread only, return when the mailbox is not empty anymore
+   */
+  void wait();
+
   const task_id_t task_id;
   /*
    * pthread associated with the thread
    */
-  // std::thread::id                      thread_id;
+  // set by notify_task_ready
+  std::thread::id thread_id;
   std::thread thread;
   /*
    * State of the thread
@@ -118,7 +92,12 @@ class itti_task_ctxt {
   std::mutex m_state;
   volatile task_state_t task_state;
 
-  std::queue<std::shared_ptr<itti_msg>> msg_queue;
+  itti_mailbox mailbox;
+  std::atomic<bool> sleeping;
+  // messages taken out of the mailbox, not returned yet by receive_msg
+  std::vector<std::shared_ptr<itti_msg>> batch;
+  std::size_t batch_pos;
+  // only used while the task thread sleeps
   std::mutex m_queue;
   std::condition_variable c_queue;
 };
@@ -138,17 +117,19 @@ class itti_mw {
   std::atomic<int> created_tasks;
   std::atomic<int> ready_tasks;
 
-  std::set<itti_timer, timer_comparator> timers;
-  itti_timer current_timer;
+  // tick 0 of the timer wheel
+  const std::chrono::steady_clock::time_point timer_epoch;
+  itti_timer_wheel timers;
   std::mutex m_timers;
   std::condition_variable c_timers;
-
-  std::mutex m_timeout;
-  std::condition_variable c_timeout;
+  // tick the timer thread sleeps until, 0 while it runs: timer_setup only
+  // has to wake it up for an earlier timer
+  uint64_t timer_wakeup_tick;
 
   bool terminate;
 
   static void timer_manager_task(const util::thread_sched_params& sched_params);
+  uint64_t timer_elapsed_us() const;
 
  public:
   itti_mw();
@@ -169,7 +150,7 @@ class itti_mw {
 
   /** \brief Send a message to a task (could be itself)
    \param message message to send
-   @returns -1 on failure, 0 otherwise
+   @returns -1 on failure (e.g. message dropped, full mailbox), 0 otherwise
    **/
   int send_msg(std::shared_ptr<itti_msg> message);
 
@@ -186,6 +167,28 @@ class itti_mw {
    **/
   std::shared_ptr<itti_msg> poll_msg(task_id_t task_id);
 
+  /** \brief Retrieves all the messages available (at least one) in the queue
+   * associated to task_id, up to ITTI_MAILBOX_BATCH.
+   * If the queue is empty, the thread is blocked till a new message arrives.
+   \param task_id Task ID of the receiving task
+   \param msgs Received messages, appended
+   @returns number of messages received
+   **/
+  std::size_t receive_msgs(
+      task_id_t task_id, std::vector<std::shared_ptr<itti_msg>>& msgs);
+
+  /** \brief Get the queue counters of a task
+   \param task_id Task ID
+   \param stats Counters
+   @returns -1 on failure, 0 otherwise
+   **/
+  int get_task_stats(task_id_t task_id, itti_task_stats_t& stats) const;
+
+  /** \brief Log the queue counters of every task, done every
+   * ITTI_TASK_STATS_PERIOD_SECONDS and when the tasks end
+   **/
+  void log_task_stats() const;
+
   /** \brief Start thread associated to the task
    * \param task_id task to start
    * \param start_routine entry point for the task
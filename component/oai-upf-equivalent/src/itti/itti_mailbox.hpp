@@ -0,0 +1,205 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+/*! \file itti_mailbox.hpp
+   \brief Bounded lock-free message queue of an ITTI task, any thread sends,
+          only the task receives
+   \date 2021
+*/
+#ifndef SRC_OAI_ITTI_ITTI_MAILBOX_HPP_INCLUDED_
+#define SRC_OAI_ITTI_ITTI_MAILBOX_HPP_INCLUDED_
+
+#include <stdint.h>
+#include <time.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "itti_msg.hpp"
+
+// Messages pending per task, a sender waits when the mailbox is full
+#define ITTI_MAILBOX_SIZE 16384
+// Wait of a sender for room in a full mailbox before the message is dropped
+#define ITTI_MAILBOX_FULL_WAIT_US 100000
+// Busy polls of an empty mailbox before the task thread sleeps
+#define ITTI_MAILBOX_SPIN 1024
+// Messages taken out of the mailbox at once by receive_msg
+#define ITTI_MAILBOX_BATCH 32
+
+typedef struct itti_task_stats_s {
+  uint64_t sent;      // messages pushed in the mailbox
+  uint64_t received;  // messages taken out by the task
+  uint64_t depth;     // messages waiting now
+  uint64_t max_depth;
+  uint64_t full;     // senders that had to wait for room
+  uint64_t dropped;  // messages lost, no room in time
+  uint64_t latency_avg_ns;
+  uint64_t latency_max_ns;
+} itti_task_stats_t;
+
+//------------------------------------------------------------------------------
+static inline void itti_cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t itti_now_ns() {
+  struct timespec ts = {};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Sequence numbered ring (D. Vyukov's bounded queue): a sender claims a slot
+// with a CAS on tail, the receiver owns head and needs no atomic RMW.
+class itti_mailbox {
+ public:
+  itti_mailbox()
+      : tail(0),
+        full(0),
+        dropped(0),
+        head(0),
+        max_depth(0),
+        latency_sum_ns(0),
+        latency_max_ns(0),
+        slots(ITTI_MAILBOX_SIZE) {
+    for (uint64_t i = 0; i < ITTI_MAILBOX_SIZE; i++) {
+      slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+  itti_mailbox(itti_mailbox const&) = delete;
+  void operator=(itti_mailbox const&) = delete;
+
+  // Any thread. Drop the message and return false if the mailbox is still
+  // full after ITTI_MAILBOX_FULL_WAIT_US, or at once if !may_wait
+  bool push(const std::shared_ptr<itti_msg>& msg, const bool may_wait) {
+    uint64_t pos         = tail.load(std::memory_order_relaxed);
+    uint64_t deadline_ns = 0;
+    slot_t* slot         = nullptr;
+    while (true) {
+      slot         = &slots[pos & (ITTI_MAILBOX_SIZE - 1)];
+      uint64_t seq = slot->seq.load(std::memory_order_acquire);
+      int64_t dif  = (int64_t) seq - (int64_t) pos;
+      if (dif == 0) {
+        if (tail.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (dif < 0) {
+        // full, back pressure for a while rather than losing a message
+        const uint64_t now_ns = itti_now_ns();
+        if (!deadline_ns) {
+          full.fetch_add(1, std::memory_order_relaxed);
+          deadline_ns = now_ns + ITTI_MAILBOX_FULL_WAIT_US * 1000ULL;
+        }
+        if (!may_wait || (now_ns >= deadline_ns)) {
+          dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+        std::this_thread::yield();
+        pos = tail.load(std::memory_order_relaxed);
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+    slot->msg        = msg;
+    slot->enqueue_ns = itti_now_ns();
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Task thread only, return the number of messages appended to msgs
+  std::size_t pop(
+      std::vector<std::shared_ptr<itti_msg>>& msgs, const std::size_t max) {
+    const uint64_t first = head.load(std::memory_order_relaxed);
+    uint64_t pos         = first;
+    uint64_t now         = 0;
+    while (pos - first < max) {
+      slot_t* slot = &slots[pos & (ITTI_MAILBOX_SIZE - 1)];
+      if (slot->seq.load(std::memory_order_acquire) != pos + 1) break;
+      if (!now) now = itti_now_ns();
+      const uint64_t latency = now - slot->enqueue_ns;
+      latency_sum_ns.store(
+          latency_sum_ns.load(std::memory_order_relaxed) + latency,
+          std::memory_order_relaxed);
+      if (latency > latency_max_ns.load(std::memory_order_relaxed))
+        latency_max_ns.store(latency, std::memory_order_relaxed);
+      msgs.push_back(std::move(slot->msg));
+      slot->seq.store(pos + ITTI_MAILBOX_SIZE, std::memory_order_release);
+      pos++;
+    }
+    if (pos != first) {
+      const uint64_t depth = tail.load(std::memory_order_relaxed) - first;
+      if (depth > max_depth.load(std::memory_order_relaxed))
+        max_depth.store(depth, std::memory_order_relaxed);
+      head.store(pos, std::memory_order_relaxed);
+    }
+    return pos - first;
+  }
+
+  // Task thread only
+  bool empty() const {
+    const uint64_t pos = head.load(std::memory_order_relaxed);
+    return slots[pos & (ITTI_MAILBOX_SIZE - 1)].seq.load(
+               std::memory_order_acquire) != pos + 1;
+  }
+
+  // Any thread, approximate
+  void get_stats(itti_task_stats_t& stats) const {
+    stats.received  = head.load(std::memory_order_relaxed);
+    stats.sent      = tail.load(std::memory_order_relaxed);
+    stats.depth     = stats.sent - stats.received;
+    stats.max_depth = max_depth.load(std::memory_order_relaxed);
+    stats.full      = full.load(std::memory_order_relaxed);
+    stats.dropped   = dropped.load(std::memory_order_relaxed);
+    stats.latency_avg_ns =
+        stats.received ?
+            latency_sum_ns.load(std::memory_order_relaxed) / stats.received :
+            0;
+    stats.latency_max_ns = latency_max_ns.load(std::memory_order_relaxed);
+  }
+
+ private:
+  typedef struct slot_s {
+    std::atomic<uint64_t> seq;
+    uint64_t enqueue_ns;
+    std::shared_ptr<itti_msg> msg;
+  } slot_t;
+  static_assert(
+      (ITTI_MAILBOX_SIZE & (ITTI_MAILBOX_SIZE - 1)) == 0,
+      "ITTI_MAILBOX_SIZE must be a power of 2");
+
+  // senders
+  alignas(64) std::atomic<uint64_t> tail;
+  std::atomic<uint64_t> full;
+  std::atomic<uint64_t> dropped;
+  // receiver, written by the task thread only
+  alignas(64) std::atomic<uint64_t> head;
+  std::atomic<uint64_t> max_depth;
+  std::atomic<uint64_t> latency_sum_ns;
+  std::atomic<uint64_t> latency_max_ns;
+  alignas(64) std::vector<slot_t> slots;
+};
+
+#endif /* SRC_OAI_ITTI_ITTI_MAILBOX_HPP_INCLUDED_ */
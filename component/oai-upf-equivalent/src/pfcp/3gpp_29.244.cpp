@@ -368,39 +368,39 @@ pfcp_ie* pfcp_ie::new_pfcp_ie_from_stream(std::istream& is) {
         //        return ie;
         //      }
         //      break;
-        //    case PFCP_IE_MEASUREMENT_METHOD: {
-        //        pfcp_measurement_method_ie *ie = new
-        //        pfcp_measurement_method_ie(tlv); ie->load_from(is); return ie;
-        //      }
-        //      break;
-        //    case PFCP_IE_USAGE_REPORT_TRIGGER: {
-        //        pfcp_usage_report_trigger_ie *ie = new
-        //        pfcp_usage_report_trigger_ie(tlv); ie->load_from(is); return
-        //        ie;
-        //      }
-        //      break;
-        //    case PFCP_IE_MEASUREMENT_PERIOD: {
-        //        pfcp_measurement_period_ie *ie = new
-        //        pfcp_measurement_period_ie(tlv); ie->load_from(is); return ie;
-        //      }
-        //      break;
+      case PFCP_IE_MEASUREMENT_METHOD: {
+        pfcp_measurement_method_ie* ie = new pfcp_measurement_method_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
+      case PFCP_IE_USAGE_REPORT_TRIGGER: {
+        pfcp_usage_report_trigger_ie* ie =
+            new pfcp_usage_report_trigger_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
+      case PFCP_IE_MEASUREMENT_PERIOD: {
+        pfcp_measurement_period_ie* ie = new pfcp_measurement_period_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
         //    case PFCP_IE_FQ_CSID: {
         //        pfcp_fq_csid_ie *ie = new pfcp_fq_csid_ie(tlv);
         //        ie->load_from(is);
         //        return ie;
         //      }
         //      break;
-        //    case PFCP_IE_VOLUME_MEASUREMENT: {
-        //        pfcp_volume_measurement_ie *ie = new
-        //        pfcp_volume_measurement_ie(tlv); ie->load_from(is); return ie;
-        //      }
-        //      break;
-        //    case PFCP_IE_DURATION_MEASUREMENT: {
-        //        pfcp_duration_measurement_ie *ie = new
-        //        pfcp_duration_measurement_ie(tlv); ie->load_from(is); return
-        //        ie;
-        //      }
-        //      break;
+      case PFCP_IE_VOLUME_MEASUREMENT: {
+        pfcp_volume_measurement_ie* ie = new pfcp_volume_measurement_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
+      case PFCP_IE_DURATION_MEASUREMENT: {
+        pfcp_duration_measurement_ie* ie =
+            new pfcp_duration_measurement_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
         //    case PFCP_IE_APPLICATION_DETECTION_INFORMATION: {
         //        pfcp_application_detection_information_ie *ie = new
         //        pfcp_application_detection_information_ie(tlv);
@@ -408,18 +408,17 @@ pfcp_ie* pfcp_ie::new_pfcp_ie_from_stream(std::istream& is) {
         //        return ie;
         //      }
         //      break;
-        //    case PFCP_IE_TIME_OF_FIRST_PACKET: {
-        //        pfcp_time_of_first_packet_ie *ie = new
-        //        pfcp_time_of_first_packet_ie(tlv); ie->load_from(is); return
-        //        ie;
-        //      }
-        //      break;
-        //    case PFCP_IE_TIME_OF_LAST_PACKET: {
-        //        pfcp_time_of_last_packet_ie *ie = new
-        //        pfcp_time_of_last_packet_ie(tlv); ie->load_from(is); return
-        //        ie;
-        //      }
-        //      break;
+      case PFCP_IE_TIME_OF_FIRST_PACKET: {
+        pfcp_time_of_first_packet_ie* ie =
+            new pfcp_time_of_first_packet_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
+      case PFCP_IE_TIME_OF_LAST_PACKET: {
+        pfcp_time_of_last_packet_ie* ie = new pfcp_time_of_last_packet_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
         //    case PFCP_IE_QUOTA_HOLDING_TIME: {
         //        pfcp_quota_holding_time_ie *ie = new
         //        pfcp_quota_holding_time_ie(tlv); ie->load_from(is); return ie;
@@ -431,59 +430,50 @@ pfcp_ie* pfcp_ie::new_pfcp_ie_from_stream(std::istream& is) {
         //        return ie;
         //      }
         //      break;
-        //    case PFCP_IE_VOLUME_QUOTA: {
-        //        pfcp_volume_quota_ie *ie = new pfcp_volume_quota_ie(tlv);
-        //        ie->load_from(is);
-        //        return ie;
-        //      }
-        //      break;
-        //    case PFCP_IE_TIME_QUOTA: {
-        //        pfcp_time_quota_ie *ie = new pfcp_time_quota_ie(tlv);
-        //        ie->load_from(is);
-        //        return ie;
-        //      }
-        //      break;
-        //    case PFCP_IE_START_TIME: {
-        //        pfcp_start_time_ie *ie = new pfcp_start_time_ie(tlv);
-        //        ie->load_from(is);
-        //        return ie;
-        //      }
-        //      break;
-        //    case PFCP_IE_END_TIME: {
-        //        pfcp_end_time_ie *ie = new pfcp_end_time_ie(tlv);
-        //        ie->load_from(is);
-        //        return ie;
-        //      }
-        //      break;
+      case PFCP_IE_VOLUME_QUOTA: {
+        pfcp_volume_quota_ie* ie = new pfcp_volume_quota_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
+      case PFCP_IE_TIME_QUOTA: {
+        pfcp_time_quota_ie* ie = new pfcp_time_quota_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
+      case PFCP_IE_START_TIME: {
+        pfcp_start_time_ie* ie = new pfcp_start_time_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
+      case PFCP_IE_END_TIME: {
+        pfcp_end_time_ie* ie = new pfcp_end_time_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
         //    case PFCP_IE_QUERY_URR: {
         //        pfcp_query_urr_ie *ie = new pfcp_query_urr_ie(tlv);
         //        ie->load_from(is);
         //        return ie;
         //      }
         //      break;
-        //    case PFCP_IE_USAGE_REPORT_WITHIN_SESSION_MODIFICATION_RESPONSE: {
-        //        pfcp_usage_report_within_session_modification_response_ie *ie
-        //        = new
-        //        pfcp_usage_report_within_session_modification_response_ie(tlv);
-        //        ie->load_from(is);
-        //        return ie;
-        //      }
-        //      break;
-        //    case PFCP_IE_USAGE_REPORT_WITHIN_SESSION_DELETION_RESPONSE: {
-        //        pfcp_usage_report_within_session_deletion_response_ie *ie =
-        //        new
-        //        pfcp_usage_report_within_session_deletion_response_ie(tlv);
-        //        ie->load_from(is);
-        //        return ie;
-        //      }
-        //      break;
-        //    case PFCP_IE_USAGE_REPORT_WITHIN_SESSION_REPORT_REQUEST: {
-        //        pfcp_usage_report_within_session_report_request_ie *ie = new
-        //        pfcp_usage_report_within_session_report_request_ie(tlv);
-        //        ie->load_from(is);
-        //        return ie;
-        //      }
-        //      break;
+      case PFCP_IE_USAGE_REPORT_WITHIN_SESSION_MODIFICATION_RESPONSE: {
+        pfcp_usage_report_within_session_modification_response_ie* ie =
+            new pfcp_usage_report_within_session_modification_response_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
+      case PFCP_IE_USAGE_REPORT_WITHIN_SESSION_DELETION_RESPONSE: {
+        pfcp_usage_report_within_session_deletion_response_ie* ie =
+            new pfcp_usage_report_within_session_deletion_response_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
+      case PFCP_IE_USAGE_REPORT_WITHIN_SESSION_REPORT_REQUEST: {
+        pfcp_usage_report_within_session_report_request_ie* ie =
+            new pfcp_usage_report_within_session_report_request_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
       case PFCP_IE_URR_ID: {
         pfcp_urr_id_ie* ie = new pfcp_urr_id_ie(tlv);
         ie->load_from(is);
@@ -617,12 +607,11 @@ pfcp_ie* pfcp_ie::new_pfcp_ie_from_stream(std::istream& is) {
         //        pfcp_remote_gtp_u_peer_ie(tlv); ie->load_from(is); return ie;
         //      }
         //      break;
-        //    case PFCP_IE_UR_SEQN: {
-        //        pfcp_ur_seqn_ie *ie = new pfcp_ur_seqn_ie(tlv);
-        //        ie->load_from(is);
-        //        return ie;
-        //      }
-        //      break;
+      case PFCP_IE_UR_SEQN: {
+        pfcp_ur_seqn_ie* ie = new pfcp_ur_seqn_ie(tlv);
+        ie->load_from(is);
+        return ie;
+      } break;
         //    case PFCP_IE_UPDATE_DUPLICATING_PARAMETERS: {
         //        pfcp_update_duplicating_parameters_ie *ie = new
         //        pfcp_update_duplicating_parameters_ie(tlv); ie->load_from(is);
@@ -1324,11 +1313,12 @@ pfcp_msg::pfcp_msg(const pfcp_session_modification_response& pfcp_ies)
   // add_ie(sie);} if (pfcp_ies.overload_control_information.first)
   // {std::shared_ptr<pfcp_overload_control_information_ie> sie(new
   // pfcp_overload_control_information_ie(pfcp_ies.overload_control_information.second));
-  // add_ie(sie);} if (pfcp_ies.usage_report.first)
-  // {std::shared_ptr<pfcp_usage_report_within_pfcp_session_modification_response_ie>
-  // sie(new
-  // pfcp_usage_report_within_pfcp_session_modification_response_ie(pfcp_ies.usage_report.second));
   // add_ie(sie);}
+  for (auto it : pfcp_ies.usage_reports) {
+    std::shared_ptr<pfcp_usage_report_within_session_modification_response_ie>
+        sie(new pfcp_usage_report_within_session_modification_response_ie(it));
+    add_ie(sie);
+  }
   if (pfcp_ies.failed_rule_id.first) {
     std::shared_ptr<pfcp_failed_rule_id_ie> sie(
         new pfcp_failed_rule_id_ie(pfcp_ies.failed_rule_id.second));
@@ -1371,11 +1361,12 @@ pfcp_msg::pfcp_msg(const pfcp_session_deletion_response& pfcp_ies)
   // add_ie(sie);} if (pfcp_ies.overload_control_information.first)
   // {std::shared_ptr<pfcp_overload_control_information_ie> sie(new
   // pfcp_overload_control_information_ie(pfcp_ies.overload_control_information.second));
-  // add_ie(sie);} if (pfcp_ies.usage_report_information.first)
-  // {std::shared_ptr<pfcp_usage_report_within_session_deletion_response_ie>
-  // sie(new
-  // pfcp_usage_report_within_session_deletion_response_ie(pfcp_ies.additional_usage_reports_information.second));
   // add_ie(sie);}
+  for (auto it : pfcp_ies.usage_reports) {
+    std::shared_ptr<pfcp_usage_report_within_session_deletion_response_ie> sie(
+        new pfcp_usage_report_within_session_deletion_response_ie(it));
+    add_ie(sie);
+  }
 }
 //------------------------------------------------------------------------------
 pfcp_msg::pfcp_msg(const pfcp_session_report_request& pfcp_ies)
@@ -1393,8 +1384,11 @@ pfcp_msg::pfcp_msg(const pfcp_session_report_request& pfcp_ies)
         new pfcp_downlink_data_report_ie(pfcp_ies.downlink_data_report.second));
     add_ie(sie);
   }
-  // TODO std::pair<bool, pfcp::usage_report_within_pfcp_session_report_request>
-  // usage_report;
+  for (auto it : pfcp_ies.usage_reports) {
+    std::shared_ptr<pfcp_usage_report_within_session_report_request_ie> sie(
+        new pfcp_usage_report_within_session_report_request_ie(it));
+    add_ie(sie);
+  }
   // TODO std::pair<bool, pfcp::error_indication_report>
   // error_indication_report;
   // TODO std::pair<bool, pfcp::load_control_information>
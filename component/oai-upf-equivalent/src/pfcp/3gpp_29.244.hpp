@@ -1510,18 +1510,19 @@ class pfcp_volume_threshold_ie : public pfcp_ie {
       throw pfcp_tlv_bad_length_exception(
           tlv.type, tlv.get_length(), __FILE__, __LINE__);
     }
+    is.read(reinterpret_cast<char*>(&u1.b), sizeof(u1.b));
     if (u1.bf.tovol) {
       is.read(reinterpret_cast<char*>(&total_volume), sizeof(total_volume));
       total_volume = be64toh(total_volume);
     }
     if (u1.bf.ulvol) {
       is.read(reinterpret_cast<char*>(&uplink_volume), sizeof(uplink_volume));
-      total_volume = be64toh(uplink_volume);
+      uplink_volume = be64toh(uplink_volume);
     }
     if (u1.bf.dlvol) {
       is.read(
           reinterpret_cast<char*>(&downlink_volume), sizeof(downlink_volume));
-      total_volume = be64toh(downlink_volume);
+      downlink_volume = be64toh(downlink_volume);
     }
   }
   //--------
@@ -1742,18 +1743,19 @@ class pfcp_subsequent_volume_threshold_ie : public pfcp_ie {
       throw pfcp_tlv_bad_length_exception(
           tlv.type, tlv.get_length(), __FILE__, __LINE__);
     }
+    is.read(reinterpret_cast<char*>(&u1.b), sizeof(u1.b));
     if (u1.bf.tovol) {
       is.read(reinterpret_cast<char*>(&total_volume), sizeof(total_volume));
       total_volume = be64toh(total_volume);
     }
     if (u1.bf.ulvol) {
       is.read(reinterpret_cast<char*>(&uplink_volume), sizeof(uplink_volume));
-      total_volume = be64toh(uplink_volume);
+      uplink_volume = be64toh(uplink_volume);
     }
     if (u1.bf.dlvol) {
       is.read(
           reinterpret_cast<char*>(&downlink_volume), sizeof(downlink_volume));
-      total_volume = be64toh(downlink_volume);
+      downlink_volume = be64toh(downlink_volume);
     }
   }
   //--------
@@ -3339,121 +3341,261 @@ class pfcp_node_id_ie : public pfcp_ie {
 //      s.set(pfd_contents);
 //  }
 //};
+//-------------------------------------
+// IE MEASUREMENT_METHOD
+class pfcp_measurement_method_ie : public pfcp_ie {
+ public:
+  union {
+    struct {
+      uint8_t durat : 1;
+      uint8_t volum : 1;
+      uint8_t event : 1;
+      uint8_t spare : 5;
+    } bf;
+    uint8_t b;
+  } u1;
+  //--------
+  pfcp_measurement_method_ie(const pfcp::measurement_method_t& b)
+      : pfcp_ie(PFCP_IE_MEASUREMENT_METHOD) {
+    u1.b        = 0;
+    u1.bf.durat = b.durat;
+    u1.bf.volum = b.volum;
+    u1.bf.event = b.event;
+    tlv.set_length(1);
+  }
+  //--------
+  pfcp_measurement_method_ie() : pfcp_ie(PFCP_IE_MEASUREMENT_METHOD) {
+    u1.b = 0;
+    tlv.set_length(1);
+  }
+  //--------
+  pfcp_measurement_method_ie(const pfcp_tlv& t) : pfcp_ie(t) { u1.b = 0; };
+  //--------
+  void to_core_type(pfcp::measurement_method_t& b) {
+    b.durat = u1.bf.durat;
+    b.volum = u1.bf.volum;
+    b.event = u1.bf.event;
+  }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.dump_to(os);
+    os.write(reinterpret_cast<const char*>(&u1.b), sizeof(u1.b));
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() != 1) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(reinterpret_cast<char*>(&u1.b), sizeof(u1.b));
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::measurement_method_t measurement_method = {};
+    to_core_type(measurement_method);
+    s.set(measurement_method);
+  }
+};
+//-------------------------------------
+// IE USAGE_REPORT_TRIGGER
+class pfcp_usage_report_trigger_ie : public pfcp_ie {
+ public:
+  union {
+    struct {
+      uint8_t perio : 1;
+      uint8_t volth : 1;
+      uint8_t timth : 1;
+      uint8_t quhti : 1;
+      uint8_t start : 1;
+      uint8_t stop : 1;
+      uint8_t droth : 1;
+      uint8_t immer : 1;
+    } bf;
+    uint8_t b;
+  } u1;
+  union {
+    struct {
+      uint8_t volqu : 1;
+      uint8_t timqu : 1;
+      uint8_t liusa : 1;
+      uint8_t termr : 1;
+      uint8_t monit : 1;
+      uint8_t envcl : 1;
+      uint8_t macar : 1;
+      uint8_t eveth : 1;
+    } bf;
+    uint8_t b;
+  } u2;
+  union {
+    struct {
+      uint8_t evequ : 1;
+      uint8_t tebur : 1;
+      uint8_t spare : 6;
+    } bf;
+    uint8_t b;
+  } u3;
+
+  //--------
+  explicit pfcp_usage_report_trigger_ie(const pfcp::usage_report_trigger_t& b)
+      : pfcp_ie(PFCP_IE_USAGE_REPORT_TRIGGER) {
+    u1.b = 0;
+    u2.b = 0;
+    u3.b = 0;
+    tlv.set_length(3);
+    u1.bf.immer = b.immer;
+    u1.bf.droth = b.droth;
+    u1.bf.stop  = b.stop;
+    u1.bf.start = b.start;
+    u1.bf.quhti = b.quhti;
+    u1.bf.timth = b.timth;
+    u1.bf.volth = b.volth;
+    u1.bf.perio = b.perio;
+
+    u2.bf.eveth = b.eveth;
+    u2.bf.macar = b.macar;
+    u2.bf.envcl = b.envcl;
+    u2.bf.monit = b.monit;
+    u2.bf.termr = b.termr;
+    u2.bf.timqu = b.timqu;
+    u2.bf.liusa = b.liusa;
+    u2.bf.volqu = b.volqu;
+
+    u3.bf.tebur = b.tebur;
+    u3.bf.evequ = b.evequ;
+  }
+  //--------
+  pfcp_usage_report_trigger_ie() : pfcp_ie(PFCP_IE_USAGE_REPORT_TRIGGER) {
+    u1.b = 0;
+    u2.b = 0;
+    u3.b = 0;
+    tlv.set_length(3);
+  }
+  //--------
+  explicit pfcp_usage_report_trigger_ie(const pfcp_tlv& t) : pfcp_ie(t){};
+  //--------
+  void to_core_type(pfcp::usage_report_trigger_t& b) {
+    b.immer = u1.bf.immer;
+    b.droth = u1.bf.droth;
+    b.stop  = u1.bf.stop;
+    b.start = u1.bf.start;
+    b.quhti = u1.bf.quhti;
+    b.timth = u1.bf.timth;
+    b.volth = u1.bf.volth;
+    b.perio = u1.bf.perio;
+
+    b.eveth = u2.bf.eveth;
+    b.macar = u2.bf.macar;
+    b.envcl = u2.bf.envcl;
+    b.monit = u2.bf.monit;
+    b.termr = u2.bf.termr;
+    b.timqu = u2.bf.timqu;
+    b.liusa = u2.bf.liusa;
+    b.volqu = u2.bf.volqu;
+
+    b.tebur = u3.bf.tebur;
+    b.evequ = u3.bf.evequ;
+  }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.set_length(3);
+    tlv.dump_to(os);
+    os.write(reinterpret_cast<const char*>(&u1.b), sizeof(u1.b));
+    os.write(reinterpret_cast<const char*>(&u2.b), sizeof(u2.b));
+    os.write(reinterpret_cast<const char*>(&u3.b), sizeof(u3.b));
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() != 3) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(reinterpret_cast<char*>(&u1.b), sizeof(u1.b));
+    is.read(reinterpret_cast<char*>(&u2.b), sizeof(u2.b));
+    is.read(reinterpret_cast<char*>(&u3.b), sizeof(u3.b));
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::usage_report_trigger_t usage_report_trigger = {};
+    to_core_type(usage_report_trigger);
+    s.set(usage_report_trigger);
+  }
+};
+//-------------------------------------
+// IE MEASUREMENT_PERIOD
+class pfcp_measurement_period_ie : public pfcp_ie {
+ public:
+  uint32_t measurement_period;
+
+  //--------
+  explicit pfcp_measurement_period_ie(const pfcp::measurement_period_t& b)
+      : pfcp_ie(PFCP_IE_MEASUREMENT_PERIOD) {
+    measurement_period = b.measurement_period;
+    tlv.set_length(sizeof(measurement_period));
+  }
+  //--------
+  pfcp_measurement_period_ie() : pfcp_ie(PFCP_IE_MEASUREMENT_PERIOD) {
+    measurement_period = 0;
+    tlv.set_length(sizeof(measurement_period));
+  }
+  //--------
+  explicit pfcp_measurement_period_ie(const pfcp_tlv& t) : pfcp_ie(t) {
+    measurement_period = 0;
+  };
+  //--------
+  void to_core_type(pfcp::measurement_period_t& b) {
+    b.measurement_period = measurement_period;
+  }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.dump_to(os);
+    auto be_measurement_period = htobe32(measurement_period);
+    os.write(
+        reinterpret_cast<const char*>(&be_measurement_period),
+        sizeof(be_measurement_period));
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() != sizeof(measurement_period)) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(
+        reinterpret_cast<char*>(&measurement_period),
+        sizeof(measurement_period));
+    measurement_period = be32toh(measurement_period);
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::measurement_period_t v = {};
+    to_core_type(v);
+    s.set(v);
+  }
+};
 ////-------------------------------------
-//// IE MEASUREMENT_METHOD
-// class pfcp_measurement_method_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_measurement_method_ie(const pfcp::measurement_method_t& b) :
-//  pfcp_ie(PFCP_IE_MEASUREMENT_METHOD){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_measurement_method_ie() : pfcp_ie(PFCP_IE_MEASUREMENT_METHOD){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_measurement_method_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::measurement_method_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::measurement_method_t measurement_method = {};
-//      to_core_type(measurement_method);
-//      s.set(measurement_method);
-//  }
-//};
-////-------------------------------------
-//// IE USAGE_REPORT_TRIGGER
-// class pfcp_usage_report_trigger_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_usage_report_trigger_ie(const pfcp::usage_report_trigger_t& b) :
-//  pfcp_ie(PFCP_IE_USAGE_REPORT_TRIGGER){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_usage_report_trigger_ie() : pfcp_ie(PFCP_IE_USAGE_REPORT_TRIGGER){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_usage_report_trigger_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::usage_report_trigger_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::usage_report_trigger_t usage_report_trigger = {};
-//      to_core_type(usage_report_trigger);
-//      s.set(usage_report_trigger);
-//  }
-//};
-////-------------------------------------
-//// IE MEASUREMENT_PERIOD
-// class pfcp_measurement_period_ie : public pfcp_ie {
+//// IE FQ_CSID
+// class pfcp_fq_csid_ie : public pfcp_ie {
 // public:
 //  uint8_t todo;
 //
 //  //--------
-//  pfcp_measurement_period_ie(const pfcp::measurement_period_t& b) :
-//  pfcp_ie(PFCP_IE_MEASUREMENT_PERIOD){
+//  pfcp_fq_csid_ie(const pfcp::fq_csid_t& b) : pfcp_ie(PFCP_IE_FQ_CSID){
 //    todo = 0;
 //    tlv.set_length(1);
 //  }
 //  //--------
-//  pfcp_measurement_period_ie() : pfcp_ie(PFCP_IE_MEASUREMENT_PERIOD){
+//  pfcp_fq_csid_ie() : pfcp_ie(PFCP_IE_FQ_CSID){
 //    todo = 0;
 //    tlv.set_length(1);
 //  }
 //  //--------
-//  pfcp_measurement_period_ie(const pfcp_tlv& t) : pfcp_ie(t) {
+//  pfcp_fq_csid_ie(const pfcp_tlv& t) : pfcp_ie(t) {
 //    todo = 0;
 //  };
 //  //--------
-//  void to_core_type(pfcp::measurement_period_t& b) {
+//  void to_core_type(pfcp::fq_csid_t& b) {
 //    b.todo = todo;
 //  }
 //  //--------
@@ -3472,588 +3614,290 @@ class pfcp_node_id_ie : public pfcp_ie {
 //  }
 //  //--------
 //  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::measurement_period_t measurement_period = {};
-//      to_core_type(measurement_period);
-//      s.set(measurement_period);
-//  }
-//};
-////-------------------------------------
-//// IE FQ_CSID
-// class pfcp_fq_csid_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_fq_csid_ie(const pfcp::fq_csid_t& b) : pfcp_ie(PFCP_IE_FQ_CSID){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_fq_csid_ie() : pfcp_ie(PFCP_IE_FQ_CSID){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_fq_csid_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::fq_csid_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::fq_csid_t fq_csid = {};
-//      to_core_type(fq_csid);
-//      s.set(fq_csid);
-//  }
-//};
-////-------------------------------------
-//// IE VOLUME_MEASUREMENT
-// class pfcp_volume_measurement_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_volume_measurement_ie(const pfcp::volume_measurement_t& b) :
-//  pfcp_ie(PFCP_IE_VOLUME_MEASUREMENT){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_volume_measurement_ie() : pfcp_ie(PFCP_IE_VOLUME_MEASUREMENT){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_volume_measurement_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::volume_measurement_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::volume_measurement_t volume_measurement = {};
-//      to_core_type(volume_measurement);
-//      s.set(volume_measurement);
-//  }
-//};
-////-------------------------------------
-//// IE DURATION_MEASUREMENT
-// class pfcp_duration_measurement_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_duration_measurement_ie(const pfcp::duration_measurement_t& b) :
-//  pfcp_ie(PFCP_IE_DURATION_MEASUREMENT){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_duration_measurement_ie() : pfcp_ie(PFCP_IE_DURATION_MEASUREMENT){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_duration_measurement_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::duration_measurement_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::duration_measurement_t duration_measurement = {};
-//      to_core_type(duration_measurement);
-//      s.set(duration_measurement);
-//  }
-//};
-////-------------------------------------
-//// IE APPLICATION_DETECTION_INFORMATION
-// class pfcp_application_detection_information_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_application_detection_information_ie(const
-//  pfcp::application_detection_information& b) :
-//  pfcp_ie(PFCP_IE_APPLICATION_DETECTION_INFORMATION){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_application_detection_information_ie() :
-//  pfcp_ie(PFCP_IE_APPLICATION_DETECTION_INFORMATION){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_application_detection_information_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::application_detection_information& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::application_detection_information
-//      application_detection_information = {};
-//      to_core_type(application_detection_information);
-//      s.set(application_detection_information);
-//  }
-//};
-////-------------------------------------
-//// IE TIME_OF_FIRST_PACKET
-// class pfcp_time_of_first_packet_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_time_of_first_packet_ie(const pfcp::time_of_first_packet_t& b) :
-//  pfcp_ie(PFCP_IE_TIME_OF_FIRST_PACKET){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_time_of_first_packet_ie() : pfcp_ie(PFCP_IE_TIME_OF_FIRST_PACKET){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_time_of_first_packet_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::time_of_first_packet_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::time_of_first_packet_t time_of_first_packet = {};
-//      to_core_type(time_of_first_packet);
-//      s.set(time_of_first_packet);
-//  }
-//};
-////-------------------------------------
-//// IE TIME_OF_LAST_PACKET
-// class pfcp_time_of_last_packet_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_time_of_last_packet_ie(const pfcp::time_of_last_packet_t& b) :
-//  pfcp_ie(PFCP_IE_TIME_OF_LAST_PACKET){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_time_of_last_packet_ie() : pfcp_ie(PFCP_IE_TIME_OF_LAST_PACKET){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_time_of_last_packet_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::time_of_last_packet_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::time_of_last_packet_t time_of_last_packet = {};
-//      to_core_type(time_of_last_packet);
-//      s.set(time_of_last_packet);
-//  }
-//};
-////-------------------------------------
-//// IE QUOTA_HOLDING_TIME
-// class pfcp_quota_holding_time_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_quota_holding_time_ie(const pfcp::quota_holding_time_t& b) :
-//  pfcp_ie(PFCP_IE_QUOTA_HOLDING_TIME){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_quota_holding_time_ie() : pfcp_ie(PFCP_IE_QUOTA_HOLDING_TIME){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_quota_holding_time_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::quota_holding_time_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::quota_holding_time_t quota_holding_time = {};
-//      to_core_type(quota_holding_time);
-//      s.set(quota_holding_time);
-//  }
-//};
-////-------------------------------------
-//// IE DROPPED_DL_TRAFFIC_THRESHOLD
-// class pfcp_dropped_dl_traffic_threshold_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_dropped_dl_traffic_threshold_ie(const
-//  pfcp::dropped_dl_traffic_threshold_t& b) :
-//  pfcp_ie(PFCP_IE_DROPPED_DL_TRAFFIC_THRESHOLD){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_dropped_dl_traffic_threshold_ie() :
-//  pfcp_ie(PFCP_IE_DROPPED_DL_TRAFFIC_THRESHOLD){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_dropped_dl_traffic_threshold_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::dropped_dl_traffic_threshold_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::dropped_dl_traffic_threshold_t dropped_dl_traffic_threshold = {};
-//      to_core_type(dropped_dl_traffic_threshold);
-//      s.set(dropped_dl_traffic_threshold);
-//  }
-//};
-////-------------------------------------
-//// IE VOLUME_QUOTA
-// class pfcp_volume_quota_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_volume_quota_ie(const pfcp::volume_quota_t& b) :
-//  pfcp_ie(PFCP_IE_VOLUME_QUOTA){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_volume_quota_ie() : pfcp_ie(PFCP_IE_VOLUME_QUOTA){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_volume_quota_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::volume_quota_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::volume_quota_t volume_quota = {};
-//      to_core_type(volume_quota);
-//      s.set(volume_quota);
-//  }
-//};
-////-------------------------------------
-//// IE TIME_QUOTA
-// class pfcp_time_quota_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_time_quota_ie(const pfcp::time_quota_t& b) :
-//  pfcp_ie(PFCP_IE_TIME_QUOTA){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_time_quota_ie() : pfcp_ie(PFCP_IE_TIME_QUOTA){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_time_quota_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::time_quota_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::time_quota_t time_quota = {};
-//      to_core_type(time_quota);
-//      s.set(time_quota);
-//  }
-//};
-////-------------------------------------
-//// IE START_TIME
-// class pfcp_start_time_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_start_time_ie(const pfcp::start_time_t& b) :
-//  pfcp_ie(PFCP_IE_START_TIME){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_start_time_ie() : pfcp_ie(PFCP_IE_START_TIME){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_start_time_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::start_time_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::start_time_t start_time = {};
-//      to_core_type(start_time);
-//      s.set(start_time);
-//  }
-//};
-////-------------------------------------
-//// IE END_TIME
-// class pfcp_end_time_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_end_time_ie(const pfcp::end_time_t& b) : pfcp_ie(PFCP_IE_END_TIME){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_end_time_ie() : pfcp_ie(PFCP_IE_END_TIME){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_end_time_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::end_time_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::end_time_t end_time = {};
-//      to_core_type(end_time);
-//      s.set(end_time);
+//      pfcp::fq_csid_t fq_csid = {};
+//      to_core_type(fq_csid);
+//      s.set(fq_csid);
 //  }
 //};
+//-------------------------------------
+// IE VOLUME_MEASUREMENT
+class pfcp_volume_measurement_ie : public pfcp_ie {
+ public:
+  union {
+    struct {
+      uint8_t tovol : 1;
+      uint8_t ulvol : 1;
+      uint8_t dlvol : 1;
+      uint8_t tonop : 1;
+      uint8_t ulnop : 1;
+      uint8_t dlnop : 1;
+      uint8_t spare : 2;
+    } bf;
+    uint8_t b;
+  } u1;
+  uint64_t total_volume;
+  uint64_t uplink_volume;
+  uint64_t downlink_volume;
+  uint64_t total_nop;
+  uint64_t uplink_nop;
+  uint64_t downlink_nop;
+
+  //--------
+  explicit pfcp_volume_measurement_ie(const pfcp::volume_measurement_t& b)
+      : pfcp_ie(PFCP_IE_VOLUME_MEASUREMENT) {
+    tlv.set_length(1);
+    u1.b        = 0;
+    u1.bf.tovol = b.tovol;
+    u1.bf.ulvol = b.ulvol;
+    u1.bf.dlvol = b.dlvol;
+    u1.bf.tonop = b.tonop;
+    u1.bf.ulnop = b.ulnop;
+    u1.bf.dlnop = b.dlnop;
+    if (u1.bf.tovol) {
+      total_volume = b.total_volume;
+      tlv.add_length(sizeof(total_volume));
+    } else {
+      total_volume = 0;
+    }
+    if (u1.bf.ulvol) {
+      uplink_volume = b.uplink_volume;
+      tlv.add_length(sizeof(uplink_volume));
+    } else {
+      uplink_volume = 0;
+    }
+    if (u1.bf.dlvol) {
+      downlink_volume = b.downlink_volume;
+      tlv.add_length(sizeof(downlink_volume));
+    } else {
+      downlink_volume = 0;
+    }
+    if (u1.bf.tonop) {
+      total_nop = b.total_nop;
+      tlv.add_length(sizeof(total_nop));
+    } else {
+      total_nop = 0;
+    }
+    if (u1.bf.ulnop) {
+      uplink_nop = b.uplink_nop;
+      tlv.add_length(sizeof(uplink_nop));
+    } else {
+      uplink_nop = 0;
+    }
+    if (u1.bf.dlnop) {
+      downlink_nop = b.downlink_nop;
+      tlv.add_length(sizeof(downlink_nop));
+    } else {
+      downlink_nop = 0;
+    }
+  }
+  //--------
+  pfcp_volume_measurement_ie() : pfcp_ie(PFCP_IE_VOLUME_MEASUREMENT) {
+    u1.b            = 0;
+    total_volume    = 0;
+    uplink_volume   = 0;
+    downlink_volume = 0;
+    total_nop       = 0;
+    uplink_nop      = 0;
+    downlink_nop    = 0;
+    tlv.set_length(1);
+  }
+  //--------
+  explicit pfcp_volume_measurement_ie(const pfcp_tlv& t) : pfcp_ie(t) {
+    u1.b            = 0;
+    total_volume    = 0;
+    uplink_volume   = 0;
+    downlink_volume = 0;
+    total_nop       = 0;
+    uplink_nop      = 0;
+    downlink_nop    = 0;
+  };
+  //--------
+  void to_core_type(pfcp::volume_measurement_t& f) {
+    f                 = {0};
+    f.tovol           = u1.bf.tovol;
+    f.ulvol           = u1.bf.ulvol;
+    f.dlvol           = u1.bf.dlvol;
+    f.tonop           = u1.bf.tonop;
+    f.ulnop           = u1.bf.ulnop;
+    f.dlnop           = u1.bf.dlnop;
+    f.total_volume    = total_volume;
+    f.uplink_volume   = uplink_volume;
+    f.downlink_volume = downlink_volume;
+    f.total_nop       = total_nop;
+    f.uplink_nop      = uplink_nop;
+    f.downlink_nop    = downlink_nop;
+  }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.set_length(1);
+    if (u1.bf.tovol) {
+      tlv.add_length(sizeof(total_volume));
+    }
+    if (u1.bf.ulvol) {
+      tlv.add_length(sizeof(uplink_volume));
+    }
+    if (u1.bf.dlvol) {
+      tlv.add_length(sizeof(downlink_volume));
+    }
+    if (u1.bf.tonop) {
+      tlv.add_length(sizeof(total_nop));
+    }
+    if (u1.bf.ulnop) {
+      tlv.add_length(sizeof(uplink_nop));
+    }
+    if (u1.bf.dlnop) {
+      tlv.add_length(sizeof(downlink_nop));
+    }
+
+    tlv.dump_to(os);
+    os.write(reinterpret_cast<const char*>(&u1.b), sizeof(u1.b));
+    if (u1.bf.tovol) {
+      auto be_total_volume = htobe64(total_volume);
+      os.write(
+          reinterpret_cast<const char*>(&be_total_volume),
+          sizeof(be_total_volume));
+    }
+    if (u1.bf.ulvol) {
+      auto be_uplink_volume = htobe64(uplink_volume);
+      os.write(
+          reinterpret_cast<const char*>(&be_uplink_volume),
+          sizeof(be_uplink_volume));
+    }
+    if (u1.bf.dlvol) {
+      auto be_downlink_volume = htobe64(downlink_volume);
+      os.write(
+          reinterpret_cast<const char*>(&be_downlink_volume),
+          sizeof(be_downlink_volume));
+    }
+    if (u1.bf.tonop) {
+      auto be_total_nop = htobe64(total_nop);
+      os.write(
+          reinterpret_cast<const char*>(&be_total_nop), sizeof(be_total_nop));
+    }
+    if (u1.bf.ulnop) {
+      auto be_uplink_nop = htobe64(uplink_nop);
+      os.write(
+          reinterpret_cast<const char*>(&be_uplink_nop), sizeof(be_uplink_nop));
+    }
+    if (u1.bf.dlnop) {
+      auto be_downlink_nop = htobe64(downlink_nop);
+      os.write(
+          reinterpret_cast<const char*>(&be_downlink_nop),
+          sizeof(be_downlink_nop));
+    }
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    is.read(reinterpret_cast<char*>(&u1.b), sizeof(u1.b));
+    if (tlv.get_length() < 1) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    if (u1.bf.tovol) {
+      is.read(reinterpret_cast<char*>(&total_volume), sizeof(total_volume));
+      total_volume = be64toh(total_volume);
+    }
+    if (u1.bf.ulvol) {
+      is.read(reinterpret_cast<char*>(&uplink_volume), sizeof(uplink_volume));
+      uplink_volume = be64toh(uplink_volume);
+    }
+    if (u1.bf.dlvol) {
+      is.read(
+          reinterpret_cast<char*>(&downlink_volume), sizeof(downlink_volume));
+      downlink_volume = be64toh(downlink_volume);
+    }
+    if (u1.bf.tonop) {
+      is.read(reinterpret_cast<char*>(&total_nop), sizeof(total_nop));
+      total_nop = be64toh(total_nop);
+    }
+    if (u1.bf.ulnop) {
+      is.read(reinterpret_cast<char*>(&uplink_nop), sizeof(uplink_nop));
+      uplink_nop = be64toh(uplink_nop);
+    }
+    if (u1.bf.dlnop) {
+      is.read(reinterpret_cast<char*>(&downlink_nop), sizeof(downlink_nop));
+      downlink_nop = be64toh(downlink_nop);
+    }
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::volume_measurement_t volume_measurement = {};
+    to_core_type(volume_measurement);
+    s.set(volume_measurement);
+  }
+};
+//-------------------------------------
+// IE DURATION_MEASUREMENT
+class pfcp_duration_measurement_ie : public pfcp_ie {
+ public:
+  uint32_t duration;
+
+  //--------
+  explicit pfcp_duration_measurement_ie(const pfcp::duration_measurement_t& b)
+      : pfcp_ie(PFCP_IE_DURATION_MEASUREMENT) {
+    duration = b.duration;
+    tlv.set_length(sizeof(duration));
+  }
+  //--------
+  pfcp_duration_measurement_ie() : pfcp_ie(PFCP_IE_DURATION_MEASUREMENT) {
+    duration = 0;
+    tlv.set_length(sizeof(duration));
+  }
+  //--------
+  explicit pfcp_duration_measurement_ie(const pfcp_tlv& t) : pfcp_ie(t) {
+    duration = 0;
+  };
+  //--------
+  void to_core_type(pfcp::duration_measurement_t& b) { b.duration = duration; }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.dump_to(os);
+    auto be_duration = htobe32(duration);
+    os.write(reinterpret_cast<const char*>(&be_duration), sizeof(be_duration));
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() != sizeof(duration)) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(reinterpret_cast<char*>(&duration), sizeof(duration));
+    duration = be32toh(duration);
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::duration_measurement_t v = {};
+    to_core_type(v);
+    s.set(v);
+  }
+};
 ////-------------------------------------
-//// IE QUERY_URR
-// class pfcp_query_urr_ie : public pfcp_ie {
+//// IE APPLICATION_DETECTION_INFORMATION
+// class pfcp_application_detection_information_ie : public pfcp_ie {
 // public:
 //  uint8_t todo;
 //
 //  //--------
-//  pfcp_query_urr_ie(const pfcp::query_urr& b) : pfcp_ie(PFCP_IE_QUERY_URR){
+//  pfcp_application_detection_information_ie(const
+//  pfcp::application_detection_information& b) :
+//  pfcp_ie(PFCP_IE_APPLICATION_DETECTION_INFORMATION){
 //    todo = 0;
 //    tlv.set_length(1);
 //  }
 //  //--------
-//  pfcp_query_urr_ie() : pfcp_ie(PFCP_IE_QUERY_URR){
+//  pfcp_application_detection_information_ie() :
+//  pfcp_ie(PFCP_IE_APPLICATION_DETECTION_INFORMATION){
 //    todo = 0;
 //    tlv.set_length(1);
 //  }
 //  //--------
-//  pfcp_query_urr_ie(const pfcp_tlv& t) : pfcp_ie(t) {
+//  pfcp_application_detection_information_ie(const pfcp_tlv& t) : pfcp_ie(t) {
 //    todo = 0;
 //  };
 //  //--------
-//  void to_core_type(pfcp::query_urr& b) {
+//  void to_core_type(pfcp::application_detection_information& b) {
 //    b.todo = todo;
 //  }
 //  //--------
@@ -4072,39 +3916,139 @@ class pfcp_node_id_ie : public pfcp_ie {
 //  }
 //  //--------
 //  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::query_urr query_urr = {};
-//      to_core_type(query_urr);
-//      s.set(query_urr);
+//      pfcp::application_detection_information
+//      application_detection_information = {};
+//      to_core_type(application_detection_information);
+//      s.set(application_detection_information);
 //  }
 //};
+//-------------------------------------
+// IE TIME_OF_FIRST_PACKET
+class pfcp_time_of_first_packet_ie : public pfcp_ie {
+ public:
+  uint32_t time_of_first_packet;
+
+  //--------
+  explicit pfcp_time_of_first_packet_ie(const pfcp::time_of_first_packet_t& b)
+      : pfcp_ie(PFCP_IE_TIME_OF_FIRST_PACKET) {
+    time_of_first_packet = b.time_of_first_packet;
+    tlv.set_length(sizeof(time_of_first_packet));
+  }
+  //--------
+  pfcp_time_of_first_packet_ie() : pfcp_ie(PFCP_IE_TIME_OF_FIRST_PACKET) {
+    time_of_first_packet = 0;
+    tlv.set_length(sizeof(time_of_first_packet));
+  }
+  //--------
+  pfcp_time_of_first_packet_ie(const pfcp_tlv& t) : pfcp_ie(t) {
+    time_of_first_packet = 0;
+  };
+  //--------
+  void to_core_type(pfcp::time_of_first_packet_t& b) {
+    b.time_of_first_packet = time_of_first_packet;
+  }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.dump_to(os);
+    auto be_time_of_first_packet = htobe32(time_of_first_packet);
+    os.write(
+        reinterpret_cast<const char*>(&be_time_of_first_packet),
+        sizeof(be_time_of_first_packet));
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() != sizeof(time_of_first_packet)) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(
+        reinterpret_cast<char*>(&time_of_first_packet),
+        sizeof(time_of_first_packet));
+    time_of_first_packet = be32toh(time_of_first_packet);
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::time_of_first_packet_t time_of_first_packet = {};
+    to_core_type(time_of_first_packet);
+    s.set(time_of_first_packet);
+  }
+};
+//-------------------------------------
+// IE TIME_OF_LAST_PACKET
+class pfcp_time_of_last_packet_ie : public pfcp_ie {
+ public:
+  uint32_t time_of_last_packet;
+
+  //--------
+  explicit pfcp_time_of_last_packet_ie(const pfcp::time_of_last_packet_t& b)
+      : pfcp_ie(PFCP_IE_TIME_OF_LAST_PACKET) {
+    time_of_last_packet = 0;
+    tlv.set_length(sizeof(time_of_last_packet));
+  }
+  //--------
+  pfcp_time_of_last_packet_ie() : pfcp_ie(PFCP_IE_TIME_OF_LAST_PACKET) {
+    time_of_last_packet = 0;
+    tlv.set_length(sizeof(time_of_last_packet));
+  }
+  //--------
+  pfcp_time_of_last_packet_ie(const pfcp_tlv& t) : pfcp_ie(t) {
+    time_of_last_packet = 0;
+  };
+  //--------
+  void to_core_type(pfcp::time_of_last_packet_t& b) {
+    b.time_of_last_packet = time_of_last_packet;
+  }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.dump_to(os);
+    auto be_time_of_last_packet = htobe32(time_of_last_packet);
+    os.write(
+        reinterpret_cast<const char*>(&be_time_of_last_packet),
+        sizeof(be_time_of_last_packet));
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() != sizeof(time_of_last_packet)) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(
+        reinterpret_cast<char*>(&time_of_last_packet),
+        sizeof(time_of_last_packet));
+    time_of_last_packet = be32toh(time_of_last_packet);
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::time_of_last_packet_t time_of_last_packet = {};
+    to_core_type(time_of_last_packet);
+    s.set(time_of_last_packet);
+  }
+};
 ////-------------------------------------
-//// IE USAGE_REPORT_WITHIN_SESSION_MODIFICATION_RESPONSE
-// class pfcp_usage_report_within_session_modification_response_ie : public
-// pfcp_ie { public:
+//// IE QUOTA_HOLDING_TIME
+// class pfcp_quota_holding_time_ie : public pfcp_ie {
+// public:
 //  uint8_t todo;
 //
 //  //--------
-//  pfcp_usage_report_within_session_modification_response_ie(const
-//  pfcp::usage_report_within_pfcp_session_modification_response& b) :
-//  pfcp_ie(PFCP_IE_USAGE_REPORT_WITHIN_SESSION_MODIFICATION_RESPONSE){
+//  pfcp_quota_holding_time_ie(const pfcp::quota_holding_time_t& b) :
+//  pfcp_ie(PFCP_IE_QUOTA_HOLDING_TIME){
 //    todo = 0;
 //    tlv.set_length(1);
 //  }
 //  //--------
-//  pfcp_usage_report_within_session_modification_response_ie() :
-//  pfcp_ie(PFCP_IE_USAGE_REPORT_WITHIN_SESSION_MODIFICATION_RESPONSE){
+//  pfcp_quota_holding_time_ie() : pfcp_ie(PFCP_IE_QUOTA_HOLDING_TIME){
 //    todo = 0;
 //    tlv.set_length(1);
 //  }
 //  //--------
-//  pfcp_usage_report_within_session_modification_response_ie(const pfcp_tlv& t)
-//  : pfcp_ie(t) {
+//  pfcp_quota_holding_time_ie(const pfcp_tlv& t) : pfcp_ie(t) {
 //    todo = 0;
 //  };
 //  //--------
-//  void
-//  to_core_type(pfcp::usage_report_within_pfcp_session_modification_response&
-//  b) {
+//  void to_core_type(pfcp::quota_holding_time_t& b) {
 //    b.todo = todo;
 //  }
 //  //--------
@@ -4123,39 +4067,36 @@ class pfcp_node_id_ie : public pfcp_ie {
 //  }
 //  //--------
 //  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::usage_report_within_pfcp_session_modification_response
-//      usage_report_within_session_modification_response = {};
-//      to_core_type(usage_report_within_session_modification_response);
-//      s.set(usage_report_within_session_modification_response);
+//      pfcp::quota_holding_time_t quota_holding_time = {};
+//      to_core_type(quota_holding_time);
+//      s.set(quota_holding_time);
 //  }
 //};
 ////-------------------------------------
-//// IE USAGE_REPORT_WITHIN_SESSION_DELETION_RESPONSE
-// class pfcp_usage_report_within_session_deletion_response_ie : public pfcp_ie
-// { public:
+//// IE DROPPED_DL_TRAFFIC_THRESHOLD
+// class pfcp_dropped_dl_traffic_threshold_ie : public pfcp_ie {
+// public:
 //  uint8_t todo;
 //
 //  //--------
-//  pfcp_usage_report_within_session_deletion_response_ie(const
-//  pfcp::usage_report_within_pfcp_session_deletion_response& b) :
-//  pfcp_ie(PFCP_IE_USAGE_REPORT_WITHIN_SESSION_DELETION_RESPONSE){
+//  pfcp_dropped_dl_traffic_threshold_ie(const
+//  pfcp::dropped_dl_traffic_threshold_t& b) :
+//  pfcp_ie(PFCP_IE_DROPPED_DL_TRAFFIC_THRESHOLD){
 //    todo = 0;
 //    tlv.set_length(1);
 //  }
 //  //--------
-//  pfcp_usage_report_within_session_deletion_response_ie() :
-//  pfcp_ie(PFCP_IE_USAGE_REPORT_WITHIN_SESSION_DELETION_RESPONSE){
+//  pfcp_dropped_dl_traffic_threshold_ie() :
+//  pfcp_ie(PFCP_IE_DROPPED_DL_TRAFFIC_THRESHOLD){
 //    todo = 0;
 //    tlv.set_length(1);
 //  }
 //  //--------
-//  pfcp_usage_report_within_session_deletion_response_ie(const pfcp_tlv& t) :
-//  pfcp_ie(t) {
+//  pfcp_dropped_dl_traffic_threshold_ie(const pfcp_tlv& t) : pfcp_ie(t) {
 //    todo = 0;
 //  };
 //  //--------
-//  void to_core_type(pfcp::usage_report_within_pfcp_session_deletion_response&
-//  b) {
+//  void to_core_type(pfcp::dropped_dl_traffic_threshold_t& b) {
 //    b.todo = todo;
 //  }
 //  //--------
@@ -4174,39 +4115,304 @@ class pfcp_node_id_ie : public pfcp_ie {
 //  }
 //  //--------
 //  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::usage_report_within_pfcp_session_deletion_response
-//      usage_report_within_session_deletion_response = {};
-//      to_core_type(usage_report_within_session_deletion_response);
-//      s.set(usage_report_within_session_deletion_response);
+//      pfcp::dropped_dl_traffic_threshold_t dropped_dl_traffic_threshold = {};
+//      to_core_type(dropped_dl_traffic_threshold);
+//      s.set(dropped_dl_traffic_threshold);
 //  }
 //};
+//-------------------------------------
+// IE VOLUME_QUOTA
+class pfcp_volume_quota_ie : public pfcp_ie {
+ public:
+  union {
+    struct {
+      uint8_t tovol : 1;
+      uint8_t ulvol : 1;
+      uint8_t dlvol : 1;
+      uint8_t spare : 5;
+    } bf;
+    uint8_t b;
+  } u1;
+  uint64_t total_volume;
+  uint64_t uplink_volume;
+  uint64_t downlink_volume;
+  //--------
+  explicit pfcp_volume_quota_ie(const pfcp::volume_quota_t& b)
+      : pfcp_ie(PFCP_IE_VOLUME_QUOTA) {
+    tlv.set_length(1);
+    u1.b        = 0;
+    u1.bf.tovol = b.tovol;
+    u1.bf.ulvol = b.ulvol;
+    u1.bf.dlvol = b.dlvol;
+    if (u1.bf.tovol) {
+      total_volume = b.total_volume;
+      tlv.add_length(sizeof(total_volume));
+    } else {
+      total_volume = 0;
+    }
+    if (u1.bf.ulvol) {
+      uplink_volume = b.uplink_volume;
+      tlv.add_length(sizeof(uplink_volume));
+    } else {
+      uplink_volume = 0;
+    }
+    if (u1.bf.dlvol) {
+      downlink_volume = b.downlink_volume;
+      tlv.add_length(sizeof(downlink_volume));
+    } else {
+      downlink_volume = 0;
+    }
+  }
+  //--------
+  pfcp_volume_quota_ie() : pfcp_ie(PFCP_IE_VOLUME_QUOTA) {
+    tlv.set_length(1);
+    u1.b            = 0;
+    total_volume    = 0;
+    uplink_volume   = 0;
+    downlink_volume = 0;
+  }
+  //--------
+  explicit pfcp_volume_quota_ie(const pfcp_tlv& t) : pfcp_ie(t){};
+  //--------
+  void to_core_type(pfcp::volume_quota_t& b) {
+    b       = {};
+    b.tovol = u1.bf.tovol;
+    b.ulvol = u1.bf.ulvol;
+    b.dlvol = u1.bf.dlvol;
+    if (u1.bf.tovol) {
+      b.total_volume = total_volume;
+    }
+    if (u1.bf.ulvol) {
+      b.uplink_volume = uplink_volume;
+    }
+    if (u1.bf.dlvol) {
+      b.downlink_volume = downlink_volume;
+    }
+  }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.set_length(1);
+    if (u1.bf.tovol) {
+      tlv.add_length(sizeof(total_volume));
+    }
+    if (u1.bf.ulvol) {
+      tlv.add_length(sizeof(uplink_volume));
+    }
+    if (u1.bf.dlvol) {
+      tlv.add_length(sizeof(downlink_volume));
+    }
+
+    tlv.dump_to(os);
+    os.write(reinterpret_cast<const char*>(&u1.b), sizeof(u1.b));
+    if (u1.bf.tovol) {
+      auto be_total_volume = htobe64(total_volume);
+      os.write(
+          reinterpret_cast<const char*>(&be_total_volume),
+          sizeof(be_total_volume));
+    }
+    if (u1.bf.ulvol) {
+      auto be_uplink_volume = htobe64(uplink_volume);
+      os.write(
+          reinterpret_cast<const char*>(&be_uplink_volume),
+          sizeof(be_uplink_volume));
+    }
+    if (u1.bf.dlvol) {
+      auto be_downlink_volume = htobe64(downlink_volume);
+      os.write(
+          reinterpret_cast<const char*>(&be_downlink_volume),
+          sizeof(be_downlink_volume));
+    }
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() < 1) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(reinterpret_cast<char*>(&u1.b), sizeof(u1.b));
+    if (u1.bf.tovol) {
+      is.read(reinterpret_cast<char*>(&total_volume), sizeof(total_volume));
+      total_volume = be64toh(total_volume);
+    }
+    if (u1.bf.ulvol) {
+      is.read(reinterpret_cast<char*>(&uplink_volume), sizeof(uplink_volume));
+      uplink_volume = be64toh(uplink_volume);
+    }
+    if (u1.bf.dlvol) {
+      is.read(
+          reinterpret_cast<char*>(&downlink_volume), sizeof(downlink_volume));
+      downlink_volume = be64toh(downlink_volume);
+    }
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::volume_quota_t v = {};
+    to_core_type(v);
+    s.set(v);
+  }
+};
+//-------------------------------------
+// IE TIME_QUOTA
+class pfcp_time_quota_ie : public pfcp_ie {
+ public:
+  uint32_t time_quota;
+
+  //--------
+  explicit pfcp_time_quota_ie(const pfcp::time_quota_t& b)
+      : pfcp_ie(PFCP_IE_TIME_QUOTA) {
+    time_quota = b.time_quota;
+    tlv.set_length(sizeof(time_quota));
+  }
+  //--------
+  pfcp_time_quota_ie()
+      : pfcp_ie(PFCP_IE_TIME_QUOTA), time_quota(0) {
+    tlv.set_length(sizeof(time_quota));
+  }
+  //--------
+  explicit pfcp_time_quota_ie(const pfcp_tlv& t)
+      : pfcp_ie(t), time_quota(0){};
+  //--------
+  void to_core_type(pfcp::time_quota_t& b) {
+    b.time_quota = time_quota;
+  }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.dump_to(os);
+    auto be_time_quota = htobe32(time_quota);
+    os.write(
+        reinterpret_cast<const char*>(&be_time_quota),
+        sizeof(be_time_quota));
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() != sizeof(time_quota)) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(reinterpret_cast<char*>(&time_quota), sizeof(time_quota));
+    time_quota = be32toh(time_quota);
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::time_quota_t v = {};
+    to_core_type(v);
+    s.set(v);
+  }
+};
+//-------------------------------------
+// IE START_TIME
+class pfcp_start_time_ie : public pfcp_ie {
+ public:
+  uint32_t start_time;
+
+  //--------
+  explicit pfcp_start_time_ie(const pfcp::start_time_t& b)
+      : pfcp_ie(PFCP_IE_START_TIME) {
+    start_time = b.start_time;
+    tlv.set_length(sizeof(start_time));
+  }
+  //--------
+  pfcp_start_time_ie() : pfcp_ie(PFCP_IE_START_TIME) {
+    start_time = 0;
+    tlv.set_length(sizeof(start_time));
+  }
+  explicit pfcp_start_time_ie(const pfcp_tlv& t) : pfcp_ie(t) {
+    start_time = 0;
+  };
+  //--------
+  void to_core_type(pfcp::start_time_t& b) { b.start_time = start_time; }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.dump_to(os);
+    auto be_start_time = htobe32(start_time);
+    os.write(
+        reinterpret_cast<const char*>(&be_start_time), sizeof(be_start_time));
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() != sizeof(start_time)) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(reinterpret_cast<char*>(&start_time), sizeof(start_time));
+    start_time = be32toh(start_time);
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::start_time_t start_time = {};
+    to_core_type(start_time);
+    s.set(start_time);
+  }
+};
+//-------------------------------------
+// IE END_TIME
+class pfcp_end_time_ie : public pfcp_ie {
+ public:
+  uint32_t end_time;
+
+  //--------
+  explicit pfcp_end_time_ie(const pfcp::end_time_t& b)
+      : pfcp_ie(PFCP_IE_END_TIME) {
+    end_time = b.end_time;
+    tlv.set_length(sizeof(end_time));
+  }
+  //--------
+  pfcp_end_time_ie() : pfcp_ie(PFCP_IE_END_TIME) {
+    end_time = 0;
+    tlv.set_length(sizeof(end_time));
+  }
+  //--------
+  pfcp_end_time_ie(const pfcp_tlv& t) : pfcp_ie(t) { end_time = 0; };
+  //--------
+  void to_core_type(pfcp::end_time_t& b) { b.end_time = end_time; }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.dump_to(os);
+    auto be_end_time = htobe32(end_time);
+    os.write(reinterpret_cast<const char*>(&be_end_time), sizeof(be_end_time));
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() != sizeof(end_time)) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(reinterpret_cast<char*>(&end_time), sizeof(end_time));
+    end_time = be32toh(end_time);
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::end_time_t end_time = {};
+    to_core_type(end_time);
+    s.set(end_time);
+  }
+};
 ////-------------------------------------
-//// IE USAGE_REPORT_WITHIN_SESSION_REPORT_REQUEST
-// class pfcp_usage_report_within_session_report_request_ie : public pfcp_ie {
+//// IE QUERY_URR
+// class pfcp_query_urr_ie : public pfcp_ie {
 // public:
 //  uint8_t todo;
 //
 //  //--------
-//  pfcp_usage_report_within_session_report_request_ie(const
-//  pfcp::usage_report_within_pfcp_session_report_request& b) :
-//  pfcp_ie(PFCP_IE_USAGE_REPORT_WITHIN_SESSION_REPORT_REQUEST){
+//  pfcp_query_urr_ie(const pfcp::query_urr& b) : pfcp_ie(PFCP_IE_QUERY_URR){
 //    todo = 0;
 //    tlv.set_length(1);
 //  }
 //  //--------
-//  pfcp_usage_report_within_session_report_request_ie() :
-//  pfcp_ie(PFCP_IE_USAGE_REPORT_WITHIN_SESSION_REPORT_REQUEST){
+//  pfcp_query_urr_ie() : pfcp_ie(PFCP_IE_QUERY_URR){
 //    todo = 0;
 //    tlv.set_length(1);
 //  }
 //  //--------
-//  pfcp_usage_report_within_session_report_request_ie(const pfcp_tlv& t) :
-//  pfcp_ie(t) {
+//  pfcp_query_urr_ie(const pfcp_tlv& t) : pfcp_ie(t) {
 //    todo = 0;
 //  };
 //  //--------
-//  void to_core_type(pfcp::usage_report_within_pfcp_session_report_request& b)
-//  {
+//  void to_core_type(pfcp::query_urr& b) {
 //    b.todo = todo;
 //  }
 //  //--------
@@ -4225,10 +4431,9 @@ class pfcp_node_id_ie : public pfcp_ie {
 //  }
 //  //--------
 //  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::usage_report_within_pfcp_session_report_request
-//      usage_report_within_session_report_request = {};
-//      to_core_type(usage_report_within_session_report_request);
-//      s.set(usage_report_within_session_report_request);
+//      pfcp::query_urr query_urr = {};
+//      to_core_type(query_urr);
+//      s.set(query_urr);
 //  }
 //};
 //-------------------------------------
@@ -5458,51 +5663,359 @@ class pfcp_node_report_type_ie : public pfcp_ie {
 //      s.set(v);
 //  }
 //};
-////-------------------------------------
-//// IE UR_SEQN
-// class pfcp_ur_seqn_ie : public pfcp_ie {
-// public:
-//  uint8_t todo;
-//
-//  //--------
-//  pfcp_ur_seqn_ie(const pfcp::ur_seqn_t& b) : pfcp_ie(PFCP_IE_UR_SEQN){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_ur_seqn_ie() : pfcp_ie(PFCP_IE_UR_SEQN){
-//    todo = 0;
-//    tlv.set_length(1);
-//  }
-//  //--------
-//  pfcp_ur_seqn_ie(const pfcp_tlv& t) : pfcp_ie(t) {
-//    todo = 0;
-//  };
-//  //--------
-//  void to_core_type(pfcp::ur_seqn_t& b) {
-//    b.todo = todo;
-//  }
-//  //--------
-//  void dump_to(std::ostream& os) {
-//    tlv.dump_to(os);
-//    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void load_from(std::istream& is) {
-//    //tlv.load_from(is);
-//    if (tlv.get_length() != 1) {
-//      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
-//      __FILE__, __LINE__);
-//    }
-//    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
-//  }
-//  //--------
-//  void to_core_type(pfcp_ies_container& s) {
-//      pfcp::ur_seqn_t ur_seqn = {};
-//      to_core_type(ur_seqn);
-//      s.set(ur_seqn);
-//  }
-//};
+//-------------------------------------
+// IE UR_SEQN
+class pfcp_ur_seqn_ie : public pfcp_ie {
+ public:
+  uint32_t ur_seqn;
+
+  //--------
+  pfcp_ur_seqn_ie(const pfcp::ur_seqn_t& b) : pfcp_ie(PFCP_IE_UR_SEQN) {
+    ur_seqn = b.ur_seqn;
+    tlv.set_length(sizeof(ur_seqn));
+  }
+  //--------
+  pfcp_ur_seqn_ie() : pfcp_ie(PFCP_IE_UR_SEQN) {
+    ur_seqn = 0;
+    tlv.set_length(sizeof(ur_seqn));
+  }
+  //--------
+  pfcp_ur_seqn_ie(const pfcp_tlv& t) : pfcp_ie(t) { ur_seqn = 0; };
+  //--------
+  void to_core_type(pfcp::ur_seqn_t& b) { b.ur_seqn = ur_seqn; }
+  //--------
+  void dump_to(std::ostream& os) {
+    tlv.dump_to(os);
+    auto be_ur_seqn = htobe32(ur_seqn);
+    os.write(reinterpret_cast<const char*>(&be_ur_seqn), sizeof(be_ur_seqn));
+  }
+  //--------
+  void load_from(std::istream& is) {
+    // tlv.load_from(is);
+    if (tlv.get_length() != sizeof(ur_seqn)) {
+      throw pfcp_tlv_bad_length_exception(
+          tlv.type, tlv.get_length(), __FILE__, __LINE__);
+    }
+    is.read(reinterpret_cast<char*>(&ur_seqn), sizeof(ur_seqn));
+    ur_seqn = be32toh(ur_seqn);
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::ur_seqn_t v = {};
+    to_core_type(v);
+    s.set(v);
+  }
+};
+//-------------------------------------
+// IE USAGE_REPORT_WITHIN_SESSION_MODIFICATION_RESPONSE
+class pfcp_usage_report_within_session_modification_response_ie
+    : public pfcp_grouped_ie {
+ public:
+  //--------
+  pfcp_usage_report_within_session_modification_response_ie(
+      const pfcp::usage_report_within_pfcp_session_modification_response& b)
+      : pfcp_grouped_ie(
+            PFCP_IE_USAGE_REPORT_WITHIN_SESSION_MODIFICATION_RESPONSE) {
+    tlv.set_length(0);
+    if (b.urr_id.first) {
+      std::shared_ptr<pfcp_urr_id_ie> sie(new pfcp_urr_id_ie(b.urr_id.second));
+      add_ie(sie);
+    }
+    if (b.ur_seqn.first) {
+      std::shared_ptr<pfcp_ur_seqn_ie> sie(
+          new pfcp_ur_seqn_ie(b.ur_seqn.second));
+      add_ie(sie);
+    }
+    if (b.usage_report_trigger.first) {
+      std::shared_ptr<pfcp_usage_report_trigger_ie> sie(
+          new pfcp_usage_report_trigger_ie(b.usage_report_trigger.second));
+      add_ie(sie);
+    }
+    if (b.start_time.first) {
+      std::shared_ptr<pfcp_start_time_ie> sie(
+          new pfcp_start_time_ie(b.start_time.second));
+      add_ie(sie);
+    }
+    if (b.end_time.first) {
+      std::shared_ptr<pfcp_end_time_ie> sie(
+          new pfcp_end_time_ie(b.end_time.second));
+      add_ie(sie);
+    }
+    if (b.volume_measurement.first) {
+      std::shared_ptr<pfcp_volume_measurement_ie> sie(
+          new pfcp_volume_measurement_ie(b.volume_measurement.second));
+      add_ie(sie);
+    }
+    if (b.duration_measurement.first) {
+      std::shared_ptr<pfcp_duration_measurement_ie> sie(
+          new pfcp_duration_measurement_ie(b.duration_measurement.second));
+      add_ie(sie);
+    }
+    if (b.time_of_first_packet.first) {
+      std::shared_ptr<pfcp_time_of_first_packet_ie> sie(
+          new pfcp_time_of_first_packet_ie(b.time_of_first_packet.second));
+      add_ie(sie);
+    }
+    if (b.time_of_last_packet.first) {
+      std::shared_ptr<pfcp_time_of_last_packet_ie> sie(
+          new pfcp_time_of_last_packet_ie(b.time_of_last_packet.second));
+      add_ie(sie);
+    }
+    // if (b.usage_information.first) {
+    //   std::shared_ptr<pfcp_usage_information_ie> sie(
+    //       new pfcp_usage_information_ie(b.usage_information.second));
+    //   add_ie(sie);
+    // }
+    // if (b.query_urr_reference.first) {
+    //   std::shared_ptr<pfcp_query_urr_reference_ie> sie(
+    //       new pfcp_query_urr_reference_ie(b.query_urr_reference.second));
+    //   add_ie(sie);
+    // }
+    // if (b.ethernet_traffic_information.first) {
+    //   std::shared_ptr<pfcp_ethernet_traffic_information_ie> sie(
+    //       new
+    //       pfcp_ethernet_traffic_information_ie(b.ethernet_traffic_information.second));
+    //   add_ie(sie);
+    // }
+  }
+  //--------
+  pfcp_usage_report_within_session_modification_response_ie()
+      : pfcp_grouped_ie(
+            PFCP_IE_USAGE_REPORT_WITHIN_SESSION_MODIFICATION_RESPONSE) {}
+  //--------
+  explicit pfcp_usage_report_within_session_modification_response_ie(
+      const pfcp_tlv& t)
+      : pfcp_grouped_ie(t){};
+  //--------
+  void to_core_type(
+      pfcp::usage_report_within_pfcp_session_modification_response& c) {
+    for (auto sie : ies) {
+      sie.get()->to_core_type(c);
+    }
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::usage_report_within_pfcp_session_modification_response i = {};
+    to_core_type(i);
+    s.set(i);
+  }
+};
+//-------------------------------------
+// IE USAGE_REPORT_WITHIN_SESSION_DELETION_RESPONSE
+class pfcp_usage_report_within_session_deletion_response_ie
+    : public pfcp_grouped_ie {
+ public:
+  //--------
+  pfcp_usage_report_within_session_deletion_response_ie(
+      const pfcp::usage_report_within_pfcp_session_deletion_response& b)
+      : pfcp_grouped_ie(
+            PFCP_IE_USAGE_REPORT_WITHIN_SESSION_DELETION_RESPONSE) {
+    tlv.set_length(0);
+    if (b.urr_id.first) {
+      std::shared_ptr<pfcp_urr_id_ie> sie(new pfcp_urr_id_ie(b.urr_id.second));
+      add_ie(sie);
+    }
+    if (b.ur_seqn.first) {
+      std::shared_ptr<pfcp_ur_seqn_ie> sie(
+          new pfcp_ur_seqn_ie(b.ur_seqn.second));
+      add_ie(sie);
+    }
+    if (b.usage_report_trigger.first) {
+      std::shared_ptr<pfcp_usage_report_trigger_ie> sie(
+          new pfcp_usage_report_trigger_ie(b.usage_report_trigger.second));
+      add_ie(sie);
+    }
+    if (b.start_time.first) {
+      std::shared_ptr<pfcp_start_time_ie> sie(
+          new pfcp_start_time_ie(b.start_time.second));
+      add_ie(sie);
+    }
+    if (b.end_time.first) {
+      std::shared_ptr<pfcp_end_time_ie> sie(
+          new pfcp_end_time_ie(b.end_time.second));
+      add_ie(sie);
+    }
+    if (b.volume_measurement.first) {
+      std::shared_ptr<pfcp_volume_measurement_ie> sie(
+          new pfcp_volume_measurement_ie(b.volume_measurement.second));
+      add_ie(sie);
+    }
+    if (b.duration_measurement.first) {
+      std::shared_ptr<pfcp_duration_measurement_ie> sie(
+          new pfcp_duration_measurement_ie(b.duration_measurement.second));
+      add_ie(sie);
+    }
+    if (b.time_of_first_packet.first) {
+      std::shared_ptr<pfcp_time_of_first_packet_ie> sie(
+          new pfcp_time_of_first_packet_ie(b.time_of_first_packet.second));
+      add_ie(sie);
+    }
+    if (b.time_of_last_packet.first) {
+      std::shared_ptr<pfcp_time_of_last_packet_ie> sie(
+          new pfcp_time_of_last_packet_ie(b.time_of_last_packet.second));
+      add_ie(sie);
+    }
+    // if (b.usage_information.first) {
+    //   std::shared_ptr<pfcp_usage_information_ie> sie(
+    //       new pfcp_usage_information_ie(b.usage_information.second));
+    //   add_ie(sie);
+    // }
+    // if (b.ethernet_traffic_information.first) {
+    //   std::shared_ptr<pfcp_ethernet_traffic_information_ie> sie(
+    //       new
+    //       pfcp_ethernet_traffic_information_ie(b.ethernet_traffic_information.second));
+    //   add_ie(sie);
+    // }
+  }
+  //--------
+  pfcp_usage_report_within_session_deletion_response_ie()
+      : pfcp_grouped_ie(
+            PFCP_IE_USAGE_REPORT_WITHIN_SESSION_DELETION_RESPONSE) {}
+  //--------
+  explicit pfcp_usage_report_within_session_deletion_response_ie(
+      const pfcp_tlv& t)
+      : pfcp_grouped_ie(t){};
+  //--------
+  void to_core_type(
+      pfcp::usage_report_within_pfcp_session_deletion_response& c) {
+    for (auto sie : ies) {
+      sie.get()->to_core_type(c);
+    }
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::usage_report_within_pfcp_session_deletion_response i = {};
+    to_core_type(i);
+    s.set(i);
+  }
+};
+//-------------------------------------
+// IE USAGE_REPORT_WITHIN_SESSION_REPORT_REQUEST
+class pfcp_usage_report_within_session_report_request_ie
+    : public pfcp_grouped_ie {
+ public:
+  //--------
+  pfcp_usage_report_within_session_report_request_ie(
+      const pfcp::usage_report_within_pfcp_session_report_request& b)
+      : pfcp_grouped_ie(PFCP_IE_USAGE_REPORT_WITHIN_SESSION_REPORT_REQUEST) {
+    tlv.set_length(0);
+    if (b.urr_id.first) {
+      std::shared_ptr<pfcp_urr_id_ie> sie(new pfcp_urr_id_ie(b.urr_id.second));
+      add_ie(sie);
+    }
+    if (b.ur_seqn.first) {
+      std::shared_ptr<pfcp_ur_seqn_ie> sie(
+          new pfcp_ur_seqn_ie(b.ur_seqn.second));
+      add_ie(sie);
+    }
+    if (b.usage_report_trigger.first) {
+      std::shared_ptr<pfcp_usage_report_trigger_ie> sie(
+          new pfcp_usage_report_trigger_ie(b.usage_report_trigger.second));
+      add_ie(sie);
+    }
+    if (b.start_time.first) {
+      std::shared_ptr<pfcp_start_time_ie> sie(
+          new pfcp_start_time_ie(b.start_time.second));
+      add_ie(sie);
+    }
+    if (b.end_time.first) {
+      std::shared_ptr<pfcp_end_time_ie> sie(
+          new pfcp_end_time_ie(b.end_time.second));
+      add_ie(sie);
+    }
+    if (b.volume_measurement.first) {
+      std::shared_ptr<pfcp_volume_measurement_ie> sie(
+          new pfcp_volume_measurement_ie(b.volume_measurement.second));
+      add_ie(sie);
+    }
+    if (b.duration_measurement.first) {
+      std::shared_ptr<pfcp_duration_measurement_ie> sie(
+          new pfcp_duration_measurement_ie(b.duration_measurement.second));
+      add_ie(sie);
+    }
+    // if (b.application_detection_information.first) {
+    //   std::shared_ptr<pfcp_application_detection_information_ie> sie(
+    //       new
+    //       pfcp_application_detection_information_ie(b.application_detection_information.second));
+    //   add_ie(sie);
+    // }
+    if (b.ue_ip_address.first) {
+      std::shared_ptr<pfcp_ue_ip_address_ie> sie(
+          new pfcp_ue_ip_address_ie(b.ue_ip_address.second));
+      add_ie(sie);
+    }
+    if (b.network_instance.first) {
+      std::shared_ptr<pfcp_network_instance_ie> sie(
+          new pfcp_network_instance_ie(b.network_instance.second));
+      add_ie(sie);
+    }
+    if (b.time_of_first_packet.first) {
+      std::shared_ptr<pfcp_time_of_first_packet_ie> sie(
+          new pfcp_time_of_first_packet_ie(b.time_of_first_packet.second));
+      add_ie(sie);
+    }
+    if (b.time_of_last_packet.first) {
+      std::shared_ptr<pfcp_time_of_last_packet_ie> sie(
+          new pfcp_time_of_last_packet_ie(b.time_of_last_packet.second));
+      add_ie(sie);
+    }
+    // if (b.usage_information.first) {
+    //   std::shared_ptr<pfcp_usage_information_ie> sie(
+    //       new pfcp_usage_information_ie(b.usage_information.second));
+    //   add_ie(sie);
+    // }
+    // if (b.query_urr_reference.first) {
+    //   std::shared_ptr<pfcp_query_urr_reference_ie> sie(
+    //       new pfcp_query_urr_reference_ie(b.query_urr_reference.second));
+    //   add_ie(sie);
+    // }
+    // if (b.ethernet_traffic_information.first) {
+    //   std::shared_ptr<pfcp_ethernet_traffic_information_ie> sie(
+    //       new
+    //       pfcp_ethernet_traffic_information_ie(b.ethernet_traffic_information.second));
+    //   add_ie(sie);
+    // }
+  }
+  //--------
+  pfcp_usage_report_within_session_report_request_ie()
+      : pfcp_grouped_ie(PFCP_IE_USAGE_REPORT_WITHIN_SESSION_REPORT_REQUEST) {}
+  //--------
+  explicit pfcp_usage_report_within_session_report_request_ie(const pfcp_tlv& t)
+      : pfcp_grouped_ie(t){};
+  //--------
+  void to_core_type(pfcp::usage_report_within_pfcp_session_report_request& c) {
+    for (auto sie : ies) {
+      sie.get()->to_core_type(c);
+    }
+  }
+  //--------
+  void to_core_type(pfcp_ies_container& s) {
+    pfcp::usage_report_within_pfcp_session_report_request i = {};
+    to_core_type(i);
+    s.set(i);
+  }
+  //  //--------
+  //  void dump_to(std::ostream& os) {
+  //    tlv.dump_to(os);
+  //    os.write(reinterpret_cast<const char*>(&todo), sizeof(todo));
+  //  }
+  //  //--------
+  //  void load_from(std::istream& is) {
+  //    //tlv.load_from(is);
+  //    if (tlv.get_length() != 1) {
+  //      throw pfcp_tlv_bad_length_exception(tlv.type, tlv.get_length(),
+  //      __FILE__, __LINE__);
+  //    }
+  //    is.read(reinterpret_cast<char*>(&todo), sizeof(todo));
+  //  }
+  //  //--------
+  //  void to_core_type(pfcp_ies_container& s) {
+  //      pfcp::usage_report_within_pfcp_session_report_request
+  //      usage_report_within_session_report_request = {};
+  //      to_core_type(usage_report_within_session_report_request);
+  //      s.set(usage_report_within_session_report_request);
+  //  }
+};
 ////-------------------------------------
 //// IE UPDATE_DUPLICATING_PARAMETERS
 // class pfcp_update_duplicating_parameters_ie : public pfcp_ie {
@@ -8517,7 +9030,7 @@ class pfcp_create_urr_ie : public pfcp_grouped_ie {
   //--------
   explicit pfcp_create_urr_ie(const pfcp_tlv& t) : pfcp_grouped_ie(t) {}
   //--------
-  void to_core_type(pfcp::duplicating_parameters& c) {
+  void to_core_type(pfcp::create_urr& c) {
     for (auto sie : ies) {
       sie.get()->to_core_type(c);
     }
@@ -6976,8 +6976,8 @@ class pfcp_session_modification_response : public pfcp_ies_container {
   std::pair<bool, pfcp::load_control_information> load_control_information;
   std::pair<bool, pfcp::overload_control_information>
       overload_control_information;
-  std::pair<bool, pfcp::usage_report_within_pfcp_session_modification_response>
-      usage_report;
+  std::vector<pfcp::usage_report_within_pfcp_session_modification_response>
+      usage_reports;
   std::pair<bool, pfcp::failed_rule_id_t> failed_rule_id;
   std::pair<bool, pfcp::additional_usage_reports_information_t>
       additional_usage_reports_information;
@@ -6989,7 +6989,7 @@ class pfcp_session_modification_response : public pfcp_ies_container {
         created_pdrs(),
         load_control_information(),
         overload_control_information(),
-        usage_report(),
+        usage_reports(),
         failed_rule_id(),
         additional_usage_reports_information(),
         created_traffic_endpoint() {}
@@ -7001,7 +7001,7 @@ class pfcp_session_modification_response : public pfcp_ies_container {
         created_pdrs(i.created_pdrs),
         load_control_information(i.load_control_information),
         overload_control_information(i.overload_control_information),
-        usage_report(i.usage_report),
+        usage_reports(i.usage_reports),
         failed_rule_id(i.failed_rule_id),
         additional_usage_reports_information(
             i.additional_usage_reports_information),
@@ -7039,14 +7039,6 @@ class pfcp_session_modification_response : public pfcp_ies_container {
     }
     return false;
   }
-  bool get(
-      pfcp::usage_report_within_pfcp_session_modification_response& v) const {
-    if (usage_report.first) {
-      v = usage_report.second;
-      return true;
-    }
-    return false;
-  }
   bool get(pfcp::failed_rule_id_t& v) const {
     if (failed_rule_id.first) {
       v = failed_rule_id.second;
@@ -7088,8 +7080,7 @@ class pfcp_session_modification_response : public pfcp_ies_container {
   }
   void set(
       const pfcp::usage_report_within_pfcp_session_modification_response& v) {
-    usage_report.first  = true;
-    usage_report.second = v;
+    usage_reports.push_back(v);
   }
   void set(const pfcp::failed_rule_id_t& v) {
     failed_rule_id.first  = true;
@@ -7121,11 +7112,16 @@ class pfcp_session_deletion_response : public pfcp_ies_container {
 
   std::pair<bool, pfcp::cause_t> cause;
   std::pair<bool, pfcp::offending_ie_t> offending_ie;
+  std::vector<pfcp::usage_report_within_pfcp_session_deletion_response>
+      usage_reports;
 
-  pfcp_session_deletion_response() : cause(), offending_ie() {}
+  pfcp_session_deletion_response()
+      : cause(), offending_ie(), usage_reports() {}
 
   pfcp_session_deletion_response(const pfcp_session_deletion_response& i)
-      : cause(i.cause), offending_ie(i.offending_ie) {}
+      : cause(i.cause),
+        offending_ie(i.offending_ie),
+        usage_reports(i.usage_reports) {}
 
   const char* get_msg_name() const { return "PFCP_SESSION_DELETION_RESPONSE"; };
 
@@ -7152,6 +7148,9 @@ class pfcp_session_deletion_response : public pfcp_ies_container {
     offending_ie.first  = true;
     offending_ie.second = v;
   }
+  void set(const pfcp::usage_report_within_pfcp_session_deletion_response& v) {
+    usage_reports.push_back(v);
+  }
 };
 //------------------------------------------------------------------------------
 class pfcp_session_report_request : public pfcp_ies_container {
@@ -7160,8 +7159,8 @@ class pfcp_session_report_request : public pfcp_ies_container {
 
   std::pair<bool, pfcp::report_type_t> report_type;
   std::pair<bool, pfcp::downlink_data_report> downlink_data_report;
-  std::pair<bool, pfcp::usage_report_within_pfcp_session_report_request>
-      usage_report;
+  std::vector<pfcp::usage_report_within_pfcp_session_report_request>
+      usage_reports;
   std::pair<bool, pfcp::error_indication_report> error_indication_report;
   std::pair<bool, pfcp::load_control_information> load_control_information;
   std::pair<bool, pfcp::overload_control_information>
@@ -7172,7 +7171,7 @@ class pfcp_session_report_request : public pfcp_ies_container {
   pfcp_session_report_request()
       : report_type(),
         downlink_data_report(),
-        usage_report(),
+        usage_reports(),
         error_indication_report(),
         load_control_information(),
         overload_control_information(),
@@ -7181,7 +7180,7 @@ class pfcp_session_report_request : public pfcp_ies_container {
   pfcp_session_report_request(const pfcp_session_report_request& i)
       : report_type(i.report_type),
         downlink_data_report(i.downlink_data_report),
-        usage_report(i.usage_report),
+        usage_reports(i.usage_reports),
         error_indication_report(i.error_indication_report),
         load_control_information(i.load_control_information),
         overload_control_information(i.overload_control_information),
@@ -7204,13 +7203,6 @@ class pfcp_session_report_request : public pfcp_ies_container {
     }
     return false;
   }
-  bool get(pfcp::usage_report_within_pfcp_session_report_request& v) const {
-    if (usage_report.first) {
-      v = usage_report.second;
-      return true;
-    }
-    return false;
-  }
   bool get(pfcp::error_indication_report& v) const {
     if (error_indication_report.first) {
       v = error_indication_report.second;
@@ -7249,8 +7241,7 @@ class pfcp_session_report_request : public pfcp_ies_container {
     downlink_data_report.second = v;
   }
   void set(const pfcp::usage_report_within_pfcp_session_report_request& v) {
-    usage_report.first  = true;
-    usage_report.second = v;
+    usage_reports.push_back(v);
   }
   void set(const pfcp::error_indication_report& v) {
     error_indication_report.first  = true;
@@ -253,7 +253,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -286,7 +286,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -319,7 +319,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -413,7 +413,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -433,15 +433,11 @@ uint32_t pfcp_l4_stack::send_request(
     const endpoint& dest, const uint64_t seid,
     const pfcp_session_establishment_request& pfcp_ies,
     const task_id_t& task_id, const uint64_t trxn_id) {
-  std::ostringstream oss(std::ostringstream::binary);
-  pfcp_msg msg(pfcp_ies);
+  pfcp_msg_header msg = {};
   msg.set_seid(seid);
   msg.set_sequence_number(get_next_seq_num());
-  msg.dump_to(oss);
-  // std::cout << string_to_hex(oss.str()) << std::endl;
-  // std::cout << std::hex << "msg length 0x" << msg.get_message_length() <<
-  // "msg seqnum 0x" << msg.get_sequence_number() << std::endl;
-  std::string bstream = oss.str();
+  std::string bstream = {};
+  pfcp::encode(msg, pfcp_ies, bstream);
 
   Logger::pfcp().trace(
       "Sending %s, seq %d seid " SEID_FMT " ", pfcp_ies.get_msg_name(),
@@ -449,7 +445,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -469,15 +465,11 @@ uint32_t pfcp_l4_stack::send_request(
     const endpoint& dest, const uint64_t seid,
     const pfcp_session_modification_request& pfcp_ies, const task_id_t& task_id,
     const uint64_t trxn_id) {
-  std::ostringstream oss(std::ostringstream::binary);
-  pfcp_msg msg(pfcp_ies);
+  pfcp_msg_header msg = {};
   msg.set_seid(seid);
   msg.set_sequence_number(get_next_seq_num());
-  msg.dump_to(oss);
-  // std::cout << string_to_hex(oss.str()) << std::endl;
-  // std::cout << std::hex << "msg length 0x" << msg.get_message_length() <<
-  // "msg seqnum 0x" << msg.get_sequence_number() << std::endl;
-  std::string bstream = oss.str();
+  std::string bstream = {};
+  pfcp::encode(msg, pfcp_ies, bstream);
 
   Logger::pfcp().trace(
       "Sending %s, seq %d seid " SEID_FMT " ", pfcp_ies.get_msg_name(),
@@ -485,7 +477,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -551,7 +543,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -587,7 +579,7 @@ uint32_t pfcp_l4_stack::send_request(
   pfcp_procedure proc   = {};
   proc.initial_msg_type = msg.get_message_type();
   proc.trxn_id          = trxn_id;
-  proc.retry_msg        = std::make_shared<pfcp_msg>(msg);
+  proc.retry_bstream    = std::make_shared<std::string>(bstream);
   proc.remote_endpoint  = dest;
   start_msg_retry_timer(
       proc, PFCP_T1_RESPONSE_MS, task_id, msg.get_sequence_number());
@@ -711,12 +703,11 @@ void pfcp_l4_stack::send_response(
   std::map<uint64_t, uint32_t>::iterator it;
   it = trxn_id2seq_num.find(trxn_id);
   if (it != trxn_id2seq_num.end()) {
-    std::ostringstream oss(std::ostringstream::binary);
-    pfcp_msg msg(pfcp_ies);
+    pfcp_msg_header msg = {};
     msg.set_seid(seid);
     msg.set_sequence_number(it->second);
-    msg.dump_to(oss);
-    std::string bstream = oss.str();
+    std::string bstream = {};
+    pfcp::encode(msg, pfcp_ies, bstream);
     Logger::pfcp().trace(
         "Sending %s, seq %d seid " SEID_FMT " ", pfcp_ies.get_msg_name(),
         msg.get_sequence_number(), seid);
@@ -746,12 +737,11 @@ void pfcp_l4_stack::send_response(
   std::map<uint64_t, uint32_t>::iterator it;
   it = trxn_id2seq_num.find(trxn_id);
   if (it != trxn_id2seq_num.end()) {
-    std::ostringstream oss(std::ostringstream::binary);
-    pfcp_msg msg(pfcp_ies);
+    pfcp_msg_header msg = {};
     msg.set_seid(seid);
     msg.set_sequence_number(it->second);
-    msg.dump_to(oss);
-    std::string bstream = oss.str();
+    std::string bstream = {};
+    pfcp::encode(msg, pfcp_ies, bstream);
     Logger::pfcp().trace(
         "Sending %s, seq %d seid " SEID_FMT " ", pfcp_ies.get_msg_name(),
         msg.get_sequence_number(), seid);
@@ -865,16 +855,12 @@ void pfcp_l4_stack::time_out_event(
       if (it_proc->second.retry_count < PFCP_N1_REQUESTS) {
         it_proc->second.retry_count++;
         start_msg_retry_timer(
-            it_proc->second, PFCP_T1_RESPONSE_MS, task_id,
-            it_proc->second.retry_msg->get_sequence_number());
+            it_proc->second, PFCP_T1_RESPONSE_MS, task_id, it_proc->first);
         // send again message
         Logger::pfcp().trace(
             "Retry %d Sending msg type %d, seq %d", it_proc->second.retry_count,
-            it_proc->second.retry_msg->get_message_type(),
-            it_proc->second.retry_msg->get_sequence_number());
-        std::ostringstream oss(std::ostringstream::binary);
-        it_proc->second.retry_msg->dump_to(oss);
-        std::string bstream = oss.str();
+            it_proc->second.initial_msg_type, it_proc->first);
+        const std::string& bstream = *it_proc->second.retry_bstream;
         udp_s_8805.async_send_to(
             reinterpret_cast<const char*>(bstream.c_str()), bstream.length(),
             it_proc->second.remote_endpoint);
@@ -41,6 +41,7 @@
 #include <utility>
 #include <vector>
 #include "msg_pfcp.hpp"
+#include "pfcp_codec.hpp"
 
 namespace pfcp {
 
@@ -48,7 +49,8 @@ static const uint16_t default_port = 8805;
 
 class pfcp_procedure {
  public:
-  std::shared_ptr<pfcp_msg> retry_msg;
+  // the request as sent, for the retransmissions
+  std::shared_ptr<std::string> retry_bstream;
   endpoint remote_endpoint;
   timer_id_t retry_timer_id;
   timer_id_t proc_cleanup_timer_id;
@@ -58,7 +60,7 @@ class pfcp_procedure {
   uint8_t retry_count;
 
   pfcp_procedure()
-      : retry_msg(),
+      : retry_bstream(),
         remote_endpoint(),
         retry_timer_id(0),
         proc_cleanup_timer_id(0),
@@ -68,7 +70,7 @@ class pfcp_procedure {
         retry_count(0) {}
 
   pfcp_procedure(const pfcp_procedure& p)
-      : retry_msg(p.retry_msg),
+      : retry_bstream(p.retry_bstream),
         remote_endpoint(p.remote_endpoint),
         retry_timer_id(p.retry_timer_id),
         proc_cleanup_timer_id(p.proc_cleanup_timer_id),
@@ -0,0 +1,981 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_codec.cpp
+ \brief PFCP session establishment and modification messages encoded in a
+        contiguous buffer and decoded from it, without iostream nor pfcp_ie
+ \date 2021
+ */
+
+#include "pfcp_codec.hpp"
+
+#include <string.h>
+
+using namespace pfcp;
+
+#define PFCP_CODEC_TLV_LENGTH 4
+#define PFCP_CODEC_MAX_LENGTH 0xFFFF
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Lengths of the IEs of the core types and the IEs written in place, in the
+// order of the pfcp_ie constructors. handled is false if a length exceeds the
+// TLV length or if a value is not handled.
+class encoder {
+ public:
+  bool handled;
+  uint8_t* p;
+
+  encoder() : handled(true), p(nullptr) {}
+  explicit encoder(uint8_t* buf) : handled(true), p(buf) {}
+
+  // IE with its TLV
+  template<class T>
+  std::size_t ie_length(const T& v) {
+    std::size_t l = length(v);
+    if (l > PFCP_CODEC_MAX_LENGTH) handled = false;
+    return PFCP_CODEC_TLV_LENGTH + l;
+  }
+  template<class T>
+  std::size_t ie_length(const std::pair<bool, T>& v) {
+    return v.first ? ie_length(v.second) : 0;
+  }
+  template<class T>
+  std::size_t ie_length(const std::vector<T>& v) {
+    std::size_t l = 0;
+    for (const auto& i : v) l += ie_length(i);
+    return l;
+  }
+  template<class T>
+  void not_handled(const std::pair<bool, T>& v) {
+    if (v.first) handled = false;
+  }
+  template<class T>
+  void not_handled(const std::vector<T>& v) {
+    if (!v.empty()) handled = false;
+  }
+
+  template<class T>
+  void ie(const uint16_t type, const T& v) {
+    be16(type);
+    be16(length(v));
+    value(v);
+  }
+  template<class T>
+  void ie(const uint16_t type, const std::pair<bool, T>& v) {
+    if (v.first) ie(type, v.second);
+  }
+  template<class T>
+  void ie(const uint16_t type, const std::vector<T>& v) {
+    for (const auto& i : v) ie(type, i);
+  }
+
+  void u8(const uint8_t v) { *p++ = v; }
+  void be16(const uint16_t v) {
+    u8(v >> 8);
+    u8(v);
+  }
+  void be32(const uint32_t v) {
+    be16(v >> 16);
+    be16(v);
+  }
+  void be64(const uint64_t v) {
+    be32(v >> 32);
+    be32(v);
+  }
+  void bytes(const void* v, const std::size_t n) {
+    memcpy(p, v, n);
+    p += n;
+  }
+  void str(const std::string& s) { bytes(s.data(), s.size()); }
+  // pfcp_ie::string_to_dotted(), str.length() + 1 bytes
+  void dotted(const std::string& s) {
+    uint8_t* label = p++;
+    uint8_t n      = 0;
+    for (const char c : s) {
+      if (c == '.') {
+        *label = n;
+        n      = 0;
+        label  = p++;
+      } else {
+        *p++ = c;
+        n++;
+      }
+    }
+    *label = n;
+  }
+
+  void header(const pfcp_msg_header& h) {
+    // version 1, no message priority
+    u8(0x20 | (h.has_seid() ? 0x01 : 0));
+    u8(h.get_message_type());
+    be16(h.get_message_length());
+    if (h.has_seid()) be64(h.get_seid());
+    uint32_t sn = h.get_sequence_number();
+    u8(sn >> 16);
+    u8(sn >> 8);
+    u8(sn);
+    u8(0);
+  }
+
+  //----------------------------------------------------------------------------
+  // Leaf IEs
+  std::size_t length(const pfcp::cause_t&) { return 1; }
+  void value(const pfcp::cause_t& v) { u8(v.cause_value); }
+
+  std::size_t length(const offending_ie_t&) { return 2; }
+  void value(const offending_ie_t& v) { be16(v.offending_ie); }
+
+  std::size_t length(const source_interface_t&) { return 1; }
+  void value(const source_interface_t& v) { u8(v.interface_value); }
+
+  std::size_t length(const destination_interface_t&) { return 1; }
+  void value(const destination_interface_t& v) { u8(v.interface_value); }
+
+  std::size_t length(const node_id_t& v) {
+    switch (v.node_id_type) {
+      case NODE_ID_TYPE_IPV4_ADDRESS:
+        return 1 + 4;
+      case NODE_ID_TYPE_IPV6_ADDRESS:
+        return 1 + 16;
+      case NODE_ID_TYPE_FQDN:
+        return 1 + v.fqdn.length() + 1;
+      default:
+        return 1;
+    }
+  }
+  void value(const node_id_t& v) {
+    u8(v.node_id_type);
+    switch (v.node_id_type) {
+      case NODE_ID_TYPE_IPV4_ADDRESS:
+        bytes(&v.u1.ipv4_address.s_addr, 4);
+        break;
+      case NODE_ID_TYPE_IPV6_ADDRESS:
+        bytes(v.u1.ipv6_address.s6_addr, 16);
+        break;
+      case NODE_ID_TYPE_FQDN:
+        dotted(v.fqdn);
+        break;
+      default:;
+    }
+  }
+
+  std::size_t length(const fseid_t& v) {
+    return 9 + (v.v4 ? 4 : 0) + (v.v6 ? 16 : 0);
+  }
+  void value(const fseid_t& v) {
+    u8((v.v4 << 1) | v.v6);
+    be64(v.seid);
+    if (v.v4) bytes(&v.ipv4_address.s_addr, 4);
+    if (v.v6) bytes(v.ipv6_address.s6_addr, 16);
+  }
+
+  // CHOOSE: as pfcp_fteid_ie, without the V4/V6 flags, CHOOSE ID if any
+  std::size_t length(const pfcp::fteid_t& v) {
+    if (v.ch) return 1 + (v.chid ? 1 : 0);
+    return 1 + 4 + (v.v4 ? 4 : 0) + (v.v6 ? 16 : 0);
+  }
+  void value(const pfcp::fteid_t& v) {
+    if (v.ch) {
+      u8((1 << 2) | (v.chid << 3));
+      if (v.chid) u8(v.choose_id);
+      return;
+    }
+    u8(v.v4 | (v.v6 << 1));
+    be32(v.teid);
+    if (v.v4) bytes(&v.ipv4_address.s_addr, 4);
+    if (v.v6) bytes(v.ipv6_address.s6_addr, 16);
+  }
+
+  std::size_t length(const network_instance_t& v) {
+    return v.network_instance.size();
+  }
+  void value(const network_instance_t& v) { str(v.network_instance); }
+
+  std::size_t length(const ue_ip_address_t& v) {
+    return 1 + (v.v4 ? 4 : 0) + (v.v6 ? (v.ipv6d ? 17 : 16) : 0);
+  }
+  void value(const ue_ip_address_t& v) {
+    u8(v.v6 | (v.v4 << 1) | (v.sd << 2) | ((v.v6 & v.ipv6d) << 3));
+    if (v.v4) bytes(&v.ipv4_address.s_addr, 4);
+    if (v.v6) {
+      bytes(v.ipv6_address.s6_addr, 16);
+      if (v.ipv6d) u8(v.ipv6_prefix_delegation_bits);
+    }
+  }
+
+  // Flow Label and SDF Filter ID are not handled
+  std::size_t length(const sdf_filter_t& v) {
+    if (v.fl || v.bid || (v.ttc && (v.tos_traffic_class.size() != 2)) ||
+        (v.spi && (v.security_parameter_index.size() != 4)))
+      handled = false;
+    return 2 + (v.fd ? 2 + v.flow_description.size() : 0) + (v.ttc ? 2 : 0) +
+           (v.spi ? 4 : 0);
+  }
+  void value(const sdf_filter_t& v) {
+    u8(v.fd | (v.ttc << 1) | (v.spi << 2));
+    u8(0);
+    if (v.fd) {
+      be16(v.length_of_flow_description);
+      str(v.flow_description);
+    }
+    if (v.ttc) str(v.tos_traffic_class);
+    if (v.spi) str(v.security_parameter_index);
+  }
+
+  std::size_t length(const application_id_t& v) {
+    return v.application_id.size();
+  }
+  void value(const application_id_t& v) { str(v.application_id); }
+
+  std::size_t length(const qfi_t&) { return 1; }
+  void value(const qfi_t& v) { u8(v.qfi); }
+
+  std::size_t length(const pdr_id_t&) { return 2; }
+  void value(const pdr_id_t& v) { be16(v.rule_id); }
+
+  std::size_t length(const precedence_t&) { return 4; }
+  void value(const precedence_t& v) { be32(v.precedence); }
+
+  std::size_t length(const far_id_t&) { return 4; }
+  void value(const far_id_t& v) { be32(v.far_id); }
+
+  std::size_t length(const urr_id_t&) { return 4; }
+  void value(const urr_id_t& v) { be32(v.urr_id); }
+
+  std::size_t length(const qer_id_t&) { return 4; }
+  void value(const qer_id_t& v) { be32(v.qer_id); }
+
+  std::size_t length(const bar_id_t&) { return 1; }
+  void value(const bar_id_t& v) { u8(v.bar_id); }
+
+  std::size_t length(const outer_header_removal_t&) { return 1; }
+  void value(const outer_header_removal_t& v) {
+    u8(v.outer_header_removal_description);
+  }
+
+  std::size_t length(const apply_action_t&) { return 1; }
+  void value(const apply_action_t& v) {
+    u8(v.drop | (v.forw << 1) | (v.buff << 2) | (v.nocp << 3) |
+       (v.dupl << 4));
+  }
+
+  std::size_t length(const user_plane_inactivity_timer_t&) { return 4; }
+  void value(const user_plane_inactivity_timer_t& v) {
+    be32(v.user_plane_inactivity_timer);
+  }
+
+  std::size_t length(const outer_header_creation_t& v) {
+    uint16_t d    = v.outer_header_creation_description;
+    std::size_t l = 2;
+    if (d & (OUTER_HEADER_CREATION_GTPU_UDP_IPV4 |
+             OUTER_HEADER_CREATION_GTPU_UDP_IPV6))
+      l += 4;
+    if (d & (OUTER_HEADER_CREATION_GTPU_UDP_IPV4 |
+             OUTER_HEADER_CREATION_UDP_IPV4))
+      l += 4;
+    if (d & (OUTER_HEADER_CREATION_GTPU_UDP_IPV6 |
+             OUTER_HEADER_CREATION_UDP_IPV6))
+      l += 16;
+    if (d & OUTER_HEADER_CREATION_UDP_IPV4) l += 2;
+    return l;
+  }
+  void value(const outer_header_creation_t& v) {
+    uint16_t d = v.outer_header_creation_description;
+    be16(d);
+    if (d & (OUTER_HEADER_CREATION_GTPU_UDP_IPV4 |
+             OUTER_HEADER_CREATION_GTPU_UDP_IPV6))
+      be32(v.teid);
+    if (d & (OUTER_HEADER_CREATION_GTPU_UDP_IPV4 |
+             OUTER_HEADER_CREATION_UDP_IPV4))
+      bytes(&v.ipv4_address.s_addr, 4);
+    if (d & (OUTER_HEADER_CREATION_GTPU_UDP_IPV6 |
+             OUTER_HEADER_CREATION_UDP_IPV6))
+      bytes(v.ipv6_address.s6_addr, 16);
+    if (d & OUTER_HEADER_CREATION_UDP_IPV4) be16(v.port_number);
+  }
+
+  std::size_t length(const transport_level_marking_t& v) {
+    if (v.transport_level_marking.size() != 2) handled = false;
+    return 2;
+  }
+  void value(const transport_level_marking_t& v) {
+    str(v.transport_level_marking);
+  }
+
+  std::size_t length(const forwarding_policy_t& v) {
+    return 1 + v.forwarding_policy_identifier.size();
+  }
+  void value(const forwarding_policy_t& v) {
+    u8(v.forwarding_policy_identifier_length);
+    str(v.forwarding_policy_identifier);
+  }
+
+  //----------------------------------------------------------------------------
+  // Grouped IEs
+  std::size_t length(const pdi& v) {
+    return ie_length(v.source_interface) + ie_length(v.local_fteid) +
+           ie_length(v.network_instance) + ie_length(v.ue_ip_address) +
+           ie_length(v.sdf_filter) + ie_length(v.application_id) +
+           ie_length(v.qfi);
+  }
+  void value(const pdi& v) {
+    ie(PFCP_IE_SOURCE_INTERFACE, v.source_interface);
+    ie(PFCP_IE_F_TEID, v.local_fteid);
+    ie(PFCP_IE_NETWORK_INSTANCE, v.network_instance);
+    ie(PFCP_IE_UE_IP_ADDRESS, v.ue_ip_address);
+    ie(PFCP_IE_SDF_FILTER, v.sdf_filter);
+    ie(PFCP_IE_APPLICATION_ID, v.application_id);
+    ie(PFCP_IE_QFI, v.qfi);
+  }
+
+  std::size_t length(const create_pdr& v) {
+    not_handled(v.activate_predefined_rules);
+    return ie_length(v.pdr_id) + ie_length(v.precedence) + ie_length(v.pdi) +
+           ie_length(v.outer_header_removal) + ie_length(v.far_id) +
+           ie_length(v.urr_id) + ie_length(v.qer_id);
+  }
+  void value(const create_pdr& v) {
+    ie(PFCP_IE_PACKET_DETECTION_RULE_ID, v.pdr_id);
+    ie(PFCP_IE_PRECEDENCE, v.precedence);
+    ie(PFCP_IE_PDI, v.pdi);
+    ie(PFCP_IE_OUTER_HEADER_REMOVAL, v.outer_header_removal);
+    ie(PFCP_IE_FAR_ID, v.far_id);
+    ie(PFCP_IE_URR_ID, v.urr_id);
+    ie(PFCP_IE_QER_ID, v.qer_id);
+  }
+
+  std::size_t length(const forwarding_parameters& v) {
+    return ie_length(v.destination_interface) + ie_length(v.network_instance) +
+           ie_length(v.outer_header_creation) +
+           ie_length(v.transport_level_marking) +
+           ie_length(v.forwarding_policy);
+  }
+  void value(const forwarding_parameters& v) {
+    ie(PFCP_IE_DESTINATION_INTERFACE, v.destination_interface);
+    ie(PFCP_IE_NETWORK_INSTANCE, v.network_instance);
+    ie(PFCP_IE_OUTER_HEADER_CREATION, v.outer_header_creation);
+    ie(PFCP_IE_TRANSPORT_LEVEL_MARKING, v.transport_level_marking);
+    ie(PFCP_IE_FORWARDING_POLICY, v.forwarding_policy);
+  }
+
+  std::size_t length(const update_forwarding_parameters& v) {
+    return ie_length(v.destination_interface) + ie_length(v.network_instance) +
+           ie_length(v.outer_header_creation) +
+           ie_length(v.transport_level_marking) +
+           ie_length(v.forwarding_policy);
+  }
+  void value(const update_forwarding_parameters& v) {
+    ie(PFCP_IE_DESTINATION_INTERFACE, v.destination_interface);
+    ie(PFCP_IE_NETWORK_INSTANCE, v.network_instance);
+    ie(PFCP_IE_OUTER_HEADER_CREATION, v.outer_header_creation);
+    ie(PFCP_IE_TRANSPORT_LEVEL_MARKING, v.transport_level_marking);
+    ie(PFCP_IE_FORWARDING_POLICY, v.forwarding_policy);
+  }
+
+  std::size_t length(const create_far& v) {
+    not_handled(v.duplicating_parameters);
+    return ie_length(v.far_id) + ie_length(v.apply_action) +
+           ie_length(v.forwarding_parameters) + ie_length(v.bar_id);
+  }
+  void value(const create_far& v) {
+    ie(PFCP_IE_FAR_ID, v.far_id);
+    ie(PFCP_IE_APPLY_ACTION, v.apply_action);
+    ie(PFCP_IE_FORWARDING_PARAMETERS, v.forwarding_parameters);
+    ie(PFCP_IE_BAR_ID, v.bar_id);
+  }
+
+  std::size_t length(const created_pdr& v) {
+    return ie_length(v.pdr_id) + ie_length(v.local_fteid);
+  }
+  void value(const created_pdr& v) {
+    ie(PFCP_IE_PACKET_DETECTION_RULE_ID, v.pdr_id);
+    ie(PFCP_IE_F_TEID, v.local_fteid);
+  }
+
+  std::size_t length(const update_far& v) {
+    return ie_length(v.far_id) + ie_length(v.apply_action) +
+           ie_length(v.update_forwarding_parameters) + ie_length(v.bar_id);
+  }
+  void value(const update_far& v) {
+    ie(PFCP_IE_FAR_ID, v.far_id);
+    ie(PFCP_IE_APPLY_ACTION, v.apply_action);
+    ie(PFCP_IE_UPDATE_FORWARDING_PARAMETERS, v.update_forwarding_parameters);
+    ie(PFCP_IE_BAR_ID, v.bar_id);
+  }
+
+  std::size_t length(const remove_pdr& v) { return ie_length(v.pdr_id); }
+  void value(const remove_pdr& v) {
+    ie(PFCP_IE_PACKET_DETECTION_RULE_ID, v.pdr_id);
+  }
+
+  std::size_t length(const remove_far& v) { return ie_length(v.far_id); }
+  void value(const remove_far& v) { ie(PFCP_IE_FAR_ID, v.far_id); }
+
+  //----------------------------------------------------------------------------
+  // Messages, as the pfcp_msg constructors
+  // pfcp_create_urr_ie and pfcp_update_pdr_ie are encoded empty by pfcp_msg,
+  // the messages with these IEs keep these bytes
+  std::size_t length(const pfcp_session_establishment_request& s) {
+    not_handled(s.create_qers);
+    not_handled(s.create_traffic_endpoint);
+    not_handled(s.user_id);
+    not_handled(s.create_urrs);
+    return ie_length(s.node_id) + ie_length(s.cp_fseid) +
+           ie_length(s.create_pdrs) + ie_length(s.create_fars) +
+           ie_length(s.user_plane_inactivity_timer);
+  }
+  void value(const pfcp_session_establishment_request& s) {
+    ie(PFCP_IE_NODE_ID, s.node_id);
+    ie(PFCP_IE_F_SEID, s.cp_fseid);
+    ie(PFCP_IE_CREATE_PDR, s.create_pdrs);
+    ie(PFCP_IE_CREATE_FAR, s.create_fars);
+    ie(PFCP_IE_USER_PLANE_INACTIVITY_TIMER, s.user_plane_inactivity_timer);
+  }
+
+  std::size_t length(const pfcp_session_establishment_response& s) {
+    not_handled(s.failed_rule_id);
+    return ie_length(s.node_id) + ie_length(s.cause) +
+           ie_length(s.offending_ie) + ie_length(s.up_fseid) +
+           ie_length(s.created_pdrs);
+  }
+  void value(const pfcp_session_establishment_response& s) {
+    ie(PFCP_IE_NODE_ID, s.node_id);
+    ie(PFCP_IE_CAUSE, s.cause);
+    ie(PFCP_IE_OFFENDING_IE, s.offending_ie);
+    ie(PFCP_IE_F_SEID, s.up_fseid);
+    ie(PFCP_IE_CREATED_PDR, s.created_pdrs);
+  }
+
+  std::size_t length(const pfcp_session_modification_request& s) {
+    not_handled(s.remove_urrs);
+    not_handled(s.remove_qers);
+    not_handled(s.create_qers);
+    not_handled(s.create_traffic_endpoint);
+    not_handled(s.update_urrs);
+    not_handled(s.update_qers);
+    not_handled(s.create_urrs);
+    not_handled(s.update_pdrs);
+    return ie_length(s.cp_fseid) + ie_length(s.remove_pdrs) +
+           ie_length(s.remove_fars) + ie_length(s.create_pdrs) +
+           ie_length(s.create_fars) + ie_length(s.update_fars) +
+           ie_length(s.user_plane_inactivity_timer);
+  }
+  void value(const pfcp_session_modification_request& s) {
+    ie(PFCP_IE_F_SEID, s.cp_fseid);
+    ie(PFCP_IE_REMOVE_PDR, s.remove_pdrs);
+    ie(PFCP_IE_REMOVE_FAR, s.remove_fars);
+    ie(PFCP_IE_CREATE_PDR, s.create_pdrs);
+    ie(PFCP_IE_CREATE_FAR, s.create_fars);
+    ie(PFCP_IE_UPDATE_FAR, s.update_fars);
+    ie(PFCP_IE_USER_PLANE_INACTIVITY_TIMER, s.user_plane_inactivity_timer);
+  }
+
+  std::size_t length(const pfcp_session_modification_response& s) {
+    not_handled(s.usage_reports);
+    not_handled(s.failed_rule_id);
+    return ie_length(s.cause) + ie_length(s.offending_ie) +
+           ie_length(s.created_pdrs);
+  }
+  void value(const pfcp_session_modification_response& s) {
+    ie(PFCP_IE_CAUSE, s.cause);
+    ie(PFCP_IE_OFFENDING_IE, s.offending_ie);
+    ie(PFCP_IE_CREATED_PDR, s.created_pdrs);
+  }
+};
+
+//------------------------------------------------------------------------------
+class reader {
+ public:
+  const uint8_t* p;
+
+  explicit reader(const byte_span& b) : p(b.data) {}
+
+  uint8_t u8() { return *p++; }
+  uint16_t be16() {
+    uint16_t v = ((uint16_t) p[0] << 8) | p[1];
+    p += 2;
+    return v;
+  }
+  uint32_t be32() {
+    uint32_t v = ((uint32_t) be16() << 16);
+    return v | be16();
+  }
+  uint64_t be64() {
+    uint64_t v = ((uint64_t) be32() << 32);
+    return v | be32();
+  }
+  void bytes(void* v, const std::size_t n) {
+    memcpy(v, p, n);
+    p += n;
+  }
+  void str(std::string& s, const std::size_t n) {
+    s.assign(reinterpret_cast<const char*>(p), n);
+    p += n;
+  }
+};
+
+bool decode_ies(const byte_span& b, pfcp_ies_container& s);
+
+//------------------------------------------------------------------------------
+template<class T>
+bool decode_grouped(const byte_span& b, pfcp_ies_container& s) {
+  T v = {};
+  if (!decode_ies(b, v)) return false;
+  s.set(v);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// One IE set in s as pfcp_ie::to_core_type, false if the IE is not handled
+// or if its length is not the one of pfcp_ie::load_from
+bool decode_ie(const ie_view& ie, pfcp_ies_container& s) {
+  reader r(ie.value);
+  const std::size_t l = ie.value.size;
+  switch (ie.type) {
+    case PFCP_IE_CREATE_PDR:
+      return decode_grouped<create_pdr>(ie.value, s);
+    case PFCP_IE_PDI:
+      return decode_grouped<pdi>(ie.value, s);
+    case PFCP_IE_CREATE_FAR:
+      return decode_grouped<create_far>(ie.value, s);
+    case PFCP_IE_FORWARDING_PARAMETERS:
+      return decode_grouped<forwarding_parameters>(ie.value, s);
+    case PFCP_IE_CREATE_URR:
+      return decode_grouped<create_urr>(ie.value, s);
+    case PFCP_IE_CREATED_PDR:
+      return decode_grouped<created_pdr>(ie.value, s);
+    case PFCP_IE_UPDATE_PDR:
+      return decode_grouped<update_pdr>(ie.value, s);
+    case PFCP_IE_UPDATE_FAR:
+      return decode_grouped<update_far>(ie.value, s);
+    case PFCP_IE_UPDATE_FORWARDING_PARAMETERS:
+      return decode_grouped<update_forwarding_parameters>(ie.value, s);
+    case PFCP_IE_REMOVE_PDR:
+      return decode_grouped<remove_pdr>(ie.value, s);
+    case PFCP_IE_REMOVE_FAR:
+      return decode_grouped<remove_far>(ie.value, s);
+
+    case PFCP_IE_CAUSE: {
+      if (l != 1) return false;
+      pfcp::cause_t v = {};
+      v.cause_value   = r.u8();
+      s.set(v);
+    } break;
+    case PFCP_IE_OFFENDING_IE: {
+      if (l != 2) return false;
+      offending_ie_t v = {};
+      v.offending_ie   = r.be16();
+      s.set(v);
+    } break;
+    case PFCP_IE_SOURCE_INTERFACE: {
+      if (l != 1) return false;
+      source_interface_t v = {};
+      v.interface_value    = r.u8();
+      s.set(v);
+    } break;
+    case PFCP_IE_DESTINATION_INTERFACE: {
+      if (l != 1) return false;
+      destination_interface_t v = {};
+      v.interface_value         = r.u8();
+      s.set(v);
+    } break;
+    case PFCP_IE_NODE_ID: {
+      node_id_t v    = {};
+      v.node_id_type = r.u8() & 0x0F;
+      switch (v.node_id_type) {
+        case NODE_ID_TYPE_IPV4_ADDRESS:
+          if (l != 1 + 4) return false;
+          r.bytes(&v.u1.ipv4_address.s_addr, 4);
+          break;
+        case NODE_ID_TYPE_IPV6_ADDRESS:
+          if (l != 1 + 16) return false;
+          r.bytes(v.u1.ipv6_address.s6_addr, 16);
+          break;
+        case NODE_ID_TYPE_FQDN: {
+          if (l < 2) return false;
+          std::string dotted = {};
+          r.str(dotted, l - 1);
+          pfcp_ie::dotted_to_string(dotted, v.fqdn);
+        } break;
+        default:
+          return false;
+      }
+      s.set(v);
+    } break;
+    case PFCP_IE_F_SEID: {
+      uint8_t flags = r.u8();
+      fseid_t v     = {};
+      v.v6          = flags & 0x01;
+      v.v4          = (flags >> 1) & 0x01;
+      if (l != 9u + (v.v4 ? 4u : 0u) + (v.v6 ? 16u : 0u)) return false;
+      v.seid = r.be64();
+      if (v.v4) r.bytes(&v.ipv4_address.s_addr, 4);
+      if (v.v6) r.bytes(v.ipv6_address.s6_addr, 16);
+      s.set(v);
+    } break;
+    case PFCP_IE_F_TEID: {
+      uint8_t flags   = r.u8();
+      pfcp::fteid_t v = {};
+      v.v4            = flags & 0x01;
+      v.v6            = (flags >> 1) & 0x01;
+      v.ch            = (flags >> 2) & 0x01;
+      v.chid          = (flags >> 3) & 0x01;
+      if (v.ch) {
+        if (l != 1u + (v.chid ? 1u : 0u)) return false;
+        if (v.chid) v.choose_id = r.u8();
+      } else {
+        if (l != 5u + (v.v4 ? 4u : 0u) + (v.v6 ? 16u : 0u)) return false;
+        v.teid = r.be32();
+        if (v.v4) r.bytes(&v.ipv4_address.s_addr, 4);
+        if (v.v6) r.bytes(v.ipv6_address.s6_addr, 16);
+      }
+      s.set(v);
+    } break;
+    case PFCP_IE_NETWORK_INSTANCE: {
+      network_instance_t v = {};
+      r.str(v.network_instance, l);
+      s.set(v);
+    } break;
+    case PFCP_IE_UE_IP_ADDRESS: {
+      uint8_t flags     = r.u8();
+      ue_ip_address_t v = {};
+      v.v6              = flags & 0x01;
+      v.v4              = (flags >> 1) & 0x01;
+      v.sd              = (flags >> 2) & 0x01;
+      bool ipv6d        = (flags >> 3) & 0x01;
+      if (l != 1u + (v.v4 ? 4u : 0u) + (v.v6 ? (ipv6d ? 17u : 16u) : 0u))
+        return false;
+      if (v.v4) r.bytes(&v.ipv4_address.s_addr, 4);
+      if (v.v6) {
+        r.bytes(v.ipv6_address.s6_addr, 16);
+        v.ipv6d = ipv6d;
+        if (ipv6d) v.ipv6_prefix_delegation_bits = r.u8();
+      }
+      s.set(v);
+    } break;
+    case PFCP_IE_SDF_FILTER: {
+      if (l < 2) return false;
+      uint8_t flags      = r.u8();
+      sdf_filter_t v     = {};
+      v.fd               = flags & 0x01;
+      v.ttc              = (flags >> 1) & 0x01;
+      v.spi              = (flags >> 2) & 0x01;
+      v.fl               = (flags >> 3) & 0x01;
+      v.bid              = (flags >> 4) & 0x01;
+      std::size_t length = 2;
+      r.u8();
+      if (v.fd) {
+        if (l < 4) return false;
+        v.length_of_flow_description = r.be16();
+        length += 2 + v.length_of_flow_description;
+      }
+      length += (v.ttc ? 2 : 0) + (v.spi ? 4 : 0) + (v.fl ? 3 : 0) +
+                (v.bid ? 4 : 0);
+      if (l != length) return false;
+      if (v.fd) r.str(v.flow_description, v.length_of_flow_description);
+      if (v.ttc) r.str(v.tos_traffic_class, 2);
+      if (v.spi) r.str(v.security_parameter_index, 4);
+      if (v.fl) r.str(v.flow_label, 3);
+      if (v.bid) v.sdf_filter_id = r.be32();
+      s.set(v);
+    } break;
+    case PFCP_IE_APPLICATION_ID: {
+      application_id_t v = {};
+      r.str(v.application_id, l);
+      s.set(v);
+    } break;
+    case PFCP_IE_QFI: {
+      if (l != 1) return false;
+      qfi_t v = {};
+      v.qfi   = r.u8() & 0x3F;
+      s.set(v);
+    } break;
+    case PFCP_IE_PACKET_DETECTION_RULE_ID: {
+      if (l != 2) return false;
+      pdr_id_t v = {};
+      v.rule_id  = r.be16();
+      s.set(v);
+    } break;
+    case PFCP_IE_PRECEDENCE: {
+      if (l != 4) return false;
+      precedence_t v = {};
+      v.precedence   = r.be32();
+      s.set(v);
+    } break;
+    case PFCP_IE_FAR_ID: {
+      if (l != 4) return false;
+      far_id_t v = {};
+      v.far_id   = r.be32();
+      s.set(v);
+    } break;
+    case PFCP_IE_URR_ID: {
+      if (l != 4) return false;
+      urr_id_t v = {};
+      v.urr_id   = r.be32();
+      s.set(v);
+    } break;
+    case PFCP_IE_QER_ID: {
+      if (l != 4) return false;
+      qer_id_t v = {};
+      v.qer_id   = r.be32();
+      s.set(v);
+    } break;
+    case PFCP_IE_BAR_ID: {
+      if (l != 1) return false;
+      bar_id_t v = {};
+      v.bar_id   = r.u8();
+      s.set(v);
+    } break;
+    case PFCP_IE_OUTER_HEADER_REMOVAL: {
+      if (l != 1) return false;
+      outer_header_removal_t v           = {};
+      v.outer_header_removal_description = r.u8();
+      s.set(v);
+    } break;
+    case PFCP_IE_APPLY_ACTION: {
+      if (l != 1) return false;
+      uint8_t flags    = r.u8();
+      apply_action_t v = {};
+      v.drop           = flags & 0x01;
+      v.forw           = (flags >> 1) & 0x01;
+      v.buff           = (flags >> 2) & 0x01;
+      v.nocp           = (flags >> 3) & 0x01;
+      v.dupl           = (flags >> 4) & 0x01;
+      s.set(v);
+    } break;
+    case PFCP_IE_MEASUREMENT_METHOD: {
+      if (l != 1) return false;
+      uint8_t flags          = r.u8();
+      measurement_method_t v = {};
+      v.durat                = flags & 0x01;
+      v.volum                = (flags >> 1) & 0x01;
+      v.event                = (flags >> 2) & 0x01;
+      s.set(v);
+    } break;
+    case PFCP_IE_REPORTING_TRIGGERS: {
+      if (l != 2) return false;
+      uint8_t b1             = r.u8();
+      uint8_t b2             = r.u8();
+      reporting_triggers_t v = {};
+      v.perio                = b1 & 0x01;
+      v.volth                = (b1 >> 1) & 0x01;
+      v.timth                = (b1 >> 2) & 0x01;
+      v.quhti                = (b1 >> 3) & 0x01;
+      v.start                = (b1 >> 4) & 0x01;
+      v.stop                 = (b1 >> 5) & 0x01;
+      v.droth                = (b1 >> 6) & 0x01;
+      v.liusa                = (b1 >> 7) & 0x01;
+      v.volqu                = b2 & 0x01;
+      v.timqu                = (b2 >> 1) & 0x01;
+      v.envcl                = (b2 >> 2) & 0x01;
+      v.macar                = (b2 >> 3) & 0x01;
+      v.eveth                = (b2 >> 4) & 0x01;
+      s.set(v);
+    } break;
+    case PFCP_IE_MEASUREMENT_PERIOD: {
+      if (l != 4) return false;
+      measurement_period_t v = {};
+      v.measurement_period   = r.be32();
+      s.set(v);
+    } break;
+    case PFCP_IE_USER_PLANE_INACTIVITY_TIMER: {
+      if (l != 4) return false;
+      user_plane_inactivity_timer_t v = {};
+      v.user_plane_inactivity_timer   = r.be32();
+      s.set(v);
+    } break;
+    case PFCP_IE_OUTER_HEADER_CREATION: {
+      if (l < 4) return false;
+      outer_header_creation_t v           = {};
+      v.outer_header_creation_description = r.be16();
+      uint16_t d                          = v.outer_header_creation_description;
+      encoder e;
+      if (l != e.length(v)) return false;
+      if (d & (OUTER_HEADER_CREATION_GTPU_UDP_IPV4 |
+               OUTER_HEADER_CREATION_GTPU_UDP_IPV6))
+        v.teid = r.be32();
+      if (d & (OUTER_HEADER_CREATION_GTPU_UDP_IPV4 |
+               OUTER_HEADER_CREATION_UDP_IPV4))
+        r.bytes(&v.ipv4_address.s_addr, 4);
+      if (d & (OUTER_HEADER_CREATION_GTPU_UDP_IPV6 |
+               OUTER_HEADER_CREATION_UDP_IPV6))
+        r.bytes(v.ipv6_address.s6_addr, 16);
+      if (d & OUTER_HEADER_CREATION_UDP_IPV4) v.port_number = r.be16();
+      s.set(v);
+    } break;
+    case PFCP_IE_TRANSPORT_LEVEL_MARKING: {
+      if (l != 2) return false;
+      transport_level_marking_t v = {};
+      r.str(v.transport_level_marking, 2);
+      s.set(v);
+    } break;
+    case PFCP_IE_FORWARDING_POLICY: {
+      forwarding_policy_t v                 = {};
+      v.forwarding_policy_identifier_length = r.u8();
+      if (l != 1u + v.forwarding_policy_identifier_length) return false;
+      r.str(
+          v.forwarding_policy_identifier,
+          v.forwarding_policy_identifier_length);
+      s.set(v);
+    } break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool decode_ies(const byte_span& b, pfcp_ies_container& s) {
+  ie_cursor c(b);
+  ie_view ie = {};
+  while (c.next(ie)) {
+    if (!decode_ie(ie, s)) return false;
+  }
+  return !c.error();
+}
+
+//------------------------------------------------------------------------------
+template<class T>
+std::size_t message_length(const T& s) {
+  encoder e;
+  std::size_t l = PFCP_MSG_HEADER_MIN_SIZE + 8 + e.length(s);
+  if (!e.handled || (l > PFCP_CODEC_TLV_LENGTH + PFCP_CODEC_MAX_LENGTH))
+    return 0;
+  return l;
+}
+
+//------------------------------------------------------------------------------
+template<class T>
+std::size_t encode_message(
+    pfcp_msg_header& h, const uint8_t message_type, const T& s, uint8_t* buf,
+    const std::size_t size) {
+  std::size_t l = message_length(s);
+  if (!l) return 0;
+  if (!h.has_seid()) l -= 8;
+  if (l > size) return 0;
+  h.set_message_type(message_type);
+  h.set_message_length(l - PFCP_CODEC_TLV_LENGTH);
+  encoder e(buf);
+  e.header(h);
+  e.value(s);
+  return l;
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+bool ie_cursor::next(ie_view& ie) {
+  if (bad || (offset == ies.size)) return false;
+  if (ies.size - offset < PFCP_CODEC_TLV_LENGTH) {
+    bad = true;
+    return false;
+  }
+  const uint8_t* p = ies.data + offset;
+  uint16_t type    = ((uint16_t) p[0] << 8) | p[1];
+  uint16_t length  = ((uint16_t) p[2] << 8) | p[3];
+  if (!length || (type & 0x8000) ||
+      (length > ies.size - offset - PFCP_CODEC_TLV_LENGTH)) {
+    bad = true;
+    return false;
+  }
+  ie.type  = type;
+  ie.value = ies.subspan(offset + PFCP_CODEC_TLV_LENGTH, length);
+  offset += PFCP_CODEC_TLV_LENGTH + length;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+std::size_t pfcp::encoded_length(const pfcp_session_establishment_request& s) {
+  return message_length(s);
+}
+
+//------------------------------------------------------------------------------
+std::size_t pfcp::encoded_length(const pfcp_session_establishment_response& s) {
+  return message_length(s);
+}
+
+//------------------------------------------------------------------------------
+std::size_t pfcp::encoded_length(const pfcp_session_modification_request& s) {
+  return message_length(s);
+}
+
+//------------------------------------------------------------------------------
+std::size_t pfcp::encoded_length(const pfcp_session_modification_response& s) {
+  return message_length(s);
+}
+
+//------------------------------------------------------------------------------
+std::size_t pfcp::encode(
+    pfcp_msg_header& h, const pfcp_session_establishment_request& s,
+    uint8_t* buf, const std::size_t size) {
+  return encode_message(h, PFCP_SESSION_ESTABLISHMENT_REQUEST, s, buf, size);
+}
+
+//------------------------------------------------------------------------------
+std::size_t pfcp::encode(
+    pfcp_msg_header& h, const pfcp_session_establishment_response& s,
+    uint8_t* buf, const std::size_t size) {
+  return encode_message(h, PFCP_SESSION_ESTABLISHMENT_RESPONSE, s, buf, size);
+}
+
+//------------------------------------------------------------------------------
+std::size_t pfcp::encode(
+    pfcp_msg_header& h, const pfcp_session_modification_request& s,
+    uint8_t* buf, const std::size_t size) {
+  return encode_message(h, PFCP_SESSION_MODIFICATION_REQUEST, s, buf, size);
+}
+
+//------------------------------------------------------------------------------
+std::size_t pfcp::encode(
+    pfcp_msg_header& h, const pfcp_session_modification_response& s,
+    uint8_t* buf, const std::size_t size) {
+  return encode_message(h, PFCP_SESSION_MODIFICATION_RESPONSE, s, buf, size);
+}
+
+//------------------------------------------------------------------------------
+bool pfcp::decode(const byte_span& b, pfcp_msg_header& h) {
+  if (b.size < PFCP_MSG_HEADER_MIN_SIZE) return false;
+  reader r(b);
+  uint8_t flags = r.u8();
+  h.set_message_type(r.u8());
+  uint16_t length = r.be16();
+  if (flags & 0x01) {
+    if (b.size < PFCP_MSG_HEADER_MIN_SIZE + 8) return false;
+    h.set_seid(r.be64());
+  }
+  h.set_message_length(length);
+  uint32_t sn = (uint32_t) r.u8() << 16;
+  sn |= (uint32_t) r.u8() << 8;
+  h.set_sequence_number(sn | r.u8());
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool pfcp::decode(
+    const byte_span& b, const pfcp_msg_header& h, pfcp_ies_container& s) {
+  std::size_t header_length =
+      PFCP_MSG_HEADER_MIN_SIZE + (h.has_seid() ? 8 : 0);
+  std::size_t length = PFCP_CODEC_TLV_LENGTH + h.get_message_length();
+  if ((length < header_length) || (length > b.size)) return false;
+  return decode_ies(b.subspan(header_length, length - header_length), s);
+}
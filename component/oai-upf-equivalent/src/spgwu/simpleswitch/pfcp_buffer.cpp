@@ -0,0 +1,211 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_buffer.cpp
+   \brief Per session buffering of DL packets while the FAR has BUFF set
+   \date 2021
+*/
+
+#include <string.h>
+
+#include "pfcp_buffer.hpp"
+#include "pfcp_session.hpp"
+#include "pfcp_switch.hpp"
+#include "spgwu_s1u.hpp"
+#include "logger.hpp"
+
+using namespace pfcp;
+
+extern spgwu::pfcp_switch* pfcp_switch_inst;
+extern spgwu::spgwu_s1u* spgwu_s1u_inst;
+
+//------------------------------------------------------------------------------
+pfcp_dl_buffer::pfcp_dl_buffer()
+    : packets(0),
+      bytes(0),
+      dropped_overflow(0),
+      dropped_no_block(0),
+      dropped_aged(0),
+      dropped_discarded(0),
+      flushed_packets(0),
+      lock(),
+      ring(PFCP_DL_BUFFER_MAX_PACKETS),
+      head(0),
+      count(0),
+      total_bytes(0) {}
+
+//------------------------------------------------------------------------------
+void pfcp_dl_buffer::push(const dl_buffer_slot_t& slot) {
+  ring[(head + count) % PFCP_DL_BUFFER_MAX_PACKETS] = slot;
+  count++;
+  total_bytes += slot.num_bytes;
+}
+
+//------------------------------------------------------------------------------
+void pfcp_dl_buffer::push(
+    const uint32_t far_id, const char* buffer, const std::size_t len,
+    const uint64_t now) {
+  expire(now);
+  if ((count >= PFCP_DL_BUFFER_MAX_PACKETS) ||
+      (total_bytes + len > PFCP_DL_BUFFER_MAX_BYTES)) {
+    dropped_overflow.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  char* block = pfcp_switch_inst->get_dl_buffer_block();
+  if (not block) {
+    dropped_no_block.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  memcpy(block, buffer, len);
+  dl_buffer_slot_t slot = {};
+  slot.block            = block;
+  slot.num_bytes        = len;
+  slot.far_id           = far_id;
+  slot.enqueue_ns       = now;
+  push(slot);
+}
+
+//------------------------------------------------------------------------------
+dl_buffer_slot_t pfcp_dl_buffer::pop() {
+  dl_buffer_slot_t slot = ring[head];
+  head                  = (head + 1) % PFCP_DL_BUFFER_MAX_PACKETS;
+  count--;
+  total_bytes -= slot.num_bytes;
+  return slot;
+}
+
+//------------------------------------------------------------------------------
+void pfcp_dl_buffer::expire(const uint64_t now) {
+  const uint64_t max_age_ns = PFCP_DL_BUFFER_MAX_AGE_MS * 1000000ULL;
+  while ((count) && (now - ring[head].enqueue_ns > max_age_ns)) {
+    dl_buffer_slot_t slot = pop();
+    pfcp_switch_inst->release_dl_buffer_block(slot.block);
+    dropped_aged.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+//------------------------------------------------------------------------------
+void pfcp_dl_buffer::publish() {
+  packets.store(count, std::memory_order_relaxed);
+  bytes.store(total_bytes, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void pfcp_dl_buffer::enqueue(
+    const uint32_t far_id, const char* buffer, const std::size_t num_bytes) {
+  std::lock_guard<std::mutex> lg(lock);
+  push(far_id, buffer, num_bytes, now_ns());
+  publish();
+}
+
+//------------------------------------------------------------------------------
+bool pfcp_dl_buffer::enqueue_pending(
+    const uint32_t far_id, const char* buffer, const std::size_t num_bytes) {
+  std::lock_guard<std::mutex> lg(lock);
+  for (uint32_t i = 0; i < count; i++) {
+    if (ring[(head + i) % PFCP_DL_BUFFER_MAX_PACKETS].far_id == far_id) {
+      push(far_id, buffer, num_bytes, now_ns());
+      publish();
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+void pfcp_dl_buffer::drain() {
+  const uint64_t now = now_ns();
+  expire(now);
+  // Sent G-PDUs reference the blocks until the batch is flushed
+  char* sent[PFCP_DL_BUFFER_MAX_PACKETS];
+  uint32_t num_sent = 0;
+
+  spgwu_s1u_inst->begin_g_pdu_batch();
+  for (uint32_t n = count; n > 0; n--) {
+    dl_buffer_slot_t slot = pop();
+    switch (pfcp_switch_inst->forward_buffered_dl(
+        slot.block, slot.num_bytes, slot.far_id)) {
+      case PFCP_FWD_ACTION_FORW_ACCESS_GTPU:
+      case PFCP_FWD_ACTION_FORW_CORE:
+        sent[num_sent++] = slot.block;
+        break;
+      case PFCP_FWD_ACTION_BUFF:
+        // still buffering, order kept since every slot is rotated once
+        push(slot);
+        break;
+      default:
+        pfcp_switch_inst->release_dl_buffer_block(slot.block);
+        dropped_discarded.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  spgwu_s1u_inst->flush_g_pdu_batch();
+
+  for (uint32_t i = 0; i < num_sent; i++) {
+    pfcp_switch_inst->release_dl_buffer_block(sent[i]);
+  }
+  flushed_packets.fetch_add(num_sent, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void pfcp_dl_buffer::flush(const pfcp_session& session) {
+  std::lock_guard<std::mutex> lg(lock);
+  if (not count) return;
+  const uint64_t flushed = flushed_packets.load(std::memory_order_relaxed);
+  drain();
+  publish();
+  Logger::pfcp_switch().info(
+      "Session " SEID_FMT " DL buffer flushed %lu packets, %s",
+      session.get_up_seid(),
+      flushed_packets.load(std::memory_order_relaxed) - flushed,
+      to_string().c_str());
+}
+
+//------------------------------------------------------------------------------
+void pfcp_dl_buffer::clear() {
+  std::lock_guard<std::mutex> lg(lock);
+  while (count) {
+    dl_buffer_slot_t slot = pop();
+    pfcp_switch_inst->release_dl_buffer_block(slot.block);
+    dropped_discarded.fetch_add(1, std::memory_order_relaxed);
+  }
+  publish();
+}
+
+//------------------------------------------------------------------------------
+void pfcp_dl_buffer::add_stats(dl_buffer_stats_t& stats) const {
+  stats.packets += packets.load(std::memory_order_relaxed);
+  stats.bytes += bytes.load(std::memory_order_relaxed);
+  stats.dropped_overflow += dropped_overflow.load(std::memory_order_relaxed);
+  stats.dropped_no_block += dropped_no_block.load(std::memory_order_relaxed);
+  stats.dropped_aged += dropped_aged.load(std::memory_order_relaxed);
+  stats.dropped_discarded += dropped_discarded.load(std::memory_order_relaxed);
+  stats.flushed_packets += flushed_packets.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+std::string pfcp_dl_buffer::to_string() const {
+  return fmt::format(
+      "buffered {} packets {} bytes, dropped overflow {} no block {} aged {} "
+      "discarded {}, flushed {}",
+      packets.load(), bytes.load(), dropped_overflow.load(),
+      dropped_no_block.load(), dropped_aged.load(), dropped_discarded.load(),
+      flushed_packets.load());
+}
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_buffer.hpp
+   \brief Per session buffering of DL packets while the FAR has BUFF set
+   \date 2021
+*/
+
+#ifndef FILE_PFCP_BUFFER_HPP_SEEN
+#define FILE_PFCP_BUFFER_HPP_SEEN
+
+#include <time.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Caps of a session buffer, whichever is reached first
+#define PFCP_DL_BUFFER_MAX_PACKETS 256
+#define PFCP_DL_BUFFER_MAX_BYTES (256 * 1024)
+// Paging plus service request should fit, older packets are useless anyway
+#define PFCP_DL_BUFFER_MAX_AGE_MS 3000
+
+namespace pfcp {
+
+class pfcp_session;
+
+// Sum of the counters below over the sessions
+typedef struct dl_buffer_stats_s {
+  uint64_t packets;
+  uint64_t bytes;
+  uint64_t dropped_overflow;
+  uint64_t dropped_no_block;
+  uint64_t dropped_aged;
+  uint64_t dropped_discarded;
+  uint64_t flushed_packets;
+} dl_buffer_stats_t;
+
+typedef struct dl_buffer_slot_s {
+  char* block;  // from the pfcp_switch DL buffer pool, IP packet at block start
+  uint32_t num_bytes;
+  uint32_t far_id;      // FAR of the DL PDR the packet matched
+  uint64_t enqueue_ns;  // CLOCK_MONOTONIC
+} dl_buffer_slot_t;
+
+// Bounded FIFO of DL packets. Packets are copied by the pdn_worker / SGi
+// threads into blocks of the pfcp_switch pool, and sent in order by the
+// SPGWU_APP task when a Session Modification switches the FAR to FORW, with
+// the forwarding entries then published. The datapath never sends them.
+class pfcp_dl_buffer {
+ public:
+  // Occupancy
+  std::atomic<uint32_t> packets;
+  std::atomic<uint32_t> bytes;
+  // Drops
+  std::atomic<uint64_t> dropped_overflow;   // packet or byte cap reached
+  std::atomic<uint64_t> dropped_no_block;   // pfcp_switch pool exhausted
+  std::atomic<uint64_t> dropped_aged;       // older than the max age
+  std::atomic<uint64_t> dropped_discarded;  // FAR removed or set to DROP
+  std::atomic<uint64_t> flushed_packets;
+
+  pfcp_dl_buffer();
+  pfcp_dl_buffer(const pfcp_dl_buffer&) = delete;
+  void operator=(const pfcp_dl_buffer&) = delete;
+  ~pfcp_dl_buffer() { clear(); }
+
+  // Datapath side
+
+  // FAR asked for buffering
+  void enqueue(
+      const uint32_t far_id, const char* buffer, const std::size_t num_bytes);
+  // While packets of the FAR are still queued, newer ones go behind them
+  // whatever the FAR says, so that the flow is never reordered until the
+  // SPGWU_APP task flushes the queue. Return true if queued.
+  inline bool enqueue_if_pending(
+      const uint32_t far_id, const char* buffer, const std::size_t num_bytes) {
+    if (not packets.load(std::memory_order_relaxed)) return false;
+    return enqueue_pending(far_id, buffer, num_bytes);
+  }
+
+  // Control side, called by the SPGWU_APP task only
+
+  // Send the packets whose rule now forwards, keep the ones whose rule still
+  // buffers, drop the others.
+  void flush(const pfcp_session& session);
+  // Give all blocks back to the pool
+  void clear();
+
+  void add_stats(dl_buffer_stats_t& stats) const;
+  std::string to_string() const;
+
+ private:
+  std::mutex lock;
+  std::vector<dl_buffer_slot_t> ring;
+  uint32_t head;  // oldest packet
+  uint32_t count;
+  uint32_t total_bytes;
+
+  static inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  }
+
+  // lock held
+  void push(
+      const uint32_t far_id, const char* buffer, const std::size_t len,
+      const uint64_t now);
+  void push(const dl_buffer_slot_t& slot);
+  dl_buffer_slot_t pop();
+  void expire(const uint64_t now);
+  void drain();
+  // Occupancy counters are only published once a drain is over
+  void publish();
+
+  bool enqueue_pending(
+      const uint32_t far_id, const char* buffer, const std::size_t num_bytes);
+};
+}  // namespace pfcp
+
+#endif /* FILE_PFCP_BUFFER_HPP_SEEN */
@@ -71,7 +71,7 @@ void pfcp_far::apply_forwarding_rules(
                     spgwu_cfg.s1_up.port,
                     forwarding_parameters.second.outer_header_creation.second
                         .teid,
-                    reinterpret_cast<const char*>(iph), num_bytes);
+                    reinterpret_cast<const char*>(iph), num_bytes, qfi);
                 break;
               case OUTER_HEADER_CREATION_UDP_IPV4:  // TODO
               case OUTER_HEADER_CREATION_UDP_IPV6:  // TODO
@@ -0,0 +1,112 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_fwd.hpp
+   \brief Compiled forwarding entries looked up by the datapath
+   \date 2021
+*/
+
+#ifndef FILE_PFCP_FWD_HPP_SEEN
+#define FILE_PFCP_FWD_HPP_SEEN
+
+#include <netinet/in.h>
+
+#include <memory>
+#include <vector>
+
+#include "gtpu_template.hpp"
+#include "pfcp_qer.hpp"
+#include "pfcp_urr.hpp"
+
+// PDRs sharing a TEID or a UE address, more are ignored (logged)
+#define PFCP_FWD_MAX_RULES 8
+
+// FAR apply action and forwarding parameters, resolved at install time
+#define PFCP_FWD_ACTION_DROP 0
+#define PFCP_FWD_ACTION_FORW_ACCESS_GTPU 1
+#define PFCP_FWD_ACTION_FORW_CORE 2
+#define PFCP_FWD_ACTION_BUFF 3
+
+namespace pfcp {
+
+class pfcp_far;
+class pfcp_pdr;
+class pfcp_session;
+
+// One PDR with everything it refers to. Two cache lines, the pointed objects
+// are kept alive by the pfcp_fwd_entry holding the rule. The PDR and the FAR
+// are never modified once published (copy on write on Update PDR/FAR), the
+// QER and the URR are shared with the datapath through atomics.
+typedef struct alignas(64) pfcp_fwd_rule_s {
+  pfcp::pfcp_pdr* pdr;
+  pfcp::pfcp_qer* qer;  // nullptr if none
+  pfcp::pfcp_urr* urr;  // nullptr if none
+  uint8_t action;       // PFCP_FWD_ACTION_*
+  uint8_t nocp;
+  uint8_t qfi;  // DL G-PDU marking, resolved from the QER or the PDI
+  // UE address and/or SDF filter of the PDI have to be checked per packet
+  uint8_t match;
+  uint32_t far_id;  // DL buffering, the packets are queued per FAR
+  // slow path only
+  pfcp::pfcp_far* far;
+  // outer header creation, QFI included
+  gtpv1u::gtpu_g_pdu_template_t g_pdu;
+
+  // Return false if the packet has to be dropped
+  inline bool police_ul(const std::size_t num_bytes) const {
+    if ((qer) && (not qer->police_ul(num_bytes))) return false;
+    if (urr) {
+      if (urr->quota_exhausted.load(std::memory_order_relaxed)) return false;
+      urr->count_ul(num_bytes);
+    }
+    return true;
+  }
+  inline bool police_dl(const std::size_t num_bytes) const {
+    if ((qer) && (not qer->police_dl(num_bytes))) return false;
+    if (urr) {
+      if (urr->quota_exhausted.load(std::memory_order_relaxed)) return false;
+      urr->count_dl(num_bytes);
+    }
+    return true;
+  }
+} pfcp_fwd_rule_t;
+static_assert(sizeof(pfcp_fwd_rule_t) == 128, "two cache lines per rule");
+
+// Immutable once published: the Sx task builds a new entry on every change
+// of the session and retires the previous one through RCU, with the PDRs and
+// FARs it references, so the datapath reads it with plain loads and no
+// reference counting.
+class pfcp_fwd_entry {
+ public:
+  pfcp::pfcp_session* session;
+  uint8_t num_rules;
+  pfcp_fwd_rule_t rules[PFCP_FWD_MAX_RULES];  // ascending precedence
+
+  // Owners of the raw pointers above, released when the entry is reclaimed
+  std::shared_ptr<pfcp::pfcp_session> session_ref;
+  std::vector<std::shared_ptr<void>> refs;
+
+  explicit pfcp_fwd_entry(const std::shared_ptr<pfcp::pfcp_session>& s)
+      : session(s.get()), num_rules(0), rules(), session_ref(s), refs() {}
+};
+}  // namespace pfcp
+
+#endif /* FILE_PFCP_FWD_HPP_SEEN */
@@ -70,9 +70,7 @@ bool pfcp_pdr::look_up_pack_in_access(
     }
     // SDF filter
     if (pdi.second.sdf_filter.first) {
-      // TODO (create ss_pdi_t with ss_sdf_filter_t with optimized flow
-      // description matching )
-      return true;
+      return compiled_sdf_filter.match_ul(iph, num_bytes);
     }
     return true;  // No SDF filter actually
   } else {
@@ -108,21 +106,98 @@ bool pfcp_pdr::look_up_pack_in_core(
       return false;
     }
   }
-  // SDF filters TODO vector
-  // if (pdi.second.sdf_filter.first) {
-  // TODO (create ss_pdi_t with ss_sdf_filter_t with optimized flow description
-  // matching )
+  if (pdi.second.sdf_filter.first) {
+    return compiled_sdf_filter.match_dl(iph, num_bytes);
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool pfcp_pdr::look_up_pack_in_access(
+    struct ipv6hdr* const ip6h, const std::size_t num_bytes,
+    const endpoint& r_endpoint, const uint32_t tunnel_id) {
+  // implicit packet arrives from ACCESS interface
+  if (outer_header_removal.first) {
+    if (outer_header_removal.second.outer_header_removal_description !=
+        OUTER_HEADER_REMOVAL_GTPU_UDP_IPV4) {
+      return false;
+    }
+  } else {
+    // IPV4/UDP/GTP header already removed
+    return false;
+  }
+  if (pdi.first) {
+    if (pdi.second.source_interface.first) {
+      if (pdi.second.source_interface.second.interface_value !=
+          INTERFACE_VALUE_ACCESS) {
+        return false;
+      }
+    }
+    // local_fteid should be fine since pdr created for this fteid
+    if (pdi.second.local_fteid.first) {
+      if (pdi.second.local_fteid.second.teid != tunnel_id) {
+        return false;
+      }
+    }
+    if (pdi.second.ue_ip_address.first) {
+      if (!pdi.second.ue_ip_address.second.v6) {
+        return false;
+      }
+      if (ue_ipv6_prefix(pdi.second.ue_ip_address.second.ipv6_address) !=
+          ue_ipv6_prefix(ip6h->saddr)) {
+        return false;
+      }
+    }
+    // SDF filter
+    if (pdi.second.sdf_filter.first) {
+      return compiled_sdf_filter.match_ul(ip6h, num_bytes);
+    }
+    return true;  // No SDF filter actually
+  } else {
+    // Mandatory IE
+    return false;
+  }
+}
+//------------------------------------------------------------------------------
+bool pfcp_pdr::look_up_pack_in_core(
+    struct ipv6hdr* const ip6h, const std::size_t num_bytes) {
+  // implicit packet arrives from CORE interface
+  if (outer_header_removal.first) {
+    // TODO ... when necessary (split U)
+    return false;
+  }
+  if (pdi.second.ue_ip_address.first) {
+    if (!pdi.second.ue_ip_address.second.v6) {
+      return false;
+    }
+    if (ue_ipv6_prefix(pdi.second.ue_ip_address.second.ipv6_address) !=
+        ue_ipv6_prefix(ip6h->daddr)) {
+      return false;
+    }
+  }
+  if (pdi.second.sdf_filter.first) {
+    return compiled_sdf_filter.match_dl(ip6h, num_bytes);
+  }
   return true;
-  //}
-  // return false;
 }
 
 //------------------------------------------------------------------------------
 bool pfcp_pdr::update(const pfcp::update_pdr& update, uint8_t& cause_value) {
+  // Validated on a copy of the PDI: a rejected update leaves the PDR as it was
+  std::pair<bool, pfcp::pdi> updated_pdi = pdi;
+  pfcp::pfcp_sdf_filter updated_sdf_filter = {};
+  if (update.get(updated_pdi.second)) {
+    updated_pdi.first = true;
+    if (not compile_sdf_filter(updated_pdi, updated_sdf_filter)) {
+      cause_value = pfcp::CAUSE_VALUE_RULE_CREATION_MODIFICATION_FAILURE;
+      return false;
+    }
+    pdi                 = updated_pdi;
+    compiled_sdf_filter = updated_sdf_filter;
+  }
   if (update.get(outer_header_removal.second))
     outer_header_removal.first = true;
   if (update.get(precedence.second)) precedence.first = true;
-  if (update.get(pdi.second)) pdi.first = true;
   if (update.get(far_id.second)) far_id.first = true;
   if (update.get(urr_id.second)) urr_id.first = true;
   if (update.get(qer_id.second)) qer_id.first = true;
@@ -132,29 +207,45 @@ bool pfcp_pdr::update(const pfcp::update_pdr& update, uint8_t& cause_value) {
 }
 
 //------------------------------------------------------------------------------
-void pfcp_pdr::buffering_requested(
-    const char* buffer, const std::size_t num_bytes) {
-  Logger::spgwu_sx().warn("TODO pfcp_pdr::buffering_requested()");
-  /*
-    // TODO find smarter solution
-    char filename[] = "/tmp/buff_pdrzzzxxxyyy.XXXXXX";
-    int fd = mkstemp(filename);
+bool pfcp_pdr::compile_sdf_filter() {
+  return compile_sdf_filter(pdi, compiled_sdf_filter);
+}
 
-    if (fd == -1) return 1;
-    write(fd, buffer, num_bytes);
+//------------------------------------------------------------------------------
+bool pfcp_pdr::compile_sdf_filter(
+    const std::pair<bool, pfcp::pdi>& p,
+    pfcp::pfcp_sdf_filter& compiled) const {
+  if ((not p.first) || (not p.second.sdf_filter.first)) {
+    compiled = {};
+    return true;
+  }
+  const pfcp::sdf_filter_t& sdf_filter = p.second.sdf_filter.second;
+  // TODO ToS, SPI, flow label, only flow description is matched
+  if ((not sdf_filter.fd) ||
+      (not compiled.compile(sdf_filter.flow_description))) {
+    Logger::spgwu_sx().warn(
+        "PDR id %4x: unsupported SDF filter flow description \"%s\"",
+        pdr_id.rule_id, sdf_filter.flow_description.c_str());
+    return false;
+  }
+  Logger::spgwu_sx().debug(
+      "PDR id %4x: SDF filter \"%s\" compiled in %d rule(s)", pdr_id.rule_id,
+      sdf_filter.flow_description.c_str(), compiled.get_num_rules());
+  return true;
+}
 
-    close(fd);
-    unlink(filename);
-    num_packets++
-   */
+//------------------------------------------------------------------------------
+void pfcp_pdr::buffering_requested(
+    std::shared_ptr<pfcp::pfcp_session> session, const uint32_t far_id,
+    const char* buffer, const std::size_t num_bytes) {
+  session->dl_buffer.enqueue(far_id, buffer, num_bytes);
 }
 
 //------------------------------------------------------------------------------
 void pfcp_pdr::notify_cp_requested(
     std::shared_ptr<pfcp::pfcp_session> session) {
-  if (not notified_cp) {
+  if (not notified_cp.exchange(true, std::memory_order_relaxed)) {
     Logger::spgwu_sx().trace("notify_cp_requested()");
-    notified_cp = true;
 
     pfcp::pfcp_session_report_request h;
 
@@ -30,14 +30,29 @@
 
 #include <linux/ip.h>
 #include <linux/ipv6.h>
+#include <endian.h>
+#include <string.h>
 #include "endpoint.hpp"
 #include "msg_pfcp.hpp"
+#include "pfcp_sdf_filter.hpp"
+#include <atomic>
 #include <mutex>
 
 namespace pfcp {
 
 class pfcp_session;
 
+// UE IPv6 addresses are matched on their /64 prefix (TS 23.501 5.8.2.2.2),
+// returned in host byte order
+inline uint64_t ue_ipv6_prefix(const struct in6_addr& a) {
+  uint64_t prefix;
+  memcpy(&prefix, a.s6_addr, sizeof(prefix));
+  return be64toh(prefix);
+}
+
+// Not modified once referenced by a published forwarding entry, Update PDR
+// replaces the PDR of the session by an updated copy (pfcp_session::update)
+// except notified_cp, set by the datapath.
 class pfcp_pdr {
  public:
   mutable std::mutex lock;
@@ -50,8 +65,10 @@ class pfcp_pdr {
   std::pair<bool, pfcp::urr_id_t> urr_id;
   std::pair<bool, pfcp::qer_id_t> qer_id;
   std::pair<bool, pfcp::activate_predefined_rules_t> activate_predefined_rules;
+  // flow description of pdi.sdf_filter, parsed once for the datapath
+  pfcp::pfcp_sdf_filter compiled_sdf_filter;
 
-  bool notified_cp;
+  std::atomic<bool> notified_cp;
 
   explicit pfcp_pdr(uint64_t lseid)
       : lock(),
@@ -64,6 +81,7 @@ class pfcp_pdr {
         urr_id(),
         qer_id(),
         activate_predefined_rules(),
+        compiled_sdf_filter(),
         notified_cp(false) {}
 
   explicit pfcp_pdr(const pfcp::create_pdr& c)
@@ -77,6 +95,7 @@ class pfcp_pdr {
         urr_id(c.urr_id),
         qer_id(c.qer_id),
         activate_predefined_rules(c.activate_predefined_rules),
+        compiled_sdf_filter(),
         notified_cp(false) {}
 
   pfcp_pdr(const pfcp_pdr& c)
@@ -88,7 +107,8 @@ class pfcp_pdr {
         urr_id(c.urr_id),
         qer_id(c.qer_id),
         activate_predefined_rules(c.activate_predefined_rules),
-        notified_cp(c.notified_cp) {
+        compiled_sdf_filter(c.compiled_sdf_filter),
+        notified_cp(c.notified_cp.load(std::memory_order_relaxed)) {
     local_seid = c.local_seid;
     pdr_id     = c.pdr_id;
   }
@@ -184,14 +204,26 @@ class pfcp_pdr {
   }
 
   bool update(const pfcp::update_pdr& update, uint8_t& cause_value);
+  // Returns false if the SDF filter of the PDI cannot be handled
+  bool compile_sdf_filter();
+  bool compile_sdf_filter(
+      const std::pair<bool, pfcp::pdi>& p,
+      pfcp::pfcp_sdf_filter& compiled) const;
 
   bool look_up_pack_in_access(
       struct iphdr* const iph, const std::size_t num_bytes,
       const endpoint& r_endpoint, const uint32_t tunnel_id);
   bool look_up_pack_in_core(
       struct iphdr* const iph, const std::size_t num_bytes);
+  bool look_up_pack_in_access(
+      struct ipv6hdr* const ip6h, const std::size_t num_bytes,
+      const endpoint& r_endpoint, const uint32_t tunnel_id);
+  bool look_up_pack_in_core(
+      struct ipv6hdr* const ip6h, const std::size_t num_bytes);
 
-  void buffering_requested(const char* buffer, const std::size_t num_bytes);
+  void buffering_requested(
+      std::shared_ptr<pfcp::pfcp_session> session, const uint32_t far_id,
+      const char* buffer, const std::size_t num_bytes);
   void notify_cp_requested(std::shared_ptr<pfcp::pfcp_session> session);
 
   // For sorting in collections
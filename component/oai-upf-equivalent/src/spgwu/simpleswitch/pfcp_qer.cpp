@@ -0,0 +1,85 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file pfcp_qer.cpp
+   \brief QoS Enforcement Rule: gate status and MBR policing
+   \date 2021
+*/
+
+#include "pfcp_qer.hpp"
+#include "logger.hpp"
+
+using namespace pfcp;
+
+//------------------------------------------------------------------------------
+void pfcp_token_bucket::set_rate(const uint64_t rate_kbps, const bool fill) {
+  const uint64_t r = (rate_kbps * 1000) / 8;
+  int64_t b        = (r * PFCP_QER_BURST_MS) / 1000;
+  if (b < PFCP_QER_MIN_BURST_BYTES) b = PFCP_QER_MIN_BURST_BYTES;
+  burst.store(b, std::memory_order_relaxed);
+  if (fill) {
+    tokens.store(b, std::memory_order_relaxed);
+  } else {
+    int64_t t = tokens.load(std::memory_order_relaxed);
+    while ((t > b) && (not tokens.compare_exchange_weak(
+                          t, b, std::memory_order_relaxed))) {
+    }
+  }
+  rate.store(r, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void pfcp_qer::apply(const bool created) {
+  if (gate_status.first) {
+    ul_gate_open.store(
+        gate_status.second.ul_gate == pfcp::OPEN, std::memory_order_relaxed);
+    dl_gate_open.store(
+        gate_status.second.dl_gate == pfcp::OPEN, std::memory_order_relaxed);
+  }
+  if (maximum_bitrate.first) {
+    ul_mbr.set_rate(maximum_bitrate.second.ul_mbr, created);
+    dl_mbr.set_rate(maximum_bitrate.second.dl_mbr, created);
+  }
+}
+
+//------------------------------------------------------------------------------
+bool pfcp_qer::update(const pfcp::update_qer& update, uint8_t& cause_value) {
+  if (update.get(qer_correlation_id.second)) qer_correlation_id.first = true;
+  if (update.get(gate_status.second)) gate_status.first = true;
+  if (update.get(maximum_bitrate.second)) maximum_bitrate.first = true;
+  if (update.get(guaranteed_bitrate.second)) guaranteed_bitrate.first = true;
+  if (update.get(qos_flow_identifier.second)) qos_flow_identifier.first = true;
+  // TODO packet_rate, dl_flow_level_marking, reflective_qos
+  apply(false);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+std::string pfcp_qer::to_string() const {
+  return fmt::format(
+      "QER {:08x} gate UL {} DL {} MBR UL {} DL {} kbps, dropped UL {} DL {}",
+      qer_id.qer_id, ul_gate_open.load() ? "open" : "closed",
+      dl_gate_open.load() ? "open" : "closed",
+      maximum_bitrate.first ? maximum_bitrate.second.ul_mbr : 0,
+      maximum_bitrate.first ? maximum_bitrate.second.dl_mbr : 0,
+      ul_dropped_packets.load(), dl_dropped_packets.load());
+}
@@ -0,0 +1,156 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_qer.hpp
+   \brief QoS Enforcement Rule: gate status and MBR policing
+   \date 2021
+*/
+
+#ifndef FILE_PFCP_QER_HPP_SEEN
+#define FILE_PFCP_QER_HPP_SEEN
+
+#include <time.h>
+
+#include <atomic>
+
+#include "msg_pfcp.hpp"
+
+// Bucket depth expressed in time at MBR
+#define PFCP_QER_BURST_MS 100
+// Bucket depth never below a couple of full sized packets
+#define PFCP_QER_MIN_BURST_BYTES 3000
+
+namespace pfcp {
+
+// Token bucket in bytes, refilled lazily from the packet timestamps. All state
+// is atomic: several pdn_worker / S1U threads may police the same QER while
+// the Sx task updates the rate.
+class pfcp_token_bucket {
+ public:
+  pfcp_token_bucket() : rate(0), burst(0), tokens(0), last_ns(0) {}
+
+  // rate_kbps as in the MBR IE (kbit/s), 0 disables policing. The bucket is
+  // filled if fill, otherwise it keeps its tokens up to the new burst.
+  void set_rate(const uint64_t rate_kbps, const bool fill);
+
+  inline bool consume(const std::size_t num_bytes, const uint64_t now_ns) {
+    const uint64_t r = rate.load(std::memory_order_relaxed);
+    if (not r) return true;
+    const int64_t b = burst.load(std::memory_order_relaxed);
+
+    uint64_t last = last_ns.load(std::memory_order_relaxed);
+    // only the thread that moves last_ns forward credits the elapsed interval
+    if ((now_ns > last) &&
+        last_ns.compare_exchange_strong(
+            last, now_ns, std::memory_order_relaxed)) {
+      const uint64_t elapsed = now_ns - last;
+      int64_t credit         = b;
+      if (elapsed < 1000000000ULL) {
+        credit = ((unsigned __int128) elapsed * r) / 1000000000ULL;
+      }
+      int64_t t = tokens.fetch_add(credit, std::memory_order_relaxed) + credit;
+      while ((t > b) && (not tokens.compare_exchange_weak(
+                            t, b, std::memory_order_relaxed))) {
+      }
+    }
+    const int64_t len = num_bytes;
+    if (tokens.fetch_sub(len, std::memory_order_relaxed) < len) {
+      tokens.fetch_add(len, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  std::atomic<uint64_t> rate;     // bytes per second
+  std::atomic<int64_t> burst;     // bytes
+  std::atomic<int64_t> tokens;    // bytes
+  std::atomic<uint64_t> last_ns;  // CLOCK_MONOTONIC
+};
+
+class pfcp_qer {
+ public:
+  pfcp::qer_id_t qer_id;
+  std::pair<bool, pfcp::qer_correlation_id_t> qer_correlation_id;
+  std::pair<bool, pfcp::gate_status_t> gate_status;
+  std::pair<bool, pfcp::mbr_t> maximum_bitrate;
+  std::pair<bool, pfcp::gbr_t> guaranteed_bitrate;
+  std::pair<bool, pfcp::qfi_t> qos_flow_identifier;
+
+  // Datapath view of the IEs above
+  std::atomic<bool> ul_gate_open;
+  std::atomic<bool> dl_gate_open;
+  pfcp_token_bucket ul_mbr;
+  pfcp_token_bucket dl_mbr;
+  std::atomic<uint64_t> ul_dropped_packets;
+  std::atomic<uint64_t> dl_dropped_packets;
+
+  explicit pfcp_qer(const pfcp::create_qer& c)
+      : qer_id(c.qer_id.second),
+        qer_correlation_id(c.qer_correlation_id),
+        gate_status(c.gate_status),
+        maximum_bitrate(c.maximum_bitrate),
+        guaranteed_bitrate(c.guaranteed_bitrate),
+        qos_flow_identifier(c.qos_flow_identifier),
+        ul_gate_open(true),
+        dl_gate_open(true),
+        ul_mbr(),
+        dl_mbr(),
+        ul_dropped_packets(0),
+        dl_dropped_packets(0) {
+    apply(true);
+  }
+
+  bool update(const pfcp::update_qer& update, uint8_t& cause_value);
+
+  static inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  }
+
+  // Return false if the packet has to be dropped
+  inline bool police_ul(const std::size_t num_bytes) {
+    if ((ul_gate_open.load(std::memory_order_relaxed)) &&
+        (ul_mbr.consume(num_bytes, now_ns()))) {
+      return true;
+    }
+    ul_dropped_packets.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  inline bool police_dl(const std::size_t num_bytes) {
+    if ((dl_gate_open.load(std::memory_order_relaxed)) &&
+        (dl_mbr.consume(num_bytes, now_ns()))) {
+      return true;
+    }
+    dl_dropped_packets.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  std::string to_string() const;
+
+ private:
+  // created: the token buckets start full, an update does not refill them
+  void apply(const bool created);
+};
+}  // namespace pfcp
+
+#endif
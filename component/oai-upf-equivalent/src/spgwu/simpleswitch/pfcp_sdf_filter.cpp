@@ -0,0 +1,241 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_sdf_filter.cpp
+   \brief SDF filter compiled from an IPFilterRule flow description
+   \date 2021
+*/
+
+#include "pfcp_sdf_filter.hpp"
+
+#include <sstream>
+#include <vector>
+
+using namespace pfcp;
+
+namespace {
+
+typedef struct port_range_s {
+  uint16_t lo;
+  uint16_t hi;
+} port_range_t;
+
+typedef struct sdf_address_s {
+  uint8_t ip_version;  // 0 any, 4 or 6
+  uint32_t addr;
+  uint32_t mask;
+  struct in6_addr addr6;
+  struct in6_addr mask6;
+} sdf_address_t;
+
+//------------------------------------------------------------------------------
+bool parse_uint(const std::string& s, const unsigned long max, uint32_t& v) {
+  if (s.empty() || (s.size() > 10)) return false;
+  unsigned long r = 0;
+  for (const char c : s) {
+    if ((c < '0') || (c > '9')) return false;
+    r = r * 10 + (c - '0');
+  }
+  if (r > max) return false;
+  v = r;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool parse_proto(const std::string& s, uint8_t& proto) {
+  uint32_t v = 0;
+  if (s == "ip") {
+    proto = 0;
+  } else if (s == "icmp") {
+    proto = IPPROTO_ICMP;
+  } else if (s == "tcp") {
+    proto = IPPROTO_TCP;
+  } else if (s == "udp") {
+    proto = IPPROTO_UDP;
+  } else if (s == "sctp") {
+    proto = IPPROTO_SCTP;
+  } else if (parse_uint(s, 255, v)) {
+    proto = v;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool parse_address(const std::string& s, sdf_address_t& a) {
+  a = {};
+  // "assigned": UE address, already checked with the PDI UE IP address
+  if ((s == "any") || (s == "assigned")) return true;
+
+  std::string host  = s;
+  uint32_t prefix   = 0;
+  bool has_prefix   = false;
+  std::size_t slash = s.find('/');
+  if (slash != std::string::npos) {
+    host       = s.substr(0, slash);
+    has_prefix = true;
+    if (not parse_uint(s.substr(slash + 1), 128, prefix)) return false;
+  }
+  struct in_addr in4  = {};
+  struct in6_addr in6 = {};
+  if (inet_pton(AF_INET, host.c_str(), &in4) == 1) {
+    if (not has_prefix) prefix = 32;
+    if (prefix > 32) return false;
+    a.ip_version = 4;
+    a.mask       = (prefix) ? htonl(0xFFFFFFFFu << (32 - prefix)) : 0;
+    a.addr       = in4.s_addr & a.mask;
+    return true;
+  }
+  if (inet_pton(AF_INET6, host.c_str(), &in6) == 1) {
+    if (not has_prefix) prefix = 128;
+    a.ip_version = 6;
+    for (uint32_t i = 0; i < 16; i++) {
+      const uint32_t bits = (prefix > 8 * i) ? prefix - 8 * i : 0;
+      a.mask6.s6_addr[i]  = (bits >= 8) ? 0xFF : (uint8_t)(0xFF00 >> bits);
+      a.addr6.s6_addr[i]  = in6.s6_addr[i] & a.mask6.s6_addr[i];
+    }
+    return true;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+bool parse_ports(const std::string& s, std::vector<port_range_t>& ports) {
+  std::istringstream iss(s);
+  std::string item;
+  while (std::getline(iss, item, ',')) {
+    uint32_t lo      = 0;
+    uint32_t hi      = 0;
+    std::size_t dash = item.find('-');
+    if (dash == std::string::npos) {
+      if (not parse_uint(item, 65535, lo)) return false;
+      hi = lo;
+    } else {
+      if (not parse_uint(item.substr(0, dash), 65535, lo)) return false;
+      if (not parse_uint(item.substr(dash + 1), 65535, hi)) return false;
+      if (lo > hi) return false;
+    }
+    ports.push_back({.lo = (uint16_t) lo, .hi = (uint16_t) hi});
+  }
+  return not ports.empty();
+}
+
+//------------------------------------------------------------------------------
+bool is_ports(const std::string& s) {
+  return (not s.empty()) && (s[0] >= '0') && (s[0] <= '9') &&
+         (s.find_first_of(".:") == std::string::npos);
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+bool pfcp_sdf_filter::compile(const std::string& flow_description) {
+  num_rules = 0;
+
+  std::istringstream iss(flow_description);
+  std::vector<std::string> tokens;
+  std::string token;
+  while (iss >> token) tokens.push_back(token);
+
+  std::size_t i = 0;
+  // action, only permit is meaningful for SDF filters
+  if ((i >= tokens.size()) || (tokens[i++] != "permit")) return false;
+  // direction, "out" describes downlink (from remote to UE)
+  if (i >= tokens.size()) return false;
+  const std::string& dir = tokens[i++];
+  if ((dir != "out") && (dir != "in")) return false;
+
+  uint8_t proto = 0;
+  if ((i >= tokens.size()) || (not parse_proto(tokens[i++], proto)))
+    return false;
+
+  sdf_address_t src = {};
+  sdf_address_t dst = {};
+  std::vector<port_range_t> src_ports;
+  std::vector<port_range_t> dst_ports;
+
+  if ((i >= tokens.size()) || (tokens[i++] != "from")) return false;
+  if ((i >= tokens.size()) || (not parse_address(tokens[i++], src)))
+    return false;
+  if ((i < tokens.size()) && is_ports(tokens[i])) {
+    if (not parse_ports(tokens[i++], src_ports)) return false;
+  }
+  if ((i >= tokens.size()) || (tokens[i++] != "to")) return false;
+  if ((i >= tokens.size()) || (not parse_address(tokens[i++], dst)))
+    return false;
+  if ((i < tokens.size()) && is_ports(tokens[i])) {
+    if (not parse_ports(tokens[i++], dst_ports)) return false;
+  }
+  // options (frag, ipoptions, tcpflags, ...) not supported
+  if (i != tokens.size()) return false;
+
+  if ((src.ip_version) && (dst.ip_version) &&
+      (src.ip_version != dst.ip_version))
+    return false;
+
+  const bool check_ports = (not src_ports.empty()) || (not dst_ports.empty());
+  if (check_ports) {
+    if ((proto != IPPROTO_TCP) && (proto != IPPROTO_UDP) &&
+        (proto != IPPROTO_SCTP) && (proto != 0))
+      return false;
+  }
+  if (src_ports.empty()) src_ports.push_back({.lo = 0, .hi = 65535});
+  if (dst_ports.empty()) dst_ports.push_back({.lo = 0, .hi = 65535});
+  if (src_ports.size() * dst_ports.size() > PFCP_SDF_FILTER_MAX_RULES)
+    return false;
+
+  // "in" rules are written from the UE point of view
+  const sdf_address_t& remote = (dir == "out") ? src : dst;
+  const sdf_address_t& local  = (dir == "out") ? dst : src;
+  const std::vector<port_range_t>& remote_ports =
+      (dir == "out") ? src_ports : dst_ports;
+  const std::vector<port_range_t>& local_ports =
+      (dir == "out") ? dst_ports : src_ports;
+
+  // "any" addresses only: the rule applies to both IP versions
+  const uint8_t ip_version =
+      (remote.ip_version) ? remote.ip_version : local.ip_version;
+  uint8_t n = 0;
+  for (const auto& rp : remote_ports) {
+    for (const auto& lp : local_ports) {
+      sdf_rule_t& r    = rules[n++];
+      r                = {};
+      r.proto          = proto;
+      r.ip_version     = ip_version;
+      r.check_ports    = check_ports;
+      r.remote_addr    = remote.addr;
+      r.remote_mask    = remote.mask;
+      r.local_addr     = local.addr;
+      r.local_mask     = local.mask;
+      r.remote_port_lo = rp.lo;
+      r.remote_port_hi = rp.hi;
+      r.local_port_lo  = lp.lo;
+      r.local_port_hi  = lp.hi;
+      r.remote_addr6   = remote.addr6;
+      r.remote_mask6   = remote.mask6;
+      r.local_addr6    = local.addr6;
+      r.local_mask6    = local.mask6;
+    }
+  }
+  num_rules = n;
+  return true;
+}
@@ -0,0 +1,220 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_sdf_filter.hpp
+   \brief SDF filter compiled from an IPFilterRule flow description
+   \date 2021
+*/
+
+#ifndef FILE_PFCP_SDF_FILTER_HPP_SEEN
+#define FILE_PFCP_SDF_FILTER_HPP_SEEN
+
+#include <arpa/inet.h>
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <netinet/in.h>
+#include <string.h>
+
+#include <cstdint>
+#include <string>
+
+// Max number of rules a single flow description can expand to (port lists)
+#define PFCP_SDF_FILTER_MAX_RULES 8
+
+namespace pfcp {
+
+// One flattened match rule. "remote" is the source of the IPFilterRule in the
+// "out" direction (the peer on the N6/SGi side), "local" is the UE side.
+// Addresses and masks are in network byte order, ports in host byte order.
+typedef struct sdf_rule_s {
+  uint8_t proto;       // 0 means any
+  uint8_t ip_version;  // 0 (no address given), 4 or 6
+  uint8_t check_ports;
+  uint8_t spare;
+  uint32_t remote_addr;
+  uint32_t remote_mask;
+  uint32_t local_addr;
+  uint32_t local_mask;
+  uint16_t remote_port_lo;
+  uint16_t remote_port_hi;
+  uint16_t local_port_lo;
+  uint16_t local_port_hi;
+  // ip_version 6 only
+  struct in6_addr remote_addr6;
+  struct in6_addr remote_mask6;
+  struct in6_addr local_addr6;
+  struct in6_addr local_mask6;
+} sdf_rule_t;
+
+class pfcp_sdf_filter {
+ public:
+  pfcp_sdf_filter() : num_rules(0), rules() {}
+
+  // Parse a flow description (TS 29.244 5.2.1A.2, RFC 6733 IPFilterRule):
+  //   permit out <proto> from <addr[/mask]|any> [ports] to <addr|assigned|any>
+  //   [ports]
+  // Returns false on any unsupported or malformed token, the filter is then
+  // left empty and matches nothing.
+  bool compile(const std::string& flow_description);
+
+  uint8_t get_num_rules() const { return num_rules; }
+
+  // Packet received from the access side, UE is the source
+  bool match_ul(const struct iphdr* const iph, const std::size_t num_bytes)
+      const {
+    return match<true>(iph, num_bytes);
+  }
+  // Packet received from the core side, UE is the destination
+  bool match_dl(const struct iphdr* const iph, const std::size_t num_bytes)
+      const {
+    return match<false>(iph, num_bytes);
+  }
+  bool match_ul(const struct ipv6hdr* const ip6h, const std::size_t num_bytes)
+      const {
+    return match6<true>(ip6h, num_bytes);
+  }
+  bool match_dl(const struct ipv6hdr* const ip6h, const std::size_t num_bytes)
+      const {
+    return match6<false>(ip6h, num_bytes);
+  }
+
+ private:
+  uint8_t num_rules;
+  sdf_rule_t rules[PFCP_SDF_FILTER_MAX_RULES];
+
+  template <bool uplink>
+  bool match(const struct iphdr* const iph, const std::size_t num_bytes) const {
+    if ((num_bytes < sizeof(struct iphdr)) || (iph->version != 4)) {
+      return false;
+    }
+    const uint32_t remote_addr = (uplink) ? iph->daddr : iph->saddr;
+    const uint32_t local_addr  = (uplink) ? iph->saddr : iph->daddr;
+    // L4 ports only available in first fragment
+    bool has_ports       = false;
+    uint16_t remote_port = 0;
+    uint16_t local_port  = 0;
+    const std::size_t ihl = iph->ihl << 2;
+    if (((iph->protocol == IPPROTO_TCP) || (iph->protocol == IPPROTO_UDP) ||
+         (iph->protocol == IPPROTO_SCTP)) &&
+        ((iph->frag_off & htons(0x1FFF)) == 0) && (num_bytes >= ihl + 4)) {
+      const uint8_t* l4    = reinterpret_cast<const uint8_t*>(iph) + ihl;
+      const uint16_t sport = (l4[0] << 8) | l4[1];
+      const uint16_t dport = (l4[2] << 8) | l4[3];
+      remote_port          = (uplink) ? dport : sport;
+      local_port           = (uplink) ? sport : dport;
+      has_ports            = true;
+    }
+    for (int i = 0; i < num_rules; i++) {
+      const sdf_rule_t& r = rules[i];
+      if ((r.proto) && (r.proto != iph->protocol)) continue;
+      if (r.ip_version == 6) continue;
+      if ((remote_addr & r.remote_mask) != r.remote_addr) continue;
+      if ((local_addr & r.local_mask) != r.local_addr) continue;
+      if (r.check_ports) {
+        if (not has_ports) continue;
+        if ((remote_port < r.remote_port_lo) ||
+            (remote_port > r.remote_port_hi))
+          continue;
+        if ((local_port < r.local_port_lo) || (local_port > r.local_port_hi))
+          continue;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  static inline bool match_prefix6(
+      const struct in6_addr& a, const struct in6_addr& addr,
+      const struct in6_addr& mask) {
+    uint64_t w[2], v[2], m[2];
+    memcpy(w, &a, sizeof(w));
+    memcpy(v, &addr, sizeof(v));
+    memcpy(m, &mask, sizeof(m));
+    return (((w[0] & m[0]) == v[0]) && ((w[1] & m[1]) == v[1]));
+  }
+
+  template <bool uplink>
+  bool match6(const struct ipv6hdr* const ip6h, const std::size_t num_bytes)
+      const {
+    if ((num_bytes < sizeof(struct ipv6hdr)) || (ip6h->version != 6)) {
+      return false;
+    }
+    const struct in6_addr& remote_addr = (uplink) ? ip6h->daddr : ip6h->saddr;
+    const struct in6_addr& local_addr  = (uplink) ? ip6h->saddr : ip6h->daddr;
+    // Walk the extension headers up to the upper layer header, L4 ports only
+    // available in first fragment
+    const uint8_t* p    = reinterpret_cast<const uint8_t*>(ip6h);
+    uint8_t proto       = ip6h->nexthdr;
+    std::size_t off     = sizeof(struct ipv6hdr);
+    bool first_fragment = true;
+    for (int n = 0; n < 4; n++) {
+      if ((proto != IPPROTO_HOPOPTS) && (proto != IPPROTO_ROUTING) &&
+          (proto != IPPROTO_DSTOPTS) && (proto != IPPROTO_FRAGMENT))
+        break;
+      if (num_bytes < off + 8) return false;
+      if (proto == IPPROTO_FRAGMENT) {
+        first_fragment = (((p[off + 2] << 8) | p[off + 3]) & 0xFFF8) == 0;
+        proto          = p[off];
+        off += 8;
+      } else {
+        proto = p[off];
+        off += (p[off + 1] + 1) << 3;
+      }
+    }
+    bool has_ports       = false;
+    uint16_t remote_port = 0;
+    uint16_t local_port  = 0;
+    if (((proto == IPPROTO_TCP) || (proto == IPPROTO_UDP) ||
+         (proto == IPPROTO_SCTP)) &&
+        (first_fragment) && (num_bytes >= off + 4)) {
+      const uint16_t sport = (p[off] << 8) | p[off + 1];
+      const uint16_t dport = (p[off + 2] << 8) | p[off + 3];
+      remote_port          = (uplink) ? dport : sport;
+      local_port           = (uplink) ? sport : dport;
+      has_ports            = true;
+    }
+    for (int i = 0; i < num_rules; i++) {
+      const sdf_rule_t& r = rules[i];
+      if ((r.proto) && (r.proto != proto)) continue;
+      if (r.ip_version == 4) continue;
+      if (r.ip_version == 6) {
+        if (not match_prefix6(remote_addr, r.remote_addr6, r.remote_mask6))
+          continue;
+        if (not match_prefix6(local_addr, r.local_addr6, r.local_mask6))
+          continue;
+      }
+      if (r.check_ports) {
+        if (not has_ports) continue;
+        if ((remote_port < r.remote_port_lo) ||
+            (remote_port > r.remote_port_hi))
+          continue;
+        if ((local_port < r.local_port_lo) || (local_port > r.local_port_hi))
+          continue;
+      }
+      return true;
+    }
+    return false;
+  }
+};
+
+}  // namespace pfcp
+
+#endif /* FILE_PFCP_SDF_FILTER_HPP_SEEN */
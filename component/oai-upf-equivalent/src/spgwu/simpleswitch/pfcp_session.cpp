@@ -56,6 +56,28 @@ bool pfcp_session::get(
   return false;
 }
 //------------------------------------------------------------------------------
+bool pfcp_session::get(
+    const uint32_t qer_id, std::shared_ptr<pfcp::pfcp_qer>& qer) const {
+  for (const auto& it : qers) {
+    if (it->qer_id.qer_id == qer_id) {
+      qer = it;
+      return true;
+    }
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
+bool pfcp_session::get(
+    const pfcp::urr_id_t& urr_id, std::shared_ptr<pfcp::pfcp_urr>& urr) const {
+  for (const auto& it : urrs) {
+    if (it->urr_id.urr_id == urr_id.urr_id) {
+      urr = it;
+      return true;
+    }
+  }
+  return false;
+}
+//------------------------------------------------------------------------------
 void pfcp_session::add(std::shared_ptr<pfcp::pfcp_far> far) {
   Logger::spgwu_sx().info("pfcp_session::add(far) seid " SEID_FMT " ", seid);
   fars.push_back(far);
@@ -66,6 +88,16 @@ void pfcp_session::add(std::shared_ptr<pfcp::pfcp_pdr> pdr) {
   pdrs.push_back(pdr);
 }
 //------------------------------------------------------------------------------
+void pfcp_session::add(std::shared_ptr<pfcp::pfcp_qer> qer) {
+  Logger::spgwu_sx().info("pfcp_session::add(qer) seid " SEID_FMT " ", seid);
+  qers.push_back(qer);
+}
+//------------------------------------------------------------------------------
+void pfcp_session::add(std::shared_ptr<pfcp::pfcp_urr> urr) {
+  Logger::spgwu_sx().info("pfcp_session::add(urr) seid " SEID_FMT " ", seid);
+  urrs.push_back(urr);
+}
+//------------------------------------------------------------------------------
 bool pfcp_session::remove(const pfcp::far_id_t& far_id, uint8_t& cause_value) {
   for (std::vector<std::shared_ptr<pfcp::pfcp_far>>::iterator it = fars.begin();
        it != fars.end(); ++it) {
@@ -94,14 +126,55 @@ bool pfcp_session::remove(const pfcp::pdr_id_t& pdr_id, uint8_t& cause_value) {
   return false;
 }
 //------------------------------------------------------------------------------
+bool pfcp_session::remove(const pfcp::qer_id_t& qer_id, uint8_t& cause_value) {
+  for (std::vector<std::shared_ptr<pfcp::pfcp_qer>>::iterator it = qers.begin();
+       it != qers.end(); ++it) {
+    if ((*it)->qer_id.qer_id == qer_id.qer_id) {
+      Logger::spgwu_sx().info(
+          "pfcp_session::remove(qer) seid " SEID_FMT " %s", seid,
+          (*it)->to_string().c_str());
+      qers.erase(it);
+      return true;
+    }
+  }
+  cause_value = pfcp::CAUSE_VALUE_RULE_CREATION_MODIFICATION_FAILURE;
+  return false;
+}
+//------------------------------------------------------------------------------
+bool pfcp_session::remove(const pfcp::urr_id_t& urr_id, uint8_t& cause_value) {
+  for (std::vector<std::shared_ptr<pfcp::pfcp_urr>>::iterator it = urrs.begin();
+       it != urrs.end(); ++it) {
+    if ((*it)->urr_id.urr_id == urr_id.urr_id) {
+      Logger::spgwu_sx().info(
+          "pfcp_session::remove(urr) seid " SEID_FMT " %s", seid,
+          (*it)->to_string().c_str());
+      urrs.erase(it);
+      return true;
+    }
+  }
+  cause_value = pfcp::CAUSE_VALUE_RULE_CREATION_MODIFICATION_FAILURE;
+  return false;
+}
+//------------------------------------------------------------------------------
 bool pfcp_session::update(
     const pfcp::update_far& update, uint8_t& cause_value) {
-  std::shared_ptr<pfcp::pfcp_far> far = {};
-  if (get(update.far_id.far_id, far)) {
-    if (far->update(update, cause_value)) {
+  for (auto& it : fars) {
+    if (it->far_id.far_id == update.far_id.far_id) {
+      // Copy on write: the published forwarding entries keep the previous FAR
+      std::shared_ptr<pfcp::pfcp_far> far = std::make_shared<pfcp_far>(*it);
+      if (not far->update(update, cause_value)) return false;
+      it = far;
+      if (far->apply_action.forw) {
+        // UE reachable again, next idle period has to be reported again
+        for (const auto& pdr : pdrs) {
+          if ((pdr->far_id.first) &&
+              (pdr->far_id.second.far_id == far->far_id.far_id)) {
+            pdr->notified_cp.store(false, std::memory_order_relaxed);
+          }
+        }
+      }
       return true;
     }
-    return false;
   }
   cause_value = pfcp::CAUSE_VALUE_RULE_CREATION_MODIFICATION_FAILURE;
   return false;
@@ -109,9 +182,37 @@ bool pfcp_session::update(
 //------------------------------------------------------------------------------
 bool pfcp_session::update(
     const pfcp::update_pdr& update, uint8_t& cause_value) {
-  std::shared_ptr<pfcp::pfcp_pdr> pdr = {};
-  if (get(update.pdr_id.rule_id, pdr)) {
-    if (pdr->update(update, cause_value)) {
+  for (auto& it : pdrs) {
+    if (it->pdr_id.rule_id == update.pdr_id.rule_id) {
+      // Copy on write: the published forwarding entries keep the previous PDR
+      std::shared_ptr<pfcp::pfcp_pdr> pdr = std::make_shared<pfcp_pdr>(*it);
+      if (not pdr->update(update, cause_value)) return false;
+      it = pdr;
+      return true;
+    }
+  }
+  cause_value = pfcp::CAUSE_VALUE_RULE_CREATION_MODIFICATION_FAILURE;
+  return false;
+}
+//------------------------------------------------------------------------------
+bool pfcp_session::update(
+    const pfcp::update_qer& update, uint8_t& cause_value) {
+  std::shared_ptr<pfcp::pfcp_qer> qer = {};
+  if (get(update.qer_id.second.qer_id, qer)) {
+    if (qer->update(update, cause_value)) {
+      return true;
+    }
+    return false;
+  }
+  cause_value = pfcp::CAUSE_VALUE_RULE_CREATION_MODIFICATION_FAILURE;
+  return false;
+}
+//------------------------------------------------------------------------------
+bool pfcp_session::update(
+    const pfcp::update_urr& update, uint8_t& cause_value) {
+  std::shared_ptr<pfcp::pfcp_urr> urr = {};
+  if (get(update.urr_id.second, urr)) {
+    if (urr->update(update, cause_value)) {
       return true;
     }
     return false;
@@ -157,6 +258,52 @@ bool pfcp_session::create(
   return true;
 }
 //------------------------------------------------------------------------------
+bool pfcp_session::create(
+    const pfcp::create_qer& cr_qer, pfcp::cause_t& cause,
+    uint16_t& offending_ie) {
+  if (not cr_qer.qer_id.first) {
+    // should be caught in lower layer
+    cause.cause_value = CAUSE_VALUE_MANDATORY_IE_MISSING;
+    offending_ie      = PFCP_IE_QER_ID;
+    return false;
+  }
+  if (not cr_qer.gate_status.first) {
+    // should be caught in lower layer
+    cause.cause_value = CAUSE_VALUE_MANDATORY_IE_MISSING;
+    offending_ie      = PFCP_IE_GATE_STATUS;
+    return false;
+  }
+  std::shared_ptr<pfcp_qer> sqer = std::make_shared<pfcp_qer>(cr_qer);
+  add(sqer);
+  return true;
+}
+//------------------------------------------------------------------------------
+bool pfcp_session::create(
+    const pfcp::create_urr& cr_urr, pfcp::cause_t& cause,
+    uint16_t& offending_ie) {
+  if (not cr_urr.urr_id.first) {
+    // should be caught in lower layer
+    cause.cause_value = CAUSE_VALUE_MANDATORY_IE_MISSING;
+    offending_ie      = PFCP_IE_URR_ID;
+    return false;
+  }
+  if (not cr_urr.measurement_method.first) {
+    // should be caught in lower layer
+    cause.cause_value = CAUSE_VALUE_MANDATORY_IE_MISSING;
+    offending_ie      = PFCP_IE_MEASUREMENT_METHOD;
+    return false;
+  }
+  if (not cr_urr.reporting_triggers.first) {
+    // should be caught in lower layer
+    cause.cause_value = CAUSE_VALUE_MANDATORY_IE_MISSING;
+    offending_ie      = PFCP_IE_REPORTING_TRIGGERS;
+    return false;
+  }
+  std::shared_ptr<pfcp_urr> surr = std::make_shared<pfcp_urr>(cr_urr);
+  add(surr);
+  return true;
+}
+//------------------------------------------------------------------------------
 bool pfcp_session::create(
     const pfcp::create_pdr& cr_pdr, pfcp::cause_t& cause,
     uint16_t& offending_ie, pfcp::fteid_t& allocated_fteid) {
@@ -209,11 +356,7 @@ bool pfcp_session::create(
       return false;
     }
     const pfcp::fteid_t& local_fteid = pdi.local_fteid.second;
-    allocated_fteid                  = {};
-    if (local_fteid.ch) {
-      // TODO if (local_fteid.choose_id) {
-      allocated_fteid = pfcp_switch_inst->generate_fteid_s1u();
-    } else {
+    if (not local_fteid.ch) {
       cause.cause_value = CAUSE_VALUE_REQUEST_REJECTED;
       Logger::spgwu_sx().info(
           "Do not support IE FTEID managed by CP entity! Rejecting "
@@ -221,35 +364,41 @@ bool pfcp_session::create(
       return false;
     }
     pfcp_pdr* pdr = new pfcp_pdr(cr_pdr);
+    if (not pdr->compile_sdf_filter()) {
+      delete pdr;
+      cause.cause_value = CAUSE_VALUE_RULE_CREATION_MODIFICATION_FAILURE;
+      offending_ie      = PFCP_IE_SDF_FILTER;
+      return false;
+    }
+    // TODO if (local_fteid.choose_id) {
+    allocated_fteid = pfcp_switch_inst->generate_fteid_s1u();
     if (local_fteid.ch) {
       pdr->pdi.second.set(allocated_fteid);
     }
 
+    // Reachable by the datapath once the pfcp_switch commits the session
     std::shared_ptr<pfcp_pdr> spdr = std::shared_ptr<pfcp_pdr>(pdr);
-    if (pfcp_switch_inst->create_packet_in_access(
-            spdr, allocated_fteid, cause.cause_value)) {
-      pdr->set(get_up_seid());
-      add(spdr);
-    } else {
-      cause.cause_value = CAUSE_VALUE_REQUEST_REJECTED;
-      Logger::spgwu_sx().info(
-          "Could not create_packet_in_access ! Rejecting "
-          "PFCP_SESSION_ESTABLISHMENT_REQUEST");
-      return false;
-    }
+    pdr->set(get_up_seid());
+    add(spdr);
   } else if (
       pdi.source_interface.second.interface_value == INTERFACE_VALUE_CORE) {
-    pfcp_pdr* pdr                  = new pfcp_pdr(cr_pdr);
+    pfcp_pdr* pdr = new pfcp_pdr(cr_pdr);
+    if (not pdr->compile_sdf_filter()) {
+      delete pdr;
+      cause.cause_value = CAUSE_VALUE_RULE_CREATION_MODIFICATION_FAILURE;
+      offending_ie      = PFCP_IE_SDF_FILTER;
+      return false;
+    }
     std::shared_ptr<pfcp_pdr> spdr = std::shared_ptr<pfcp_pdr>(pdr);
     pdr->set(get_up_seid());
-    if ((pdi.ue_ip_address.first) && (pdi.ue_ip_address.second.v4)) {
-      pfcp_switch_inst->add_pfcp_dl_pdr_by_ue_ip(
-          be32toh(pdi.ue_ip_address.second.ipv4_address.s_addr), spdr);
-    } else {
+    // Dual stack PDR is reachable by both UE addresses
+    if ((not pdi.ue_ip_address.first) ||
+        ((not pdi.ue_ip_address.second.v4) &&
+         (not pdi.ue_ip_address.second.v6))) {
       cause.cause_value = CAUSE_VALUE_REQUEST_REJECTED;
       Logger::spgwu_sx().info(
-          "Could not create_packet_in_access, cause accept only IPv4 UE IP "
-          "address! Rejecting PFCP_XXX_REQUEST");
+          "Could not create_packet_in_core, cause no UE IP address! "
+          "Rejecting PFCP_XXX_REQUEST");
       return false;
     }
     add(spdr);
@@ -287,29 +436,37 @@ bool pfcp_session::remove(
   return remove(rm_pdr.pdr_id.second, cause.cause_value);
 }
 //------------------------------------------------------------------------------
-void pfcp_session::cleanup() {
-  for (std::vector<std::shared_ptr<pfcp::pfcp_pdr>>::iterator it = pdrs.begin();
-       it != pdrs.end(); ++it) {
-    if (((*it)->pdi.first) && ((*it)->pdi.second.source_interface.first)) {
-      if ((*it)->pdi.second.source_interface.second.interface_value ==
-          INTERFACE_VALUE_ACCESS) {
-        if ((*it)->pdi.second.local_fteid.first) {
-          pfcp_switch_inst->remove_pfcp_ul_pdrs_by_up_teid(
-              (*it)->pdi.second.local_fteid.second.teid);
-        }
-      } else if (
-          (*it)->pdi.second.source_interface.second.interface_value ==
-          INTERFACE_VALUE_CORE) {
-        if (((*it)->pdi.second.ue_ip_address.first) &&
-            ((*it)->pdi.second.ue_ip_address.second.v4)) {
-          pfcp_switch_inst->remove_pfcp_dl_pdrs_by_ue_ip(be32toh(
-              (*it)->pdi.second.ue_ip_address.second.ipv4_address.s_addr));
-        }
-      }
-    }
+bool pfcp_session::remove(
+    const pfcp::remove_qer& rm_qer, pfcp::cause_t& cause,
+    uint16_t& offending_ie) {
+  if (not rm_qer.qer_id.first) {
+    // should be caught in lower layer
+    cause.cause_value = CAUSE_VALUE_MANDATORY_IE_MISSING;
+    offending_ie      = PFCP_IE_QER_ID;
+    return false;
   }
+  return remove(rm_qer.qer_id.second, cause.cause_value);
+}
+//------------------------------------------------------------------------------
+bool pfcp_session::remove(
+    const pfcp::remove_urr& rm_urr, pfcp::cause_t& cause,
+    uint16_t& offending_ie) {
+  if (not rm_urr.urr_id.first) {
+    // should be caught in lower layer
+    cause.cause_value = CAUSE_VALUE_MANDATORY_IE_MISSING;
+    offending_ie      = PFCP_IE_URR_ID;
+    return false;
+  }
+  return remove(rm_urr.urr_id.second, cause.cause_value);
+}
+//------------------------------------------------------------------------------
+void pfcp_session::cleanup() {
+  // forwarding entries are withdrawn by the pfcp_switch
   fars.clear();
   pdrs.clear();
+  qers.clear();
+  urrs.clear();
+  dl_buffer.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -30,8 +30,11 @@
 
 #include "3gpp_29.244.h"
 #include "msg_pfcp.hpp"
+#include "pfcp_buffer.hpp"
 #include "pfcp_far.hpp"
 #include "pfcp_pdr.hpp"
+#include "pfcp_qer.hpp"
+#include "pfcp_urr.hpp"
 
 namespace pfcp {
 
@@ -41,23 +44,51 @@ class pfcp_session {
  private:
   void add(std::shared_ptr<pfcp::pfcp_far>);
   void add(std::shared_ptr<pfcp::pfcp_pdr>);
+  void add(std::shared_ptr<pfcp::pfcp_qer>);
+  void add(std::shared_ptr<pfcp::pfcp_urr>);
 
   bool remove(const pfcp::far_id_t& far_id, uint8_t& cause_value);
   bool remove(const pfcp::pdr_id_t& pdr_id, uint8_t& cause_value);
+  bool remove(const pfcp::qer_id_t& qer_id, uint8_t& cause_value);
+  bool remove(const pfcp::urr_id_t& urr_id, uint8_t& cause_value);
 
  public:
   pfcp::fseid_t cp_fseid;
   uint64_t seid;  // User plane
-  uint8_t qfi;
 
   // TO DO better than this :(sooner the better)  when inserting or removing new
   // PDRs, FARS, should not conflict with switching operations
   std::vector<std::shared_ptr<pfcp::pfcp_pdr>> pdrs;
   std::vector<std::shared_ptr<pfcp::pfcp_far>> fars;
-
-  pfcp_session() : cp_fseid(), seid(0), pdrs(), fars() {
+  std::vector<std::shared_ptr<pfcp::pfcp_qer>> qers;
+  std::vector<std::shared_ptr<pfcp::pfcp_urr>> urrs;
+
+  // DL packets held while a FAR has BUFF set (UE idle, paging)
+  pfcp_dl_buffer dl_buffer;
+
+  // Keys of the forwarding entries published by the pfcp_switch
+  std::vector<teid_t> ul_teids;
+  std::vector<uint32_t> ue_ipv4s;  // host byte order
+  std::vector<uint64_t> ue_ipv6_prefixes;
+  // A published DL rule has BUFF set, the datapath may fill dl_buffer
+  bool dl_buffering;
+
+  pfcp_session()
+      : cp_fseid(),
+        seid(0),
+        pdrs(),
+        fars(),
+        qers(),
+        urrs(),
+        dl_buffer(),
+        ul_teids(),
+        ue_ipv4s(),
+        ue_ipv6_prefixes(),
+        dl_buffering(false) {
     pdrs.reserve(8);
     fars.reserve(8);
+    qers.reserve(4);
+    urrs.reserve(4);
   }
   pfcp_session(pfcp::fseid_t& cp, uint64_t up_seid) : pfcp_session() {
     cp_fseid = cp;
@@ -65,7 +96,17 @@ class pfcp_session {
   }
 
   pfcp_session(const pfcp_session& c)
-      : cp_fseid(c.cp_fseid), seid(c.seid), pdrs(c.pdrs), fars(c.fars) {}
+      : cp_fseid(c.cp_fseid),
+        seid(c.seid),
+        pdrs(c.pdrs),
+        fars(c.fars),
+        qers(c.qers),
+        urrs(c.urrs),
+        dl_buffer(),
+        ul_teids(),
+        ue_ipv4s(),
+        ue_ipv6_prefixes(),
+        dl_buffering(false) {}
 
   virtual ~pfcp_session() {
     cleanup();
@@ -79,9 +120,13 @@ class pfcp_session {
   uint64_t get_up_seid() const { return seid; };
   bool get(const uint32_t, std::shared_ptr<pfcp::pfcp_far>&) const;
   bool get(const uint16_t, std::shared_ptr<pfcp::pfcp_pdr>&) const;
+  bool get(const uint32_t, std::shared_ptr<pfcp::pfcp_qer>&) const;
+  bool get(const pfcp::urr_id_t&, std::shared_ptr<pfcp::pfcp_urr>&) const;
 
   bool update(const pfcp::update_far& update, uint8_t& cause_value);
   bool update(const pfcp::update_pdr& update, uint8_t& cause_value);
+  bool update(const pfcp::update_qer& update, uint8_t& cause_value);
+  bool update(const pfcp::update_urr& update, uint8_t& cause_value);
 
   bool create(
       const pfcp::create_far& cr_far, pfcp::cause_t& cause,
@@ -89,6 +134,12 @@ class pfcp_session {
   bool create(
       const pfcp::create_pdr& cr_pdr, pfcp::cause_t& cause,
       uint16_t& offending_ie, pfcp::fteid_t& allocated_fteid);
+  bool create(
+      const pfcp::create_qer& cr_qer, pfcp::cause_t& cause,
+      uint16_t& offending_ie);
+  bool create(
+      const pfcp::create_urr& cr_urr, pfcp::cause_t& cause,
+      uint16_t& offending_ie);
 
   bool remove(
       const pfcp::remove_far& rm_far, pfcp::cause_t& cause,
@@ -96,6 +147,12 @@ class pfcp_session {
   bool remove(
       const pfcp::remove_pdr& rm_pdr, pfcp::cause_t& cause,
       uint16_t& offending_ie);
+  bool remove(
+      const pfcp::remove_qer& rm_qer, pfcp::cause_t& cause,
+      uint16_t& offending_ie);
+  bool remove(
+      const pfcp::remove_urr& rm_urr, pfcp::cause_t& cause,
+      uint16_t& offending_ie);
 };
 }  // namespace pfcp
 #endif
@@ -34,9 +34,12 @@
 #include "spgwu_config.hpp"
 #include "spgwu_pfcp_association.hpp"
 #include "spgwu_s1u.hpp"
+#include "spgwu_sx.hpp"
 
 #include <algorithm>
 #include <fstream>  // std::ifstream
+#include <map>
+#include <poll.h>
 #include <sched.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
@@ -57,19 +60,58 @@ using namespace std;
 extern itti_mw* itti_inst;
 extern spgwu_config spgwu_cfg;
 extern spgwu_s1u* spgwu_s1u_inst;
+extern spgwu_sx* spgwu_sx_inst;
 extern pfcp_switch* pfcp_switch_inst;
 
+// Multi-queue tun: queue written by the calling thread, its own one for the
+// queue readers
+static thread_local int tun_queue_fd = -1;
+
+//------------------------------------------------------------------------------
+static bool ipv6_in_network(
+    const struct in6_addr& a, const struct in6_addr& network,
+    const int prefix) {
+  const int bytes = prefix / 8;
+  const int bits  = prefix % 8;
+  if (memcmp(a.s6_addr, network.s6_addr, bytes)) return false;
+  if (bits) {
+    const uint8_t mask = 0xFF00 >> bits;
+    return ((a.s6_addr[bytes] & mask) == (network.s6_addr[bytes] & mask));
+  }
+  return true;
+}
+
 //------------------------------------------------------------------------------
 void pfcp_switch::pdn_worker(
     const int id, const util::thread_sched_params& sched_params) {
   uint64_t count      = 0;
   iovec_q_item_t* iov = nullptr;
+  iovec_q_item_t* done[UDP_MAX_BATCH_SIZE];
+  const unsigned int batch_size = spgwu_cfg.s1_up_batching.tx_batch_size;
 
   sched_params.apply(TASK_NONE, Logger::udp());
   while (1) {
     work_pool_->blockingRead(iov);
     ++count;
     // std::cout << "DL worker " << id << " count " << count << std::endl;
+    if (iov->msg_iov.iov_base && (batch_size > 1)) {
+      // G-PDUs of the packets already queued leave in one batch, buffers are
+      // given back once sent.
+      unsigned int num_done = 0;
+      spgwu_s1u_inst->begin_g_pdu_batch();
+      do {
+        if (iov->msg_iov.iov_base == nullptr) break;
+        pfcp_session_look_up_pack_in_core(
+            (const char*) iov->msg_iov.iov_base, iov->msg_iov.iov_len);
+        done[num_done++] = iov;
+        iov              = nullptr;
+      } while ((num_done < batch_size) && work_pool_->readIfNotEmpty(iov));
+      spgwu_s1u_inst->flush_g_pdu_batch();
+      for (unsigned int i = 0; i < num_done; i++) {
+        free_pool_->blockingWrite(done[i]);
+      }
+      if (iov == nullptr) continue;
+    }
     // exit thread
     if (iov->msg_iov.iov_base) {
       pfcp_session_look_up_pack_in_core(
@@ -138,12 +180,76 @@ void pfcp_switch::pdn_read_loop(
   }
 }
 //------------------------------------------------------------------------------
+void pfcp_switch::pdn_queue_loop(
+    int queue_fd, const int queue_id, util::thread_sched_params sched_params) {
+  // Run to completion: the kernel steers a flow always to the same tun queue,
+  // keeping its packets in order without any shared work queue.
+  uint64_t count  = 0;
+  uint64_t errors = 0;
+  const unsigned int batch_size =
+      std::max(spgwu_cfg.s1_up_batching.tx_batch_size, 1U);
+  char* buffers = (char*) calloc(batch_size, PFCP_SWITCH_RECV_BUFFER_SIZE);
+
+  struct pollfd pfd = {};
+  pfd.fd            = queue_fd;
+  pfd.events        = POLLIN;
+
+  // One core per queue from cpu_id, wrapping around the available cores
+  if (sched_params.cpu_id >= 0) {
+    const unsigned int num_cpus =
+        std::max(std::thread::hardware_concurrency(), 1U);
+    sched_params.cpu_id = (sched_params.cpu_id + queue_id) % num_cpus;
+  }
+  // UL packets sent by this thread go to its own queue
+  tun_queue_fd = queue_fd;
+  sched_params.apply(TASK_NONE, Logger::pfcp_switch());
+
+  while (1) {
+    // Queue opened non blocking when several packets are read per round
+    if ((batch_size > 1) && (poll(&pfd, 1, -1) < 0)) {
+      continue;
+    }
+    spgwu_s1u_inst->begin_g_pdu_batch();
+    for (unsigned int i = 0; i < batch_size; i++) {
+      char* buffer = buffers + i * PFCP_SWITCH_RECV_BUFFER_SIZE +
+                     ROOM_FOR_GTPV1U_G_PDU;
+      ssize_t nread = read(
+          queue_fd, buffer,
+          PFCP_SWITCH_RECV_BUFFER_SIZE - ROOM_FOR_GTPV1U_G_PDU);
+      if (nread > 0) {
+        ++count;
+        pfcp_session_look_up_pack_in_core(buffer, nread);
+        continue;
+      }
+      // The other queues keep running: log, back off and read again
+      if ((nread < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+        ++errors;
+        Logger::pfcp_switch().error(
+            "read tun queue %d failed rc=%d:%s nb_errors %d", queue_id, nread,
+            strerror(errno), errors);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+      }
+      break;
+    }
+    spgwu_s1u_inst->flush_g_pdu_batch();
+  }
+}
+//------------------------------------------------------------------------------
 void pfcp_switch::send_to_core(char* const ip_packet, const ssize_t len) {
   ssize_t bytes_sent;
+  int fd = sock_w;
+  if (!tun_queues_.empty()) {
+    // Each thread sticks to a tun queue, the S1U threads are spread over them
+    if (tun_queue_fd < 0) {
+      tun_queue_fd =
+          tun_queues_[next_tun_queue_.fetch_add(1) % tun_queues_.size()];
+    }
+    fd = tun_queue_fd;
+  }
   // Logger::pfcp_switch().trace( "pfcp_switch::send_to_core %d bytes ", len);
-  if ((bytes_sent = write(sock_w, ip_packet, len)) < 0) {
+  if ((bytes_sent = write(fd, ip_packet, len)) < 0) {
     Logger::pfcp_switch().error(
-        "write fd %d failed rc=%d:%s", sock_w, bytes_sent, strerror(errno));
+        "write fd %d failed rc=%d:%s", fd, bytes_sent, strerror(errno));
   }
 }
 //------------------------------------------------------------------------------
@@ -254,7 +360,7 @@ int pfcp_switch::create_pdn_socket(const char* const ifname) {
   return RETURNerror;
 }
 //------------------------------------------------------------------------------
-int pfcp_switch::tun_open(char* devname, int flags) {
+int pfcp_switch::tun_open(char* devname, int flags, const bool multi_queue) {
   struct ifreq ifr;
   int fd, err;
   if ((fd = open("/dev/net/tun", flags)) == -1) {
@@ -263,6 +369,9 @@ int pfcp_switch::tun_open(char* devname, int flags) {
   }
   memset(&ifr, 0, sizeof(ifr));
   ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+  if (multi_queue) {
+    ifr.ifr_flags |= IFF_MULTI_QUEUE;
+  }
   strncpy(ifr.ifr_name, devname, IFNAMSIZ);  // devname = tunX
 
   if ((err = ioctl(fd, TUNSETIFF, (void*) &ifr)) == -1) {
@@ -284,8 +393,12 @@ void pfcp_switch::setup_pdn_interfaces() {
     pdn_cfg_t it = spgwu_cfg.pdns[index];
     int sock_r   = 0;
 
-    cmd = fmt::format("ip tuntap add mode tun dev tun{}", index);
-    rc  = system((const char*) cmd.c_str());
+    if (spgwu_cfg.sgi_tun_multi_queue) {
+      cmd = fmt::format("ip tuntap add mode tun dev tun{} multi_queue", index);
+    } else {
+      cmd = fmt::format("ip tuntap add mode tun dev tun{}", index);
+    }
+    rc = system((const char*) cmd.c_str());
 
     cmd = fmt::format("ip link set dev tun{} up", index);
     rc  = system((const char*) cmd.c_str());
@@ -342,20 +455,44 @@ void pfcp_switch::setup_pdn_interfaces() {
     // index); rc = system ((const char*)cmd.c_str());
 
     cmd = fmt::format("tun{}", index);
-    if ((sock_r = tun_open((char*) cmd.c_str(), O_RDWR)) == RETURNerror) {
-      Logger::pfcp_switch().error("Could not set PDN interface read socket");
-      sleep(2);
-      exit(EXIT_FAILURE);
-    }
+    if (spgwu_cfg.sgi_tun_multi_queue) {
+      int flags = O_RDWR;
+      if (spgwu_cfg.s1_up_batching.tx_batch_size > 1) flags |= O_NONBLOCK;
+      for (uint32_t q = 0; q < num_threads_; q++) {
+        if ((sock_r = tun_open((char*) cmd.c_str(), flags, true)) ==
+            RETURNerror) {
+          Logger::pfcp_switch().error(
+              "Could not set PDN interface queue %d", q);
+          sleep(2);
+          exit(EXIT_FAILURE);
+        }
+        tun_queues_.push_back(sock_r);
+        socks_r.push_back(sock_r);
+      }
+
+      for (std::size_t q = 0; q < tun_queues_.size(); q++) {
+        std::thread t = thread(
+            &pfcp_switch::pdn_queue_loop, this, tun_queues_[q], q,
+            spgwu_cfg.sgi.thread_rd_sched_params);
+        t.detach();
+        threads_.push_back(std::move(t));
+      }
+    } else {
+      if ((sock_r = tun_open((char*) cmd.c_str(), O_RDWR)) == RETURNerror) {
+        Logger::pfcp_switch().error("Could not set PDN interface read socket");
+        sleep(2);
+        exit(EXIT_FAILURE);
+      }
 
-    sock_w = sock_r;
+      sock_w = sock_r;
 
-    std::thread t = thread(
-        &pfcp_switch::pdn_read_loop, this, sock_r,
-        spgwu_cfg.sgi.thread_rd_sched_params);
-    t.detach();
-    threads_.push_back(std::move(t));
-    socks_r.push_back(sock_r);
+      std::thread t = thread(
+          &pfcp_switch::pdn_read_loop, this, sock_r,
+          spgwu_cfg.sgi.thread_rd_sched_params);
+      t.detach();
+      threads_.push_back(std::move(t));
+      socks_r.push_back(sock_r);
+    }
   }
 
   rc = system("/sbin/sysctl -w net.ipv4.conf.all.forwarding=1");
@@ -380,45 +517,92 @@ pfcp::fteid_t pfcp_switch::generate_fteid_s1u() {
 }
 //------------------------------------------------------------------------------
 pfcp_switch::pfcp_switch()
-    : seid_generator_(),
-      teid_s1u_generator_(),
-      ue_ipv4_hbo2pfcp_pdr(PFCP_SWITCH_MAX_PDRS),
-      ul_s1u_teid2pfcp_pdr(PFCP_SWITCH_MAX_PDRS),
+    : seid_generator_(UINT_GENERATOR_SHARDS),
+      teid_s1u_generator_(UINT_GENERATOR_SHARDS),
+      ul_s1u_teid2fwd_entry(PFCP_SWITCH_MAX_PDRS),
+      ue_ipv4_hbo2fwd_entry(PFCP_SWITCH_MAX_PDRS),
+      ue_ipv6_prefix2fwd_entry(PFCP_SWITCH_MAX_PDRS),
       up_seid2pfcp_sessions(PFCP_SWITCH_MAX_SESSIONS),
       threads_(16),
       socks_r(16),
-      sock_w(0) {
+      sock_w(0),
+      tun_queues_(),
+      next_tun_queue_(0) {
   num_threads_   = spgwu_cfg.sgi.thread_rd_sched_params.thread_pool_size;
-  int num_blocks = num_threads_ * 16;
-  free_pool_     = new folly::MPMCQueue<iovec_q_item_t*>(num_blocks);
-  work_pool_     = new folly::MPMCQueue<iovec_q_item_t*>(num_blocks);
-
-  recv_buffer_alloc_ = (char*) calloc(num_blocks, PFCP_SWITCH_RECV_BUFFER_SIZE);
-
-  for (int i = 0; i < num_blocks; i++) {
-    iovec_q_item_s* v = (iovec_q_item_s*) calloc(1, sizeof(iovec_q_item_s));
-    v->msg_iov.iov_base =
-        (void*) ((uintptr_t) calloc(1, PFCP_SWITCH_RECV_BUFFER_SIZE) + (uintptr_t) ROOM_FOR_GTPV1U_G_PDU);
-    v->msg_iov.iov_len = PFCP_SWITCH_RECV_BUFFER_SIZE - ROOM_FOR_GTPV1U_G_PDU;
-    v->msg.msg_iovlen  = 1;
-    v->msg.msg_flags   = 0;
-    v->msg.msg_control = nullptr;
-    v->msg.msg_controllen = 0;
-    free_pool_->blockingWrite(v);
+  // One URR counter shard per thread counting: the S1U and SGi workers, and
+  // the S1U and SGi readers
+  pfcp::pfcp_urr::set_num_shards(
+      spgwu_cfg.s1_up.thread_rd_sched_params.thread_pool_size + num_threads_ +
+      2);
+  free_pool_         = nullptr;
+  work_pool_         = nullptr;
+  recv_buffer_alloc_ = nullptr;
+  // With a multi-queue tun, the queue readers use their own buffers and do the
+  // DL work themselves: no shared work queue
+  if (not spgwu_cfg.sgi_tun_multi_queue) {
+    int num_blocks = num_threads_ * 16;
+    // Each DL worker may hold one TX batch of buffers
+    if (spgwu_cfg.s1_up_batching.tx_batch_size > 1) {
+      num_blocks += num_threads_ * spgwu_cfg.s1_up_batching.tx_batch_size;
+    }
+    free_pool_ = new folly::MPMCQueue<iovec_q_item_t*>(num_blocks);
+    work_pool_ = new folly::MPMCQueue<iovec_q_item_t*>(num_blocks);
+
+    recv_buffer_alloc_ =
+        (char*) calloc(num_blocks, PFCP_SWITCH_RECV_BUFFER_SIZE);
+
+    for (int i = 0; i < num_blocks; i++) {
+      iovec_q_item_s* v = (iovec_q_item_s*) calloc(1, sizeof(iovec_q_item_s));
+      v->msg_iov.iov_base =
+          (void*) ((uintptr_t) calloc(1, PFCP_SWITCH_RECV_BUFFER_SIZE) +
+                   (uintptr_t) ROOM_FOR_GTPV1U_G_PDU);
+      v->msg_iov.iov_len =
+          PFCP_SWITCH_RECV_BUFFER_SIZE - ROOM_FOR_GTPV1U_G_PDU;
+      v->msg.msg_iovlen     = 1;
+      v->msg.msg_flags      = 0;
+      v->msg.msg_control    = nullptr;
+      v->msg.msg_controllen = 0;
+      free_pool_->blockingWrite(v);
+    }
+  }
+  dl_buffer_pool_ =
+      new folly::MPMCQueue<char*>(PFCP_SWITCH_DL_BUFFER_POOL_BLOCKS);
+  char* dl_blocks = (char*) calloc(
+      PFCP_SWITCH_DL_BUFFER_POOL_BLOCKS, PFCP_SWITCH_RECV_BUFFER_SIZE);
+  for (int i = 0; i < PFCP_SWITCH_DL_BUFFER_POOL_BLOCKS; i++) {
+    dl_buffer_pool_->blockingWrite(
+        dl_blocks + i * PFCP_SWITCH_RECV_BUFFER_SIZE + ROOM_FOR_GTPV1U_G_PDU);
   }
-  for (int i = 0; i < num_threads_; i++) {
-    std::thread t = std::thread(
-        &pfcp_switch::pdn_worker, this, i,
-        spgwu_cfg.sgi.thread_rd_sched_params);
-    threads_.push_back(std::move(t));
+  if (not spgwu_cfg.sgi_tun_multi_queue) {
+    for (uint32_t i = 0; i < num_threads_; i++) {
+      std::thread t = std::thread(
+          &pfcp_switch::pdn_worker, this, i,
+          spgwu_cfg.sgi.thread_rd_sched_params);
+      threads_.push_back(std::move(t));
+    }
   }
   timer_min_commit_interval_id = 0;
   timer_max_commit_interval_id = 0;
+  timer_urr_check_id           = 0;
+  dl_buffer_stats_removed_     = {};
+  timer_dl_buffer_stats_id     = itti_inst->timer_setup(
+      PFCP_SWITCH_DL_BUFFER_STATS_PERIOD_SECONDS, 0, TASK_SPGWU_APP,
+      TASK_SPGWU_PFCP_SWITCH_DL_BUFFER_STATS);
   cp_fseid2pfcp_sessions = {}, sock_w = -1;
   pdn_if_index = -1;
   setup_pdn_interfaces();
 }
 //------------------------------------------------------------------------------
+char* pfcp_switch::get_dl_buffer_block() {
+  char* block = nullptr;
+  if (dl_buffer_pool_->read(block)) return block;
+  return nullptr;
+}
+//------------------------------------------------------------------------------
+void pfcp_switch::release_dl_buffer_block(char* const block) {
+  dl_buffer_pool_->blockingWrite(block);
+}
+//------------------------------------------------------------------------------
 bool pfcp_switch::get_pfcp_session_by_cp_fseid(
     const pfcp::fseid_t& fseid,
     std::shared_ptr<pfcp::pfcp_session>& session) const {
@@ -447,34 +631,6 @@ bool pfcp_switch::get_pfcp_session_by_up_seid(
   }
 }
 //------------------------------------------------------------------------------
-bool pfcp_switch::get_pfcp_ul_pdrs_by_up_teid(
-    const teid_t teid,
-    std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>& pdrs) const {
-  folly::AtomicHashMap<
-      teid_t, std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>>::
-      const_iterator pit = ul_s1u_teid2pfcp_pdr.find(teid);
-  if (pit == ul_s1u_teid2pfcp_pdr.end())
-    return false;
-  else {
-    pdrs = pit->second;
-    return true;
-  }
-}
-//------------------------------------------------------------------------------
-bool pfcp_switch::get_pfcp_dl_pdrs_by_ue_ip(
-    const uint32_t ue_ip,
-    std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>& pdrs) const {
-  folly::AtomicHashMap<
-      uint32_t, std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>>::
-      const_iterator pit = ue_ipv4_hbo2pfcp_pdr.find(ue_ip);
-  if (pit == ue_ipv4_hbo2pfcp_pdr.end())
-    return false;
-  else {
-    pdrs = pit->second;
-    return true;
-  }
-}
-//------------------------------------------------------------------------------
 void pfcp_switch::add_pfcp_session_by_cp_fseid(
     const pfcp::fseid_t& fseid, std::shared_ptr<pfcp::pfcp_session>& session) {
   std::pair<fseid_t, std::shared_ptr<pfcp::pfcp_session>> entry(fseid, session);
@@ -489,7 +645,9 @@ void pfcp_switch::add_pfcp_session_by_up_seid(
 //------------------------------------------------------------------------------
 void pfcp_switch::remove_pfcp_session(
     std::shared_ptr<pfcp::pfcp_session>& session) {
+  withdraw_fwd_entries(*session);
   session->cleanup();
+  session->dl_buffer.add_stats(dl_buffer_stats_removed_);
   cp_fseid2pfcp_sessions.erase(session->cp_fseid);
   up_seid2pfcp_sessions.erase(session->seid);
 }
@@ -502,76 +660,225 @@ void pfcp_switch::remove_pfcp_session(const pfcp::fseid_t& cp_fseid) {
 }
 
 //------------------------------------------------------------------------------
-void pfcp_switch::add_pfcp_ul_pdr_by_up_teid(
-    const teid_t teid, std::shared_ptr<pfcp::pfcp_pdr>& pdr) {
-  folly::AtomicHashMap<
-      teid_t, std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>>::
-      const_iterator pit = ul_s1u_teid2pfcp_pdr.find(teid);
-  if (pit == ul_s1u_teid2pfcp_pdr.end()) {
-    std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>> pdrs =
-        std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>(
-            new std::vector<std::shared_ptr<pfcp::pfcp_pdr>>());
-    pdrs->push_back(pdr);
-    std::pair<
-        teid_t, std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>>
-        entry(teid, pdrs);
-    // Logger::pfcp_switch().info( "add_pfcp_ul_pdr_by_up_teid tunnel " TEID_FMT
-    // " ", teid);
-    ul_s1u_teid2pfcp_pdr.insert(entry);
+template <typename K>
+static void publish_fwd_entry(
+    folly::AtomicHashMap<K, std::atomic<const pfcp_fwd_entry*>>& table,
+    const K key, const pfcp_fwd_entry* const entry) {
+  typename folly::AtomicHashMap<
+      K, std::atomic<const pfcp_fwd_entry*>>::iterator it = table.find(key);
+  if (it == table.end()) {
+    table.emplace(key, entry);
+    return;
+  }
+  const pfcp_fwd_entry* old =
+      it->second.exchange(entry, std::memory_order_acq_rel);
+  if (old) folly::rcu_retire(const_cast<pfcp_fwd_entry*>(old));
+}
+//------------------------------------------------------------------------------
+template <typename K>
+static void withdraw_fwd_entry(
+    folly::AtomicHashMap<K, std::atomic<const pfcp_fwd_entry*>>& table,
+    const K key) {
+  typename folly::AtomicHashMap<
+      K, std::atomic<const pfcp_fwd_entry*>>::iterator it = table.find(key);
+  if (it == table.end()) return;
+  const pfcp_fwd_entry* old =
+      it->second.exchange(nullptr, std::memory_order_acq_rel);
+  table.erase(key);
+  if (old) folly::rcu_retire(const_cast<pfcp_fwd_entry*>(old));
+}
+//------------------------------------------------------------------------------
+template <typename K>
+static void publish_fwd_entries(
+    folly::AtomicHashMap<K, std::atomic<const pfcp_fwd_entry*>>& table,
+    std::map<K, std::unique_ptr<pfcp_fwd_entry>>& entries,
+    std::vector<K>& published) {
+  for (const auto& key : published) {
+    if (entries.find(key) == entries.end()) withdraw_fwd_entry(table, key);
+  }
+  published.clear();
+  for (auto& it : entries) {
+    publish_fwd_entry(table, it.first, it.second.release());
+    published.push_back(it.first);
+  }
+}
+//------------------------------------------------------------------------------
+bool pfcp_switch::compile_fwd_rule(
+    const pfcp::pfcp_session& session,
+    const std::shared_ptr<pfcp::pfcp_pdr>& pdr,
+    pfcp::pfcp_fwd_entry& entry) const {
+  if (entry.num_rules >= PFCP_FWD_MAX_RULES) {
+    Logger::pfcp_switch().warn(
+        "Session " SEID_FMT " PDR id %4x ignored, more than %d PDRs share its "
+        "TEID or UE IP address",
+        session.get_up_seid(), pdr->pdr_id.rule_id, PFCP_FWD_MAX_RULES);
+    return false;
+  }
+  std::shared_ptr<pfcp::pfcp_far> far = {};
+  if ((not pdr->far_id.first) ||
+      (not session.get(pdr->far_id.second.far_id, far))) {
+    // nothing to apply, packets matching this PDR were never forwarded
+    return false;
+  }
+  const pfcp::pdi& pdi = pdr->pdi.second;
+  pfcp_fwd_rule_t& r   = entry.rules[entry.num_rules];
+  r                    = {};
+  r.pdr                = pdr.get();
+  r.far                = far.get();
+  r.far_id             = far->far_id.far_id;
+  entry.refs.push_back(pdr);
+  entry.refs.push_back(far);
+
+  // What the lookup key does not already guarantee is checked per packet
+  if (pdi.source_interface.second.interface_value == INTERFACE_VALUE_ACCESS) {
+    r.match = (pdi.ue_ip_address.first) || (pdi.sdf_filter.first) ||
+              (not pdr->outer_header_removal.first) ||
+              (pdr->outer_header_removal.second
+                   .outer_header_removal_description !=
+               OUTER_HEADER_REMOVAL_GTPU_UDP_IPV4);
   } else {
-    // sort by precedence
-    // const std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>&
-    // spdrs = pit->second;
-    std::vector<std::shared_ptr<pfcp::pfcp_pdr>>* pdrs = pit->second.get();
-    for (std::vector<std::shared_ptr<pfcp::pfcp_pdr>>::iterator it =
-             pdrs->begin();
-         it < pdrs->end(); ++it) {
-      if (*(it->get()) < *(pdr.get())) {
-        pit->second->insert(it, pdr);
-        return;
+    r.match = (pdi.sdf_filter.first) || (pdr->outer_header_removal.first);
+  }
+
+  std::shared_ptr<pfcp::pfcp_qer> qer = {};
+  if ((pdr->qer_id.first) &&
+      (session.get(pdr->qer_id.second.qer_id, qer))) {
+    r.qer = qer.get();
+    entry.refs.push_back(qer);
+  }
+  std::shared_ptr<pfcp::pfcp_urr> urr = {};
+  if ((pdr->urr_id.first) && (session.get(pdr->urr_id.second, urr))) {
+    r.urr = urr.get();
+    entry.refs.push_back(urr);
+  }
+  // QoS flow of the packets matching this PDR (TS 29.244 5.2.1A): QFI
+  // required by the QER, else the one the PDI detects
+  if ((r.qer) && (qer->qos_flow_identifier.first)) {
+    r.qfi = qer->qos_flow_identifier.second.qfi;
+  } else if (pdi.qfi.first) {
+    r.qfi = pdi.qfi.second.qfi;
+  }
+
+  if (far->apply_action.forw) {
+    r.action = PFCP_FWD_ACTION_DROP;
+    const std::pair<bool, pfcp::forwarding_parameters>& fp =
+        far->forwarding_parameters;
+    if ((fp.first) && (fp.second.destination_interface.first)) {
+      const uint8_t interface =
+          fp.second.destination_interface.second.interface_value;
+      if ((interface == INTERFACE_VALUE_ACCESS) &&
+          (fp.second.outer_header_creation.first)) {
+        const pfcp::outer_header_creation_t& ohc =
+            fp.second.outer_header_creation.second;
+        switch (ohc.outer_header_creation_description) {
+          case OUTER_HEADER_CREATION_GTPU_UDP_IPV4:
+            r.action = PFCP_FWD_ACTION_FORW_ACCESS_GTPU;
+            spgwu_s1u_inst->build_g_pdu_template(
+                ohc.ipv4_address, spgwu_cfg.s1_up.port, ohc.teid, r.qfi,
+                r.g_pdu);
+            break;
+          case OUTER_HEADER_CREATION_GTPU_UDP_IPV6:
+            r.action = PFCP_FWD_ACTION_FORW_ACCESS_GTPU;
+            spgwu_s1u_inst->build_g_pdu_template(
+                ohc.ipv6_address, spgwu_cfg.s1_up.port, ohc.teid, r.qfi,
+                r.g_pdu);
+            break;
+          case OUTER_HEADER_CREATION_UDP_IPV4:  // TODO
+          case OUTER_HEADER_CREATION_UDP_IPV6:  // TODO
+          default:;
+        }
+      } else if (interface == INTERFACE_VALUE_CORE) {
+        r.action = PFCP_FWD_ACTION_FORW_CORE;
       }
     }
+  } else if (far->apply_action.drop) {
+    r.action = PFCP_FWD_ACTION_DROP;
+  } else if (far->apply_action.buff) {
+    r.action = PFCP_FWD_ACTION_BUFF;
   }
+  r.nocp = far->apply_action.nocp;
+  entry.num_rules++;
+  return true;
 }
 //------------------------------------------------------------------------------
-void pfcp_switch::remove_pfcp_ul_pdrs_by_up_teid(const teid_t teid) {
-  ul_s1u_teid2pfcp_pdr.erase(teid);
-}
+void pfcp_switch::commit_fwd_entries(
+    std::shared_ptr<pfcp::pfcp_session>& session) {
+  // sort by precedence, lowest value first (TS 29.244 5.2.1)
+  std::vector<std::shared_ptr<pfcp::pfcp_pdr>> pdrs = session->pdrs;
+  std::stable_sort(
+      pdrs.begin(), pdrs.end(),
+      [](const std::shared_ptr<pfcp::pfcp_pdr>& a,
+         const std::shared_ptr<pfcp::pfcp_pdr>& b) { return *a < *b; });
 
-//------------------------------------------------------------------------------
-void pfcp_switch::add_pfcp_dl_pdr_by_ue_ip(
-    const uint32_t ue_ip, std::shared_ptr<pfcp::pfcp_pdr>& pdr) {
-  folly::AtomicHashMap<
-      uint32_t, std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>>::
-      const_iterator pit = ue_ipv4_hbo2pfcp_pdr.find(ue_ip);
-  if (pit == ue_ipv4_hbo2pfcp_pdr.end()) {
-    std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>> pdrs =
-        std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>(
-            new std::vector<std::shared_ptr<pfcp::pfcp_pdr>>());
-    pdrs->push_back(pdr);
-    std::pair<
-        uint32_t, std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>>
-        entry(ue_ip, pdrs);
-    ue_ipv4_hbo2pfcp_pdr.insert(entry);
-    // Logger::pfcp_switch().info( "add_pfcp_dl_pdr_by_ue_ip UE IP %8x", ue_ip);
-  } else {
-    // sort by precedence
-    // const std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>&
-    // spdrs = pit->second;
-    std::vector<std::shared_ptr<pfcp::pfcp_pdr>>* pdrs = pit->second.get();
-    for (std::vector<std::shared_ptr<pfcp::pfcp_pdr>>::iterator it =
-             pdrs->begin();
-         it < pdrs->end(); ++it) {
-      if (*(it->get()) < *(pdr.get())) {
-        pit->second->insert(it, pdr);
-        return;
+  std::map<teid_t, std::unique_ptr<pfcp_fwd_entry>> ul = {};
+  std::map<uint32_t, std::unique_ptr<pfcp_fwd_entry>> dl_ipv4 = {};
+  std::map<uint64_t, std::unique_ptr<pfcp_fwd_entry>> dl_ipv6 = {};
+  auto entry_of = [&session](auto& entries, const auto key) -> pfcp_fwd_entry& {
+    std::unique_ptr<pfcp_fwd_entry>& e = entries[key];
+    if (not e) e.reset(new pfcp_fwd_entry(session));
+    return *e;
+  };
+
+  for (const auto& pdr : pdrs) {
+    if ((not pdr->pdi.first) || (not pdr->pdi.second.source_interface.first)) {
+      continue;
+    }
+    const pfcp::pdi& pdi = pdr->pdi.second;
+    if (pdi.source_interface.second.interface_value == INTERFACE_VALUE_ACCESS) {
+      if (pdi.local_fteid.first) {
+        compile_fwd_rule(
+            *session, pdr, entry_of(ul, pdi.local_fteid.second.teid));
+      }
+    } else if (
+        pdi.source_interface.second.interface_value == INTERFACE_VALUE_CORE) {
+      if (not pdi.ue_ip_address.first) continue;
+      // Dual stack PDR is reachable from both tables
+      if (pdi.ue_ip_address.second.v4) {
+        compile_fwd_rule(
+            *session, pdr,
+            entry_of(
+                dl_ipv4,
+                be32toh(pdi.ue_ip_address.second.ipv4_address.s_addr)));
+      }
+      if (pdi.ue_ip_address.second.v6) {
+        compile_fwd_rule(
+            *session, pdr,
+            entry_of(
+                dl_ipv6,
+                ue_ipv6_prefix(pdi.ue_ip_address.second.ipv6_address)));
       }
     }
   }
+
+  auto buffering = [](const auto& entries) {
+    for (const auto& it : entries) {
+      for (uint8_t i = 0; i < it.second->num_rules; i++) {
+        if (it.second->rules[i].action == PFCP_FWD_ACTION_BUFF) return true;
+      }
+    }
+    return false;
+  };
+  session->dl_buffering = buffering(dl_ipv4) || buffering(dl_ipv6);
+
+  publish_fwd_entries(ul_s1u_teid2fwd_entry, ul, session->ul_teids);
+  publish_fwd_entries(ue_ipv4_hbo2fwd_entry, dl_ipv4, session->ue_ipv4s);
+  publish_fwd_entries(
+      ue_ipv6_prefix2fwd_entry, dl_ipv6, session->ue_ipv6_prefixes);
 }
 //------------------------------------------------------------------------------
-void pfcp_switch::remove_pfcp_dl_pdrs_by_ue_ip(const uint32_t ue_ip) {
-  ue_ipv4_hbo2pfcp_pdr.erase(ue_ip);
+void pfcp_switch::withdraw_fwd_entries(pfcp::pfcp_session& session) {
+  for (const auto& teid : session.ul_teids) {
+    withdraw_fwd_entry(ul_s1u_teid2fwd_entry, teid);
+  }
+  for (const auto& ue_ip : session.ue_ipv4s) {
+    withdraw_fwd_entry(ue_ipv4_hbo2fwd_entry, ue_ip);
+  }
+  for (const auto& ue_prefix : session.ue_ipv6_prefixes) {
+    withdraw_fwd_entry(ue_ipv6_prefix2fwd_entry, ue_prefix);
+  }
+  session.ul_teids.clear();
+  session.ue_ipv4s.clear();
+  session.ue_ipv6_prefixes.clear();
 }
 //------------------------------------------------------------------------------
 std::string pfcp_switch::to_string() const {
@@ -582,15 +889,6 @@ std::string pfcp_switch::to_string() const {
   return s;
 }
 
-//------------------------------------------------------------------------------
-bool pfcp_switch::create_packet_in_access(
-    std::shared_ptr<pfcp::pfcp_pdr>& pdr, const pfcp::fteid_t& in,
-    uint8_t& cause) {
-  cause = CAUSE_VALUE_REQUEST_ACCEPTED;
-  add_pfcp_ul_pdr_by_up_teid(in.teid, pdr);
-  return true;
-}
-
 //------------------------------------------------------------------------------
 void pfcp_switch::handle_pfcp_session_establishment_request(
     std::shared_ptr<itti_sxab_session_establishment_request> sreq,
@@ -616,6 +914,28 @@ void pfcp_switch::handle_pfcp_session_establishment_request(
         }
       }
 
+      if (cause.cause_value == CAUSE_VALUE_REQUEST_ACCEPTED) {
+        for (auto it : req->pfcp_ies.create_qers) {
+          create_qer& cr_qer = it;
+          if (not session->create(cr_qer, cause, offending_ie.offending_ie)) {
+            session->cleanup();
+            delete session;
+            break;
+          }
+        }
+      }
+
+      if (cause.cause_value == CAUSE_VALUE_REQUEST_ACCEPTED) {
+        for (auto it : req->pfcp_ies.create_urrs) {
+          create_urr& cr_urr = it;
+          if (not session->create(cr_urr, cause, offending_ie.offending_ie)) {
+            session->cleanup();
+            delete session;
+            break;
+          }
+        }
+      }
+
       if (cause.cause_value == CAUSE_VALUE_REQUEST_ACCEPTED) {
         //--------------------------------
         // Process PDR to be created
@@ -665,8 +985,10 @@ void pfcp_switch::handle_pfcp_session_establishment_request(
         s = std::shared_ptr<pfcp_session>(session);
         add_pfcp_session_by_cp_fseid(fseid, s);
         add_pfcp_session_by_up_seid(session->seid, s);
+        commit_fwd_entries(s);
         // start_timer_min_commit_interval();
         // start_timer_max_commit_interval();
+        if (not session->urrs.empty()) start_timer_urr_check();
 
         pfcp::fseid_t up_fseid = {};
         spgwu_cfg.get_pfcp_fseid(up_fseid);
@@ -776,6 +1098,46 @@ void pfcp_switch::handle_pfcp_session_modification_request(
       }
     }
 
+    if (cause.cause_value == CAUSE_VALUE_REQUEST_ACCEPTED) {
+      for (auto it : req->pfcp_ies.remove_qers) {
+        remove_qer& qer = it;
+        if (not session->remove(qer, cause, offending_ie.offending_ie)) {
+          if (cause.cause_value ==
+              CAUSE_VALUE_RULE_CREATION_MODIFICATION_FAILURE) {
+            failed_rule.rule_id_type  = FAILED_RULE_ID_TYPE_QER;
+            failed_rule.rule_id_value = qer.qer_id.second.qer_id;
+            resp->pfcp_ies.set(failed_rule);
+            break;
+          }
+        }
+      }
+    }
+
+    if (cause.cause_value == CAUSE_VALUE_REQUEST_ACCEPTED) {
+      for (auto it : req->pfcp_ies.remove_urrs) {
+        remove_urr& urr                      = it;
+        std::shared_ptr<pfcp::pfcp_urr> surr = {};
+        if ((urr.urr_id.first) && (session->get(urr.urr_id.second, surr))) {
+          // Final report for the removed URR (TS 29.244 7.5.5.2)
+          pfcp::usage_report_trigger_t trigger = {};
+          trigger.termr                        = 1;
+          pfcp::usage_report_within_pfcp_session_modification_response
+              report = {};
+          surr->fill_usage_report(report, trigger, pfcp_urr::now_ntp());
+          resp->pfcp_ies.set(report);
+        }
+        if (not session->remove(urr, cause, offending_ie.offending_ie)) {
+          if (cause.cause_value ==
+              CAUSE_VALUE_RULE_CREATION_MODIFICATION_FAILURE) {
+            failed_rule.rule_id_type  = FAILED_RULE_ID_TYPE_URR;
+            failed_rule.rule_id_value = urr.urr_id.second.urr_id;
+            resp->pfcp_ies.set(failed_rule);
+            break;
+          }
+        }
+      }
+    }
+
     if (cause.cause_value == CAUSE_VALUE_REQUEST_ACCEPTED) {
       for (auto it : req->pfcp_ies.create_fars) {
         create_far& cr_far = it;
@@ -785,6 +1147,24 @@ void pfcp_switch::handle_pfcp_session_modification_request(
       }
     }
 
+    if (cause.cause_value == CAUSE_VALUE_REQUEST_ACCEPTED) {
+      for (auto it : req->pfcp_ies.create_qers) {
+        create_qer& cr_qer = it;
+        if (not session->create(cr_qer, cause, offending_ie.offending_ie)) {
+          break;
+        }
+      }
+    }
+
+    if (cause.cause_value == CAUSE_VALUE_REQUEST_ACCEPTED) {
+      for (auto it : req->pfcp_ies.create_urrs) {
+        create_urr& cr_urr = it;
+        if (not session->create(cr_urr, cause, offending_ie.offending_ie)) {
+          break;
+        }
+      }
+    }
+
     if (cause.cause_value == CAUSE_VALUE_REQUEST_ACCEPTED) {
       for (auto it : req->pfcp_ies.create_pdrs) {
         create_pdr& cr_pdr = it;
@@ -845,7 +1225,42 @@ void pfcp_switch::handle_pfcp_session_modification_request(
           resp->pfcp_ies.set(failed_rule);
         }
       }
+      for (auto it : req->pfcp_ies.update_qers) {
+        update_qer& qer     = it;
+        uint8_t cause_value = CAUSE_VALUE_REQUEST_ACCEPTED;
+        if (not session->update(qer, cause_value)) {
+          cause.cause_value            = cause_value;
+          failed_rule_id_t failed_rule = {};
+          failed_rule.rule_id_type     = FAILED_RULE_ID_TYPE_QER;
+          failed_rule.rule_id_value    = qer.qer_id.second.qer_id;
+          resp->pfcp_ies.set(failed_rule);
+        }
+      }
+      for (auto it : req->pfcp_ies.update_urrs) {
+        update_urr& urr     = it;
+        uint8_t cause_value = CAUSE_VALUE_REQUEST_ACCEPTED;
+        if (not session->update(urr, cause_value)) {
+          cause.cause_value            = cause_value;
+          failed_rule_id_t failed_rule = {};
+          failed_rule.rule_id_type     = FAILED_RULE_ID_TYPE_URR;
+          failed_rule.rule_id_value    = urr.urr_id.second.urr_id;
+          resp->pfcp_ies.set(failed_rule);
+        }
+      }
+      // TODO Query URR (TS 29.244 7.5.4.10) is not supported: it is not
+      // decoded in the modification request, the usage is only reported on
+      // thresholds, quotas, periods, Remove URR and session deletion.
     }
+    // Rules applied so far reach the datapath, even on partial failure
+    const bool dl_buffering = session->dl_buffering;
+    commit_fwd_entries(s);
+    // FAR BUFF -> FORW (Service Request after paging): send what was held,
+    // with the entries just committed. Datapath threads still reading the
+    // previous BUFF rules may be queueing: wait for them, nothing would flush
+    // their packets afterwards.
+    if (dl_buffering) folly::synchronize_rcu();
+    session->dl_buffer.flush(*session);
+    if (not session->urrs.empty()) start_timer_urr_check();
   }
   resp->pfcp_ies.set(cause);
   if ((cause.cause_value == CAUSE_VALUE_MANDATORY_IE_MISSING) ||
@@ -900,6 +1315,15 @@ void pfcp_switch::handle_pfcp_session_deletion_request(
     cause.cause_value = CAUSE_VALUE_SESSION_CONTEXT_NOT_FOUND;
   } else {
     resp->seid = s->cp_fseid.seid;
+    // Final usage reports (TS 29.244 7.5.7.2)
+    const uint32_t now                   = pfcp_urr::now_ntp();
+    pfcp::usage_report_trigger_t trigger = {};
+    trigger.termr                        = 1;
+    for (const auto& urr : s->urrs) {
+      pfcp::usage_report_within_pfcp_session_deletion_response report = {};
+      urr->fill_usage_report(report, trigger, now);
+      resp->pfcp_ies.set(report);
+    }
     remove_pfcp_session(s);
   }
   pfcp_associations::get_instance().notify_del_session(fseid);
@@ -937,41 +1361,83 @@ void pfcp_switch::handle_pfcp_session_deletion_request(
 #endif
 }
 //------------------------------------------------------------------------------
+void pfcp_switch::start_timer_urr_check() {
+  if (timer_urr_check_id) return;
+  timer_urr_check_id = itti_inst->timer_setup(
+      PFCP_SWITCH_URR_CHECK_INTERVAL_SECONDS, 0, TASK_SPGWU_APP,
+      TASK_SPGWU_PFCP_SWITCH_URR_CHECK);
+}
+//------------------------------------------------------------------------------
+void pfcp_switch::time_out_urr_check(const uint32_t timer_id) {
+  if (timer_id != timer_urr_check_id) return;
+  timer_urr_check_id = 0;
+
+  const uint32_t now = pfcp_urr::now_ntp();
+  bool has_urrs      = false;
+  for (const auto& it : up_seid2pfcp_sessions) {
+    const std::shared_ptr<pfcp::pfcp_session>& session = it.second;
+    if (session->urrs.empty()) continue;
+    has_urrs = true;
+
+    pfcp::pfcp_session_report_request h = {};
+    for (const auto& urr : session->urrs) {
+      pfcp::usage_report_trigger_t trigger = {};
+      if (urr->check(now, trigger)) {
+        pfcp::usage_report_within_pfcp_session_report_request report = {};
+        urr->fill_usage_report(report, trigger, now);
+        h.set(report);
+      }
+    }
+    if (not h.usage_reports.empty()) {
+      pfcp::report_type_t report_type = {};
+      report_type.usar                = 1;
+      h.set(report_type);
+      spgwu_sx_inst->send_sx_msg(session->cp_fseid, h);
+    }
+  }
+  if (has_urrs) start_timer_urr_check();
+}
+//------------------------------------------------------------------------------
+pfcp::dl_buffer_stats_t pfcp_switch::get_dl_buffer_stats() const {
+  pfcp::dl_buffer_stats_t stats = dl_buffer_stats_removed_;
+  for (const auto& it : up_seid2pfcp_sessions) {
+    it.second->dl_buffer.add_stats(stats);
+  }
+  return stats;
+}
+//------------------------------------------------------------------------------
+void pfcp_switch::time_out_dl_buffer_stats(const uint32_t timer_id) {
+  if (timer_id != timer_dl_buffer_stats_id) return;
+  pfcp::dl_buffer_stats_t stats = get_dl_buffer_stats();
+  Logger::pfcp_switch().info(
+      "DL buffers %" PRIu64 " packets %" PRIu64
+      " bytes, dropped overflow %" PRIu64 " no block %" PRIu64
+      " aged %" PRIu64 " discarded %" PRIu64 ", flushed %" PRIu64,
+      stats.packets, stats.bytes, stats.dropped_overflow,
+      stats.dropped_no_block, stats.dropped_aged, stats.dropped_discarded,
+      stats.flushed_packets);
+  timer_dl_buffer_stats_id = itti_inst->timer_setup(
+      PFCP_SWITCH_DL_BUFFER_STATS_PERIOD_SECONDS, 0, TASK_SPGWU_APP,
+      TASK_SPGWU_PFCP_SWITCH_DL_BUFFER_STATS);
+}
+//------------------------------------------------------------------------------
 void pfcp_switch::pfcp_session_look_up_pack_in_access(
     struct iphdr* const iph, const std::size_t num_bytes,
     const endpoint& r_endpoint, const uint32_t tunnel_id) {
   if (!spgwu_cfg.nsf.bypass_ul_pfcp_rules) {
-    std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>> pdrs = {};
-    if (get_pfcp_ul_pdrs_by_up_teid(tunnel_id, pdrs)) {
-      bool nocp = false;
-      bool buff = false;
-      for (std::vector<std::shared_ptr<pfcp::pfcp_pdr>>::iterator it_pdr =
-               pdrs->begin();
-           it_pdr < pdrs->end(); ++it_pdr) {
-        if ((*it_pdr)->look_up_pack_in_access(
-                iph, num_bytes, r_endpoint, tunnel_id)) {
-          std::shared_ptr<pfcp::pfcp_session> ssession = {};
-          uint64_t lseid                               = 0;
-          if ((*it_pdr)->get(lseid)) {
-            if (get_pfcp_session_by_up_seid(lseid, ssession)) {
-              pfcp::far_id_t far_id = {};
-              if ((*it_pdr)->get(far_id)) {
-                std::shared_ptr<pfcp::pfcp_far> sfar = {};
-                if (ssession->get(far_id.far_id, sfar)) {
-                  // Maintain uplink QFI in session
-                  uint8_t qfi   = (*it_pdr)->pdi.second.qfi.second.qfi;
-                  ssession->qfi = qfi;
-                  sfar->apply_forwarding_rules(iph, num_bytes, nocp, buff, 0);
-                }
-              }
-            }
-          }
-          return;
-        } else {
-          Logger::pfcp_switch().info(
-              "pfcp_session_look_up_pack_in_access failed PDR id %4x ",
-              (*it_pdr)->pdr_id.rule_id);
+    folly::rcu_reader rcu;
+    const pfcp::pfcp_fwd_entry* entry = get_ul_fwd_entry(tunnel_id);
+    if (entry) {
+      for (uint8_t i = 0; i < entry->num_rules; i++) {
+        const pfcp::pfcp_fwd_rule_t& rule = entry->rules[i];
+        if ((rule.match) && (not rule.pdr->look_up_pack_in_access(
+                                iph, num_bytes, r_endpoint, tunnel_id))) {
+          continue;
+        }
+        if (rule.police_ul(num_bytes)) {
+          apply_fwd_rule(rule, iph, num_bytes);
         }
+        return;
       }
     } else {
       // Logger::pfcp_switch().info( "pfcp_session_look_up_pack_in_access tunnel
@@ -987,9 +1453,40 @@ void pfcp_switch::pfcp_session_look_up_pack_in_access(
   }
 }
 //------------------------------------------------------------------------------
+void pfcp_switch::apply_fwd_rule(
+    const pfcp::pfcp_fwd_rule_t& rule, struct iphdr* const iph,
+    const std::size_t num_bytes) {
+  switch (rule.action) {
+    case PFCP_FWD_ACTION_FORW_ACCESS_GTPU:
+      spgwu_s1u_inst->send_g_pdu(
+          rule.g_pdu, reinterpret_cast<const char*>(iph), num_bytes);
+      break;
+    case PFCP_FWD_ACTION_FORW_CORE:
+      if (no_internal_loop(iph, num_bytes)) {
+        send_to_core(reinterpret_cast<char* const>(iph), num_bytes);
+      }
+      break;
+    case PFCP_FWD_ACTION_BUFF:  // done by the caller
+    case PFCP_FWD_ACTION_DROP:
+    default:;
+  }
+}
+//------------------------------------------------------------------------------
 bool pfcp_switch::no_internal_loop(
     struct iphdr* const iph, const std::size_t num_bytes) {
   pdn_cfg_t& pdn = spgwu_cfg.pdns[0];
+  if (iph->version == 6) {
+    const struct ipv6hdr* ip6h = (const struct ipv6hdr*) iph;
+    // UE to UE, except to the tun address (network::1)
+    if ((pdn.prefix_ipv6) &&
+        (ipv6_in_network(ip6h->daddr, pdn.network_ipv6, pdn.prefix_ipv6)) &&
+        ((ip6h->daddr.s6_addr[15] != 1) ||
+         (memcmp(ip6h->daddr.s6_addr, pdn.network_ipv6.s6_addr, 15)))) {
+      pfcp_session_look_up_pack_in_core((const char*) iph, num_bytes);
+      return false;
+    }
+    return true;
+  }
   if ((pdn.network_ipv4.s_addr == (iph->daddr & pdn.network_mask_ipv4_be)) &&
       ((be32toh(iph->daddr) & 0x000000FF) != 0X00000001)) {
     pfcp_session_look_up_pack_in_core((const char*) iph, num_bytes);
@@ -1001,7 +1498,33 @@ bool pfcp_switch::no_internal_loop(
 void pfcp_switch::pfcp_session_look_up_pack_in_access(
     struct ipv6hdr* const ip6h, const std::size_t num_bytes,
     const endpoint& r_endpoint, const uint32_t tunnel_id) {
-  // TODO
+  // The inner packet is forwarded in place, whatever its IP version
+  struct iphdr* const iph = (struct iphdr*) ip6h;
+  if (!spgwu_cfg.nsf.bypass_ul_pfcp_rules) {
+    folly::rcu_reader rcu;
+    const pfcp::pfcp_fwd_entry* entry = get_ul_fwd_entry(tunnel_id);
+    if (entry) {
+      for (uint8_t i = 0; i < entry->num_rules; i++) {
+        const pfcp::pfcp_fwd_rule_t& rule = entry->rules[i];
+        if ((rule.match) && (not rule.pdr->look_up_pack_in_access(
+                                ip6h, num_bytes, r_endpoint, tunnel_id))) {
+          continue;
+        }
+        if (rule.police_ul(num_bytes)) {
+          apply_fwd_rule(rule, iph, num_bytes);
+        }
+        return;
+      }
+    } else {
+      spgwu_s1u_inst->report_error_indication(r_endpoint, tunnel_id);
+    }
+  } else {
+    // Do not check PFCP rules for all UL data packet
+    if (no_internal_loop(iph, num_bytes)) {
+      pfcp_switch_inst->send_to_core(
+          reinterpret_cast<char* const>(iph), num_bytes);
+    }
+  }
 }
 //------------------------------------------------------------------------------
 void pfcp_switch::pfcp_session_look_up_pack_in_core(
@@ -1009,70 +1532,68 @@ void pfcp_switch::pfcp_session_look_up_pack_in_core(
   // Logger::pfcp_switch().info( "pfcp_session_look_up_pack_in_core %d bytes",
   // num_bytes);
   struct iphdr* iph = (struct iphdr*) buffer;
-  std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>> pdrs;
+  folly::rcu_reader rcu;
+  const pfcp::pfcp_fwd_entry* entry = nullptr;
   if (iph->version == 4) {
     uint32_t ue_ip = be32toh(iph->daddr);
-    if (get_pfcp_dl_pdrs_by_ue_ip(ue_ip, pdrs)) {
-      bool nocp = false;
-      bool buff = false;
-      for (std::vector<std::shared_ptr<pfcp::pfcp_pdr>>::iterator it =
-               pdrs->begin();
-           it < pdrs->end(); ++it) {
-        if ((*it)->look_up_pack_in_core(iph, num_bytes)) {
-          std::shared_ptr<pfcp::pfcp_session> ssession = {};
-          uint64_t lseid                               = 0;
-          if ((*it)->get(lseid)) {
-            if (get_pfcp_session_by_up_seid(lseid, ssession)) {
-              pfcp::far_id_t far_id = {};
-              if ((*it)->get(far_id)) {
-                std::shared_ptr<pfcp::pfcp_far> sfar = {};
-                uint8_t qfi                          = ssession->qfi;
-                //#if TRACE_IS_ON
-                //                Logger::pfcp_switch().trace(
-                //                "pfcp_session_look_up_pack_in_core %d bytes,
-                //                far id %08X", num_bytes, far_id);
-                //#endif
-                if (ssession->get(far_id.far_id, sfar)) {
-                  //#if TRACE_IS_ON
-                  //                  Logger::pfcp_switch().trace(
-                  //                  "pfcp_session_look_up_pack_in_core %d
-                  //                  bytes, got far, far id %08X", num_bytes,
-                  //                  far_id);
-                  //#endif
-                  sfar->apply_forwarding_rules(iph, num_bytes, nocp, buff, qfi);
-                  if (buff) {
-                    //#if TRACE_IS_ON
-                    //                    Logger::pfcp_switch().trace(
-                    //                    "Buffering %d bytes, far id %08X",
-                    //                    num_bytes, far_id);
-                    //#endif
-                    (*it)->buffering_requested(buffer, num_bytes);
-                  }
-                  if (nocp) {
-                    //#if TRACE_IS_ON
-                    //                    Logger::pfcp_switch().trace( "Notify
-                    //                    CP %d bytes, far id %08X", num_bytes,
-                    //                    far_id);
-                    //#endif
-                    (*it)->notify_cp_requested(ssession);
-                  }
-                }
-              }
-            }
-          }
-          return;
-        } else {
-          Logger::pfcp_switch().info(
-              "look_up_pack_in_core failed PDR id %4x ", (*it)->pdr_id.rule_id);
-        }
-      }
-    } else {
-      Logger::pfcp_switch().info(
+    entry          = get_dl_fwd_entry(ue_ip);
+    if (not entry) {
+      // Per packet, compiled out unless TRACE_IS_ON
+      Logger::pfcp_switch().trace(
           "pfcp_session_look_up_pack_in_core UE IP %8x not found", ue_ip);
+      return;
     }
   } else if (iph->version == 6) {
-    // TODO;
+    // IPv6 packets take the same zero-copy path, headroom is in front of the
+    // packet whatever its IP version
+    const uint64_t ue_prefix =
+        pfcp::ue_ipv6_prefix(((struct ipv6hdr*) buffer)->daddr);
+    entry = get_dl_fwd_entry_ipv6(ue_prefix);
+    if (not entry) {
+      Logger::pfcp_switch().trace(
+          "pfcp_session_look_up_pack_in_core UE IPv6 prefix %016lx not found",
+          ue_prefix);
+      return;
+    }
   } else {
     Logger::pfcp_switch().info("Unknown IP version %d packet", iph->version);
+    return;
+  }
+  pfcp::pfcp_session* const session = entry->session;
+  const pfcp::pfcp_fwd_rule_t* const rule =
+      match_dl_fwd_rule(*entry, iph, num_bytes);
+  if ((not rule) || (not rule->police_dl(num_bytes))) return;
+  // Behind the packets of the FAR still buffered, the Sx task sends them
+  if (session->dl_buffer.enqueue_if_pending(rule->far_id, buffer, num_bytes)) {
+    return;
+  }
+  apply_fwd_rule(*rule, iph, num_bytes);
+  if (rule->action == PFCP_FWD_ACTION_BUFF) {
+    rule->pdr->buffering_requested(
+        entry->session_ref, rule->far_id, buffer, num_bytes);
+  }
+  if (rule->nocp) {
+    rule->pdr->notify_cp_requested(entry->session_ref);
+  }
+}
+//------------------------------------------------------------------------------
+uint8_t pfcp_switch::forward_buffered_dl(
+    char* const buffer, const std::size_t num_bytes, uint32_t& far_id) {
+  struct iphdr* iph = (struct iphdr*) buffer;
+  folly::rcu_reader rcu;
+  const pfcp::pfcp_fwd_entry* entry = nullptr;
+  if (iph->version == 4) {
+    entry = get_dl_fwd_entry(be32toh(iph->daddr));
+  } else if (iph->version == 6) {
+    entry = get_dl_fwd_entry_ipv6(
+        pfcp::ue_ipv6_prefix(((struct ipv6hdr*) buffer)->daddr));
   }
+  if (not entry) return PFCP_FWD_ACTION_DROP;
+  const pfcp::pfcp_fwd_rule_t* const rule =
+      match_dl_fwd_rule(*entry, iph, num_bytes);
+  if (not rule) return PFCP_FWD_ACTION_DROP;
+  // Already counted and policed when it was buffered
+  far_id = rule->far_id;
+  apply_fwd_rule(*rule, iph, num_bytes);
+  return rule->action;
 }
@@ -32,14 +32,17 @@
 #include "itti.hpp"
 #include "itti_msg_sxab.hpp"
 #include "msg_pfcp.hpp"
+#include "pfcp_fwd.hpp"
 #include "pfcp_session.hpp"
 #include "uint_generator.hpp"
 #include "thread_sched.hpp"
 
 #include <folly/AtomicHashMap.h>
 #include <folly/MPMCQueue.h>
+#include <folly/synchronization/Rcu.h>
 #include <linux/ip.h>
 #include <linux/ipv6.h>
+#include <atomic>
 #include <unordered_map>
 #include <memory>
 #include <netinet/in.h>
@@ -62,14 +65,22 @@ class pfcp_switch {
   // Very unoptimized
 #define PFCP_SWITCH_RECV_BUFFER_SIZE 2048
 #define ROOM_FOR_GTPV1U_G_PDU 64
+  // SGi reader to DL workers, nullptr with a multi-queue tun
   folly::MPMCQueue<iovec_q_item_t*>* free_pool_;
   folly::MPMCQueue<iovec_q_item_t*>* work_pool_;
+  // Blocks holding DL packets of sessions whose FAR has BUFF set, kept apart
+  // from free_pool_ so that idle UEs never starve the SGi readers
+#define PFCP_SWITCH_DL_BUFFER_POOL_BLOCKS 4096
+  folly::MPMCQueue<char*>* dl_buffer_pool_;
   uint32_t num_threads_;
   char* recv_buffer_alloc_;
   char recv_buffer_[PFCP_SWITCH_RECV_BUFFER_SIZE];
   std::vector<std::thread> threads_;
   std::vector<int> socks_r;
   int sock_w;
+  // IFF_MULTI_QUEUE tun file descriptors, one per SGi thread
+  std::vector<int> tun_queues_;
+  std::atomic<unsigned int> next_tun_queue_;
   // std::string                               gw_mac_address;
   int pdn_if_index;
 
@@ -78,39 +89,56 @@ class pfcp_switch {
 
 #define TASK_SPGWU_PFCP_SWITCH_MAX_COMMIT_INTERVAL (0)
 #define TASK_SPGWU_PFCP_SWITCH_MIN_COMMIT_INTERVAL (1)
+#define TASK_SPGWU_PFCP_SWITCH_URR_CHECK (2)
+#define TASK_SPGWU_PFCP_SWITCH_DL_BUFFER_STATS (3)
 
 #define PFCP_SWITCH_MAX_COMMIT_INTERVAL_MILLISECONDS 200
 #define PFCP_SWITCH_MIN_COMMIT_INTERVAL_MILLISECONDS 50
+// Granularity of URR threshold/quota/period evaluation
+#define PFCP_SWITCH_URR_CHECK_INTERVAL_SECONDS 1
+#define PFCP_SWITCH_DL_BUFFER_STATS_PERIOD_SECONDS 60
 
   // switching_data_per_cpu_socket             switching_data[];
   std::unordered_map<pfcp::fseid_t, std::shared_ptr<pfcp::pfcp_session>>
       cp_fseid2pfcp_sessions;
   folly::AtomicHashMap<uint64_t, std::shared_ptr<pfcp::pfcp_session>>
       up_seid2pfcp_sessions;
-  folly::AtomicHashMap<
-      teid_t, std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>>
-      ul_s1u_teid2pfcp_pdr;
-  folly::AtomicHashMap<
-      uint32_t, std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>>
-      ue_ipv4_hbo2pfcp_pdr;
+  // Datapath tables, written by the SPGWU_APP task only. Entries are
+  // immutable, replaced ones are reclaimed once no datapath thread is in an
+  // RCU read-side section anymore.
+  folly::AtomicHashMap<teid_t, std::atomic<const pfcp::pfcp_fwd_entry*>>
+      ul_s1u_teid2fwd_entry;
+  folly::AtomicHashMap<uint32_t, std::atomic<const pfcp::pfcp_fwd_entry*>>
+      ue_ipv4_hbo2fwd_entry;
+  // Keyed by the /64 prefix of the UE IPv6 address, host byte order
+  folly::AtomicHashMap<uint64_t, std::atomic<const pfcp::pfcp_fwd_entry*>>
+      ue_ipv6_prefix2fwd_entry;
 
   // moodycamel::ConcurrentQueue<pfcp::pfcp_session*> create_session_q;
 
   void pdn_worker(const int id, const util::thread_sched_params& sched_params);
   void pdn_read_loop(int sock_r, util::thread_sched_params sched_params);
+  void pdn_queue_loop(
+      int queue_fd, const int queue_id,
+      util::thread_sched_params sched_params);
   int create_pdn_socket(
       const char* const ifname, const bool promisc, int& if_index);
   int create_pdn_socket(const char* const ifname);
-  int tun_open(char* devname, int flags);
+  int tun_open(char* devname, int flags, const bool multi_queue = false);
   void setup_pdn_interfaces();
 
   timer_id_t timer_max_commit_interval_id;
   timer_id_t timer_min_commit_interval_id;
+  timer_id_t timer_urr_check_id;
+  timer_id_t timer_dl_buffer_stats_id;
+  // DL buffer counters of the deleted sessions
+  pfcp::dl_buffer_stats_t dl_buffer_stats_removed_;
 
   void stop_timer_min_commit_interval();
   void start_timer_min_commit_interval();
   void stop_timer_max_commit_interval();
   void start_timer_max_commit_interval();
+  void start_timer_urr_check();
 
   void commit_changes();
 
@@ -118,19 +146,58 @@ class pfcp_switch {
       const pfcp::fseid_t&, std::shared_ptr<pfcp::pfcp_session>&) const;
   bool get_pfcp_session_by_up_seid(
       const uint64_t, std::shared_ptr<pfcp::pfcp_session>&) const;
-  bool get_pfcp_ul_pdrs_by_up_teid(
-      const teid_t,
-      std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>&) const;
-  bool get_pfcp_dl_pdrs_by_ue_ip(
-      const uint32_t,
-      std::shared_ptr<std::vector<std::shared_ptr<pfcp::pfcp_pdr>>>&) const;
+  // Datapath, to be called within a folly::rcu_reader section
+  inline const pfcp::pfcp_fwd_entry* get_ul_fwd_entry(const teid_t teid) const {
+    auto it = ul_s1u_teid2fwd_entry.find(teid);
+    if (it == ul_s1u_teid2fwd_entry.end()) return nullptr;
+    return it->second.load(std::memory_order_acquire);
+  }
+  inline const pfcp::pfcp_fwd_entry* get_dl_fwd_entry(
+      const uint32_t ue_ip) const {
+    auto it = ue_ipv4_hbo2fwd_entry.find(ue_ip);
+    if (it == ue_ipv4_hbo2fwd_entry.end()) return nullptr;
+    return it->second.load(std::memory_order_acquire);
+  }
+  inline const pfcp::pfcp_fwd_entry* get_dl_fwd_entry_ipv6(
+      const uint64_t ue_prefix) const {
+    auto it = ue_ipv6_prefix2fwd_entry.find(ue_prefix);
+    if (it == ue_ipv6_prefix2fwd_entry.end()) return nullptr;
+    return it->second.load(std::memory_order_acquire);
+  }
+  // First rule of a DL entry matched by the packet, nullptr if none
+  static inline const pfcp::pfcp_fwd_rule_t* match_dl_fwd_rule(
+      const pfcp::pfcp_fwd_entry& entry, struct iphdr* const iph,
+      const std::size_t num_bytes) {
+    for (uint8_t i = 0; i < entry.num_rules; i++) {
+      const pfcp::pfcp_fwd_rule_t& rule = entry.rules[i];
+      if ((rule.match) &&
+          (not((iph->version == 4) ?
+                   rule.pdr->look_up_pack_in_core(iph, num_bytes) :
+                   rule.pdr->look_up_pack_in_core(
+                       (struct ipv6hdr*) iph, num_bytes)))) {
+        continue;
+      }
+      return &rule;
+    }
+    return nullptr;
+  }
+  void apply_fwd_rule(
+      const pfcp::pfcp_fwd_rule_t& rule, struct iphdr* const iph,
+      const std::size_t num_bytes);
+
+  // Control side
+  bool compile_fwd_rule(
+      const pfcp::pfcp_session& session,
+      const std::shared_ptr<pfcp::pfcp_pdr>& pdr,
+      pfcp::pfcp_fwd_entry& entry) const;
+  // (Re)publish the entries of all TEIDs and UE addresses of the session
+  void commit_fwd_entries(std::shared_ptr<pfcp::pfcp_session>& session);
+  void withdraw_fwd_entries(pfcp::pfcp_session& session);
 
   void add_pfcp_session_by_cp_fseid(
       const pfcp::fseid_t&, std::shared_ptr<pfcp::pfcp_session>&);
   void add_pfcp_session_by_up_seid(
       const uint64_t, std::shared_ptr<pfcp::pfcp_session>&);
-  void add_pfcp_ul_pdr_by_up_teid(
-      const teid_t teid, std::shared_ptr<pfcp::pfcp_pdr>&);
 
   void remove_pfcp_session(std::shared_ptr<pfcp::pfcp_session>&);
 
@@ -143,13 +210,7 @@ class pfcp_switch {
   pfcp_switch(pfcp_switch const&) = delete;
   void operator=(pfcp_switch const&) = delete;
 
-  void add_pfcp_dl_pdr_by_ue_ip(
-      const uint32_t ue_ip, std::shared_ptr<pfcp::pfcp_pdr>&);
-
   pfcp::fteid_t generate_fteid_s1u();
-  bool create_packet_in_access(
-      std::shared_ptr<pfcp::pfcp_pdr>& pdr, const pfcp::fteid_t& in,
-      uint8_t& cause);
 
   void pfcp_session_look_up_pack_in_access(
       struct iphdr* const iph, const std::size_t num_bytes,
@@ -169,6 +230,17 @@ class pfcp_switch {
   void pfcp_session_look_up_pack_in_core(
       const char* buffer, const std::size_t num_bytes);
 
+  // DL buffering blocks, room for a G-PDU header is left before the block.
+  // get_dl_buffer_block() returns nullptr when the pool is exhausted.
+  char* get_dl_buffer_block();
+  void release_dl_buffer_block(char* const block);
+  // SPGWU_APP task, DL buffer flush: apply the rule now published for a
+  // buffered packet and return its action (PFCP_FWD_ACTION_*), far_id is set
+  // to the FAR of the rule
+  uint8_t forward_buffered_dl(
+      char* const buffer, const std::size_t num_bytes, uint32_t& far_id);
+
+  // IPv4 or IPv6 packet, return false if it was looped back to a UE
   bool no_internal_loop(struct iphdr* const iph, const std::size_t num_bytes);
   void send_to_core(char* const ip_packet, const ssize_t len);
 
@@ -184,10 +256,13 @@ class pfcp_switch {
 
   void time_out_min_commit_interval(const uint32_t timer_id);
   void time_out_max_commit_interval(const uint32_t timer_id);
+  void time_out_urr_check(const uint32_t timer_id);
+  void time_out_dl_buffer_stats(const uint32_t timer_id);
+
+  // DL buffers of all the sessions, SPGWU_APP task only
+  pfcp::dl_buffer_stats_t get_dl_buffer_stats() const;
 
   void remove_pfcp_session(const pfcp::fseid_t& cp_fseid);
-  void remove_pfcp_ul_pdrs_by_up_teid(const teid_t);
-  void remove_pfcp_dl_pdrs_by_ue_ip(const uint32_t);
 
   std::string to_string() const;
 };
@@ -0,0 +1,196 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_urr.cpp
+   \brief Usage Reporting Rule: volume/duration measurement and reporting
+   \date 2021
+*/
+
+#include "pfcp_urr.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+
+using namespace pfcp;
+
+unsigned int pfcp_urr::num_shards = 8;
+
+//------------------------------------------------------------------------------
+pfcp_urr::pfcp_urr(const pfcp::create_urr& c)
+    : urr_id(c.urr_id.second),
+      measurement_method(c.measurement_method),
+      reporting_triggers(c.reporting_triggers),
+      measurement_period(c.measurement_period),
+      volume_threshold(c.volume_threshold),
+      volume_quota(c.volume_quota),
+      time_threshold(c.time_threshold),
+      time_quota(c.time_quota),
+      quota_exhausted(false),
+      counters(new urr_counters_t[num_shards]()),
+      reported(),
+      quota_base(),
+      last_seen(),
+      ur_seqn(0),
+      first_packet_time(0),
+      last_packet_time(0) {
+  start_time   = now_ntp();
+  period_start = start_time;
+  provision_quotas(start_time);
+}
+
+//------------------------------------------------------------------------------
+void pfcp_urr::set_num_shards(const unsigned int n) {
+  num_shards = std::max(n, 1U);
+}
+
+//------------------------------------------------------------------------------
+bool pfcp_urr::update(const pfcp::update_urr& update, uint8_t& cause_value) {
+  const uint32_t now = now_ntp();
+  if (update.get(measurement_method.second)) measurement_method.first = true;
+  if (update.get(reporting_triggers.second)) reporting_triggers.first = true;
+  if (update.get(measurement_period.second)) {
+    measurement_period.first = true;
+    period_start             = now;
+  }
+  if (update.get(volume_threshold.second)) volume_threshold.first = true;
+  if (update.get(time_threshold.second)) time_threshold.first = true;
+  // A new quota replaces the remaining one (TS 29.244 5.2.2.2)
+  bool new_quota = false;
+  if (update.get(volume_quota.second)) {
+    volume_quota.first = true;
+    new_quota          = true;
+  }
+  if (update.get(time_quota.second)) {
+    time_quota.first = true;
+    new_quota        = true;
+  }
+  if (new_quota) provision_quotas(now);
+  // TODO subsequent thresholds/quotas, quota holding time, linked URRs
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void pfcp_urr::provision_quotas(const uint32_t now) {
+  quota_base       = snapshot();
+  time_quota_start = now;
+  quota_exhausted.store(false, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+urr_usage_t pfcp_urr::snapshot() const {
+  urr_usage_t u = {};
+  for (unsigned int i = 0; i < num_shards; i++) {
+    const urr_counters_t& c = counters[i];
+    u.ul_bytes += c.ul_bytes.load(std::memory_order_relaxed);
+    u.dl_bytes += c.dl_bytes.load(std::memory_order_relaxed);
+    u.ul_packets += c.ul_packets.load(std::memory_order_relaxed);
+    u.dl_packets += c.dl_packets.load(std::memory_order_relaxed);
+  }
+  return u;
+}
+
+//------------------------------------------------------------------------------
+urr_usage_t pfcp_urr::observe(const uint32_t now) {
+  const urr_usage_t u = snapshot();
+  if ((u.ul_packets != last_seen.ul_packets) ||
+      (u.dl_packets != last_seen.dl_packets)) {
+    if (not first_packet_time) first_packet_time = now;
+    last_packet_time = now;
+  }
+  last_seen = u;
+  return u;
+}
+
+//------------------------------------------------------------------------------
+bool pfcp_urr::check(
+    const uint32_t now, pfcp::usage_report_trigger_t& trigger) {
+  trigger             = {};
+  bool report         = false;
+  const urr_usage_t u = observe(now);
+
+  if (reporting_triggers.first) {
+    const pfcp::reporting_triggers_t& rt = reporting_triggers.second;
+    if ((rt.volth) && (volume_threshold.first)) {
+      const pfcp::volume_threshold_t& vt = volume_threshold.second;
+      const uint64_t ul                  = u.ul_bytes - reported.ul_bytes;
+      const uint64_t dl                  = u.dl_bytes - reported.dl_bytes;
+      if (((vt.tovol) && (ul + dl >= vt.total_volume)) ||
+          ((vt.ulvol) && (ul >= vt.uplink_volume)) ||
+          ((vt.dlvol) && (dl >= vt.downlink_volume))) {
+        trigger.volth = 1;
+        report        = true;
+      }
+    }
+    if ((rt.timth) && (time_threshold.first) &&
+        (now - start_time >= time_threshold.second.time_threshold)) {
+      trigger.timth = 1;
+      report        = true;
+    }
+    if ((rt.perio) && (measurement_period.first) &&
+        (measurement_period.second.measurement_period) &&
+        (now - period_start >= measurement_period.second.measurement_period)) {
+      trigger.perio = 1;
+      report        = true;
+      period_start  = now;
+    }
+  }
+
+  if (not quota_exhausted.load(std::memory_order_relaxed)) {
+    bool exhausted = false;
+    if (volume_quota.first) {
+      const pfcp::volume_quota_t& vq = volume_quota.second;
+      const uint64_t ul              = u.ul_bytes - quota_base.ul_bytes;
+      const uint64_t dl              = u.dl_bytes - quota_base.dl_bytes;
+      if (((vq.tovol) && (ul + dl >= vq.total_volume)) ||
+          ((vq.ulvol) && (ul >= vq.uplink_volume)) ||
+          ((vq.dlvol) && (dl >= vq.downlink_volume))) {
+        exhausted = true;
+        if ((reporting_triggers.first) && (reporting_triggers.second.volqu)) {
+          trigger.volqu = 1;
+          report        = true;
+        }
+      }
+    }
+    if ((time_quota.first) &&
+        (now - time_quota_start >= time_quota.second.time_quota)) {
+      exhausted = true;
+      if ((reporting_triggers.first) && (reporting_triggers.second.timqu)) {
+        trigger.timqu = 1;
+        report        = true;
+      }
+    }
+    if (exhausted) {
+      quota_exhausted.store(true, std::memory_order_relaxed);
+      Logger::spgwu_sx().info(
+          "URR %08x quota exhausted, dropping traffic", urr_id.urr_id);
+    }
+  }
+  return report;
+}
+
+//------------------------------------------------------------------------------
+std::string pfcp_urr::to_string() const {
+  const urr_usage_t u = snapshot();
+  return fmt::format(
+      "URR {:08x} UL {} bytes {} packets DL {} bytes {} packets{}",
+      urr_id.urr_id, u.ul_bytes, u.ul_packets, u.dl_bytes, u.dl_packets,
+      quota_exhausted.load() ? " (quota exhausted)" : "");
+}
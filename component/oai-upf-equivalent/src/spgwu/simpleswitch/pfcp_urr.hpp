@@ -0,0 +1,183 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file pfcp_urr.hpp
+   \brief Usage Reporting Rule: volume/duration measurement and reporting
+   \date 2021
+*/
+
+#ifndef FILE_PFCP_URR_HPP_SEEN
+#define FILE_PFCP_URR_HPP_SEEN
+
+#include <time.h>
+
+#include <atomic>
+#include <memory>
+
+#include "msg_pfcp.hpp"
+
+// Seconds between 1900 (NTP epoch, TS 29.244 8.2.38) and 1970
+#define PFCP_URR_NTP_OFFSET 2208988800UL
+
+namespace pfcp {
+
+// One cache line per shard. With a shard per datapath thread a thread only
+// touches its own line, threads beyond the number given to set_num_shards()
+// share shards (the counters stay exact, the lines are contended).
+typedef struct alignas(64) urr_counters_s {
+  std::atomic<uint64_t> ul_bytes;
+  std::atomic<uint64_t> dl_bytes;
+  std::atomic<uint64_t> ul_packets;
+  std::atomic<uint64_t> dl_packets;
+} urr_counters_t;
+
+// Aggregated (read side) view of the shards
+typedef struct urr_usage_s {
+  uint64_t ul_bytes;
+  uint64_t dl_bytes;
+  uint64_t ul_packets;
+  uint64_t dl_packets;
+} urr_usage_t;
+
+class pfcp_urr {
+ public:
+  pfcp::urr_id_t urr_id;
+  std::pair<bool, pfcp::measurement_method_t> measurement_method;
+  std::pair<bool, pfcp::reporting_triggers_t> reporting_triggers;
+  std::pair<bool, pfcp::measurement_period_t> measurement_period;
+  std::pair<bool, pfcp::volume_threshold_t> volume_threshold;
+  std::pair<bool, pfcp::volume_quota_t> volume_quota;
+  std::pair<bool, pfcp::time_threshold_t> time_threshold;
+  std::pair<bool, pfcp::time_quota_t> time_quota;
+
+  // Set by check() when a quota is reached, traffic is then dropped
+  std::atomic<bool> quota_exhausted;
+
+  explicit pfcp_urr(const pfcp::create_urr& c);
+
+  // Number of datapath threads counting, called once before any URR exists
+  static void set_num_shards(const unsigned int n);
+
+  bool update(const pfcp::update_urr& update, uint8_t& cause_value);
+
+  // Datapath side, called by pdn_worker / S1U threads
+  inline void count_ul(const std::size_t num_bytes) {
+    urr_counters_t& c = counters[shard_index()];
+    c.ul_bytes.fetch_add(num_bytes, std::memory_order_relaxed);
+    c.ul_packets.fetch_add(1, std::memory_order_relaxed);
+  }
+  inline void count_dl(const std::size_t num_bytes) {
+    urr_counters_t& c = counters[shard_index()];
+    c.dl_bytes.fetch_add(num_bytes, std::memory_order_relaxed);
+    c.dl_packets.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Control side, called by the SPGWU_APP task only
+
+  // NTP seconds (TS 29.244 8.2.38)
+  static inline uint32_t now_ntp() {
+    return (uint32_t)(time(nullptr) + PFCP_URR_NTP_OFFSET);
+  }
+
+  // Evaluate thresholds, quotas and period; return true if a report is due
+  bool check(const uint32_t now, pfcp::usage_report_trigger_t& trigger);
+
+  // Fill a Usage Report IE (Modification/Deletion Response or Report Request)
+  // and start a new measurement interval.
+  template <class T>
+  void fill_usage_report(
+      T& report, const pfcp::usage_report_trigger_t& trigger,
+      const uint32_t now) {
+    const urr_usage_t u = observe(now);
+    report.set(urr_id);
+    pfcp::ur_seqn_t seqn = {.ur_seqn = ur_seqn++};
+    report.set(seqn);
+    report.set(trigger);
+    pfcp::start_time_t st = {.start_time = start_time};
+    report.set(st);
+    pfcp::end_time_t et = {.end_time = now};
+    report.set(et);
+    if ((not measurement_method.first) || (measurement_method.second.volum)) {
+      pfcp::volume_measurement_t vm = {};
+      vm.tovol                      = 1;
+      vm.ulvol                      = 1;
+      vm.dlvol                      = 1;
+      vm.tonop                      = 1;
+      vm.ulnop                      = 1;
+      vm.dlnop                      = 1;
+      vm.uplink_volume              = u.ul_bytes - reported.ul_bytes;
+      vm.downlink_volume            = u.dl_bytes - reported.dl_bytes;
+      vm.total_volume               = vm.uplink_volume + vm.downlink_volume;
+      vm.uplink_nop                 = u.ul_packets - reported.ul_packets;
+      vm.downlink_nop               = u.dl_packets - reported.dl_packets;
+      vm.total_nop                  = vm.uplink_nop + vm.downlink_nop;
+      report.set(vm);
+    }
+    if ((measurement_method.first) && (measurement_method.second.durat)) {
+      pfcp::duration_measurement_t dm = {.duration = now - start_time};
+      report.set(dm);
+    }
+    if (first_packet_time) {
+      pfcp::time_of_first_packet_t tf = {.time_of_first_packet =
+                                             first_packet_time};
+      report.set(tf);
+      pfcp::time_of_last_packet_t tl = {.time_of_last_packet =
+                                            last_packet_time};
+      report.set(tl);
+    }
+    reported          = u;
+    start_time        = now;
+    first_packet_time = 0;
+    last_packet_time  = 0;
+  }
+
+  std::string to_string() const;
+
+ private:
+  static unsigned int num_shards;
+  std::unique_ptr<urr_counters_t[]> counters;
+
+  // Measurement state, only accessed by the SPGWU_APP task
+  urr_usage_t reported;    // usage at the last report
+  urr_usage_t quota_base;  // usage when the volume quota was provisioned
+  urr_usage_t last_seen;   // usage at the last check()
+  uint32_t ur_seqn;
+  uint32_t start_time;  // start of the current measurement interval
+  uint32_t period_start;
+  uint32_t time_quota_start;
+  uint32_t first_packet_time;
+  uint32_t last_packet_time;
+
+  static inline unsigned int shard_index() {
+    static std::atomic<unsigned int> next_shard(0);
+    static thread_local const unsigned int shard =
+        next_shard.fetch_add(1, std::memory_order_relaxed) % num_shards;
+    return shard;
+  }
+
+  urr_usage_t snapshot() const;
+  // snapshot() and track time of first/last packet at check() granularity
+  urr_usage_t observe(const uint32_t now);
+  void provision_quotas(const uint32_t now);
+};
+}  // namespace pfcp
+
+#endif /* FILE_PFCP_URR_HPP_SEEN */
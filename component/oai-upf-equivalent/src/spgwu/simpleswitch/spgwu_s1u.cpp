@@ -76,6 +76,7 @@ void spgwu_s1u_task(void* args_p) {
       case TIME_OUT:
         if (itti_msg_timeout* to = dynamic_cast<itti_msg_timeout*>(msg)) {
           Logger::spgwu_s1u().info("TIME-OUT event timer id %d", to->timer_id);
+          spgwu_s1u_inst->time_out_itti_event(to->timer_id);
         }
         break;
 
@@ -102,16 +103,39 @@ spgwu_s1u::spgwu_s1u()
     : gtpu_l4_stack(
           spgwu_cfg.s1_up.addr4, spgwu_cfg.s1_up.port,
           spgwu_cfg.s1_up.thread_rd_sched_params,
-          spgwu_cfg.upf_5g_features.enable_5g_features) {
+          spgwu_cfg.upf_5g_features.enable_5g_features,
+          spgwu_cfg.s1_up_batching),
+      timer_batch_stats(ITTI_INVALID_TIMER_ID) {
   Logger::spgwu_s1u().startup("Starting...");
   if (itti_inst->create_task(
           TASK_SPGWU_S1U, spgwu_s1u_task, &spgwu_cfg.itti.s1u_sched_params)) {
     Logger::spgwu_s1u().error("Cannot create task TASK_SPGWU_S1U");
     throw std::runtime_error("Cannot create task TASK_SPGWU_S1U");
   }
+  if ((spgwu_cfg.s1_up_batching.rx_batch_size > 1) ||
+      (spgwu_cfg.s1_up_batching.tx_batch_size > 1)) {
+    timer_batch_stats = itti_inst->timer_setup(
+        SPGWU_S1U_BATCH_STATS_PERIOD_SEC, 0, TASK_SPGWU_S1U);
+  }
   Logger::spgwu_s1u().startup("Started");
 }
 //------------------------------------------------------------------------------
+void spgwu_s1u::time_out_itti_event(const uint32_t timer_id) {
+  if (timer_id != timer_batch_stats) return;
+  udp_batch_stats_t stats = get_batch_stats();
+  Logger::spgwu_s1u().info(
+      "GTP-U batching RX %" PRIu64 " packets in %" PRIu64
+      " batches (avg %.1f), TX %" PRIu64 " packets in %" PRIu64
+      " batches (avg %.1f, GSO %" PRIu64 ", errors %" PRIu64 ")",
+      stats.rx_packets, stats.rx_batches,
+      (stats.rx_batches) ? (double) stats.rx_packets / stats.rx_batches : 0.0,
+      stats.tx_packets, stats.tx_batches,
+      (stats.tx_batches) ? (double) stats.tx_packets / stats.tx_batches : 0.0,
+      stats.tx_gso_batches, stats.tx_errors);
+  timer_batch_stats = itti_inst->timer_setup(
+      SPGWU_S1U_BATCH_STATS_PERIOD_SEC, 0, TASK_SPGWU_S1U);
+}
+//------------------------------------------------------------------------------
 void spgwu_s1u::handle_receive(
     char* recv_buffer, const std::size_t bytes_transferred,
     const endpoint& r_endpoint) {
@@ -204,25 +228,18 @@ void spgwu_s1u::send_g_pdu(
     uint8_t qfi) {
   // Logger::spgwu_s1u().info( "spgwu_s1u::send_g_pdu() TEID " TEID_FMT " %d
   // bytes", num_bytes);
-  struct sockaddr_in peer_sock_addr;
-  peer_sock_addr.sin_family = AF_INET;
-  peer_sock_addr.sin_addr   = peer_addr;
-  peer_sock_addr.sin_port   = htobe16(peer_udp_port);
-  gtpu_l4_stack::send_g_pdu(
-      peer_sock_addr, (teid_t) tunnel_id, send_buffer, num_bytes, qfi);
+  gtpv1u::gtpu_g_pdu_template_t t = {};
+  build_g_pdu_template(peer_addr, peer_udp_port, (teid_t) tunnel_id, qfi, t);
+  gtpu_l4_stack::send_g_pdu(t, send_buffer, num_bytes);
 }
 //------------------------------------------------------------------------------
 void spgwu_s1u::send_g_pdu(
     const struct in6_addr& peer_addr, const uint16_t peer_udp_port,
-    const uint32_t tunnel_id, const char* send_buffer,
-    const ssize_t num_bytes) {
-  struct sockaddr_in6 peer_sock_addr;
-  peer_sock_addr.sin6_family   = AF_INET6;
-  peer_sock_addr.sin6_addr     = peer_addr;
-  peer_sock_addr.sin6_port     = htobe16(peer_udp_port);
-  peer_sock_addr.sin6_flowinfo = 0;
-  peer_sock_addr.sin6_scope_id = 0;
-  gtpu_l4_stack::send_g_pdu(peer_sock_addr, tunnel_id, send_buffer, num_bytes);
+    const uint32_t tunnel_id, const char* send_buffer, const ssize_t num_bytes,
+    uint8_t qfi) {
+  gtpv1u::gtpu_g_pdu_template_t t = {};
+  build_g_pdu_template(peer_addr, peer_udp_port, tunnel_id, qfi, t);
+  gtpu_l4_stack::send_g_pdu(t, send_buffer, num_bytes);
 }
 //------------------------------------------------------------------------------
 void spgwu_s1u::handle_receive_echo_request(
@@ -40,10 +40,13 @@
 
 namespace spgwu {
 
+#define SPGWU_S1U_BATCH_STATS_PERIOD_SEC 60
+
 class spgwu_s1u : public gtpv1u::gtpu_l4_stack {
  private:
   std::thread::id thread_id;
   std::thread thread;
+  timer_id_t timer_batch_stats;
 
   void handle_receive_gtpv1u_msg(
       gtpv1u::gtpv1u_msg& msg, const endpoint& r_endpoint);
@@ -73,6 +76,7 @@ class spgwu_s1u : public gtpv1u::gtpu_l4_stack {
       char* recv_buffer, const std::size_t bytes_transferred,
       const endpoint& r_endpoint);
 
+  using gtpv1u::gtpu_l4_stack::send_g_pdu;
   void send_g_pdu(
       const struct in_addr& peer_addr, const uint16_t peer_udp_port,
       const uint32_t tunnel_id, const char* send_buffer,
@@ -80,7 +84,7 @@ class spgwu_s1u : public gtpv1u::gtpu_l4_stack {
   void send_g_pdu(
       const struct in6_addr& peer_addr, const uint16_t peer_udp_port,
       const uint32_t tunnel_id, const char* send_buffer,
-      const ssize_t num_bytes);
+      const ssize_t num_bytes, uint8_t qfi);
 
   void time_out_itti_event(const uint32_t timer_id);
   void report_error_indication(
@@ -109,6 +109,12 @@ void spgwu_app_task(void* args_p) {
             case TASK_SPGWU_PFCP_SWITCH_MAX_COMMIT_INTERVAL:
               // pfcp_switch_inst->time_out_max_commit_interval(to->timer_id);
               break;
+            case TASK_SPGWU_PFCP_SWITCH_URR_CHECK:
+              pfcp_switch_inst->time_out_urr_check(to->timer_id);
+              break;
+            case TASK_SPGWU_PFCP_SWITCH_DL_BUFFER_STATS:
+              pfcp_switch_inst->time_out_dl_buffer_stats(to->timer_id);
+              break;
             default:;
           }
         }
@@ -268,6 +268,40 @@ int spgwu_config::load_interface(const Setting& if_cfg, interface_cfg_t& cfg) {
   return RETURNok;
 }
 
+//------------------------------------------------------------------------------
+int spgwu_config::load_batching(
+    const Setting& batching_cfg, udp_batch_params_t& cfg) {
+  std::string astring = {};
+  cfg.rx_batch_size   = 1;
+  cfg.tx_batch_size   = 1;
+  cfg.gso             = false;
+  if (batching_cfg.lookupValue(SPGWU_CONFIG_STRING_BATCHING_ENABLE, astring)) {
+    if (not boost::iequals(astring, "yes")) {
+      return RETURNok;
+    }
+  }
+  cfg.rx_batch_size = 32;
+  cfg.tx_batch_size = 32;
+  batching_cfg.lookupValue(
+      SPGWU_CONFIG_STRING_RX_BATCH_SIZE, cfg.rx_batch_size);
+  batching_cfg.lookupValue(
+      SPGWU_CONFIG_STRING_TX_BATCH_SIZE, cfg.tx_batch_size);
+  if ((cfg.rx_batch_size < 1) || (cfg.rx_batch_size > UDP_MAX_BATCH_SIZE) ||
+      (cfg.tx_batch_size < 1) || (cfg.tx_batch_size > UDP_MAX_BATCH_SIZE)) {
+    Logger::spgwu_app().error(
+        "Batch sizes (RX %u, TX %u) must be in interval [1..%d] in config "
+        "file",
+        cfg.rx_batch_size, cfg.tx_batch_size, UDP_MAX_BATCH_SIZE);
+    cfg.rx_batch_size = 1;
+    cfg.tx_batch_size = 1;
+    return RETURNerror;
+  }
+  if (batching_cfg.lookupValue(SPGWU_CONFIG_STRING_UDP_GSO, astring)) {
+    cfg.gso = boost::iequals(astring, "yes");
+  }
+  return RETURNok;
+}
+
 //------------------------------------------------------------------------------
 int spgwu_config::load(const string& config_file) {
   Config cfg;
@@ -337,12 +371,24 @@ int spgwu_config::load(const string& config_file) {
     const Setting& s1_up_cfg =
         nw_if_cfg[SPGWU_CONFIG_STRING_INTERFACE_S1U_S12_S4_UP];
     load_interface(s1_up_cfg, s1_up);
+    try {
+      const Setting& batching_cfg = s1_up_cfg[SPGWU_CONFIG_STRING_BATCHING];
+      load_batching(batching_cfg, s1_up_batching);
+    } catch (const SettingNotFoundException& nfex) {
+      Logger::spgwu_app().info(
+          "%s : %s, using defaults", nfex.what(), nfex.getPath());
+    }
 
     const Setting& sx_cfg = nw_if_cfg[SPGWU_CONFIG_STRING_INTERFACE_SX];
     load_interface(sx_cfg, sx);
 
     const Setting& sgi_cfg = nw_if_cfg[SPGWU_CONFIG_STRING_INTERFACE_SGI];
     load_interface(sgi_cfg, sgi);
+    std::string multi_queue = {};
+    if (sgi_cfg.lookupValue(
+            SPGWU_CONFIG_STRING_TUN_MULTI_QUEUE, multi_queue)) {
+      sgi_tun_multi_queue = boost::iequals(multi_queue, "yes");
+    }
 
     if ((boost::iequals(sgi.if_name, "none")) ||
         (boost::iequals(sgi.if_name, "default_gateway"))) {
@@ -720,6 +766,13 @@ void spgwu_config::display() {
   Logger::spgwu_app().info(
       "      thread pool size: %d",
       s1_up.thread_rd_sched_params.thread_pool_size);
+  Logger::spgwu_app().info("    Batching:");
+  Logger::spgwu_app().info(
+      "      RX batch size ..: %u", s1_up_batching.rx_batch_size);
+  Logger::spgwu_app().info(
+      "      TX batch size ..: %u", s1_up_batching.tx_batch_size);
+  Logger::spgwu_app().info(
+      "      UDP GSO ........: %s", (s1_up_batching.gso) ? "yes" : "no");
   Logger::spgwu_app().info("- SXA-SXB:");
   Logger::spgwu_app().info("    iface ............: %s", sx.if_name.c_str());
   Logger::spgwu_app().info("    ipv4.addr ........: %s", inet_ntoa(sx.addr4));
@@ -756,6 +809,8 @@ void spgwu_config::display() {
   Logger::spgwu_app().info(
       "      thread pool size: %d",
       sgi.thread_rd_sched_params.thread_pool_size);
+  Logger::spgwu_app().info(
+      "    tun multi-queue ..: %s", (sgi_tun_multi_queue) ? "yes" : "no");
   Logger::spgwu_app().info("- PDN networks:");
   Logger::spgwu_app().info("    SNAT .............: %s", (snat) ? "yes" : "no");
   int i = 1;
@@ -57,6 +57,12 @@ namespace spgwu {
 #define SPGWU_CONFIG_STRING_THREAD_RD_SCHED_POLICY "SCHED_POLICY"
 #define SPGWU_CONFIG_STRING_THREAD_RD_SCHED_PRIORITY "SCHED_PRIORITY"
 #define SPGWU_CONFIG_STRING_THREAD_POOL_SIZE "THREAD_POOL_SIZE"
+#define SPGWU_CONFIG_STRING_BATCHING "BATCHING"
+#define SPGWU_CONFIG_STRING_BATCHING_ENABLE "ENABLE"
+#define SPGWU_CONFIG_STRING_RX_BATCH_SIZE "RX_BATCH_SIZE"
+#define SPGWU_CONFIG_STRING_TX_BATCH_SIZE "TX_BATCH_SIZE"
+#define SPGWU_CONFIG_STRING_UDP_GSO "UDP_GSO"
+#define SPGWU_CONFIG_STRING_TUN_MULTI_QUEUE "TUN_MULTI_QUEUE"
 #define SPGWU_CONFIG_STRING_INTERFACE_SGI "SGI"
 #define SPGWU_CONFIG_STRING_INTERFACE_SX "SX"
 #define SPGWU_CONFIG_STRING_INTERFACE_S1U_S12_S4_UP "S1U_S12_S4_UP"
@@ -131,6 +137,8 @@ class spgwu_config {
  private:
   int load_itti(const libconfig::Setting& itti_cfg, itti_cfg_t& cfg);
   int load_interface(const libconfig::Setting& if_cfg, interface_cfg_t& cfg);
+  int load_batching(
+      const libconfig::Setting& batching_cfg, udp_batch_params_t& cfg);
   int load_thread_sched_params(
       const libconfig::Setting& thread_sched_params_cfg,
       util::thread_sched_params& cfg);
@@ -142,7 +150,9 @@ class spgwu_config {
   unsigned int instance;
   std::string fqdn;
   interface_cfg_t s1_up;
+  udp_batch_params_t s1_up_batching;
   interface_cfg_t sgi;
+  bool sgi_tun_multi_queue;  // one tun queue per SGi thread
   interface_cfg_t sx;
   itti_cfg_t itti;
   nsf_cfg_t nsf;
@@ -175,7 +185,9 @@ class spgwu_config {
         instance(0),
         fqdn(),
         s1_up(),
+        s1_up_batching(),
         sgi(),
+        sgi_tun_multi_queue(false),
         gateway(),
         sx(),
         itti(),
@@ -193,6 +205,10 @@ class spgwu_config {
     s1_up.thread_rd_sched_params.sched_priority = 98;
     s1_up.port                                  = gtpv1u::default_port;
 
+    s1_up_batching.rx_batch_size = 1;
+    s1_up_batching.tx_batch_size = 1;
+    s1_up_batching.gso           = false;
+
     sgi.thread_rd_sched_params.sched_priority = 98;
 
     sx.thread_rd_sched_params.sched_priority = 95;
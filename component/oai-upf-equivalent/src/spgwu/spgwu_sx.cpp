@@ -408,10 +408,17 @@ void spgwu_sx::handle_receive_association_setup_request(
 //------------------------------------------------------------------------------
 void spgwu_sx::handle_receive_session_establishment_request(
     pfcp_msg& msg, const endpoint& remote_endpoint) {
-  bool error                                           = true;
-  uint64_t trxn_id                                     = 0;
   pfcp_session_establishment_request msg_ies_container = {};
   msg.to_core_type(msg_ies_container);
+  handle_receive_session_establishment_request(
+      msg, msg_ies_container, remote_endpoint);
+}
+//------------------------------------------------------------------------------
+void spgwu_sx::handle_receive_session_establishment_request(
+    pfcp_msg& msg, const pfcp_session_establishment_request& msg_ies_container,
+    const endpoint& remote_endpoint) {
+  bool error       = true;
+  uint64_t trxn_id = 0;
 
   handle_receive_message_cb(
       msg, remote_endpoint, TASK_SPGWU_SX, error, trxn_id);
@@ -437,10 +444,17 @@ void spgwu_sx::handle_receive_session_establishment_request(
 //------------------------------------------------------------------------------
 void spgwu_sx::handle_receive_session_modification_request(
     pfcp_msg& msg, const endpoint& remote_endpoint) {
-  bool error                                          = true;
-  uint64_t trxn_id                                    = 0;
   pfcp_session_modification_request msg_ies_container = {};
   msg.to_core_type(msg_ies_container);
+  handle_receive_session_modification_request(
+      msg, msg_ies_container, remote_endpoint);
+}
+//------------------------------------------------------------------------------
+void spgwu_sx::handle_receive_session_modification_request(
+    pfcp_msg& msg, const pfcp_session_modification_request& msg_ies_container,
+    const endpoint& remote_endpoint) {
+  bool error       = true;
+  uint64_t trxn_id = 0;
 
   handle_receive_message_cb(
       msg, remote_endpoint, TASK_SPGWU_SX, error, trxn_id);
@@ -713,6 +727,12 @@ void spgwu_sx::handle_receive(
   pfcp_msg msg    = {};
   msg.remote_port = remote_endpoint.port();
   try {
+    if (handle_receive_session_request(
+            pfcp::byte_span(
+                reinterpret_cast<const uint8_t*>(recv_buffer),
+                bytes_transferred),
+            remote_endpoint))
+      return;
     msg.load_from(iss);
     handle_receive_pfcp_msg(msg, remote_endpoint);
   } catch (pfcp_exception& e) {
@@ -720,6 +740,33 @@ void spgwu_sx::handle_receive(
   }
 }
 //------------------------------------------------------------------------------
+bool spgwu_sx::handle_receive_session_request(
+    const pfcp::byte_span& b, const endpoint& remote_endpoint) {
+  pfcp_msg_header hdr = {};
+  if (!pfcp::decode(b, hdr)) return false;
+  switch (hdr.get_message_type()) {
+    case PFCP_SESSION_ESTABLISHMENT_REQUEST: {
+      pfcp_session_establishment_request msg_ies_container = {};
+      if (!pfcp::decode(b, hdr, msg_ies_container)) return false;
+      pfcp_msg msg(hdr);
+      msg.remote_port = remote_endpoint.port();
+      handle_receive_session_establishment_request(
+          msg, msg_ies_container, remote_endpoint);
+    } break;
+    case PFCP_SESSION_MODIFICATION_REQUEST: {
+      pfcp_session_modification_request msg_ies_container = {};
+      if (!pfcp::decode(b, hdr, msg_ies_container)) return false;
+      pfcp_msg msg(hdr);
+      msg.remote_port = remote_endpoint.port();
+      handle_receive_session_modification_request(
+          msg, msg_ies_container, remote_endpoint);
+    } break;
+    default:
+      return false;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
 void spgwu_sx::time_out_itti_event(const uint32_t timer_id) {
   bool handled = false;
   time_out_event(timer_id, TASK_SPGWU_SX, handled);
@@ -102,6 +102,10 @@ class spgwu_sx : public pfcp::pfcp_l4_stack {
   void handle_receive(
       char* recv_buffer, const std::size_t bytes_transferred,
       const endpoint& remote_endpoint);
+  // Session Establishment/Modification Request decoded by the PFCP codec,
+  // false if not handled by the codec (then decoded by pfcp_msg)
+  bool handle_receive_session_request(
+      const pfcp::byte_span& b, const endpoint& remote_endpoint);
   // node related
   void handle_receive_heartbeat_request(
       pfcp::pfcp_msg& msg, const endpoint& remote_endpoint);
@@ -114,8 +118,16 @@ class spgwu_sx : public pfcp::pfcp_l4_stack {
   // session related
   void handle_receive_session_establishment_request(
       pfcp::pfcp_msg& msg, const endpoint& remote_endpoint);
+  void handle_receive_session_establishment_request(
+      pfcp::pfcp_msg& msg,
+      const pfcp::pfcp_session_establishment_request& msg_ies_container,
+      const endpoint& remote_endpoint);
   void handle_receive_session_modification_request(
       pfcp::pfcp_msg& msg, const endpoint& remote_endpoint);
+  void handle_receive_session_modification_request(
+      pfcp::pfcp_msg& msg,
+      const pfcp::pfcp_session_modification_request& msg_ies_container,
+      const endpoint& remote_endpoint);
   void handle_receive_session_deletion_request(
       pfcp::pfcp_msg& msg, const endpoint& remote_endpoint);
   void handle_receive_session_report_response(
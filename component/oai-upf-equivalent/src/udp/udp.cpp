@@ -28,7 +28,16 @@
 
 #include "udp.hpp"
 
+#include <algorithm>
 #include <cstdlib>
+#include <netinet/udp.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+// Pending transmissions of the calling thread, see begin_send_batch()
+static thread_local udp_tx_batch_t tx_batch = {};
 
 //------------------------------------------------------------------------------
 void udp_application::handle_receive(
@@ -62,12 +71,31 @@ void udp_server::udp_worker_loop(
     const int id, const util::thread_sched_params& sched_params) {
   uint64_t count              = 0;
   udp_packet_q_item_t* worker = nullptr;
+  udp_packet_q_item_t* done[UDP_MAX_BATCH_SIZE];
 
   sched_params.apply(TASK_NONE, Logger::udp());
   while (1) {
     work_pool_->blockingRead(worker);
     ++count;
     // std::cout << "w" << id << " " << count << std::endl;
+    if (worker->buffer && (batch_params_.tx_batch_size > 1)) {
+      // Handle what is already queued, transmissions triggered by these
+      // packets leave in one batch, then give back the buffers.
+      unsigned int num_done = 0;
+      begin_send_batch();
+      do {
+        if (worker->buffer == nullptr) break;
+        app_->handle_receive(worker->buffer, worker->size, worker->r_endpoint);
+        done[num_done++] = worker;
+        worker           = nullptr;
+      } while ((num_done < batch_params_.tx_batch_size) &&
+               work_pool_->readIfNotEmpty(worker));
+      flush_send_batch();
+      for (unsigned int i = 0; i < num_done; i++) {
+        free_pool_->write(done[i]);
+      }
+      if (worker == nullptr) continue;
+    }
     // exit thread
     if (worker->buffer) {
       app_->handle_receive(worker->buffer, worker->size, worker->r_endpoint);
@@ -119,6 +147,67 @@ void udp_server::udp_read_loop(const util::thread_sched_params& sched_params) {
   }
 }
 //------------------------------------------------------------------------------
+void udp_server::udp_read_batch_loop(
+    const util::thread_sched_params& sched_params) {
+  udp_packet_q_item_t* items[UDP_MAX_BATCH_SIZE];
+  struct mmsghdr msgs[UDP_MAX_BATCH_SIZE];
+  struct iovec iovs[UDP_MAX_BATCH_SIZE];
+  unsigned int num_items = 0;
+  bool exit_requested    = false;
+
+  sched_params.apply(TASK_NONE, Logger::udp());
+
+  while (1) {
+    // At least one buffer, then as many free buffers as available
+    if (num_items == 0) {
+      free_pool_->blockingRead(items[num_items++]);
+    }
+    while ((num_items < batch_params_.rx_batch_size) &&
+           free_pool_->readIfNotEmpty(items[num_items])) {
+      num_items++;
+    }
+    // exit thread
+    for (unsigned int i = 0; i < num_items; i++) {
+      if (items[i]->buffer == nullptr) exit_requested = true;
+    }
+    if (exit_requested) {
+      for (unsigned int i = 0; i < num_items; i++) {
+        free(items[i]);
+      }
+      udp_packet_q_item_t* worker = nullptr;
+      while (work_pool_->readIfNotEmpty(worker)) {
+        free(worker);
+      }
+      return;
+    }
+
+    for (unsigned int i = 0; i < num_items; i++) {
+      iovs[i].iov_base            = items[i]->buffer;
+      iovs[i].iov_len             = UDP_RECV_BUFFER_SIZE;
+      msgs[i]                     = {};
+      msgs[i].msg_hdr.msg_name    = &items[i]->r_endpoint.addr_storage;
+      msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+      msgs[i].msg_hdr.msg_iov     = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen  = 1;
+    }
+    int num_msgs = recvmmsg(socket_, msgs, num_items, MSG_WAITFORONE, nullptr);
+    if (num_msgs > 0) {
+      for (int i = 0; i < num_msgs; i++) {
+        items[i]->size                        = msgs[i].msg_len;
+        items[i]->r_endpoint.addr_storage_len = msgs[i].msg_hdr.msg_namelen;
+        work_pool_->blockingWrite(items[i]);
+      }
+      // Keep the unused buffers for the next call
+      std::copy(items + num_msgs, items + num_items, items);
+      num_items -= num_msgs;
+      rx_batches_.fetch_add(1, std::memory_order_relaxed);
+      rx_packets_.fetch_add(num_msgs, std::memory_order_relaxed);
+    } else {
+      Logger::udp().error("Recvmmsg failed %s\n", strerror(errno));
+    }
+  }
+}
+//------------------------------------------------------------------------------
 int udp_server::create_socket(
     const struct in_addr& address, const uint16_t port) {
   struct sockaddr_in addr = {};
@@ -230,6 +319,13 @@ void udp_server::start_receive(
   int num_blocks = num_threads_ * 16;
   app_           = app;
   Logger::udp().trace("udp_server::start_receive");
+  // Room for the reader batch plus one TX batch held by each worker
+  if (batch_params_.rx_batch_size > 1) {
+    num_blocks += batch_params_.rx_batch_size;
+  }
+  if (batch_params_.tx_batch_size > 1) {
+    num_blocks += num_threads_ * batch_params_.tx_batch_size;
+  }
   free_pool_         = new folly::MPMCQueue<udp_packet_q_item_t*>(num_blocks);
   work_pool_         = new folly::MPMCQueue<udp_packet_q_item_t*>(num_blocks);
   recv_buffer_alloc_ = (char*) calloc(num_blocks, UDP_RECV_BUFFER_SIZE);
@@ -246,11 +342,173 @@ void udp_server::start_receive(
         std::thread(&udp_server::udp_worker_loop, this, i, sched_params);
     threads_.push_back(std::move(t));
   }
-  std::thread t = std::thread(&udp_server::udp_read_loop, this, sched_params);
+  std::thread t;
+  if (batch_params_.rx_batch_size > 1) {
+    t = std::thread(&udp_server::udp_read_batch_loop, this, sched_params);
+  } else {
+    t = std::thread(&udp_server::udp_read_loop, this, sched_params);
+  }
   t.detach();
   threads_.push_back(std::move(t));
 }
 //------------------------------------------------------------------------------
+void udp_server::set_batch_params(const udp_batch_params_t& batch_params) {
+  batch_params_ = batch_params;
+  batch_params_.rx_batch_size =
+      std::min(batch_params_.rx_batch_size, (unsigned int) UDP_MAX_BATCH_SIZE);
+  batch_params_.tx_batch_size =
+      std::min(batch_params_.tx_batch_size, (unsigned int) UDP_MAX_BATCH_SIZE);
+  if (batch_params_.gso) {
+    int gso_size = 0;
+    if (setsockopt(
+            socket_, SOL_UDP, UDP_SEGMENT, &gso_size, sizeof(gso_size)) < 0) {
+      Logger::udp().warn(
+          "UDP GSO not supported (%s), using sendmmsg only", strerror(errno));
+      batch_params_.gso = false;
+    }
+  }
+  Logger::udp().info(
+      "UDP batching RX %u TX %u GSO %s", batch_params_.rx_batch_size,
+      batch_params_.tx_batch_size, (batch_params_.gso) ? "yes" : "no");
+}
+//------------------------------------------------------------------------------
+udp_batch_stats_t udp_server::get_batch_stats() const {
+  udp_batch_stats_t stats = {};
+  stats.rx_batches        = rx_batches_.load(std::memory_order_relaxed);
+  stats.rx_packets        = rx_packets_.load(std::memory_order_relaxed);
+  stats.tx_batches        = tx_batches_.load(std::memory_order_relaxed);
+  stats.tx_packets        = tx_packets_.load(std::memory_order_relaxed);
+  stats.tx_gso_batches    = tx_gso_batches_.load(std::memory_order_relaxed);
+  stats.tx_errors         = tx_errors_.load(std::memory_order_relaxed);
+  return stats;
+}
+//------------------------------------------------------------------------------
+void udp_server::begin_send_batch() {
+  if (batch_params_.tx_batch_size <= 1) return;
+  if ((tx_batch.server) && (tx_batch.server != this)) {
+    tx_batch.server->flush_send_batch();
+  }
+  tx_batch.server = this;
+}
+//------------------------------------------------------------------------------
+void udp_server::flush_send_batch() {
+  if (tx_batch.server != this) return;
+  send_batch(tx_batch);
+  tx_batch.server = nullptr;
+}
+//------------------------------------------------------------------------------
+bool udp_server::queue_send_to(
+    const char* header, const std::size_t header_len,
+    const char* send_buffer, const ssize_t num_bytes,
+    const struct sockaddr* r_addr, const socklen_t r_addr_len) {
+  if (tx_batch.server != this) return false;
+  if (tx_batch.count == batch_params_.tx_batch_size) {
+    send_batch(tx_batch);
+  }
+  unsigned int i = tx_batch.count++;
+  memcpy(&tx_batch.addrs[i], r_addr, r_addr_len);
+  // the caller's header may be on its stack
+  if (header_len) memcpy(tx_batch.headers[i], header, header_len);
+  struct iovec* iov                    = &tx_batch.iovs[2 * i];
+  iov[0].iov_base                      = tx_batch.headers[i];
+  iov[0].iov_len                       = header_len;
+  iov[1].iov_base                      = (void*) send_buffer;
+  iov[1].iov_len                       = num_bytes;
+  tx_batch.msgs[i]                     = {};
+  tx_batch.msgs[i].msg_hdr.msg_name    = &tx_batch.addrs[i];
+  tx_batch.msgs[i].msg_hdr.msg_namelen = r_addr_len;
+  tx_batch.msgs[i].msg_hdr.msg_iov     = iov;
+  tx_batch.msgs[i].msg_hdr.msg_iovlen  = 2;
+  return true;
+}
+//------------------------------------------------------------------------------
+void udp_server::async_send_to(
+    const char* header, const std::size_t header_len, const char* payload,
+    const ssize_t payload_len, const struct sockaddr* r_addr,
+    const socklen_t r_addr_len) {
+  if (queue_send_to(
+          header, header_len, payload, payload_len, r_addr, r_addr_len))
+    return;
+  struct iovec iov[2];
+  iov[0].iov_base   = (void*) header;
+  iov[0].iov_len    = header_len;
+  iov[1].iov_base   = (void*) payload;
+  iov[1].iov_len    = payload_len;
+  struct msghdr msg = {};
+  msg.msg_name      = (void*) r_addr;
+  msg.msg_namelen   = r_addr_len;
+  msg.msg_iov       = iov;
+  msg.msg_iovlen    = 2;
+  ssize_t bytes_written = sendmsg(socket_, &msg, 0);
+  if (bytes_written != (ssize_t)(header_len + payload_len)) {
+    Logger::udp().error("sendmsg failed(%d:%s)\n", errno, strerror(errno));
+  }
+}
+//------------------------------------------------------------------------------
+void udp_server::send_batch(udp_tx_batch_t& batch) {
+  if (batch.count == 0) return;
+  if (!(batch_params_.gso && send_batch_gso(batch))) {
+    unsigned int sent = 0;
+    while (sent < batch.count) {
+      int rc = sendmmsg(socket_, &batch.msgs[sent], batch.count - sent, 0);
+      if (rc <= 0) {
+        Logger::udp().error("sendmmsg failed(%d:%s)\n", errno, strerror(errno));
+        tx_errors_.fetch_add(batch.count - sent, std::memory_order_relaxed);
+        break;
+      }
+      sent += rc;
+    }
+    tx_batches_.fetch_add(1, std::memory_order_relaxed);
+    tx_packets_.fetch_add(sent, std::memory_order_relaxed);
+  }
+  batch.count = 0;
+}
+//------------------------------------------------------------------------------
+bool udp_server::send_batch_gso(udp_tx_batch_t& batch) {
+  // One destination, same size segments (last one may be shorter)
+  if (batch.count < 2) return false;
+  // The kernel cuts the concatenated iovecs in gso_size segments
+  const size_t gso_size    = batch.iovs[0].iov_len + batch.iovs[1].iov_len;
+  const socklen_t addr_len = batch.msgs[0].msg_hdr.msg_namelen;
+  size_t total_len         = 0;
+  for (unsigned int i = 0; i < batch.count; i++) {
+    const size_t len =
+        batch.iovs[2 * i].iov_len + batch.iovs[2 * i + 1].iov_len;
+    if ((batch.msgs[i].msg_hdr.msg_namelen != addr_len) ||
+        memcmp(&batch.addrs[i], &batch.addrs[0], addr_len))
+      return false;
+    if ((len > gso_size) || ((len != gso_size) && (i != batch.count - 1)))
+      return false;
+    total_len += len;
+  }
+  if (total_len > 65000) return false;
+
+  char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+
+  struct msghdr msg  = {};
+  msg.msg_name       = &batch.addrs[0];
+  msg.msg_namelen    = addr_len;
+  msg.msg_iov        = batch.iovs;
+  msg.msg_iovlen     = 2 * batch.count;
+  msg.msg_control    = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+  cm->cmsg_level     = SOL_UDP;
+  cm->cmsg_type      = UDP_SEGMENT;
+  cm->cmsg_len       = CMSG_LEN(sizeof(uint16_t));
+  *((uint16_t*) CMSG_DATA(cm)) = gso_size;
+
+  if (sendmsg(socket_, &msg, 0) != (ssize_t) total_len) {
+    // Let sendmmsg() do the job
+    return false;
+  }
+  tx_batches_.fetch_add(1, std::memory_order_relaxed);
+  tx_gso_batches_.fetch_add(1, std::memory_order_relaxed);
+  tx_packets_.fetch_add(batch.count, std::memory_order_relaxed);
+  return true;
+}
+//------------------------------------------------------------------------------
 void udp_server::stop(void) {
   for (int i = 0; i < num_threads_; i++) {
     udp_packet_q_item_t* p =
@@ -38,6 +38,7 @@
 #include <inttypes.h>
 #include <sys/socket.h>
 
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -65,6 +66,38 @@ typedef struct udp_packet_q_item_s {
   size_t size;
 } udp_packet_q_item_t;
 
+#define UDP_MAX_BATCH_SIZE 64
+// Tunnel header sent in front of a payload, see async_send_to()
+#define UDP_MAX_HEADER_LEN 16
+
+// Batch sizes of 1 (or 0) keep the one syscall per datagram behaviour
+typedef struct udp_batch_params_s {
+  unsigned int rx_batch_size;  // datagrams per recvmmsg()
+  unsigned int tx_batch_size;  // datagrams per sendmmsg()
+  bool gso;  // use UDP_SEGMENT when a TX batch qualifies
+} udp_batch_params_t;
+
+typedef struct udp_batch_stats_s {
+  uint64_t rx_batches;
+  uint64_t rx_packets;
+  uint64_t tx_batches;
+  uint64_t tx_packets;
+  uint64_t tx_gso_batches;
+  uint64_t tx_errors;
+} udp_batch_stats_t;
+
+// Datagrams queued by one thread between begin_send_batch() and
+// flush_send_batch(), payloads are referenced, not copied
+typedef struct udp_tx_batch_s {
+  udp_server* server;
+  unsigned int count;
+  struct mmsghdr msgs[UDP_MAX_BATCH_SIZE];
+  // header, payload of each datagram (header may be empty)
+  struct iovec iovs[2 * UDP_MAX_BATCH_SIZE];
+  struct sockaddr_storage addrs[UDP_MAX_BATCH_SIZE];
+  alignas(16) char headers[UDP_MAX_BATCH_SIZE][UDP_MAX_HEADER_LEN];
+} udp_tx_batch_t;
+
 class udp_server {
 #define UDP_RECV_BUFFER_SIZE 8192
  public:
@@ -73,7 +106,14 @@ class udp_server {
         port_(port_num),
         num_threads_(1),
         free_pool_(nullptr),
-        work_pool_(nullptr) {
+        work_pool_(nullptr),
+        batch_params_(),
+        rx_batches_(0),
+        rx_packets_(0),
+        tx_batches_(0),
+        tx_packets_(0),
+        tx_gso_batches_(0),
+        tx_errors_(0) {
     socket_ = create_socket(address, port_);
     if (socket_ > 0) {
       Logger::udp().debug(
@@ -93,8 +133,16 @@ class udp_server {
   udp_server(const struct in6_addr& address, const uint16_t port_num)
       : app_(nullptr),
         port_(port_num),
+        num_threads_(1),
         free_pool_(nullptr),
-        work_pool_(nullptr) {
+        work_pool_(nullptr),
+        batch_params_(),
+        rx_batches_(0),
+        rx_packets_(0),
+        tx_batches_(0),
+        tx_packets_(0),
+        tx_gso_batches_(0),
+        tx_errors_(0) {
     socket_ = create_socket(address, port_);
     if (socket_ > 0) {
       Logger::udp().debug(
@@ -114,8 +162,16 @@ class udp_server {
   udp_server(const char* address, const uint16_t port_num)
       : app_(nullptr),
         port_(port_num),
+        num_threads_(1),
         free_pool_(nullptr),
-        work_pool_(nullptr) {
+        work_pool_(nullptr),
+        batch_params_(),
+        rx_batches_(0),
+        rx_packets_(0),
+        tx_batches_(0),
+        tx_packets_(0),
+        tx_gso_batches_(0),
+        tx_errors_(0) {
     socket_ = create_socket(address, port_);
     if (socket_ > 0) {
       Logger::udp().debug("udp_server::udp_server(%s:%d)", address, port_);
@@ -137,12 +193,27 @@ class udp_server {
   }
 
   void udp_read_loop(const util::thread_sched_params& thread_sched_params);
+  void udp_read_batch_loop(const util::thread_sched_params& sched_params);
   void udp_worker_loop(
       const int id, const util::thread_sched_params& sched_params);
 
+  // Must be called before start_receive()
+  void set_batch_params(const udp_batch_params_t& batch_params);
+  udp_batch_stats_t get_batch_stats() const;
+
+  // Until flush_send_batch(), async_send_to() calls of the calling thread are
+  // queued and the send buffers must remain valid.
+  void begin_send_batch();
+  void flush_send_batch();
+
   void async_send_to(
       const char* send_buffer, const ssize_t num_bytes,
       const endpoint& r_endpoint) {
+    if (queue_send_to(
+            nullptr, 0, send_buffer, num_bytes,
+            (const struct sockaddr*) &r_endpoint.addr_storage,
+            r_endpoint.addr_storage_len))
+      return;
     ssize_t bytes_written = sendto(
         socket_, send_buffer, num_bytes, 0,
         (struct sockaddr*) &r_endpoint.addr_storage,
@@ -155,6 +226,10 @@ class udp_server {
   void async_send_to(
       const char* send_buffer, const ssize_t num_bytes,
       const struct sockaddr_in& r_endpoint) {
+    if (queue_send_to(
+            nullptr, 0, send_buffer, num_bytes,
+            (const struct sockaddr*) &r_endpoint, sizeof(struct sockaddr_in)))
+      return;
     ssize_t bytes_written = sendto(
         socket_, send_buffer, num_bytes, 0, (struct sockaddr*) &r_endpoint,
         sizeof(struct sockaddr_in));
@@ -166,6 +241,10 @@ class udp_server {
   void async_send_to(
       const char* send_buffer, const ssize_t num_bytes,
       const struct sockaddr_in6& r_endpoint) {
+    if (queue_send_to(
+            nullptr, 0, send_buffer, num_bytes,
+            (const struct sockaddr*) &r_endpoint, sizeof(struct sockaddr_in6)))
+      return;
     ssize_t bytes_written = sendto(
         socket_, send_buffer, num_bytes, 0, (struct sockaddr*) &r_endpoint,
         sizeof(struct sockaddr_in6));
@@ -174,6 +253,13 @@ class udp_server {
     }
   }
 
+  // Scatter-gather: the header (at most UDP_MAX_HEADER_LEN bytes) is copied,
+  // the payload is sent in place and never written.
+  void async_send_to(
+      const char* header, const std::size_t header_len, const char* payload,
+      const ssize_t payload_len, const struct sockaddr* r_addr,
+      const socklen_t r_addr_len);
+
   void start_receive(
       udp_application* gtp_stack,
       const util::thread_sched_params& sched_params);
@@ -186,6 +272,13 @@ class udp_server {
 
   // void handle_receive(const int& error, std::size_t bytes_transferred);
 
+  bool queue_send_to(
+      const char* header, const std::size_t header_len,
+      const char* send_buffer, const ssize_t num_bytes,
+      const struct sockaddr* r_addr, const socklen_t r_addr_len);
+  void send_batch(udp_tx_batch_t& batch);
+  bool send_batch_gso(udp_tx_batch_t& batch);
+
   static void handle_send(
       const char*, /*buffer*/
       const int& /*error*/, std::size_t /*bytes_transferred*/) {}
@@ -201,6 +294,14 @@ class udp_server {
   int socket_;
   uint16_t port_;
   sa_family_t sa_family;
+
+  udp_batch_params_t batch_params_;
+  std::atomic<uint64_t> rx_batches_;
+  std::atomic<uint64_t> rx_packets_;
+  std::atomic<uint64_t> tx_batches_;
+  std::atomic<uint64_t> tx_packets_;
+  std::atomic<uint64_t> tx_gso_batches_;
+  std::atomic<uint64_t> tx_errors_;
 };
 
 #endif /* FILE_UDP_HPP_SEEN */
@@ -0,0 +1,186 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file gtpu_encap_bench.cpp
+ \brief Micro-benchmark of the G-PDU encapsulation, per packet header build
+        versus precomputed template
+ \date 2021
+ */
+
+#include <arpa/inet.h>
+#include <sys/uio.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "gtpu.h"
+#include "gtpu_template.hpp"
+
+#define BENCH_NUM_PACKETS 50000000
+// Enough packet buffers not to stay in L1, like a RX ring
+#define BENCH_NUM_BUFFERS 1024
+#define BENCH_BUFFER_SIZE 2048
+#define BENCH_HEADROOM 64
+
+using namespace gtpv1u;
+
+// What is handed to sendmmsg()
+typedef struct bench_datagram_s {
+  struct sockaddr_in addr;
+  struct iovec iov[2];
+  alignas(16) uint8_t header[GTPU_G_PDU_TEMPLATE_MAX_LEN];
+} bench_datagram_t;
+
+//------------------------------------------------------------------------------
+// Previous path: sockaddr and header rebuilt field by field, header written in
+// the headroom of the payload buffer
+static void legacy_encap(
+    bench_datagram_t& d, const struct in_addr& peer_addr, const teid_t teid,
+    char* payload, const uint16_t payload_len, const bool ext_hdr,
+    const uint8_t qfi) {
+  d.addr.sin_family = AF_INET;
+  d.addr.sin_addr   = peer_addr;
+  d.addr.sin_port   = htobe16(2152);
+  if (!ext_hdr) {
+    struct gtpuhdr* gtpuhdr = reinterpret_cast<struct gtpuhdr*>(
+        payload - sizeof(struct gtpuhdr) + 4);
+    gtpuhdr->spare          = 0;
+    gtpuhdr->e              = 0;
+    gtpuhdr->s              = 0;
+    gtpuhdr->pn             = 0;
+    gtpuhdr->pt             = 1;
+    gtpuhdr->version        = 1;
+    gtpuhdr->message_type   = GTPU_G_PDU;
+    gtpuhdr->message_length = htobe16(payload_len);
+    gtpuhdr->teid           = htobe32(teid);
+    d.iov[0].iov_base       = gtpuhdr;
+    d.iov[0].iov_len        = payload_len + sizeof(struct gtpuhdr) - 4;
+  } else {
+    struct gtpuhdr* gtpuhdr = reinterpret_cast<struct gtpuhdr*>(
+        payload - sizeof(struct gtpuhdr) -
+        sizeof(struct gtpu_extn_pdu_session_container));
+    gtpuhdr->spare          = 0;
+    gtpuhdr->e              = 1;
+    gtpuhdr->s              = 0;
+    gtpuhdr->pn             = 0;
+    gtpuhdr->pt             = 1;
+    gtpuhdr->version        = 1;
+    gtpuhdr->message_type   = GTPU_G_PDU;
+    gtpuhdr->message_length = htobe16(
+        payload_len + sizeof(struct gtpu_extn_pdu_session_container) + 4);
+    gtpuhdr->teid          = htobe32(teid);
+    gtpuhdr->pdu_number    = 0x00;
+    gtpuhdr->sequence      = 0x00;
+    gtpuhdr->next_ext_type = GTPU_PDU_SESSION_CONTAINER;
+
+    struct gtpu_extn_pdu_session_container* gtpu_ext_hdr =
+        reinterpret_cast<struct gtpu_extn_pdu_session_container*>(
+            payload - sizeof(struct gtpu_extn_pdu_session_container));
+    gtpu_ext_hdr->message_length = 0x01;
+    gtpu_ext_hdr->pdu_type       = GTPU_DL_PDU_SESSION_INFORMATION;
+    gtpu_ext_hdr->qfi            = qfi;
+    gtpu_ext_hdr->next_ext_type  = GTPU_NO_MORE_EXTENSION_HEADER;
+    d.iov[0].iov_base            = gtpuhdr;
+    d.iov[0].iov_len             = payload_len + sizeof(struct gtpuhdr) +
+                        sizeof(struct gtpu_extn_pdu_session_container);
+  }
+  d.iov[1].iov_len = 0;
+}
+
+//------------------------------------------------------------------------------
+// Template path: header stored next to the sendmmsg() vectors, payload only
+// referenced
+static inline void template_encap(
+    bench_datagram_t& d, const gtpu_g_pdu_template_t& t, char* payload,
+    const uint16_t payload_len) {
+  d.iov[0].iov_base = d.header;
+  d.iov[0].iov_len  = gtpu_g_pdu_encap(t, d.header, payload_len);
+  d.iov[1].iov_base = payload;
+  d.iov[1].iov_len  = payload_len;
+}
+
+//------------------------------------------------------------------------------
+static void report(const char* name, const double s) {
+  std::cout << "  " << name << ": " << (BENCH_NUM_PACKETS / s) / 1e6
+            << " M encapsulations/s, " << (s * 1e9) / BENCH_NUM_PACKETS
+            << " ns/packet" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+static void bench(const bool ext_hdr) {
+  std::vector<char> buffers(BENCH_NUM_BUFFERS * BENCH_BUFFER_SIZE, 0x45);
+  std::vector<bench_datagram_t> batch(64);
+  struct in_addr peer_addr = {};
+  inet_pton(AF_INET, "192.168.70.140", &peer_addr);
+  const teid_t teid = 0x12345678;
+  const uint8_t qfi = 9;
+
+  gtpu_g_pdu_template_t t = {};
+  gtpu_g_pdu_template_init(t, peer_addr, 2152, teid, ext_hdr, qfi);
+
+  // Both paths must produce the same datagram
+  char* payload = &buffers[BENCH_HEADROOM];
+  legacy_encap(batch[0], peer_addr, teid, payload, 100, ext_hdr, qfi);
+  template_encap(batch[1], t, payload, 100);
+  if ((batch[1].iov[0].iov_len + 100 != batch[0].iov[0].iov_len) ||
+      memcmp(
+          batch[0].iov[0].iov_base, batch[1].header,
+          batch[1].iov[0].iov_len)) {
+    std::cerr << "Template header differs from the legacy one" << std::endl;
+    return;
+  }
+
+  std::cout << (ext_hdr ? "with" : "without")
+            << " PDU session container:" << std::endl;
+  uint64_t sum = 0;
+  auto start   = std::chrono::steady_clock::now();
+  for (int n = 0; n < BENCH_NUM_PACKETS; n++) {
+    char* p = &buffers[(n % BENCH_NUM_BUFFERS) * BENCH_BUFFER_SIZE +
+                       BENCH_HEADROOM];
+    bench_datagram_t& d = batch[n & 63];
+    legacy_encap(d, peer_addr, teid, p, 64 + (n & 1023), ext_hdr, qfi);
+    sum += d.iov[0].iov_len;
+    asm volatile("" : : "r"(sum) : "memory");
+  }
+  auto end = std::chrono::steady_clock::now();
+  report("legacy  ", std::chrono::duration<double>(end - start).count());
+
+  start = std::chrono::steady_clock::now();
+  for (int n = 0; n < BENCH_NUM_PACKETS; n++) {
+    char* p = &buffers[(n % BENCH_NUM_BUFFERS) * BENCH_BUFFER_SIZE +
+                       BENCH_HEADROOM];
+    bench_datagram_t& d = batch[n & 63];
+    template_encap(d, t, p, 64 + (n & 1023));
+    sum += d.iov[0].iov_len;
+    asm volatile("" : : "r"(sum) : "memory");
+  }
+  end = std::chrono::steady_clock::now();
+  report("template", std::chrono::duration<double>(end - start).count());
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  bench(false);
+  bench(true);
+  return 0;
+}
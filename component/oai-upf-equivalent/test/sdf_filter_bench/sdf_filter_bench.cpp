@@ -0,0 +1,104 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the OAI Public License, Version 1.1  (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the
+ * License at
+ *
+ *      http://www.openairinterface.org/?page_id=698
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file sdf_filter_bench.cpp
+ \brief Micro-benchmark of the compiled SDF filter matching
+ \date 2021
+ */
+
+#include <arpa/inet.h>
+#include <linux/udp.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "pfcp_sdf_filter.hpp"
+
+#define BENCH_NUM_PACKETS 10000000
+
+//------------------------------------------------------------------------------
+static void build_packet(
+    uint8_t* buf, const char* src, const char* dst, const uint16_t sport,
+    const uint16_t dport) {
+  struct iphdr* iph  = (struct iphdr*) buf;
+  struct udphdr* udp = (struct udphdr*) (buf + sizeof(struct iphdr));
+  memset(buf, 0, sizeof(struct iphdr) + sizeof(struct udphdr));
+  iph->version  = 4;
+  iph->ihl      = 5;
+  iph->protocol = IPPROTO_UDP;
+  iph->tot_len  = htons(sizeof(struct iphdr) + sizeof(struct udphdr));
+  inet_pton(AF_INET, src, &iph->saddr);
+  inet_pton(AF_INET, dst, &iph->daddr);
+  udp->source = htons(sport);
+  udp->dest   = htons(dport);
+}
+
+//------------------------------------------------------------------------------
+// Walk the filters in precedence order like the PDR lookup does, the packet
+// only matches the last one (worst case).
+static void bench(const int num_filters) {
+  std::vector<pfcp::pfcp_sdf_filter> filters(num_filters);
+  for (int i = 0; i < num_filters; i++) {
+    std::string fd = "permit out 17 from 10.0." + std::to_string(i / 250) +
+                     "." + std::to_string(i % 250 + 1) +
+                     "/32 5000-5010,6000 to assigned 1024-65535";
+    if (not filters[i].compile(fd)) {
+      std::cerr << "Could not compile " << fd << std::endl;
+      return;
+    }
+  }
+  const int last = num_filters - 1;
+  std::string remote = "10.0." + std::to_string(last / 250) + "." +
+                       std::to_string(last % 250 + 1);
+  uint8_t dl[64];
+  uint8_t ul[64];
+  build_packet(dl, remote.c_str(), "12.1.1.2", 6000, 40000);
+  build_packet(ul, "12.1.1.2", remote.c_str(), 40000, 5005);
+
+  uint64_t hits = 0;
+  auto start    = std::chrono::steady_clock::now();
+  for (int n = 0; n < BENCH_NUM_PACKETS; n++) {
+    const struct iphdr* iph = (const struct iphdr*) ((n & 1) ? ul : dl);
+    for (const auto& f : filters) {
+      if ((n & 1) ? f.match_ul(iph, 28) : f.match_dl(iph, 28)) {
+        hits++;
+        break;
+      }
+    }
+    asm volatile("" : : "r"(hits) : "memory");
+  }
+  auto end = std::chrono::steady_clock::now();
+  double s = std::chrono::duration<double>(end - start).count();
+  std::cout << "filters " << num_filters << ": " << hits << " hits, "
+            << (BENCH_NUM_PACKETS / s) / 1e6 << " Mpps, "
+            << (s * 1e9) / BENCH_NUM_PACKETS << " ns/packet" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+int main() {
+  for (const int num_filters : {1, 4, 16, 64, 256}) {
+    bench(num_filters);
+  }
+  return 0;
+}